@@ -520,7 +520,8 @@ static void mapDecompressedData(Pixel32* pOutput, uint32_t width, const Pixel32*
 	}
 }
 template<bool PVRTCII>
-static uint32_t pvrtcDecompress(uint8_t* pCompressedData, Pixel32* pDecompressedData, uint32_t width, uint32_t height, uint8_t bpp)
+static uint32_t pvrtcDecompress(uint8_t* pCompressedData, Pixel32* pDecompressedData, uint32_t width, uint32_t height, uint8_t bpp,
+	uint32_t wordRowStart = 0, uint32_t wordRowEnd = UINT32_MAX)
 {
 	uint32_t wordWidth = 4;
 	uint32_t wordHeight = 4;
@@ -537,8 +538,12 @@ static uint32_t pvrtcDecompress(uint8_t* pCompressedData, Pixel32* pDecompressed
 	PVRTCWordIndices indices;
 	std::vector<Pixel32> pPixels(wordWidth * wordHeight * sizeof(Pixel32));
 
+	// rom-properties: Only decompress the specified word rows.
+	// Word row r writes the bottom half of word row r-1 and the top half of word row r.
+	if (wordRowEnd > static_cast<uint32_t>(i32NumYWords)) { wordRowEnd = static_cast<uint32_t>(i32NumYWords); }
+
 	// For each row of words
-	for (int32_t wordY = -1; wordY < i32NumYWords - 1; wordY++)
+	for (int32_t wordY = static_cast<int32_t>(wordRowStart) - 1; wordY < static_cast<int32_t>(wordRowEnd) - 1; wordY++)
 	{
 		// for each column of words
 		for (int32_t wordX = -1; wordX < i32NumXWords - 1; wordX++)
@@ -622,6 +627,31 @@ uint32_t PVRTDecompressPVRTC(const void* pCompressedData, uint32_t Do2bitMode, u
 uint32_t PVRTDecompressPVRTCII(const void* pCompressedData, uint32_t Do2bitMode, uint32_t XDim, uint32_t YDim, uint8_t* pResultImage)
 {
 	return PVRTDecompressPVRTC_int<true>(pCompressedData, Do2bitMode, XDim, YDim, pResultImage);
+}
+
+// rom-properties: Decompress a range of word rows.
+template<bool PVRTCII>
+static uint32_t PVRTDecompressPVRTC_Rows_int(const void* pCompressedData, uint32_t Do2bitMode, uint32_t XDim, uint32_t YDim, uint8_t* pResultImage,
+	uint32_t wordRowStart, uint32_t wordRowEnd)
+{
+	// The dimensions must be at least the minimum size, since
+	// a temporary buffer can't be shared between word rows.
+	if (XDim < ((Do2bitMode == 1u) ? 16u : 8u) || YDim < 8u) { return 0; }
+
+	return pvrtcDecompress<PVRTCII>((uint8_t*)pCompressedData,
+		(Pixel32*)pResultImage, XDim, YDim, uint8_t(Do2bitMode == 1 ? 2 : 4), wordRowStart, wordRowEnd);
+}
+
+uint32_t PVRTDecompressPVRTC_Rows(const void* pCompressedData, uint32_t Do2bitMode, uint32_t XDim, uint32_t YDim, uint8_t* pResultImage,
+	uint32_t wordRowStart, uint32_t wordRowEnd)
+{
+	return PVRTDecompressPVRTC_Rows_int<false>(pCompressedData, Do2bitMode, XDim, YDim, pResultImage, wordRowStart, wordRowEnd);
+}
+
+uint32_t PVRTDecompressPVRTCII_Rows(const void* pCompressedData, uint32_t Do2bitMode, uint32_t XDim, uint32_t YDim, uint8_t* pResultImage,
+	uint32_t wordRowStart, uint32_t wordRowEnd)
+{
+	return PVRTDecompressPVRTC_Rows_int<true>(pCompressedData, Do2bitMode, XDim, YDim, pResultImage, wordRowStart, wordRowEnd);
 }	
 } // namespace pvr
 //!\endcond
@@ -29,4 +29,33 @@ uint32_t PVRTDecompressPVRTC(const void* compressedData, uint32_t do2bitMode, ui
 /// <returns>Return the amount of data that was decompressed.</returns>
 uint32_t PVRTDecompressPVRTCII(const void* compressedData, uint32_t do2bitMode, uint32_t xDim, uint32_t yDim, uint8_t* outResultImage);
 
+// rom-properties: Decompress a range of word rows.
+// Each word row is 4 pixels high. Word row r writes the bottom half of word row r-1
+// (wrapping around to the last word row) and the top half of word row r, so
+// disjoint word row ranges can be decompressed concurrently into the same image.
+
+/// <summary>Decompresses a range of word rows of PVRTC to RGBA 8888.</summary>
+/// <param name="compressedData">The PVRTC texture data to decompress</param>
+/// <param name="do2bitMode">Signifies whether the data is PVRTC2 or PVRTC4</param>
+/// <param name="xDim">X dimension of the texture (must be at least 16 for PVRTC2 or 8 for PVRTC4)</param>
+/// <param name="yDim">Y dimension of the texture (must be at least 8)</param>
+/// <param name="outResultImage">The decompressed texture data (full image)</param>
+/// <param name="wordRowStart">First word row</param>
+/// <param name="wordRowEnd">Last word row, plus one</param>
+/// <returns>Return the amount of data that was decompressed, or 0 if the texture is too small.</returns>
+uint32_t PVRTDecompressPVRTC_Rows(const void* compressedData, uint32_t do2bitMode, uint32_t xDim, uint32_t yDim, uint8_t* outResultImage,
+	uint32_t wordRowStart, uint32_t wordRowEnd);
+
+/// <summary>Decompresses a range of word rows of PVRTC-II to RGBA 8888.</summary>
+/// <param name="compressedData">The PVRTC-II texture data to decompress</param>
+/// <param name="do2bitMode">Signifies whether the data is PVRTC2 or PVRTC4</param>
+/// <param name="xDim">X dimension of the texture (must be at least 16 for PVRTC2 or 8 for PVRTC4)</param>
+/// <param name="yDim">Y dimension of the texture (must be at least 8)</param>
+/// <param name="outResultImage">The decompressed texture data (full image)</param>
+/// <param name="wordRowStart">First word row</param>
+/// <param name="wordRowEnd">Last word row, plus one</param>
+/// <returns>Return the amount of data that was decompressed, or 0 if the texture is too small.</returns>
+uint32_t PVRTDecompressPVRTCII_Rows(const void* compressedData, uint32_t do2bitMode, uint32_t xDim, uint32_t yDim, uint8_t* outResultImage,
+	uint32_t wordRowStart, uint32_t wordRowEnd);
+
 } // namespace pvr
@@ -14,13 +14,19 @@ using LibRpTexture::rp_image;
 
 // libromdata
 #include "libromdata/RomDataFactory.hpp"
+#include "libromdata/RomDataIndex.hpp"
 using LibRomData::RomDataFactory;
+using LibRomData::RomDataIndex;
 
 // TCreateThumbnail is a templated class,
 // so we have to #include the .cpp file here.
 #include "libromdata/img/TCreateThumbnail.cpp"
 using LibRomData::TCreateThumbnail;
 
+// librpthreads
+#include "librpthreads/ThreadPool.hpp"
+using LibRpThreads::ThreadPool;
+
 // C++ STL classes.
 using std::string;
 using std::unique_ptr;
@@ -163,9 +169,12 @@ string CreateThumbnailPrivate::proxyForUrl(const string &url) const
  * @param source_file	[in] Source filename or URI.
  * @param pp_file	[out] Opened file.
  * @param s_uri		[out] Normalized URI. (file:/ for a filename, etc.)
+ * @param s_filename	[out] Local filename, or empty string if the file isn't local.
+ * @param enableThumbnailOnNetworkFS [in] Config::enableThumbnailOnNetworkFS()
  * @return 0 on success; RPCT error code on error.
  */
-static int openFromFilenameOrURI(const char *source_file, IRpFile **pp_file, string &s_uri)
+static int openFromFilenameOrURI(const char *source_file, IRpFile **pp_file,
+	string &s_uri, string &s_filename, bool enableThumbnailOnNetworkFS)
 {
 	// NOTE: Not checking these in Release builds.
 	assert(source_file != nullptr);
@@ -173,7 +182,7 @@ static int openFromFilenameOrURI(const char *source_file, IRpFile **pp_file, str
 
 	*pp_file = nullptr;
 	s_uri.clear();
-	const bool enableThumbnailOnNetworkFS = Config::instance()->enableThumbnailOnNetworkFS();
+	s_filename.clear();
 
 	IRpFile *file = nullptr;
 	char *const uri_scheme = g_uri_parse_scheme(source_file);
@@ -194,6 +203,7 @@ static int openFromFilenameOrURI(const char *source_file, IRpFile **pp_file, str
 
 			// Open the file using RpFile.
 			file = new RpFile(source_filename, RpFile::FM_OPEN_READ_GZ);
+			s_filename = source_filename;
 			g_free(source_filename);
 		} else {
 			// Not a local filename.
@@ -245,6 +255,7 @@ static int openFromFilenameOrURI(const char *source_file, IRpFile **pp_file, str
 
 		// Open the file using RpFile.
 		file = new RpFile(source_file, RpFile::FM_OPEN_READ_GZ);
+		s_filename = source_file;
 	}
 
 	if (file && file->isOpen()) {
@@ -260,37 +271,28 @@ static int openFromFilenameOrURI(const char *source_file, IRpFile **pp_file, str
 }
 
 /**
- * Thumbnail creator function for wrapper programs.
+ * Create a thumbnail.
+ * Common function for rp_create_thumbnail() and rp_create_thumbnails_batch().
+ * @param d CreateThumbnailPrivate
  * @param source_file Source file or URI. (UTF-8)
  * @param output_file Output file. (UTF-8)
  * @param maximum_size Maximum size.
- * @return 0 on success; non-zero on error.
+ * @param enableThumbnailOnNetworkFS Config::enableThumbnailOnNetworkFS()
+ * @return 0 on success; RPCT error code on error.
  */
-extern "C"
-G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const char *output_file, int maximum_size)
+static int createThumbnail(CreateThumbnailPrivate *d,
+	const char *source_file, const char *output_file, int maximum_size,
+	bool enableThumbnailOnNetworkFS)
 {
-	// Some of this is based on the GNOME Thumbnailer skeleton project.
-	// https://github.com/hadess/gnome-thumbnailer-skeleton/blob/master/gnome-thumbnailer-skeleton.c
-
-	if (getuid() == 0 || geteuid() == 0) {
-		g_critical("*** " G_LOG_DOMAIN " does not support running as root.");
-		return RPCT_RUNNING_AS_ROOT;
-	}
-
-	// Make sure glib is initialized.
-	// NOTE: This is a no-op as of glib-2.36.
-#if !GLIB_CHECK_VERSION(2,36,0)
-	g_type_init();
-#endif
-
 	// NOTE: TCreateThumbnail() has wrappers for opening the
 	// ROM file and getting RomData*, but we're doing it here
 	// in order to return better error codes.
 
 	// Attempt to open the ROM file.
 	IRpFile *file = nullptr;
-	string s_uri;
-	int ret = openFromFilenameOrURI(source_file, &file, s_uri);
+	string s_uri, s_filename;
+	int ret = openFromFilenameOrURI(source_file, &file, s_uri, s_filename,
+		enableThumbnailOnNetworkFS);
 	if (ret != 0) {
 		// Error opening the file.
 		return ret;
@@ -299,7 +301,7 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const
 
 	// Get the appropriate RomData class for this ROM.
 	// RomData class *must* support at least one image type.
-	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL);
+	RomData *const romData = RomDataIndex::create(file, RomDataFactory::RDA_HAS_THUMBNAIL);
 	file->unref();	// file is ref()'d by RomData.
 	if (!romData) {
 		// ROM is not supported.
@@ -308,7 +310,6 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const
 
 	// Create the thumbnail.
 	// TODO: If image is larger than maximum_size, resize down.
-	unique_ptr<CreateThumbnailPrivate> d(new CreateThumbnailPrivate());
 	CreateThumbnailPrivate::GetThumbnailOutParams_t outParams;
 	ret = d->getThumbnail(romData, maximum_size, &outParams);
 	if (ret != 0 || !d->isImgClassValid(outParams.retImg)) {
@@ -359,8 +360,19 @@ G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const
 	// Modification time and file size.
 	mtime_str[0] = 0;
 	szFile_str[0] = 0;
-	f_src = g_file_new_for_uri(s_uri.c_str());
-	if (f_src) {
+	if (!s_filename.empty()) {
+		// Local file. Use stat() instead of GIO.
+		off64_t szFile;
+		time_t mtime;
+		if (FileSystem::get_file_size_and_mtime(s_filename, &szFile, &mtime) == 0) {
+			if (mtime > 0) {
+				snprintf(mtime_str, sizeof(mtime_str), "%" PRId64, (int64_t)mtime);
+			}
+			if (szFile > 0) {
+				snprintf(szFile_str, sizeof(szFile_str), "%" PRId64, (int64_t)szFile);
+			}
+		}
+	} else if ((f_src = g_file_new_for_uri(s_uri.c_str())) != nullptr) {
 		GError *error = nullptr;
 		GFileInfo *const fi_src = g_file_query_info(f_src,
 			G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_STANDARD_SIZE,
@@ -466,3 +478,125 @@ cleanup:
 	romData->unref();
 	return ret;
 }
+
+/**
+ * Thumbnail creator function for wrapper programs.
+ * @param source_file Source file or URI. (UTF-8)
+ * @param output_file Output file. (UTF-8)
+ * @param maximum_size Maximum size.
+ * @return 0 on success; non-zero on error.
+ */
+extern "C"
+G_MODULE_EXPORT int RP_C_API rp_create_thumbnail(const char *source_file, const char *output_file, int maximum_size)
+{
+	// Some of this is based on the GNOME Thumbnailer skeleton project.
+	// https://github.com/hadess/gnome-thumbnailer-skeleton/blob/master/gnome-thumbnailer-skeleton.c
+
+	if (getuid() == 0 || geteuid() == 0) {
+		g_critical("*** " G_LOG_DOMAIN " does not support running as root.");
+		return RPCT_RUNNING_AS_ROOT;
+	}
+
+	// Make sure glib is initialized.
+	// NOTE: This is a no-op as of glib-2.36.
+#if !GLIB_CHECK_VERSION(2,36,0)
+	g_type_init();
+#endif
+
+	CreateThumbnailPrivate d;
+	return createThumbnail(&d, source_file, output_file, maximum_size,
+		Config::instance()->enableThumbnailOnNetworkFS());
+}
+
+/**
+ * rp_create_thumbnails_batch() job.
+ */
+struct CreateThumbnailBatchJob {
+	CreateThumbnailPrivate *d;
+	const char *const *source_files;
+	const char *const *output_files;
+	int *results;
+	int maximum_size;
+	bool enableThumbnailOnNetworkFS;
+};
+
+/**
+ * rp_create_thumbnails_batch() task function.
+ * @param param CreateThumbnailBatchJob
+ * @param index File index.
+ */
+static void createThumbnailTask(void *param, unsigned int index)
+{
+	const CreateThumbnailBatchJob *const job = static_cast<const CreateThumbnailBatchJob*>(param);
+	const char *const source_file = job->source_files[index];
+	const char *const output_file = job->output_files[index];
+	if (!source_file || !output_file) {
+		job->results[index] = RPCT_SOURCE_FILE_ERROR;
+		return;
+	}
+
+	job->results[index] = createThumbnail(job->d,
+		source_file, output_file, job->maximum_size,
+		job->enableThumbnailOnNetworkFS);
+}
+
+/**
+ * Batch thumbnail creator function for wrapper programs.
+ *
+ * This is equivalent to calling rp_create_thumbnail() for each file,
+ * but per-process state is only initialized once, and files are
+ * processed in parallel using the shared thread pool.
+ *
+ * @param count		[in] Number of files.
+ * @param source_files	[in] Source files or URIs. (UTF-8)
+ * @param output_files	[in] Output files. (UTF-8)
+ * @param maximum_size	[in] Maximum size.
+ * @param results	[out] Array of count RPCT error codes. (0 on success)
+ * @return Number of files that failed. (0 if all thumbnails were created)
+ */
+extern "C"
+G_MODULE_EXPORT int RP_C_API rp_create_thumbnails_batch(unsigned int count,
+	const char *const *source_files, const char *const *output_files,
+	int maximum_size, int *results)
+{
+	assert(source_files != nullptr);
+	assert(output_files != nullptr);
+	assert(results != nullptr);
+	if (count == 0 || !source_files || !output_files || !results) {
+		return 0;
+	}
+
+	if (getuid() == 0 || geteuid() == 0) {
+		g_critical("*** " G_LOG_DOMAIN " does not support running as root.");
+		for (unsigned int i = 0; i < count; i++) {
+			results[i] = RPCT_RUNNING_AS_ROOT;
+		}
+		return static_cast<int>(count);
+	}
+
+	// Make sure glib is initialized.
+	// NOTE: This is a no-op as of glib-2.36.
+#if !GLIB_CHECK_VERSION(2,36,0)
+	g_type_init();
+#endif
+
+	// NOTE: CreateThumbnailPrivate doesn't have any per-file
+	// state, so a single instance is shared by all tasks.
+	CreateThumbnailPrivate d;
+	CreateThumbnailBatchJob job;
+	job.d = &d;
+	job.source_files = source_files;
+	job.output_files = output_files;
+	job.results = results;
+	job.maximum_size = maximum_size;
+	job.enableThumbnailOnNetworkFS = Config::instance()->enableThumbnailOnNetworkFS();
+	ThreadPool::instance()->parallelFor(count, createThumbnailTask, &job);
+
+	int failed = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		if (results[i] != 0) {
+			failed++;
+		}
+	}
+	return failed;
+}
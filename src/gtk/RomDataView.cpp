@@ -767,7 +767,7 @@ rom_data_view_init_string(RomDataView *page,
 	gtk_widget_show(widget);
 
 	if (!str && field.data.str) {
-		str = field.data.str->c_str();
+		str = field.data.str.c_str();
 	}
 
 	if (field.type == RomFields::RFT_STRING &&
@@ -937,9 +937,9 @@ rom_data_view_init_listdata(RomDataView *page,
 	// NOTE: listDataDesc.names can be nullptr,
 	// which means we don't have any column headers.
 
-	// Single language ListData_t.
+	// Single language ListDataView_t.
 	// For RFT_LISTDATA_MULTI, this is only used for row and column count.
-	const RomFields::ListData_t *list_data;
+	const RomFields::ListDataView_t *list_data;
 	const bool isMulti = !!(listDataDesc.flags & RomFields::RFT_LISTDATA_MULTI);
 	if (isMulti) {
 		// Multiple languages.
@@ -1037,7 +1037,7 @@ rom_data_view_init_listdata(RomDataView *page,
 	unsigned int row = 0;	// for icons [TODO: Use iterator?]
 	const auto list_data_cend = list_data->cend();
 	for (auto iter = list_data->cbegin(); iter != list_data_cend; ++iter, row++) {
-		const vector<string> &data_row = *iter;
+		const RomFields::ListDataRow_t &data_row = *iter;
 		// FIXME: Skip even if we don't have checkboxes?
 		// (also check other UI frontends)
 		if (hasCheckboxes && data_row.empty()) {
@@ -1473,7 +1473,7 @@ rom_data_view_update_multi(RomDataView *page, uint32_t user_lc)
 			}
 		}
 
-		// Get the ListData_t.
+		// Get the ListDataView_t.
 		const auto *const pListData = RomFields::getFromListDataMulti(pListData_multi, page->def_lc, user_lc);
 		assert(pListData != nullptr);
 		if (pListData != nullptr) {
@@ -1631,7 +1631,7 @@ rom_data_view_update_field(RomDataView *page, int fieldIdx)
 			}
 
 			gtk_label_set_text(GTK_LABEL(widget), field->data.str
-				? field->data.str->c_str()
+				? field->data.str.c_str()
 				: nullptr);
 			ret = 0;
 			break;
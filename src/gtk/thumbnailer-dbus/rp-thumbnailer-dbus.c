@@ -18,6 +18,7 @@
 #include "SpecializedThumbnailer1.h"
 
 // C includes.
+#include <assert.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
@@ -69,7 +70,12 @@ static void	rp_thumbnailer_set_property	(GObject	*object,
 						 GParamSpec	*pspec);
 
 static gboolean	rp_thumbnailer_timeout		(RpThumbnailer	*thumbnailer);
-static gboolean	rp_thumbnailer_process		(RpThumbnailer	*thumbnailer);
+static void	rp_thumbnailer_process		(gpointer	 data,
+						 gpointer	 user_data);
+static gint	rp_thumbnailer_compare_requests	(gconstpointer	 a,
+						 gconstpointer	 b,
+						 gpointer	 user_data);
+static gboolean	rp_thumbnailer_complete		(gpointer	 data);
 
 // D-Bus methods.
 static gboolean	rp_thumbnailer_queue		(OrgFreedesktopThumbnailsSpecializedThumbnailer1 *skeleton,
@@ -93,12 +99,34 @@ struct _RpThumbnailerClass {
 
 #define SHUTDOWN_TIMEOUT_SECONDS 30
 
+// Maximum number of worker threads.
+#define MAX_WORKER_THREADS 8
+
+// Request states.
+// NOTE: Accessed atomically, since the worker threads
+// and the main thread both update the state.
+enum RequestState {
+	REQUEST_QUEUED = 0,	// Waiting for a worker thread
+	REQUEST_RUNNING = 1,	// Being processed by a worker thread
+	REQUEST_CANCELLED = 2,	// All handles were dequeued before it started
+};
+
 // Thumbnail request information.
+// Duplicate requests for the same URI and flavor are coalesced,
+// so a single request may have multiple handles.
 struct request_info {
+	RpThumbnailer *thumbnailer;	// Owner (has a reference)
 	gchar *uri;
-	guint32 handle;
-	bool large;	// False for 'normal' (128x128); true for 'large' (256x256)
-	bool urgent;	// 'urgent' value
+	GArray *handles;	// guint32; main thread only
+	guint64 seq;		// Queue order, for FIFO within a priority
+	gint state;		// enum RequestState (atomic)
+	gint urgent;		// 'urgent' value (atomic)
+	bool large;		// False for 'normal' (128x128); true for 'large' (256x256)
+
+	// Result. (set by the worker thread)
+	gchar *cache_filename;
+	const char *err_msg;	// NULL on success
+	guint32 err_code;
 };
 
 struct _RpThumbnailer {
@@ -111,14 +139,23 @@ struct _RpThumbnailer {
 	// Shutdown timeout.
 	guint timeout_id;
 
-	// Idle function for processing.
-	guint idle_process;
+	// Worker threads.
+	GThreadPool *thread_pool;
 
 	// Last handle value.
 	guint32 last_handle;
 
-	// Request queue.
-	GQueue request_queue;	// element is struct request_info*
+	// Last request sequence number.
+	guint64 last_seq;
+
+	// Number of requests that haven't been completed yet.
+	// Main thread only.
+	guint pending_count;
+
+	// Requests that haven't been completed yet.
+	// Main thread only.
+	GHashTable *pending_uris[2];	// key: uri; value: struct request_info*; index is 'large'
+	GHashTable *pending_handles;	// key: handle; value: struct request_info*
 
 	/** Properties. **/
 
@@ -221,9 +258,13 @@ static void
 rp_thumbnailer_init(RpThumbnailer *thumbnailer, gpointer g_class)
 {
 	// g_object_new() guarantees that all values are initialized to 0.
-	// Nothing to do here.
-	RP_UNUSED(thumbnailer);
 	RP_UNUSED(g_class);
+
+	// Pending request maps.
+	// NOTE: Keys are owned by the request_info structs.
+	thumbnailer->pending_uris[0] = g_hash_table_new(g_str_hash, g_str_equal);
+	thumbnailer->pending_uris[1] = g_hash_table_new(g_str_hash, g_str_equal);
+	thumbnailer->pending_handles = g_hash_table_new(g_direct_hash, g_direct_equal);
 }
 
 static void
@@ -243,6 +284,23 @@ rp_thumbnailer_constructed(GObject *object)
 		return;
 	}
 
+	// Create the worker threads.
+	// NOTE: Non-exclusive, so threads are only created when needed.
+#if GLIB_CHECK_VERSION(2,36,0)
+	guint max_threads = g_get_num_processors();
+#else /* !GLIB_CHECK_VERSION(2,36,0) */
+	guint max_threads = 2;
+#endif /* GLIB_CHECK_VERSION(2,36,0) */
+	if (max_threads < 1) {
+		max_threads = 1;
+	} else if (max_threads > MAX_WORKER_THREADS) {
+		max_threads = MAX_WORKER_THREADS;
+	}
+	thumbnailer->thread_pool = g_thread_pool_new(rp_thumbnailer_process,
+		thumbnailer, (gint)max_threads, false, NULL);
+	g_thread_pool_set_sort_function(thumbnailer->thread_pool,
+		rp_thumbnailer_compare_requests, NULL);
+
 	// Connect signals to the relevant functions.
 	g_signal_connect(thumbnailer->skeleton, "handle-queue",
 		G_CALLBACK(rp_thumbnailer_queue), thumbnailer);
@@ -270,10 +328,13 @@ rp_thumbnailer_dispose(GObject *object)
 		thumbnailer->timeout_id = 0;
 	}
 
-	// Unregister idle_process.
-	if (G_UNLIKELY(thumbnailer->idle_process != 0)) {
-		g_source_remove(thumbnailer->idle_process);
-		thumbnailer->idle_process = 0;
+	// Wait for the worker threads to finish.
+	// NOTE: Each request has a reference to the RpThumbnailer,
+	// so there shouldn't be any requests left unless dispose()
+	// was called explicitly.
+	if (thumbnailer->thread_pool) {
+		g_thread_pool_free(thumbnailer->thread_pool, false, true);
+		thumbnailer->thread_pool = NULL;
 	}
 
 	// No longer exported.
@@ -292,15 +353,12 @@ rp_thumbnailer_finalize(GObject *object)
 		g_object_unref(thumbnailer->skeleton);
 	}
 
-	// Delete any remaining requests and free the queue.
-	for (GList *p = thumbnailer->request_queue.head; p != NULL; p = p->next) {
-		if (p->data) {
-			struct request_info *const req = (struct request_info*)p->data;
-			g_free(req->uri);
-			g_free(req);
-		}
-	}
-	g_queue_clear(&thumbnailer->request_queue);
+	// Free the pending request maps.
+	// NOTE: Requests have a reference to the RpThumbnailer,
+	// so all requests have been freed by this point.
+	g_hash_table_destroy(thumbnailer->pending_uris[0]);
+	g_hash_table_destroy(thumbnailer->pending_uris[1]);
+	g_hash_table_destroy(thumbnailer->pending_handles);
 
 	/** Properties. **/
 	g_free(thumbnailer->cache_dir);
@@ -391,6 +449,19 @@ rp_thumbnailer_set_property(GObject *object,
 	}
 }
 
+/**
+ * Free a request.
+ * @param req Request.
+ */
+static void
+request_info_free(struct request_info *req)
+{
+	g_free(req->uri);
+	g_free(req->cache_filename);
+	g_array_free(req->handles, true);
+	g_free(req);
+}
+
 /**
  * Queue a ROM image for thumbnailing.
  * @param skeleton	[in] GDBusObjectSkeleton
@@ -413,7 +484,7 @@ rp_thumbnailer_queue(OrgFreedesktopThumbnailsSpecializedThumbnailer1 *skeleton,
 	g_dbus_async_return_val_if_fail(IS_RP_THUMBNAILER(thumbnailer), invocation, false);
 	g_dbus_async_return_val_if_fail(uri != NULL, invocation, false);
 
-	if (G_UNLIKELY(thumbnailer->shutdown_emitted)) {
+	if (G_UNLIKELY(thumbnailer->shutdown_emitted || !thumbnailer->thread_pool)) {
 		// The shutdown signal was emitted.
 		// Can't queue anything else.
 		g_dbus_method_invocation_return_error(invocation,
@@ -435,21 +506,47 @@ rp_thumbnailer_queue(OrgFreedesktopThumbnailsSpecializedThumbnailer1 *skeleton,
 		handle = ++thumbnailer->last_handle;
 	}
 
-	// Add the URI to the queue.
 	// NOTE: Currently handling all flavors that aren't "large" as "normal".
-	struct request_info *const req = g_malloc(sizeof(struct request_info));
+	const bool large = flavor && (g_ascii_strcasecmp(flavor, "large") == 0);
+
+	// If the same URI and flavor is already queued and hasn't
+	// been started yet, add this handle to the existing request.
+	struct request_info *req = (struct request_info*)g_hash_table_lookup(
+		thumbnailer->pending_uris[large], uri);
+	if (req && g_atomic_int_get(&req->state) == REQUEST_QUEUED) {
+		g_array_append_val(req->handles, handle);
+		g_hash_table_insert(thumbnailer->pending_handles, GUINT_TO_POINTER(handle), req);
+		if (urgent && !g_atomic_int_get(&req->urgent)) {
+			// Upgrade the existing request to 'urgent'.
+			g_atomic_int_set(&req->urgent, true);
+#if GLIB_CHECK_VERSION(2,46,0)
+			g_thread_pool_move_to_front(thumbnailer->thread_pool, req);
+#endif /* GLIB_CHECK_VERSION(2,46,0) */
+		}
+		org_freedesktop_thumbnails_specialized_thumbnailer1_complete_queue(skeleton, invocation, handle);
+		return true;
+	}
+
+	// Add the URI to the queue.
+	// NOTE: 'urgent' requests are sorted ahead of other requests
+	// by rp_thumbnailer_compare_requests().
+	req = g_malloc0(sizeof(struct request_info));
+	req->thumbnailer = g_object_ref(thumbnailer);
 	req->uri = g_strdup(uri);
-	req->handle = handle;
-	req->large = flavor && (g_ascii_strcasecmp(flavor, "large") == 0);
+	req->handles = g_array_sized_new(false, false, sizeof(guint32), 1);
+	g_array_append_val(req->handles, handle);
+	req->seq = ++thumbnailer->last_seq;
+	req->state = REQUEST_QUEUED;
 	req->urgent = urgent;
-	// TODO Put 'urgent' requests at the front of the queue?
-	g_queue_push_tail(&thumbnailer->request_queue, req);
+	req->large = large;
 
-	// Make sure the idle process is started.
-	// TODO: Make it multi-threaded? (needs atomic compare and/or mutex...)
-	if (thumbnailer->idle_process == 0) {
-		thumbnailer->idle_process = g_idle_add((GSourceFunc)rp_thumbnailer_process, thumbnailer);
-	}
+	// NOTE: If a request for this URI is already running,
+	// the new request replaces it in the URI map.
+	// g_hash_table_replace() is used so the key is replaced, too.
+	g_hash_table_replace(thumbnailer->pending_uris[large], req->uri, req);
+	g_hash_table_insert(thumbnailer->pending_handles, GUINT_TO_POINTER(handle), req);
+	thumbnailer->pending_count++;
+	g_thread_pool_push(thumbnailer->thread_pool, req, NULL);
 
 	org_freedesktop_thumbnails_specialized_thumbnailer1_complete_queue(skeleton, invocation, handle);
 	return true;
@@ -472,7 +569,35 @@ rp_thumbnailer_dequeue(OrgFreedesktopThumbnailsSpecializedThumbnailer1 *skeleton
 	g_dbus_async_return_val_if_fail(IS_RP_THUMBNAILER(thumbnailer), invocation, false);
 	g_dbus_async_return_val_if_fail(handle != 0, invocation, false);
 
-	// TODO
+	struct request_info *const req = (struct request_info*)g_hash_table_lookup(
+		thumbnailer->pending_handles, GUINT_TO_POINTER(handle));
+	if (!req) {
+		// Handle not found. It may have already been completed.
+		org_freedesktop_thumbnails_specialized_thumbnailer1_complete_dequeue(skeleton, invocation);
+		return true;
+	}
+
+	// Remove the handle from the request.
+	// No signals will be emitted for this handle.
+	g_hash_table_remove(thumbnailer->pending_handles, GUINT_TO_POINTER(handle));
+	for (guint i = 0; i < req->handles->len; i++) {
+		if (g_array_index(req->handles, guint32, i) == handle) {
+			g_array_remove_index(req->handles, i);
+			break;
+		}
+	}
+
+	if (req->handles->len == 0) {
+		// No handles left. If the request hasn't been started yet,
+		// cancel it. (A running request is allowed to finish.)
+		if (g_atomic_int_compare_and_exchange(&req->state, REQUEST_QUEUED, REQUEST_CANCELLED)) {
+			// Don't coalesce new requests with the cancelled one.
+			if (g_hash_table_lookup(thumbnailer->pending_uris[req->large], req->uri) == req) {
+				g_hash_table_remove(thumbnailer->pending_uris[req->large], req->uri);
+			}
+		}
+	}
+
 	org_freedesktop_thumbnails_specialized_thumbnailer1_complete_dequeue(skeleton, invocation);
 	return true;
 }
@@ -485,7 +610,7 @@ static gboolean
 rp_thumbnailer_timeout(RpThumbnailer *thumbnailer)
 {
 	g_return_val_if_fail(IS_RP_THUMBNAILER(thumbnailer), false);
-	if (!g_queue_is_empty(&thumbnailer->request_queue)) {
+	if (thumbnailer->pending_count > 0) {
 		// Still processing stuff.
 		return true;
 	}
@@ -499,43 +624,63 @@ rp_thumbnailer_timeout(RpThumbnailer *thumbnailer)
 	return false;
 }
 
+/**
+ * Compare two requests for the thread pool's queue.
+ * 'urgent' requests are processed first; otherwise, FIFO.
+ * @param a struct request_info*
+ * @param b struct request_info*
+ * @param user_data Unused.
+ * @return Negative if a should be processed first; positive if b should be processed first.
+ */
+static gint
+rp_thumbnailer_compare_requests(gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	RP_UNUSED(user_data);
+	struct request_info *const req_a = (struct request_info*)a;
+	struct request_info *const req_b = (struct request_info*)b;
+
+	const gint urgent_a = g_atomic_int_get(&req_a->urgent);
+	const gint urgent_b = g_atomic_int_get(&req_b->urgent);
+	if (urgent_a != urgent_b) {
+		return (urgent_a ? -1 : 1);
+	}
+	return (req_a->seq < req_b->seq ? -1 : (req_a->seq > req_b->seq ? 1 : 0));
+}
+
 /**
  * Process a thumbnail.
- * @param thumbnailer RpThumbnailer object.
+ * This runs on a worker thread. Signals are emitted
+ * on the main thread by rp_thumbnailer_complete().
+ * @param data struct request_info*
+ * @param user_data RpThumbnailer object.
  */
-static gboolean
-rp_thumbnailer_process(RpThumbnailer *thumbnailer)
+static void
+rp_thumbnailer_process(gpointer data, gpointer user_data)
 {
-	g_return_val_if_fail(IS_RP_THUMBNAILER(thumbnailer), FALSE);
+	struct request_info *const req = (struct request_info*)data;
+	RpThumbnailer *const thumbnailer = RP_THUMBNAILER(user_data);
 
-	const gchar *md5_string;	// owned by md5 object
-	const struct request_info *req;	// request info from the map
+	gchar *md5_string = NULL;	// g_compute_checksum_for_data()
 	gchar *cache_filename = NULL;	// cache filename (g_strdup_printf())
 	size_t cache_filename_sz;	// size of cache_filename
 	int pos, pos2;			// snprintf() position
 	int ret;
 
-	// Process one thumbnail.
-	req = (struct request_info*)g_queue_pop_head(&thumbnailer->request_queue);
-	if (req == NULL) {
-		// Nothing in the queue.
-		goto cleanup;
+	if (!g_atomic_int_compare_and_exchange(&req->state, REQUEST_QUEUED, REQUEST_RUNNING)) {
+		// Request was cancelled.
+		goto finished;
 	}
 
 	// NOTE: cache_dir and pfn_rp_create_thumbnail should NOT be NULL
 	// at this point, but we're checking it anyway.
 	if (!thumbnailer->cache_dir || thumbnailer->cache_dir[0] == 0) {
 		// No cache directory...
-		org_freedesktop_thumbnails_specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, "",
-			0, "Thumbnail cache directory is empty.");
+		req->err_msg = "Thumbnail cache directory is empty.";
 		goto finished;
 	}
 	if (!thumbnailer->pfn_rp_create_thumbnail) {
 		// No thumbnailer function.
-		org_freedesktop_thumbnails_specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, "",
-			0, "No thumbnailer function is available.");
+		req->err_msg = "No thumbnailer function is available.";
 		goto finished;
 	}
 
@@ -556,16 +701,14 @@ rp_thumbnailer_process(RpThumbnailer *thumbnailer)
 	// pos does NOT include the NULL terminator, so check >=.
 	if (pos < 0 || ((size_t)pos + 1 + 32 + 4) > cache_filename_sz) {
 		// Not enough memory.
-		org_freedesktop_thumbnails_specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			0, "Cannot snprintf() the thumbnail cache directory name.");
+		req->err_msg = "Cannot snprintf() the thumbnail cache directory name.";
 		goto finished;
 	}
 
+	// NOTE: g_mkdir_with_parents() is safe to call from
+	// multiple threads, since EEXIST is ignored.
 	if (g_mkdir_with_parents(cache_filename, 0777) != 0) {
-		org_freedesktop_thumbnails_specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			0, "Cannot mkdir() the thumbnail cache directory.");
+		req->err_msg = "Cannot mkdir() the thumbnail cache directory.";
 		goto finished;
 	}
 
@@ -573,9 +716,7 @@ rp_thumbnailer_process(RpThumbnailer *thumbnailer)
 	md5_string = g_compute_checksum_for_data(G_CHECKSUM_MD5, (const guchar*)req->uri, strlen(req->uri));
 	if (!md5_string) {
 		// Cannot compute the checksum...
-		org_freedesktop_thumbnails_specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			0, "g_compute_checksum_for_data() failed.");
+		req->err_msg = "g_compute_checksum_for_data() failed.";
 		goto finished;
 	}
 
@@ -584,9 +725,7 @@ rp_thumbnailer_process(RpThumbnailer *thumbnailer)
 	// pos and pos2 do NOT include the NULL terminator, so check >=.
 	if (pos2 < 0 || ((size_t)pos + (size_t)pos2) >= cache_filename_sz) {
 		// Not enough memory.
-		org_freedesktop_thumbnails_specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			0, "Cannot snprintf() the thumbnail filename.");
+		req->err_msg = "Cannot snprintf() the thumbnail filename.";
 		goto finished;
 	}
 
@@ -595,43 +734,79 @@ rp_thumbnailer_process(RpThumbnailer *thumbnailer)
 	if (ret == 0) {
 		// Image thumbnailed successfully.
 		g_debug("rom-properties thumbnail: %s -> %s [OK]", req->uri, cache_filename);
-		org_freedesktop_thumbnails_specialized_thumbnailer1_emit_ready(
-			thumbnailer->skeleton, req->handle, req->uri);
 	} else {
 		// Error thumbnailing the image...
 		g_debug("rom-properties thumbnail: %s -> %s [ERR=%d]", req->uri, cache_filename, ret);
-		org_freedesktop_thumbnails_specialized_thumbnailer1_emit_error(
-			thumbnailer->skeleton, req->handle, req->uri,
-			2, "Image thumbnailing failed... (TODO: return code)");
+		req->err_code = 2;
+		req->err_msg = "Image thumbnailing failed... (TODO: return code)";
 	}
 
 finished:
-	// Request is finished. Emit the finished signal.
-	org_freedesktop_thumbnails_specialized_thumbnailer1_emit_finished(
-		thumbnailer->skeleton, req->handle);
+	g_free(md5_string);
+	req->cache_filename = cache_filename;
 
-cleanup:
-	// Free allocated things.
-	g_free(cache_filename);
+	// Emit the signals on the main thread.
+	g_idle_add(rp_thumbnailer_complete, req);
+}
+
+/**
+ * A request has been processed.
+ * Emit the signals for all of its handles.
+ * This runs on the main thread.
+ * @param data struct request_info*
+ * @return FALSE to remove the idle source.
+ */
+static gboolean
+rp_thumbnailer_complete(gpointer data)
+{
+	struct request_info *const req = (struct request_info*)data;
+	RpThumbnailer *const thumbnailer = req->thumbnailer;
+
+	// Remove the request from the pending maps.
+	if (g_hash_table_lookup(thumbnailer->pending_uris[req->large], req->uri) == req) {
+		g_hash_table_remove(thumbnailer->pending_uris[req->large], req->uri);
+	}
 
-	// req was allocated using g_malloc() before it was
-	// added to the queue. We'll need to free it here.
-	g_free((gpointer)req);
+	const bool cancelled = (g_atomic_int_get(&req->state) == REQUEST_CANCELLED);
+	for (guint i = 0; i < req->handles->len; i++) {
+		const guint32 handle = g_array_index(req->handles, guint32, i);
+		g_hash_table_remove(thumbnailer->pending_handles, GUINT_TO_POINTER(handle));
+		if (cancelled) {
+			// Shouldn't happen, since cancelled requests
+			// don't have any handles left.
+			continue;
+		}
 
-	// Return TRUE if we still have more thumbnails queued.
-	const bool isEmpty = g_queue_is_empty(&thumbnailer->request_queue);
-	if (isEmpty) {
-		// Clear the idle process.
-		// FIXME: Atomic compare and/or mutex? (assuming multi-threaded...)
-		thumbnailer->idle_process = 0;
+		if (!req->err_msg) {
+			org_freedesktop_thumbnails_specialized_thumbnailer1_emit_ready(
+				thumbnailer->skeleton, handle, req->uri);
+		} else {
+			// NOTE: Errors that aren't specific to the URI
+			// are reported with an empty URI.
+			org_freedesktop_thumbnails_specialized_thumbnailer1_emit_error(
+				thumbnailer->skeleton, handle,
+				(req->cache_filename ? req->uri : ""),
+				req->err_code, req->err_msg);
+		}
 
+		// Request is finished. Emit the finished signal.
+		org_freedesktop_thumbnails_specialized_thumbnailer1_emit_finished(
+			thumbnailer->skeleton, handle);
+	}
+
+	assert(thumbnailer->pending_count > 0);
+	thumbnailer->pending_count--;
+	if (thumbnailer->pending_count == 0 && !thumbnailer->shutdown_emitted) {
 		// Restart the inactivity timeout.
 		if (G_LIKELY(thumbnailer->timeout_id == 0)) {
 			thumbnailer->timeout_id = g_timeout_add_seconds(SHUTDOWN_TIMEOUT_SECONDS,
 				(GSourceFunc)rp_thumbnailer_timeout, thumbnailer);
 		}
 	}
-	return !isEmpty;
+
+	request_info_free(req);
+	g_object_unref(thumbnailer);
+	return false;
 }
 
 /**
@@ -38,7 +38,11 @@ int rpt_do_security_options(void)
 		// ensures it can only be used to create threads.
 		SCMP_SYS(clone),
 		// Other multi-threading syscalls
-		SCMP_SYS(set_robust_list),
+		SCMP_SYS(set_robust_list), SCMP_SYS(madvise),
+		SCMP_SYS(sched_getaffinity),	// sysconf(_SC_NPROCESSORS_ONLN)
+#if defined(__SNR_rseq) || defined(__NR_rseq)
+		SCMP_SYS(rseq),		// glibc-2.35
+#endif /* __SNR_rseq || __NR_rseq */
 
 		SCMP_SYS(access),	// LibUnixCommon::isWritableDirectory()
 		SCMP_SYS(close),
@@ -53,6 +57,8 @@ int rpt_do_security_options(void)
 		SCMP_SYS(getppid),	// dll-search.c: walk_proc_tree()
 		SCMP_SYS(getuid),	// TODO: Only use geteuid()?
 		SCMP_SYS(lseek), SCMP_SYS(_llseek),
+		SCMP_SYS(pread64),	// LibRpFile::RpFile::readAt()
+		SCMP_SYS(preadv),	// LibRpFile::RpFile::readBatch()
 		SCMP_SYS(lstat), SCMP_SYS(lstat64),	// LibRpBase::FileSystem::is_symlink(), resolve_symlink()
 		SCMP_SYS(mkdir),	// g_mkdir_with_parents() [rp_thumbnailer_process()]
 		SCMP_SYS(mmap),		// iconv_open(), dlopen()
@@ -67,8 +73,13 @@ int rpt_do_security_options(void)
 		__NR_openat2,		// Linux 5.6
 #endif /* __SNR_openat2 || __NR_openat2 */
 		SCMP_SYS(readlink),	// realpath() [LibRpBase::FileSystem::resolve_symlink()]
+		SCMP_SYS(rename), SCMP_SYS(renameat),	// LibRpFile::FileSystem::rename_file() [RomDataIndex]
+#if defined(__SNR_renameat2) || defined(__NR_renameat2)
+		SCMP_SYS(renameat2),
+#endif /* __SNR_renameat2 || __NR_renameat2 */
 		SCMP_SYS(stat), SCMP_SYS(stat64),	// LibUnixCommon::isWritableDirectory()
 		SCMP_SYS(statfs), SCMP_SYS(statfs64),	// LibRpBase::FileSystem::isOnBadFS()
+		SCMP_SYS(unlink), SCMP_SYS(unlinkat),	// LibRpFile::FileSystem::delete_file() [RomDataIndex]
 
 #if defined(__SNR_statx) || defined(__NR_statx)
 		SCMP_SYS(getcwd),	// called by glibc's statx()
@@ -93,7 +93,7 @@ class ListDataModelPrivate
 		 * @param hasCheckboxes If true, skip empty rows.
 		 * @return vector<QString>.
 		 */
-		static vector<QString> convertListDataToVector(const RomFields::ListData_t *list_data, bool hasCheckboxes);
+		static vector<QString> convertListDataToVector(const RomFields::ListDataView_t *list_data, bool hasCheckboxes);
 
 	public:
 		/**
@@ -212,7 +212,7 @@ void ListDataModelPrivate::updateIconPixmaps(void)
  * @param hasCheckboxes If true, skip empty rows.
  * @return vector<QString>.
  */
-vector<QString> ListDataModelPrivate::convertListDataToVector(const RomFields::ListData_t *list_data, bool hasCheckboxes)
+vector<QString> ListDataModelPrivate::convertListDataToVector(const RomFields::ListDataView_t *list_data, bool hasCheckboxes)
 {
 	vector<QString> data;
 	if (!list_data || list_data->empty()) {
@@ -226,7 +226,7 @@ vector<QString> ListDataModelPrivate::convertListDataToVector(const RomFields::L
 	data.reserve(columnCount * rowCount);
 	const auto list_data_cend = list_data->cend();
 	for (auto iter = list_data->cbegin(); iter != list_data_cend; ++iter) {
-		const vector<string> &data_row = *iter;
+		const RomFields::ListDataRow_t &data_row = *iter;
 		if (hasCheckboxes && data_row.empty()) {
 			// Skip this row.
 			continue;
@@ -237,7 +237,7 @@ vector<QString> ListDataModelPrivate::convertListDataToVector(const RomFields::L
 		int cols = columnCount;
 		const auto data_row_cend = data_row.cend();
 		for (auto iter = data_row.cbegin(); iter != data_row_cend && cols > 0; ++iter, cols--) {
-			data.emplace_back(U82Q(*iter));
+			data.emplace_back(U82Q(iter->c_str(), static_cast<int>(iter->size())));
 		}
 		// If there's fewer columns in the data row than we have allocated,
 		// add blank QStrings.
@@ -495,9 +495,9 @@ void ListDataModel::setField(const RomFields::Field *pField)
 		return;
 	}
 
-	// Single language ListData_t.
+	// Single language ListDataView_t.
 	// For RFT_LISTDATA_MULTI, this is only used for row and column count.
-	const RomFields::ListData_t *list_data;
+	const RomFields::ListDataView_t *list_data;
 	const bool isMulti = !!(listDataDesc.flags & RomFields::RFT_LISTDATA_MULTI);
 	if (isMulti) {
 		// Multiple languages.
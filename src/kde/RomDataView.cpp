@@ -568,7 +568,7 @@ QLabel *RomDataViewPrivate::initString(QLabel *lblDesc,
 		if (str) {
 			text = *str;
 		} else if (field.data.str) {
-			text = U82Q(*(field.data.str));
+			text = U82Q(field.data.str.ptr, static_cast<int>(field.data.str.len));
 		}
 		text.replace(QChar(L'\n'), QLatin1String("<br/>"));
 		lblString->setText(text);
@@ -581,7 +581,7 @@ QLabel *RomDataViewPrivate::initString(QLabel *lblDesc,
 		if (str) {
 			lblString->setText(*str);
 		} else if (field.data.str) {
-			lblString->setText(U82Q(*(field.data.str)));
+			lblString->setText(U82Q(field.data.str.ptr, static_cast<int>(field.data.str.len)));
 		}
 	}
 
@@ -719,9 +719,9 @@ void RomDataViewPrivate::initListData(QLabel *lblDesc,
 	// NOTE: listDataDesc.names can be nullptr,
 	// which means we don't have any column headers.
 
-	// Single language ListData_t.
+	// Single language ListDataView_t.
 	// For RFT_LISTDATA_MULTI, this is only used for row and column count.
-	const RomFields::ListData_t *list_data;
+	const RomFields::ListDataView_t *list_data;
 	const bool isMulti = !!(listDataDesc.flags & RomFields::RFT_LISTDATA_MULTI);
 	if (isMulti) {
 		// Multiple languages.
@@ -1258,7 +1258,7 @@ int RomDataViewPrivate::updateField(int fieldIdx)
 			}
 
 			if (field->data.str) {
-				label->setText(U82Q(*(field->data.str)));
+				label->setText(U82Q(field->data.str.ptr, static_cast<int>(field->data.str.len)));
 			} else {
 				label->clear();
 			}
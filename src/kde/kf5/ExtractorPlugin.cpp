@@ -19,7 +19,9 @@ using LibRpFile::IRpFile;
 
 // libromdata
 #include "libromdata/RomDataFactory.hpp"
+#include "libromdata/RomDataIndex.hpp"
 using LibRomData::RomDataFactory;
+using LibRomData::RomDataIndex;
 
 // C++ STL classes.
 using std::string;
@@ -83,7 +85,7 @@ void ExtractorPlugin::extract(ExtractionResult *result)
 
 	// Get the appropriate RomData class for this ROM.
 	// file is dup()'d by RomData.
-	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_METADATA);
+	RomData *const romData = RomDataIndex::create(file, RomDataFactory::RDA_METADATA_ONLY);
 	file->unref();	// file is ref()'d by RomData.
 	if (!romData) {
 		// ROM is not supported.
@@ -126,10 +128,10 @@ void ExtractorPlugin::extract(ExtractionResult *result)
 			}
 
 			case PropertyType::String: {
-				const string *str = prop->data.str;
+				const StrView &str = prop->data.str;
 				if (str) {
 					result->add(static_cast<KFileMetaData::Property::Property>(prop->name),
-						QString::fromUtf8(str->data(), static_cast<int>(str->size())));
+						QString::fromUtf8(str.ptr, static_cast<int>(str.len)));
 				}
 				break;
 			}
@@ -19,7 +19,9 @@ using LibRpFile::IRpFile;
 
 // libromdata
 #include "libromdata/RomDataFactory.hpp"
+#include "libromdata/RomDataIndex.hpp"
 using LibRomData::RomDataFactory;
+using LibRomData::RomDataIndex;
 
 // C++ STL classes.
 using std::string;
@@ -61,7 +63,8 @@ OverlayIconPlugin::OverlayIconPlugin(QObject *parent)
 
 QStringList OverlayIconPlugin::getOverlays(const QUrl &item)
 {
-	// TODO: Check for slow devices and/or cache this?
+	// TODO: Check for slow devices?
+	// NOTE: Results are cached by RomDataIndex if it's enabled.
 	QStringList sl;
 
 	const Config *const config = Config::instance();
@@ -78,7 +81,7 @@ QStringList OverlayIconPlugin::getOverlays(const QUrl &item)
 	}
 
 	// Get the appropriate RomData class for this ROM.
-	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_DPOVERLAY);
+	RomData *const romData = RomDataIndex::create(file, RomDataFactory::RDA_HAS_DPOVERLAY);
 	file->unref();	// file is ref()'d by RomData.
 	if (!romData) {
 		// No RomData.
@@ -137,6 +137,11 @@ class GameCubePrivate final : public RomDataPrivate
 		vector<WiiPartEntry> wiiPtbl;
 		bool wiiPtblLoaded;
 
+		// Wii volume group table.
+		// Prefetched with the disc header for regular disc images.
+		RVL_VolumeGroupTable vgtbl;
+		bool hasVgtbl;
+
 		// Pointers to specific partitions within wiiPtbl.
 		WiiPartition *updatePartition;
 		WiiPartition *gamePartition;
@@ -217,12 +222,14 @@ GameCubePrivate::GameCubePrivate(GameCube *q, IRpFile *file)
 	, gcnRegion(~0)
 	, hasRegionCode(false)
 	, wiiPtblLoaded(false)
+	, hasVgtbl(false)
 	, updatePartition(nullptr)
 	, gamePartition(nullptr)
 {
 	// Clear the various structs.
 	memset(&discHeader, 0, sizeof(discHeader));
 	memset(&regionSetting, 0, sizeof(regionSetting));
+	memset(&vgtbl, 0, sizeof(vgtbl));
 	memset(&opening_bnr, 0, sizeof(opening_bnr));
 }
 
@@ -288,18 +295,22 @@ int GameCubePrivate::loadWiiPartitionTables(void)
 
 	// Assuming a maximum of 128 partitions per table.
 	// (This is a rather high estimate.)
-	RVL_VolumeGroupTable vgtbl;
 	array<RVL_PartitionTableEntry, 1024> pt;
 
-	// Read the volume group table.
+	// Read the volume group table, unless it was
+	// already read along with the disc header.
 	// References:
 	// - https://wiibrew.org/wiki/Wii_Disc#Partitions_information
 	// - http://blog.delroth.net/2011/06/reading-wii-discs-with-python/
-	size_t size = discReader->seekAndRead(RVL_VolumeGroupTable_ADDRESS, &vgtbl, sizeof(vgtbl));
-	if (size != sizeof(vgtbl)) {
-		// Could not read the volume group table.
-		// TODO: Return error from fread()?
-		return -EIO;
+	size_t size;
+	if (!hasVgtbl) {
+		size = discReader->seekAndRead(RVL_VolumeGroupTable_ADDRESS, &vgtbl, sizeof(vgtbl));
+		if (size != sizeof(vgtbl)) {
+			// Could not read the volume group table.
+			// TODO: Return error from fread()?
+			return -EIO;
+		}
+		hasVgtbl = true;
 	}
 
 	// Get the size of the disc image.
@@ -470,6 +481,9 @@ int GameCubePrivate::gcn_loadOpeningBnr(void)
 		gcnPartition->unref();
 		return -EIO;
 	}
+	if (metaDataOnly) {
+		bnr->setMetaDataOnly();
+	}
 
 	// GameCubeBNR subclass is open.
 	opening_bnr.gcn.partition = gcnPartition;
@@ -671,6 +685,10 @@ GameCube::GameCube(IRpFile *file)
 
 	// Read the disc header.
 	uint8_t header[4096+256];
+	// bi2.bin and RVL_RegionSetting may be read along with
+	// the disc header for regular disc images.
+	GCN_Boot_Info bootInfo;	// TODO: Save in GameCubePrivate?
+	bool hasBootInfo = false, hasRegionSetting = false;
 	d->file->rewind();
 	size_t size = d->file->read(&header, sizeof(header));
 	if (size != sizeof(header)) {
@@ -858,11 +876,47 @@ GameCube::GameCube(IRpFile *file)
 	d->discReader->rewind();
 	if ((d->discType & GameCubePrivate::DISC_FORMAT_MASK) != GameCubePrivate::DISC_FORMAT_PARTITION) {
 		// Regular disc image.
-		size = d->discReader->read(&d->discHeader, sizeof(d->discHeader));
-		if (size != sizeof(d->discHeader)) {
+		// The region code and Wii volume group table are at fixed
+		// addresses, so read them in the same batch as the disc header.
+		// The system type might not be known yet, so only skip the
+		// ones that are definitely not needed.
+		const unsigned int discSystem = (d->discType & GameCubePrivate::DISC_SYSTEM_MASK);
+		IDiscReader::ReadRequest reqs[4];
+		unsigned int reqCount = 0;
+		reqs[reqCount].pos = 0;
+		reqs[reqCount].ptr = &d->discHeader;
+		reqs[reqCount++].size = sizeof(d->discHeader);
+
+		const unsigned int bootInfoIdx = reqCount;
+		if (discSystem != GameCubePrivate::DISC_SYSTEM_WII) {
+			reqs[reqCount].pos = GCN_Boot_Info_ADDRESS;
+			reqs[reqCount].ptr = &bootInfo;
+			reqs[reqCount++].size = sizeof(bootInfo);
+		}
+		const unsigned int wiiIdx = reqCount;
+		if (discSystem == GameCubePrivate::DISC_SYSTEM_WII ||
+		    discSystem == GameCubePrivate::DISC_SYSTEM_UNKNOWN)
+		{
+			reqs[reqCount].pos = RVL_RegionSetting_ADDRESS;
+			reqs[reqCount].ptr = &d->regionSetting;
+			reqs[reqCount++].size = sizeof(d->regionSetting);
+			reqs[reqCount].pos = RVL_VolumeGroupTable_ADDRESS;
+			reqs[reqCount].ptr = &d->vgtbl;
+			reqs[reqCount++].size = sizeof(d->vgtbl);
+		}
+		d->discReader->readBatch(reqs, reqCount);
+
+		if (reqs[0].ret != sizeof(d->discHeader)) {
 			// Error reading the disc header.
 			goto notSupported;
 		}
+		if (bootInfoIdx < wiiIdx) {
+			hasBootInfo = (reqs[bootInfoIdx].ret == sizeof(bootInfo));
+		}
+		if (wiiIdx < reqCount) {
+			hasRegionSetting = (reqs[wiiIdx].ret == sizeof(d->regionSetting));
+			d->hasVgtbl = (reqs[wiiIdx+1].ret == sizeof(d->vgtbl));
+		}
 		d->hasRegionCode = true;
 	} else {
 		// Standalone partition.
@@ -1005,11 +1059,12 @@ GameCube::GameCube(IRpFile *file)
 	switch (d->discType & GameCubePrivate::DISC_SYSTEM_MASK) {
 		case GameCubePrivate::DISC_SYSTEM_GCN:
 		case GameCubePrivate::DISC_SYSTEM_TRIFORCE: {	// TODO?
-			GCN_Boot_Info bootInfo;	// TODO: Save in GameCubePrivate?
-			size = d->discReader->seekAndRead(GCN_Boot_Info_ADDRESS, &bootInfo, sizeof(bootInfo));
-			if (size != sizeof(bootInfo)) {
-				// Cannot read bi2.bin.
-				goto notSupported;
+			if (!hasBootInfo) {
+				size = d->discReader->seekAndRead(GCN_Boot_Info_ADDRESS, &bootInfo, sizeof(bootInfo));
+				if (size != sizeof(bootInfo)) {
+					// Cannot read bi2.bin.
+					goto notSupported;
+				}
 			}
 
 			d->gcnRegion = be32_to_cpu(bootInfo.region_code);
@@ -1020,10 +1075,12 @@ GameCube::GameCube(IRpFile *file)
 		case GameCubePrivate::DISC_SYSTEM_WII:
 			// TODO: Figure out region code for standalone partitions.
 			if (d->hasRegionCode) {
-				size = d->discReader->seekAndRead(RVL_RegionSetting_ADDRESS, &d->regionSetting, sizeof(d->regionSetting));
-				if (size != sizeof(d->regionSetting)) {
-					// Cannot read RVL_RegionSetting.
-					goto notSupported;
+				if (!hasRegionSetting) {
+					size = d->discReader->seekAndRead(RVL_RegionSetting_ADDRESS, &d->regionSetting, sizeof(d->regionSetting));
+					if (size != sizeof(d->regionSetting)) {
+						// Cannot read RVL_RegionSetting.
+						goto notSupported;
+					}
 				}
 
 				d->gcnRegion = be32_to_cpu(d->regionSetting.region_code);
@@ -2215,6 +2272,65 @@ int GameCube::extURLs(ImageType imageType, vector<ExtURL> *pExtURLs, int size) c
 	return 0;
 }
 
+/**
+ * Get the decrypted and/or decompressed views of this ROM image's contents.
+ * @return Content views. (empty if none are available)
+ */
+vector<RomData::ContentView> GameCube::contentViews(void)
+{
+	RP_D(GameCube);
+	vector<ContentView> views;
+	if (!d->isValid || !d->discReader || !d->discReader->isOpen()) {
+		// Disc image isn't valid.
+		return views;
+	}
+
+	switch (d->discType & GameCubePrivate::DISC_FORMAT_MASK) {
+		case GameCubePrivate::DISC_FORMAT_WBFS:
+		case GameCubePrivate::DISC_FORMAT_CISO:
+		case GameCubePrivate::DISC_FORMAT_NASOS:
+		case GameCubePrivate::DISC_FORMAT_GCZ: {
+			// Compressed disc image.
+			ContentView view;
+			view.name = C_("GameCube", "Disc image (decompressed)");
+			view.discReader = d->discReader->ref();
+			views.emplace_back(std::move(view));
+			break;
+		}
+		default:
+			break;
+	}
+
+	if ((d->discType & GameCubePrivate::DISC_SYSTEM_MASK) != GameCubePrivate::DISC_SYSTEM_WII ||
+	    d->loadWiiPartitionTables() != 0)
+	{
+		// Not a Wii disc, or the partition tables couldn't be loaded.
+		return views;
+	}
+
+	const auto wiiPtbl_cend = d->wiiPtbl.cend();
+	for (auto iter = d->wiiPtbl.cbegin(); iter != wiiPtbl_cend; ++iter) {
+		WiiPartition *const partition = iter->partition;
+		if (!partition || !partition->isOpen())
+			continue;
+
+		// Decryption is initialized on the first read.
+		uint8_t buf[4];
+		partition->seekAndRead(0, buf, sizeof(buf));
+		if (partition->verifyResult() != KeyManager::VerifyResult::OK) {
+			// Partition can't be decrypted.
+			continue;
+		}
+
+		ContentView view;
+		// tr: %1$u == volume group number, %2$u == partition number
+		view.name = rp_sprintf_p(C_("GameCube", "Partition %1$up%2$u (decrypted)"), iter->vg, iter->pt);
+		view.discReader = partition->ref();
+		views.emplace_back(std::move(view));
+	}
+	return views;
+}
+
 /**
  * Check for "viewed" achievements.
  *
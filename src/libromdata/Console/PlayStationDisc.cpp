@@ -316,9 +316,23 @@ PlayStationDisc::PlayStationDisc(IRpFile *file)
 
 	IDiscReader *discReader = nullptr;
 
+	// Read the PVD for each supported sector size at once:
+	// 2048-byte sectors, or 2352-byte or 2448-byte sectors.
+	static const unsigned int sector_sizes[] = {2352, 2448};
+	CDROM_2352_Sector_t sectors[ARRAY_SIZE(sector_sizes)];
+	IRpFile::ReadRequest reqs[1 + ARRAY_SIZE(sector_sizes)];
+	reqs[0].pos = ISO_PVD_ADDRESS_2048;
+	reqs[0].ptr = &d->pvd;
+	reqs[0].size = sizeof(d->pvd);
+	for (int i = 0; i < ARRAY_SIZE(sector_sizes); i++) {
+		reqs[i+1].pos = sector_sizes[i] * ISO_PVD_LBA;
+		reqs[i+1].ptr = &sectors[i];
+		reqs[i+1].size = sizeof(sectors[i]);
+	}
+	d->file->readBatch(reqs, ARRAY_SIZE(reqs));
+
 	// Check for a PVD with 2048-byte sectors.
-	size_t size = d->file->seekAndRead(ISO_PVD_ADDRESS_2048, &d->pvd, sizeof(d->pvd));
-	if (size != sizeof(d->pvd)) {
+	if (reqs[0].ret != sizeof(d->pvd)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
 	}
@@ -327,21 +341,17 @@ PlayStationDisc::PlayStationDisc(IRpFile *file)
 		discReader = new DiscReader(d->file);
 	} else {
 		// Check for a PVD with 2352-byte or 2448-byte sectors.
-		static const unsigned int sector_sizes[] = {2352, 2448, 0};
-		CDROM_2352_Sector_t sector;
-
-		for (const unsigned int *p = sector_sizes; *p != 0; p++) {
-			size_t size = d->file->seekAndRead(*p * ISO_PVD_LBA, &sector, sizeof(sector));
-			if (size != sizeof(d->pvd)) {
+		for (int i = 0; i < ARRAY_SIZE(sector_sizes); i++) {
+			if (reqs[i+1].ret != sizeof(sectors[i])) {
 				UNREF_AND_NULL_NOCHK(d->file);
 				return;
 			}
 
-			const uint8_t *const pData = cdromSectorDataPtr(&sector);
+			const uint8_t *const pData = cdromSectorDataPtr(&sectors[i]);
 			if (ISO::checkPVD(pData) >= 0) {
 				// Found the correct sector size.
 				memcpy(&d->pvd, pData, sizeof(d->pvd));
-				discReader = new Cdrom2352Reader(d->file, *p);
+				discReader = new Cdrom2352Reader(d->file, sector_sizes[i]);
 				break;
 			}
 		}
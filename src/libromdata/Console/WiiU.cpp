@@ -112,10 +112,19 @@ WiiU::WiiU(IRpFile *file)
 	// GCN/Wii magic numbers are not present.
 	static_assert(sizeof(GCN_DiscHeader) >= sizeof(WiiU_DiscHeader),
 		"GCN_DiscHeader is smaller than WiiU_DiscHeader.");
+	// The secondary magic number at 0x10000 is read in the same
+	// batch, since it's at the same address in unencrypted WUD.
 	uint8_t header[sizeof(GCN_DiscHeader)];
-	d->file->rewind();
-	size_t size = d->file->read(header, sizeof(header));
-	if (size != sizeof(header)) {
+	uint32_t disc_magic;
+	IRpFile::ReadRequest reqs[2];
+	reqs[0].pos = 0;
+	reqs[0].ptr = header;
+	reqs[0].size = sizeof(header);
+	reqs[1].pos = 0x10000;
+	reqs[1].ptr = &disc_magic;
+	reqs[1].size = sizeof(disc_magic);
+	d->file->readBatch(reqs, ARRAY_SIZE(reqs));
+	if (reqs[0].ret != sizeof(header)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
 	}
@@ -154,21 +163,21 @@ WiiU::WiiU(IRpFile *file)
 		return;
 	}
 
-	// Re-read the disc header for WUX.
+	// Re-read the disc header and secondary magic number for WUX.
+	size_t size = reqs[1].ret;
 	if (d->discType > WiiUPrivate::DiscType::WUD) {
-		size = d->discReader->seekAndRead(0, header, sizeof(header));
-		if (size != sizeof(header)) {
+		d->discReader->readBatch(reqs, ARRAY_SIZE(reqs));
+		if (reqs[0].ret != sizeof(header)) {
 			// Seek and/or read error.
 			UNREF_AND_NULL_NOCHK(d->discReader);
 			UNREF_AND_NULL_NOCHK(d->file);
 			d->discType = WiiUPrivate::DiscType::Unknown;
 			return;
 		}
+		size = reqs[1].ret;
 	}
 
 	// Verify the secondary magic number at 0x10000.
-	uint32_t disc_magic;
-	size = d->discReader->seekAndRead(0x10000, &disc_magic, sizeof(disc_magic));
 	if (size != sizeof(disc_magic)) {
 		// Seek and/or read error.
 		UNREF_AND_NULL_NOCHK(d->discReader);
@@ -636,4 +645,27 @@ int WiiU::extURLs(ImageType imageType, vector<ExtURL> *pExtURLs, int size) const
 	return 0;
 }
 
+/**
+ * Get the decrypted and/or decompressed views of this ROM image's contents.
+ * @return Content views. (empty if none are available)
+ */
+vector<RomData::ContentView> WiiU::contentViews(void)
+{
+	RP_D(WiiU);
+	vector<ContentView> views;
+	if (!d->isValid || d->discType != WiiUPrivate::DiscType::WUX ||
+	    !d->discReader || !d->discReader->isOpen())
+	{
+		// Only WUX images are compressed.
+		// NOTE: Wii U partitions aren't decrypted by WiiU.
+		return views;
+	}
+
+	ContentView view;
+	view.name = "Disc image (decompressed)";
+	view.discReader = d->discReader->ref();
+	views.emplace_back(std::move(view));
+	return views;
+}
+
 }
@@ -16,6 +16,7 @@ namespace LibRomData {
 ROMDATA_DECL_BEGIN(WiiU)
 ROMDATA_DECL_IMGSUPPORT()
 ROMDATA_DECL_IMGEXT()
+ROMDATA_DECL_CONTENT_VIEWS()
 ROMDATA_DECL_END()
 
 }
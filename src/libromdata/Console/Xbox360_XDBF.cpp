@@ -993,13 +993,13 @@ int Xbox360_XDBF_Private::addFields_achievements_SPA(void)
 	vector<string> *const v_xach_col_names = RomFields::strArrayToVector_i18n(
 		"Xbox360_XDBF|Achievements", xach_col_names, ARRAY_SIZE(xach_col_names));
 
-	// Vectors.
-	array<RomFields::ListData_t*, XDBF_LANGUAGE_MAX> pvv_xach;
-	pvv_xach[XDBF_LANGUAGE_UNKNOWN] = nullptr;
+	// List data builders.
+	// The strings are copied directly into the RomFields string arena.
+	array<unique_ptr<RomFields::ListDataBuilder>, XDBF_LANGUAGE_MAX> pvv_xach;
 	for (int langID = XDBF_LANGUAGE_ENGLISH; langID < XDBF_LANGUAGE_MAX; langID++) {
-		pvv_xach[langID] = (strTblIndexes[langID] >= 0)
-			? new RomFields::ListData_t(xach_count)
-			: nullptr;
+		if (strTblIndexes[langID] >= 0) {
+			pvv_xach[langID].reset(new RomFields::ListDataBuilder(fields, xach_count, 3));
+		}
 	}
 	auto vv_icons = new RomFields::ListDataIcons_t(xach_count);
 	auto icon_iter = vv_icons->begin();
@@ -1025,11 +1025,11 @@ int Xbox360_XDBF_Private::addFields_achievements_SPA(void)
 				// No strings for this language.
 				continue;
 			}
-			auto &data_row = pvv_xach[langID]->at(i);
-			data_row.reserve(3);
+			RomFields::ListDataBuilder *const data_row = pvv_xach[langID].get();
+			data_row->addRow();
 
 			// Achievement ID
-			data_row.emplace_back(s_achievement_id);
+			data_row->add(s_achievement_id);
 
 			// Title.
 			string desc = loadString_SPA((XDBF_Language_e)langID, name_id);
@@ -1061,22 +1061,21 @@ int Xbox360_XDBF_Private::addFields_achievements_SPA(void)
 			}
 
 			// TODO: Formatting value indicating that the first line should be bold.
-			data_row.emplace_back(std::move(desc));
+			data_row->add(desc);
 
 			// Gamerscore
-			data_row.emplace_back(s_gamerscore);
+			data_row->add(s_gamerscore);
 		}
 	}
 
-	// Add the vectors to a map.
-	RomFields::ListDataMultiMap_t *const mvv_xach = new RomFields::ListDataMultiMap_t();
+	// Add the rows to a map.
+	RomFields::ListDataViewMultiMap_t *const mvv_xach = new RomFields::ListDataViewMultiMap_t();
 	for (int langID = XDBF_LANGUAGE_ENGLISH; langID < XDBF_LANGUAGE_MAX; langID++) {
 		if (!pvv_xach[langID]) {
-			// No vector for this language.
+			// No builder for this language.
 			continue;
-		} else if (pvv_xach[langID]->empty()) {
+		} else if (pvv_xach[langID]->rowCount() == 0) {
 			// No string data.
-			delete pvv_xach[langID];
 			continue;
 		}
 
@@ -1084,12 +1083,10 @@ int Xbox360_XDBF_Private::addFields_achievements_SPA(void)
 		assert(lc != 0);
 		if (lc == 0) {
 			// Invalid language code.
-			delete pvv_xach[langID];
 			continue;
 		}
 
-		mvv_xach->insert(std::make_pair(lc, std::move(*pvv_xach[langID])));
-		delete pvv_xach[langID];
+		mvv_xach->insert(std::make_pair(lc, pvv_xach[langID]->release()));
 	}
 
 	// Add the list data.
@@ -1097,7 +1094,7 @@ int Xbox360_XDBF_Private::addFields_achievements_SPA(void)
 	                              RomFields::RFT_LISTDATA_ICONS |
 				      RomFields::RFT_LISTDATA_MULTI, 0);
 	params.headers = v_xach_col_names;
-	params.data.multi = mvv_xach;
+	params.view.multi = mvv_xach;
 	params.def_lc = getDefaultLC();
 	// TODO: Header alignment?
 	params.col_attrs.align_headers	= AFLD_ALIGN3(TXA_D, TXA_D, TXA_C);
@@ -1205,13 +1202,13 @@ int Xbox360_XDBF_Private::addFields_avatarAwards_SPA(void)
 	vector<string> *const v_xgaa_col_names = RomFields::strArrayToVector_i18n(
 		"Xbox360_XDBF|AvatarAwards", xgaa_col_names, ARRAY_SIZE(xgaa_col_names));
 
-	// Vectors.
-	array<RomFields::ListData_t*, XDBF_LANGUAGE_MAX> pvv_xgaa;
-	pvv_xgaa[XDBF_LANGUAGE_UNKNOWN] = nullptr;
+	// List data builders.
+	// The strings are copied directly into the RomFields string arena.
+	array<unique_ptr<RomFields::ListDataBuilder>, XDBF_LANGUAGE_MAX> pvv_xgaa;
 	for (int langID = XDBF_LANGUAGE_ENGLISH; langID < XDBF_LANGUAGE_MAX; langID++) {
-		pvv_xgaa[langID] = (strTblIndexes[langID] >= 0)
-			? new RomFields::ListData_t(xgaa_count)
-			: nullptr;
+		if (strTblIndexes[langID] >= 0) {
+			pvv_xgaa[langID].reset(new RomFields::ListDataBuilder(fields, xgaa_count, 2));
+		}
 	}
 	auto vv_icons = new RomFields::ListDataIcons_t(xgaa_count);
 	auto icon_iter = vv_icons->begin();
@@ -1236,11 +1233,11 @@ int Xbox360_XDBF_Private::addFields_avatarAwards_SPA(void)
 				// No strings for this language.
 				continue;
 			}
-			auto &data_row = pvv_xgaa[langID]->at(i);
-			data_row.reserve(2);
+			RomFields::ListDataBuilder *const data_row = pvv_xgaa[langID].get();
+			data_row->addRow();
 
 			// Avatar award ID
-			data_row.emplace_back(s_avatar_award_id);
+			data_row->add(s_avatar_award_id);
 
 			// Title.
 			string desc = loadString_SPA((XDBF_Language_e)langID, name_id);
@@ -1272,19 +1269,18 @@ int Xbox360_XDBF_Private::addFields_avatarAwards_SPA(void)
 			}
 
 			// TODO: Formatting value indicating that the first line should be bold.
-			data_row.emplace_back(std::move(desc));
+			data_row->add(desc);
 		}
 	}
 
-	// Add the vectors to a map.
-	RomFields::ListDataMultiMap_t *const mvv_xgaa = new RomFields::ListDataMultiMap_t();
+	// Add the rows to a map.
+	RomFields::ListDataViewMultiMap_t *const mvv_xgaa = new RomFields::ListDataViewMultiMap_t();
 	for (int langID = XDBF_LANGUAGE_ENGLISH; langID < XDBF_LANGUAGE_MAX; langID++) {
 		if (!pvv_xgaa[langID]) {
-			// No vector for this language.
+			// No builder for this language.
 			continue;
-		} else if (pvv_xgaa[langID]->empty()) {
+		} else if (pvv_xgaa[langID]->rowCount() == 0) {
 			// No string data.
-			delete pvv_xgaa[langID];
 			continue;
 		}
 
@@ -1292,12 +1288,10 @@ int Xbox360_XDBF_Private::addFields_avatarAwards_SPA(void)
 		assert(lc != 0);
 		if (lc == 0) {
 			// Invalid language code.
-			delete pvv_xgaa[langID];
 			continue;
 		}
 
-		mvv_xgaa->insert(std::make_pair(lc, std::move(*pvv_xgaa[langID])));
-		delete pvv_xgaa[langID];
+		mvv_xgaa->insert(std::make_pair(lc, pvv_xgaa[langID]->release()));
 	}
 
 	// Add the list data.
@@ -1311,7 +1305,7 @@ int Xbox360_XDBF_Private::addFields_avatarAwards_SPA(void)
 	params.col_attrs.sorting	= AFLD_ALIGN2(COLSORT_NUM, COLSORT_STD);
 	params.col_attrs.sort_col	= 0;	// ID
 	params.col_attrs.sort_dir	= RomFields::COLSORTORDER_ASCENDING;
-	params.data.multi = mvv_xgaa;
+	params.view.multi = mvv_xgaa;
 	params.mxd.icons = vv_icons;
 	fields->addField_listData(C_("Xbox360_XDBF", "Avatar Awards"), &params);
 	return 0;
@@ -1431,9 +1425,9 @@ int Xbox360_XDBF_Private::addFields_achievements_GPD(void)
 	vector<string> *const v_xach_col_names = RomFields::strArrayToVector_i18n(
 		"Xbox360_XDBF|Achievements", xach_col_names, ARRAY_SIZE(xach_col_names));
 
-	RomFields::ListData_t *vv_xach = new RomFields::ListData_t();
+	// The strings are copied directly into the RomFields string arena.
+	RomFields::ListDataBuilder vv_xach(fields, 16, 3);
 	auto vv_icons = new RomFields::ListDataIcons_t();
-	vv_xach->reserve(16);
 	vv_icons->reserve(16);
 
 	// GPD doesn't have an achievements table.
@@ -1530,19 +1524,16 @@ int Xbox360_XDBF_Private::addFields_achievements_GPD(void)
 		}
 
 		// Add to RFT_LISTDATA.
-		vector<string> data_row;
-		data_row.reserve(3);
-		data_row.emplace_back(s_achievement_id);
-		data_row.emplace_back(std::move(desc));
-		data_row.emplace_back(s_gamerscore);
-		vv_xach->emplace_back(std::move(data_row));
+		vv_xach.addRow();
+		vv_xach.add(s_achievement_id);
+		vv_xach.add(desc);
+		vv_xach.add(s_gamerscore);
 	}
 
 	// FIXME: Figure out why Dolphin segfaults if the list is empty.
-	if (vv_xach->empty()) {
+	if (vv_xach.rowCount() == 0) {
 		// No achievements.
 		delete v_xach_col_names;
-		delete vv_xach;
 		delete vv_icons;
 		return -ENOENT;
 	}
@@ -1551,7 +1542,7 @@ int Xbox360_XDBF_Private::addFields_achievements_GPD(void)
 	RomFields::AFLD_PARAMS params(RomFields::RFT_LISTDATA_SEPARATE_ROW |
 	                              RomFields::RFT_LISTDATA_ICONS, 0);
 	params.headers = v_xach_col_names;
-	params.data.single = vv_xach;
+	params.view.single = new RomFields::ListDataView_t(vv_xach.release());
 	params.def_lc = getDefaultLC();
 	// TODO: Header alignment?
 	params.col_attrs.align_headers	= AFLD_ALIGN3(TXA_D, TXA_D, TXA_C);
@@ -1275,6 +1275,9 @@ const Xbox360_XDBF *Xbox360_XEX_Private::initXDBF(void)
 		// FIXME: XEX1 XDBF is either encrypted or garbage...
 		Xbox360_XDBF *const pe_xdbf_tmp = new Xbox360_XDBF(peFile_tmp, true);
 		if (pe_xdbf_tmp->isOpen()) {
+			if (metaDataOnly) {
+				pe_xdbf_tmp->setMetaDataOnly();
+			}
 			pe_xdbf = pe_xdbf_tmp;
 		} else {
 			pe_xdbf_tmp->unref();
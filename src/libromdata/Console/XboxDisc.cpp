@@ -28,6 +28,7 @@ using LibRpTexture::rp_image;
 
 // C++ STL classes.
 using std::string;
+using std::unique_ptr;
 using std::vector;
 
 namespace LibRomData {
@@ -172,6 +173,9 @@ RomData *XboxDiscPrivate::openDefaultExe(ExeType *pExeType)
 		f_defaultExe->unref();
 		if (xexData->isValid()) {
 			// default.xex is open and valid.
+			if (metaDataOnly) {
+				xexData->setMetaDataOnly();
+			}
 			defaultExeData = xexData;
 			exeType = ExeType::XEX;
 			if (pExeType) {
@@ -189,6 +193,9 @@ RomData *XboxDiscPrivate::openDefaultExe(ExeType *pExeType)
 		f_defaultExe->unref();
 		if (xbeData->isValid()) {
 			// default.xbe is open and valid.
+			if (metaDataOnly) {
+				xbeData->setMetaDataOnly();
+			}
 			defaultExeData = xbeData;
 			exeType = ExeType::XBE;
 			if (pExeType) {
@@ -304,9 +311,33 @@ XboxDisc::XboxDisc(IRpFile *file)
 
 	// Read the ISO-9660 PVD.
 	// NOTE: Only 2048-byte sectors, since this is DVD.
+	// For image files, the XDVDFS header can only be at a few
+	// fixed addresses, one per disc type, so read all of them
+	// in the same batch. (Kreon drives must be unlocked before
+	// the XDVDFS header can be read.)
+	static const unsigned int xdvdfs_lba[] = {
+		0,			// Extracted XDVDFS
+		XDVDFS_LBA_OFFSET_XGD1,	// XGD1
+		XDVDFS_LBA_OFFSET_XGD2,	// XGD2
+		XDVDFS_LBA_OFFSET_XGD3,	// XGD3
+	};
 	ISO_Primary_Volume_Descriptor pvd;
-	size_t size = d->file->seekAndRead(ISO_PVD_ADDRESS_2048, &pvd, sizeof(pvd));
-	if (size != sizeof(pvd)) {
+	unique_ptr<XDVDFS_Header[]> xdvdfsHeaders;
+	IRpFile::ReadRequest reqs[1 + ARRAY_SIZE(xdvdfs_lba)];
+	unsigned int reqCount = 1;
+	reqs[0].pos = ISO_PVD_ADDRESS_2048;
+	reqs[0].ptr = &pvd;
+	reqs[0].size = sizeof(pvd);
+	if (!d->file->isDevice()) {
+		xdvdfsHeaders.reset(new XDVDFS_Header[ARRAY_SIZE(xdvdfs_lba)]);
+		for (unsigned int i = 0; i < ARRAY_SIZE(xdvdfs_lba); i++, reqCount++) {
+			reqs[reqCount].pos = static_cast<off64_t>(xdvdfs_lba[i] + XDVDFS_HEADER_LBA_OFFSET) * XDVDFS_BLOCK_SIZE;
+			reqs[reqCount].ptr = &xdvdfsHeaders[i];
+			reqs[reqCount].size = sizeof(XDVDFS_Header);
+		}
+	}
+	d->file->readBatch(reqs, reqCount);
+	if (reqs[0].ret != sizeof(pvd)) {
 		UNREF_AND_NULL_NOCHK(d->file);
 		return;
 	}
@@ -374,7 +405,17 @@ XboxDisc::XboxDisc(IRpFile *file)
 		d->isKreon = false;
 		return;
 	}
-	d->xdvdfsPartition = new XDVDFSPartition(d->discReader, d->xdvdfs_addr, d->file->size() - d->xdvdfs_addr);
+	const XDVDFS_Header *pXdvdfsHeader = nullptr;
+	if (xdvdfsHeaders) {
+		// Use the XDVDFS header that was read with the PVD.
+		const int idx = (d->discType > XboxDiscPrivate::DiscType::Unknown)
+			? static_cast<int>(d->discType) : 0;
+		assert(xdvdfs_lba[idx] * XDVDFS_BLOCK_SIZE == d->xdvdfs_addr);
+		if (reqs[idx+1].ret == sizeof(XDVDFS_Header)) {
+			pXdvdfsHeader = &xdvdfsHeaders[idx];
+		}
+	}
+	d->xdvdfsPartition = new XDVDFSPartition(d->discReader, d->xdvdfs_addr, d->file->size() - d->xdvdfs_addr, pXdvdfsHeader);
 	if (!d->xdvdfsPartition->isOpen()) {
 		// Unable to open the XDVDFSPartition.
 		UNREF_AND_NULL_NOCHK(d->xdvdfsPartition);
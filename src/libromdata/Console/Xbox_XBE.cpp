@@ -168,11 +168,17 @@ int Xbox_XBE_Private::findXbeSectionHeader(const char *name, XBE_Section_Header
 	}
 
 	// Read the XBE header.
-	unique_ptr<uint8_t[]> first64KB(new uint8_t[XBE_READ_SIZE]);
-	size_t size = file->seekAndRead(0, first64KB.get(), XBE_READ_SIZE);
-	if (size != XBE_READ_SIZE) {
-		// Seek and/or read error.
-		return -EIO;
+	// If the file is memory-mapped, the data is used in place.
+	unique_ptr<uint8_t[]> first64KB_buf;
+	const uint8_t *first64KB = file->dataPtr(0, XBE_READ_SIZE);
+	if (!first64KB) {
+		first64KB_buf.reset(new uint8_t[XBE_READ_SIZE]);
+		size_t size = file->seekAndRead(0, first64KB_buf.get(), XBE_READ_SIZE);
+		if (size != XBE_READ_SIZE) {
+			// Seek and/or read error.
+			return -EIO;
+		}
+		first64KB = first64KB_buf.get();
 	}
 
 	// Section count.
@@ -201,10 +207,16 @@ int Xbox_XBE_Private::findXbeSectionHeader(const char *name, XBE_Section_Header
 		}
 
 		// Read the name.
-		size = file->seekAndRead(name_address - base_address, section_name, sizeof(section_name));
-		if (size != sizeof(section_name)) {
-			// Seek and/or read error.
-			return -EIO;
+		// Section names are usually within the first 64 KB.
+		const uint32_t name_address_phys = name_address - base_address;
+		if (name_address_phys <= XBE_READ_SIZE - sizeof(section_name)) {
+			memcpy(section_name, &first64KB[name_address_phys], sizeof(section_name));
+		} else {
+			size_t size = file->seekAndRead(name_address_phys, section_name, sizeof(section_name));
+			if (size != sizeof(section_name)) {
+				// Seek and/or read error.
+				return -EIO;
+			}
 		}
 		section_name[sizeof(section_name)-1] = '\0';
 
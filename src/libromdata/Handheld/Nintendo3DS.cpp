@@ -205,6 +205,9 @@ int Nintendo3DSPrivate::loadSMDH(void)
 	}
 
 	// Loaded the SMDH section.
+	if (metaDataOnly) {
+		smdhData->setMetaDataOnly();
+	}
 	headers_loaded |= HEADER_SMDH;
 	this->mainContent = smdhData;
 	return 0;
@@ -615,6 +618,9 @@ int Nintendo3DSPrivate::openSRL(void)
 
 	if (srlData && srlData->isOpen() && srlData->isValid()) {
 		// SRL opened successfully.
+		if (metaDataOnly) {
+			srlData->setMetaDataOnly();
+		}
 		this->mainContent = srlData;
 	} else {
 		// Failed to open the SRL.
@@ -2757,6 +2763,86 @@ bool Nintendo3DS::hasDangerousPermissions(void) const
 	return d->perm.isDangerous;
 }
 
+/**
+ * Get the decrypted and/or decompressed views of this ROM image's contents.
+ * @return Content views. (empty if none are available)
+ */
+vector<RomData::ContentView> Nintendo3DS::contentViews(void)
+{
+	RP_D(Nintendo3DS);
+	vector<ContentView> views;
+	if (!d->isValid || !d->file) {
+		// ROM image isn't valid.
+		return views;
+	}
+
+	// Content/partition indexes to check.
+	vector<int> idxs;
+	const char *name_fmt;
+	switch (d->romType) {
+		case Nintendo3DSPrivate::RomType::CIA:
+			if (d->loadTicketAndTMD() != 0) {
+				// Unable to load the ticket and TMD.
+				return views;
+			}
+			idxs.reserve(d->content_chunks.size());
+			for (auto iter = d->content_chunks.cbegin();
+			     iter != d->content_chunks.cend(); ++iter)
+			{
+				idxs.emplace_back(be16_to_cpu(iter->index));
+			}
+			// tr: %d == content index
+			name_fmt = C_("Nintendo3DS", "Content %d (decrypted)");
+			break;
+		case Nintendo3DSPrivate::RomType::CCI:
+			for (int i = 0; i < 8; i++) {
+				if (d->mxh.ncsd_header.partitions[i].length != 0) {
+					idxs.emplace_back(i);
+				}
+			}
+			// tr: %d == partition index
+			name_fmt = C_("Nintendo3DS", "Partition %d (decrypted)");
+			break;
+		case Nintendo3DSPrivate::RomType::NCCH:
+			idxs.emplace_back(0);
+			name_fmt = nullptr;
+			break;
+		default:
+			// No decrypted views.
+			return views;
+	}
+
+	const auto idxs_cend = idxs.cend();
+	for (auto iter = idxs.cbegin(); iter != idxs_cend; ++iter) {
+		NCCHReader *ncch = nullptr;
+		d->loadNCCH(*iter, &ncch);
+		if (!ncch || !ncch->isOpen() ||
+		    ncch->verifyResult() != KeyManager::VerifyResult::OK)
+		{
+			// NCCH can't be decrypted.
+			UNREF(ncch);
+			continue;
+		}
+
+		if (d->romType == Nintendo3DSPrivate::RomType::NCCH) {
+			// A standalone NCCH is only useful if it's encrypted.
+			NCCHReader::CryptoType cryptoType;
+			if (ncch->cryptoType(&cryptoType) != 0 || !cryptoType.encrypted) {
+				ncch->unref();
+				continue;
+			}
+		}
+
+		ContentView view;
+		view.name = (name_fmt
+			? rp_sprintf(name_fmt, *iter)
+			: C_("Nintendo3DS", "NCCH (decrypted)"));
+		view.discReader = ncch;
+		views.emplace_back(std::move(view));
+	}
+	return views;
+}
+
 /**
  * Check for "viewed" achievements.
  *
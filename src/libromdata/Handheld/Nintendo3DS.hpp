@@ -24,6 +24,7 @@ ROMDATA_DECL_IMGINT()
 ROMDATA_DECL_ICONANIM()
 ROMDATA_DECL_IMGEXT()
 ROMDATA_DECL_ROMOPS()
+ROMDATA_DECL_CONTENT_VIEWS()
 ROMDATA_DECL_VIEWED_ACHIEVEMENTS()
 ROMDATA_DECL_END()
 
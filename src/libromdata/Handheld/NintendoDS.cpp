@@ -77,7 +77,10 @@ int NintendoDSPrivate::loadIconTitleData(void)
 	}
 
 	// Read the icon/title data.
-	size_t size = this->file->seekAndRead(icon_offset, &nds_icon_title, sizeof(nds_icon_title));
+	// In metadata-only mode, the DSi animated icon isn't needed,
+	// so only read up to the end of the titles.
+	const size_t read_size = (metaDataOnly ? static_cast<size_t>(NDS_ICON_SIZE_HANS_KO) : sizeof(nds_icon_title));
+	size_t size = this->file->seekAndRead(icon_offset, &nds_icon_title, read_size);
 
 	// Make sure we have the correct size based on the version.
 	if (size < sizeof(nds_icon_title.version)) {
@@ -104,7 +107,7 @@ int NintendoDSPrivate::loadIconTitleData(void)
 			return -EIO;
 	}
 
-	if (size < req_size) {
+	if (size < std::min<size_t>(req_size, read_size)) {
 		// Error reading the icon data.
 		return -EIO;
 	}
@@ -123,8 +126,9 @@ const rp_image *NintendoDSPrivate::loadIcon(void)
 	if (icon_first_frame) {
 		// Icon has already been loaded.
 		return icon_first_frame;
-	} else if (!this->file || !this->isValid) {
+	} else if (!this->file || !this->isValid || metaDataOnly) {
 		// Can't load the icon.
+		// (Icons aren't loaded in metadata-only mode.)
 		return nullptr;
 	}
 
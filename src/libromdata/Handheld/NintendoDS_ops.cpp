@@ -57,11 +57,20 @@ uint32_t NintendoDSPrivate::checkNDSSecurityData(void)
 		return ret;
 	}
 
-	uint32_t security_data[0x3000/4];
-	size_t size = file->seekAndRead(0x1000, security_data, sizeof(security_data));
-	if (size != sizeof(security_data)) {
-		// Seek and/or read error.
-		return 0;
+	// If the file is memory-mapped, check the security data in place.
+	// Otherwise, read it into a local buffer.
+	uint32_t secbuf[0x3000/4];
+	const uint32_t *security_data;
+	const uint8_t *const pMapped = file->dataPtr(0x1000, sizeof(secbuf));
+	if (pMapped && (reinterpret_cast<uintptr_t>(pMapped) % sizeof(uint32_t)) == 0) {
+		security_data = reinterpret_cast<const uint32_t*>(pMapped);
+	} else {
+		size_t size = file->seekAndRead(0x1000, secbuf, sizeof(secbuf));
+		if (size != sizeof(secbuf)) {
+			// Seek and/or read error.
+			return 0;
+		}
+		security_data = secbuf;
 	}
 
 	// Check the S-Box and Blowfish tables for non-zero data.
@@ -555,13 +564,7 @@ int NintendoDS::doRomOp_int(int id, RomOpParams *pParams)
 					field->data.bitfield = d->secData;
 				}
 				if (d->fieldIdx_secArea >= 0) {
-					field = const_cast<RomFields::Field*>(d->fields->at(d->fieldIdx_secArea));
-					const char *const s_secArea = d->getNDSSecureAreaString();
-					if (field->data.str) {
-						const_cast<string*>(field->data.str)->assign(s_secArea);
-					} else {
-						field->data.str = new string(s_secArea);
-					}
+					d->fields->changeField_string(d->fieldIdx_secArea, d->getNDSSecureAreaString());
 				}
 			}
 
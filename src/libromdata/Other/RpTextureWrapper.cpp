@@ -126,16 +126,16 @@ int RpTextureWrapper::isRomSupported_static(const DetectInfo *info)
 	assert(info->header.addr == 0);
 	if (!info || !info->header.pData ||
 	    info->header.addr != 0 ||
-	    info->header.size < sizeof(uint32_t))
+	    info->header.size < sizeof(uint32_t)*2)
 	{
 		// Either no detection information was specified,
 		// or the header is too small.
 		return -1;
 	}
 
-	// TODO: FileFormatFactory::isTextureSupported()
-	// For now, delegate to FileFormatFactory::create().
-	return 0;
+	// Check the magic number without creating a FileFormat object.
+	// The full check is done by FileFormatFactory::create().
+	return (FileFormatFactory::isTextureSupported(info->header.pData, info->header.size) ? 0 : -1);
 }
 
 /**
@@ -361,4 +361,47 @@ int RpTextureWrapper::loadInternalImage(ImageType imageType, const rp_image **pI
 		d->texture->image);	// func
 }
 
+/**
+ * Load an internal image for the specified thumbnail size.
+ * Called by RomData::imageForSize().
+ *
+ * This uses the smallest mipmap whose largest dimension
+ * is at least reqSize.
+ *
+ * @param imageType	[in] Image type to load.
+ * @param reqSize	[in] Requested image size.
+ * @param pImage	[out] Pointer to const rp_image* to store the image in.
+ * @param pFullSize	[out] Two-element array for the full-size image's [width, height].
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpTextureWrapper::loadInternalImageForSize(ImageType imageType, int reqSize,
+	const rp_image **pImage, int pFullSize[2])
+{
+	ASSERT_loadInternalImage(imageType, pImage);
+	RP_D(RpTextureWrapper);
+	if (imageType != IMG_INT_IMAGE) {
+		*pImage = nullptr;
+		return -ENOENT;
+	} else if (!d->file) {
+		*pImage = nullptr;
+		return -EBADF;
+	} else if (!d->isValid) {
+		*pImage = nullptr;
+		return -EIO;
+	}
+
+	*pImage = d->texture->imageForSize(reqSize);
+	if (!*pImage) {
+		return -EIO;
+	}
+	// NOTE: 1D textures have a height of 0.
+	pFullSize[0] = d->texture->width();
+	pFullSize[1] = d->texture->height();
+	if (pFullSize[0] <= 0 || pFullSize[1] <= 0) {
+		pFullSize[0] = (*pImage)->width();
+		pFullSize[1] = (*pImage)->height();
+	}
+	return 0;
+}
+
 }
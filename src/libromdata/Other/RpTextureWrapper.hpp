@@ -19,6 +19,24 @@ ROMDATA_DECL_METADATA()
 ROMDATA_DECL_IMGSUPPORT()
 ROMDATA_DECL_IMGPF()
 ROMDATA_DECL_IMGINT()
+
+	public:
+		/**
+		 * Load an internal image for the specified thumbnail size.
+		 * Called by RomData::imageForSize().
+		 *
+		 * This uses the smallest mipmap whose largest dimension
+		 * is at least reqSize.
+		 *
+		 * @param imageType	[in] Image type to load.
+		 * @param reqSize	[in] Requested image size.
+		 * @param pImage	[out] Pointer to const rp_image* to store the image in.
+		 * @param pFullSize	[out] Two-element array for the full-size image's [width, height].
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int loadInternalImageForSize(ImageType imageType, int reqSize,
+			const LibRpTexture::rp_image **pImage, int pFullSize[2]) final;
+
 ROMDATA_DECL_END()
 
 }
@@ -181,6 +181,61 @@ class RomDataFactoryPrivate
 		 */
 		static RomData *openDreamcastVMSandVMI(IRpFile *file);
 
+		// Magic number dispatch index.
+		// Entries are sorted by address, then magic number,
+		// then romDataFns_magic[] index, so all subclasses that
+		// match a given magic number can be found with a single
+		// binary search while preserving the table's priority.
+		struct MagicIdx {
+			uint32_t address;
+			uint32_t magic;
+			unsigned int idx;	// Index in romDataFns_magic[].
+
+			inline bool operator<(const MagicIdx &other) const
+			{
+				if (address != other.address)
+					return (address < other.address);
+				if (magic != other.magic)
+					return (magic < other.magic);
+				return (idx < other.idx);
+			}
+		};
+		static vector<MagicIdx> vec_magicIdx;
+		// Distinct magic number addresses, sorted.
+		static vector<uint32_t> vec_magicAddrs;
+
+		// File extension dispatch index for RomData subclasses
+		// that read data from somewhere other than the header
+		// at address 0. These can't be detected from the
+		// initial header read, so the file extension is used
+		// to determine which subclasses need to be checked.
+		// - Key: Lowercase file extension, including the leading dot.
+		// - Value: Matching subclasses, in table order.
+		// NOTE: ".bin" matches all header subclasses with non-zero addresses.
+		static unordered_map<string, vector<const RomDataFns*> > map_extIdx_header;
+		static unordered_map<string, vector<const RomDataFns*> > map_extIdx_footer;
+
+		// pthread_once() control variable.
+		static pthread_once_t once_dispatchIdx;
+
+		/**
+		 * Initialize the magic number and file extension dispatch indexes.
+		 *
+		 * Internal function; must be called using pthread_once().
+		 */
+		static void init_dispatchIdx(void);
+
+		/**
+		 * Look up a file extension in a file extension dispatch index.
+		 * init_dispatchIdx() must have been called first.
+		 * @param map_extIdx File extension dispatch index.
+		 * @param ext File extension, including the leading dot. (may be nullptr)
+		 * @return Matching subclasses, or nullptr if none match.
+		 */
+		static const vector<const RomDataFns*> *lookupExt(
+			const unordered_map<string, vector<const RomDataFns*> > &map_extIdx,
+			const char *ext);
+
 		// Vectors for file extensions and MIME types.
 		// We want to collect them once per session instead of
 		// repeatedly collecting them, since the caller might
@@ -220,6 +275,16 @@ class RomDataFactoryPrivate
 		 * @return Game-specific RomData subclass, or nullptr if none are supported.
 		 */
 		static RomData *checkISO(IRpFile *file);
+
+		/**
+		 * Create a RomData subclass for the specified ROM file.
+		 * Internal implementation of RomDataFactory::create().
+		 *
+		 * @param file ROM file.
+		 * @param attrs RomDataAttr bitfield. (RDA_METADATA_ONLY must not be set)
+		 * @return RomData subclass, or nullptr if the ROM isn't supported.
+		 */
+		static RomData *create(IRpFile *file, unsigned int attrs);
 };
 
 /** RomDataFactoryPrivate **/
@@ -229,6 +294,12 @@ vector<const char*> RomDataFactoryPrivate::vec_mimeTypes;
 pthread_once_t RomDataFactoryPrivate::once_exts = PTHREAD_ONCE_INIT;
 pthread_once_t RomDataFactoryPrivate::once_mimeTypes = PTHREAD_ONCE_INIT;
 
+vector<RomDataFactoryPrivate::MagicIdx> RomDataFactoryPrivate::vec_magicIdx;
+vector<uint32_t> RomDataFactoryPrivate::vec_magicAddrs;
+unordered_map<string, vector<const RomDataFactoryPrivate::RomDataFns*> > RomDataFactoryPrivate::map_extIdx_header;
+unordered_map<string, vector<const RomDataFactoryPrivate::RomDataFns*> > RomDataFactoryPrivate::map_extIdx_footer;
+pthread_once_t RomDataFactoryPrivate::once_dispatchIdx = PTHREAD_ONCE_INIT;
+
 #define ATTR_NONE		RomDataFactory::RDA_NONE
 #define ATTR_HAS_THUMBNAIL	RomDataFactory::RDA_HAS_THUMBNAIL
 #define ATTR_HAS_DPOVERLAY	RomDataFactory::RDA_HAS_DPOVERLAY
@@ -434,6 +505,93 @@ RomData *RomDataFactoryPrivate::openDreamcastVMSandVMI(IRpFile *file)
 	return dcSave;
 }
 
+/**
+ * Initialize the magic number and file extension dispatch indexes.
+ *
+ * Internal function; must be called using pthread_once().
+ */
+void RomDataFactoryPrivate::init_dispatchIdx(void)
+{
+	// Magic number index.
+	vec_magicIdx.reserve(ARRAY_SIZE(romDataFns_magic) - 1);
+	for (unsigned int i = 0; romDataFns_magic[i].supportedFileExtensions != nullptr; i++) {
+		const RomDataFns *const fns = &romDataFns_magic[i];
+		MagicIdx magicIdx;
+		magicIdx.address = fns->address;
+		magicIdx.magic = fns->size;
+		magicIdx.idx = i;
+		vec_magicIdx.emplace_back(magicIdx);
+
+		auto iter = std::find(vec_magicAddrs.cbegin(), vec_magicAddrs.cend(), fns->address);
+		if (iter == vec_magicAddrs.cend()) {
+			vec_magicAddrs.emplace_back(fns->address);
+		}
+	}
+	std::sort(vec_magicIdx.begin(), vec_magicIdx.end());
+	std::sort(vec_magicAddrs.begin(), vec_magicAddrs.end());
+
+	// File extension indexes.
+	// NOTE: Only header subclasses with non-zero addresses
+	// are indexed here. Subclasses with headers at 0 are
+	// always checked, since they don't need any extra reads.
+	auto addExts = [](unordered_map<string, vector<const RomDataFns*> > &map_extIdx, const RomDataFns *fns) {
+		const char *const *sys_exts = fns->supportedFileExtensions();
+		if (!sys_exts)
+			return;
+
+		for (; *sys_exts != nullptr; sys_exts++) {
+			string ext(*sys_exts);
+			std::transform(ext.begin(), ext.end(), ext.begin(),
+				[](unsigned char c) { return std::tolower(c); });
+			vector<const RomDataFns*> &vec = map_extIdx[ext];
+			if (vec.empty() || vec.back() != fns) {
+				vec.emplace_back(fns);
+			}
+		}
+	};
+
+	// Generic ".bin" files could be anything, so all header
+	// subclasses with non-zero addresses are checked for ".bin",
+	// even if they don't list it in their own file extensions.
+	vector<const RomDataFns*> &vec_bin = map_extIdx_header[".bin"];
+	for (const RomDataFns *fns = &romDataFns_header[0];
+	     fns->supportedFileExtensions != nullptr; fns++)
+	{
+		if (fns->address != 0) {
+			addExts(map_extIdx_header, fns);
+			if (vec_bin.empty() || vec_bin.back() != fns) {
+				vec_bin.emplace_back(fns);
+			}
+		}
+	}
+	for (const RomDataFns *fns = &romDataFns_footer[0];
+	     fns->supportedFileExtensions != nullptr; fns++)
+	{
+		addExts(map_extIdx_footer, fns);
+	}
+}
+
+/**
+ * Look up a file extension in a file extension dispatch index.
+ * init_dispatchIdx() must have been called first.
+ * @param map_extIdx File extension dispatch index.
+ * @param ext File extension, including the leading dot. (may be nullptr)
+ * @return Matching subclasses, or nullptr if none match.
+ */
+const vector<const RomDataFactoryPrivate::RomDataFns*> *RomDataFactoryPrivate::lookupExt(
+	const unordered_map<string, vector<const RomDataFns*> > &map_extIdx,
+	const char *ext)
+{
+	if (!ext || ext[0] == '\0')
+		return nullptr;
+
+	string s_ext(ext);
+	std::transform(s_ext.begin(), s_ext.end(), s_ext.begin(),
+		[](unsigned char c) { return std::tolower(c); });
+	auto iter = map_extIdx.find(s_ext);
+	return (iter != map_extIdx.end() ? &iter->second : nullptr);
+}
+
 /**
  * Check an ISO-9660 disc image for a game-specific file system.
  *
@@ -538,24 +696,15 @@ RomData *RomDataFactoryPrivate::checkISO(IRpFile *file)
 	return new ISO(file);
 }
 
-/** RomDataFactory **/
-
 /**
  * Create a RomData subclass for the specified ROM file.
- *
- * NOTE: RomData::isValid() is checked before returning a
- * created RomData instance, so returned objects can be
- * assumed to be valid as long as they aren't nullptr.
- *
- * If imgbf is non-zero, at least one of the specified image
- * types must be supported by the RomData subclass in order to
- * be returned.
+ * Internal implementation of RomDataFactory::create().
  *
  * @param file ROM file.
- * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+ * @param attrs RomDataAttr bitfield. (RDA_METADATA_ONLY must not be set)
  * @return RomData subclass, or nullptr if the ROM isn't supported.
  */
-RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
+RomData *RomDataFactoryPrivate::create(IRpFile *file, unsigned int attrs)
 {
 	RomData::DetectInfo info;
 
@@ -617,23 +766,52 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 		// Not a .VMI+.VMS pair.
 	}
 
+	// Make sure the dispatch indexes are initialized.
+	pthread_once(&RomDataFactoryPrivate::once_dispatchIdx, RomDataFactoryPrivate::init_dispatchIdx);
+
 	// Check RomData subclasses that take a header at 0
 	// and definitely have a 32-bit magic number in the header.
-	const RomDataFactoryPrivate::RomDataFns *fns =
-		&RomDataFactoryPrivate::romDataFns_magic[0];
-	for (; fns->supportedFileExtensions != nullptr; fns++) {
-		if ((fns->attrs & attrs) != attrs) {
-			// This RomData subclass doesn't have the
-			// required attributes.
-			continue;
+	// The magic number at each distinct address is read once
+	// and looked up in the sorted magic number index.
+	{
+		typedef RomDataFactoryPrivate::MagicIdx MagicIdx;
+		unsigned int candidates[ARRAY_SIZE(RomDataFactoryPrivate::romDataFns_magic)];
+		unsigned int candidate_count = 0;
+
+		const auto &vec_magicIdx = RomDataFactoryPrivate::vec_magicIdx;
+		for (uint32_t address : RomDataFactoryPrivate::vec_magicAddrs) {
+			// TODO: Verify alignment restrictions.
+			assert(address % 4 == 0);
+			assert(address + sizeof(uint32_t) <= sizeof(header.u32));
+			if (address + sizeof(uint32_t) > info.header.size) {
+				// Header is too small for this address.
+				// Addresses are sorted, so we're done.
+				break;
+			}
+
+			MagicIdx key;
+			key.address = address;
+			key.magic = be32_to_cpu(header.u32[address/4]);
+			key.idx = 0;
+			for (auto iter = std::lower_bound(vec_magicIdx.cbegin(), vec_magicIdx.cend(), key);
+			     iter != vec_magicIdx.cend() && iter->address == key.address && iter->magic == key.magic;
+			     ++iter)
+			{
+				candidates[candidate_count++] = iter->idx;
+			}
 		}
 
-		// Check the magic number.
-		// TODO: Verify alignment restrictions.
-		assert(fns->address % 4 == 0);
-		assert(fns->address + sizeof(uint32_t) <= sizeof(header.u32));
-		uint32_t magic = header.u32[fns->address/4];
-		if (be32_to_cpu(magic) == fns->size) {
+		// Check the candidates in table order.
+		std::sort(&candidates[0], &candidates[candidate_count]);
+		for (unsigned int i = 0; i < candidate_count; i++) {
+			const RomDataFactoryPrivate::RomDataFns *const fns =
+				&RomDataFactoryPrivate::romDataFns_magic[candidates[i]];
+			if ((fns->attrs & attrs) != attrs) {
+				// This RomData subclass doesn't have the
+				// required attributes.
+				continue;
+			}
+
 			// Found a matching magic number.
 			if (fns->isRomSupported(&info) >= 0) {
 				RomData *const romData = fns->newRomData(file);
@@ -649,8 +827,7 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 	}
 
 	// Check for supported textures.
-	{
-		// TODO: RpTextureWrapper::isRomSupported()?
+	if (RpTextureWrapper::isRomSupported_static(&info) >= 0) {
 		RomData *const romData = new RpTextureWrapper(file);
 		if (romData->isValid()) {
 			// RomData subclass obtained.
@@ -661,102 +838,86 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 		romData->unref();
 	}
 
-	// Check other RomData subclasses that take a header,
+	// Check other RomData subclasses that take a header at 0,
 	// but don't have a simple 32-bit magic number check.
-	fns = &RomDataFactoryPrivate::romDataFns_header[0];
-	bool checked_exts = false;
-	for (; fns->supportedFileExtensions != nullptr; fns++) {
+	const RomDataFactoryPrivate::RomDataFns *fns =
+		&RomDataFactoryPrivate::romDataFns_header[0];
+	for (; fns->supportedFileExtensions != nullptr && fns->address == 0; fns++) {
 		if ((fns->attrs & attrs) != attrs) {
 			// This RomData subclass doesn't have the
 			// required attributes.
 			continue;
 		}
 
-		if (fns->address != info.header.addr ||
-		    fns->size > info.header.size)
-		{
-			// Header address has changed.
-			if (!checked_exts) {
-				// Check the file extension to reduce overhead
-				// for file types that don't use this.
-				// TODO: Don't hard-code this.
-				// Use a pointer to supportedFileExtensions_static() instead?
-				static const char *const exts[] = {
-					".bin",		/* generic .bin */
-					".sms",		/* Sega Master System */
-					".gg",		/* Game Gear */
-					".tgc",		/* game.com */
-					".iso",		/* ISO-9660 */
-					".img",		/* CCD/IMG */
-					".xiso",	/* Xbox disc image */
-					".min",		/* Pokémon Mini */
-					nullptr
-				};
-
-				if (info.ext == nullptr) {
-					// No file extension...
-					break;
-				}
-
-				// Check for a matching extension.
-				bool found = false;
-				for (const char *const *ext = exts; *ext != nullptr; ext++) {
-					if (!strcasecmp(info.ext, *ext)) {
-						// Found a match!
-						found = true;
-					}
-				}
-				if (!found) {
-					// No match.
-					break;
-				}
-
-				// File extensions have been checked.
-				checked_exts = true;
+		if (fns->isRomSupported(&info) >= 0) {
+			RomData *const romData = fns->newRomData(file);
+			if (romData->isValid()) {
+				// RomData subclass obtained.
+				return romData;
 			}
 
-			// Read the new header data.
-
-			// NOTE: fns->size == 0 is only correct
-			// for headers located at 0, since we
-			// read the whole 4096+256 bytes for these.
-			assert(fns->size != 0);
-			assert(fns->size <= sizeof(header));
-			if (fns->size == 0 || fns->size > sizeof(header))
-				continue;
-
-			// Make sure the file is big enough to
-			// have this header.
-			if ((static_cast<off64_t>(fns->address) + fns->size) > info.szFile)
-				continue;
+			// Not actually supported.
+			romData->unref();
+		}
+	}
 
-			// Read the header data.
-			info.header.addr = fns->address;
-			int ret = file->seek(info.header.addr);
-			if (ret != 0)
+	// Check RomData subclasses that take a header at a
+	// non-zero address. Only subclasses that support the
+	// file extension are checked in order to reduce overhead.
+	const vector<const RomDataFactoryPrivate::RomDataFns*> *pVecFns =
+		RomDataFactoryPrivate::lookupExt(RomDataFactoryPrivate::map_extIdx_header, info.ext);
+	if (pVecFns) {
+		for (const RomDataFactoryPrivate::RomDataFns *fns : *pVecFns) {
+			if ((fns->attrs & attrs) != attrs) {
+				// This RomData subclass doesn't have the
+				// required attributes.
 				continue;
-			info.header.size = static_cast<uint32_t>(file->read(header.u8, fns->size));
-			if (info.header.size != fns->size)
-				continue;
-		}
+			}
 
-		if (fns->isRomSupported(&info) >= 0) {
-			RomData *romData;
-			if (fns->attrs & RDA_CHECK_ISO) {
-				// Check for a game-specific ISO subclass.
-				romData = RomDataFactoryPrivate::checkISO(file);
-			} else {
-				// Standard RomData subclass.
-				romData = fns->newRomData(file);
+			if (fns->address != info.header.addr ||
+			    fns->size > info.header.size)
+			{
+				// Header address has changed.
+				// Read the new header data.
+
+				// NOTE: fns->size == 0 is only correct
+				// for headers located at 0, since we
+				// read the whole 4096+256 bytes for these.
+				assert(fns->size != 0);
+				assert(fns->size <= sizeof(header));
+				if (fns->size == 0 || fns->size > sizeof(header))
+					continue;
+
+				// Make sure the file is big enough to
+				// have this header.
+				if ((static_cast<off64_t>(fns->address) + fns->size) > info.szFile)
+					continue;
+
+				// Read the header data.
+				info.header.addr = fns->address;
+				info.header.size = static_cast<uint32_t>(file->seekAndRead(info.header.addr, header.u8, fns->size));
+				if (info.header.size != fns->size)
+					continue;
 			}
 
-			if (romData) {
-				if (romData->isValid()) {
-					// RomData subclass obtained.
-					return romData;
+			if (fns->isRomSupported(&info) >= 0) {
+				RomData *romData;
+				if (fns->attrs & ATTR_CHECK_ISO) {
+					// Check for a game-specific ISO subclass.
+					romData = RomDataFactoryPrivate::checkISO(file);
+				} else {
+					// Standard RomData subclass.
+					romData = fns->newRomData(file);
+				}
+
+				if (romData) {
+					if (romData->isValid()) {
+						// RomData subclass obtained.
+						return romData;
+					}
+					// Not actually supported.
+					romData->unref();
 				}
-				// Not actually supported.
-				romData->unref();
 			}
 		}
 	}
@@ -768,23 +929,20 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 		return nullptr;
 	}
 
+	pVecFns = RomDataFactoryPrivate::lookupExt(RomDataFactoryPrivate::map_extIdx_footer, info.ext);
+	if (!pVecFns) {
+		// No footer subclasses support this file extension.
+		return nullptr;
+	}
+
 	bool readFooter = false;
-	fns = &RomDataFactoryPrivate::romDataFns_footer[0];
-	for (; fns->supportedFileExtensions != nullptr; fns++) {
+	for (const RomDataFactoryPrivate::RomDataFns *fns : *pVecFns) {
 		if ((fns->attrs & attrs) != attrs) {
 			// This RomData subclass doesn't have the
 			// required attributes.
 			continue;
 		}
 
-		// Do we have a matching extension?
-		// FIXME: Instead of hard-coded, check supportedFileExtensions.
-		// Currently only supports VirtualBoy.
-		if (!info.ext || strcasecmp(info.ext, ".vb") != 0) {
-			// Extension doesn't match.
-			continue;
-		}
-
 		// Make sure we've read the footer.
 		if (!readFooter) {
 			static const int footer_size = 1024;
@@ -815,6 +973,43 @@ RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
 	return nullptr;
 }
 
+/** RomDataFactory **/
+
+/**
+ * Create a RomData subclass for the specified ROM file.
+ *
+ * NOTE: RomData::isValid() is checked before returning a
+ * created RomData instance, so returned objects can be
+ * assumed to be valid as long as they aren't nullptr.
+ *
+ * If imgbf is non-zero, at least one of the specified image
+ * types must be supported by the RomData subclass in order to
+ * be returned.
+ *
+ * If RDA_METADATA_ONLY is set, the RomData subclass must have
+ * metadata, and the returned object will be in metadata-only mode.
+ *
+ * @param file ROM file.
+ * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
+ * @return RomData subclass, or nullptr if the ROM isn't supported.
+ */
+RomData *RomDataFactory::create(IRpFile *file, unsigned int attrs)
+{
+	if (!(attrs & RDA_METADATA_ONLY)) {
+		// Regular mode.
+		return RomDataFactoryPrivate::create(file, attrs);
+	}
+
+	// Metadata-only mode. The subclass must have metadata.
+	attrs &= ~RDA_METADATA_ONLY;
+	attrs |= RDA_HAS_METADATA;
+	RomData *const romData = RomDataFactoryPrivate::create(file, attrs);
+	if (romData) {
+		romData->setMetaDataOnly();
+	}
+	return romData;
+}
+
 /**
  * Initialize the vector of supported file extensions.
  * Used for Win32 COM registration.
@@ -56,6 +56,12 @@ class RomDataFactory
 			// Check for game-specific disc file systems.
 			// (For internal RomDataFactory use only.)
 			RDA_CHECK_ISO		= (1U << 8),
+
+			// Open the file in metadata-only mode.
+			// This isn't a subclass attribute; it implies RDA_HAS_METADATA,
+			// and the returned RomData object will only load metadata.
+			// See RomData::setMetaDataOnly().
+			RDA_METADATA_ONLY	= (1U << 9),
 		};
 
 		/**
@@ -69,6 +75,9 @@ class RomDataFactory
 		 * types must be supported by the RomData subclass in order to
 		 * be returned.
 		 *
+		 * If RDA_METADATA_ONLY is set, the RomData subclass must have
+		 * metadata, and the returned object will be in metadata-only mode.
+		 *
 		 * @param file ROM file.
 		 * @param attrs RomDataAttr bitfield. If set, RomData subclass must have the specified attributes.
 		 * @return RomData subclass, or nullptr if the ROM isn't supported.
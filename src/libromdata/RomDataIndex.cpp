@@ -0,0 +1,1724 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * RomDataIndex.cpp: Persistent RomData detection and metadata index.      *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "librpbase/config.librpbase.h"
+
+#include "RomDataIndex.hpp"
+#include "RomDataIndex_p.hpp"
+#include "RomDataFactory.hpp"
+
+// librpbase, librpfile
+#include "librpbase/RomFields.hpp"
+#include "librpbase/RomMetaData.hpp"
+#include "librpbase/SystemRegion.hpp"
+#include "librpbase/config/AboutTabText.hpp"
+#include "librpbase/config/Config.hpp"
+#include "librpbase/crypto/KeyManager.hpp"
+#include "librpfile/FileSystem.hpp"
+#include "librpfile/RpFile.hpp"
+using namespace LibRpBase;
+using namespace LibRpFile;
+
+// librpthreads
+#include "librpthreads/Atomics.h"
+#include "librpthreads/Mutex.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+
+// libcachecommon
+#include "libcachecommon/CacheDir.hpp"
+
+// C++ STL classes.
+using std::array;
+using std::string;
+using std::vector;
+
+#ifdef _WIN32
+// Win32 needed for GetCurrentProcessId().
+# include "libwin32common/RpWin32_sdk.h"
+#else /* !_WIN32 */
+# include <unistd.h>	/* for getpid() */
+#endif /* _WIN32 */
+
+namespace LibRomData {
+
+
+/**
+ * Index entry writer.
+ */
+class IndexWriter
+{
+	public:
+		explicit IndexWriter(vector<uint8_t> &buf)
+			: buf(buf)
+		{ }
+
+	private:
+		RP_DISABLE_COPY(IndexWriter)
+
+	public:
+		inline size_t pos(void) const
+		{
+			return buf.size();
+		}
+
+		inline void write(const void *data, size_t size)
+		{
+			const uint8_t *const p = static_cast<const uint8_t*>(data);
+			buf.insert(buf.end(), p, p + size);
+		}
+
+		inline void u8(uint8_t val)
+		{
+			buf.push_back(val);
+		}
+
+		inline void u16(uint16_t val)
+		{
+			val = cpu_to_le16(val);
+			write(&val, sizeof(val));
+		}
+
+		inline void u32(uint32_t val)
+		{
+			val = cpu_to_le32(val);
+			write(&val, sizeof(val));
+		}
+
+		inline void u64(uint64_t val)
+		{
+			val = cpu_to_le64(val);
+			write(&val, sizeof(val));
+		}
+
+		inline void str(const char *str)
+		{
+			if (!str) {
+				u32(~0U);
+				return;
+			}
+			const size_t len = strlen(str);
+			u32(static_cast<uint32_t>(len));
+			write(str, len);
+		}
+
+		inline void str(const string &str)
+		{
+			u32(static_cast<uint32_t>(str.size()));
+			write(str.data(), str.size());
+		}
+
+		inline void str(const string *str)
+		{
+			if (str) {
+				this->str(*str);
+			} else {
+				u32(~0U);
+			}
+		}
+
+		inline void str(const StrView &str)
+		{
+			if (str) {
+				u32(static_cast<uint32_t>(str.len));
+				write(str.ptr, str.len);
+			} else {
+				u32(~0U);
+			}
+		}
+
+		inline void strVector(const vector<string> *vec)
+		{
+			if (!vec) {
+				u32(~0U);
+				return;
+			}
+			u32(static_cast<uint32_t>(vec->size()));
+			for (const string &s : *vec) {
+				str(s);
+			}
+		}
+
+		inline void listData(const RomFields::ListDataView_t *list_data)
+		{
+			if (!list_data) {
+				u32(~0U);
+				return;
+			}
+			u32(static_cast<uint32_t>(list_data->size()));
+			for (const RomFields::ListDataRow_t &row : *list_data) {
+				// Same format as strVector().
+				u32(static_cast<uint32_t>(row.size()));
+				for (const StrView &s : row) {
+					str(s);
+				}
+			}
+		}
+
+		/**
+		 * Reserve space for a section size.
+		 * @return Position of the section size.
+		 */
+		inline size_t beginSection(void)
+		{
+			const size_t sizePos = pos();
+			u32(0);
+			return sizePos;
+		}
+
+		/**
+		 * Set a section's size.
+		 * @param sizePos Position of the section size.
+		 */
+		inline void endSection(size_t sizePos)
+		{
+			patchU32(sizePos, static_cast<uint32_t>(pos() - sizePos - sizeof(uint32_t)));
+		}
+
+		/**
+		 * Overwrite a previously-written u32.
+		 * @param pos Position of the u32.
+		 * @param val New value.
+		 */
+		inline void patchU32(size_t pos, uint32_t val)
+		{
+			val = cpu_to_le32(val);
+			memcpy(&buf[pos], &val, sizeof(val));
+		}
+
+		/**
+		 * Discard everything written after the specified position.
+		 * @param pos Position.
+		 */
+		inline void truncate(size_t pos)
+		{
+			buf.resize(pos);
+		}
+
+	private:
+		vector<uint8_t> &buf;
+};
+
+/**
+ * Index entry reader.
+ * All reads are bounds-checked; if a read fails,
+ * ok() will return false and all subsequent reads
+ * will return zero or empty values.
+ */
+class IndexReader
+{
+	public:
+		IndexReader(const uint8_t *data, size_t size)
+			: p(data), p_end(data + size)
+			, m_ok(true)
+		{ }
+
+	private:
+		RP_DISABLE_COPY(IndexReader)
+
+	public:
+		inline bool ok(void) const
+		{
+			return m_ok;
+		}
+
+		inline const uint8_t *ptr(void) const
+		{
+			return p;
+		}
+
+		inline const uint8_t *read(size_t size)
+		{
+			if (!m_ok || static_cast<size_t>(p_end - p) < size) {
+				m_ok = false;
+				return nullptr;
+			}
+			const uint8_t *const ret = p;
+			p += size;
+			return ret;
+		}
+
+		inline uint8_t u8(void)
+		{
+			const uint8_t *const data = read(sizeof(uint8_t));
+			return (data ? *data : 0);
+		}
+
+		inline uint16_t u16(void)
+		{
+			uint16_t val = 0;
+			const uint8_t *const data = read(sizeof(val));
+			if (data) {
+				memcpy(&val, data, sizeof(val));
+			}
+			return le16_to_cpu(val);
+		}
+
+		inline uint32_t u32(void)
+		{
+			uint32_t val = 0;
+			const uint8_t *const data = read(sizeof(val));
+			if (data) {
+				memcpy(&val, data, sizeof(val));
+			}
+			return le32_to_cpu(val);
+		}
+
+		inline uint64_t u64(void)
+		{
+			uint64_t val = 0;
+			const uint8_t *const data = read(sizeof(val));
+			if (data) {
+				memcpy(&val, data, sizeof(val));
+			}
+			return le64_to_cpu(val);
+		}
+
+		/**
+		 * Read a string.
+		 * @param s	[out] String.
+		 * @return True if the string is non-null; false if it's null or on error.
+		 */
+		inline bool str(string &s)
+		{
+			s.clear();
+			const uint32_t len = u32();
+			if (len == ~0U) {
+				return false;
+			}
+			const uint8_t *const data = read(len);
+			if (!data) {
+				return false;
+			}
+			s.assign(reinterpret_cast<const char*>(data), len);
+			return true;
+		}
+
+		/**
+		 * Read a string vector.
+		 * @return Allocated vector, or nullptr if null or on error.
+		 */
+		inline vector<string> *strVector(void)
+		{
+			const uint32_t count = u32();
+			if (count == ~0U || !m_ok) {
+				return nullptr;
+			} else if (count > static_cast<size_t>(p_end - p) / sizeof(uint32_t)) {
+				// Not enough data for this many strings.
+				m_ok = false;
+				return nullptr;
+			}
+
+			vector<string> *const vec = new vector<string>(count);
+			for (string &s : *vec) {
+				str(s);
+			}
+			return vec;
+		}
+
+		/**
+		 * Read list data.
+		 * The strings are copied directly into the RomFields string arena.
+		 * @param fields RomFields object that will own the list data.
+		 * @return Allocated ListDataView_t, or nullptr if null or on error.
+		 */
+		inline RomFields::ListDataView_t *listData(RomFields *fields)
+		{
+			const uint32_t count = u32();
+			if (count == ~0U || !m_ok) {
+				return nullptr;
+			} else if (count > static_cast<size_t>(p_end - p) / sizeof(uint32_t)) {
+				// Not enough data for this many rows.
+				m_ok = false;
+				return nullptr;
+			}
+
+			RomFields::ListDataBuilder builder(fields, count);
+			for (uint32_t i = 0; i < count && m_ok; i++) {
+				builder.addRow();
+				const uint32_t cols = u32();
+				if (cols == ~0U || !m_ok) {
+					continue;
+				} else if (cols > static_cast<size_t>(p_end - p) / sizeof(uint32_t)) {
+					// Not enough data for this many strings.
+					m_ok = false;
+					break;
+				}
+
+				for (uint32_t j = 0; j < cols; j++) {
+					const uint32_t len = u32();
+					const uint8_t *const data = (len != ~0U ? read(len) : nullptr);
+					if (data) {
+						builder.add(reinterpret_cast<const char*>(data), len);
+					} else {
+						builder.add("", 0);
+					}
+				}
+			}
+			return new RomFields::ListDataView_t(builder.release());
+		}
+
+	private:
+		const uint8_t *p;
+		const uint8_t *const p_end;
+		bool m_ok;
+};
+
+/** Field serialization **/
+
+/**
+ * Serialize RomFields.
+ * @param w Index writer.
+ * @param fields RomFields.
+ * @return True on success; false if the RomFields object can't be serialized.
+ */
+static bool serializeFields(IndexWriter &w, const RomFields *fields)
+{
+	// Tabs
+	const int tabCount = fields->tabCount();
+	w.u32(static_cast<uint32_t>(tabCount));
+	for (int i = 0; i < tabCount; i++) {
+		w.str(fields->tabName(i));
+	}
+	w.u32(fields->defaultLanguageCode());
+
+	// Fields
+	const size_t countPos = w.pos();
+	uint32_t count = 0;
+	w.u32(0);
+	const auto fields_cend = fields->cend();
+	for (auto iter = fields->cbegin(); iter != fields_cend; ++iter) {
+		const RomFields::Field &field = *iter;
+		if (!field.isValid)
+			continue;
+
+		w.u8(field.type);
+		w.u8(field.tabIdx);
+		w.str(field.name);
+
+		switch (field.type) {
+			case RomFields::RFT_STRING:
+				w.u32(field.desc.flags);
+				w.str(field.data.str);
+				break;
+
+			case RomFields::RFT_BITFIELD:
+				w.u32(static_cast<uint32_t>(field.desc.bitfield.elemsPerRow));
+				w.strVector(field.desc.bitfield.names);
+				w.u32(field.data.bitfield);
+				break;
+
+			case RomFields::RFT_LISTDATA: {
+				const auto &listDataDesc = field.desc.list_data;
+				if (listDataDesc.flags & RomFields::RFT_LISTDATA_ICONS) {
+					// Icons can't be indexed.
+					return false;
+				}
+				w.u32(listDataDesc.flags);
+				w.u32(static_cast<uint32_t>(listDataDesc.rows_visible));
+				w.u32(listDataDesc.col_attrs.align_headers);
+				w.u32(listDataDesc.col_attrs.align_data);
+				w.u32(listDataDesc.col_attrs.sizing);
+				w.u32(listDataDesc.col_attrs.sorting);
+				w.u8(static_cast<uint8_t>(listDataDesc.col_attrs.sort_col));
+				w.u8(listDataDesc.col_attrs.sort_dir);
+				w.strVector(listDataDesc.names);
+
+				if (listDataDesc.flags & RomFields::RFT_LISTDATA_MULTI) {
+					const RomFields::ListDataViewMultiMap_t *const multi = field.data.list_data.data.multi;
+					if (!multi) {
+						w.u32(~0U);
+					} else {
+						w.u32(static_cast<uint32_t>(multi->size()));
+						for (const auto &pld : *multi) {
+							w.u32(pld.first);
+							w.listData(&pld.second);
+						}
+					}
+				} else {
+					w.listData(field.data.list_data.data.single);
+				}
+				w.u32(field.data.list_data.mxd.checkboxes);
+				break;
+			}
+
+			case RomFields::RFT_DATETIME:
+				w.u32(field.desc.flags);
+				w.u64(static_cast<uint64_t>(field.data.date_time));
+				break;
+
+			case RomFields::RFT_AGE_RATINGS: {
+				const RomFields::age_ratings_t *const age_ratings = field.data.age_ratings;
+				w.u8(age_ratings != nullptr);
+				if (age_ratings) {
+					for (uint16_t rating : *age_ratings) {
+						w.u16(rating);
+					}
+				}
+				break;
+			}
+
+			case RomFields::RFT_DIMENSIONS:
+				w.u32(static_cast<uint32_t>(field.data.dimensions[0]));
+				w.u32(static_cast<uint32_t>(field.data.dimensions[1]));
+				w.u32(static_cast<uint32_t>(field.data.dimensions[2]));
+				break;
+
+			case RomFields::RFT_STRING_MULTI: {
+				w.u32(field.desc.flags);
+				const RomFields::StringMultiMap_t *const str_multi = field.data.str_multi;
+				if (!str_multi) {
+					w.u32(~0U);
+				} else {
+					w.u32(static_cast<uint32_t>(str_multi->size()));
+					for (const auto &pstr : *str_multi) {
+						w.u32(pstr.first);
+						w.str(pstr.second);
+					}
+				}
+				break;
+			}
+
+			default:
+				// Unsupported field type.
+				assert(!"Unsupported RomFields::RomFieldsType.");
+				return false;
+		}
+
+		count++;
+	}
+
+	// Update the field count.
+	w.patchU32(countPos, count);
+	return true;
+}
+
+/**
+ * Deserialize RomFields.
+ * @param r Index reader.
+ * @param fields RomFields. (should be empty)
+ * @return Number of fields read on success; negative POSIX error code on error.
+ */
+static int deserializeFields(IndexReader &r, RomFields *fields)
+{
+	// Tabs
+	const uint32_t tabCount = r.u32();
+	if (tabCount > 256) {
+		// Too many tabs. (tabIdx is uint8_t)
+		return -EIO;
+	}
+	if (tabCount > 0) {
+		fields->reserveTabs(static_cast<int>(tabCount));
+	}
+	string s;
+	for (uint32_t i = 0; i < tabCount; i++) {
+		const bool hasName = r.str(s);
+		fields->setTabName(static_cast<int>(i), (hasName ? s.c_str() : nullptr));
+	}
+	const uint32_t def_lc = r.u32();
+
+	// Fields
+	const uint32_t count = r.u32();
+	if (!r.ok()) {
+		return -EIO;
+	}
+	if (count > 0) {
+		fields->reserve(static_cast<int>(std::min<uint32_t>(count, 1024U)));
+	}
+
+	string name;
+	for (uint32_t i = 0; i < count && r.ok(); i++) {
+		const uint8_t type = r.u8();
+		const uint8_t tabIdx = r.u8();
+		r.str(name);
+		fields->setTabIndex(tabIdx);
+
+		switch (type) {
+			case RomFields::RFT_STRING: {
+				const unsigned int flags = r.u32();
+				const bool hasStr = r.str(s);
+				fields->addField_string(name.c_str(), (hasStr ? s.c_str() : nullptr), flags);
+				break;
+			}
+
+			case RomFields::RFT_BITFIELD: {
+				const int elemsPerRow = static_cast<int>(r.u32());
+				vector<string> *const bit_names = r.strVector();
+				const uint32_t bitfield = r.u32();
+				if (!bit_names) {
+					// Bit names are required.
+					return -EIO;
+				}
+				fields->addField_bitfield(name.c_str(), bit_names, elemsPerRow, bitfield);
+				break;
+			}
+
+			case RomFields::RFT_LISTDATA: {
+				RomFields::AFLD_PARAMS params;
+				params.flags = r.u32();
+				params.rows_visible = static_cast<int>(r.u32());
+				params.col_attrs.align_headers = r.u32();
+				params.col_attrs.align_data = r.u32();
+				params.col_attrs.sizing = r.u32();
+				params.col_attrs.sorting = r.u32();
+				params.col_attrs.sort_col = static_cast<int8_t>(r.u8());
+				params.col_attrs.sort_dir = static_cast<RomFields::ColSortOrder>(r.u8());
+				params.headers = r.strVector();
+				params.def_lc = def_lc;
+
+				if ((params.flags & RomFields::RFT_LISTDATA_ICONS) || params.rows_visible < 0) {
+					// Icons are never indexed, and rows_visible can't be negative.
+					delete params.headers;
+					return -EIO;
+				}
+
+				if (params.flags & RomFields::RFT_LISTDATA_MULTI) {
+					const uint32_t lcCount = r.u32();
+					if (lcCount != ~0U && r.ok()) {
+						RomFields::ListDataViewMultiMap_t *const multi = new RomFields::ListDataViewMultiMap_t();
+						for (uint32_t j = 0; j < lcCount && r.ok(); j++) {
+							const uint32_t lc = r.u32();
+							RomFields::ListDataView_t *const list_data = r.listData(fields);
+							if (list_data) {
+								multi->emplace(lc, std::move(*list_data));
+								delete list_data;
+							}
+						}
+						params.view.multi = multi;
+					}
+				} else {
+					params.view.single = r.listData(fields);
+				}
+				params.mxd.checkboxes = r.u32();
+				fields->addField_listData(name.c_str(), &params);
+				break;
+			}
+
+			case RomFields::RFT_DATETIME: {
+				const unsigned int flags = r.u32();
+				const time_t date_time = static_cast<time_t>(static_cast<int64_t>(r.u64()));
+				fields->addField_dateTime(name.c_str(), date_time, flags);
+				break;
+			}
+
+			case RomFields::RFT_AGE_RATINGS: {
+				if (!r.u8()) {
+					// No age ratings.
+					continue;
+				}
+				RomFields::age_ratings_t age_ratings;
+				for (uint16_t &rating : age_ratings) {
+					rating = r.u16();
+				}
+				fields->addField_ageRatings(name.c_str(), age_ratings);
+				break;
+			}
+
+			case RomFields::RFT_DIMENSIONS: {
+				const int dimX = static_cast<int>(r.u32());
+				const int dimY = static_cast<int>(r.u32());
+				const int dimZ = static_cast<int>(r.u32());
+				fields->addField_dimensions(name.c_str(), dimX, dimY, dimZ);
+				break;
+			}
+
+			case RomFields::RFT_STRING_MULTI: {
+				const unsigned int flags = r.u32();
+				const uint32_t lcCount = r.u32();
+				RomFields::StringMultiMap_t *str_multi = nullptr;
+				if (lcCount != ~0U && r.ok()) {
+					str_multi = new RomFields::StringMultiMap_t();
+					for (uint32_t j = 0; j < lcCount && r.ok(); j++) {
+						const uint32_t lc = r.u32();
+						r.str(s);
+						str_multi->emplace(lc, s);
+					}
+				}
+				fields->addField_string_multi(name.c_str(), str_multi, def_lc, flags);
+				break;
+			}
+
+			default:
+				// Unsupported field type.
+				return -EIO;
+		}
+	}
+
+	return (r.ok() ? fields->count() : -EIO);
+}
+
+/** Metadata serialization **/
+
+/**
+ * Serialize RomMetaData.
+ * @param w Index writer.
+ * @param metaData RomMetaData.
+ */
+static void serializeMetaData(IndexWriter &w, const RomMetaData *metaData)
+{
+	const int count = metaData->count();
+	w.u32(static_cast<uint32_t>(count));
+	for (int i = 0; i < count; i++) {
+		const RomMetaData::MetaData *const prop = metaData->prop(i);
+		w.u8(static_cast<uint8_t>(prop->name));
+		w.u8(static_cast<uint8_t>(prop->type));
+		switch (prop->type) {
+			case PropertyType::Integer:
+				w.u32(static_cast<uint32_t>(prop->data.ivalue));
+				break;
+			case PropertyType::UnsignedInteger:
+				w.u32(prop->data.uvalue);
+				break;
+			case PropertyType::String:
+				w.str(prop->data.str);
+				break;
+			case PropertyType::Timestamp:
+				w.u64(static_cast<uint64_t>(prop->data.timestamp));
+				break;
+			default:
+				// No data.
+				break;
+		}
+	}
+}
+
+/**
+ * Deserialize RomMetaData.
+ * @param r Index reader.
+ * @param metaData RomMetaData. (should be empty)
+ * @return Number of metadata properties read on success; negative POSIX error code on error.
+ */
+static int deserializeMetaData(IndexReader &r, RomMetaData *metaData)
+{
+	const uint32_t count = r.u32();
+	if (!r.ok()) {
+		return -EIO;
+	}
+	if (count > 0) {
+		metaData->reserve(static_cast<int>(std::min<uint32_t>(count, static_cast<uint32_t>(Property::PropertyCount))));
+	}
+
+	string s;
+	for (uint32_t i = 0; i < count && r.ok(); i++) {
+		const Property name = static_cast<Property>(r.u8());
+		const PropertyType type = static_cast<PropertyType>(r.u8());
+		if (RomMetaData::propertyType(name) != type) {
+			// Invalid property name, or the type doesn't match.
+			return -EIO;
+		}
+		switch (type) {
+			case PropertyType::Integer:
+				metaData->addMetaData_integer(name, static_cast<int>(r.u32()));
+				break;
+			case PropertyType::UnsignedInteger:
+				metaData->addMetaData_uint(name, r.u32());
+				break;
+			case PropertyType::String:
+				if (r.str(s)) {
+					metaData->addMetaData_string(name, s);
+				}
+				break;
+			case PropertyType::Timestamp:
+				metaData->addMetaData_timestamp(name, static_cast<time_t>(static_cast<int64_t>(r.u64())));
+				break;
+			default:
+				// No data.
+				break;
+		}
+	}
+
+	return (r.ok() ? metaData->count() : -EIO);
+}
+
+/** IndexedRomData **/
+
+class IndexedRomDataPrivate;
+class IndexedRomData final : public RomData
+{
+	public:
+		/**
+		 * Create a RomData object from an index entry.
+		 * NOTE: Check isValid() to determine if the entry was parsed.
+		 * @param file ROM file.
+		 * @param attrs RomDataFactory attributes.
+		 * @param entry Index entry data. (will be moved)
+		 * @param bodyPos Position of the entry body.
+		 * @param entryFlags Entry flags.
+		 */
+		IndexedRomData(IRpFile *file, unsigned int attrs,
+			vector<uint8_t> &&entry, size_t bodyPos, uint32_t entryFlags);
+	protected:
+		~IndexedRomData() final { }
+
+	private:
+		typedef RomData super;
+		friend class IndexedRomDataPrivate;
+		RP_DISABLE_COPY(IndexedRomData)
+
+	public:
+		void close(void) final;
+		int isRomSupported(const DetectInfo *info) const final;
+		const char *systemName(unsigned int type) const final;
+		const char *const *supportedFileExtensions(void) const final;
+		const char *const *supportedMimeTypes(void) const final;
+		uint32_t supportedImageTypes(void) const final;
+		vector<ImageSizeDef> supportedImageSizes(ImageType imageType) const final;
+		uint32_t imgpf(ImageType imageType) const final;
+		int extURLs(ImageType imageType, vector<ExtURL> *pExtURLs, int size = IMAGE_SIZE_DEFAULT) const final;
+		string scrapeImageURL(const char *html, size_t size) const final;
+		const IconAnimData *iconAnimData(void) const final;
+		bool hasDangerousPermissions(void) const final;
+		vector<ContentView> contentViews(void) final;
+
+	protected:
+		int loadFieldData(void) final;
+		int loadMetaData(void) final;
+		int loadInternalImage(ImageType imageType, const LibRpTexture::rp_image **pImage) final;
+};
+
+class IndexedRomDataPrivate final : public RomDataPrivate
+{
+	public:
+		IndexedRomDataPrivate(IndexedRomData *q, IRpFile *file, unsigned int attrs);
+		~IndexedRomDataPrivate() final;
+
+	private:
+		typedef RomDataPrivate super;
+		RP_DISABLE_COPY(IndexedRomDataPrivate)
+
+	public:
+		unsigned int attrs;		// RomDataFactory attributes.
+		vector<uint8_t> entry;		// Index entry data.
+
+		// Sections in the index entry.
+		// If not present, the fallback RomData object will be used.
+		const uint8_t *fieldsData;
+		uint32_t fieldsSize;
+		const uint8_t *metaDataData;
+		uint32_t metaDataSize;
+
+		string s_className;
+		string s_mimeType;
+		array<string, RomDataIndexPrivate::SYSNAME_COUNT> sysNames;
+		uint32_t sysNamesValid;		// Bitfield of non-null system names.
+
+		uint32_t imgbf;
+		array<uint32_t, RomData::IMG_EXT_MAX+1> imgpf;
+		bool hasDangerousPermissions;
+
+		// External image URLs. (IMAGE_SIZE_DEFAULT only)
+		bool hasExtURLs;
+		array<int, RomData::IMG_EXT_MAX-RomData::IMG_EXT_MIN+1> extURLsRet;
+		array<vector<RomData::ExtURL>, RomData::IMG_EXT_MAX-RomData::IMG_EXT_MIN+1> extURLs;
+
+		// Fallback RomData object, created by RomDataFactory.
+		// Used for anything that isn't in the index entry.
+		Mutex fallbackMutex;
+		RomData *fallback;
+		bool fallbackTried;
+
+	public:
+		/**
+		 * Parse the index entry body.
+		 * @param bodyPos Position of the entry body.
+		 * @param entryFlags Entry flags.
+		 * @return True on success; false on error.
+		 */
+		bool parseEntry(size_t bodyPos, uint32_t entryFlags);
+
+		/**
+		 * Get the fallback RomData object.
+		 * The ROM file is reopened with RomDataFactory on first use.
+		 * @return Fallback RomData object, or nullptr on error.
+		 */
+		RomData *getFallback(void);
+};
+
+IndexedRomDataPrivate::IndexedRomDataPrivate(IndexedRomData *q, IRpFile *file, unsigned int attrs)
+	: super(q, file)
+	, attrs(attrs)
+	, fieldsData(nullptr)
+	, fieldsSize(0)
+	, metaDataData(nullptr)
+	, metaDataSize(0)
+	, sysNamesValid(0)
+	, imgbf(0)
+	, hasDangerousPermissions(false)
+	, hasExtURLs(false)
+	, fallback(nullptr)
+	, fallbackTried(false)
+{
+	imgpf.fill(0);
+	extURLsRet.fill(-ENOENT);
+}
+
+IndexedRomDataPrivate::~IndexedRomDataPrivate()
+{
+	UNREF(fallback);
+}
+
+/**
+ * Parse the index entry body.
+ * @param bodyPos Position of the entry body.
+ * @param entryFlags Entry flags.
+ * @return True on success; false on error.
+ */
+bool IndexedRomDataPrivate::parseEntry(size_t bodyPos, uint32_t entryFlags)
+{
+	assert(bodyPos <= entry.size());
+	if (bodyPos > entry.size())
+		return false;
+	IndexReader r(entry.data() + bodyPos, entry.size() - bodyPos);
+
+	r.str(s_className);
+	const bool hasMimeType = r.str(s_mimeType);
+	fileType = static_cast<RomData::FileType>(r.u32());
+	for (unsigned int i = 0; i < RomDataIndexPrivate::SYSNAME_COUNT; i++) {
+		if (r.str(sysNames[i])) {
+			sysNamesValid |= (1U << i);
+		}
+	}
+	imgbf = r.u32();
+	for (uint32_t &pf : imgpf) {
+		pf = r.u32();
+	}
+	hasDangerousPermissions = !!r.u8();
+
+	if (entryFlags & RomDataIndexPrivate::ENTRY_HAS_EXTURLS) {
+		for (int i = RomData::IMG_EXT_MIN; i <= RomData::IMG_EXT_MAX; i++) {
+			if (!(imgbf & (1U << i)))
+				continue;
+
+			const unsigned int idx = i - RomData::IMG_EXT_MIN;
+			extURLsRet[idx] = static_cast<int>(r.u32());
+			const uint32_t count = r.u32();
+			if (count > 64 || !r.ok()) {
+				// Too many URLs.
+				return false;
+			}
+			vector<RomData::ExtURL> &vec = extURLs[idx];
+			vec.resize(count);
+			for (RomData::ExtURL &extURL : vec) {
+				r.str(extURL.url);
+				r.str(extURL.cache_key);
+				extURL.width = r.u16();
+				extURL.height = r.u16();
+				extURL.high_res = !!r.u8();
+			}
+		}
+		hasExtURLs = true;
+	}
+
+	if (entryFlags & RomDataIndexPrivate::ENTRY_HAS_FIELDS) {
+		fieldsSize = r.u32();
+		fieldsData = r.read(fieldsSize);
+	}
+	if (entryFlags & RomDataIndexPrivate::ENTRY_HAS_METADATA) {
+		metaDataSize = r.u32();
+		metaDataData = r.read(metaDataSize);
+	}
+
+	if (!r.ok() || s_className.empty()) {
+		return false;
+	} else if (fileType <= RomData::FileType::Unknown || fileType >= RomData::FileType::Max) {
+		// Invalid file type.
+		return false;
+	}
+
+	className = s_className.c_str();
+	mimeType = (hasMimeType ? s_mimeType.c_str() : nullptr);
+	return true;
+}
+
+/**
+ * Get the fallback RomData object.
+ * The ROM file is reopened with RomDataFactory on first use.
+ * @return Fallback RomData object, or nullptr on error.
+ */
+RomData *IndexedRomDataPrivate::getFallback(void)
+{
+	MutexLocker locker(fallbackMutex);
+	if (fallbackTried) {
+		return fallback;
+	}
+	fallbackTried = true;
+
+	if (!file) {
+		// File was closed.
+		return nullptr;
+	}
+
+	RomData *const romData = RomDataFactory::create(file, attrs);
+	if (!romData) {
+		return nullptr;
+	}
+
+	// Make sure the fallback object is the same class
+	// as the index entry. If it isn't, the index is stale.
+	const char *const fbClassName = romData->className();
+	if (!fbClassName || s_className != fbClassName) {
+		romData->unref();
+		return nullptr;
+	}
+
+	fallback = romData;
+	return fallback;
+}
+
+/**
+ * Create a RomData object from an index entry.
+ * NOTE: Check isValid() to determine if the entry was parsed.
+ * @param file ROM file.
+ * @param attrs RomDataFactory attributes.
+ * @param entry Index entry data. (will be moved)
+ * @param bodyPos Position of the entry body.
+ * @param entryFlags Entry flags.
+ */
+IndexedRomData::IndexedRomData(IRpFile *file, unsigned int attrs,
+	vector<uint8_t> &&entry, size_t bodyPos, uint32_t entryFlags)
+	: super(new IndexedRomDataPrivate(this, file, attrs))
+{
+	RP_D(IndexedRomData);
+	d->entry = std::move(entry);
+	d->isValid = d->parseEntry(bodyPos, entryFlags);
+	if (d->isValid && (attrs & RomDataFactory::RDA_METADATA_ONLY)) {
+		setMetaDataOnly();
+	}
+}
+
+/**
+ * Close the opened file.
+ */
+void IndexedRomData::close(void)
+{
+	RP_D(IndexedRomData);
+	MutexLocker locker(d->fallbackMutex);
+	if (d->fallback) {
+		d->fallback->close();
+	}
+	super::close();
+}
+
+/**
+ * Is a ROM image supported by this object?
+ * IndexedRomData is never used for detection.
+ * @param info DetectInfo containing ROM detection information.
+ * @return -1
+ */
+int IndexedRomData::isRomSupported(const DetectInfo *info) const
+{
+	RP_UNUSED(info);
+	return -1;
+}
+
+/**
+ * Get the name of the system the loaded ROM is designed for.
+ * @param type System name type. (See the SystemName enum.)
+ * @return System name, or nullptr if type is invalid.
+ */
+const char *IndexedRomData::systemName(unsigned int type) const
+{
+	RP_D(const IndexedRomData);
+	if (!d->isValid || !isSystemNameTypeValid(type))
+		return nullptr;
+
+	const unsigned int idx = (type & SYSNAME_TYPE_MASK) +
+		((type & SYSNAME_REGION_MASK) ? 3 : 0);
+	return ((d->sysNamesValid & (1U << idx)) ? d->sysNames[idx].c_str() : nullptr);
+}
+
+/**
+ * Get a list of all supported file extensions.
+ * IndexedRomData isn't registered for any file extensions.
+ * @return Empty list.
+ */
+const char *const *IndexedRomData::supportedFileExtensions(void) const
+{
+	static const char *const exts[] = { nullptr };
+	return exts;
+}
+
+/**
+ * Get a list of all supported MIME types.
+ * IndexedRomData isn't registered for any MIME types.
+ * @return Empty list.
+ */
+const char *const *IndexedRomData::supportedMimeTypes(void) const
+{
+	static const char *const mimeTypes[] = { nullptr };
+	return mimeTypes;
+}
+
+/**
+ * Get a bitfield of image types this class can retrieve.
+ * @return Bitfield of supported image types. (ImageTypesBF)
+ */
+uint32_t IndexedRomData::supportedImageTypes(void) const
+{
+	RP_D(const IndexedRomData);
+	return d->imgbf;
+}
+
+/**
+ * Get a list of all available image sizes for the specified image type.
+ * @param imageType Image type.
+ * @return Vector of available image sizes, or empty vector if no images are available.
+ */
+vector<RomData::ImageSizeDef> IndexedRomData::supportedImageSizes(ImageType imageType) const
+{
+	ASSERT_supportedImageSizes(imageType);
+
+	RP_D(const IndexedRomData);
+	if (!(d->imgbf & (1U << imageType))) {
+		// Image type isn't supported.
+		return vector<ImageSizeDef>();
+	}
+
+	// Image sizes aren't indexed.
+	RomData *const fallback = const_cast<IndexedRomDataPrivate*>(d)->getFallback();
+	return (fallback ? fallback->supportedImageSizes(imageType) : vector<ImageSizeDef>());
+}
+
+/**
+ * Get image processing flags.
+ * @param imageType Image type.
+ * @return Bitfield of ImageProcessingBF operations to perform.
+ */
+uint32_t IndexedRomData::imgpf(ImageType imageType) const
+{
+	ASSERT_imgpf(imageType);
+
+	RP_D(const IndexedRomData);
+	return d->imgpf[imageType];
+}
+
+/**
+ * Get a list of URLs for an external image type.
+ * @param imageType	[in]     Image type.
+ * @param pExtURLs	[out]    Output vector.
+ * @param size		[in,opt] Requested image size.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int IndexedRomData::extURLs(ImageType imageType, vector<ExtURL> *pExtURLs, int size) const
+{
+	ASSERT_extURLs(imageType, pExtURLs);
+	pExtURLs->clear();
+
+	RP_D(const IndexedRomData);
+	if (!(d->imgbf & (1U << imageType))) {
+		// Image type isn't supported.
+		return -ENOENT;
+	}
+
+	if (d->hasExtURLs && size == IMAGE_SIZE_DEFAULT) {
+		// Use the indexed URLs.
+		const unsigned int idx = imageType - IMG_EXT_MIN;
+		*pExtURLs = d->extURLs[idx];
+		return d->extURLsRet[idx];
+	}
+
+	RomData *const fallback = const_cast<IndexedRomDataPrivate*>(d)->getFallback();
+	return (fallback ? fallback->extURLs(imageType, pExtURLs, size) : -EIO);
+}
+
+/**
+ * Scrape an image URL from a downloaded HTML page.
+ * @param html HTML data.
+ * @param size Size of HTML data.
+ * @return Image URL, or empty string if not found or not supported.
+ */
+string IndexedRomData::scrapeImageURL(const char *html, size_t size) const
+{
+	RP_D(const IndexedRomData);
+	RomData *const fallback = const_cast<IndexedRomDataPrivate*>(d)->getFallback();
+	return (fallback ? fallback->scrapeImageURL(html, size) : string());
+}
+
+/**
+ * Get the animated icon data.
+ * @return Animated icon data, or nullptr if no animated icon is present.
+ */
+const IconAnimData *IndexedRomData::iconAnimData(void) const
+{
+	RP_D(const IndexedRomData);
+	if (!(d->imgpf[IMG_INT_ICON] & IMGPF_ICON_ANIMATED)) {
+		// No animated icon.
+		return nullptr;
+	}
+
+	RomData *const fallback = const_cast<IndexedRomDataPrivate*>(d)->getFallback();
+	return (fallback ? fallback->iconAnimData() : nullptr);
+}
+
+/**
+ * Does this ROM image have "dangerous" permissions?
+ * @return True if the ROM image has "dangerous" permissions; false if not.
+ */
+bool IndexedRomData::hasDangerousPermissions(void) const
+{
+	RP_D(const IndexedRomData);
+	return d->hasDangerousPermissions;
+}
+
+/**
+ * Get the decrypted and/or decompressed views of this ROM image's contents.
+ * Content views aren't indexed, so this uses the fallback object.
+ * @return Content views. (empty if none are available)
+ */
+vector<RomData::ContentView> IndexedRomData::contentViews(void)
+{
+	RP_D(IndexedRomData);
+	RomData *const fallback = d->getFallback();
+	return (fallback ? fallback->contentViews() : vector<ContentView>());
+}
+
+/**
+ * Load field data.
+ * Called by RomData::fields() if the field data hasn't been loaded yet.
+ * @return Number of fields read on success; negative POSIX error code on error.
+ */
+int IndexedRomData::loadFieldData(void)
+{
+	RP_D(IndexedRomData);
+	if (!d->fields->empty()) {
+		// Field data *has* been loaded...
+		return 0;
+	} else if (!d->isValid) {
+		// Unknown ROM image type.
+		return -EIO;
+	}
+
+	if (d->fieldsData) {
+		// Use the indexed fields.
+		IndexReader r(d->fieldsData, d->fieldsSize);
+		return deserializeFields(r, d->fields);
+	}
+
+	// Fields aren't indexed. Copy them from the fallback object.
+	RomData *const fallback = d->getFallback();
+	const RomFields *const fbFields = (fallback ? fallback->fields() : nullptr);
+	if (!fbFields) {
+		return -EIO;
+	}
+	d->fields->addFields_romFields(fbFields, 0);
+	const int tabCount = fbFields->tabCount();
+	for (int i = 0; i < tabCount; i++) {
+		d->fields->setTabName(i, fbFields->tabName(i));
+	}
+	return d->fields->count();
+}
+
+/**
+ * Load metadata properties.
+ * Called by RomData::metaData() if the field data hasn't been loaded yet.
+ * @return Number of metadata properties read on success; negative POSIX error code on error.
+ */
+int IndexedRomData::loadMetaData(void)
+{
+	RP_D(IndexedRomData);
+	if (d->metaData != nullptr) {
+		// Metadata *has* been loaded...
+		return 0;
+	} else if (!d->isValid) {
+		// Unknown ROM image type.
+		return -EIO;
+	}
+
+	if (d->metaDataData) {
+		// Use the indexed metadata.
+		d->metaData = new RomMetaData();
+		IndexReader r(d->metaDataData, d->metaDataSize);
+		return deserializeMetaData(r, d->metaData);
+	}
+
+	// Metadata isn't indexed. Copy it from the fallback object.
+	RomData *const fallback = d->getFallback();
+	const RomMetaData *const fbMetaData = (fallback ? fallback->metaData() : nullptr);
+	if (!fbMetaData) {
+		return -ENOENT;
+	}
+	d->metaData = new RomMetaData();
+	d->metaData->addMetaData_metaData(fbMetaData);
+	return d->metaData->count();
+}
+
+/**
+ * Load an internal image.
+ * Internal images aren't indexed, so this uses the fallback object.
+ * @param imageType	[in] Image type to load.
+ * @param pImage	[out] Pointer to const rp_image* to store the image in.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int IndexedRomData::loadInternalImage(ImageType imageType, const LibRpTexture::rp_image **pImage)
+{
+	ASSERT_loadInternalImage(imageType, pImage);
+
+	RP_D(IndexedRomData);
+	*pImage = nullptr;
+	if (!(d->imgbf & (1U << imageType))) {
+		// Image type isn't supported.
+		return -ENOENT;
+	}
+
+	// NOTE: The fallback object owns the image.
+	RomData *const fallback = d->getFallback();
+	if (!fallback) {
+		return -EIO;
+	}
+	*pImage = fallback->image(imageType);
+	return (*pImage ? 0 : -EIO);
+}
+
+/** RomDataIndexPrivate **/
+
+// Index entry magic number.
+const char RomDataIndexPrivate::entry_magic[8] = {'R','P','I','D','X','0','2','\0'};
+
+/**
+ * Get the program version string for index entries.
+ * @return Program version string.
+ */
+const string &RomDataIndexPrivate::programVersion(void)
+{
+	static const string version = string(AboutTabText::prg_version) + '+' + AboutTabText::git_version;
+	return version;
+}
+
+/**
+ * Get a configuration file's modification time.
+ * @param confReader ConfReader for the configuration file.
+ * @return Configuration file's mtime, or 0 if not available.
+ */
+time_t RomDataIndexPrivate::confMtime(const ConfReader *confReader)
+{
+	const char *const filename = confReader->filename();
+	if (!filename)
+		return 0;
+
+	time_t mtime;
+	int ret = FileSystem::get_mtime(filename, &mtime);
+	return (ret == 0 ? mtime : 0);
+}
+
+/**
+ * Can an IRpFile's filename be used to get the file's identity?
+ * @param filename Filename.
+ * @return True if it can; false if not.
+ */
+bool RomDataIndexPrivate::isUsableFilename(const string &filename)
+{
+#ifdef _WIN32
+	// RpFile_IStream may only have the base filename, which would
+	// match the wrong file, so require an absolute path.
+	// Drive letter ("C:\") or UNC path ("\\server\share").
+	if (filename.size() >= 3 && ISALPHA(filename[0]) &&
+	    filename[1] == ':' && (filename[2] == '\\' || filename[2] == '/'))
+	{
+		return true;
+	}
+	return (filename.size() >= 2 && filename[0] == '\\' && filename[1] == '\\');
+#else /* !_WIN32 */
+	return !filename.empty();
+#endif /* _WIN32 */
+}
+
+/**
+ * Get the index entry filename for a file.
+ * @param fileId File identity.
+ * @param attrs RomDataFactory attributes.
+ * @return Index entry filename, or empty string on error.
+ */
+string RomDataIndexPrivate::getEntryFilename(const FileSystem::FileIdentity &fileId, unsigned int attrs)
+{
+	// NOTE: May be empty if the cache directory isn't
+	// accessible, e.g. when running under bubblewrap.
+	const string &cache_dir = LibCacheCommon::getCacheDirectory();
+	if (cache_dir.empty())
+		return string();
+
+	// Entries are grouped by device, then by the low byte
+	// of the inode number in order to keep directories small.
+	// Format: index/[dev]/[ino & 0xFF]/[ino]-[attrs].rpidx
+	char buf[96];
+	snprintf(buf, sizeof(buf), "index%c%08X%08X%c%02X%c%08X%08X-%08X.rpidx",
+		static_cast<char>(DIR_SEP_CHR),
+		static_cast<uint32_t>(fileId.dev >> 32), static_cast<uint32_t>(fileId.dev),
+		static_cast<char>(DIR_SEP_CHR),
+		static_cast<unsigned int>(fileId.ino & 0xFF),
+		static_cast<char>(DIR_SEP_CHR),
+		static_cast<uint32_t>(fileId.ino >> 32), static_cast<uint32_t>(fileId.ino),
+		attrs);
+
+	string entryFilename = cache_dir;
+	if (entryFilename.at(entryFilename.size()-1) != DIR_SEP_CHR) {
+		entryFilename += DIR_SEP_CHR;
+	}
+	entryFilename += buf;
+	return entryFilename;
+}
+
+/**
+ * Load an index entry.
+ * @param entryFilename	[in] Index entry filename.
+ * @param buf		[out] Entry data.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RomDataIndexPrivate::loadEntry(const string &entryFilename, vector<uint8_t> &buf)
+{
+	RpFile *const file = new RpFile(entryFilename, RpFile::FM_OPEN_READ);
+	if (!file->isOpen()) {
+		// Entry doesn't exist.
+		int ret = -file->lastError();
+		file->unref();
+		return (ret != 0 ? ret : -EIO);
+	}
+
+	const off64_t fileSize = file->size();
+	if (fileSize <= 0 || fileSize > static_cast<off64_t>(ENTRY_SIZE_MAX)) {
+		// Invalid entry size.
+		file->unref();
+		return -EIO;
+	}
+
+	buf.resize(static_cast<size_t>(fileSize));
+	const size_t size = file->read(buf.data(), buf.size());
+	file->unref();
+	if (size != buf.size()) {
+		// Short read.
+		buf.clear();
+		return -EIO;
+	}
+	return 0;
+}
+
+/**
+ * Save an index entry.
+ * The entry is written to a temporary file, then renamed,
+ * so other processes will never see a partial entry.
+ * @param entryFilename Index entry filename.
+ * @param buf Entry data.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RomDataIndexPrivate::saveEntry(const string &entryFilename, const vector<uint8_t> &buf)
+{
+	// Make sure the index subdirectory exists.
+	// NOTE: rmkdir() ignores the last component.
+	int ret = FileSystem::rmkdir(entryFilename);
+	if (ret != 0)
+		return ret;
+
+	// Temporary filename.
+	// Multiple threads and/or processes may be indexing
+	// the same file, so make sure the filename is unique.
+	static volatile int tmpCounter = 0;
+	char tmpSuffix[48];
+	snprintf(tmpSuffix, sizeof(tmpSuffix), ".%u-%d.tmp",
+#ifdef _WIN32
+		static_cast<unsigned int>(GetCurrentProcessId()),
+#else /* !_WIN32 */
+		static_cast<unsigned int>(getpid()),
+#endif /* _WIN32 */
+		ATOMIC_INC_FETCH(&tmpCounter));
+	const string tmpFilename = entryFilename + tmpSuffix;
+
+	RpFile *const file = new RpFile(tmpFilename, RpFile::FM_CREATE_WRITE);
+	if (!file->isOpen()) {
+		ret = -file->lastError();
+		file->unref();
+		return (ret != 0 ? ret : -EIO);
+	}
+	const size_t size = file->write(buf.data(), buf.size());
+	file->unref();
+	if (size != buf.size()) {
+		// Short write.
+		FileSystem::delete_file(tmpFilename);
+		return -EIO;
+	}
+
+	ret = FileSystem::rename_file(tmpFilename, entryFilename);
+	if (ret != 0) {
+		FileSystem::delete_file(tmpFilename);
+	}
+	return ret;
+}
+
+/**
+ * Check an index entry's header.
+ * @param entry		[in] Entry data.
+ * @param fileId	[in] File identity.
+ * @param attrs		[in] RomDataFactory attributes.
+ * @param pBodyPos	[out] Position of the entry body.
+ * @param pEntryFlags	[out] Entry flags.
+ * @return True if the header matches; false if not.
+ */
+bool RomDataIndexPrivate::checkHeader(const vector<uint8_t> &entry,
+	const FileSystem::FileIdentity &fileId, unsigned int attrs,
+	size_t *pBodyPos, uint32_t *pEntryFlags)
+{
+	IndexReader r(entry.data(), entry.size());
+	const uint8_t *const magic = r.read(sizeof(entry_magic));
+	if (!magic || memcmp(magic, entry_magic, sizeof(entry_magic)) != 0) {
+		// Incorrect magic number.
+		return false;
+	}
+
+	string version;
+	r.str(version);
+	if (version != programVersion()) {
+		// Entry was created by a different version.
+		return false;
+	}
+
+	if (r.u64() != fileId.dev ||
+	    r.u64() != fileId.ino ||
+	    r.u64() != static_cast<uint64_t>(fileId.size) ||
+	    r.u64() != static_cast<uint64_t>(fileId.mtime))
+	{
+		// File has changed.
+		return false;
+	}
+
+	if (r.u64() != static_cast<uint64_t>(configMtime()) ||
+	    r.u64() != static_cast<uint64_t>(keysMtime()) ||
+	    r.u32() != SystemRegion::getLanguageCode() ||
+	    r.u32() != SystemRegion::getCountryCode() ||
+	    r.u32() != attrs)
+	{
+		// Configuration, keys, and/or system locale has changed.
+		return false;
+	}
+
+	*pEntryFlags = r.u32();
+	if (!r.ok())
+		return false;
+	*pBodyPos = static_cast<size_t>(r.ptr() - entry.data());
+	return true;
+}
+
+/**
+ * Serialize an index entry.
+ * @param buf		[out] Entry data.
+ * @param fileId	[in] File identity.
+ * @param attrs		[in] RomDataFactory attributes.
+ * @param romData	[in,opt] RomData object, or nullptr if the file isn't supported.
+ */
+void RomDataIndexPrivate::serializeEntry(vector<uint8_t> &buf,
+	const FileSystem::FileIdentity &fileId, unsigned int attrs,
+	const RomData *romData)
+{
+	buf.clear();
+	IndexWriter w(buf);
+
+	// Header
+	w.write(entry_magic, sizeof(entry_magic));
+	w.str(programVersion());
+	w.u64(fileId.dev);
+	w.u64(fileId.ino);
+	w.u64(static_cast<uint64_t>(fileId.size));
+	w.u64(static_cast<uint64_t>(fileId.mtime));
+	w.u64(static_cast<uint64_t>(configMtime()));
+	w.u64(static_cast<uint64_t>(keysMtime()));
+	w.u32(SystemRegion::getLanguageCode());
+	w.u32(SystemRegion::getCountryCode());
+	w.u32(attrs);
+	const size_t flagsPos = w.pos();
+	w.u32(0);
+
+	if (!romData) {
+		// File isn't supported.
+		return;
+	}
+	uint32_t entryFlags = ENTRY_SUPPORTED;
+
+	// Only index the data that the caller is going to use.
+	// Anything else is loaded by IndexedRomData's fallback object.
+	// - No attributes: Full property page, e.g. rpcli.
+	// - RDA_HAS_METADATA, RDA_METADATA_ONLY: Metadata extractors.
+	// - RDA_HAS_DPOVERLAY: Overlay icons. (only uses the header data)
+	const bool wantFields = (attrs == 0);
+	const bool wantMetaData = (attrs == 0) ||
+		(attrs & (RomDataFactory::RDA_HAS_METADATA | RomDataFactory::RDA_METADATA_ONLY));
+
+	w.str(romData->className());
+	w.str(romData->mimeType());
+	w.u32(static_cast<uint32_t>(romData->fileType()));
+	for (unsigned int region = 0; region < 2; region++) {
+		for (unsigned int type = 0; type < 3; type++) {
+			w.str(romData->systemName(type | (region ? RomData::SYSNAME_REGION_ROM_LOCAL : 0)));
+		}
+	}
+
+	const uint32_t imgbf = romData->supportedImageTypes();
+	w.u32(imgbf);
+	for (int i = RomData::IMG_INT_MIN; i <= RomData::IMG_EXT_MAX; i++) {
+		w.u32(romData->imgpf(static_cast<RomData::ImageType>(i)));
+	}
+	w.u8(romData->hasDangerousPermissions());
+
+	if (wantFields) {
+		vector<RomData::ExtURL> extURLs;
+		for (int i = RomData::IMG_EXT_MIN; i <= RomData::IMG_EXT_MAX; i++) {
+			if (!(imgbf & (1U << i)))
+				continue;
+
+			const int ret = romData->extURLs(static_cast<RomData::ImageType>(i), &extURLs);
+			w.u32(static_cast<uint32_t>(ret));
+			w.u32(static_cast<uint32_t>(extURLs.size()));
+			for (const RomData::ExtURL &extURL : extURLs) {
+				w.str(extURL.url);
+				w.str(extURL.cache_key);
+				w.u16(extURL.width);
+				w.u16(extURL.height);
+				w.u8(extURL.high_res);
+			}
+		}
+		entryFlags |= ENTRY_HAS_EXTURLS;
+
+		const RomFields *const fields = romData->fields();
+		if (fields) {
+			const size_t sectionPos = w.beginSection();
+			if (serializeFields(w, fields)) {
+				w.endSection(sectionPos);
+				entryFlags |= ENTRY_HAS_FIELDS;
+			} else {
+				// Fields can't be indexed.
+				w.truncate(sectionPos);
+			}
+		}
+	}
+
+	if (wantMetaData) {
+		const RomMetaData *const metaData = romData->metaData();
+		if (metaData) {
+			const size_t sectionPos = w.beginSection();
+			serializeMetaData(w, metaData);
+			w.endSection(sectionPos);
+			entryFlags |= ENTRY_HAS_METADATA;
+		}
+	}
+
+	w.patchU32(flagsPos, entryFlags);
+}
+
+/**
+ * Create a RomData object from an index entry.
+ * @param file		[in] ROM file.
+ * @param attrs		[in] RomDataFactory attributes.
+ * @param fileId	[in] File identity.
+ * @param entry		[in,out] Entry data. (moved into the RomData object on a hit)
+ * @param pHit		[out] Set to true on an index hit; false on a miss.
+ * @return RomData object on a hit, or nullptr if the file isn't supported or on a miss.
+ */
+RomData *RomDataIndexPrivate::createFromEntry(IRpFile *file, unsigned int attrs,
+	const FileSystem::FileIdentity &fileId, vector<uint8_t> &entry, bool *pHit)
+{
+	*pHit = false;
+
+	size_t bodyPos = 0;
+	uint32_t entryFlags = 0;
+	if (!checkHeader(entry, fileId, attrs, &bodyPos, &entryFlags)) {
+		// Entry is stale or corrupted.
+		return nullptr;
+	}
+
+	if (!(entryFlags & ENTRY_SUPPORTED)) {
+		// Index hit: File isn't supported.
+		*pHit = true;
+		return nullptr;
+	}
+
+	// Index hit: File is supported.
+	IndexedRomData *const romData = new IndexedRomData(file, attrs, std::move(entry), bodyPos, entryFlags);
+	if (!romData->isValid()) {
+		// Entry is corrupted.
+		romData->unref();
+		return nullptr;
+	}
+
+	*pHit = true;
+	return romData;
+}
+
+/** RomDataIndex **/
+
+/**
+ * Create a RomData subclass for the specified ROM file,
+ * using the ROM data index if it's enabled.
+ *
+ * The index is stored in the cache directory and maps a file's
+ * identity (device, inode, size, and mtime) to the results of
+ * RomDataFactory::create(): the RomData class, system names,
+ * supported image types, fields, and metadata.
+ *
+ * On an index hit, RomDataFactory::create() is skipped entirely.
+ * The returned RomData object serves the indexed data, and will
+ * only reopen the ROM with RomDataFactory if something that isn't
+ * indexed is requested, e.g. internal images.
+ *
+ * "Not supported" results are indexed, too.
+ *
+ * NOTE: The returned RomData object does not support ROM operations.
+ * Don't use this function if ROM operations are needed.
+ *
+ * If the index is disabled, or if the file doesn't have a usable
+ * identity (e.g. it's not a local file), this is equivalent to
+ * RomDataFactory::create().
+ *
+ * @param file ROM file.
+ * @param attrs RomDataFactory::RomDataAttr bitfield.
+ * @return RomData subclass, or nullptr if the ROM isn't supported.
+ */
+RomData *RomDataIndex::create(IRpFile *file, unsigned int attrs)
+{
+	assert(file != nullptr);
+	if (!file || !Config::instance()->enableRomDataIndex()) {
+		// ROM data index is disabled.
+		return RomDataFactory::create(file, attrs);
+	}
+
+	// Only local files can be indexed.
+	// NOTE: Device files have a size of 0 here.
+	const string filename = file->filename();
+	FileSystem::FileIdentity fileId;
+	if (!RomDataIndexPrivate::isUsableFilename(filename) ||
+	    FileSystem::get_file_identity(filename, &fileId) != 0 ||
+	    fileId.size <= 0)
+	{
+		return RomDataFactory::create(file, attrs);
+	}
+
+	const string entryFilename = RomDataIndexPrivate::getEntryFilename(fileId, attrs);
+	if (entryFilename.empty()) {
+		// Cache directory isn't available.
+		return RomDataFactory::create(file, attrs);
+	}
+
+	vector<uint8_t> entry;
+	if (RomDataIndexPrivate::loadEntry(entryFilename, entry) == 0) {
+		bool hit = false;
+		RomData *const romData = RomDataIndexPrivate::createFromEntry(file, attrs, fileId, entry, &hit);
+		if (hit) {
+			// Index hit.
+			// NOTE: nullptr if the file isn't supported.
+			return romData;
+		}
+	}
+
+	// Index miss.
+	RomData *const romData = RomDataFactory::create(file, attrs);
+	if (!romData || !(attrs & RomDataFactory::RDA_HAS_THUMBNAIL)) {
+		// NOTE: Thumbnailers need the actual images, so only
+		// negative results are indexed for RDA_HAS_THUMBNAIL.
+		RomDataIndexPrivate::serializeEntry(entry, fileId, attrs, romData);
+		RomDataIndexPrivate::saveEntry(entryFilename, entry);
+	}
+	return romData;
+}
+
+}
@@ -0,0 +1,66 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * RomDataIndex.hpp: Persistent RomData detection and metadata index.      *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_ROMDATAINDEX_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_ROMDATAINDEX_HPP__
+
+#include "common.h"
+
+namespace LibRpBase {
+	class RomData;
+}
+namespace LibRpFile {
+	class IRpFile;
+}
+
+namespace LibRomData {
+
+class RomDataIndex
+{
+	private:
+		RomDataIndex();
+		~RomDataIndex();
+	private:
+		RP_DISABLE_COPY(RomDataIndex)
+
+	public:
+		/**
+		 * Create a RomData subclass for the specified ROM file,
+		 * using the ROM data index if it's enabled.
+		 *
+		 * The index is stored in the cache directory and maps a file's
+		 * identity (device, inode, size, and mtime) to the results of
+		 * RomDataFactory::create(): the RomData class, system names,
+		 * supported image types, fields, and metadata. Entries are
+		 * invalidated if the program version, rom-properties.conf,
+		 * keys.conf, or the system locale changes.
+		 *
+		 * On an index hit, RomDataFactory::create() is skipped entirely.
+		 * The returned RomData object serves the indexed data, and will
+		 * only reopen the ROM with RomDataFactory if something that isn't
+		 * indexed is requested, e.g. internal images.
+		 *
+		 * "Not supported" results are indexed, too.
+		 *
+		 * NOTE: The returned RomData object does not support ROM operations.
+		 * Don't use this function if ROM operations are needed.
+		 *
+		 * If the index is disabled, or if the file doesn't have a usable
+		 * identity (e.g. it's not a local file), this is equivalent to
+		 * RomDataFactory::create().
+		 *
+		 * @param file ROM file.
+		 * @param attrs RomDataFactory::RomDataAttr bitfield.
+		 * @return RomData subclass, or nullptr if the ROM isn't supported.
+		 */
+		static LibRpBase::RomData *create(LibRpFile::IRpFile *file, unsigned int attrs = 0);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_ROMDATAINDEX_HPP__ */
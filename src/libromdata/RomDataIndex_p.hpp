@@ -0,0 +1,205 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata)                       *
+ * RomDataIndex_p.hpp: Persistent RomData detection and metadata index.    *
+ * (PRIVATE CLASS)                                                         *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBROMDATA_ROMDATAINDEX_P_HPP__
+#define __ROMPROPERTIES_LIBROMDATA_ROMDATAINDEX_P_HPP__
+
+#include "librpbase/config.librpbase.h"
+
+// C includes.
+#include <stdint.h>
+#include <time.h>
+
+// C++ includes.
+#include <string>
+#include <vector>
+
+// librpbase, librpfile
+#include "librpbase/config/Config.hpp"
+#include "librpbase/crypto/KeyManager.hpp"
+#include "librpfile/FileSystem.hpp"
+
+namespace LibRpBase {
+	class RomData;
+}
+namespace LibRpFile {
+	class IRpFile;
+}
+
+namespace LibRomData {
+
+/**
+ * Index entry layout (all integers are little-endian):
+ *
+ * Header:
+ * - char[8]: Magic number. ("RPIDX02\0")
+ * - str:     Program version. (entries are invalidated on upgrade)
+ * - u64[4]:  File identity. (device, inode, size, mtime)
+ * - u64:     Configuration file mtime.
+ * - u64:     Key store file mtime. (keys.conf)
+ * - u32[2]:  System language and country codes.
+ * - u32:     RomDataFactory attributes.
+ * - u32:     Entry flags. (EntryFlags)
+ *
+ * If ENTRY_SUPPORTED is set:
+ * - str:     Class name, MIME type
+ * - u32:     File type
+ * - str[6]:  System names (SYSNAME_TYPE_* x SYSNAME_REGION_*)
+ * - u32:     Supported image types
+ * - u32[10]: imgpf for each image type
+ * - u8:      hasDangerousPermissions()
+ * - If ENTRY_HAS_EXTURLS: For each supported external image type:
+ *   u32 count, then count x {str url, str cache_key, u16 width, u16 height, u8 high_res}
+ * - If ENTRY_HAS_FIELDS: u32 size, then the serialized RomFields.
+ * - If ENTRY_HAS_METADATA: u32 size, then the serialized RomMetaData.
+ *
+ * Strings are stored as u32 length + UTF-8 data.
+ * nullptr strings have a length of 0xFFFFFFFF.
+ */
+
+class RomDataIndexPrivate
+{
+	private:
+		RomDataIndexPrivate();
+		~RomDataIndexPrivate();
+	private:
+		RP_DISABLE_COPY(RomDataIndexPrivate)
+
+	public:
+		// Index entry magic number.
+		static const char entry_magic[8];
+
+		// Maximum index entry size.
+		static const size_t ENTRY_SIZE_MAX = 16U*1024U*1024U;
+
+		// Entry flags.
+		enum EntryFlags : uint32_t {
+			ENTRY_SUPPORTED		= (1U << 0),	// File is supported.
+			ENTRY_HAS_FIELDS	= (1U << 1),	// RomFields are present.
+			ENTRY_HAS_METADATA	= (1U << 2),	// RomMetaData is present.
+			ENTRY_HAS_EXTURLS	= (1U << 3),	// External image URLs are present.
+		};
+
+		// Number of system name variants.
+		// (SYSNAME_TYPE_LONG, SHORT, ABBREVIATION) x (SYSNAME_REGION_GENERIC, ROM_LOCAL)
+		static const unsigned int SYSNAME_COUNT = 6;
+
+		/**
+		 * Get the program version string for index entries.
+		 * @return Program version string.
+		 */
+		static const std::string &programVersion(void);
+
+		/**
+		 * Can an IRpFile's filename be used to get the file's identity?
+		 * @param filename Filename.
+		 * @return True if it can; false if not.
+		 */
+		static bool isUsableFilename(const std::string &filename);
+
+		/**
+		 * Get the index entry filename for a file.
+		 * @param fileId File identity.
+		 * @param attrs RomDataFactory attributes.
+		 * @return Index entry filename, or empty string on error.
+		 */
+		static std::string getEntryFilename(const LibRpFile::FileSystem::FileIdentity &fileId, unsigned int attrs);
+
+		/**
+		 * Load an index entry.
+		 * @param entryFilename	[in] Index entry filename.
+		 * @param buf		[out] Entry data.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int loadEntry(const std::string &entryFilename, std::vector<uint8_t> &buf);
+
+		/**
+		 * Save an index entry.
+		 * The entry is written to a temporary file, then renamed,
+		 * so other processes will never see a partial entry.
+		 * @param entryFilename Index entry filename.
+		 * @param buf Entry data.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int saveEntry(const std::string &entryFilename, const std::vector<uint8_t> &buf);
+
+		/**
+		 * Get a configuration file's modification time.
+		 * @param confReader ConfReader for the configuration file.
+		 * @return Configuration file's mtime, or 0 if not available.
+		 */
+		static time_t confMtime(const LibRpBase::ConfReader *confReader);
+
+		/**
+		 * Get the configuration file's modification time.
+		 * Entries are invalidated if the configuration changes,
+		 * since some RomData subclasses check the configuration.
+		 * @return Configuration file's mtime, or 0 if not available.
+		 */
+		static inline time_t configMtime(void)
+		{
+			return confMtime(LibRpBase::Config::instance());
+		}
+
+		/**
+		 * Get the key store file's modification time.
+		 * Entries are invalidated if the key store changes,
+		 * since encrypted formats show different fields
+		 * depending on which keys are available.
+		 * @return keys.conf's mtime, or 0 if not available.
+		 */
+		static inline time_t keysMtime(void)
+		{
+#ifdef ENABLE_DECRYPTION
+			return confMtime(LibRpBase::KeyManager::instance());
+#else /* !ENABLE_DECRYPTION */
+			return 0;
+#endif /* ENABLE_DECRYPTION */
+		}
+
+		/**
+		 * Check an index entry's header.
+		 * @param entry		[in] Entry data.
+		 * @param fileId	[in] File identity.
+		 * @param attrs		[in] RomDataFactory attributes.
+		 * @param pBodyPos	[out] Position of the entry body.
+		 * @param pEntryFlags	[out] Entry flags.
+		 * @return True if the header matches; false if not.
+		 */
+		static bool checkHeader(const std::vector<uint8_t> &entry,
+			const LibRpFile::FileSystem::FileIdentity &fileId, unsigned int attrs,
+			size_t *pBodyPos, uint32_t *pEntryFlags);
+
+		/**
+		 * Serialize an index entry.
+		 * @param buf		[out] Entry data.
+		 * @param fileId	[in] File identity.
+		 * @param attrs		[in] RomDataFactory attributes.
+		 * @param romData	[in,opt] RomData object, or nullptr if the file isn't supported.
+		 */
+		static void serializeEntry(std::vector<uint8_t> &buf,
+			const LibRpFile::FileSystem::FileIdentity &fileId, unsigned int attrs,
+			const LibRpBase::RomData *romData);
+
+		/**
+		 * Create a RomData object from an index entry.
+		 * @param file		[in] ROM file.
+		 * @param attrs		[in] RomDataFactory attributes.
+		 * @param fileId	[in] File identity.
+		 * @param entry		[in,out] Entry data. (moved into the RomData object on a hit)
+		 * @param pHit		[out] Set to true on an index hit; false on a miss.
+		 * @return RomData object on a hit, or nullptr if the file isn't supported or on a miss.
+		 */
+		static LibRpBase::RomData *createFromEntry(LibRpFile::IRpFile *file, unsigned int attrs,
+			const LibRpFile::FileSystem::FileIdentity &fileId, std::vector<uint8_t> &entry, bool *pHit);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBROMDATA_ROMDATAINDEX_P_HPP__ */
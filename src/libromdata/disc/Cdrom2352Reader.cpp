@@ -196,7 +196,7 @@ int Cdrom2352Reader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t siz
 	// NOTE 2: No changes neeed for 2448-byte mode, since subchannels are
 	// stored *after* the 2352-byte sector data.
 	CDROM_2352_Sector_t sector;
-	size_t sz_read = m_file->seekAndRead(physBlockAddr, &sector, sizeof(sector));
+	size_t sz_read = m_file->readAt(physBlockAddr, &sector, sizeof(sector));
 	m_lastError = m_file->lastError();
 	if (sz_read != sizeof(sector)) {
 		// Read error.
@@ -39,12 +39,17 @@
 #  endif
 #endif /* HAVE_LZO */
 
-// librpbase, librpfile
+// librpthreads
+#include "librpthreads/ThreadPool.hpp"
+
+// librpbase, librpfile, librpthreads
 using namespace LibRpBase;
 using LibRpFile::IRpFile;
+using LibRpThreads::ThreadPool;
 
 // C++ STL classes.
 using std::unique_ptr;
+using std::vector;
 
 namespace LibRomData {
 
@@ -59,6 +64,9 @@ DELAYLOAD_TEST_FUNCTION_IMPL0(lzo_version);
 #  endif /* HAVE_LZO */
 #endif /* _MSC_VER */
 
+// Maximum number of blocks to decompress concurrently in a single batch.
+static const unsigned int CISO_DECOMPRESS_BATCH_MAX = 64;
+
 class CisoPspReaderPrivate : public SparseDiscReaderPrivate {
 	public:
 		CisoPspReaderPrivate(CisoPspReader *q);
@@ -103,13 +111,9 @@ class CisoPspReaderPrivate : public SparseDiscReaderPrivate {
 		bool isDaxWithoutNCTable;	// Convenience variable.
 		uint8_t index_shift;		// Index shift value.
 
-		// Block cache.
-		ao::uvector<uint8_t> blockCache;
-		uint32_t blockCacheIdx;
-
-		// Decompression buffer.
-		// (Same size as blockCache.)
-		ao::uvector<uint8_t> z_buffer;
+		// NOTE: Recently-used blocks are cached by SparseDiscReader.
+		// readBlock() and readBlocks() may be called from multiple
+		// threads at once, so they use local buffers.
 
 		/**
 		 * Get the compressed size of a block.
@@ -117,6 +121,59 @@ class CisoPspReaderPrivate : public SparseDiscReaderPrivate {
 		 * @return Block's compressed size, or 0 on error.
 		 */
 		uint32_t getBlockCompressedSize(uint32_t blockNum) const;
+
+		enum class CompressionMode {
+			None = 0,
+			Deflate = 1,
+			LZ4 = 2,
+			LZO = 3,
+		};
+
+		/**
+		 * Get the physical address and compression information of a block.
+		 * @param blockIdx		[in] Block index.
+		 * @param pPhysBlockAddr	[out] Physical address of the block data.
+		 * @param pZBlockSize		[out] Size of the block data. (Uncompressed blocks: block_size)
+		 * @param pZMode		[out] Compression mode.
+		 * @param pWindowBits		[out] zlib windowBits. (Deflate only)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int getBlockInfo(uint32_t blockIdx, off64_t *pPhysBlockAddr,
+			uint32_t *pZBlockSize, CompressionMode *pZMode, int *pWindowBits) const;
+
+		/**
+		 * Decompress a block.
+		 * This function is thread-safe.
+		 * @param z_mode	[in] Compression mode. (must not be None)
+		 * @param windowBits	[in] zlib windowBits. (Deflate only)
+		 * @param pZData	[in] Compressed data.
+		 * @param z_block_size	[in] Size of the compressed data.
+		 * @param pOut		[out] Output buffer. (Must be block_size bytes!)
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int decompressBlock(CompressionMode z_mode, int windowBits,
+			const uint8_t *pZData, uint32_t z_block_size, uint8_t *pOut) const;
+
+		// Parallel decompression job.
+		struct DecompressJob {
+			const uint8_t *pZData;	// Compressed data.
+			uint8_t *pOut;		// Output buffer.
+			uint32_t z_block_size;	// Compressed size.
+			int windowBits;		// zlib windowBits. (Deflate only)
+			CompressionMode z_mode;	// Compression mode.
+			int ret;		// Result. (0 on success; negative POSIX error code on error.)
+		};
+		struct DecompressBatch {
+			const CisoPspReaderPrivate *d;
+			DecompressJob *jobs;
+		};
+
+		/**
+		 * ThreadPool task function for parallel decompression.
+		 * @param param DecompressBatch*
+		 * @param index Job index.
+		 */
+		static void decompressTask(void *param, unsigned int index);
 };
 
 /** CisoPspReaderPrivate **/
@@ -126,7 +183,6 @@ CisoPspReaderPrivate::CisoPspReaderPrivate(CisoPspReader *q)
 	, cisoType(CisoType::Unknown)
 	, isDaxWithoutNCTable(false)
 	, index_shift(0)
-	, blockCacheIdx(~0U)
 {
 	// Clear the header structs.
 	memset(&header, 0, sizeof(header));
@@ -192,6 +248,271 @@ uint32_t CisoPspReaderPrivate::getBlockCompressedSize(uint32_t blockNum) const
 	return size;
 }
 
+/**
+ * Get the physical address and compression information of a block.
+ * @param blockIdx		[in] Block index.
+ * @param pPhysBlockAddr	[out] Physical address of the block data.
+ * @param pZBlockSize		[out] Size of the block data. (Uncompressed blocks: block_size)
+ * @param pZMode		[out] Compression mode.
+ * @param pWindowBits		[out] zlib windowBits. (Deflate only)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CisoPspReaderPrivate::getBlockInfo(uint32_t blockIdx, off64_t *pPhysBlockAddr,
+	uint32_t *pZBlockSize, CompressionMode *pZMode, int *pWindowBits) const
+{
+	// Get the physical address first.
+	const uint32_t indexEntry = indexEntries[blockIdx];
+	uint32_t z_block_size = getBlockCompressedSize(blockIdx);
+	if (z_block_size == 0) {
+		// Unable to get the block's compressed size...
+		return -EIO;
+	}
+
+	CompressionMode z_mode;
+	int windowBits = 0;
+
+	off64_t physBlockAddr;
+	switch (cisoType) {
+		default:
+		case CisoType::Unknown:
+			assert(!"Unsupported CisoType.");
+			return -ENOTSUP;
+
+		case CisoType::CISO:
+			// CISO uses raw deflate.
+			windowBits = -15;
+
+			// Mask off the compression bit, and shift the address
+			// based on the index shift.
+			physBlockAddr = static_cast<off64_t>(indexEntry & ~CISO_PSP_V0_NOT_COMPRESSED);
+			physBlockAddr <<= index_shift;
+
+			if (header.cisoPsp.version < 2) {
+				// CISO v0/v1: Check if compressed.
+				z_mode = (indexEntry & CISO_PSP_V0_NOT_COMPRESSED)
+					? CompressionMode::None
+					: CompressionMode::Deflate;
+			} else {
+				// CISO v2: Check if compressed, and if so, which algorithm.
+				if (z_block_size == block_size) {
+					z_mode = CompressionMode::None;
+				} else {
+					z_mode = (indexEntry & CISO_PSP_V2_LZ4_COMPRESSED)
+						? CompressionMode::LZ4
+						: CompressionMode::Deflate;
+				}
+			}
+			break;
+
+#ifdef HAVE_LZ4
+		case CisoType::ZISO:
+			// ZISO uses LZ4.
+
+			// Mask off the compression bit, and shift the address
+			// based on the index shift.
+			physBlockAddr = static_cast<off64_t>(indexEntry & ~CISO_PSP_V0_NOT_COMPRESSED);
+			physBlockAddr <<= index_shift;
+
+			z_mode = (indexEntry & CISO_PSP_V0_NOT_COMPRESSED)
+				? CompressionMode::None
+				: CompressionMode::LZ4;
+			break;
+#endif /* HAVE_LZ4 */
+
+#ifdef HAVE_LZO
+		case CisoType::JISO:
+			// JISO uses LZO or zlib.
+			// TODO: Verify the rest of this.
+
+			// JISO does *not* indicate compression using the high bit.
+			// Instead, the compressed block size will match the uncompressed
+			// block size, similar to CISOv2.
+			physBlockAddr = static_cast<off64_t>(indexEntry);
+			physBlockAddr <<= index_shift;
+
+			if (header.jiso.block_headers) {
+				// Block headers are present.
+				// TODO: jiso.exe says this can provide for "faster decompression".
+				if (z_block_size <= 4) {
+					// Incorrect block size.
+					return -EIO;
+				}
+				physBlockAddr += 4;
+				z_block_size -= 4;
+			}
+
+			if (z_block_size == block_size) {
+				z_mode = CompressionMode::None;
+			} else {
+				switch (header.jiso.method) {
+					case JISO_METHOD_LZO:
+						z_mode = CompressionMode::LZO;
+						break;
+					case JISO_METHOD_ZLIB:
+						// JISO zlib uses raw deflate.
+						windowBits = -15;
+						z_mode = CompressionMode::Deflate;
+						break;
+					default:
+						assert(!"Unsupported JISO compression method.");
+						return -ENOTSUP;
+				}
+			}
+			break;
+#endif /* HAVE_LZO */
+
+		case CisoType::DAX:
+			physBlockAddr = static_cast<off64_t>(indexEntry);
+			if (header.dax.nc_areas > 0 && daxNCTable[blockIdx]) {
+				// Uncompressed block.
+				z_mode = CompressionMode::None;
+			} else {
+				// Compressed block.
+				// DAX uses zlib deflate.
+				windowBits = 15;
+				z_mode = CompressionMode::Deflate;
+			}
+			break;
+	}
+
+	if (z_mode == CompressionMode::None) {
+		// (Un)compressed block size must be at least the actual block size.
+		// NOTE: The index entries may be aligned using index_shift,
+		// so uncompressed blocks can have padding after the data.
+		if (z_block_size < block_size) {
+			// Error...
+			return -EIO;
+		}
+		// Only read the block data, not the padding.
+		z_block_size = block_size;
+	} else {
+		uint32_t z_max_size = block_size;
+		if (unlikely(isDaxWithoutNCTable)) {
+			// DAX without NC table can end up compressing to larger
+			// than the uncompressed size.
+			z_max_size *= 2;
+		}
+		if (z_block_size > z_max_size) {
+			// Compressed data is larger than the uncompressed block size.
+			// This is only allowed for DAX without NC table.
+			return -EIO;
+		}
+	}
+
+	*pPhysBlockAddr = physBlockAddr;
+	*pZBlockSize = z_block_size;
+	*pZMode = z_mode;
+	*pWindowBits = windowBits;
+	return 0;
+}
+
+/**
+ * Decompress a block.
+ * This function is thread-safe.
+ * @param z_mode	[in] Compression mode. (must not be None)
+ * @param windowBits	[in] zlib windowBits. (Deflate only)
+ * @param pZData	[in] Compressed data.
+ * @param z_block_size	[in] Size of the compressed data.
+ * @param pOut		[out] Output buffer. (Must be block_size bytes!)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CisoPspReaderPrivate::decompressBlock(CompressionMode z_mode, int windowBits,
+	const uint8_t *pZData, uint32_t z_block_size, uint8_t *pOut) const
+{
+	switch (z_mode) {
+		default:
+			assert(!"Compression mode not supported...");
+			return -ENOTSUP;
+
+		case CompressionMode::Deflate: {
+			assert(windowBits != 0);
+			if (windowBits == 0) {
+				return -EINVAL;
+			}
+
+			// Decompress the data.
+			z_stream z = { };
+			z.next_in = const_cast<Bytef*>(pZData);
+			z.avail_in = z_block_size;
+			z.next_out = pOut;
+			z.avail_out = block_size;
+			inflateInit2(&z, windowBits);
+
+			int status = inflate(&z, Z_FULL_FLUSH);
+			const uint32_t uncomp_size = block_size - z.avail_out;
+			inflateEnd(&z);
+
+			if (status != Z_STREAM_END || uncomp_size != block_size) {
+				// Decompression error.
+				// TODO: Print warnings and/or more comprehensive error codes.
+				return -EIO;
+			}
+			break;
+		}
+
+		case CompressionMode::LZ4: {
+#ifdef HAVE_LZ4
+			// Decompress the data.
+			int size = LZ4_decompress_safe(
+				reinterpret_cast<const char*>(pZData),
+				reinterpret_cast<char*>(pOut),
+				z_block_size, block_size);
+			if (size != (int)block_size) {
+				// Decompression error.
+				// TODO: Print warnings and/or more comprehensive error codes.
+				return -EIO;
+			}
+			break;
+#else /* !HAVE_LZ4 */
+			// TODO: If it's CISOv2, check for LZ4-compressed blocks and fail early?
+			assert(!"LZ4 is not enabled in this build.");
+			return -EIO;
+#endif /* HAVE_LZ4 */
+		}
+
+		case CompressionMode::LZO: {
+#ifdef HAVE_LZO
+			// Decompress the data.
+			// TODO: LZO in-place decompression?
+			lzo_uint dst_len = block_size;
+			int ret = lzo1x_decompress_safe(
+				pZData, z_block_size,
+				pOut, &dst_len,
+				nullptr);
+			if (ret != LZO_E_OK || dst_len != block_size) {
+				// Decompression error.
+				// TODO: Print warnings and/or more comprehensive error codes.
+				return -EIO;
+			}
+			break;
+#else /* !HAVE_LZO */
+			assert(!"LZO is not enabled in this build.");
+			return -EIO;
+#endif /* HAVE_LZO */
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * ThreadPool task function for parallel decompression.
+ * @param param DecompressBatch*
+ * @param index Job index.
+ */
+void CisoPspReaderPrivate::decompressTask(void *param, unsigned int index)
+{
+	const DecompressBatch *const batch = static_cast<const DecompressBatch*>(param);
+	DecompressJob *const job = &batch->jobs[index];
+	if (job->z_mode == CompressionMode::None) {
+		memcpy(job->pOut, job->pZData, batch->d->block_size);
+		job->ret = 0;
+	} else {
+		job->ret = batch->d->decompressBlock(job->z_mode, job->windowBits,
+			job->pZData, job->z_block_size, job->pOut);
+	}
+}
+
 /** CisoPspReader **/
 
 CisoPspReader::CisoPspReader(IRpFile *file)
@@ -472,19 +793,6 @@ CisoPspReader::CisoPspReader(IRpFile *file)
 		}
 	}
 
-	// Initialize the block cache and decompression buffer.
-	// NOTE: Extra 64 bytes is for zlib, in case it needs it.
-	size_t cache_size = d->block_size + 64;
-	if (d->isDaxWithoutNCTable) {
-		// DAX with no NC table. Use double the block size,
-		// since zlib-compressed data can end up taking up
-		// more space than uncompressed.
-		cache_size *= 2;
-	}
-	d->blockCache.resize(cache_size);
-	d->z_buffer.resize(cache_size);
-	d->blockCacheIdx = ~0U;
-
 	// Reset the disc position.
 	d->pos = 0;
 }
@@ -750,323 +1058,185 @@ int CisoPspReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 		return 0;
 	}
 
-	if (blockIdx == d->blockCacheIdx) {
-		// Block is cached.
-		memcpy(ptr, &d->blockCache[pos], size);
-		return size;
-	}
-
-	// Get the physical address first.
-	const uint32_t indexEntry = d->indexEntries[blockIdx];
-	uint32_t z_block_size = d->getBlockCompressedSize(blockIdx);
-	if (z_block_size == 0) {
-		// Unable to get the block's compressed size...
-		m_lastError = EIO;
+	if (d->cisoType == CisoPspReaderPrivate::CisoType::Unknown) {
+		assert(!"Unsupported CisoType.");
+		UNREF_AND_NULL_NOCHK(m_file);
+		m_lastError = ENOTSUP;
 		return 0;
 	}
 
-	enum class CompressionMode {
-		None = 0,
-		Deflate = 1,
-		LZ4 = 2,
-		LZO = 3,
-	};
-	CompressionMode z_mode;
-	int windowBits = 0;
+	// Full blocks are read directly into the output buffer.
+	// Partial blocks are read into a temporary block buffer first.
+	// NOTE: Not using a shared buffer, since this function
+	// may be called from multiple threads at once.
+	const bool isFullBlock = (pos == 0 && size == d->block_size);
+	ao::uvector<uint8_t> tmpBlockBuf;
+	if (!isFullBlock) {
+		tmpBlockBuf.resize(d->block_size);
+	}
+	uint8_t *const blockBuf = (isFullBlock ? static_cast<uint8_t*>(ptr) : tmpBlockBuf.data());
 
+	// Get the physical address and compression mode.
 	off64_t physBlockAddr;
-	switch (d->cisoType) {
-		default:
-		case CisoPspReaderPrivate::CisoType::Unknown:
-			assert(!"Unsupported CisoType.");
-			UNREF_AND_NULL_NOCHK(m_file);
-			m_lastError = ENOTSUP;
-			return 0;
-
-		case CisoPspReaderPrivate::CisoType::CISO:
-			// CISO uses raw deflate.
-			windowBits = -15;
-
-			// Mask off the compression bit, and shift the address
-			// based on the index shift.
-			physBlockAddr = static_cast<off64_t>(indexEntry & ~CISO_PSP_V0_NOT_COMPRESSED);
-			physBlockAddr <<= d->index_shift;
-
-			if (d->header.cisoPsp.version < 2) {
-				// CISO v0/v1: Check if compressed.
-				z_mode = (indexEntry & CISO_PSP_V0_NOT_COMPRESSED)
-					? CompressionMode::None
-					: CompressionMode::Deflate;
-
-				if (z_mode == CompressionMode::None) {
-					// (Un)compressed block size must match the actual block size.
-					if (z_block_size != d->block_size) {
-						// Error...
-						m_lastError = EIO;
-						return 0;
-					}
-				}
-			} else {
-				// CISO v2: Check if compressed, and if so, which algorithm.
-				if (z_block_size == d->block_size) {
-					z_mode = CompressionMode::None;
-				} else {
-					z_mode = (indexEntry & CISO_PSP_V2_LZ4_COMPRESSED)
-						? CompressionMode::LZ4
-						: CompressionMode::Deflate;
-				}
-			}
-			break;
-
-#ifdef HAVE_LZ4
-		case CisoPspReaderPrivate::CisoType::ZISO:
-			// ZISO uses LZ4.
-
-			// Mask off the compression bit, and shift the address
-			// based on the index shift.
-			physBlockAddr = static_cast<off64_t>(indexEntry & ~CISO_PSP_V0_NOT_COMPRESSED);
-			physBlockAddr <<= d->index_shift;
-
-			z_mode = (indexEntry & CISO_PSP_V0_NOT_COMPRESSED)
-				? CompressionMode::None
-				: CompressionMode::LZ4;
-			break;
-#endif /* HAVE_LZ4 */
-
-#ifdef HAVE_LZO
-		case CisoPspReaderPrivate::CisoType::JISO:
-			// JISO uses LZO or zlib.
-			// TODO: Verify the rest of this.
-
-			// JISO does *not* indicate compression using the high bit.
-			// Instead, the compressed block size will match the uncompressed
-			// block size, similar to CISOv2.
-			physBlockAddr = static_cast<off64_t>(indexEntry);
-			physBlockAddr <<= d->index_shift;
-
-			if (d->header.jiso.block_headers) {
-				// Block headers are present.
-				// TODO: jiso.exe says this can provide for "faster decompression".
-				if (z_block_size <= 4) {
-					// Incorrect block size.
-					m_lastError = EIO;
-					return 0;
-				}
-				physBlockAddr += 4;
-				z_block_size -= 4;
-			}
-
-			if (z_block_size == d->block_size) {
-				z_mode = CompressionMode::None;
-			} else {
-				switch (d->header.jiso.method) {
-					case JISO_METHOD_LZO:
-						z_mode = CompressionMode::LZO;
-						break;
-					case JISO_METHOD_ZLIB:
-						// JISO zlib uses raw deflate.
-						windowBits = -15;
-						z_mode = CompressionMode::Deflate;
-						break;
-					default:
-						assert(!"Unsupported JISO compression method.");
-						m_lastError = ENOTSUP;
-						return 0;
-				}
-			}
-			break;
-#endif /* HAVE_LZO */
-
-		case CisoPspReaderPrivate::CisoType::DAX:
-			physBlockAddr = static_cast<off64_t>(indexEntry);
-			if (d->header.dax.nc_areas > 0 && d->daxNCTable[blockIdx]) {
-				// Uncompressed block.
-				z_mode = CompressionMode::None;
-			} else {
-				// Compressed block.
-				// DAX uses zlib deflate.
-				windowBits = 15;
-				z_mode = CompressionMode::Deflate;
-			}
-			break;
+	uint32_t z_block_size;
+	CisoPspReaderPrivate::CompressionMode z_mode;
+	int windowBits;
+	int ret = d->getBlockInfo(blockIdx, &physBlockAddr, &z_block_size, &z_mode, &windowBits);
+	if (ret != 0) {
+		m_lastError = -ret;
+		return 0;
 	}
 
-	switch (z_mode) {
-		default:
-			assert(!"Compression mode not supported...");
-			m_lastError = ENOTSUP;
-			return 0;
-
-		case CompressionMode::None: {
-			// Reading uncompressed data directly into the cache.
-			size_t sz_read = m_file->seekAndRead(physBlockAddr, d->blockCache.data(), z_block_size);
-			if (sz_read != z_block_size) {
-				// Seek and/or read error.
-				d->blockCacheIdx = ~0U;
-				m_lastError = m_file->lastError();
-				if (m_lastError == 0) {
-					m_lastError = EIO;
-				}
-				return 0;
+	if (z_mode == CisoPspReaderPrivate::CompressionMode::None) {
+		// Reading uncompressed data directly into the block buffer.
+		size_t sz_read = m_file->readAt(physBlockAddr, blockBuf, z_block_size);
+		if (sz_read != z_block_size) {
+			// Seek and/or read error.
+			m_lastError = m_file->lastError();
+			if (m_lastError == 0) {
+				m_lastError = EIO;
 			}
-			d->blockCacheIdx = blockIdx;
-			break;
+			return 0;
 		}
-
-		case CompressionMode::Deflate: {
-			// Read compressed data into a temporary buffer,
-			// then decompress it.
-			assert(windowBits != 0);
-			if (windowBits == 0) {
-				m_lastError = EINVAL;
-			}
-			uint32_t z_max_size = d->block_size;
-			if (unlikely(d->isDaxWithoutNCTable)) {
-				// DAX without NC table can end up compressing to larger
-				// than the uncompressed size.
-				z_max_size *= 2;
-			}
-			if (z_block_size > z_max_size) {
-				// Compressed data is larger than the uncompressed block size.
-				// This is only allowed for DAX without NC table.
+	} else {
+		// Read compressed data into a temporary buffer,
+		// then decompress it.
+		ao::uvector<uint8_t> z_buffer(z_block_size);
+		size_t sz_read = m_file->readAt(physBlockAddr, z_buffer.data(), z_block_size);
+		if (sz_read != z_block_size) {
+			// Seek and/or read error.
+			m_lastError = m_file->lastError();
+			if (m_lastError == 0) {
 				m_lastError = EIO;
-				return 0;
 			}
+			return 0;
+		}
 
-			size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
-			if (sz_read != z_block_size) {
-				// Seek and/or read error.
-				m_lastError = m_file->lastError();
-				if (m_lastError == 0) {
-					m_lastError = EIO;
-				}
-				return 0;
-			}
+		ret = d->decompressBlock(z_mode, windowBits, z_buffer.data(), z_block_size, blockBuf);
+		if (ret != 0) {
+			// Decompression error.
+			m_lastError = -ret;
+			return 0;
+		}
+	}
 
-			// Decompress the data.
-			z_stream z = { };
-			z.next_in = d->z_buffer.data();
-			z.avail_in = z_block_size;
-			z.next_out = d->blockCache.data();
-			z.avail_out = d->block_size;
-			inflateInit2(&z, windowBits);
+	if (!isFullBlock) {
+		// Copy the requested part of the block.
+		memcpy(ptr, &blockBuf[pos], size);
+	}
+	return size;
+}
 
-			int status = inflate(&z, Z_FULL_FLUSH);
-			const uint32_t uncomp_size = d->block_size - z.avail_out;
-			inflateEnd(&z);
+/**
+ * Read multiple full blocks.
+ *
+ * The compressed data is read on the calling thread,
+ * and then the blocks are decompressed concurrently
+ * directly into the output buffer.
+ *
+ * @param blockIdx	[in] First block index.
+ * @param count		[in] Number of blocks.
+ * @param ptr		[out] Output data buffer. (Must be at least count * block_size bytes!)
+ * @return Number of full blocks read.
+ */
+unsigned int CisoPspReader::readBlocks(uint32_t blockIdx, unsigned int count, void *ptr)
+{
+	RP_D(CisoPspReader);
+	ThreadPool *const pool = ThreadPool::instance();
+	if (count < 2 || pool->threadCount() < 2 ||
+	    d->cisoType == CisoPspReaderPrivate::CisoType::Unknown)
+	{
+		// Not worth decompressing concurrently.
+		return super::readBlocks(blockIdx, count, ptr);
+	}
 
-			if (status != Z_STREAM_END || uncomp_size != d->block_size) {
-				// Decompression error.
-				// TODO: Print warnings and/or more comprehensive error codes.
-				d->blockCacheIdx = ~0U;
-				m_lastError = EIO;
-				return 0;
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	const uint32_t block_size = d->block_size;
+
+	vector<CisoPspReaderPrivate::DecompressJob> jobs;
+	vector<off64_t> physAddrs;
+	jobs.reserve(std::min(count, CISO_DECOMPRESS_BATCH_MAX));
+	physAddrs.reserve(jobs.capacity());
+
+	// Compressed data buffer.
+	ao::uvector<uint8_t> z_batch_buffer;
+
+	unsigned int blocksRead = 0;
+	while (blocksRead < count) {
+		const unsigned int batchCount = std::min(count - blocksRead, CISO_DECOMPRESS_BATCH_MAX);
+		const uint32_t batchIdx = blockIdx + blocksRead;
+
+		// Get the compressed block information.
+		jobs.clear();
+		physAddrs.clear();
+		size_t z_total = 0;
+		for (unsigned int i = 0; i < batchCount; i++) {
+			CisoPspReaderPrivate::DecompressJob job;
+			off64_t physBlockAddr;
+			int ret = d->getBlockInfo(batchIdx + i, &physBlockAddr,
+				&job.z_block_size, &job.z_mode, &job.windowBits);
+			if (ret != 0) {
+				// Invalid block.
+				m_lastError = -ret;
+				return blocksRead;
 			}
-			break;
+			job.pZData = nullptr;
+			job.pOut = ptr8 + (static_cast<size_t>(i) * block_size);
+			job.ret = -EIO;
+			jobs.push_back(job);
+
+			physAddrs.push_back(physBlockAddr);
+			z_total += job.z_block_size;
 		}
 
-		case CompressionMode::LZ4: {
-#ifdef HAVE_LZ4
-			// Read compressed data into a temporary buffer,
-			// then decompress it.
-			uint32_t z_max_size = d->block_size;
-			if (unlikely(d->isDaxWithoutNCTable)) {
-				// DAX without NC table can end up compressing to larger
-				// than the uncompressed size.
-				z_max_size *= 2;
-			}
-			if (z_block_size > z_max_size) {
-				// Compressed data is larger than the uncompressed block size.
-				// This is only allowed for DAX without NC table.
-				m_lastError = EIO;
-				return 0;
+		// Read the compressed data.
+		// Contiguous blocks are read with a single readAt() call.
+		z_batch_buffer.resize(z_total);
+		uint8_t *pZData = z_batch_buffer.data();
+		for (unsigned int i = 0; i < batchCount; ) {
+			unsigned int j = i + 1;
+			size_t run_size = jobs[i].z_block_size;
+			while (j < batchCount && physAddrs[j] == physAddrs[i] + static_cast<off64_t>(run_size)) {
+				run_size += jobs[j].z_block_size;
+				j++;
 			}
 
-			size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
-			if (sz_read != z_block_size) {
+			const size_t sz_read = m_file->readAt(physAddrs[i], pZData, run_size);
+			if (sz_read != run_size) {
 				// Seek and/or read error.
 				m_lastError = m_file->lastError();
 				if (m_lastError == 0) {
 					m_lastError = EIO;
 				}
-				return 0;
+				return blocksRead;
 			}
 
-			// Decompress the data.
-			int size = LZ4_decompress_safe(
-				reinterpret_cast<const char*>(d->z_buffer.data()),
-				reinterpret_cast<char*>(d->blockCache.data()),
-				z_block_size, d->block_size);
-			if (size != (int)d->block_size) {
-				// Decompression error.
-				// TODO: Print warnings and/or more comprehensive error codes.
-				d->blockCacheIdx = ~0U;
-				m_lastError = EIO;
-				return 0;
+			for (; i < j; i++) {
+				jobs[i].pZData = pZData;
+				pZData += jobs[i].z_block_size;
 			}
-			break;
-#else /* !HAVE_LZ4 */
-			// TODO: If it's CISOv2, check for LZ4-compressed blocks and fail early?
-			assert(!"LZ4 is not enabled in this build.");
-			m_lastError = EIO;
-			return 0;
-#endif /* HAVE_LZ4 */
 		}
 
-		case CompressionMode::LZO: {
-#ifdef HAVE_LZO
-			// Read compressed data into a temporary buffer,
-			// then decompress it.
-			uint32_t z_max_size = d->block_size;
-			if (unlikely(d->isDaxWithoutNCTable)) {
-				// DAX without NC table can end up compressing to larger
-				// than the uncompressed size.
-				z_max_size *= 2;
-			}
-			if (z_block_size > z_max_size) {
-				// Compressed data is larger than the uncompressed block size.
-				// This is only allowed for DAX without NC table.
-				m_lastError = EIO;
-				return 0;
-			}
-
-			size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
-			if (sz_read != z_block_size) {
-				// Seek and/or read error.
-				m_lastError = m_file->lastError();
-				if (m_lastError == 0) {
-					m_lastError = EIO;
-				}
-				return 0;
-			}
+		// Decompress the blocks.
+		CisoPspReaderPrivate::DecompressBatch batch;
+		batch.d = d;
+		batch.jobs = jobs.data();
+		pool->parallelFor(batchCount, CisoPspReaderPrivate::decompressTask, &batch);
 
-			// Decompress the data.
-			// TODO: LZO in-place decompression?
-			lzo_uint dst_len = d->block_size;
-			int ret = lzo1x_decompress_safe(
-				d->z_buffer.data(), z_block_size,
-				d->blockCache.data(), &dst_len,
-				nullptr);
-			if (ret != LZO_E_OK || dst_len != d->block_size) {
+		// Check for errors.
+		for (unsigned int i = 0; i < batchCount; i++) {
+			if (jobs[i].ret != 0) {
 				// Decompression error.
-				// TODO: Print warnings and/or more comprehensive error codes.
-				d->blockCacheIdx = ~0U;
-				m_lastError = EIO;
-				return 0;
+				m_lastError = -jobs[i].ret;
+				return blocksRead + i;
 			}
-			break;
-#else /* !HAVE_LZO */
-			assert(!"LZO is not enabled in this build.");
-			m_lastError = EIO;
-			return 0;
-#endif /* HAVE_LZO */
 		}
+
+		blocksRead += batchCount;
+		ptr8 += static_cast<size_t>(batchCount) * block_size;
 	}
 
-	// Block has been loaded into the cache.
-	memcpy(ptr, &d->blockCache[pos], size);
-	d->blockCacheIdx = blockIdx;
-	return size;
+	return blocksRead;
 }
 
 }
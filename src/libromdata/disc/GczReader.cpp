@@ -24,12 +24,17 @@
 #  include "libwin32common/DelayLoadHelper.h"
 #endif /* _MSC_VER */
 
-// librpbase, librpfile
+// librpthreads
+#include "librpthreads/ThreadPool.hpp"
+
+// librpbase, librpfile, librpthreads
 using namespace LibRpBase;
 using LibRpFile::IRpFile;
+using LibRpThreads::ThreadPool;
 
 // C++ STL classes.
 using std::unique_ptr;
+using std::vector;
 
 namespace LibRomData {
 
@@ -38,6 +43,9 @@ namespace LibRomData {
 DELAYLOAD_TEST_FUNCTION_IMPL0(zlibVersion);
 #endif /* _MSC_VER */
 
+// Maximum number of blocks to decompress concurrently in a single batch.
+static const unsigned int GCZ_DECOMPRESS_BATCH_MAX = 64;
+
 class GczReaderPrivate : public SparseDiscReaderPrivate {
 	public:
 		GczReaderPrivate(GczReader *q);
@@ -56,13 +64,9 @@ class GczReaderPrivate : public SparseDiscReaderPrivate {
 		ao::uvector<uint64_t> blockPointers;
 		ao::uvector<uint32_t> hashes;
 
-		// Block cache.
-		ao::uvector<uint8_t> blockCache;
-		uint32_t blockCacheIdx;
-
-		// Decompression buffer.
-		// (Same size as blockCache.)
-		ao::uvector<uint8_t> z_buffer;
+		// NOTE: Recently-used blocks are cached by SparseDiscReader.
+		// readBlock() and readBlocks() may be called from multiple
+		// threads at once, so they use local buffers.
 
 		// Starting offset of the data area.
 		// This offset must be added to the blockPointers value.
@@ -74,13 +78,46 @@ class GczReaderPrivate : public SparseDiscReaderPrivate {
 		 * @return Block's compressed size, or 0 on error.
 		 */
 		uint32_t getBlockCompressedSize(uint64_t blockNum) const;
+
+		/**
+		 * Decompress a GCZ block.
+		 * This function is thread-safe.
+		 * @param pZData	[in] Compressed data.
+		 * @param z_block_size	[in] Size of the compressed data.
+		 * @param hash		[in] Adler32 hash of the compressed data. (little-endian)
+		 * @param pOut		[out] Output buffer. (Must be block_size bytes!)
+		 * @param block_size	[in] Block size.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int decompressBlock(const uint8_t *pZData, uint32_t z_block_size,
+			uint32_t hash, uint8_t *pOut, uint32_t block_size);
+
+		// Parallel decompression job.
+		struct DecompressJob {
+			const uint8_t *pZData;	// Compressed data.
+			uint8_t *pOut;		// Output buffer.
+			uint32_t z_block_size;	// Compressed size.
+			uint32_t hash;		// Adler32 hash. (little-endian)
+			bool compressed;	// False if the block is stored uncompressed.
+			int ret;		// Result. (0 on success; negative POSIX error code on error.)
+		};
+		struct DecompressBatch {
+			DecompressJob *jobs;
+			uint32_t block_size;
+		};
+
+		/**
+		 * ThreadPool task function for parallel decompression.
+		 * @param param DecompressBatch*
+		 * @param index Job index.
+		 */
+		static void decompressTask(void *param, unsigned int index);
 };
 
 /** GczReaderPrivate **/
 
 GczReaderPrivate::GczReaderPrivate(GczReader *q)
 	: super(q)
-	, blockCacheIdx(~0U)
 	, dataOffset(0)
 {
 	// Clear the GCZ header struct.
@@ -111,6 +148,66 @@ uint32_t GczReaderPrivate::getBlockCompressedSize(uint64_t blockNum) const
 	}
 }
 
+/**
+ * Decompress a GCZ block.
+ * This function is thread-safe.
+ * @param pZData	[in] Compressed data.
+ * @param z_block_size	[in] Size of the compressed data.
+ * @param hash		[in] Adler32 hash of the compressed data. (little-endian)
+ * @param pOut		[out] Output buffer. (Must be block_size bytes!)
+ * @param block_size	[in] Block size.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GczReaderPrivate::decompressBlock(const uint8_t *pZData, uint32_t z_block_size,
+	uint32_t hash, uint8_t *pOut, uint32_t block_size)
+{
+	// Verify the hash of the *compressed* data.
+	uint32_t hash_calc = adler32(0L, Z_NULL, 0);
+	hash_calc = adler32(hash_calc, pZData, z_block_size);
+	if (hash_calc != le32_to_cpu(hash)) {
+		// Hash error.
+		// TODO: Print warnings and/or more comprehensive error codes.
+		return -EIO;
+	}
+
+	// Decompress the data.
+	z_stream z = { };
+	z.next_in = const_cast<Bytef*>(pZData);
+	z.avail_in = z_block_size;
+	z.next_out = pOut;
+	z.avail_out = block_size;
+	inflateInit(&z);
+
+	int status = inflate(&z, Z_FULL_FLUSH);
+	const uint32_t uncomp_size = block_size - z.avail_out;
+	inflateEnd(&z);
+
+	if (status != Z_STREAM_END || uncomp_size != block_size) {
+		// Decompression error.
+		// TODO: Print warnings and/or more comprehensive error codes.
+		return -EIO;
+	}
+	return 0;
+}
+
+/**
+ * ThreadPool task function for parallel decompression.
+ * @param param DecompressBatch*
+ * @param index Job index.
+ */
+void GczReaderPrivate::decompressTask(void *param, unsigned int index)
+{
+	const DecompressBatch *const batch = static_cast<const DecompressBatch*>(param);
+	DecompressJob *const job = &batch->jobs[index];
+	if (job->compressed) {
+		job->ret = decompressBlock(job->pZData, job->z_block_size,
+			job->hash, job->pOut, batch->block_size);
+	} else {
+		memcpy(job->pOut, job->pZData, batch->block_size);
+		job->ret = 0;
+	}
+}
+
 /** GczReader **/
 
 GczReader::GczReader(IRpFile *file)
@@ -263,12 +360,6 @@ GczReader::GczReader(IRpFile *file)
 	}
 	d->dataOffset = static_cast<uint32_t>(pos);
 
-	// Initialize the block cache and decompression buffer.
-	// NOTE: Extra 64 bytes is for zlib, in case it needs it.
-	d->blockCache.resize(d->block_size + 64);
-	d->z_buffer.resize(d->block_size + 64);
-	d->blockCacheIdx = ~0U;
-
 	// Reset the disc position.
 	d->pos = 0;
 }
@@ -405,11 +496,16 @@ int GczReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 		return 0;
 	}
 
-	if (blockIdx == d->blockCacheIdx) {
-		// Block is cached.
-		memcpy(ptr, &d->blockCache[pos], size);
-		return size;
+	// Full blocks are read directly into the output buffer.
+	// Partial blocks are read into a temporary block buffer first.
+	// NOTE: Not using a shared buffer, since this function
+	// may be called from multiple threads at once.
+	const bool isFullBlock = (pos == 0 && size == d->block_size);
+	ao::uvector<uint8_t> tmpBlockBuf;
+	if (!isFullBlock) {
+		tmpBlockBuf.resize(d->block_size);
 	}
+	uint8_t *const blockBuf = (isFullBlock ? static_cast<uint8_t*>(ptr) : tmpBlockBuf.data());
 
 	// NOTE: If this is the last block, then we might have
 	// a short read. We'll allow it.
@@ -436,22 +532,20 @@ int GczReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 	}
 
 	if (!compressed) {
-		// Reading uncompressed data directly into the cache.
+		// Reading uncompressed data directly into the block buffer.
 		if (isLastBlock) {
-			memset(d->blockCache.data(), 0, d->blockCache.size());
+			memset(blockBuf, 0, d->block_size);
 		}
 
-		size_t sz_read = m_file->seekAndRead(physBlockAddr, d->blockCache.data(), z_block_size);
+		size_t sz_read = m_file->readAt(physBlockAddr, blockBuf, z_block_size);
 		if (sz_read != z_block_size && !isLastBlock) {
 			// Seek and/or read error.
-			d->blockCacheIdx = ~0U;
 			m_lastError = m_file->lastError();
 			if (m_lastError == 0) {
 				m_lastError = EIO;
 			}
 			return 0;
 		}
-		d->blockCacheIdx = blockIdx;
 	} else {
 		// Read compressed data into a temporary buffer,
 		// then decompress it.
@@ -461,7 +555,8 @@ int GczReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 			return 0;
 		}
 
-		size_t sz_read = m_file->seekAndRead(physBlockAddr, d->z_buffer.data(), z_block_size);
+		ao::uvector<uint8_t> z_buffer(z_block_size);
+		size_t sz_read = m_file->readAt(physBlockAddr, z_buffer.data(), z_block_size);
 		if (sz_read != z_block_size) {
 			// Seek and/or read error.
 			m_lastError = m_file->lastError();
@@ -471,41 +566,147 @@ int GczReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 			return 0;
 		}
 
-		// Verify the hash of the *compressed* data.
-		uint32_t hash_calc = adler32(0L, Z_NULL, 0);
-		hash_calc = adler32(hash_calc, d->z_buffer.data(), z_block_size);
-		if (hash_calc != le32_to_cpu(d->hashes[blockIdx])) {
-			// Hash error.
-			// TODO: Print warnings and/or more comprehensive error codes.
-			m_lastError = EIO;
-			return 0;
-		}
-
 		// Decompress the data.
-		z_stream z = { };
-		z.next_in = d->z_buffer.data();
-		z.avail_in = z_block_size;
-		z.next_out = d->blockCache.data();
-		z.avail_out = d->block_size;
-		inflateInit(&z);
-
-		int status = inflate(&z, Z_FULL_FLUSH);
-		const uint32_t uncomp_size = d->block_size - z.avail_out;
-		inflateEnd(&z);
-
-		if (status != Z_STREAM_END || uncomp_size != d->block_size) {
+		int ret = d->decompressBlock(z_buffer.data(), z_block_size,
+			d->hashes[blockIdx], blockBuf, d->block_size);
+		if (ret != 0) {
 			// Decompression error.
-			// TODO: Print warnings and/or more comprehensive error codes.
-			d->blockCacheIdx = ~0U;
-			m_lastError = EIO;
+			m_lastError = -ret;
 			return 0;
 		}
 	}
 
-	// Block has been loaded into the cache.
-	memcpy(ptr, &d->blockCache[pos], size);
-	d->blockCacheIdx = blockIdx;
+	if (!isFullBlock) {
+		// Copy the requested part of the block.
+		memcpy(ptr, &blockBuf[pos], size);
+	}
 	return size;
 }
 
+/**
+ * Read multiple full blocks.
+ *
+ * The compressed data is read on the calling thread,
+ * and then the blocks are decompressed concurrently
+ * directly into the output buffer.
+ *
+ * @param blockIdx	[in] First block index.
+ * @param count		[in] Number of blocks.
+ * @param ptr		[out] Output data buffer. (Must be at least count * block_size bytes!)
+ * @return Number of full blocks read.
+ */
+unsigned int GczReader::readBlocks(uint32_t blockIdx, unsigned int count, void *ptr)
+{
+	RP_D(GczReader);
+	ThreadPool *const pool = ThreadPool::instance();
+	if (count < 2 || pool->threadCount() < 2) {
+		// Not worth decompressing concurrently.
+		return super::readBlocks(blockIdx, count, ptr);
+	}
+
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	const uint32_t block_size = d->block_size;
+	const uint32_t blockCountTotal = static_cast<uint32_t>(d->blockPointers.size());
+	assert(blockIdx < blockCountTotal);
+	assert(count <= blockCountTotal - blockIdx);
+	if (blockIdx >= blockCountTotal || count > blockCountTotal - blockIdx) {
+		// Out of range.
+		m_lastError = EINVAL;
+		return 0;
+	}
+
+	vector<GczReaderPrivate::DecompressJob> jobs;
+	vector<off64_t> physAddrs;
+	jobs.reserve(std::min(count, GCZ_DECOMPRESS_BATCH_MAX));
+	physAddrs.reserve(jobs.capacity());
+
+	// Compressed data buffer.
+	ao::uvector<uint8_t> z_batch_buffer;
+
+	unsigned int blocksRead = 0;
+	while (blocksRead < count) {
+		const unsigned int batchCount = std::min(count - blocksRead, GCZ_DECOMPRESS_BATCH_MAX);
+		const uint32_t batchIdx = blockIdx + blocksRead;
+		if (batchIdx + batchCount == blockCountTotal) {
+			// The last block might have a short read.
+			// Use the regular readBlock() function for this batch.
+			return blocksRead + super::readBlocks(batchIdx, batchCount, ptr8);
+		}
+
+		// Get the compressed block information.
+		jobs.clear();
+		physAddrs.clear();
+		size_t z_total = 0;
+		for (unsigned int i = 0; i < batchCount; i++) {
+			const uint64_t blockPointer = d->blockPointers[batchIdx + i];
+			GczReaderPrivate::DecompressJob job;
+			job.z_block_size = d->getBlockCompressedSize(batchIdx + i);
+			job.compressed = (!(blockPointer & GCZ_FLAG_BLOCK_NOT_COMPRESSED));
+			if (job.z_block_size == 0 || job.z_block_size > block_size ||
+			    (!job.compressed && job.z_block_size != block_size))
+			{
+				// Invalid block.
+				m_lastError = EIO;
+				return blocksRead;
+			}
+			job.hash = d->hashes[batchIdx + i];
+			job.pZData = nullptr;
+			job.pOut = ptr8 + (static_cast<size_t>(i) * block_size);
+			job.ret = -EIO;
+			jobs.push_back(job);
+
+			physAddrs.push_back(static_cast<off64_t>(blockPointer & ~GCZ_FLAG_BLOCK_NOT_COMPRESSED) + d->dataOffset);
+			z_total += job.z_block_size;
+		}
+
+		// Read the compressed data.
+		// Contiguous blocks are read with a single readAt() call.
+		z_batch_buffer.resize(z_total);
+		uint8_t *pZData = z_batch_buffer.data();
+		for (unsigned int i = 0; i < batchCount; ) {
+			unsigned int j = i + 1;
+			size_t run_size = jobs[i].z_block_size;
+			while (j < batchCount && physAddrs[j] == physAddrs[i] + static_cast<off64_t>(run_size)) {
+				run_size += jobs[j].z_block_size;
+				j++;
+			}
+
+			const size_t sz_read = m_file->readAt(physAddrs[i], pZData, run_size);
+			if (sz_read != run_size) {
+				// Seek and/or read error.
+				m_lastError = m_file->lastError();
+				if (m_lastError == 0) {
+					m_lastError = EIO;
+				}
+				return blocksRead;
+			}
+
+			for (; i < j; i++) {
+				jobs[i].pZData = pZData;
+				pZData += jobs[i].z_block_size;
+			}
+		}
+
+		// Decompress the blocks.
+		GczReaderPrivate::DecompressBatch batch;
+		batch.jobs = jobs.data();
+		batch.block_size = block_size;
+		pool->parallelFor(batchCount, GczReaderPrivate::decompressTask, &batch);
+
+		// Check for errors.
+		for (unsigned int i = 0; i < batchCount; i++) {
+			if (jobs[i].ret != 0) {
+				// Decompression error.
+				m_lastError = -jobs[i].ret;
+				return blocksRead + i;
+			}
+		}
+
+		blocksRead += batchCount;
+		ptr8 += static_cast<size_t>(batchCount) * block_size;
+	}
+
+	return blocksRead;
+}
+
 }
@@ -77,6 +77,20 @@ class GczReader : public LibRpBase::SparseDiscReader
 		 */
 		ATTR_ACCESS_SIZE(write_only, 4, 5)
 		int readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size) final;
+
+		/**
+		 * Read multiple full blocks.
+		 *
+		 * The compressed data is read on the calling thread,
+		 * and then the blocks are decompressed concurrently
+		 * directly into the output buffer.
+		 *
+		 * @param blockIdx	[in] First block index.
+		 * @param count		[in] Number of blocks.
+		 * @param ptr		[out] Output data buffer. (Must be at least count * block_size bytes!)
+		 * @return Number of full blocks read.
+		 */
+		unsigned int readBlocks(uint32_t blockIdx, unsigned int count, void *ptr) final;
 };
 
 }
@@ -13,10 +13,10 @@
 #include "../cdrom_structs.h"
 #include "IsoPartition.hpp"
 
-// librpbase, librpfile
 #include "librpfile/RelatedFile.hpp"
 using namespace LibRpBase;
 using namespace LibRpFile;
+using LibRpThreads::MutexLocker;
 
 // Other RomData subclasses
 #include "Other/ISO.hpp"
@@ -64,6 +64,11 @@ class GdiReaderPrivate : public SparseDiscReaderPrivate {
 		// Value = pointer to BlockRange in blockRanges.
 		vector<BlockRange*> trackMappings;
 
+		// Track mutex.
+		// Tracks are opened on demand by readBlock(),
+		// which may be called from multiple threads.
+		LibRpThreads::Mutex trackMutex;
+
 		/**
 		 * Close all opened files.
 		 */
@@ -240,6 +245,8 @@ int GdiReaderPrivate::openTrack(int trackNumber)
 		return -EINVAL;
 	}
 
+	MutexLocker locker(trackMutex);
+
 	// Check if this track exists.
 	// NOTE: trackNumber starts at 1, not 0.
 	if (trackNumber > static_cast<int>(trackMappings.size())) {
@@ -552,7 +559,7 @@ int GdiReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 		// 2352-byte sectors.
 		// TODO: Handle audio tracks properly?
 		CDROM_2352_Sector_t sector;
-		size_t sz_read = blockRange->file->seekAndRead(phys_pos, &sector, sizeof(sector));
+		size_t sz_read = blockRange->file->readAt(phys_pos, &sector, sizeof(sector));
 		m_lastError = blockRange->file->lastError();
 		if (sz_read != sizeof(sector)) {
 			// Read error.
@@ -566,7 +573,7 @@ int GdiReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size)
 	}
 
 	// 2048-byte sectors.
-	size_t sz_read = blockRange->file->seekAndRead(phys_pos, ptr, size);
+	size_t sz_read = blockRange->file->readAt(phys_pos, ptr, size);
 	return (sz_read > 0 ? (int)sz_read : -1);
 }
 
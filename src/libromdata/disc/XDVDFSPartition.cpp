@@ -24,7 +24,8 @@ class XDVDFSPartitionPrivate
 {
 	public:
 		XDVDFSPartitionPrivate(XDVDFSPartition *q,
-			off64_t partition_offset, off64_t partition_size);
+			off64_t partition_offset, off64_t partition_size,
+			const XDVDFS_Header *pHeader);
 		~XDVDFSPartitionPrivate();
 
 	private:
@@ -77,7 +78,8 @@ class XDVDFSPartitionPrivate
 /** XDVDFSPartitionPrivate **/
 
 XDVDFSPartitionPrivate::XDVDFSPartitionPrivate(XDVDFSPartition *q,
-	off64_t partition_offset, off64_t partition_size)
+	off64_t partition_offset, off64_t partition_size,
+	const XDVDFS_Header *pHeader)
 	: q_ptr(q)
 	, partition_offset(partition_offset)
 	, partition_size(partition_size)
@@ -97,15 +99,19 @@ XDVDFSPartitionPrivate::XDVDFSPartitionPrivate(XDVDFSPartition *q,
 		return;
 	}
 
-	// Load the XDVDFS header.
-	size_t size = q->m_discReader->seekAndRead(
-		partition_offset + (XDVDFS_HEADER_LBA_OFFSET * XDVDFS_BLOCK_SIZE),
-		&xdvdfsHeader, sizeof(xdvdfsHeader));
-	if (size != sizeof(xdvdfsHeader)) {
-		// Seek and/or read error.
-		memset(&xdvdfsHeader, 0, sizeof(xdvdfsHeader));
-		UNREF_AND_NULL_NOCHK(q->m_discReader);
-		return;
+	// Load the XDVDFS header, unless the caller already read it.
+	if (pHeader) {
+		memcpy(&xdvdfsHeader, pHeader, sizeof(xdvdfsHeader));
+	} else {
+		size_t size = q->m_discReader->seekAndRead(
+			partition_offset + (XDVDFS_HEADER_LBA_OFFSET * XDVDFS_BLOCK_SIZE),
+			&xdvdfsHeader, sizeof(xdvdfsHeader));
+		if (size != sizeof(xdvdfsHeader)) {
+			// Seek and/or read error.
+			memset(&xdvdfsHeader, 0, sizeof(xdvdfsHeader));
+			UNREF_AND_NULL_NOCHK(q->m_discReader);
+			return;
+		}
 	}
 
 	// Verify the magic strings.
@@ -329,13 +335,19 @@ const ao::uvector<uint8_t> *XDVDFSPartitionPrivate::getDirectory(const char *pat
  * NOTE: The IDiscReader *must* remain valid while this
  * XDVDFSPartition is open.
  *
+ * If the caller already read the XDVDFS header, e.g. as part
+ * of a batch read, it can be passed in pHeader to avoid
+ * reading it again. It will still be validated.
+ *
  * @param discReader IDiscReader.
  * @param partition_offset Partition start offset.
  * @param partition_size Partition size.
+ * @param pHeader XDVDFS header, or nullptr to read it from the disc.
  */
-XDVDFSPartition::XDVDFSPartition(IDiscReader *discReader, off64_t partition_offset, off64_t partition_size)
+XDVDFSPartition::XDVDFSPartition(IDiscReader *discReader, off64_t partition_offset, off64_t partition_size,
+	const XDVDFS_Header *pHeader)
 	: super(discReader)
-	, d_ptr(new XDVDFSPartitionPrivate(this, partition_offset, partition_size))
+	, d_ptr(new XDVDFSPartitionPrivate(this, partition_offset, partition_size, pHeader))
 { }
 
 XDVDFSPartition::~XDVDFSPartition()
@@ -14,6 +14,9 @@
 // C includes. (C++ namespace)
 #include <ctime>
 
+// from xdvdfs_structs.h
+struct _XDVDFS_Header;
+
 namespace LibRomData {
 
 class XDVDFSPartitionPrivate;
@@ -26,11 +29,17 @@ class XDVDFSPartition : public LibRpBase::IPartition
 		 * NOTE: The IDiscReader *must* remain valid while this
 		 * XDVDFSPartition is open.
 		 *
+		 * If the caller already read the XDVDFS header, e.g. as part
+		 * of a batch read, it can be passed in pHeader to avoid
+		 * reading it again. It will still be validated.
+		 *
 		 * @param discReader IDiscReader.
 		 * @param partition_offset Partition start offset.
 		 * @param partition_size Partition size.
+		 * @param pHeader XDVDFS header, or nullptr to read it from the disc.
 		 */
-		XDVDFSPartition(IDiscReader *discReader, off64_t partition_offset, off64_t partition_size);
+		XDVDFSPartition(IDiscReader *discReader, off64_t partition_offset, off64_t partition_size,
+			const struct _XDVDFS_Header *pHeader = nullptr);
 	protected:
 		virtual ~XDVDFSPartition();	// call unref() instead
 
@@ -12,6 +12,7 @@
 
 // librpbase, librpfile, librpthreads
 #include "librpbase/TextFuncs.hpp"
+#include "librpbase/config/Config.hpp"
 #include "librpfile/RpFile.hpp"
 #include "librpfile/FileSystem.hpp"
 using namespace LibRpBase;
@@ -47,7 +48,8 @@ using std::wstring;
 
 namespace LibRomData {
 
-// Semaphore used to limit the number of simultaneous downloads.
+// Semaphore used to limit the number of simultaneous downloads
+// if the rp-download helper isn't available.
 // TODO: Determine the best number of simultaneous downloads.
 // TODO: Test this on XP with IEIFLAG_ASYNC.
 Semaphore CacheManager::m_dlsem(2);
@@ -101,6 +103,9 @@ void CacheManager::setProxyUrl(const string &proxyUrl)
  * the last time it was requested, an empty string will be
  * returned, and a zero-byte file will be stored in the cache.
  *
+ * If the cached version is older than the revalidation period,
+ * it will be revalidated with the server first.
+ *
  * @return Absolute path to the cached file.
  */
 string CacheManager::download(const string &cache_key)
@@ -117,10 +122,6 @@ string CacheManager::download(const string &cache_key)
 		return string();
 	}
 
-	// Lock the semaphore to make sure we don't
-	// download too many files at once.
-	SemaphoreLocker locker(m_dlsem);
-
 	// Check if the file already exists.
 	off64_t filesize = 0;
 	time_t filemtime = 0;
@@ -148,6 +149,22 @@ string CacheManager::download(const string &cache_key)
 		} else if (filesize > 0) {
 			// File is larger than 0 bytes, which indicates
 			// it was cached successfully.
+
+			// Update the access time for LRU eviction.
+			// This is done explicitly in case the file system
+			// is mounted with noatime or relatime.
+			FileSystem::touch_atime(cache_filename);
+
+			// The mtime is the server's Last-Modified time,
+			// or the last time the file was revalidated.
+			const unsigned int revalidateDays = Config::instance()->cacheRevalidateDays();
+			if (revalidateDays > 0 &&
+			    (time(nullptr) - filemtime) >= (static_cast<time_t>(revalidateDays) * 86400))
+			{
+				// Revalidate the file. rp-download keeps the
+				// cached file if the server can't be reached.
+				runRpDownload(cache_key);
+			}
 			return cache_filename;
 		}
 	} else if (ret != -ENOENT) {
@@ -167,7 +184,8 @@ string CacheManager::download(const string &cache_key)
 	// NOTE: Using the unfiltered cache key, since filtering it
 	// results in slashes being changed to backslashes on Windows.
 	// rp-download will filter the key itself.
-	ret = execRpDownload(cache_key);
+
+	ret = runRpDownload(cache_key);
 	if (ret != 0) {
 		// rp-download failed for some reason.
 		return string();
@@ -177,6 +195,27 @@ string CacheManager::download(const string &cache_key)
 	return cache_filename;
 }
 
+/**
+ * Run rp-download for a cache key.
+ * The persistent helper is used if possible.
+ * @param cache_key Cache key.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CacheManager::runRpDownload(const string &cache_key)
+{
+	// Use the persistent rp-download helper if possible.
+	// It limits the number of simultaneous downloads itself.
+	int ret = execRpDownloadHelper(cache_key);
+	if (ret == -ENOTSUP || ret == -ECONNRESET) {
+		// The helper couldn't handle this request.
+		// Lock the semaphore to make sure we don't
+		// download too many files at once.
+		SemaphoreLocker locker(m_dlsem);
+		ret = execRpDownload(cache_key);
+	}
+	return ret;
+}
+
 /**
  * Check if a file has already been cached.
  * @param cache_key Cache key.
@@ -66,6 +66,9 @@ class CacheManager
 		 * the last time it was requested, an empty string will be
 		 * returned, and a zero-byte file will be stored in the cache.
 		 *
+		 * If the cached version is older than the revalidation period,
+		 * it will be revalidated with the server first.
+		 *
 		 * @return Absolute path to the cached file.
 		 */
 		std::string download(const std::string &cache_key);
@@ -78,6 +81,14 @@ class CacheManager
 		std::string findInCache(const std::string &cache_key);
 
 	protected:
+		/**
+		 * Run rp-download for a cache key.
+		 * The persistent helper is used if possible.
+		 * @param cache_key Cache key.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int runRpDownload(const std::string &cache_key);
+
 		/**
 		 * Execute rp-download.
 		 * @param filtered_cache_key Filtered cache key.
@@ -85,10 +96,26 @@ class CacheManager
 		 */
 		int execRpDownload(const std::string &filtered_cache_key);
 
+		/**
+		 * Download a file using the persistent rp-download helper.
+		 *
+		 * A single rp-download process is started in batch mode and
+		 * shared by all CacheManager instances. Cache keys are sent to it
+		 * over a socket, and it downloads them in parallel, reusing
+		 * connections to the online databases.
+		 *
+		 * @param cache_key Cache key.
+		 * @return 0 on success; negative POSIX error code on error.
+		 * -ENOTSUP and -ECONNRESET indicate that the helper couldn't
+		 * handle the request, so execRpDownload() should be used instead.
+		 */
+		int execRpDownloadHelper(const std::string &cache_key);
+
 	protected:
 		std::string m_proxyUrl;
 
-		// Semaphore used to limit the number of simultaneous downloads.
+		// Semaphore used to limit the number of simultaneous downloads
+		// if the rp-download helper isn't available.
 		static LibRpThreads::Semaphore m_dlsem;
 };
 
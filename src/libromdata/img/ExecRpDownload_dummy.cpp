@@ -26,4 +26,16 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 	return -ENOSYS;
 }
 
+/**
+ * Download a file using the persistent rp-download helper. (Dummy version)
+ * The helper process isn't implemented on this platform.
+ * @param cacheKey Cache key.
+ * @return -ENOTSUP
+ */
+int CacheManager::execRpDownloadHelper(const string &cacheKey)
+{
+	RP_UNUSED(cacheKey);
+	return -ENOTSUP;
+}
+
 }
@@ -10,8 +10,18 @@
 #include "config.libromdata.h"
 #include "CacheManager.hpp"
 
+// librpbase, librpthreads
+#include "librpbase/config/Config.hpp"
+#include "librpthreads/Mutex.hpp"
+using LibRpBase::Config;
+using LibRpThreads::Mutex;
+using LibRpThreads::Semaphore;
+
 // OS-specific includes.
+#include <fcntl.h>
+#include <poll.h>
 #include <signal.h>
+#include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -19,36 +29,36 @@
 # include <spawn.h>
 #endif /* HAVE_POSIX_SPAWN */
 
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <ctime>
+
 // C++ includes.
 #include <string>
+#include <vector>
 using std::string;
+using std::vector;
 
 namespace LibRomData {
 
+// TODO: Mac OS X path. (bundle?)
+static const char rp_download_exe[] = DIR_INSTALL_LIBEXEC "/rp-download";
+
 /**
- * Execute rp-download. (POSIX version)
- * @param filteredCacheKey Filtered cache key.
- * @return 0 on success; negative POSIX error code on error.
+ * Build a minimal environment for rp-download.
+ * This will include http_proxy and https_proxy if the proxy URL is set.
+ * @param proxyUrl	[in] Proxy URL.
+ * @param s_env		[out] Environment string storage.
+ * @param envp		[out] Environment array. (must have 5 elements)
  */
-int CacheManager::execRpDownload(const string &filteredCacheKey)
+static void buildEnvironment(const string &proxyUrl, string &s_env, const char *envp[5])
 {
-	// TODO: Mac OS X path. (bundle?)
- 	static const char rp_download_exe[] = DIR_INSTALL_LIBEXEC "/rp-download";
-
-	// Parameters.
-	const char *const argv[3] = {
-		rp_download_exe,
-		filteredCacheKey.c_str(),
-		nullptr
-	};
-
 	// Define a minimal environment for cURL.
-	// This will include http_proxy and https_proxy if the proxy URL is set.
 	// TODO: Separate proxies for http and https?
 	// TODO: Only build this once?
 	int pos[5] = {-1, -1, -1, -1, -1};
 	int count = 0;
-	std::string s_env;
+	s_env.clear();
 	s_env.reserve(1024);
 
 	// We want the HOME and USER variables.
@@ -68,7 +78,7 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 		s_env += envtmp;
 		s_env += '\0';
 	}
-	if (m_proxyUrl.empty()) {
+	if (proxyUrl.empty()) {
 		// Proxy URL is empty. Get the URLs from the environment.
 		envtmp = getenv("http_proxy");
 		if (envtmp && envtmp[0] != '\0') {
@@ -87,19 +97,64 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 	} else {
 		// Proxy URL is set. Use it.
 		pos[count++] = static_cast<int>(s_env.size());
-		s_env += "http_proxy=" + m_proxyUrl;
+		s_env += "http_proxy=" + proxyUrl;
+		s_env += '\0';
 		pos[count++] = static_cast<int>(s_env.size());
-		s_env += "https_proxy=" + m_proxyUrl;
+		s_env += "https_proxy=" + proxyUrl;
+		s_env += '\0';
 	}
 
 	// Build envp.
-	const char *envp[5] = {nullptr, nullptr, nullptr, nullptr, nullptr};
 	unsigned int envp_idx = 0;
+	for (unsigned int i = 0; i < 5; i++) {
+		envp[i] = nullptr;
+	}
 	for (unsigned int i = 0; i < 5; i++) {
 		if (pos[i] >= 0) {
 			envp[envp_idx++] = &s_env[pos[i]];
 		}
 	}
+}
+
+/**
+ * Cache policy options for rp-download.
+ */
+struct CachePolicyArgs {
+	char revalidateDays[16];	// -r: Revalidation period, in days.
+	char maxSize[16];		// -s: Maximum cache size, in MiB.
+	char maxEntries[16];		// -n: Maximum number of cache files.
+
+	CachePolicyArgs()
+	{
+		const Config *const config = Config::instance();
+		snprintf(revalidateDays, sizeof(revalidateDays), "-r%u", config->cacheRevalidateDays());
+		snprintf(maxSize, sizeof(maxSize), "-s%u", config->cacheMaxSize());
+		snprintf(maxEntries, sizeof(maxEntries), "-n%u", config->cacheMaxEntries());
+	}
+};
+
+/**
+ * Execute rp-download. (POSIX version)
+ * @param filteredCacheKey Filtered cache key.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CacheManager::execRpDownload(const string &filteredCacheKey)
+{
+	// Parameters.
+	const CachePolicyArgs policy;
+	const char *const argv[6] = {
+		rp_download_exe,
+		policy.revalidateDays,
+		policy.maxSize,
+		policy.maxEntries,
+		filteredCacheKey.c_str(),
+		nullptr
+	};
+
+	// Build the environment.
+	string s_env;
+	const char *envp[5];
+	buildEnvironment(m_proxyUrl, s_env, envp);
 
 	// TODO: Maybe we should close file handles...
 #ifdef HAVE_POSIX_SPAWN
@@ -192,4 +247,435 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 	return 0;
 }
 
+
+/** rp-download helper **/
+
+// Maximum time to wait for a response from the helper, in seconds.
+// This is longer than rp-download's own timeout, since requests
+// may be queued behind other downloads.
+#define HELPER_TIMEOUT 30
+
+namespace {
+
+/**
+ * Pending request for the rp-download helper.
+ */
+struct HelperRequest {
+	const string *cache_key;
+	time_t deadline;	// Request times out at this time.
+	int result;		// 0 on success; negative POSIX error code on error.
+	bool done;		// Set when the result is available.
+	Semaphore sem;		// Released when done, or if this request should read responses.
+
+	explicit HelperRequest(const string *cache_key)
+		: cache_key(cache_key)
+		, deadline(time(nullptr) + HELPER_TIMEOUT)
+		, result(-EIO)
+		, done(false)
+		, sem(0)
+	{ }
+};
+
+/**
+ * Persistent rp-download helper process.
+ *
+ * rp-download is started in batch mode (-b) and kept running.
+ * Cache keys are written to its stdin, and results are read
+ * from its stdout. Both are connected to a single socket,
+ * which prevents SIGPIPE if the helper exits unexpectedly.
+ *
+ * Requests are handled by the threads that made them.
+ * One of the waiting threads reads responses at a time;
+ * the other threads wait on their request's semaphore.
+ */
+class RpDownloadHelper
+{
+	public:
+		RpDownloadHelper()
+			: m_pid(-1)
+			, m_fd(-1)
+			, m_reading(false)
+			, m_answered(false)
+			, m_disabled(false)
+		{ }
+
+		~RpDownloadHelper()
+		{
+			// Closing the socket causes the helper to exit
+			// once it finishes any active downloads.
+			if (m_fd >= 0) {
+				close(m_fd);
+			}
+		}
+
+	private:
+		RP_DISABLE_COPY(RpDownloadHelper)
+
+	public:
+		/**
+		 * Download a file using the helper.
+		 * @param cache_key Cache key.
+		 * @param proxyUrl Proxy URL.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int request(const string &cache_key, const string &proxyUrl);
+
+	private:
+		/**
+		 * Start the helper process.
+		 * m_mutex must be locked by the caller.
+		 * @param proxyUrl Proxy URL.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int start(const string &proxyUrl);
+
+		/**
+		 * Stop the helper process and fail all pending requests.
+		 * m_mutex must be locked by the caller, and m_reading must be false.
+		 * @param err Negative POSIX error code for pending requests.
+		 */
+		void stop(int err);
+
+		/**
+		 * Process complete response lines in m_rdbuf.
+		 * m_mutex must be locked by the caller.
+		 */
+		void processResponses(void);
+
+		/**
+		 * Complete a pending request.
+		 * m_mutex must be locked by the caller.
+		 * @param iter Request iterator.
+		 * @param result Result code.
+		 * @return Iterator to the next request.
+		 */
+		vector<HelperRequest*>::iterator complete(vector<HelperRequest*>::iterator iter, int result);
+
+	private:
+		Mutex m_mutex;
+
+		pid_t m_pid;		// Helper process ID
+		int m_fd;		// Socket connected to the helper's stdin and stdout
+		string m_proxyUrl;	// Proxy URL used when starting the helper
+		string m_rdbuf;		// Incomplete response data
+
+		vector<HelperRequest*> m_requests;	// Pending requests, in order
+		bool m_reading;		// Set if a thread is reading responses.
+		bool m_answered;	// Set if the helper has returned at least one result.
+		bool m_disabled;	// Set if the helper doesn't work.
+};
+
+/**
+ * Start the helper process.
+ * m_mutex must be locked by the caller.
+ * @param proxyUrl Proxy URL.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpDownloadHelper::start(const string &proxyUrl)
+{
+	assert(m_fd < 0);
+
+	int sv[2];
+#ifdef SOCK_CLOEXEC
+	int ret = socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv);
+#else /* !SOCK_CLOEXEC */
+	int ret = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+	if (ret == 0) {
+		fcntl(sv[0], F_SETFD, FD_CLOEXEC);
+		fcntl(sv[1], F_SETFD, FD_CLOEXEC);
+	}
+#endif /* SOCK_CLOEXEC */
+	if (ret != 0) {
+		const int err = errno;
+		return (err != 0 ? -err : -EIO);
+	}
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+	// Prevent SIGPIPE if the helper exits unexpectedly.
+	int one = 1;
+	setsockopt(sv[0], SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif /* !MSG_NOSIGNAL && SO_NOSIGPIPE */
+
+	// Parameters.
+	char s_jobs[16];
+	snprintf(s_jobs, sizeof(s_jobs), "-j%u", Config::instance()->maxParallelDownloads());
+	const CachePolicyArgs policy;
+	const char *const argv[7] = {
+		rp_download_exe,
+		"-b",
+		s_jobs,
+		policy.revalidateDays,
+		policy.maxSize,
+		policy.maxEntries,
+		nullptr
+	};
+
+	// Build the environment.
+	string s_env;
+	const char *envp[5];
+	buildEnvironment(proxyUrl, s_env, envp);
+
+	// Connect the helper's stdin and stdout to the socket.
+	// NOTE: dup2() clears FD_CLOEXEC on the new descriptors.
+#ifdef HAVE_POSIX_SPAWN
+	// posix_spawn()
+	pid_t pid;
+	posix_spawn_file_actions_t file_actions;
+	posix_spawn_file_actions_init(&file_actions);
+	posix_spawn_file_actions_adddup2(&file_actions, sv[1], STDIN_FILENO);
+	posix_spawn_file_actions_adddup2(&file_actions, sv[1], STDOUT_FILENO);
+	ret = posix_spawn(&pid, rp_download_exe,
+		&file_actions,
+		nullptr,	// attrp
+		(char *const *)argv, (char *const *)envp);
+	posix_spawn_file_actions_destroy(&file_actions);
+	if (ret != 0) {
+		// Error creating the child process.
+		close(sv[0]);
+		close(sv[1]);
+		return -ret;
+	}
+#else /* !HAVE_POSIX_SPAWN */
+	// fork()/execve().
+	pid_t pid = fork();
+	if (pid == 0) {
+		// Child process.
+		if (dup2(sv[1], STDIN_FILENO) < 0 || dup2(sv[1], STDOUT_FILENO) < 0) {
+			_exit(EXIT_FAILURE);
+		}
+		execve(rp_download_exe, (char *const *)argv, (char *const *)envp);
+		// execve() failed.
+		_exit(EXIT_FAILURE);
+	} else if (pid == -1) {
+		// fork() failed.
+		int err = errno;
+		if (err == 0) {
+			err = EIO;
+		}
+		close(sv[0]);
+		close(sv[1]);
+		return -err;
+	}
+#endif /* HAVE_POSIX_SPAWN */
+
+	// Parent process.
+	close(sv[1]);
+	m_pid = pid;
+	m_fd = sv[0];
+	m_proxyUrl = proxyUrl;
+	m_rdbuf.clear();
+	m_answered = false;
+	return 0;
+}
+
+/**
+ * Stop the helper process and fail all pending requests.
+ * m_mutex must be locked by the caller, and m_reading must be false.
+ * @param err Negative POSIX error code for pending requests.
+ */
+void RpDownloadHelper::stop(int err)
+{
+	assert(!m_reading);
+	if (m_fd >= 0) {
+		close(m_fd);
+		m_fd = -1;
+	}
+	if (m_pid > 0) {
+		kill(m_pid, SIGTERM);
+		waitpid(m_pid, nullptr, 0);
+		m_pid = -1;
+	}
+
+	if (!m_answered) {
+		// The helper exited without handling any requests.
+		// It probably doesn't support batch mode.
+		m_disabled = true;
+	}
+
+	for (auto iter = m_requests.begin(); iter != m_requests.end(); ) {
+		iter = complete(iter, err);
+	}
+}
+
+/**
+ * Complete a pending request.
+ * m_mutex must be locked by the caller.
+ * @param iter Request iterator.
+ * @param result Result code.
+ * @return Iterator to the next request.
+ */
+vector<HelperRequest*>::iterator RpDownloadHelper::complete(vector<HelperRequest*>::iterator iter, int result)
+{
+	HelperRequest *const req = *iter;
+	req->result = result;
+	req->done = true;
+	req->sem.release();
+	return m_requests.erase(iter);
+}
+
+/**
+ * Process complete response lines in m_rdbuf.
+ * m_mutex must be locked by the caller.
+ */
+void RpDownloadHelper::processResponses(void)
+{
+	// Response format: "%d %s\n"
+	// - %d: 0 on success; 1 on error.
+	// - %s: Cache key.
+	size_t start = 0;
+	size_t nl;
+	while ((nl = m_rdbuf.find('\n', start)) != string::npos) {
+		const size_t space = m_rdbuf.find(' ', start);
+		if (space != string::npos && space < nl) {
+			const int result = (m_rdbuf.compare(start, space - start, "0") == 0 ? 0 : -EIO);
+			const size_t key_len = nl - (space + 1);
+
+			// Complete the oldest request for this cache key.
+			for (auto iter = m_requests.begin(); iter != m_requests.end(); ++iter) {
+				if ((*iter)->cache_key->compare(0, string::npos, m_rdbuf, space + 1, key_len) == 0) {
+					complete(iter, result);
+					break;
+				}
+			}
+			m_answered = true;
+		}
+		start = nl + 1;
+	}
+	m_rdbuf.erase(0, start);
+}
+
+/**
+ * Download a file using the helper.
+ * @param cache_key Cache key.
+ * @param proxyUrl Proxy URL.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpDownloadHelper::request(const string &cache_key, const string &proxyUrl)
+{
+	if (cache_key.empty() || cache_key.find_first_of("\r\n") != string::npos) {
+		// Cache keys can't contain newlines.
+		return -EINVAL;
+	}
+
+	HelperRequest req(&cache_key);
+	m_mutex.lock();
+	if (m_disabled) {
+		m_mutex.unlock();
+		return -ENOTSUP;
+	}
+	if (m_fd < 0) {
+		int ret = start(proxyUrl);
+		if (ret != 0) {
+			// Unable to start the helper.
+			m_disabled = true;
+			m_mutex.unlock();
+			return -ENOTSUP;
+		}
+	} else if (proxyUrl != m_proxyUrl) {
+		// The helper was started with a different proxy.
+		m_mutex.unlock();
+		return -ENOTSUP;
+	}
+
+	// Send the cache key to the helper.
+	const string line = cache_key + '\n';
+#ifdef MSG_NOSIGNAL
+	const ssize_t sz = send(m_fd, line.data(), line.size(), MSG_NOSIGNAL);
+#else /* !MSG_NOSIGNAL */
+	const ssize_t sz = send(m_fd, line.data(), line.size(), 0);
+#endif /* MSG_NOSIGNAL */
+	if (sz != static_cast<ssize_t>(line.size())) {
+		// The helper probably exited.
+		// If another thread is reading responses, it will
+		// stop the helper once it sees the end of the stream.
+		if (!m_reading) {
+			stop(-ECONNRESET);
+		}
+		m_mutex.unlock();
+		return -ECONNRESET;
+	}
+	m_requests.emplace_back(&req);
+
+	while (!req.done) {
+		if (m_reading) {
+			// Another thread is reading responses.
+			// Wait until this request is done, or until
+			// this thread needs to take over reading.
+			m_mutex.unlock();
+			req.sem.obtain();
+			m_mutex.lock();
+			continue;
+		}
+
+		// Read responses from the helper.
+		m_reading = true;
+		const int fd = m_fd;
+		m_mutex.unlock();
+
+		struct pollfd pfd;
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		int ret = poll(&pfd, 1, 1000);
+		int err = (ret < 0 ? errno : 0);
+		ssize_t rdsz = 0;
+		char buf[4096];
+		if (ret > 0) {
+			rdsz = read(fd, buf, sizeof(buf));
+			err = (rdsz < 0 ? errno : 0);
+		}
+
+		m_mutex.lock();
+		m_reading = false;
+		if (rdsz > 0) {
+			m_rdbuf.append(buf, rdsz);
+			processResponses();
+		} else if ((ret > 0 && rdsz == 0) || (err != 0 && err != EINTR && err != EAGAIN)) {
+			// End of stream, or a read error occurred.
+			stop(-ECONNRESET);
+		}
+
+		// Check for requests that have timed out.
+		const time_t now = time(nullptr);
+		for (auto iter = m_requests.begin(); iter != m_requests.end(); ) {
+			if (now >= (*iter)->deadline) {
+				iter = complete(iter, -ETIMEDOUT);
+			} else {
+				++iter;
+			}
+		}
+
+		// Let another waiting thread take over reading
+		// if this request is done.
+		if (req.done && !m_requests.empty()) {
+			m_requests.front()->sem.release();
+		}
+	}
+
+	m_mutex.unlock();
+	return req.result;
+}
+
+// Helper process, shared by all CacheManager instances.
+RpDownloadHelper rpDownloadHelper;
+
+}
+
+/**
+ * Download a file using the persistent rp-download helper.
+ *
+ * A single rp-download process is started in batch mode and
+ * shared by all CacheManager instances. Cache keys are sent to it
+ * over a socket, and it downloads them in parallel, reusing
+ * connections to the online databases.
+ *
+ * @param cache_key Cache key.
+ * @return 0 on success; negative POSIX error code on error.
+ * -ENOTSUP and -ECONNRESET indicate that the helper couldn't
+ * handle the request, so execRpDownload() should be used instead.
+ */
+int CacheManager::execRpDownloadHelper(const string &cache_key)
+{
+	return rpDownloadHelper.request(cache_key, m_proxyUrl);
+}
+
 }
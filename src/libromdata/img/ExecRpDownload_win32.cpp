@@ -13,6 +13,10 @@
 #include "libwin32common/RpWin32_sdk.h"
 #include "librpbase/TextFuncs_wchar.hpp"
 
+// librpbase
+#include "librpbase/config/Config.hpp"
+using LibRpBase::Config;
+
 // librpsecure
 #include "librpsecure/win32/integrity_level.h"
 
@@ -50,12 +54,21 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 	// so we'll store in a tstring.
 	// NOTE: Spaces are allowed in cache keys, so everything
 	// needs to be quoted properly.
+	// Cache policy options are passed before the cache key.
+	const Config *const config = Config::instance();
+	TCHAR t_policy[64];
+	_sntprintf(t_policy, _countof(t_policy), _T(" -r%u -s%u -n%u"),
+		config->cacheRevalidateDays(), config->cacheMaxSize(), config->cacheMaxEntries());
+	t_policy[_countof(t_policy)-1] = _T('\0');
+
 	tstring t_filteredCacheKey = U82T_s(filteredCacheKey);
 	tstring t_cmd_line;
-	t_cmd_line.reserve(rp_download_exe.size() + 5 + t_filteredCacheKey.size());
+	t_cmd_line.reserve(rp_download_exe.size() + _tcslen(t_policy) + 5 + t_filteredCacheKey.size());
 	t_cmd_line += _T('"');
 	t_cmd_line += rp_download_exe;
-	t_cmd_line += _T("\" \"");
+	t_cmd_line += _T('"');
+	t_cmd_line += t_policy;
+	t_cmd_line += _T(" \"");
 	t_cmd_line += t_filteredCacheKey;
 	t_cmd_line += _T('"');
 
@@ -135,4 +148,16 @@ int CacheManager::execRpDownload(const string &filteredCacheKey)
 	return 0;
 }
 
+/**
+ * Download a file using the persistent rp-download helper. (Win32 version)
+ * The helper process isn't implemented on this platform.
+ * @param cacheKey Cache key.
+ * @return -ENOTSUP
+ */
+int CacheManager::execRpDownloadHelper(const string &cacheKey)
+{
+	RP_UNUSED(cacheKey);
+	return -ENOTSUP;
+}
+
 }
@@ -28,6 +28,7 @@ using LibRpTexture::rp_image;
 
 // libromdata
 #include "../RomDataFactory.hpp"
+#include "../RomDataIndex.hpp"
 
 // C includes. (C++ namespace)
 #include <cassert>
@@ -53,6 +54,7 @@ TCreateThumbnail<ImgClass>::~TCreateThumbnail()
  * @param imageType	[in] Image type.
  * @param pOutSize	[out,opt] Pointer to ImgSize to store the image's size.
  * @param sBIT		[out,opt] sBIT metadata.
+ * @param req_size	[in,opt] Requested image size. (0 to disable downscaling)
  * @return Internal image, or null ImgClass on error.
  */
 template<typename ImgClass>
@@ -60,7 +62,8 @@ ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
 	const RomData *romData,
 	RomData::ImageType imageType,
 	ImgSize *pOutSize,
-	rp_image::sBIT_t *sBIT)
+	rp_image::sBIT_t *sBIT,
+	int req_size)
 {
 	assert(imageType >= RomData::IMG_INT_MIN && imageType <= RomData::IMG_INT_MAX);
 	if (imageType < RomData::IMG_INT_MIN || imageType > RomData::IMG_INT_MAX) {
@@ -71,7 +74,15 @@ ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
 		return getNullImgClass();
 	}
 
-	const rp_image *image = romData->image(imageType);
+	// Get the smallest version of the image that's at least
+	// req_size, e.g. a texture mipmap, so the full-size image
+	// doesn't have to be decoded. Images that need special
+	// handling are processed by getThumbnail() at full size.
+	const uint32_t imgpf = romData->imgpf(imageType);
+	const int sel_size = (imgpf & (RomData::IMGPF_RESCALE_ASPECT_8to7 | RomData::IMGPF_RESCALE_NEAREST))
+		? 0 : req_size;
+	int fullSize[2] = {0, 0};
+	const rp_image *image = romData->imageForSize(imageType, sel_size, fullSize);
 	if (!image) {
 		// No image.
 		if (sBIT) {
@@ -81,16 +92,27 @@ ImgClass TCreateThumbnail<ImgClass>::getInternalImage(
 	}
 
 	// Convert the rp_image to ImgClass.
-	ImgClass ret_img = rpImageToImgClass(image);
+	// If the image is larger than the requested size,
+	// downscale it first to reduce conversion overhead.
+	rp_image *const sc_img = downscaleImage(image, req_size, imgpf);
+	ImgClass ret_img = rpImageToImgClass(sc_img ? sc_img : image);
+	UNREF(sc_img);
 	if (isImgClassValid(ret_img)) {
 		// Image converted successfully.
 		if (pOutSize) {
-			// Get the image size.
-			// NOTE: The image may have been resized on Windows,
-			// since Windows has issues with non-square images.
-			// Hence, we have to get the size from ret_img.
-			// TODO: Check for errors?
-			getImgClassSize(ret_img, pOutSize);
+			if (sc_img || image->width() != fullSize[0] || image->height() != fullSize[1]) {
+				// Image was downscaled, or a smaller version was used.
+				// Return the original image size.
+				pOutSize->width = fullSize[0];
+				pOutSize->height = fullSize[1];
+			} else {
+				// Get the image size.
+				// NOTE: The image may have been resized on Windows,
+				// since Windows has issues with non-square images.
+				// Hence, we have to get the size from ret_img.
+				// TODO: Check for errors?
+				getImgClassSize(ret_img, pOutSize);
+			}
 		}
 		if (sBIT) {
 			// Get the sBIT metadata.
@@ -145,6 +167,13 @@ ImgClass TCreateThumbnail<ImgClass>::getExternalImage(
 	const bool extImgDownloadEnabled = config->extImgDownloadEnabled();
 	const bool downloadHighResScans = config->downloadHighResScans();
 
+	// JPEG images can be decoded at a reduced size if they're
+	// much larger than req_size. Images that need special
+	// handling are processed by getThumbnail() at full size.
+	const uint32_t imgpf = romData->imgpf(imageType);
+	const int sel_size = (imgpf & (RomData::IMGPF_RESCALE_ASPECT_8to7 | RomData::IMGPF_RESCALE_NEAREST))
+		? 0 : req_size;
+
 	CacheManager cache;
 	const auto extURLs_cend = extURLs.cend();
 	for (auto iter = extURLs.cbegin(); iter != extURLs_cend; ++iter) {
@@ -179,17 +208,27 @@ ImgClass TCreateThumbnail<ImgClass>::getExternalImage(
 		// Attempt to load the image.
 		unique_RefBase<RpFile> file(new RpFile(cache_filename, RpFile::FM_OPEN_READ));
 		if (file->isOpen()) {
-			rp_image *const dl_img = RpImageLoader::load(file.get());
+			int fullSize[2] = {0, 0};
+			rp_image *const dl_img = RpImageLoader::load(file.get(), sel_size, fullSize);
 			if (dl_img && dl_img->isValid()) {
 				// Image loaded successfully.
 				file->close();
-				ImgClass ret_img = rpImageToImgClass(dl_img);
+				rp_image *const sc_img = downscaleImage(dl_img, req_size, imgpf);
+				ImgClass ret_img = rpImageToImgClass(sc_img ? sc_img : dl_img);
+				UNREF(sc_img);
 				if (isImgClassValid(ret_img)) {
 					// Image converted successfully.
 					if (pOutSize) {
 						// Get the image size.
-						pOutSize->width = dl_img->width();
-						pOutSize->height = dl_img->height();
+						// NOTE: If the image was decoded at a reduced size,
+						// this is the full size of the original image.
+						if (fullSize[0] > 0 && fullSize[1] > 0) {
+							pOutSize->width = fullSize[0];
+							pOutSize->height = fullSize[1];
+						} else {
+							pOutSize->width = dl_img->width();
+							pOutSize->height = dl_img->height();
+						}
 					}
 					// Get the sBIT metadata.
 					if (sBIT) {
@@ -242,6 +281,37 @@ inline void TCreateThumbnail<ImgClass>::rescale_aspect(ImgSize &rs_size, const I
 	}
 }
 
+/**
+ * Downscale an rp_image if it's larger than the requested size.
+ * The aspect ratio is maintained.
+ * @param img		[in] rp_image.
+ * @param req_size	[in] Requested image size. (0 to disable downscaling)
+ * @param imgpf		[in] Image processing flags.
+ * @return Downscaled rp_image, or nullptr if downscaling isn't needed.
+ */
+template<typename ImgClass>
+rp_image *TCreateThumbnail<ImgClass>::downscaleImage(const rp_image *img, int req_size, uint32_t imgpf)
+{
+	if (req_size <= 0 || (img->width() <= req_size && img->height() <= req_size)) {
+		// Image is already small enough.
+		return nullptr;
+	}
+	if (imgpf & (RomData::IMGPF_RESCALE_ASPECT_8to7 | RomData::IMGPF_RESCALE_NEAREST)) {
+		// Image needs special handling, which is done
+		// by getThumbnail() on the full-size image.
+		return nullptr;
+	}
+
+	ImgSize sz = {img->width(), img->height()};
+	const ImgSize tgt_sz = {req_size, req_size};
+	rescale_aspect(sz, tgt_sz);
+	if (sz.width <= 0)
+		sz.width = 1;
+	if (sz.height <= 0)
+		sz.height = 1;
+	return img->scaled(sz.width, sz.height, rp_image::SCALE_LANCZOS);
+}
+
 /**
  * Create a thumbnail for the specified ROM file.
  * @param romData	[in] RomData object.
@@ -296,7 +366,7 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const RomData *romData, int reqSize
 		// Check for an icon first.
 		// TODO: Define "small sizes" somewhere. (DPI independence?)
 		if (imgbf & RomData::IMGBF_INT_ICON) {
-			pOutParams->retImg = getInternalImage(romData, RomData::IMG_INT_ICON, &pOutParams->fullSize, &pOutParams->sBIT);
+			pOutParams->retImg = getInternalImage(romData, RomData::IMG_INT_ICON, &pOutParams->fullSize, &pOutParams->sBIT, reqSize);
 			imgpf = romData->imgpf(RomData::IMG_INT_ICON);
 			imgbf &= ~RomData::IMGBF_INT_ICON;
 
@@ -328,7 +398,7 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const RomData *romData, int reqSize
 		// This image may be present.
 		if (imgType <= RomData::IMG_INT_MAX) {
 			// Internal image.
-			pOutParams->retImg = getInternalImage(romData, imgType, &pOutParams->fullSize, &pOutParams->sBIT);
+			pOutParams->retImg = getInternalImage(romData, imgType, &pOutParams->fullSize, &pOutParams->sBIT, reqSize);
 			imgpf = romData->imgpf(imgType);
 		} else {
 			// External image.
@@ -381,7 +451,9 @@ skip_image_check:
 		}
 	}
 
-	// TODO: If image is larger than req_size, resize down.
+	// NOTE: Images larger than reqSize were already downscaled
+	// by getInternalImage() or getExternalImage(), unless they
+	// need special handling.
 	if (imgpf & RomData::IMGPF_RESCALE_NEAREST) {
 		// TODO: User configuration.
 		ResizeNearestUpPolicy resize_up = RESIZE_UP_HALF;
@@ -439,8 +511,9 @@ skip_image_check:
 			pOutParams->thumbSize = pOutParams->fullSize;
 		}
 	} else {
-		// Thumbnail size matches the full image size.
-		pOutParams->thumbSize = pOutParams->fullSize;
+		// Use the actual image size, since the
+		// image may have been downscaled.
+		getImgClassSize(pOutParams->retImg, &pOutParams->thumbSize);
 	}
 
 	// Image retrieved successfully.
@@ -467,7 +540,7 @@ int TCreateThumbnail<ImgClass>::getThumbnail(IRpFile *file, int reqSize, GetThum
 
 	// Get the appropriate RomData class for this ROM.
 	// RomData class *must* support at least one image type.
-	RomData *romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL);
+	RomData *romData = RomDataIndex::create(file, RomDataFactory::RDA_HAS_THUMBNAIL);
 	if (!romData) {
 		// ROM is not supported.
 		return RPCT_SOURCE_FILE_NOT_SUPPORTED;
@@ -509,7 +582,7 @@ int TCreateThumbnail<ImgClass>::getThumbnail(const char *filename, int reqSize,
 
 	// Get the appropriate RomData class for this ROM.
 	// RomData class *must* support at least one image type.
-	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_THUMBNAIL);
+	RomData *const romData = RomDataIndex::create(file, RomDataFactory::RDA_HAS_THUMBNAIL);
 	file->unref();	// file is ref()'d by RomData.
 	if (!romData) {
 		// ROM is not supported.
@@ -64,6 +64,20 @@ typedef enum {
  */
 typedef int (RP_C_API *PFN_RP_CREATE_THUMBNAIL)(const char *source_file, const char *output_file, int maximum_size);
 
+/**
+ * rp_create_thumbnails_batch() function pointer.
+ * Used for wrapper programs that don't link to libromdata directly.
+ * @param count		[in] Number of files.
+ * @param source_files	[in] Source files. (UTF-8)
+ * @param output_files	[in] Output files. (UTF-8)
+ * @param maximum_size	[in] Maximum size.
+ * @param results	[out] Array of count RPCT error codes. (0 on success)
+ * @return Number of files that failed. (0 if all thumbnails were created)
+ */
+typedef int (RP_C_API *PFN_RP_CREATE_THUMBNAILS_BATCH)(unsigned int count,
+	const char *const *source_files, const char *const *output_files,
+	int maximum_size, int *results);
+
 #ifdef __cplusplus
 }
 #endif
@@ -108,12 +122,14 @@ class TCreateThumbnail
 		 * @param imageType	[in] Image type.
 		 * @param pOutSize	[out,opt] Pointer to ImgSize to store the image's size.
 		 * @param sBIT		[out,opt] sBIT metadata.
+		 * @param req_size	[in,opt] Requested image size. (0 to disable downscaling)
 		 * @return Internal image, or null ImgClass on error.
 		 */
 		ImgClass getInternalImage(const LibRpBase::RomData *romData,
 			LibRpBase::RomData::ImageType imageType,
 			ImgSize *pOutSize = nullptr,
-			LibRpTexture::rp_image::sBIT_t *sBIT = nullptr);
+			LibRpTexture::rp_image::sBIT_t *sBIT = nullptr,
+			int req_size = 0);
 
 		/**
 		 * Get an external image.
@@ -175,6 +191,16 @@ class TCreateThumbnail
 		 */
 		static inline void rescale_aspect(ImgSize &rs_size, const ImgSize &tgt_size);
 
+		/**
+		 * Downscale an rp_image if it's larger than the requested size.
+		 * The aspect ratio is maintained.
+		 * @param img		[in] rp_image.
+		 * @param req_size	[in] Requested image size. (0 to disable downscaling)
+		 * @param imgpf		[in] Image processing flags.
+		 * @return Downscaled rp_image, or nullptr if downscaling isn't needed.
+		 */
+		static LibRpTexture::rp_image *downscaleImage(const LibRpTexture::rp_image *img, int req_size, uint32_t imgpf);
+
 	protected:
 		/** Pure virtual functions. **/
 
@@ -0,0 +1,336 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * MetaDataOnlyTest.cpp: RomDataFactory metadata-only mode test.           *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase, librpfile
+#include "common.h"
+#include "byteswap_rp.h"
+#include "librpbase/RomData.hpp"
+#include "librpbase/RomMetaData.hpp"
+#include "librpfile/RpMemFile.hpp"
+using namespace LibRpBase;
+using namespace LibRpFile;
+
+// librptexture
+#include "librptexture/fileformat/dds_structs.h"
+
+// RomDataFactory
+#include "RomDataFactory.hpp"
+
+// Audio structs for synthetic test files.
+#include "Audio/nsf_structs.h"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+/**
+ * IRpFile wrapper that counts the number of bytes read.
+ * RpMemFile's read functions are final, so this wraps
+ * an RpMemFile instead of subclassing it.
+ */
+class CountingFile : public IRpFile
+{
+	public:
+		explicit CountingFile(const vector<uint8_t> &data)
+			: m_file(new RpMemFile(data.data(), data.size()))
+			, m_bytesRead(0)
+		{ }
+	protected:
+		~CountingFile() final
+		{
+			UNREF(m_file);
+		}
+
+	private:
+		RP_DISABLE_COPY(CountingFile)
+
+	public:
+		bool isOpen(void) const final
+		{
+			return (m_file != nullptr && m_file->isOpen());
+		}
+
+		void close(void) final
+		{
+			UNREF_AND_NULL(m_file);
+		}
+
+		size_t read(void *ptr, size_t size) final
+		{
+			if (!m_file)
+				return 0;
+			const size_t ret = m_file->read(ptr, size);
+			m_bytesRead += ret;
+			return ret;
+		}
+
+		size_t readAt(off64_t pos, void *ptr, size_t size) final
+		{
+			if (!m_file)
+				return 0;
+			const size_t ret = m_file->readAt(pos, ptr, size);
+			m_bytesRead += ret;
+			return ret;
+		}
+
+		size_t write(const void *ptr, size_t size) final
+		{
+			RP_UNUSED(ptr);
+			RP_UNUSED(size);
+			m_lastError = EBADF;
+			return 0;
+		}
+
+		int seek(off64_t pos) final
+		{
+			return (m_file ? m_file->seek(pos) : -1);
+		}
+
+		off64_t tell(void) final
+		{
+			return (m_file ? m_file->tell() : -1);
+		}
+
+		int truncate(off64_t size) final
+		{
+			RP_UNUSED(size);
+			m_lastError = ENOTSUP;
+			return -1;
+		}
+
+		off64_t size(void) final
+		{
+			return (m_file ? m_file->size() : -1);
+		}
+
+		string filename(void) const final
+		{
+			return string();
+		}
+
+	public:
+		/**
+		 * Get the number of bytes read so far.
+		 * @return Number of bytes read.
+		 */
+		size_t bytesRead(void) const
+		{
+			return m_bytesRead;
+		}
+
+	private:
+		RpMemFile *m_file;
+		size_t m_bytesRead;
+};
+
+class MetaDataOnlyTest : public ::testing::Test
+{
+	protected:
+		MetaDataOnlyTest() { }
+
+	public:
+		/**
+		 * Create a synthetic NSF file.
+		 * @return NSF file data.
+		 */
+		static vector<uint8_t> createNSF(void);
+
+		/**
+		 * Create a synthetic 256x256 DXT1 DDS texture.
+		 * @return DDS file data.
+		 */
+		static vector<uint8_t> createDDS(void);
+
+		/**
+		 * Get the number of bytes read by RomDataFactory::create()
+		 * plus the requested RomData accessors.
+		 * @param data File data.
+		 * @param attrs RomDataFactory attributes.
+		 * @param loadAll If true, also load fields and images.
+		 * @return Number of bytes read, or 0 if the file isn't supported.
+		 */
+		static size_t bytesReadFor(const vector<uint8_t> &data, unsigned int attrs, bool loadAll);
+};
+
+/**
+ * Create a synthetic NSF file.
+ * @return NSF file data.
+ */
+vector<uint8_t> MetaDataOnlyTest::createNSF(void)
+{
+	// 128-byte header, plus 32 KB of (blank) program data.
+	vector<uint8_t> data(sizeof(NSF_Header) + 32768);
+	NSF_Header *const nsfHeader = reinterpret_cast<NSF_Header*>(data.data());
+	memcpy(nsfHeader->magic, NSF_MAGIC, sizeof(nsfHeader->magic));
+	nsfHeader->track_count = 1;
+	nsfHeader->default_track = 1;
+	nsfHeader->load_address = cpu_to_le16(0x8000);
+	nsfHeader->init_address = cpu_to_le16(0x8000);
+	nsfHeader->play_address = cpu_to_le16(0x8003);
+	strcpy(nsfHeader->title, "Metadata Test");
+	strcpy(nsfHeader->composer, "Composer");
+	strcpy(nsfHeader->copyright, "2020 Copyright");
+	return data;
+}
+
+/**
+ * Create a synthetic 256x256 DXT1 DDS texture.
+ * @return DDS file data.
+ */
+vector<uint8_t> MetaDataOnlyTest::createDDS(void)
+{
+	// DXT1 uses 8 bytes per 4x4 block.
+	static const unsigned int dimension = 256;
+	static const size_t texDataSize = (dimension / 4) * (dimension / 4) * 8;
+
+	vector<uint8_t> data(4 + sizeof(DDS_HEADER) + texDataSize);
+	uint32_t *const pMagic = reinterpret_cast<uint32_t*>(data.data());
+	*pMagic = cpu_to_be32(DDS_MAGIC);
+
+	DDS_HEADER *const ddsHeader = reinterpret_cast<DDS_HEADER*>(&data[4]);
+	ddsHeader->dwSize = cpu_to_le32(sizeof(*ddsHeader));
+	ddsHeader->dwFlags = cpu_to_le32(DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH |
+	                                 DDSD_PIXELFORMAT | DDSD_LINEARSIZE);
+	ddsHeader->dwHeight = cpu_to_le32(dimension);
+	ddsHeader->dwWidth = cpu_to_le32(dimension);
+	ddsHeader->dwPitchOrLinearSize = cpu_to_le32(static_cast<uint32_t>(texDataSize));
+	ddsHeader->ddspf.dwSize = cpu_to_le32(sizeof(ddsHeader->ddspf));
+	ddsHeader->ddspf.dwFlags = cpu_to_le32(DDPF_FOURCC);
+	ddsHeader->ddspf.dwFourCC = cpu_to_be32(DDPF_FOURCC_DXT1);
+	ddsHeader->dwCaps = cpu_to_le32(DDSCAPS_TEXTURE);
+	return data;
+}
+
+/**
+ * Get the number of bytes read by RomDataFactory::create()
+ * plus the requested RomData accessors.
+ * @param data File data.
+ * @param attrs RomDataFactory attributes.
+ * @param loadAll If true, also load fields and images.
+ * @return Number of bytes read, or 0 if the file isn't supported.
+ */
+size_t MetaDataOnlyTest::bytesReadFor(const vector<uint8_t> &data, unsigned int attrs, bool loadAll)
+{
+	CountingFile *const file = new CountingFile(data);
+	RomData *const romData = RomDataFactory::create(file, attrs);
+	if (!romData) {
+		file->unref();
+		return 0;
+	}
+
+	EXPECT_NE(nullptr, romData->metaData());
+	if (loadAll) {
+		romData->fields();
+		const uint32_t imgbf = romData->supportedImageTypes();
+		for (int i = RomData::IMG_INT_MIN; i <= RomData::IMG_INT_MAX; i++) {
+			if (imgbf & (1U << i)) {
+				romData->image(static_cast<RomData::ImageType>(i));
+			}
+		}
+	}
+
+	romData->unref();
+	const size_t ret = file->bytesRead();
+	file->unref();
+	return ret;
+}
+
+/**
+ * Metadata-only mode must not load fields or images.
+ */
+TEST_F(MetaDataOnlyTest, noFieldsOrImages)
+{
+	const vector<uint8_t> data = createDDS();
+	CountingFile *const file = new CountingFile(data);
+	RomData *const romData = RomDataFactory::create(file, RomDataFactory::RDA_METADATA_ONLY);
+	ASSERT_NE(nullptr, romData);
+
+	EXPECT_TRUE(romData->isMetaDataOnly());
+	EXPECT_EQ(nullptr, romData->fields());
+	EXPECT_EQ(nullptr, romData->image(RomData::IMG_INT_IMAGE));
+
+	const RomMetaData *const metaData = romData->metaData();
+	ASSERT_NE(nullptr, metaData);
+	EXPECT_FALSE(metaData->empty());
+
+	romData->unref();
+	file->unref();
+}
+
+/**
+ * Metadata-only mode requires RDA_HAS_METADATA.
+ */
+TEST_F(MetaDataOnlyTest, requiresMetaData)
+{
+	// A file that isn't supported by anything.
+	const vector<uint8_t> data(8192, 0xA5);
+	CountingFile *const file = new CountingFile(data);
+	EXPECT_EQ(nullptr, RomDataFactory::create(file, RomDataFactory::RDA_METADATA_ONLY));
+	file->unref();
+}
+
+/**
+ * NSF: Metadata is in the 128-byte header.
+ * Bytes read: RomDataFactory header (4,096+256) + NSF header (128)
+ */
+TEST_F(MetaDataOnlyTest, NSF)
+{
+	const vector<uint8_t> data = createNSF();
+	const size_t metaBytes = bytesReadFor(data, RomDataFactory::RDA_METADATA_ONLY, false);
+	const size_t fullBytes = bytesReadFor(data, RomDataFactory::RDA_NONE, true);
+
+	EXPECT_EQ(4096U + 256U + sizeof(NSF_Header), metaBytes);
+	EXPECT_LE(metaBytes, fullBytes);
+}
+
+/**
+ * DDS: Metadata is in the header; the texture isn't decoded.
+ * Bytes read: RomDataFactory header (4,096+256) + FileFormatFactory magic (8) + DDS headers
+ */
+TEST_F(MetaDataOnlyTest, DDS)
+{
+	const vector<uint8_t> data = createDDS();
+	const size_t metaBytes = bytesReadFor(data, RomDataFactory::RDA_METADATA_ONLY, false);
+	const size_t fullBytes = bytesReadFor(data, RomDataFactory::RDA_NONE, true);
+
+	// FileFormatFactory reads an 8-byte magic number.
+	// The DDS constructor reads the magic number, the DDS header,
+	// and the optional DXT10 and Xbox One headers.
+	EXPECT_EQ(4096U + 256U + 8U + 4U + sizeof(DDS_HEADER) +
+		sizeof(DDS_HEADER_DXT10) + sizeof(DDS_HEADER_XBOX), metaBytes);
+
+	// Full mode has to read the entire texture.
+	EXPECT_GE(fullBytes, metaBytes + (data.size() - 4 - sizeof(DDS_HEADER)));
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: MetaDataOnly tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
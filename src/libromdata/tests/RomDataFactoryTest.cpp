@@ -0,0 +1,263 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * RomDataFactoryTest.cpp: RomDataFactory detection test.                  *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase, librpfile
+#include "common.h"
+#include "byteswap_rp.h"
+#include "librpbase/RomData.hpp"
+#include "librpfile/RpMemFile.hpp"
+#include "ctypex.h"
+using namespace LibRpBase;
+using namespace LibRpFile;
+
+// RomDataFactory
+#include "RomDataFactory.hpp"
+
+// Structs for synthetic test files.
+#include "Console/sega8_structs.h"
+#include "Handheld/pkmnmini_structs.h"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <algorithm>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+/**
+ * IRpFile wrapper that has a filename.
+ * RomDataFactory uses the file extension to determine which
+ * subclasses with headers at non-zero addresses are checked.
+ * RpMemFile's functions are final, so this wraps an
+ * RpMemFile instead of subclassing it.
+ */
+class NamedMemFile : public IRpFile
+{
+	public:
+		NamedMemFile(const vector<uint8_t> &data, const char *filename)
+			: m_file(new RpMemFile(data.data(), data.size()))
+			, m_filename(filename)
+		{ }
+	protected:
+		~NamedMemFile() final
+		{
+			UNREF(m_file);
+		}
+
+	private:
+		RP_DISABLE_COPY(NamedMemFile)
+
+	public:
+		bool isOpen(void) const final
+		{
+			return (m_file != nullptr && m_file->isOpen());
+		}
+
+		void close(void) final
+		{
+			UNREF_AND_NULL(m_file);
+		}
+
+		size_t read(void *ptr, size_t size) final
+		{
+			return (m_file ? m_file->read(ptr, size) : 0);
+		}
+
+		size_t readAt(off64_t pos, void *ptr, size_t size) final
+		{
+			return (m_file ? m_file->readAt(pos, ptr, size) : 0);
+		}
+
+		size_t write(const void *ptr, size_t size) final
+		{
+			RP_UNUSED(ptr);
+			RP_UNUSED(size);
+			m_lastError = EBADF;
+			return 0;
+		}
+
+		int seek(off64_t pos) final
+		{
+			return (m_file ? m_file->seek(pos) : -1);
+		}
+
+		off64_t tell(void) final
+		{
+			return (m_file ? m_file->tell() : -1);
+		}
+
+		int truncate(off64_t size) final
+		{
+			RP_UNUSED(size);
+			m_lastError = ENOTSUP;
+			return -1;
+		}
+
+		off64_t size(void) final
+		{
+			return (m_file ? m_file->size() : -1);
+		}
+
+		string filename(void) const final
+		{
+			return m_filename;
+		}
+
+	private:
+		RpMemFile *m_file;
+		string m_filename;
+};
+
+struct RomDataFactoryTest_mode
+{
+	const char *filename;	// Filename, including the extension.
+	bool pokemonMini;	// If true, create a Pokémon Mini ROM; otherwise, a Sega 8-bit ROM.
+	const char *className;	// Expected RomData class name, or nullptr if not supported.
+};
+
+class RomDataFactoryTest : public ::testing::TestWithParam<RomDataFactoryTest_mode>
+{
+	protected:
+		RomDataFactoryTest() { }
+
+	public:
+		/**
+		 * Create a synthetic 32 KB Sega Master System ROM image.
+		 * @return ROM image data.
+		 */
+		static vector<uint8_t> createSega8Bit(void);
+
+		/**
+		 * Create a synthetic 32 KB Pokémon Mini ROM image.
+		 * @return ROM image data.
+		 */
+		static vector<uint8_t> createPokemonMini(void);
+
+		/**
+		 * Test case suffix generator.
+		 * @param info Test parameter information.
+		 * @return Test case suffix.
+		 */
+		static string test_case_suffix_generator(const ::testing::TestParamInfo<RomDataFactoryTest_mode> &info);
+};
+
+/**
+ * Create a synthetic 32 KB Sega Master System ROM image.
+ * @return ROM image data.
+ */
+vector<uint8_t> RomDataFactoryTest::createSega8Bit(void)
+{
+	// "TMR SEGA" header at 0x7FF0.
+	vector<uint8_t> data(32768);
+	Sega8_RomHeader *const romHeader = reinterpret_cast<Sega8_RomHeader*>(&data[0x7FF0]);
+	memcpy(romHeader->magic, SEGA8_MAGIC, sizeof(romHeader->magic));
+	return data;
+}
+
+/**
+ * Create a synthetic 32 KB Pokémon Mini ROM image.
+ * @return ROM image data.
+ */
+vector<uint8_t> RomDataFactoryTest::createPokemonMini(void)
+{
+	// "MN" header at 0x2100.
+	vector<uint8_t> data(32768);
+	PokemonMini_RomHeader *const romHeader =
+		reinterpret_cast<PokemonMini_RomHeader*>(&data[POKEMONMINI_HEADER_ADDRESS]);
+	romHeader->pm_magic = be16_to_cpu(POKEMONMINI_MN_MAGIC);
+	memcpy(romHeader->nintendo, "NINTENDO", sizeof(romHeader->nintendo));
+	memcpy(romHeader->game_id, "MTST", sizeof(romHeader->game_id));
+	memcpy(romHeader->title, "FACTORY TEST", sizeof(romHeader->title));
+	return data;
+}
+
+/**
+ * Test case suffix generator.
+ * @param info Test parameter information.
+ * @return Test case suffix.
+ */
+string RomDataFactoryTest::test_case_suffix_generator(const ::testing::TestParamInfo<RomDataFactoryTest_mode> &info)
+{
+	string suffix = (info.param.pokemonMini ? "PokemonMini_" : "Sega8Bit_");
+	suffix += info.param.filename;
+
+	// Replace all non-alphanumeric characters with '_'.
+	// See gtest-param-util.h::IsValidParamName().
+	std::for_each(suffix.begin(), suffix.end(),
+		[](char &c) {
+			// NOTE: Not checking for '_' because that
+			// wastes a branch.
+			if (!ISALNUM(c)) {
+				c = '_';
+			}
+		}
+	);
+
+	return suffix;
+}
+
+/**
+ * Detect a ROM image with a header at a non-zero address.
+ */
+TEST_P(RomDataFactoryTest, nonZeroHeaderAddress)
+{
+	const RomDataFactoryTest_mode &mode = GetParam();
+
+	const vector<uint8_t> data = (mode.pokemonMini ? createPokemonMini() : createSega8Bit());
+	NamedMemFile *const file = new NamedMemFile(data, mode.filename);
+	RomData *const romData = RomDataFactory::create(file);
+	if (mode.className) {
+		ASSERT_NE(nullptr, romData) << "File '" << mode.filename << "' was not detected.";
+		EXPECT_STREQ(mode.className, romData->className());
+	} else {
+		EXPECT_EQ(nullptr, romData) << "File '" << mode.filename << "' should not have been detected.";
+	}
+
+	UNREF(romData);
+	file->unref();
+}
+
+INSTANTIATE_TEST_SUITE_P(RomDataFactory, RomDataFactoryTest,
+	::testing::Values(
+		// Sega 8-bit: Header at 0x7FF0.
+		RomDataFactoryTest_mode{"test.sms", false, "Sega8Bit"},
+		RomDataFactoryTest_mode{"test.gg", false, "Sega8Bit"},
+		RomDataFactoryTest_mode{"test.bin", false, "Sega8Bit"},
+		RomDataFactoryTest_mode{"TEST.BIN", false, "Sega8Bit"},
+		RomDataFactoryTest_mode{"test.txt", false, nullptr},
+
+		// Pokémon Mini: Header at 0x2100.
+		RomDataFactoryTest_mode{"test.min", true, "PokemonMini"},
+		RomDataFactoryTest_mode{"test.bin", true, "PokemonMini"},
+		RomDataFactoryTest_mode{"test.txt", true, nullptr})
+	, RomDataFactoryTest::test_case_suffix_generator);
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: RomDataFactory tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
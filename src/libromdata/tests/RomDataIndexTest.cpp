@@ -0,0 +1,803 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (libromdata/tests)                 *
+ * RomDataIndexTest.cpp: RomDataIndex entry serialization test.            *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase, librpfile
+#include "common.h"
+#include "librpbase/RomData_p.hpp"
+#include "librpbase/RomFields.hpp"
+#include "librpbase/RomMetaData.hpp"
+#include "librpbase/crypto/KeyManager.hpp"
+#include "librpfile/FileSystem.hpp"
+#include "librpfile/RpFile.hpp"
+using namespace LibRpBase;
+using namespace LibRpFile;
+
+// RomDataIndex
+#include "RomDataIndex_p.hpp"
+
+// C includes.
+#ifndef _WIN32
+#  include <unistd.h>	/* getcwd() */
+#endif /* !_WIN32 */
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRomData { namespace Tests {
+
+/**
+ * RomData subclass that has every RomFields and RomMetaData type.
+ */
+class TestRomData final : public RomData
+{
+	public:
+		explicit TestRomData(IRpFile *file, bool empty = false)
+			: super(file)
+			, m_empty(empty)
+		{
+			d_ptr->className = "TestRomData";
+			d_ptr->mimeType = "application/x-rp-test";
+			d_ptr->fileType = FileType::DiscImage;
+			d_ptr->isValid = true;
+		}
+
+	private:
+		typedef RomData super;
+		RP_DISABLE_COPY(TestRomData)
+
+	public:
+		int isRomSupported(const DetectInfo *info) const final
+		{
+			RP_UNUSED(info);
+			return -1;
+		}
+
+		const char *systemName(unsigned int type) const final
+		{
+			static const char *const sysNames[4] = {
+				"Test System", "Test", "TS", nullptr
+			};
+			if (type & SYSNAME_REGION_ROM_LOCAL) {
+				// Local names are only set for the long name.
+				return ((type & SYSNAME_TYPE_MASK) == 0 ? "Tesuto Shisutemu" : nullptr);
+			}
+			return sysNames[type & SYSNAME_TYPE_MASK];
+		}
+
+		const char *const *supportedFileExtensions(void) const final
+		{
+			static const char *const exts[] = {".rptest", nullptr};
+			return exts;
+		}
+
+		const char *const *supportedMimeTypes(void) const final
+		{
+			static const char *const mimeTypes[] = {"application/x-rp-test", nullptr};
+			return mimeTypes;
+		}
+
+		bool hasDangerousPermissions(void) const final
+		{
+			return true;
+		}
+
+	protected:
+		int loadFieldData(void) final;
+		int loadMetaData(void) final;
+
+	private:
+		bool m_empty;	// If true, no fields or metadata are added.
+};
+
+/**
+ * Load field data.
+ * Called by RomData::fields() if the field data hasn't been loaded yet.
+ * @return Number of fields read on success; negative POSIX error code on error.
+ */
+int TestRomData::loadFieldData(void)
+{
+	RomFields *const fields = d_ptr->fields;
+	if (m_empty) {
+		return 0;
+	}
+	fields->reserveTabs(2);
+	fields->setTabName(0, "Main");
+	fields->setTabName(1, "Extra");
+
+	// RFT_STRING
+	fields->addField_string("String", "Test string   ", RomFields::STRF_TRIM_END);
+	fields->addField_string("Empty string", "");
+	fields->addField_string("Unset string", nullptr);
+	fields->addField_string("Monospace", "0123456789ABCDEF", RomFields::STRF_MONOSPACE);
+
+	// RFT_BITFIELD
+	static const char *const bit_names[] = {
+		"Bit 0", "Bit 1", nullptr, "Bit 3", "Bit 4",
+	};
+	fields->addField_bitfield("Bitfield",
+		RomFields::strArrayToVector(bit_names, ARRAY_SIZE(bit_names)), 3, 0x1B);
+
+	// RFT_LISTDATA (single, with checkboxes)
+	static const char *const col_names[] = {"Column 1", "Column 2"};
+	RomFields::ListDataBuilder builder(fields, 3, 2);
+	for (unsigned int i = 0; i < 3; i++) {
+		char buf[32];
+		builder.addRow();
+		snprintf(buf, sizeof(buf), "Row %u", i);
+		builder.add(buf);
+		snprintf(buf, sizeof(buf), "Line 1\nLine %u", i + 2);
+		builder.add(buf);
+	}
+	RomFields::AFLD_PARAMS params(RomFields::RFT_LISTDATA_CHECKBOXES | RomFields::RFT_LISTDATA_SEPARATE_ROW, 4);
+	params.headers = RomFields::strArrayToVector(col_names, ARRAY_SIZE(col_names));
+	params.col_attrs.align_headers = 0x5;
+	params.col_attrs.align_data = 0xA;
+	params.col_attrs.sizing = 0x7;
+	params.col_attrs.sorting = 0x2;
+	params.col_attrs.sort_col = 1;
+	params.col_attrs.sort_dir = RomFields::COLSORTORDER_DESCENDING;
+	params.view.single = new RomFields::ListDataView_t(builder.release());
+	params.mxd.checkboxes = 0x5;
+	fields->addField_listData("List data", &params);
+
+	// RFT_LISTDATA (multi)
+	fields->setTabIndex(1);
+	RomFields::ListDataViewMultiMap_t *const multi = new RomFields::ListDataViewMultiMap_t();
+	static const uint32_t lcs[] = {'en', 'de'};
+	for (uint32_t lc : lcs) {
+		for (unsigned int i = 0; i < 2; i++) {
+			char buf[32];
+			builder.addRow();
+			snprintf(buf, sizeof(buf), "%c%c %u", (char)(lc >> 8), (char)lc, i);
+			builder.add(buf);
+		}
+		multi->insert(std::make_pair(lc, builder.release()));
+	}
+	RomFields::AFLD_PARAMS params_multi(RomFields::RFT_LISTDATA_MULTI, 0);
+	params_multi.def_lc = 'en';
+	params_multi.view.multi = multi;
+	fields->addField_listData("List data (multi)", &params_multi);
+
+	// RFT_DATETIME
+	fields->addField_dateTime("Date/Time", 1234567890,
+		RomFields::RFT_DATETIME_HAS_DATE | RomFields::RFT_DATETIME_HAS_TIME);
+	fields->addField_dateTime("Invalid date", -1, RomFields::RFT_DATETIME_HAS_DATE);
+
+	// RFT_AGE_RATINGS
+	RomFields::age_ratings_t age_ratings;
+	for (size_t i = 0; i < age_ratings.size(); i++) {
+		age_ratings[i] = static_cast<uint16_t>(RomFields::AGEBF_ACTIVE | i);
+	}
+	fields->addField_ageRatings("Age ratings", age_ratings);
+
+	// RFT_DIMENSIONS
+	fields->addField_dimensions("Dimensions", 256, 128, 4);
+
+	// RFT_STRING_MULTI
+	RomFields::StringMultiMap_t *const str_multi = new RomFields::StringMultiMap_t();
+	str_multi->emplace('en', "Title");
+	str_multi->emplace('fr', "Titre");
+	str_multi->emplace('ja', "\xE3\x82\xBF\xE3\x82\xA4\xE3\x83\x88\xE3\x83\xAB");
+	fields->addField_string_multi("String (multi)", str_multi, 'en');
+
+	return fields->count();
+}
+
+/**
+ * Load metadata properties.
+ * Called by RomData::metaData() if the field data hasn't been loaded yet.
+ * @return Number of metadata properties read on success; negative POSIX error code on error.
+ */
+int TestRomData::loadMetaData(void)
+{
+	RomMetaData *const metaData = new RomMetaData();
+	d_ptr->metaData = metaData;
+	if (m_empty) {
+		return 0;
+	}
+
+	metaData->addMetaData_integer(Property::Duration, -12345);
+	metaData->addMetaData_uint(Property::TrackNumber, 0xFEDCBA98U);
+	metaData->addMetaData_string(Property::Title, "Metadata title");
+	metaData->addMetaData_string(Property::Comment, "");
+	metaData->addMetaData_timestamp(Property::CreationDate, 1234567890);
+	return metaData->count();
+}
+
+class RomDataIndexTest : public ::testing::Test
+{
+	protected:
+		RomDataIndexTest()
+			: romData(nullptr)
+		{
+			fileId.dev = 0x0123456789ABCDEFULL;
+			fileId.ino = 0xFEDCBA9876543210ULL;
+			fileId.size = 1048576;
+			fileId.mtime = 1234567890;
+		}
+
+		void SetUp(void) final
+		{
+			romData = new TestRomData(nullptr);
+			RomDataIndexPrivate::serializeEntry(entry, fileId, 0, romData);
+			ASSERT_FALSE(entry.empty());
+		}
+
+		void TearDown(void) final
+		{
+			UNREF_AND_NULL(romData);
+		}
+
+		static void SetUpTestCase(void);
+
+	public:
+		/**
+		 * Compare two RomFields objects.
+		 * @param expected Expected RomFields.
+		 * @param actual Actual RomFields.
+		 */
+		static void compareFields(const RomFields *expected, const RomFields *actual);
+
+		/**
+		 * Compare two RomMetaData objects.
+		 * @param expected Expected RomMetaData.
+		 * @param actual Actual RomMetaData.
+		 */
+		static void compareMetaData(const RomMetaData *expected, const RomMetaData *actual);
+
+		/**
+		 * Load an index entry, and make sure accessing it doesn't crash.
+		 * @param entry Entry data.
+		 * @param pHit [out] Set to true on an index hit.
+		 * @return True if the entry was parsed; false if not.
+		 */
+		bool loadEntry(vector<uint8_t> entry, bool *pHit) const;
+
+	public:
+		FileSystem::FileIdentity fileId;
+		vector<uint8_t> entry;
+		RomData *romData;
+
+		// Temporary directory for index entries and configuration files.
+		static string tmp_dir;
+};
+
+string RomDataIndexTest::tmp_dir;
+
+/**
+ * Set up the temporary directory.
+ * On Linux, the configuration directory is redirected here,
+ * so keys.conf can be changed without affecting the user.
+ */
+void RomDataIndexTest::SetUpTestCase(void)
+{
+#ifndef _WIN32
+	char cwd[4096];
+	ASSERT_TRUE(getcwd(cwd, sizeof(cwd)) != nullptr);
+	tmp_dir = cwd;
+	tmp_dir += "/RomDataIndexTest.tmp/";
+
+	// NOTE: The environment variable buffer becomes
+	// part of the environment, so it must be static.
+	static string xdg_config_home_env;
+	xdg_config_home_env = "XDG_CONFIG_HOME=" + tmp_dir + "config";
+	putenv(const_cast<char*>(xdg_config_home_env.c_str()));
+
+	// Create keys.conf before the KeyManager is initialized
+	// so its mtime is included in the index entries.
+	const string keys_conf = tmp_dir + "config/rom-properties/keys.conf";
+	ASSERT_EQ(0, FileSystem::rmkdir(keys_conf));
+	RpFile *const file = new RpFile(keys_conf, RpFile::FM_CREATE_WRITE);
+	ASSERT_TRUE(file->isOpen());
+	static const char keys_conf_data[] = "[Keys]\n";
+	file->write(keys_conf_data, sizeof(keys_conf_data)-1);
+	file->unref();
+	FileSystem::set_mtime(keys_conf, 1000000000);
+#else /* _WIN32 */
+	tmp_dir = "RomDataIndexTest.tmp\\";
+	ASSERT_EQ(0, FileSystem::rmkdir(tmp_dir));
+#endif /* _WIN32 */
+}
+
+/**
+ * Compare two RomFields objects.
+ * @param expected Expected RomFields.
+ * @param actual Actual RomFields.
+ */
+void RomDataIndexTest::compareFields(const RomFields *expected, const RomFields *actual)
+{
+	ASSERT_TRUE(expected != nullptr);
+	ASSERT_TRUE(actual != nullptr);
+	ASSERT_EQ(expected->count(), actual->count());
+	ASSERT_EQ(expected->tabCount(), actual->tabCount());
+	for (int i = 0; i < expected->tabCount(); i++) {
+		EXPECT_STREQ(expected->tabName(i), actual->tabName(i));
+	}
+	EXPECT_EQ(expected->defaultLanguageCode(), actual->defaultLanguageCode());
+
+	for (int i = 0; i < expected->count(); i++) {
+		const RomFields::Field *const pExp = expected->at(i);
+		const RomFields::Field *const pAct = actual->at(i);
+		ASSERT_TRUE(pExp != nullptr);
+		ASSERT_TRUE(pAct != nullptr);
+		EXPECT_EQ(pExp->name, pAct->name);
+		ASSERT_EQ(pExp->type, pAct->type) << "field: " << pExp->name;
+		EXPECT_EQ(pExp->tabIdx, pAct->tabIdx) << "field: " << pExp->name;
+		EXPECT_EQ(pExp->isValid, pAct->isValid) << "field: " << pExp->name;
+
+		switch (pExp->type) {
+			case RomFields::RFT_STRING:
+				EXPECT_EQ(pExp->desc.flags, pAct->desc.flags);
+				EXPECT_EQ(!!pExp->data.str, !!pAct->data.str) << "field: " << pExp->name;
+				EXPECT_EQ(pExp->data.str.toString(), pAct->data.str.toString());
+				break;
+
+			case RomFields::RFT_BITFIELD:
+				EXPECT_EQ(pExp->desc.bitfield.elemsPerRow, pAct->desc.bitfield.elemsPerRow);
+				ASSERT_TRUE(pAct->desc.bitfield.names != nullptr);
+				EXPECT_EQ(*(pExp->desc.bitfield.names), *(pAct->desc.bitfield.names));
+				EXPECT_EQ(pExp->data.bitfield, pAct->data.bitfield);
+				break;
+
+			case RomFields::RFT_LISTDATA: {
+				const auto &expDesc = pExp->desc.list_data;
+				const auto &actDesc = pAct->desc.list_data;
+				EXPECT_EQ(expDesc.flags, actDesc.flags);
+				EXPECT_EQ(expDesc.rows_visible, actDesc.rows_visible);
+				EXPECT_EQ(expDesc.col_attrs.align_headers, actDesc.col_attrs.align_headers);
+				EXPECT_EQ(expDesc.col_attrs.align_data, actDesc.col_attrs.align_data);
+				EXPECT_EQ(expDesc.col_attrs.sizing, actDesc.col_attrs.sizing);
+				EXPECT_EQ(expDesc.col_attrs.sorting, actDesc.col_attrs.sorting);
+				EXPECT_EQ(expDesc.col_attrs.sort_col, actDesc.col_attrs.sort_col);
+				EXPECT_EQ(expDesc.col_attrs.sort_dir, actDesc.col_attrs.sort_dir);
+				EXPECT_EQ(!!expDesc.names, !!actDesc.names);
+				if (expDesc.names && actDesc.names) {
+					EXPECT_EQ(*expDesc.names, *actDesc.names);
+				}
+
+				// Compare the rows.
+				auto compareListData = [](const RomFields::ListDataView_t *exp, const RomFields::ListDataView_t *act) {
+					ASSERT_TRUE(exp != nullptr);
+					ASSERT_TRUE(act != nullptr);
+					ASSERT_EQ(exp->size(), act->size());
+					for (size_t row = 0; row < exp->size(); row++) {
+						const RomFields::ListDataRow_t &expRow = exp->at(row);
+						const RomFields::ListDataRow_t &actRow = act->at(row);
+						ASSERT_EQ(expRow.size(), actRow.size());
+						for (size_t col = 0; col < expRow.size(); col++) {
+							EXPECT_EQ(expRow[col].toString(), actRow[col].toString());
+						}
+					}
+				};
+				if (expDesc.flags & RomFields::RFT_LISTDATA_MULTI) {
+					const RomFields::ListDataViewMultiMap_t *const expMulti = pExp->data.list_data.data.multi;
+					const RomFields::ListDataViewMultiMap_t *const actMulti = pAct->data.list_data.data.multi;
+					ASSERT_TRUE(actMulti != nullptr);
+					ASSERT_EQ(expMulti->size(), actMulti->size());
+					for (const auto &pld : *expMulti) {
+						auto iter = actMulti->find(pld.first);
+						ASSERT_TRUE(iter != actMulti->end());
+						compareListData(&pld.second, &iter->second);
+					}
+				} else {
+					compareListData(pExp->data.list_data.data.single, pAct->data.list_data.data.single);
+				}
+				if (expDesc.flags & RomFields::RFT_LISTDATA_CHECKBOXES) {
+					EXPECT_EQ(pExp->data.list_data.mxd.checkboxes, pAct->data.list_data.mxd.checkboxes);
+				}
+				break;
+			}
+
+			case RomFields::RFT_DATETIME:
+				EXPECT_EQ(pExp->desc.flags, pAct->desc.flags);
+				EXPECT_EQ(pExp->data.date_time, pAct->data.date_time);
+				break;
+
+			case RomFields::RFT_AGE_RATINGS:
+				ASSERT_TRUE(pAct->data.age_ratings != nullptr);
+				EXPECT_EQ(*(pExp->data.age_ratings), *(pAct->data.age_ratings));
+				break;
+
+			case RomFields::RFT_DIMENSIONS:
+				EXPECT_EQ(pExp->data.dimensions[0], pAct->data.dimensions[0]);
+				EXPECT_EQ(pExp->data.dimensions[1], pAct->data.dimensions[1]);
+				EXPECT_EQ(pExp->data.dimensions[2], pAct->data.dimensions[2]);
+				break;
+
+			case RomFields::RFT_STRING_MULTI:
+				EXPECT_EQ(pExp->desc.flags, pAct->desc.flags);
+				ASSERT_TRUE(pAct->data.str_multi != nullptr);
+				EXPECT_EQ(*(pExp->data.str_multi), *(pAct->data.str_multi));
+				break;
+
+			default:
+				ADD_FAILURE() << "Unexpected field type: " << (int)pExp->type;
+				break;
+		}
+	}
+}
+
+/**
+ * Compare two RomMetaData objects.
+ * @param expected Expected RomMetaData.
+ * @param actual Actual RomMetaData.
+ */
+void RomDataIndexTest::compareMetaData(const RomMetaData *expected, const RomMetaData *actual)
+{
+	ASSERT_TRUE(expected != nullptr);
+	ASSERT_TRUE(actual != nullptr);
+	ASSERT_EQ(expected->count(), actual->count());
+
+	for (int i = 0; i < expected->count(); i++) {
+		const RomMetaData::MetaData *const pExp = expected->prop(i);
+		const RomMetaData::MetaData *const pAct = actual->prop(i);
+		ASSERT_TRUE(pExp != nullptr);
+		ASSERT_TRUE(pAct != nullptr);
+		EXPECT_EQ(pExp->name, pAct->name);
+		ASSERT_EQ(pExp->type, pAct->type);
+
+		switch (pExp->type) {
+			case PropertyType::Integer:
+				EXPECT_EQ(pExp->data.ivalue, pAct->data.ivalue);
+				break;
+			case PropertyType::UnsignedInteger:
+				EXPECT_EQ(pExp->data.uvalue, pAct->data.uvalue);
+				break;
+			case PropertyType::String:
+				EXPECT_EQ(pExp->data.str.toString(), pAct->data.str.toString());
+				break;
+			case PropertyType::Timestamp:
+				EXPECT_EQ(pExp->data.timestamp, pAct->data.timestamp);
+				break;
+			default:
+				ADD_FAILURE() << "Unexpected property type: " << (int)pExp->type;
+				break;
+		}
+	}
+}
+
+/**
+ * Load an index entry, and make sure accessing it doesn't crash.
+ * @param entry Entry data.
+ * @param pHit [out] Set to true on an index hit.
+ * @return True if the entry was parsed; false if not.
+ */
+bool RomDataIndexTest::loadEntry(vector<uint8_t> entry, bool *pHit) const
+{
+	RomData *const indexed = RomDataIndexPrivate::createFromEntry(nullptr, 0, fileId, entry, pHit);
+	if (!indexed) {
+		return false;
+	}
+
+	// Access everything that's indexed.
+	const char *const className = indexed->className();
+	if (className) {
+		EXPECT_GE(strlen(className), 0U);
+	}
+	for (unsigned int type = 0; type < 8; type++) {
+		indexed->systemName(type);
+	}
+	indexed->mimeType();
+	indexed->fileType();
+	indexed->supportedImageTypes();
+	indexed->hasDangerousPermissions();
+
+	const RomFields *const fields = indexed->fields();
+	if (fields) {
+		const auto fields_cend = fields->cend();
+		for (auto iter = fields->cbegin(); iter != fields_cend; ++iter) {
+			EXPECT_GE(iter->name.size(), 0U);
+		}
+	}
+	const RomMetaData *const metaData = indexed->metaData();
+	if (metaData) {
+		EXPECT_GE(metaData->count(), 0);
+	}
+
+	indexed->unref();
+	return true;
+}
+
+/**
+ * Save and load an entry with every RomFields and RomMetaData type.
+ */
+TEST_F(RomDataIndexTest, roundTrip)
+{
+	bool hit = false;
+	RomData *const indexed = RomDataIndexPrivate::createFromEntry(nullptr, 0, fileId, entry, &hit);
+	ASSERT_TRUE(hit);
+	ASSERT_TRUE(indexed != nullptr);
+	ASSERT_TRUE(indexed->isValid());
+
+	EXPECT_STREQ(romData->className(), indexed->className());
+	EXPECT_STREQ(romData->mimeType(), indexed->mimeType());
+	EXPECT_EQ(romData->fileType(), indexed->fileType());
+	for (unsigned int region = 0; region < 2; region++) {
+		for (unsigned int type = 0; type < 3; type++) {
+			const unsigned int sysNameType = type | (region ? RomData::SYSNAME_REGION_ROM_LOCAL : 0);
+			EXPECT_STREQ(romData->systemName(sysNameType), indexed->systemName(sysNameType));
+		}
+	}
+	EXPECT_EQ(romData->supportedImageTypes(), indexed->supportedImageTypes());
+	EXPECT_EQ(romData->hasDangerousPermissions(), indexed->hasDangerousPermissions());
+
+	compareFields(romData->fields(), indexed->fields());
+	compareMetaData(romData->metaData(), indexed->metaData());
+
+	indexed->unref();
+}
+
+/**
+ * Save and load an entry with no fields or metadata.
+ */
+TEST_F(RomDataIndexTest, roundTripEmpty)
+{
+	RomData *const emptyRomData = new TestRomData(nullptr, true);
+	RomDataIndexPrivate::serializeEntry(entry, fileId, 0, emptyRomData);
+
+	bool hit = false;
+	RomData *const indexed = RomDataIndexPrivate::createFromEntry(nullptr, 0, fileId, entry, &hit);
+	ASSERT_TRUE(hit);
+	ASSERT_TRUE(indexed != nullptr);
+	const RomFields *const fields = indexed->fields();
+	ASSERT_TRUE(fields != nullptr);
+	EXPECT_EQ(0, fields->count());
+	const RomMetaData *const metaData = indexed->metaData();
+	if (metaData) {
+		EXPECT_EQ(0, metaData->count());
+	}
+
+	indexed->unref();
+	emptyRomData->unref();
+}
+
+/**
+ * Save and load an entry using the index files.
+ */
+TEST_F(RomDataIndexTest, saveAndLoad)
+{
+	const string entryFilename = tmp_dir + "index" + DIR_SEP_CHR + "saveAndLoad.rpidx";
+	ASSERT_EQ(0, RomDataIndexPrivate::saveEntry(entryFilename, entry));
+
+	vector<uint8_t> loaded;
+	ASSERT_EQ(0, RomDataIndexPrivate::loadEntry(entryFilename, loaded));
+	EXPECT_EQ(entry, loaded);
+
+	bool hit = false;
+	RomData *const indexed = RomDataIndexPrivate::createFromEntry(nullptr, 0, fileId, loaded, &hit);
+	ASSERT_TRUE(hit);
+	ASSERT_TRUE(indexed != nullptr);
+	compareFields(romData->fields(), indexed->fields());
+	compareMetaData(romData->metaData(), indexed->metaData());
+	indexed->unref();
+
+	// Missing entry.
+	EXPECT_NE(0, RomDataIndexPrivate::loadEntry(tmp_dir + "index" + DIR_SEP_CHR + "missing.rpidx", loaded));
+
+	// Empty entry.
+	ASSERT_EQ(0, RomDataIndexPrivate::saveEntry(entryFilename, vector<uint8_t>()));
+	EXPECT_NE(0, RomDataIndexPrivate::loadEntry(entryFilename, loaded));
+	FileSystem::delete_file(entryFilename);
+}
+
+/**
+ * "Not supported" entries are index hits, too.
+ */
+TEST_F(RomDataIndexTest, notSupported)
+{
+	vector<uint8_t> buf;
+	RomDataIndexPrivate::serializeEntry(buf, fileId, 0, nullptr);
+
+	bool hit = false;
+	RomData *const indexed = RomDataIndexPrivate::createFromEntry(nullptr, 0, fileId, buf, &hit);
+	EXPECT_TRUE(hit);
+	EXPECT_TRUE(indexed == nullptr);
+	UNREF(indexed);
+}
+
+/**
+ * The entry must be invalidated if the file's identity changes.
+ */
+TEST_F(RomDataIndexTest, invalidateFileIdentity)
+{
+	bool hit = false;
+	EXPECT_TRUE(loadEntry(entry, &hit));
+	EXPECT_TRUE(hit);
+
+	// Modification time
+	fileId.mtime++;
+	EXPECT_FALSE(loadEntry(entry, &hit));
+	EXPECT_FALSE(hit);
+	fileId.mtime--;
+
+	// File size
+	fileId.size--;
+	EXPECT_FALSE(loadEntry(entry, &hit));
+	EXPECT_FALSE(hit);
+	fileId.size++;
+
+	// Inode
+	fileId.ino ^= 1;
+	EXPECT_FALSE(loadEntry(entry, &hit));
+	EXPECT_FALSE(hit);
+	fileId.ino ^= 1;
+
+	// RomDataFactory attributes
+	vector<uint8_t> buf(entry);
+	RomData *const indexed = RomDataIndexPrivate::createFromEntry(nullptr, 1, fileId, buf, &hit);
+	EXPECT_FALSE(hit);
+	EXPECT_TRUE(indexed == nullptr);
+	UNREF(indexed);
+
+	EXPECT_TRUE(loadEntry(entry, &hit));
+	EXPECT_TRUE(hit);
+}
+
+/**
+ * The entry must be invalidated if the file's modification
+ * time changes on disk.
+ */
+TEST_F(RomDataIndexTest, invalidateFileMtime)
+{
+	// Create a file to index.
+	const string romFilename = tmp_dir + "rom.bin";
+	RpFile *const file = new RpFile(romFilename, RpFile::FM_CREATE_WRITE);
+	ASSERT_TRUE(file->isOpen());
+	static const char rom_data[] = "Not actually a ROM image.";
+	file->write(rom_data, sizeof(rom_data));
+	file->unref();
+	ASSERT_EQ(0, FileSystem::set_mtime(romFilename, 1500000000));
+
+	ASSERT_EQ(0, FileSystem::get_file_identity(romFilename, &fileId));
+	RomDataIndexPrivate::serializeEntry(entry, fileId, 0, romData);
+
+	bool hit = false;
+	EXPECT_TRUE(loadEntry(entry, &hit));
+	EXPECT_TRUE(hit);
+
+	// Change the mtime.
+	ASSERT_EQ(0, FileSystem::set_mtime(romFilename, 1500000001));
+	ASSERT_EQ(0, FileSystem::get_file_identity(romFilename, &fileId));
+	EXPECT_FALSE(loadEntry(entry, &hit));
+	EXPECT_FALSE(hit);
+
+	FileSystem::delete_file(romFilename);
+}
+
+/**
+ * The entry must be invalidated if the program version changes.
+ */
+TEST_F(RomDataIndexTest, invalidateVersion)
+{
+	// The version string is right after the magic number.
+	const string &version = RomDataIndexPrivate::programVersion();
+	const size_t versionPos = sizeof(RomDataIndexPrivate::entry_magic) + sizeof(uint32_t);
+	ASSERT_GT(entry.size(), versionPos + version.size());
+	ASSERT_EQ(0, memcmp(&entry[versionPos], version.data(), version.size()));
+
+	vector<uint8_t> buf(entry);
+	buf[versionPos + version.size() - 1] ^= 0x01;
+	bool hit = false;
+	EXPECT_FALSE(loadEntry(buf, &hit));
+	EXPECT_FALSE(hit);
+
+	// Incorrect magic number.
+	buf = entry;
+	buf[6] = '1';
+	EXPECT_FALSE(loadEntry(buf, &hit));
+	EXPECT_FALSE(hit);
+}
+
+#if defined(ENABLE_DECRYPTION) && !defined(_WIN32)
+/**
+ * The entry must be invalidated if keys.conf changes.
+ */
+TEST_F(RomDataIndexTest, invalidateKeysConf)
+{
+	const char *const keys_conf = KeyManager::instance()->filename();
+	ASSERT_TRUE(keys_conf != nullptr);
+	ASSERT_EQ(0, strncmp(keys_conf, tmp_dir.c_str(), tmp_dir.size()));
+
+	time_t mtime = 0;
+	ASSERT_EQ(0, FileSystem::get_mtime(keys_conf, &mtime));
+	EXPECT_EQ(mtime, RomDataIndexPrivate::keysMtime());
+	RomDataIndexPrivate::serializeEntry(entry, fileId, 0, romData);
+
+	bool hit = false;
+	EXPECT_TRUE(loadEntry(entry, &hit));
+	EXPECT_TRUE(hit);
+
+	// Change keys.conf's mtime.
+	ASSERT_EQ(0, FileSystem::set_mtime(keys_conf, mtime + 60));
+	EXPECT_FALSE(loadEntry(entry, &hit));
+	EXPECT_FALSE(hit);
+
+	// Restore keys.conf's mtime.
+	ASSERT_EQ(0, FileSystem::set_mtime(keys_conf, mtime));
+	EXPECT_TRUE(loadEntry(entry, &hit));
+	EXPECT_TRUE(hit);
+}
+#endif /* ENABLE_DECRYPTION && !_WIN32 */
+
+/**
+ * Truncated entries must be a clean miss.
+ */
+TEST_F(RomDataIndexTest, truncatedEntry)
+{
+	for (size_t size = 0; size < entry.size(); size++) {
+		vector<uint8_t> buf(entry.cbegin(), entry.cbegin() + size);
+		bool hit = true;
+		EXPECT_FALSE(loadEntry(buf, &hit)) << "size: " << size;
+		EXPECT_FALSE(hit) << "size: " << size;
+	}
+
+	// Truncated entry file.
+	const string entryFilename = tmp_dir + "index" + DIR_SEP_CHR + "truncated.rpidx";
+	vector<uint8_t> buf(entry.cbegin(), entry.cbegin() + entry.size() / 2);
+	ASSERT_EQ(0, RomDataIndexPrivate::saveEntry(entryFilename, buf));
+	ASSERT_EQ(0, RomDataIndexPrivate::loadEntry(entryFilename, buf));
+	bool hit = true;
+	EXPECT_FALSE(loadEntry(buf, &hit));
+	EXPECT_FALSE(hit);
+	FileSystem::delete_file(entryFilename);
+}
+
+/**
+ * Corrupted entries must not crash.
+ * Every bit in the entry is flipped, one at a time.
+ */
+TEST_F(RomDataIndexTest, corruptedEntry)
+{
+	vector<uint8_t> buf(entry);
+	for (size_t i = 0; i < buf.size(); i++) {
+		for (unsigned int bit = 0; bit < 8; bit++) {
+			buf[i] ^= (1U << bit);
+			bool hit = false;
+			loadEntry(buf, &hit);
+			buf[i] ^= (1U << bit);
+		}
+	}
+
+	// Overwrite everything after the header with garbage.
+	vector<uint8_t> nsbuf;
+	RomDataIndexPrivate::serializeEntry(nsbuf, fileId, 0, nullptr);
+	const size_t headerSize = nsbuf.size();
+	ASSERT_LT(headerSize, buf.size());
+	for (unsigned int fill = 0; fill < 256; fill += 0x11) {
+		memset(&buf[headerSize], fill, buf.size() - headerSize);
+		bool hit = false;
+		loadEntry(buf, &hit);
+	}
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRomData test suite: RomDataIndex tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -82,15 +82,18 @@ struct ImageDecoderTest_mode
 	string dds_gz_filename;
 	string png_filename;
 	RomData::ImageType imgType;
+	int reqSize;	// Requested size for imageForSize(). (0 for the full image)
 
 	ImageDecoderTest_mode(
 		const char *dds_gz_filename,
 		const char *png_filename,
-		RomData::ImageType imgType = RomData::IMG_INT_IMAGE
+		RomData::ImageType imgType = RomData::IMG_INT_IMAGE,
+		int reqSize = 0
 		)
 		: dds_gz_filename(dds_gz_filename)
 		, png_filename(png_filename)
 		, imgType(imgType)
+		, reqSize(reqSize)
 	{ }
 
 	// May be required for MSVC 2010?
@@ -98,6 +101,7 @@ struct ImageDecoderTest_mode
 		: dds_gz_filename(other.dds_gz_filename)
 		, png_filename(other.png_filename)
 		, imgType(other.imgType)
+		, reqSize(other.reqSize)
 	{ }
 
 	// Required for MSVC 2010.
@@ -106,6 +110,7 @@ struct ImageDecoderTest_mode
 		dds_gz_filename = other.dds_gz_filename;
 		png_filename = other.png_filename;
 		imgType = other.imgType;
+		reqSize = other.reqSize;
 		return *this;
 	}
 };
@@ -485,14 +490,31 @@ void ImageDecoderTest::decodeTest_internal(void)
 	ASSERT_TRUE(m_romData->isOpen()) << "Could not load the " << filetype << " image.";
 
 	// Get the DDS image as an rp_image.
-	const rp_image *const img_dds = m_romData->image(mode.imgType);
+	// If a size is requested, imageForSize() should decode
+	// only the smallest mipmap that's at least that size.
+	int fullSize[2] = {0, 0};
+	const rp_image *const img_dds = (mode.reqSize > 0
+		? m_romData->imageForSize(mode.imgType, mode.reqSize, fullSize)
+		: m_romData->image(mode.imgType));
 	ASSERT_TRUE(img_dds != nullptr) << "Could not load the " << filetype << " image as rp_image.";
 
 	// Get the image again.
 	// The pointer should be identical to the first one.
-	const rp_image *const img_dds_2 = m_romData->image(mode.imgType);
+	const rp_image *const img_dds_2 = (mode.reqSize > 0
+		? m_romData->imageForSize(mode.imgType, mode.reqSize)
+		: m_romData->image(mode.imgType));
 	EXPECT_EQ(img_dds, img_dds_2) << "Retrieving the image twice resulted in a different rp_image object.";
 
+	if (mode.reqSize > 0) {
+		// The full-size image's dimensions should be returned,
+		// not the mipmap's dimensions.
+		const rp_image *const img_full = m_romData->image(mode.imgType);
+		ASSERT_TRUE(img_full != nullptr) << "Could not load the full " << filetype << " image as rp_image.";
+		EXPECT_EQ(img_full->width(), fullSize[0]);
+		EXPECT_EQ(img_full->height(), fullSize[1]);
+		EXPECT_NE(img_full, img_dds) << "imageForSize() returned the full image instead of a mipmap.";
+	}
+
 	// Compare the image data.
 	ASSERT_NO_FATAL_FAILURE(Compare_RpImage(img_png.get(), img_dds));
 }
@@ -667,6 +689,13 @@ string ImageDecoderTest::test_case_suffix_generator(const ::testing::TestParamIn
 		suffix += s_imgType[info.param.imgType - RomData::IMG_INT_MIN];
 	}
 
+	// Append the requested size for imageForSize() tests.
+	if (info.param.reqSize > 0) {
+		char buf[16];
+		snprintf(buf, sizeof(buf), "_%d", info.param.reqSize);
+		suffix += buf;
+	}
+
 	// TODO: Convert to ASCII?
 	return suffix;
 }
@@ -711,6 +740,26 @@ INSTANTIATE_TEST_SUITE_P(DDS_S3TC, ImageDecoderTest,
 			"S3TC/bc5.s3tc.png"))
 	, ImageDecoderTest::test_case_suffix_generator);
 
+// DirectDrawSurface tests. (Mipmaps)
+// ARGB4444-mipmap.dds is 512x512 with a full mipmap chain.
+// Mipmap 1 is ARGB4444.dds; mipmap 0 is a 2x nearest-neighbor
+// upscale, and the other mipmaps use a 2x2 box filter.
+INSTANTIATE_TEST_SUITE_P(DDS_Mipmap, ImageDecoderTest,
+	::testing::Values(
+		ImageDecoderTest_mode(
+			"ARGB/ARGB4444-mipmap.dds.gz",
+			"ARGB/ARGB4444.png",
+			RomData::IMG_INT_IMAGE, 256),
+		ImageDecoderTest_mode(
+			"ARGB/ARGB4444-mipmap.dds.gz",
+			"ARGB/ARGB4444.png",
+			RomData::IMG_INT_IMAGE, 200),
+		ImageDecoderTest_mode(
+			"ARGB/ARGB4444-mipmap.dds.gz",
+			"ARGB/ARGB4444-mipmap.mip2.png",
+			RomData::IMG_INT_IMAGE, 128))
+	, ImageDecoderTest::test_case_suffix_generator);
+
 // DirectDrawSurface tests. (Uncompressed 16-bit RGB)
 INSTANTIATE_TEST_SUITE_P(DDS_RGB16, ImageDecoderTest,
 	::testing::Values(
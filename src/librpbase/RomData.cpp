@@ -15,6 +15,12 @@
 // libcachecommon
 #include "libcachecommon/CacheKeys.hpp"
 
+// librpthreads
+#include "librpthreads/Atomics.h"
+#include "librpthreads/Mutex.hpp"
+using LibRpThreads::Mutex;
+using LibRpThreads::MutexLocker;
+
 // C++ STL classes.
 using std::string;
 using std::vector;
@@ -39,9 +45,14 @@ RomDataPrivate::RomDataPrivate(RomData *q, IRpFile *file)
 	: q_ptr(q)
 	, isValid(false)
 	, isCompressed(false)
+	, metaDataOnly(false)
 	, file(nullptr)
 	, fields(new RomFields())
 	, metaData(nullptr)
+	, loadMutex(new Mutex())
+	, loadState(0)
+	, fieldsRet(0)
+	, metaDataRet(0)
 	, className(nullptr)
 	, mimeType(nullptr)
 	, fileType(RomData::FileType::ROM_Image)
@@ -49,6 +60,8 @@ RomDataPrivate::RomDataPrivate(RomData *q, IRpFile *file)
 	// Initialize i18n.
 	rp_i18n_init();
 
+	memset(images, 0, sizeof(images));
+
 	if (file) {
 		// Reference the file.
 		this->file = file->ref();
@@ -61,6 +74,7 @@ RomDataPrivate::~RomDataPrivate()
 {
 	delete fields;
 	delete metaData;
+	delete loadMutex;
 
 	// Unreference the file.
 	UNREF(this->file);
@@ -557,6 +571,31 @@ bool RomData::isCompressed(void) const
 	return d->isCompressed;
 }
 
+/**
+ * Enable metadata-only mode.
+ *
+ * In metadata-only mode, fields() and image() always return nullptr
+ * without loading anything, and subclasses may skip work that's only
+ * needed for fields and images, e.g. opening secondary files.
+ *
+ * This must be called before fields(), metaData(), or image().
+ */
+void RomData::setMetaDataOnly(void)
+{
+	RP_D(RomData);
+	d->metaDataOnly = true;
+}
+
+/**
+ * Is metadata-only mode enabled?
+ * @return True if enabled; false if not.
+ */
+bool RomData::isMetaDataOnly(void) const
+{
+	RP_D(const RomData);
+	return d->metaDataOnly;
+}
+
 /**
  * Get the class name for the user configuration.
  * @return Class name. (ASCII) (nullptr on error)
@@ -747,6 +786,31 @@ int RomData::loadInternalImage(ImageType imageType, const rp_image **pImage)
 	return -ENOENT;
 }
 
+/**
+ * Load an internal image for the specified thumbnail size.
+ * Called by RomData::imageForSize().
+ *
+ * Subclasses that have smaller versions of an image,
+ * e.g. texture mipmaps, should return the smallest one
+ * whose largest dimension is at least reqSize.
+ *
+ * @param imageType	[in] Image type to load.
+ * @param reqSize	[in] Requested image size.
+ * @param pImage	[out] Pointer to const rp_image* to store the image in.
+ * @param pFullSize	[out] Two-element array for the full-size image's [width, height].
+ * @return 0 on success; negative POSIX error code on error. (image() is used instead)
+ */
+int RomData::loadInternalImageForSize(ImageType imageType, int reqSize,
+	const rp_image **pImage, int pFullSize[2])
+{
+	// The base class doesn't have any smaller images.
+	RP_UNUSED(imageType);
+	RP_UNUSED(reqSize);
+	RP_UNUSED(pFullSize);
+	*pImage = nullptr;
+	return -ENOTSUP;
+}
+
 /**
  * Load metadata properties.
  * Called by RomData::metaData() if the field data hasn't been loaded yet.
@@ -760,36 +824,55 @@ int RomData::loadMetaData(void)
 
 /**
  * Get the ROM Fields object.
+ *
+ * The field data is loaded exactly once.
+ * This function is thread-safe.
+ *
  * @return ROM Fields object.
  */
 const RomFields *RomData::fields(void) const
 {
 	RP_D(const RomData);
-	if (d->fields->empty()) {
+	if (d->metaDataOnly) {
+		// Fields aren't loaded in metadata-only mode.
+		return nullptr;
+	}
+
+	RomDataPrivate *const d_nc = const_cast<RomDataPrivate*>(d);
+	if (!(ATOMIC_OR_FETCH(&d_nc->loadState, 0) & RomDataPrivate::LOAD_FIELDS)) {
 		// Data has not been loaded.
 		// Load it now.
-		int ret = const_cast<RomData*>(this)->loadFieldData();
-		if (ret < 0)
-			return nullptr;
+		MutexLocker locker(*d->loadMutex);
+		if (!(d->loadState & RomDataPrivate::LOAD_FIELDS)) {
+			d_nc->fieldsRet = const_cast<RomData*>(this)->loadFieldData();
+			ATOMIC_OR_FETCH(&d_nc->loadState, RomDataPrivate::LOAD_FIELDS);
+		}
 	}
-	return d->fields;
+	return (d->fieldsRet >= 0 ? d->fields : nullptr);
 }
 
 /**
  * Get the ROM Metadata object.
+ *
+ * The metadata is loaded exactly once.
+ * This function is thread-safe.
+ *
  * @return ROM Metadata object.
  */
 const RomMetaData *RomData::metaData(void) const
 {
 	RP_D(const RomData);
-	if (!d->metaData || d->metaData->empty()) {
+	RomDataPrivate *const d_nc = const_cast<RomDataPrivate*>(d);
+	if (!(ATOMIC_OR_FETCH(&d_nc->loadState, 0) & RomDataPrivate::LOAD_METADATA)) {
 		// Data has not been loaded.
 		// Load it now.
-		int ret = const_cast<RomData*>(this)->loadMetaData();
-		if (ret < 0)
-			return nullptr;
+		MutexLocker locker(*d->loadMutex);
+		if (!(d->loadState & RomDataPrivate::LOAD_METADATA)) {
+			d_nc->metaDataRet = const_cast<RomData*>(this)->loadMetaData();
+			ATOMIC_OR_FETCH(&d_nc->loadState, RomDataPrivate::LOAD_METADATA);
+		}
 	}
-	return d->metaData;
+	return (d->metaDataRet >= 0 ? d->metaData : nullptr);
 }
 
 /**
@@ -798,6 +881,9 @@ const RomMetaData *RomData::metaData(void) const
  * The retrieved image must be ref()'d by the caller if the
  * caller stores it instead of using it immediately.
  *
+ * Each image type is loaded exactly once.
+ * This function is thread-safe.
+ *
  * @param imageType Image type to load.
  * @return Internal image, or nullptr if the ROM doesn't have one.
  */
@@ -810,6 +896,25 @@ const rp_image *RomData::image(ImageType imageType) const
 	}
 	// TODO: Check supportedImageTypes()?
 
+	RP_D(const RomData);
+	if (d->metaDataOnly) {
+		// Images aren't loaded in metadata-only mode.
+		return nullptr;
+	}
+
+	RomDataPrivate *const d_nc = const_cast<RomDataPrivate*>(d);
+	const uint32_t loadBit = (RomDataPrivate::LOAD_IMAGE_BASE << imageType);
+	if (ATOMIC_OR_FETCH(&d_nc->loadState, 0) & loadBit) {
+		// Image has already been loaded.
+		return d->images[imageType];
+	}
+
+	MutexLocker locker(*d->loadMutex);
+	if (d->loadState & loadBit) {
+		// Image was loaded by another thread.
+		return d->images[imageType];
+	}
+
 	// Load the internal image.
 	// The subclass maintains ownership of the image.
 #ifdef _DEBUG
@@ -829,7 +934,71 @@ const rp_image *RomData::image(ImageType imageType) const
 	// SANITY CHECK: `img` must not be -1LL.
 	assert(img != INVALID_IMG_PTR);
 
-	return (ret == 0 ? img : nullptr);
+	d_nc->images[imageType] = (ret == 0 ? img : nullptr);
+	ATOMIC_OR_FETCH(&d_nc->loadState, loadBit);
+	return d->images[imageType];
+}
+
+/**
+ * Get an internal image from the ROM for the specified thumbnail size.
+ *
+ * If the subclass has smaller versions of the image,
+ * e.g. texture mipmaps, this returns the smallest one
+ * whose largest dimension is at least reqSize, so the
+ * full-size image doesn't need to be decoded.
+ * Otherwise, this is the same as image().
+ *
+ * The retrieved image must be ref()'d by the caller if the
+ * caller stores it instead of using it immediately.
+ *
+ * This function is thread-safe.
+ *
+ * @param imageType	[in] Image type to load.
+ * @param reqSize	[in] Requested image size. (0 for the full-size image)
+ * @param pFullSize	[out,opt] Two-element array for the full-size image's [width, height].
+ * @return Internal image, or nullptr if the ROM doesn't have one or in metadata-only mode.
+ */
+const rp_image *RomData::imageForSize(ImageType imageType, int reqSize, int pFullSize[2]) const
+{
+	assert(imageType >= IMG_INT_MIN && imageType <= IMG_INT_MAX);
+	if (imageType < IMG_INT_MIN || imageType > IMG_INT_MAX) {
+		// ImageType is out of range.
+		return nullptr;
+	}
+
+	RP_D(const RomData);
+	if (d->metaDataOnly) {
+		// Images aren't loaded in metadata-only mode.
+		return nullptr;
+	}
+
+	if (reqSize > 0) {
+		// Check if the subclass has a smaller image.
+		// The subclass maintains ownership of the image.
+		const rp_image *img = nullptr;
+		int fullSize[2] = {0, 0};
+		int ret;
+		{
+			MutexLocker locker(*d->loadMutex);
+			ret = const_cast<RomData*>(this)->loadInternalImageForSize(
+				imageType, reqSize, &img, fullSize);
+		}
+		if (ret == 0 && img != nullptr) {
+			if (pFullSize) {
+				pFullSize[0] = fullSize[0];
+				pFullSize[1] = fullSize[1];
+			}
+			return img;
+		}
+	}
+
+	// Use the full-size image.
+	const rp_image *const img = image(imageType);
+	if (img && pFullSize) {
+		pFullSize[0] = img->width();
+		pFullSize[1] = img->height();
+	}
+	return img;
 }
 
 /**
@@ -953,6 +1122,25 @@ bool RomData::hasDangerousPermissions(void) const
 	return false;
 }
 
+/**
+ * Get the decrypted and/or decompressed views of this ROM image's contents.
+ * This is used for hashing the contents, e.g. by rpcli.
+ *
+ * Only views whose data differs from the raw file are returned,
+ * e.g. decompressed disc images and decrypted partitions.
+ * Encrypted partitions that can't be decrypted are skipped.
+ *
+ * NOTE: The views share the ROM image's file handle,
+ * so they must not be read concurrently with this object.
+ *
+ * @return Content views. (empty if none are available)
+ */
+vector<RomData::ContentView> RomData::contentViews(void)
+{
+	// No content views by default.
+	return vector<ContentView>();
+}
+
 /**
  * Get the list of operations that can be performed on this ROM.
  * @return List of operations.
@@ -32,6 +32,7 @@ namespace LibRpBase {
 
 class RomFields;
 class RomMetaData;
+class IDiscReader;
 struct IconAnimData;
 
 class RomDataPrivate;
@@ -124,6 +125,23 @@ class RomData : public RefBase
 		 */
 		bool isCompressed(void) const;
 
+		/**
+		 * Enable metadata-only mode.
+		 *
+		 * In metadata-only mode, fields() and image() always return nullptr
+		 * without loading anything, and subclasses may skip work that's only
+		 * needed for fields and images, e.g. opening secondary files.
+		 *
+		 * This must be called before fields(), metaData(), or image().
+		 */
+		void setMetaDataOnly(void);
+
+		/**
+		 * Is metadata-only mode enabled?
+		 * @return True if enabled; false if not.
+		 */
+		bool isMetaDataOnly(void) const;
+
 	public:
 		/** ROM detection functions. **/
 
@@ -433,15 +451,47 @@ class RomData : public RefBase
 		 */
 		virtual int loadInternalImage(ImageType imageType, const LibRpTexture::rp_image **pImage);
 
+		/**
+		 * Load an internal image for the specified thumbnail size.
+		 * Called by RomData::imageForSize().
+		 *
+		 * Subclasses that have smaller versions of an image,
+		 * e.g. texture mipmaps, should return the smallest one
+		 * whose largest dimension is at least reqSize.
+		 *
+		 * @param imageType	[in] Image type to load.
+		 * @param reqSize	[in] Requested image size.
+		 * @param pImage	[out] Pointer to const rp_image* to store the image in.
+		 * @param pFullSize	[out] Two-element array for the full-size image's [width, height].
+		 * @return 0 on success; negative POSIX error code on error. (image() is used instead)
+		 */
+		virtual int loadInternalImageForSize(ImageType imageType, int reqSize,
+			const LibRpTexture::rp_image **pImage, int pFullSize[2]);
+
 	public:
+		/** Lazily-loaded data **/
+
+		// fields(), metaData(), and image() load their data on the
+		// first call and cache it. Each of these can be called
+		// concurrently from multiple threads on the same RomData
+		// object; loading is serialized internally, so loadFieldData(),
+		// loadMetaData(), and loadInternalImage() are only called once
+		// per object (or image type) and never at the same time.
+		//
+		// All other functions, including close(), doRomOp(), and
+		// iconAnimData(), are NOT thread-safe and must not be called
+		// while another thread is using the same RomData object.
+
 		/**
 		 * Get the ROM Fields object.
-		 * @return ROM Fields object.
+		 * This function is thread-safe.
+		 * @return ROM Fields object, or nullptr in metadata-only mode.
 		 */
 		const RomFields *fields(void) const;
 
 		/**
 		 * Get the ROM Metadata object.
+		 * This function is thread-safe.
 		 * @return ROM Metadata object.
 		 */
 		const RomMetaData *metaData(void) const;
@@ -461,11 +511,34 @@ class RomData : public RefBase
 		 * The retrieved image must be ref()'d by the caller if the
 		 * caller stores it instead of using it immediately.
 		 *
+		 * This function is thread-safe.
+		 *
 		 * @param imageType Image type to load.
-		 * @return Internal image, or nullptr if the ROM doesn't have one.
+		 * @return Internal image, or nullptr if the ROM doesn't have one or in metadata-only mode.
 		 */
 		const LibRpTexture::rp_image *image(ImageType imageType) const;
 
+		/**
+		 * Get an internal image from the ROM for the specified thumbnail size.
+		 *
+		 * If the subclass has smaller versions of the image,
+		 * e.g. texture mipmaps, this returns the smallest one
+		 * whose largest dimension is at least reqSize, so the
+		 * full-size image doesn't need to be decoded.
+		 * Otherwise, this is the same as image().
+		 *
+		 * The retrieved image must be ref()'d by the caller if the
+		 * caller stores it instead of using it immediately.
+		 *
+		 * This function is thread-safe.
+		 *
+		 * @param imageType	[in] Image type to load.
+		 * @param reqSize	[in] Requested image size. (0 for the full-size image)
+		 * @param pFullSize	[out,opt] Two-element array for the full-size image's [width, height].
+		 * @return Internal image, or nullptr if the ROM doesn't have one or in metadata-only mode.
+		 */
+		const LibRpTexture::rp_image *imageForSize(ImageType imageType, int reqSize, int pFullSize[2] = nullptr) const;
+
 		/**
 		 * External URLs for a media type.
 		 * Includes URL and "cache key" for local caching,
@@ -557,6 +630,31 @@ class RomData : public RefBase
 		 */
 		virtual bool hasDangerousPermissions(void) const;
 
+	public:
+		/**
+		 * Content view.
+		 * The IDiscReader is ref()'d and must be unref()'d by the caller.
+		 */
+		struct ContentView {
+			std::string name;		// View name, e.g. "Partition 0 (decrypted)" (localized)
+			IDiscReader *discReader;	// Decrypted and/or decompressed contents
+		};
+
+		/**
+		 * Get the decrypted and/or decompressed views of this ROM image's contents.
+		 * This is used for hashing the contents, e.g. by rpcli.
+		 *
+		 * Only views whose data differs from the raw file are returned,
+		 * e.g. decompressed disc images and decrypted partitions.
+		 * Encrypted partitions that can't be decrypted are skipped.
+		 *
+		 * NOTE: The views share the ROM image's file handle,
+		 * so they must not be read concurrently with this object.
+		 *
+		 * @return Content views. (empty if none are available)
+		 */
+		virtual std::vector<ContentView> contentViews(void);
+
 	public:
 		/**
 		 * ROF_SAVE_FILE information.
@@ -289,6 +289,17 @@ class klass final : public LibRpBase::RomData { \
 		 */ \
 		int checkViewedAchievements(void) const final;
 
+/**
+ * RomData subclass function declaration for content views.
+ */
+#define ROMDATA_DECL_CONTENT_VIEWS() \
+	public: \
+		/** \
+		 * Get the decrypted and/or decompressed views of this ROM image's contents. \
+		 * @return Content views. (empty if none are available) \
+		 */ \
+		std::vector<ContentView> contentViews(void) final;
+
 /**
  * RomData subclass function declaration for closing the internal file handle.
  * Only needed if extra handling is needed, e.g. if multiple files are opened.
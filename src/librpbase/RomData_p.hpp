@@ -27,6 +27,9 @@ namespace LibRpFile {
 namespace LibRpTexture {
 	class rp_image;
 }
+namespace LibRpThreads {
+	class Mutex;
+}
 
 namespace LibRpBase {
 
@@ -55,11 +58,32 @@ class RomDataPrivate
 	public:
 		bool isValid;			// Subclass must set this to true if the ROM is valid.
 		bool isCompressed;		// True if the file is compressed. (transparent decompression)
+		bool metaDataOnly;		// True if only metadata will be loaded. (see RomData::setMetaDataOnly())
 		LibRpFile::IRpFile *file;	// Open file.
 		std::string filename;		// Copy of the filename.
 		RomFields *const fields;	// ROM fields. (NOTE: allocated by the base class)
 		RomMetaData *metaData;		// ROM metadata. (NOTE: nullptr initially.)
 
+	public:
+		/** Lazy loading state. **/
+
+		// Lazily-loaded artifacts.
+		// Each artifact is loaded exactly once by fields(), metaData(),
+		// or image(); the result is cached for subsequent calls.
+		enum LoadState_e : uint32_t {
+			LOAD_FIELDS	= (1U << 0),	// loadFieldData()
+			LOAD_METADATA	= (1U << 1),	// loadMetaData()
+			LOAD_IMAGE_BASE	= (1U << 2),	// loadInternalImage(); shifted by ImageType
+		};
+
+		// All loaders are serialized by loadMutex, since they
+		// share the file position and subclass private data.
+		LibRpThreads::Mutex *const loadMutex;
+		volatile uint32_t loadState;	// Bitfield of loaded artifacts. (LoadState_e)
+		int fieldsRet;			// loadFieldData() return value.
+		int metaDataRet;		// loadMetaData() return value.
+		const LibRpTexture::rp_image *images[RomData::IMG_INT_MAX+1];	// Internal images.
+
 	public:
 		/** These fields must be set by RomData subclasses in their constructors. **/
 		const char *className;		// Class name for user configuration. (ASCII) (default is nullptr)
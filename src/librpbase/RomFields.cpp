@@ -47,11 +47,25 @@ class RomFieldsPrivate
 		// and/or addField_listData with RFT_LISTDATA_MULTI.
 		uint32_t def_lc;
 
+		// String arena for RFT_STRING and RFT_LISTDATA.
+		// RomData subclasses can add hundreds of strings, so they're
+		// stored in large blocks instead of individual std::strings.
+		StringArena strArena;
+
 		/**
 		 * Delete allocated objects in this->fields.
 		 * The vector will be cleared afterwards.
 		 */
 		void delete_data(void);
+
+		/**
+		 * Copy list data into the string arena.
+		 * @tparam T ListData_t or ListDataView_t
+		 * @param list_view	[out] Destination ListDataView_t.
+		 * @param list_data	[in] Source list data.
+		 */
+		template<typename T>
+		void listDataToArena(RomFields::ListDataView_t &list_view, const T &list_data);
 };
 
 /** RomFieldsPrivate **/
@@ -66,6 +80,27 @@ RomFieldsPrivate::~RomFieldsPrivate()
 	delete_data();
 }
 
+/**
+ * Copy list data into the string arena.
+ * @tparam T ListData_t or ListDataView_t
+ * @param list_view	[out] Destination ListDataView_t.
+ * @param list_data	[in] Source list data.
+ */
+template<typename T>
+void RomFieldsPrivate::listDataToArena(RomFields::ListDataView_t &list_view, const T &list_data)
+{
+	list_view.resize(list_data.size());
+	auto dest_iter = list_view.begin();
+	for (const auto &src_row : list_data) {
+		RomFields::ListDataRow_t &dest_row = *dest_iter;
+		dest_row.reserve(src_row.size());
+		for (const auto &str : src_row) {
+			dest_row.emplace_back(strArena.add(str.data(), str.size()));
+		}
+		++dest_iter;
+	}
+}
+
 /**
  * Delete allocated objects in this->fields.
  * The vector will be cleared afterwards.
@@ -88,7 +123,7 @@ void RomFieldsPrivate::delete_data(void)
 					break;
 
 				case RomFields::RFT_STRING:
-					delete const_cast<string*>(field.data.str);
+					// Stored in the string arena.
 					break;
 				case RomFields::RFT_BITFIELD:
 					delete const_cast<vector<string>*>(field.desc.bitfield.names);
@@ -96,9 +131,9 @@ void RomFieldsPrivate::delete_data(void)
 				case RomFields::RFT_LISTDATA:
 					delete const_cast<vector<string>*>(field.desc.list_data.names);
 					if (field.desc.list_data.flags & RomFields::RFT_LISTDATA_MULTI) {
-						delete const_cast<RomFields::ListDataMultiMap_t*>(field.data.list_data.data.multi);
+						delete const_cast<RomFields::ListDataViewMultiMap_t*>(field.data.list_data.data.multi);
 					} else {
-						delete const_cast<RomFields::ListData_t*>(field.data.list_data.data.single);
+						delete const_cast<RomFields::ListDataView_t*>(field.data.list_data.data.single);
 					}
 					if (field.desc.list_data.flags & RomFields::RFT_LISTDATA_ICONS) {
 						delete const_cast<RomFields::ListDataIcons_t*>(field.data.list_data.mxd.icons);
@@ -118,8 +153,9 @@ void RomFieldsPrivate::delete_data(void)
 		}
 	);
 
-	// Clear the fields vector.
+	// Clear the fields vector and the string arena.
 	this->fields.clear();
+	strArena.clear();
 }
 
 /** RomFields **/
@@ -391,13 +427,13 @@ const string *RomFields::getFromStringMulti(const StringMultiMap_t *pStr_multi,
 }
 
 /**
- * Get ListData_t from an RFT_LISTDATA_MULTI field.
- * @param pListData_multi ListDataMultiMap_t*
+ * Get ListDataView_t from an RFT_LISTDATA_MULTI field.
+ * @param pListData_multi ListDataViewMultiMap_t*
  * @param def_lc Default language code.
  * @param user_lc User-specified language code.
- * @return Pointer to ListData_t, or nullptr if not found.
+ * @return Pointer to ListDataView_t, or nullptr if not found.
  */
-const RomFields::ListData_t *RomFields::getFromListDataMulti(const ListDataMultiMap_t *pListData_multi, uint32_t def_lc, uint32_t user_lc)
+const RomFields::ListDataView_t *RomFields::getFromListDataMulti(const ListDataViewMultiMap_t *pListData_multi, uint32_t def_lc, uint32_t user_lc)
 {
 	assert(pListData_multi != nullptr);
 	assert(!pListData_multi->empty());
@@ -736,7 +772,9 @@ int RomFields::addFields_romFields(const RomFields *other, int tabOffset)
 				break;
 
 			case RFT_STRING:
-				field_dest.data.str = (field_src.data.str ? new string(*field_src.data.str) : nullptr);
+				// NOTE: The string must be copied into our own arena,
+				// since the other RomFields object might be deleted first.
+				field_dest.data.str = d->strArena.add(field_src.data.str.ptr, field_src.data.str.len);
 				break;
 			case RFT_BITFIELD:
 				field_dest.desc.bitfield.elemsPerRow = field_src.desc.bitfield.elemsPerRow;
@@ -755,14 +793,26 @@ int RomFields::addFields_romFields(const RomFields *other, int tabOffset)
 						: nullptr);
 				field_dest.desc.list_data.col_attrs =
 					field_src.desc.list_data.col_attrs;
+				// NOTE: The strings must be copied into our own arena,
+				// since the other RomFields object might be deleted first.
 				if (field_src.desc.list_data.flags & RFT_LISTDATA_MULTI) {
-					field_dest.data.list_data.data.multi = (field_src.data.list_data.data.multi
-						? new ListDataMultiMap_t(*(field_src.data.list_data.data.multi))
-						: nullptr);
+					const ListDataViewMultiMap_t *const src_multi = field_src.data.list_data.data.multi;
+					ListDataViewMultiMap_t *dest_multi = nullptr;
+					if (src_multi) {
+						dest_multi = new ListDataViewMultiMap_t();
+						for (const auto &pld : *src_multi) {
+							d->listDataToArena((*dest_multi)[pld.first], pld.second);
+						}
+					}
+					field_dest.data.list_data.data.multi = dest_multi;
 				} else {
-					field_dest.data.list_data.data.single = (field_src.data.list_data.data.single
-						? new ListData_t(*(field_src.data.list_data.data.single))
-						: nullptr);
+					const ListDataView_t *const src_single = field_src.data.list_data.data.single;
+					ListDataView_t *dest_single = nullptr;
+					if (src_single) {
+						dest_single = new ListDataView_t();
+						d->listDataToArena(*dest_single, *src_single);
+					}
+					field_dest.data.list_data.data.single = dest_single;
 				}
 				if (field_src.desc.list_data.flags & RFT_LISTDATA_ICONS) {
 					// Icons: Copy the icon vector if set.
@@ -821,18 +871,18 @@ int RomFields::addField_string(const char *name, const char *str, unsigned int f
 	d->fields.resize(idx+1);
 	Field &field = d->fields.at(idx);
 
-	string *const nstr = (str ? new string(str) : nullptr);
+	size_t len = (str ? strlen(str) : 0);
+	// Handle string trimming flags.
+	if (str && (flags & STRF_TRIM_END)) {
+		len = trimEnd_len(str, len);
+	}
+
 	field.name = name;
 	field.type = RFT_STRING;
 	field.desc.flags = flags;
-	field.data.str = nstr;
+	field.data.str = d->strArena.add(str, len);
 	field.tabIdx = d->tabIdx;
 	field.isValid = (name != nullptr);
-
-	// Handle string trimming flags.
-	if (nstr && (flags & STRF_TRIM_END)) {
-		trimEnd(*nstr);
-	}
 	return static_cast<int>(idx);
 }
 
@@ -855,19 +905,51 @@ int RomFields::addField_string(const char *name, const string &str, unsigned int
 	d->fields.resize(idx+1);
 	Field &field = d->fields.at(idx);
 
-	string *const nstr = (!str.empty() ? new string(str) : nullptr);
 	field.name = name;
 	field.type = RFT_STRING;
 	field.desc.flags = flags;
-	field.data.str = nstr;
+	if (!str.empty()) {
+		size_t len = str.size();
+		// Handle string trimming flags.
+		if (flags & STRF_TRIM_END) {
+			len = trimEnd_len(str.data(), len);
+		}
+		field.data.str = d->strArena.add(str.data(), len);
+	} else {
+		field.data.str.clear();
+	}
 	field.tabIdx = d->tabIdx;
 	field.isValid = true;
+	return static_cast<int>(idx);
+}
+
+/**
+ * Change the string of an existing RFT_STRING field.
+ * NOTE: The old string isn't freed until the RomFields object is deleted.
+ * @param idx Field index.
+ * @param str New string.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RomFields::changeField_string(int idx, const char *str)
+{
+	RP_D(RomFields);
+	assert(idx >= 0);
+	assert(idx < static_cast<int>(d->fields.size()));
+	if (idx < 0 || idx >= static_cast<int>(d->fields.size()))
+		return -ERANGE;
 
+	Field &field = d->fields[idx];
+	assert(field.type == RFT_STRING);
+	if (field.type != RFT_STRING)
+		return -EINVAL;
+
+	size_t len = (str ? strlen(str) : 0);
 	// Handle string trimming flags.
-	if (nstr && (flags & STRF_TRIM_END)) {
-		trimEnd(*nstr);
+	if (str && (field.desc.flags & STRF_TRIM_END)) {
+		len = trimEnd_len(str, len);
 	}
-	return static_cast<int>(idx);
+	field.data.str = d->strArena.add(str, len);
+	return 0;
 }
 
 /**
@@ -1032,9 +1114,68 @@ int RomFields::addField_bitfield(const char *name,
 	return static_cast<int>(idx);
 }
 
+/** ListDataBuilder **/
+
+/**
+ * Initialize a ListDataBuilder.
+ * @param fields RomFields object that will own the list data.
+ * @param rows Number of rows to reserve. (0 if unknown)
+ * @param cols Number of columns per row. (0 if unknown)
+ */
+RomFields::ListDataBuilder::ListDataBuilder(RomFields *fields, size_t rows, size_t cols)
+	: m_fields(fields)
+	, m_cols(cols)
+{
+	assert(fields != nullptr);
+	if (rows > 0) {
+		m_view.reserve(rows);
+	}
+}
+
+/**
+ * Start a new row.
+ * Subsequent calls to add() will append to this row.
+ */
+void RomFields::ListDataBuilder::addRow(void)
+{
+	m_view.resize(m_view.size()+1);
+	if (m_cols > 0) {
+		m_view.back().reserve(m_cols);
+	}
+}
+
+/**
+ * Append a string to the current row.
+ * If no row has been started, a new row is started.
+ * @param str String.
+ * @param len Length of str, in bytes.
+ */
+void RomFields::ListDataBuilder::add(const char *str, size_t len)
+{
+	if (m_view.empty()) {
+		addRow();
+	}
+	m_view.back().emplace_back(m_fields->d_ptr->strArena.add(str, len));
+}
+
+/**
+ * Release the list data.
+ * The builder will be empty afterwards.
+ * @return ListDataView_t
+ */
+RomFields::ListDataView_t RomFields::ListDataBuilder::release(void)
+{
+	ListDataView_t view(std::move(m_view));
+	m_view.clear();
+	return view;
+}
+
 /**
  * Add ListData.
  * NOTE: This object takes ownership of the vectors.
+ * If params->view is set, the ListDataBuilder rows are used as-is.
+ * Otherwise, the ListData_t strings are copied into the string
+ * arena, and the ListData_t vectors are deleted immediately.
  * @param name Field name.
  * @param params Parameters.
  *
@@ -1083,14 +1224,46 @@ int RomFields::addField_listData(const char *name, const AFLD_PARAMS *params)
 	field.desc.list_data.names = params->headers;
 	field.desc.list_data.col_attrs = params->col_attrs;
 
+	// If the list data was built using ListDataBuilder, the strings
+	// are already in the string arena. Otherwise, copy the strings
+	// into the string arena; the ListData_t vectors are no longer
+	// needed afterwards.
 	if (flags & RFT_LISTDATA_MULTI) {
-		field.data.list_data.data.multi = params->data.multi;
+		ListDataViewMultiMap_t *multi = nullptr;
+		if (params->view.multi) {
+			multi = const_cast<ListDataViewMultiMap_t*>(params->view.multi);
+			if (params->data.multi) {
+				// Can't use both.
+				assert(!"params->data and params->view are both set.");
+				delete params->data.multi;
+			}
+		} else if (params->data.multi) {
+			multi = new ListDataViewMultiMap_t();
+			for (const auto &pld : *(params->data.multi)) {
+				d->listDataToArena((*multi)[pld.first], pld.second);
+			}
+			delete params->data.multi;
+		}
+		field.data.list_data.data.multi = multi;
 		// Copy the default language code if it hasn't been set yet.
 		if (d->def_lc == 0) {
 			d->def_lc = params->def_lc;
 		}
 	} else {
-		field.data.list_data.data.single = params->data.single;
+		ListDataView_t *single = nullptr;
+		if (params->view.single) {
+			single = const_cast<ListDataView_t*>(params->view.single);
+			if (params->data.single) {
+				// Can't use both.
+				assert(!"params->data and params->view are both set.");
+				delete params->data.single;
+			}
+		} else if (params->data.single) {
+			single = new ListDataView_t();
+			d->listDataToArena(*single, *(params->data.single));
+			delete params->data.single;
+		}
+		field.data.list_data.data.single = single;
 	}
 
 	if (flags & RFT_LISTDATA_CHECKBOXES) {
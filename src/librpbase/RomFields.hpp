@@ -24,6 +24,9 @@
 #include <string>
 #include <vector>
 
+// String arena
+#include "StringArena.hpp"
+
 namespace LibRpTexture {
 	class rp_image;
 }
@@ -241,6 +244,14 @@ class RomFields
 		typedef std::map<uint32_t, ListData_t> ListDataMultiMap_t;
 		typedef std::vector<const LibRpTexture::rp_image*> ListDataIcons_t;
 
+		// RFT_LISTDATA storage.
+		// The strings are stored in the RomFields string arena,
+		// so the rows are StrViews instead of individually-allocated
+		// strings. Use ListDataBuilder to build these directly.
+		typedef std::vector<StrView> ListDataRow_t;
+		typedef std::vector<ListDataRow_t> ListDataView_t;
+		typedef std::map<uint32_t, ListDataView_t> ListDataViewMultiMap_t;
+
 		// ROM field struct.
 		// Dynamically allocated.
 		struct Field {
@@ -285,7 +296,8 @@ class RomFields
 				uint64_t generic;
 
 				// RFT_STRING
-				const std::string *str;
+				// Stored in the RomFields string arena.
+				StrView str;
 
 				// RFT_BITFIELD
 				uint32_t bitfield;
@@ -294,12 +306,14 @@ class RomFields
 				struct {
 					union {
 						// Standard RFT_LISTDATA
-						const ListData_t *single;
+						// Strings are stored in the RomFields string arena.
+						const ListDataView_t *single;
 
 						// RFT_LISTDATA_MULTI
 						// - Key: Language code
 						// - Value: Vector of rows.
-						const ListDataMultiMap_t *multi;
+						// Strings are stored in the RomFields string arena.
+						const ListDataViewMultiMap_t *multi;
 					} data;
 
 					union {
@@ -426,13 +440,13 @@ class RomFields
 		static const std::string *getFromStringMulti(const StringMultiMap_t *pStr_multi, uint32_t def_lc, uint32_t user_lc);
 
 		/**
-		 * Get ListData_t from an RFT_LISTDATA_MULTI field.
-		 * @param pListData_multi ListDataMultiMap_t*
+		 * Get ListDataView_t from an RFT_LISTDATA_MULTI field.
+		 * @param pListData_multi ListDataViewMultiMap_t*
 		 * @param def_lc Default language code.
 		 * @param user_lc User-specified language code.
-		 * @return Pointer to ListData_t, or nullptr if not found.
+		 * @return Pointer to ListDataView_t, or nullptr if not found.
 		 */
-		static const ListData_t *getFromListDataMulti(const ListDataMultiMap_t *pListData_multi, uint32_t def_lc, uint32_t user_lc);
+		static const ListDataView_t *getFromListDataMulti(const ListDataViewMultiMap_t *pListData_multi, uint32_t def_lc, uint32_t user_lc);
 
 	public:
 		/** Convenience functions for RomData subclasses. **/
@@ -548,6 +562,15 @@ class RomFields
 		 */
 		int addField_string(const char *name, const std::string &str, unsigned int flags = 0);
 
+		/**
+		 * Change the string of an existing RFT_STRING field.
+		 * NOTE: The old string isn't freed until the RomFields object is deleted.
+		 * @param idx Field index.
+		 * @param str New string.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int changeField_string(int idx, const char *str);
+
 		enum class Base {
 			Dec,	// Decimal (Base 10)
 			Hex,	// Hexadecimal (Base 16)
@@ -618,6 +641,89 @@ class RomFields
 			const std::vector<std::string> *bit_names,
 			int elemsPerRow, uint32_t bitfield);
 
+		/**
+		 * RFT_LISTDATA builder.
+		 *
+		 * Strings are copied directly into this RomFields object's
+		 * string arena and appended to the rows as StrViews, so no
+		 * intermediate ListData_t is needed.
+		 *
+		 * NOTE: The finished rows reference this RomFields object's
+		 * string arena, so they must be added to the same object
+		 * using AFLD_PARAMS::view.
+		 */
+		class ListDataBuilder {
+			public:
+				/**
+				 * Initialize a ListDataBuilder.
+				 * @param fields RomFields object that will own the list data.
+				 * @param rows Number of rows to reserve. (0 if unknown)
+				 * @param cols Number of columns per row. (0 if unknown)
+				 */
+				explicit ListDataBuilder(RomFields *fields, size_t rows = 0, size_t cols = 0);
+
+			private:
+				RP_DISABLE_COPY(ListDataBuilder)
+
+			public:
+				/**
+				 * Start a new row.
+				 * Subsequent calls to add() will append to this row.
+				 */
+				void addRow(void);
+
+				/**
+				 * Append a string to the current row.
+				 * If no row has been started, a new row is started.
+				 * @param str String.
+				 * @param len Length of str, in bytes.
+				 */
+				void add(const char *str, size_t len);
+
+				/**
+				 * Append a NUL-terminated string to the current row.
+				 * @param str String. (nullptr is treated as an empty string)
+				 */
+				inline void add(const char *str)
+				{
+					if (str) {
+						add(str, strlen(str));
+					} else {
+						add("", 0);
+					}
+				}
+
+				/**
+				 * Append a string to the current row.
+				 * @param str String.
+				 */
+				inline void add(const std::string &str)
+				{
+					add(str.data(), str.size());
+				}
+
+				/**
+				 * Get the number of rows.
+				 * @return Number of rows.
+				 */
+				inline size_t rowCount(void) const
+				{
+					return m_view.size();
+				}
+
+				/**
+				 * Release the list data.
+				 * The builder will be empty afterwards.
+				 * @return ListDataView_t
+				 */
+				ListDataView_t release(void);
+
+			private:
+				RomFields *const m_fields;
+				ListDataView_t m_view;
+				size_t m_cols;
+		};
+
 		/**
 		 * addField_listData() parameter struct.
 		 */
@@ -636,6 +742,7 @@ class RomFields
 				col_attrs.sort_dir = COLSORTORDER_ASCENDING;
 
 				data.single = nullptr;
+				view.single = nullptr;
 				mxd.icons = nullptr;
 			}
 			AFLD_PARAMS(unsigned int flags, int rows_visible)
@@ -652,6 +759,7 @@ class RomFields
 				col_attrs.sort_dir = COLSORTORDER_ASCENDING;
 
 				data.single = nullptr;
+				view.single = nullptr;
 				mxd.icons = nullptr;
 			}
 
@@ -666,12 +774,23 @@ class RomFields
 			uint32_t def_lc;
 
 			// Data
+			// NOTE: ListData_t is only kept for compatibility.
+			// The strings are copied into the string arena, so
+			// new code should use ListDataBuilder and view instead.
 			const std::vector<std::string> *headers;
 			union {
 				const ListData_t *single;
 				const ListDataMultiMap_t *multi;
 			} data;
 
+			// Data (from ListDataBuilder)
+			// If set, this is used instead of data.
+			// The strings must be in the destination object's arena.
+			union {
+				const ListDataView_t *single;
+				const ListDataViewMultiMap_t *multi;
+			} view;
+
 			// Mutually-exclusive data.
 			union {
 				// Checkbox bitfield.
@@ -687,6 +806,9 @@ class RomFields
 		/**
 		 * Add ListData.
 		 * NOTE: This object takes ownership of the vectors.
+		 * If params->view is set, the ListDataBuilder rows are used as-is.
+		 * Otherwise, the ListData_t strings are copied into the string
+		 * arena, and the ListData_t vectors are deleted immediately.
 		 * @param name Field name.
 		 * @param params Parameters.
 		 *
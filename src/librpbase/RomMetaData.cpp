@@ -51,6 +51,19 @@ class RomMetaDataPrivate
 		 * @return Metadata property.
 		 */
 		RomMetaData::MetaData *addProperty(Property name);
+
+		/**
+		 * Add a string metadata property.
+		 * @param name Metadata name.
+		 * @param str String value.
+		 * @param len Length of str.
+		 * @param flags Formatting flags.
+		 * @return Metadata index, or -1 on error.
+		 */
+		int addString(Property name, const char *str, size_t len, unsigned int flags);
+
+		// String arena for string properties.
+		StringArena strArena;
 };
 
 /** RomMetaDataPrivate **/
@@ -184,7 +197,7 @@ void RomMetaDataPrivate::delete_data(void)
 				// No data here.
 				break;
 			case PropertyType::String:
-				delete const_cast<string*>(metaData.data.str);
+				// Stored in the string arena.
 				break;
 			default:
 				// ERROR!
@@ -193,8 +206,9 @@ void RomMetaDataPrivate::delete_data(void)
 		}
 	}
 
-	// Clear the metadata vector.
+	// Clear the metadata vector and the string arena.
 	this->metaData.clear();
+	strArena.clear();
 }
 
 /**
@@ -217,10 +231,10 @@ RomMetaData::MetaData *RomMetaDataPrivate::addProperty(Property name)
 	if (map_metaData[(int)name] > Property::Invalid) {
 		// Already added. Overwrite it.
 		pMetaData = &metaData[(int)map_metaData[(int)name]];
-		// If a string is present, delete it.
+		// If a string is present, clear it.
+		// NOTE: The old string stays in the arena.
 		if (pMetaData->type == PropertyType::String) {
-			delete pMetaData->data.str;
-			pMetaData->data.str = nullptr;
+			pMetaData->data.str.clear();
 		}
 	} else {
 		// Not added yet. Create a new one.
@@ -241,6 +255,42 @@ RomMetaData::MetaData *RomMetaDataPrivate::addProperty(Property name)
 	return pMetaData;
 }
 
+/**
+ * Add a string metadata property.
+ * @param name Metadata name.
+ * @param str String value.
+ * @param len Length of str.
+ * @param flags Formatting flags.
+ * @return Metadata index, or -1 on error.
+ */
+int RomMetaDataPrivate::addString(Property name, const char *str, size_t len, unsigned int flags)
+{
+	// Trim the string if requested.
+	if (flags & RomMetaData::STRF_TRIM_END) {
+		len = trimEnd_len(str, len);
+	}
+	if (len == 0) {
+		// Ignore empty strings.
+		return -1;
+	}
+
+	RomMetaData::MetaData *const pMetaData = addProperty(name);
+	assert(pMetaData != nullptr);
+	if (!pMetaData)
+		return -1;
+
+	// Make sure this is a string property.
+	assert(pMetaData->type == PropertyType::String);
+	if (pMetaData->type != PropertyType::String) {
+		// TODO: Delete the property in this case?
+		pMetaData->data.iptrvalue = 0;
+		return -1;
+	}
+
+	pMetaData->data.str = strArena.add(str, len);
+	return static_cast<int>(map_metaData[(int)name]);
+}
+
 /** RomMetaData **/
 
 /**
@@ -282,6 +332,18 @@ const RomMetaData::MetaData *RomMetaData::prop(int idx) const
 	return &d->metaData[idx];
 }
 
+/**
+ * Get the property type for a metadata property.
+ * @param name Property name.
+ * @return Property type, or PropertyType::Invalid if the name is invalid.
+ */
+PropertyType RomMetaData::propertyType(Property name)
+{
+	if (name <= Property::FirstProperty || name >= Property::PropertyCount)
+		return PropertyType::Invalid;
+	return RomMetaDataPrivate::PropertyTypeMap[(int)name];
+}
+
 /**
  * Is this RomMetaData empty?
  * @return True if empty; false if not.
@@ -360,8 +422,8 @@ int RomMetaData::addMetaData_metaData(const RomMetaData *other)
 				break;
 			case PropertyType::String:
 				// TODO: Don't add a property if the string value is nullptr?
-				assert(pSrc->data.str != nullptr);
-				pDest->data.str = (pSrc->data.str ? new string(*pSrc->data.str) : nullptr);
+				assert(pSrc->data.str.ptr != nullptr);
+				pDest->data.str = d->strArena.add(pSrc->data.str.ptr, pSrc->data.str.len);
 				break;
 			case PropertyType::Timestamp:
 				pDest->data.timestamp = pSrc->data.timestamp;
@@ -455,33 +517,8 @@ int RomMetaData::addMetaData_string(Property name, const char *str, unsigned int
 		return -1;
 	}
 
-	string *const nstr = new string(str);
-	// Trim the string if requested.
-	if (nstr && (flags & STRF_TRIM_END)) {
-		trimEnd(*nstr);
-	}
-	if (nstr->empty()) {
-		// String is now empty. Ignore it.
-		delete nstr;
-		return -1;
-	}
-
 	RP_D(RomMetaData);
-	MetaData *const pMetaData = d->addProperty(name);
-	assert(pMetaData != nullptr);
-	if (!pMetaData)
-		return -1;
-
-	// Make sure this is a string property.
-	assert(pMetaData->type == PropertyType::String);
-	if (pMetaData->type != PropertyType::String) {
-		// TODO: Delete the property in this case?
-		pMetaData->data.iptrvalue = 0;
-		return -1;
-	}
-
-	pMetaData->data.str = nstr;
-	return static_cast<int>(d->map_metaData[(int)name]);
+	return d->addString(name, str, strlen(str), flags);
 }
 
 /**
@@ -502,36 +539,8 @@ int RomMetaData::addMetaData_string(Property name, const string &str, unsigned i
 		return -1;
 	}
 
-	string *const nstr = new string(str);
-	// Trim the string if requested.
-	if (nstr && (flags & STRF_TRIM_END)) {
-		trimEnd(*nstr);
-	}
-	if (nstr->empty()) {
-		// String is now empty. Ignore it.
-		delete nstr;
-		return -1;
-	}
-
 	RP_D(RomMetaData);
-	MetaData *const pMetaData = d->addProperty(name);
-	assert(pMetaData != nullptr);
-	if (!pMetaData) {
-		delete nstr;
-		return -1;
-	}
-
-	// Make sure this is a string property.
-	assert(pMetaData->type == PropertyType::String);
-	if (pMetaData->type != PropertyType::String) {
-		// TODO: Delete the property in this case?
-		pMetaData->data.iptrvalue = 0;
-		delete nstr;
-		return -1;
-	}
-
-	pMetaData->data.str = nstr;
-	return static_cast<int>(d->map_metaData[(int)name]);
+	return d->addString(name, str.data(), str.size(), flags);
 }
 
 /**
@@ -24,6 +24,9 @@
 // C++ includes.
 #include <string>
 
+// String arena
+#include "StringArena.hpp"
+
 namespace LibRpBase {
 
 // Properties.
@@ -157,7 +160,7 @@ class RomMetaData
 			PropertyType type;	// Property type.
 
 			union _data {
-				// intptr_t field to cover everything.
+				// intptr_t field to cover the non-string types.
 				// Mainly used to reset the entire field.
 				intptr_t iptrvalue;
 
@@ -168,7 +171,8 @@ class RomMetaData
 				unsigned int uvalue;
 
 				// String property
-				const std::string *str;
+				// Stored in the RomMetaData string arena.
+				StrView str;
 
 				// UNIX timestamp
 				time_t timestamp;
@@ -204,6 +208,13 @@ class RomMetaData
 		 */
 		const MetaData *prop(int idx) const;
 
+		/**
+		 * Get the property type for a metadata property.
+		 * @param name Property name.
+		 * @return Property type, or PropertyType::Invalid if the name is invalid.
+		 */
+		static PropertyType propertyType(Property name);
+
 		/**
 		 * Is this RomMetaData empty?
 		 * @return True if empty; false if not.
@@ -0,0 +1,134 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * StringArena.cpp: Arena allocator for immutable strings.                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "StringArena.hpp"
+
+namespace LibRpBase {
+
+// Block sizes. Blocks start small, since most RomData subclasses
+// only have a few short strings, and double up to the maximum.
+static const size_t MIN_BLOCK_SIZE = 1024U;
+static const size_t MAX_BLOCK_SIZE = 64U * 1024U;
+
+// Strings larger than this get their own block,
+// so they don't waste the rest of the current block.
+static const size_t LARGE_STRING_SIZE = MAX_BLOCK_SIZE / 4;
+
+StringArena::StringArena()
+	: m_head(nullptr)
+	, m_nextBlockSize(MIN_BLOCK_SIZE)
+	, m_bytesAllocated(0)
+{ }
+
+StringArena::~StringArena()
+{
+	clear();
+}
+
+/**
+ * Allocate a new block.
+ * @param size Minimum usable size, in bytes.
+ * @return Block, or nullptr on error.
+ */
+StringArena::Block *StringArena::allocBlock(size_t size)
+{
+	Block *const block = static_cast<Block*>(malloc(sizeof(Block) + size));
+	if (!block) {
+		return nullptr;
+	}
+	block->next = nullptr;
+	block->size = size;
+	block->used = 0;
+	return block;
+}
+
+/**
+ * Copy a string into the arena.
+ * @param str String. (If nullptr, an unset StrView is returned.)
+ * @param len Length of str, in bytes.
+ * @return StrView pointing to the arena copy.
+ */
+StrView StringArena::add(const char *str, size_t len)
+{
+	StrView sv;
+	sv.ptr = nullptr;
+	sv.len = 0;
+	if (!str) {
+		return sv;
+	}
+
+	// Include the NUL terminator.
+	const size_t need = len + 1;
+	Block *block = m_head;
+	if (!block || (block->size - block->used) < need) {
+		if (need > LARGE_STRING_SIZE) {
+			// Large string. Give it its own block.
+			block = allocBlock(need);
+			assert(block != nullptr);
+			if (!block) {
+				return sv;
+			}
+			m_bytesAllocated += need;
+
+			// Insert the block *after* the current block so the
+			// remaining space in the current block can still be used.
+			if (m_head) {
+				block->next = m_head->next;
+				m_head->next = block;
+			} else {
+				m_head = block;
+			}
+		} else {
+			// Allocate a new regular block.
+			size_t blockSize = m_nextBlockSize;
+			while (blockSize < need) {
+				blockSize *= 2;
+			}
+			block = allocBlock(blockSize);
+			assert(block != nullptr);
+			if (!block) {
+				return sv;
+			}
+			m_bytesAllocated += blockSize;
+			m_nextBlockSize = (blockSize < MAX_BLOCK_SIZE ? blockSize * 2 : MAX_BLOCK_SIZE);
+
+			block->next = m_head;
+			m_head = block;
+		}
+	}
+
+	char *const dest = block->data() + block->used;
+	memcpy(dest, str, len);
+	dest[len] = '\0';
+	block->used += need;
+
+	sv.ptr = dest;
+	sv.len = len;
+	return sv;
+}
+
+/**
+ * Free all strings in the arena.
+ * All StrViews returned by add() will be invalidated.
+ */
+void StringArena::clear(void)
+{
+	Block *block = m_head;
+	while (block) {
+		Block *const next = block->next;
+		free(block);
+		block = next;
+	}
+
+	m_head = nullptr;
+	m_nextBlockSize = MIN_BLOCK_SIZE;
+	m_bytesAllocated = 0;
+}
+
+}
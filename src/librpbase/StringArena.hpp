@@ -0,0 +1,203 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * StringArena.hpp: Arena allocator for immutable strings.                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_STRINGARENA_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_STRINGARENA_HPP__
+
+#include "common.h"
+
+// C includes.
+#include <stddef.h>	/* size_t */
+
+// C includes. (C++ namespace)
+#include <cstring>
+
+// C++ includes.
+#include <string>
+
+namespace LibRpBase {
+
+/**
+ * Read-only view of a string stored in a StringArena.
+ * The string data is always NUL-terminated.
+ *
+ * This is a POD type, so it can be stored in the
+ * RomFields::Field and RomMetaData::MetaData unions.
+ */
+struct StrView {
+	const char *ptr;	// String data. (nullptr if no string is set)
+	size_t len;		// Length, in bytes. (not including the NUL terminator)
+
+	/**
+	 * Get the string data.
+	 * @return NUL-terminated string. (never nullptr)
+	 */
+	inline const char *c_str(void) const
+	{
+		return (ptr ? ptr : "");
+	}
+
+	/**
+	 * Get the string data.
+	 * @return NUL-terminated string. (never nullptr)
+	 */
+	inline const char *data(void) const
+	{
+		return c_str();
+	}
+
+	/**
+	 * Get the string length.
+	 * @return Length, in bytes.
+	 */
+	inline size_t size(void) const
+	{
+		return len;
+	}
+
+	/**
+	 * Is the string empty?
+	 * @return True if empty or not set; false if not.
+	 */
+	inline bool empty(void) const
+	{
+		return (len == 0);
+	}
+
+	/**
+	 * Is a string set?
+	 * An empty string that was explicitly set is still "set".
+	 * @return True if set; false if not.
+	 */
+	inline explicit operator bool(void) const
+	{
+		return (ptr != nullptr);
+	}
+
+	/**
+	 * Find a character in the string.
+	 * @param c Character.
+	 * @param pos Starting position.
+	 * @return Position of the character, or std::string::npos if not found.
+	 */
+	inline size_t find(char c, size_t pos = 0) const
+	{
+		if (pos >= len)
+			return std::string::npos;
+		const char *const p = static_cast<const char*>(memchr(ptr + pos, c, len - pos));
+		return (p ? static_cast<size_t>(p - ptr) : std::string::npos);
+	}
+
+	/**
+	 * Copy the string into an std::string.
+	 * @return std::string
+	 */
+	inline std::string toString(void) const
+	{
+		return (ptr ? std::string(ptr, len) : std::string());
+	}
+
+	/**
+	 * Clear the view.
+	 * NOTE: This doesn't free the string in the arena.
+	 */
+	inline void clear(void)
+	{
+		ptr = nullptr;
+		len = 0;
+	}
+};
+
+/**
+ * Arena allocator for immutable strings.
+ *
+ * Strings are copied into large blocks that are only freed
+ * when the arena is cleared or deleted, so adding a string is
+ * usually just a memcpy(), and freeing thousands of strings
+ * is a handful of free() calls.
+ *
+ * Strings can't be freed individually; replacing a string
+ * leaves the old copy in the arena until it's cleared.
+ */
+class StringArena
+{
+	public:
+		StringArena();
+		~StringArena();
+
+	private:
+		RP_DISABLE_COPY(StringArena)
+
+	public:
+		/**
+		 * Copy a string into the arena.
+		 * @param str String. (If nullptr, an unset StrView is returned.)
+		 * @param len Length of str, in bytes.
+		 * @return StrView pointing to the arena copy.
+		 */
+		StrView add(const char *str, size_t len);
+
+		/**
+		 * Copy a NUL-terminated string into the arena.
+		 * @param str String. (If nullptr, an unset StrView is returned.)
+		 * @return StrView pointing to the arena copy.
+		 */
+		inline StrView add(const char *str)
+		{
+			return add(str, (str ? strlen(str) : 0));
+		}
+
+		/**
+		 * Copy a string into the arena.
+		 * @param str String.
+		 * @return StrView pointing to the arena copy.
+		 */
+		inline StrView add(const std::string &str)
+		{
+			return add(str.data(), str.size());
+		}
+
+		/**
+		 * Free all strings in the arena.
+		 * All StrViews returned by add() will be invalidated.
+		 */
+		void clear(void);
+
+		/**
+		 * Get the total number of bytes allocated for string blocks.
+		 * @return Number of bytes allocated.
+		 */
+		size_t bytesAllocated(void) const
+		{
+			return m_bytesAllocated;
+		}
+
+	private:
+		struct Block {
+			Block *next;	// Next (older) block
+			size_t size;	// Usable size, in bytes
+			size_t used;	// Number of bytes used
+			// String data follows the header.
+			inline char *data(void) { return reinterpret_cast<char*>(this + 1); }
+		};
+
+		/**
+		 * Allocate a new block.
+		 * @param size Minimum usable size, in bytes.
+		 * @return Block, or nullptr on error.
+		 */
+		static Block *allocBlock(size_t size);
+
+		Block *m_head;			// Current block (newest)
+		size_t m_nextBlockSize;		// Size of the next regular block
+		size_t m_bytesAllocated;	// Total bytes allocated
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_STRINGARENA_HPP__ */
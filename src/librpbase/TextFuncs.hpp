@@ -722,6 +722,21 @@ std::string formatFileSizeKiB(unsigned int size);
  */
 void trimEnd(std::string &str);
 
+/**
+ * Get the length of a string without its trailing spaces.
+ * This is trimEnd() for strings that can't be modified.
+ * @param str String.
+ * @param len Length of str.
+ * @return Length of str, not including trailing spaces.
+ */
+static inline size_t trimEnd_len(const char *str, size_t len)
+{
+	while (len > 0 && str[len-1] == ' ') {
+		len--;
+	}
+	return len;
+}
+
 /**
  * Convert DOS (CRLF) line endings to UNIX (LF) line endings.
  * @param str_dos	[in] String with DOS line endings.
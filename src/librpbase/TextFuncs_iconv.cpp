@@ -38,24 +38,136 @@
 # include <iconv.h>
 #endif
 
+// SSE2 intrinsics.
+#include "librpcpu/cpu_dispatch.h"
+#ifdef RP_CPU_AMD64
+# include <emmintrin.h>
+#endif /* RP_CPU_AMD64 */
+
 // C++ STL classes.
 using std::string;
 using std::u16string;
+using std::vector;
 
 namespace LibRpBase {
 
 /** OS-specific text conversion functions. **/
 
+// Number of iconv descriptors to cache per thread.
+#define ICONV_CACHE_SIZE 8
+
+/**
+ * Per-thread iconv descriptor cache.
+ *
+ * iconv_open() has to load and parse the conversion tables,
+ * which is much slower than the conversion itself for the
+ * short strings found in most ROM headers. Each thread keeps
+ * its most recently used descriptors, plus an output buffer
+ * that's reused for every conversion.
+ */
+class IconvCache
+{
+	public:
+		IconvCache()
+			: count(0)
+		{ }
+
+		~IconvCache()
+		{
+			for (unsigned int i = 0; i < count; i++) {
+				iconv_close(entries[i].cd);
+			}
+		}
+
+	private:
+		RP_DISABLE_COPY(IconvCache)
+
+	public:
+		/**
+		 * Get an iconv descriptor for the specified conversion.
+		 * The descriptor is reset to its initial state.
+		 * @param src_charset	[in] Source character set.
+		 * @param dest_charset	[in] Destination character set.
+		 * @return iconv descriptor, or (iconv_t)(-1) on error.
+		 */
+		iconv_t get(const char *src_charset, const char *dest_charset)
+		{
+			for (unsigned int i = 0; i < count; i++) {
+				if (strcmp(entries[i].src, src_charset) != 0 ||
+				    strcmp(entries[i].dest, dest_charset) != 0)
+				{
+					continue;
+				}
+
+				// Found a cached descriptor.
+				// Move it to the front of the cache.
+				if (i > 0) {
+					const Entry entry = entries[i];
+					memmove(&entries[1], &entries[0], i * sizeof(entries[0]));
+					entries[0] = entry;
+				}
+
+				// Reset the conversion state.
+				iconv(entries[0].cd, nullptr, nullptr, nullptr, nullptr);
+				return entries[0].cd;
+			}
+
+			// Not cached. Don't cache names that won't fit.
+			if (strlen(src_charset) >= sizeof(entries[0].src) ||
+			    strlen(dest_charset) >= sizeof(entries[0].dest))
+			{
+				return (iconv_t)(-1);
+			}
+
+			// Open a new iconv descriptor.
+			iconv_t cd = iconv_open(dest_charset, src_charset);
+			if (cd == (iconv_t)(-1)) {
+				// Error opening iconv.
+				return cd;
+			}
+
+			if (count == ICONV_CACHE_SIZE) {
+				// Cache is full. Close the least recently used descriptor.
+				count--;
+				iconv_close(entries[count].cd);
+			}
+			memmove(&entries[1], &entries[0], count * sizeof(entries[0]));
+			entries[0].cd = cd;
+			strcpy(entries[0].src, src_charset);
+			strcpy(entries[0].dest, dest_charset);
+			count++;
+			return cd;
+		}
+
+	private:
+		struct Entry {
+			iconv_t cd;
+			char src[32];
+			char dest[32];
+		};
+		Entry entries[ICONV_CACHE_SIZE];
+		unsigned int count;
+
+	public:
+		// Output buffer.
+		vector<char> outbuf;
+};
+static thread_local IconvCache iconv_cache;
+
 /**
  * Convert a string from one character set to another.
+ *
+ * The returned string is stored in a per-thread buffer, and is
+ * only valid until the next call to rp_iconv() on this thread.
+ *
  * @param src 		[in] Source string.
  * @param len           [in] Source length, in bytes.
  * @param src_charset	[in] Source character set.
  * @param dest_charset	[in] Destination character set.
  * @param ignoreErr	[in] If true, ignore errors. ("//IGNORE" on glibc/libiconv)
- * @return malloc()'d UTF-8 string, or nullptr on error.
+ * @return NULL-terminated string in the destination character set, or nullptr on error.
  */
-static char *rp_iconv(const char *src, int len,
+static const char *rp_iconv(const char *src, int len,
 	const char *src_charset, const char *dest_charset,
 	bool ignoreErr = false)
 {
@@ -75,7 +187,7 @@ static char *rp_iconv(const char *src, int len,
 	// * http://www.delorie.com/gnu/docs/glibc/libc_101.html
 	// * http://www.codase.com/search/call?name=iconv
 
-	// Open an iconv descriptor.
+	// Get an iconv descriptor.
 	iconv_t cd;
 #if defined(__linux__) || defined(HAVE_ICONV_LIBICONV)
 	// glibc/libiconv: Append "//IGNORE" to the source character set
@@ -84,13 +196,13 @@ static char *rp_iconv(const char *src, int len,
 	if (ignoreErr) {
 		char tmpsrc[32];
 		snprintf(tmpsrc, sizeof(tmpsrc), "%s//IGNORE", src_charset);
-		cd = iconv_open(dest_charset, tmpsrc);
+		cd = iconv_cache.get(tmpsrc, dest_charset);
 	} else {
 		// Not ignoring errors.
-		cd = iconv_open(dest_charset, src_charset);
+		cd = iconv_cache.get(src_charset, dest_charset);
 	}
 #else
-	cd = iconv_open(dest_charset, src_charset);
+	cd = iconv_cache.get(src_charset, dest_charset);
 #endif
 
 	if (cd == (iconv_t)(-1)) {
@@ -98,23 +210,25 @@ static char *rp_iconv(const char *src, int len,
 		return nullptr;
 	}
 
-	// Allocate the output buffer.
+	// Make sure the output buffer is large enough.
 	// UTF-8 is variable length, and the largest UTF-8 character is 4 bytes long.
 	size_t src_bytes_len = (size_t)len;
 	const size_t out_bytes_len = (src_bytes_len * 4) + 4;
 	size_t out_bytes_remaining = out_bytes_len;
-	char *outbuf = static_cast<char*>(malloc(out_bytes_len));
+	vector<char> &outbuf = iconv_cache.outbuf;
+	if (outbuf.size() < out_bytes_len) {
+		outbuf.resize(out_bytes_len);
+	}
 
 	// Input and output pointers.
 	char *inptr = const_cast<char*>(src);	// Input pointer.
-	char *outptr = &outbuf[0];		// Output pointer.
+	char *outptr = outbuf.data();		// Output pointer.
 
 #ifdef __FreeBSD__
 	// Flags for FreeBSD's __iconv().
 	const uint32_t iconv_flags = (ignoreErr ? __ICONV_F_HIDE_INVALID : 0);
 #endif /* __FreeBSD */
 
-	bool success = true;
 	while (src_bytes_len > 0) {
 		size_t size;
 
@@ -132,30 +246,153 @@ static char *rp_iconv(const char *src, int len,
 			// Madou Monogatari I (MD) has a broken Shift-JIS
 			// code point, which breaks conversion.
 			// (Reported by andlabs.)
-			success = false;
-			break;
+			return nullptr;
 		}
 	}
 
-	// Close the iconv descriptor.
-	iconv_close(cd);
+	// The string was converted successfully.
 
-	if (success) {
-		// The string was converted successfully.
+	// Make sure the string is null-terminated.
+	size_t null_bytes = (out_bytes_remaining > 4 ? 4 : out_bytes_remaining);
+	for (size_t i = null_bytes; i > 0; i--) {
+		*outptr++ = 0x00;
+	}
 
-		// Make sure the string is null-terminated.
-		size_t null_bytes = (out_bytes_remaining > 4 ? 4 : out_bytes_remaining);
-		for (size_t i = null_bytes; i > 0; i--) {
-			*outptr++ = 0x00;
-		}
+	// Return the output buffer.
+	return outbuf.data();
+}
 
-		// Return the output buffer.
-		return outbuf;
+/** ASCII fast paths. **/
+
+/**
+ * Bitwise-OR all bytes in an 8-bit string.
+ * Used to check if a string is 7-bit ASCII.
+ * @param str	[in] 8-bit text.
+ * @param len	[in] Length of str, in bytes.
+ * @return Bitwise-OR of all bytes.
+ */
+static inline uint8_t or_reduce8(const char *str, size_t len)
+{
+	const uint8_t *p = reinterpret_cast<const uint8_t*>(str);
+	uint8_t ret = 0;
+
+#ifdef RP_CPU_AMD64
+	// amd64 always has SSE2.
+	__m128i xmm_acc = _mm_setzero_si128();
+	for (; len >= 16; p += 16, len -= 16) {
+		xmm_acc = _mm_or_si128(xmm_acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+	}
+	if (_mm_movemask_epi8(xmm_acc) != 0) {
+		// Found a byte with the high bit set.
+		return 0x80;
+	}
+#else /* !RP_CPU_AMD64 */
+	uint64_t acc = 0;
+	for (; len >= 8; p += 8, len -= 8) {
+		uint64_t qword;
+		memcpy(&qword, p, sizeof(qword));
+		acc |= qword;
 	}
+	acc |= (acc >> 32);
+	acc |= (acc >> 16);
+	acc |= (acc >>  8);
+	ret = static_cast<uint8_t>(acc);
+#endif /* RP_CPU_AMD64 */
+
+	for (; len > 0; p++, len--) {
+		ret |= *p;
+	}
+	return ret;
+}
 
-	// The string was not converted successfully.
-	free(outbuf);
-	return nullptr;
+/**
+ * Bitwise-OR all characters in a UTF-16 string.
+ * Used to check if a string is 7-bit ASCII.
+ * NOTE: Characters are *not* byteswapped.
+ * @param wcs	[in] UTF-16 text.
+ * @param len	[in] Length of wcs, in characters.
+ * @return Bitwise-OR of all characters.
+ */
+static inline uint16_t or_reduce16(const char16_t *wcs, size_t len)
+{
+	uint16_t ret = 0;
+
+#ifdef RP_CPU_AMD64
+	// amd64 always has SSE2.
+	__m128i xmm_acc = _mm_setzero_si128();
+	for (; len >= 8; wcs += 8, len -= 8) {
+		xmm_acc = _mm_or_si128(xmm_acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(wcs)));
+	}
+	xmm_acc = _mm_or_si128(xmm_acc, _mm_srli_si128(xmm_acc, 8));
+	xmm_acc = _mm_or_si128(xmm_acc, _mm_srli_si128(xmm_acc, 4));
+	xmm_acc = _mm_or_si128(xmm_acc, _mm_srli_si128(xmm_acc, 2));
+	ret = static_cast<uint16_t>(_mm_cvtsi128_si32(xmm_acc));
+#else /* !RP_CPU_AMD64 */
+	uint64_t acc = 0;
+	for (; len >= 4; wcs += 4, len -= 4) {
+		uint64_t qword;
+		memcpy(&qword, wcs, sizeof(qword));
+		acc |= qword;
+	}
+	acc |= (acc >> 32);
+	acc |= (acc >> 16);
+	ret = static_cast<uint16_t>(acc);
+#endif /* RP_CPU_AMD64 */
+
+	for (; len > 0; wcs++, len--) {
+		ret |= *wcs;
+	}
+	return ret;
+}
+
+// Masks for non-ASCII UTF-16 characters.
+#define UTF16_NONASCII_MASK_HOST	0xFF80U
+#define UTF16_NONASCII_MASK_SWAPPED	0x80FFU
+#if SYS_BYTEORDER == SYS_BIG_ENDIAN
+# define UTF16LE_NONASCII_MASK UTF16_NONASCII_MASK_SWAPPED
+# define UTF16BE_NONASCII_MASK UTF16_NONASCII_MASK_HOST
+#else
+# define UTF16LE_NONASCII_MASK UTF16_NONASCII_MASK_HOST
+# define UTF16BE_NONASCII_MASK UTF16_NONASCII_MASK_SWAPPED
+#endif
+
+/**
+ * Narrow a 7-bit ASCII UTF-16 string to 8-bit.
+ * @param wcs	[in] UTF-16 text. (must be 7-bit ASCII)
+ * @param len	[in] Length of wcs, in characters.
+ * @param swap	[in] If true, characters are byteswapped.
+ * @return 8-bit string.
+ */
+static inline string ascii16_to_ascii8(const char16_t *wcs, int len, bool swap)
+{
+	string ret;
+	ret.resize(len);
+	const int shift = (swap ? 8 : 0);
+	for (int i = 0; i < len; i++) {
+		ret[i] = static_cast<char>(static_cast<uint16_t>(wcs[i]) >> shift);
+	}
+	return ret;
+}
+
+/**
+ * Check if a code page maps 7-bit ASCII to Unicode one-to-one.
+ * @param cp	[in] Code page number.
+ * @return True if 7-bit ASCII text can be copied as-is.
+ */
+static inline bool isAsciiCompatible(unsigned int cp)
+{
+	// NOTE: cp932 maps 0x5C and 0x7E to U+005C and U+007E,
+	// not to the Yen sign and overline like JIS X 0201.
+	switch (cp) {
+		case CP_ACP:
+		case CP_LATIN1:
+		case CP_UTF8:
+		case CP_SJIS:
+		case 1252:
+			return true;
+		default:
+			return false;
+	}
 }
 
 /** Generic code page functions. **/
@@ -202,6 +439,10 @@ static inline void codePageToEncName(char *enc_name, size_t len, unsigned int cp
 string cpN_to_utf8(unsigned int cp, const char *str, int len, unsigned int flags)
 {
 	len = check_NULL_terminator(str, len);
+	if (isAsciiCompatible(cp) && !(or_reduce8(str, len) & 0x80)) {
+		// 7-bit ASCII. No conversion is needed.
+		return string(str, len);
+	}
 
 	// Get the encoding name for the primary code page.
 	char cp_name[20];
@@ -215,24 +456,23 @@ string cpN_to_utf8(unsigned int cp, const char *str, int len, unsigned int flags
 	// NOTE: "//IGNORE" sometimes doesn't work, so we won't
 	// check for TEXTCONV_FLAG_CP1252_FALLBACK here.
 	string ret;
-	char *mbs = reinterpret_cast<char*>(rp_iconv((char*)str, len*sizeof(*str), cp_name, "UTF-8", ignoreErr));
+	const char *mbs = rp_iconv(str, len*sizeof(*str), cp_name, "UTF-8", ignoreErr);
 	if (!mbs /*&& (flags & TEXTCONV_FLAG_CP1252_FALLBACK)*/) {
 		// Try cp1252 fallback.
 		// NOTE: Sometimes cp1252 fails, even with ignore set.
 		if (cp != 1252) {
-			mbs = reinterpret_cast<char*>(rp_iconv((char*)str, len*sizeof(*str), "CP1252", "UTF-8", true));
+			mbs = rp_iconv(str, len*sizeof(*str), "CP1252", "UTF-8", true);
 		}
 		if (!mbs) {
 			// Try Latin-1 fallback.
 			if (cp != CP_LATIN1) {
-				mbs = reinterpret_cast<char*>(rp_iconv((char*)str, len*sizeof(*str), "LATIN1", "UTF-8", true));
+				mbs = rp_iconv(str, len*sizeof(*str), "LATIN1", "UTF-8", true);
 			}
 		}
 	}
 
 	if (mbs) {
 		ret.assign(mbs);
-		free(mbs);
 
 #ifdef HAVE_ICONV_LIBICONV
 		if (cp == CP_SJIS) {
@@ -269,6 +509,15 @@ string cpN_to_utf8(unsigned int cp, const char *str, int len, unsigned int flags
 u16string cpN_to_utf16(unsigned int cp, const char *str, int len, unsigned int flags)
 {
 	len = check_NULL_terminator(str, len);
+	if (isAsciiCompatible(cp) && !(or_reduce8(str, len) & 0x80)) {
+		// 7-bit ASCII. No conversion is needed.
+		u16string ret;
+		ret.resize(len);
+		for (int i = 0; i < len; i++) {
+			ret[i] = static_cast<char16_t>(str[i]);
+		}
+		return ret;
+	}
 
 	// Get the encoding name for the primary code page.
 	char cp_name[20];
@@ -282,24 +531,23 @@ u16string cpN_to_utf16(unsigned int cp, const char *str, int len, unsigned int f
 	// NOTE: "//IGNORE" sometimes doesn't work, so we won't
 	// check for TEXTCONV_FLAG_CP1252_FALLBACK here.
 	u16string ret;
-	char16_t *wcs = reinterpret_cast<char16_t*>(rp_iconv((char*)str, len*sizeof(*str), cp_name, RP_ICONV_UTF16_ENCODING, ignoreErr));
+	const char16_t *wcs = reinterpret_cast<const char16_t*>(rp_iconv(str, len*sizeof(*str), cp_name, RP_ICONV_UTF16_ENCODING, ignoreErr));
 	if (!wcs /*&& (flags & TEXTCONV_FLAG_CP1252_FALLBACK)*/) {
 		// Try cp1252 fallback.
 		// NOTE: Sometimes cp1252 fails, even with ignore set.
 		if (cp != 1252) {
-			wcs = reinterpret_cast<char16_t*>(rp_iconv((char*)str, len*sizeof(*str), "CP1252", RP_ICONV_UTF16_ENCODING, true));
+			wcs = reinterpret_cast<const char16_t*>(rp_iconv(str, len*sizeof(*str), "CP1252", RP_ICONV_UTF16_ENCODING, true));
 		}
 		if (!wcs) {
 			// Try Latin-1 fallback.
 			if (cp != CP_LATIN1) {
-				wcs = reinterpret_cast<char16_t*>(rp_iconv((char*)str, len*sizeof(*str), "LATIN1//IGNORE", RP_ICONV_UTF16_ENCODING, true));
+				wcs = reinterpret_cast<const char16_t*>(rp_iconv(str, len*sizeof(*str), "LATIN1//IGNORE", RP_ICONV_UTF16_ENCODING, true));
 			}
 		}
 	}
 
 	if (wcs) {
 		ret.assign(wcs);
-		free(wcs);
 
 #ifdef HAVE_ICONV_LIBICONV
 		if (cp == CP_SJIS) {
@@ -332,6 +580,10 @@ u16string cpN_to_utf16(unsigned int cp, const char *str, int len, unsigned int f
 string utf8_to_cpN(unsigned int cp, const char *str, int len)
 {
 	len = check_NULL_terminator(str, len);
+	if (isAsciiCompatible(cp) && !(or_reduce8(str, len) & 0x80)) {
+		// 7-bit ASCII. No conversion is needed.
+		return string(str, len);
+	}
 
 	// Get the encoding name for the primary code page.
 	char cp_name[20];
@@ -339,10 +591,9 @@ string utf8_to_cpN(unsigned int cp, const char *str, int len)
 
 	// Attempt to convert the text from UTF-8.
 	string ret;
-	char *mbs = reinterpret_cast<char*>(rp_iconv((char*)str, len*sizeof(*str), "UTF-8", cp_name, true));
+	const char *mbs = rp_iconv(str, len*sizeof(*str), "UTF-8", cp_name, true);
 	if (mbs) {
 		ret.assign(mbs);
-		free(mbs);
 	}
 	return ret;
 }
@@ -362,6 +613,10 @@ string utf8_to_cpN(unsigned int cp, const char *str, int len)
 string utf16_to_cpN(unsigned int cp, const char16_t *wcs, int len)
 {
 	len = check_NULL_terminator(wcs, len);
+	if (isAsciiCompatible(cp) && !(or_reduce16(wcs, len) & UTF16_NONASCII_MASK_HOST)) {
+		// 7-bit ASCII. No conversion is needed.
+		return ascii16_to_ascii8(wcs, len, false);
+	}
 
 	// Get the encoding name for the primary code page.
 	char cp_name[20];
@@ -372,10 +627,9 @@ string utf16_to_cpN(unsigned int cp, const char16_t *wcs, int len)
 
 	// Attempt to convert the text from UTF-8.
 	string ret;
-	char *mbs = reinterpret_cast<char*>(rp_iconv((char*)wcs, len*sizeof(*wcs), RP_ICONV_UTF16_ENCODING, cp_name, ignoreErr));
+	const char *mbs = rp_iconv(reinterpret_cast<const char*>(wcs), len*sizeof(*wcs), RP_ICONV_UTF16_ENCODING, cp_name, ignoreErr);
 	if (mbs) {
 		ret.assign(mbs);
-		free(mbs);
 	}
 	return ret;
 }
@@ -393,12 +647,16 @@ string utf16le_to_utf8(const char16_t *wcs, int len)
 {
 	len = check_NULL_terminator(wcs, len);
 
+	if (!(or_reduce16(wcs, len) & UTF16LE_NONASCII_MASK)) {
+		// 7-bit ASCII. No conversion is needed.
+		return ascii16_to_ascii8(wcs, len, (SYS_BYTEORDER == SYS_BIG_ENDIAN));
+	}
+
 	// Attempt to convert the text from UTF-16LE to UTF-8.
 	string ret;
-	char *mbs = reinterpret_cast<char*>(rp_iconv((char*)wcs, len*sizeof(*wcs), "UTF-16LE", "UTF-8"));
+	const char *mbs = rp_iconv(reinterpret_cast<const char*>(wcs), len*sizeof(*wcs), "UTF-16LE", "UTF-8");
 	if (mbs) {
 		ret.assign(mbs);
-		free(mbs);
 	}
 	return ret;
 }
@@ -414,12 +672,16 @@ string utf16be_to_utf8(const char16_t *wcs, int len)
 {
 	len = check_NULL_terminator(wcs, len);
 
+	if (!(or_reduce16(wcs, len) & UTF16BE_NONASCII_MASK)) {
+		// 7-bit ASCII. No conversion is needed.
+		return ascii16_to_ascii8(wcs, len, (SYS_BYTEORDER != SYS_BIG_ENDIAN));
+	}
+
 	// Attempt to convert the text from UTF-16BE to UTF-8.
 	string ret;
-	char *mbs = reinterpret_cast<char*>(rp_iconv((char*)wcs, len*sizeof(*wcs), "UTF-16BE", "UTF-8"));
+	const char *mbs = rp_iconv(reinterpret_cast<const char*>(wcs), len*sizeof(*wcs), "UTF-16BE", "UTF-8");
 	if (mbs) {
 		ret.assign(mbs);
-		free(mbs);
 	}
 	return ret;
 }
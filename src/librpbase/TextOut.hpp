@@ -41,6 +41,7 @@ class JSONROMOutput {
 	const RomData *const romdata;
 	uint32_t lc;
 	bool crlf_;
+	bool compact_;
 public:
 	explicit JSONROMOutput(const RomData *romdata, uint32_t lc = 0);
 	friend std::ostream& operator<<(std::ostream& os, const JSONROMOutput& fo);
@@ -52,6 +53,18 @@ public:
 	inline void setCrlf(bool val) {
 		crlf_ = val;
 	}
+
+	/**
+	 * Compact output: a single line with no whitespace.
+	 * Suitable for NDJSON (one object per line).
+	 */
+	inline bool compact(void) const {
+		return compact_;
+	}
+
+	inline void setCompact(bool val) {
+		compact_ = val;
+	}
 };
 
 }
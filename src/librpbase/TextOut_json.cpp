@@ -30,21 +30,80 @@ using std::vector;
 using LibRpTexture::rp_image;
 
 // rapidjson
-#include "rapidjson/document.h"
-#include "rapidjson/ostreamwrapper.h"
 #include "rapidjson/prettywriter.h"
+#include "rapidjson/writer.h"
 using namespace rapidjson;
 
 namespace LibRpBase {
 
-template<typename Allocator>
+/**
+ * Buffered std::ostream wrapper for RapidJSON writers.
+ * rapidjson::OStreamWrapper calls ostream::put() for every character,
+ * which is slower than generating the JSON in the first place.
+ */
+class BufferedOStreamWrapper {
+public:
+	typedef char Ch;
+
+	explicit BufferedOStreamWrapper(ostream &os)
+		: os(os)
+		, pos(0) { }
+
+	~BufferedOStreamWrapper()
+	{
+		Flush();
+	}
+
+private:
+	RP_DISABLE_COPY(BufferedOStreamWrapper)
+
+public:
+	inline void Put(Ch c)
+	{
+		if (pos == sizeof(buf)) {
+			Flush();
+		}
+		buf[pos++] = c;
+	}
+
+	void Flush(void)
+	{
+		if (pos > 0) {
+			os.write(buf, pos);
+			pos = 0;
+		}
+	}
+
+	// Not implemented. (input stream functions)
+	Ch Peek(void) const { assert(false); return '\0'; }
+	Ch Take(void) { assert(false); return '\0'; }
+	size_t Tell(void) const { assert(false); return 0; }
+	Ch *PutBegin(void) { assert(false); return nullptr; }
+	size_t PutEnd(Ch*) { assert(false); return 0; }
+
+private:
+	ostream &os;
+	size_t pos;
+	char buf[16384];
+};
+
+/**
+ * Write RomFields to a RapidJSON SAX writer.
+ * Fields are written as they're read; no DOM is built.
+ */
+template<typename JSONWriter>
 class JSONFieldsOutput {
 	const RomFields& fields;
 public:
 	explicit JSONFieldsOutput(const RomFields& fields) :fields(fields) {}
 
 private:
-	static Value lcToValue(uint32_t lc, Allocator &allocator)
+	/**
+	 * Write a language code as an object key.
+	 * @param writer JSON writer
+	 * @param lc Language code
+	 */
+	static void writeLCKey(JSONWriter &writer, uint32_t lc)
 	{
 		char s_lc[8];
 		int s_lc_pos = 0;
@@ -56,322 +115,367 @@ private:
 		}
 		s_lc[s_lc_pos] = '\0';
 
-		Value s_lc_name;
-		s_lc_name.SetString(s_lc, s_lc_pos, allocator);
-		return s_lc_name;
+		writer.Key(s_lc, s_lc_pos, true);
 	}
 
-	static Value listDataToValue(const RomFields::Field &field,
-		const RomFields::ListData_t *list_data, Allocator &allocator)
+	/**
+	 * Write a string.
+	 * @param writer JSON writer
+	 * @param str String
+	 */
+	static inline void writeString(JSONWriter &writer, const string &str)
 	{
-		Value data_array(kArrayType);	// data
-		assert(list_data != nullptr);
-		if (!list_data) {
-			// No data...
-			return data_array;
-		}
+		writer.String(str.data(), static_cast<SizeType>(str.size()));
+	}
+
+	/**
+	 * Write a string from the RomFields string arena.
+	 * @param writer JSON writer
+	 * @param str StrView
+	 */
+	static inline void writeString(JSONWriter &writer, const StrView &str)
+	{
+		writer.String(str.c_str(), static_cast<SizeType>(str.size()));
+	}
+
+	/**
+	 * Write RFT_LISTDATA rows as an array.
+	 * The caller must ensure list_data is not empty.
+	 * @param writer JSON writer
+	 * @param field RomFields::Field
+	 * @param list_data Single-language ListDataView_t
+	 */
+	static void writeListData(JSONWriter &writer, const RomFields::Field &field,
+		const RomFields::ListDataView_t *list_data)
+	{
+		writer.StartArray();	// data
 
 		const bool has_checkboxes = !!(field.desc.list_data.flags & RomFields::RFT_LISTDATA_CHECKBOXES);
 		uint32_t checkboxes = field.data.list_data.mxd.checkboxes;
 		const auto list_data_cend = list_data->cend();
 		for (auto it = list_data->cbegin(); it != list_data_cend; ++it) {
-			Value row_array(kArrayType);
+			writer.StartArray();
 			if (has_checkboxes) {
 				// TODO: Better JSON schema for RFT_LISTDATA_CHECKBOXES?
-				row_array.PushBack((checkboxes & 1) ? true : false, allocator);
+				writer.Bool((checkboxes & 1) ? true : false);
 				checkboxes >>= 1;
 			}
 
 			const auto it_cend = it->cend();
 			for (auto jt = it->cbegin(); jt != it_cend; ++jt) {
-				row_array.PushBack(StringRef(*jt), allocator);
+				writeString(writer, *jt);
 			}
 
-			data_array.PushBack(row_array, allocator);
+			writer.EndArray();
 		}
 
-		return data_array;
+		writer.EndArray();
 	}
 
-public:
-	void writeToJSON(Value &fields_array, Allocator &allocator)
+	/**
+	 * Write the "name" key for a field's description.
+	 * @param writer JSON writer
+	 * @param romField RomFields::Field
+	 */
+	static inline void writeDescName(JSONWriter &writer, const RomFields::Field &romField)
 	{
-		const auto fields_cend = fields.cend();
-		for (auto iter = fields.cbegin(); iter != fields_cend; ++iter) {
-			const auto &romField = *iter;
-			if (!romField.isValid)
-				continue;
+		writer.Key("name");
+		writeString(writer, romField.name);
+	}
 
-			Value field_obj(kObjectType);	// field
+	/**
+	 * Write a single field as an object.
+	 * @param writer JSON writer
+	 * @param romField RomFields::Field
+	 */
+	static void writeField(JSONWriter &writer, const RomFields::Field &romField)
+	{
+		writer.StartObject();	// field
 
-			switch (romField.type) {
-				case RomFields::RFT_INVALID: {
-					assert(!"INVALID field type");
-					field_obj.AddMember("type", "INVALID", allocator);
-					break;
-				}
+		switch (romField.type) {
+			case RomFields::RFT_INVALID: {
+				assert(!"INVALID field type");
+				writer.Key("type"); writer.String("INVALID");
+				break;
+			}
 
-				case RomFields::RFT_STRING: {
-					field_obj.AddMember("type", "STRING", allocator);
+			case RomFields::RFT_STRING: {
+				writer.Key("type"); writer.String("STRING");
 
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-					desc_obj.AddMember("format", romField.desc.flags, allocator);
-					field_obj.AddMember("desc", desc_obj, allocator);
+				writer.Key("desc"); writer.StartObject();
+				writeDescName(writer, romField);
+				writer.Key("format"); writer.Uint(romField.desc.flags);
+				writer.EndObject();
 
-					field_obj.AddMember("data", StringRef(*(romField.data.str)), allocator);
-					break;
-				}
+				writer.Key("data");
+				writer.String(romField.data.str.c_str(), static_cast<SizeType>(romField.data.str.size()));
+				break;
+			}
 
-				case RomFields::RFT_BITFIELD: {
-					field_obj.AddMember("type", "BITFIELD", allocator);
-					const auto &bitfieldDesc = romField.desc.bitfield;
-
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-					desc_obj.AddMember("elementsPerRow", bitfieldDesc.elemsPerRow, allocator);
-
-					assert(bitfieldDesc.names != nullptr);
-					if (bitfieldDesc.names) {
-						Value names_array(kArrayType);	// names
-						unsigned int count = static_cast<unsigned int>(bitfieldDesc.names->size());
-						assert(count <= 32);
-						if (count > 32)
-							count = 32;
-						const auto names_cend = bitfieldDesc.names->cend();
-						for (auto iter = bitfieldDesc.names->cbegin(); iter != names_cend; ++iter) {
-							const string &name = *iter;
-							if (name.empty())
-								continue;
-
-							names_array.PushBack(StringRef(name), allocator);
-						}
-						if (!names_array.Empty()) {
-							desc_obj.AddMember("names", names_array, allocator);
-						} else {
-							desc_obj.AddMember("names", "ERROR", allocator);
+			case RomFields::RFT_BITFIELD: {
+				writer.Key("type"); writer.String("BITFIELD");
+				const auto &bitfieldDesc = romField.desc.bitfield;
+
+				writer.Key("desc"); writer.StartObject();
+				writeDescName(writer, romField);
+				writer.Key("elementsPerRow"); writer.Int(bitfieldDesc.elemsPerRow);
+
+				// If none of the names are set, "names" is "ERROR".
+				// Check that before starting the array.
+				assert(bitfieldDesc.names != nullptr);
+				bool hasNames = false;
+				if (bitfieldDesc.names) {
+					assert(bitfieldDesc.names->size() <= 32);
+					const auto names_cend = bitfieldDesc.names->cend();
+					for (auto iter = bitfieldDesc.names->cbegin(); iter != names_cend; ++iter) {
+						if (!iter->empty()) {
+							hasNames = true;
+							break;
 						}
-					} else {
-						desc_obj.AddMember("names", "ERROR", allocator);
 					}
-
-					field_obj.AddMember("desc", desc_obj, allocator);
-					field_obj.AddMember("data", romField.data.bitfield, allocator);
-					break;
 				}
 
-				case RomFields::RFT_LISTDATA: {
-					field_obj.AddMember("type", "LISTDATA", allocator);
-					const auto &listDataDesc = romField.desc.list_data;
+				writer.Key("names");
+				if (hasNames) {
+					writer.StartArray();
+					const auto names_cend = bitfieldDesc.names->cend();
+					for (auto iter = bitfieldDesc.names->cbegin(); iter != names_cend; ++iter) {
+						const string &name = *iter;
+						if (name.empty())
+							continue;
+						writeString(writer, name);
+					}
+					writer.EndArray();
+				} else {
+					writer.String("ERROR");
+				}
+				writer.EndObject();
 
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
+				writer.Key("data"); writer.Uint(romField.data.bitfield);
+				break;
+			}
 
-					Value names_array(kArrayType);	// names
-					if (listDataDesc.names) {
-						if (listDataDesc.flags & RomFields::RFT_LISTDATA_CHECKBOXES) {
-							// TODO: Better JSON schema for RFT_LISTDATA_CHECKBOXES?
-							names_array.PushBack("checked", allocator);
-						}
-						const auto names_cend = listDataDesc.names->cend();
-						for (auto iter = listDataDesc.names->cbegin();
-						     iter != names_cend; ++iter)
-						{
-							const string &name = *iter;
-							names_array.PushBack(StringRef(name), allocator);
-						}
+			case RomFields::RFT_LISTDATA: {
+				writer.Key("type"); writer.String("LISTDATA");
+				const auto &listDataDesc = romField.desc.list_data;
+
+				writer.Key("desc"); writer.StartObject();
+				writeDescName(writer, romField);
+				writer.Key("names"); writer.StartArray();
+				if (listDataDesc.names) {
+					if (listDataDesc.flags & RomFields::RFT_LISTDATA_CHECKBOXES) {
+						// TODO: Better JSON schema for RFT_LISTDATA_CHECKBOXES?
+						writer.String("checked");
 					}
-					desc_obj.AddMember("names", names_array, allocator);
-					field_obj.AddMember("desc", desc_obj, allocator);
-
-					if (!(listDataDesc.flags & RomFields::RFT_LISTDATA_MULTI)) {
-						// Single-language ListData.
-						Value data_array = listDataToValue(romField,
-							romField.data.list_data.data.single, allocator);
-						if (!data_array.Empty()) {
-							field_obj.AddMember("data", data_array, allocator);
-						} else {
-							// No data...
-							field_obj.AddMember("data", "ERROR", allocator);
-							break;
-						}
+					const auto names_cend = listDataDesc.names->cend();
+					for (auto iter = listDataDesc.names->cbegin();
+					     iter != names_cend; ++iter)
+					{
+						writeString(writer, *iter);
+					}
+				}
+				writer.EndArray();
+				writer.EndObject();
+
+				writer.Key("data");
+				if (!(listDataDesc.flags & RomFields::RFT_LISTDATA_MULTI)) {
+					// Single-language ListData.
+					const auto *const list_data = romField.data.list_data.data.single;
+					assert(list_data != nullptr);
+					if (list_data && !list_data->empty()) {
+						writeListData(writer, romField, list_data);
 					} else {
-						// Multi-language ListData.
-						Value data_obj(kObjectType);	// data
-						const auto *const list_data = romField.data.list_data.data.multi;
-						assert(list_data != nullptr);
-						if (!list_data) {
-							// No data...
-							field_obj.AddMember("data", "ERROR", allocator);
-							break;
-						}
+						// No data...
+						writer.String("ERROR");
+					}
+				} else {
+					// Multi-language ListData.
+					const auto *const list_data = romField.data.list_data.data.multi;
+					assert(list_data != nullptr);
+					if (!list_data) {
+						// No data...
+						writer.String("ERROR");
+						break;
+					}
 
-						const auto list_data_cend = list_data->cend();
-						for (auto mapIter = list_data->cbegin(); mapIter != list_data_cend; ++mapIter) {
-							// Key: Language code
-							// Value: Vector of string data
-							Value s_lc_name = lcToValue(mapIter->first, allocator);
-
-							Value lc_array = listDataToValue(romField,
-								&mapIter->second, allocator);
-							if (!lc_array.Empty()) {
-								data_obj.AddMember(s_lc_name, lc_array, allocator);
-							} else {
-								// No data...
-								data_obj.AddMember(s_lc_name, "ERROR", allocator);
-								continue;
-							}
+					writer.StartObject();	// data
+					const auto list_data_cend = list_data->cend();
+					for (auto mapIter = list_data->cbegin(); mapIter != list_data_cend; ++mapIter) {
+						// Key: Language code
+						// Value: Vector of string data
+						writeLCKey(writer, mapIter->first);
+						if (!mapIter->second.empty()) {
+							writeListData(writer, romField, &mapIter->second);
+						} else {
+							// No data...
+							writer.String("ERROR");
 						}
-
-						field_obj.AddMember("data", data_obj, allocator);
 					}
-					break;
-				}
-
-				case RomFields::RFT_DATETIME: {
-					field_obj.AddMember("type", "DATETIME", allocator);
-
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-					desc_obj.AddMember("flags", romField.desc.flags, allocator);
-					field_obj.AddMember("desc", desc_obj, allocator);
-
-					field_obj.AddMember("data", static_cast<int64_t>(romField.data.date_time), allocator);
-					break;
+					writer.EndObject();
 				}
+				break;
+			}
 
-				case RomFields::RFT_AGE_RATINGS: {
-					field_obj.AddMember("type", "AGE_RATINGS", allocator);
+			case RomFields::RFT_DATETIME: {
+				writer.Key("type"); writer.String("DATETIME");
 
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-					field_obj.AddMember("desc", desc_obj, allocator);
+				writer.Key("desc"); writer.StartObject();
+				writeDescName(writer, romField);
+				writer.Key("flags"); writer.Uint(romField.desc.flags);
+				writer.EndObject();
 
-					const RomFields::age_ratings_t *age_ratings = romField.data.age_ratings;
-					assert(age_ratings != nullptr);
-					if (!age_ratings) {
-						field_obj.AddMember("data", "ERROR", allocator);
-						break;
-					}
+				writer.Key("data"); writer.Int64(static_cast<int64_t>(romField.data.date_time));
+				break;
+			}
 
-					Value data_array(kArrayType);	// data
-					const unsigned int age_ratings_max = static_cast<unsigned int>(age_ratings->size());
-					for (unsigned int j = 0; j < age_ratings_max; j++) {
-						const uint16_t rating = age_ratings->at(j);
-						if (!(rating & RomFields::AGEBF_ACTIVE))
-							continue;
+			case RomFields::RFT_AGE_RATINGS: {
+				writer.Key("type"); writer.String("AGE_RATINGS");
 
-						Value rating_obj(kObjectType);
-						const char *const abbrev = RomFields::ageRatingAbbrev((RomFields::AgeRatingsCountry)j);
-						if (abbrev) {
-							rating_obj.AddMember("name", StringRef(abbrev), allocator);
-						} else {
-							// Invalid age rating.
-							// Use the numeric index.
-							rating_obj.AddMember("name", j, allocator);
-						}
+				writer.Key("desc"); writer.StartObject();
+				writeDescName(writer, romField);
+				writer.EndObject();
 
-						const string s_age_rating = RomFields::ageRatingDecode((RomFields::AgeRatingsCountry)j, rating);
-						Value rating_val;
-						rating_val.SetString(s_age_rating, allocator);
-						rating_obj.AddMember("rating", rating_val, allocator);
+				writer.Key("data");
+				const RomFields::age_ratings_t *age_ratings = romField.data.age_ratings;
+				assert(age_ratings != nullptr);
+				if (!age_ratings) {
+					writer.String("ERROR");
+					break;
+				}
 
-						data_array.PushBack(rating_obj, allocator);
+				writer.StartArray();	// data
+				const unsigned int age_ratings_max = static_cast<unsigned int>(age_ratings->size());
+				for (unsigned int j = 0; j < age_ratings_max; j++) {
+					const uint16_t rating = age_ratings->at(j);
+					if (!(rating & RomFields::AGEBF_ACTIVE))
+						continue;
+
+					writer.StartObject();
+					writer.Key("name");
+					const char *const abbrev = RomFields::ageRatingAbbrev((RomFields::AgeRatingsCountry)j);
+					if (abbrev) {
+						writer.String(abbrev);
+					} else {
+						// Invalid age rating.
+						// Use the numeric index.
+						writer.Uint(j);
 					}
 
-					field_obj.AddMember("data", data_array, allocator);
-					break;
+					writer.Key("rating");
+					writeString(writer, RomFields::ageRatingDecode((RomFields::AgeRatingsCountry)j, rating));
+					writer.EndObject();
 				}
+				writer.EndArray();
+				break;
+			}
 
-				case RomFields::RFT_DIMENSIONS: {
-					field_obj.AddMember("type", "DIMENSIONS", allocator);
+			case RomFields::RFT_DIMENSIONS: {
+				writer.Key("type"); writer.String("DIMENSIONS");
 
-					const int *const dimensions = romField.data.dimensions;
-					Value data_obj(kObjectType);	// data
-					data_obj.AddMember("w", dimensions[0], allocator);
-					if (dimensions[1] > 0) {
-						data_obj.AddMember("h", dimensions[1], allocator);
-						if (dimensions[2] > 0) {
-							data_obj.AddMember("d", dimensions[2], allocator);
-						}
+				const int *const dimensions = romField.data.dimensions;
+				writer.Key("data"); writer.StartObject();
+				writer.Key("w"); writer.Int(dimensions[0]);
+				if (dimensions[1] > 0) {
+					writer.Key("h"); writer.Int(dimensions[1]);
+					if (dimensions[2] > 0) {
+						writer.Key("d"); writer.Int(dimensions[2]);
 					}
-					field_obj.AddMember("data", data_obj, allocator);
-					break;
 				}
+				writer.EndObject();
+				break;
+			}
 
-				case RomFields::RFT_STRING_MULTI: {
-					// TODO: Act like RFT_STRING if there's only one language?
-					field_obj.AddMember("type", "STRING_MULTI", allocator);
-
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-					desc_obj.AddMember("format", romField.desc.flags, allocator);
-					field_obj.AddMember("desc", desc_obj, allocator);
-
-					Value data_obj(kObjectType);	// data
-					const auto *const pStr_multi = romField.data.str_multi;
-					const auto pStr_multi_cend = pStr_multi->cend();
-					for (auto iter = pStr_multi->cbegin(); iter != pStr_multi_cend; ++iter) {
-						Value s_lc_name = lcToValue(iter->first, allocator);
-						data_obj.AddMember(s_lc_name, StringRef(iter->second), allocator);
-					}
-
-					field_obj.AddMember("data", data_obj, allocator);
-					break;
+			case RomFields::RFT_STRING_MULTI: {
+				// TODO: Act like RFT_STRING if there's only one language?
+				writer.Key("type"); writer.String("STRING_MULTI");
+
+				writer.Key("desc"); writer.StartObject();
+				writeDescName(writer, romField);
+				writer.Key("format"); writer.Uint(romField.desc.flags);
+				writer.EndObject();
+
+				writer.Key("data"); writer.StartObject();
+				const auto *const pStr_multi = romField.data.str_multi;
+				const auto pStr_multi_cend = pStr_multi->cend();
+				for (auto iter = pStr_multi->cbegin(); iter != pStr_multi_cend; ++iter) {
+					writeLCKey(writer, iter->first);
+					writeString(writer, iter->second);
 				}
+				writer.EndObject();
+				break;
+			}
 
-				default: {
-					assert(!"Unknown RomFieldType");
-					field_obj.AddMember("type", "NYI", allocator);
+			default: {
+				assert(!"Unknown RomFieldType");
+				writer.Key("type"); writer.String("NYI");
 
-					Value desc_obj(kObjectType);	// desc
-					desc_obj.AddMember("name", StringRef(romField.name), allocator);
-					field_obj.AddMember("desc", desc_obj, allocator);
-					break;
-				}
+				writer.Key("desc"); writer.StartObject();
+				writeDescName(writer, romField);
+				writer.EndObject();
+				break;
 			}
-
-			fields_array.PushBack(field_obj, allocator);
 		}
+
+		writer.EndObject();
 	}
-};
 
+public:
+	/**
+	 * Write the "fields" array.
+	 * Nothing is written if there are no valid fields.
+	 * @param writer JSON writer
+	 */
+	void writeToJSON(JSONWriter &writer)
+	{
+		bool started = false;
+		const auto fields_cend = fields.cend();
+		for (auto iter = fields.cbegin(); iter != fields_cend; ++iter) {
+			const auto &romField = *iter;
+			if (!romField.isValid)
+				continue;
+
+			if (!started) {
+				writer.Key("fields");
+				writer.StartArray();
+				started = true;
+			}
+			writeField(writer, romField);
+		}
 
-JSONROMOutput::JSONROMOutput(const RomData *romdata, uint32_t lc)
-	: romdata(romdata)
-	, lc(lc)
-	, crlf_(false) { }
-std::ostream& operator<<(std::ostream& os, const JSONROMOutput& fo) {
-	auto romdata = fo.romdata;
-	assert(romdata && romdata->isValid());
+		if (started) {
+			writer.EndArray();
+		}
+	}
+};
 
+/**
+ * Write a RomData object to a RapidJSON SAX writer.
+ * @param writer JSON writer
+ * @param romdata RomData object
+ */
+template<typename JSONWriter>
+static void writeRomData(JSONWriter &writer, const RomData *romdata)
+{
 	const char *const systemName = romdata->systemName(RomData::SYSNAME_TYPE_LONG | RomData::SYSNAME_REGION_ROM_LOCAL);
 	const char *const fileType = romdata->fileType_string();
 	assert(systemName != nullptr);
 	assert(fileType != nullptr);
 
-	Document document;
-	document.SetObject();	// document should be an object, not an array
-	Document::AllocatorType& allocator = document.GetAllocator();
-	document.AddMember("system", StringRef(systemName ? systemName : "unknown"), allocator);
-	document.AddMember("filetype", StringRef(fileType ? fileType : "unknown"), allocator);
+	writer.StartObject();	// document should be an object, not an array
+	writer.Key("system"); writer.String(systemName ? systemName : "unknown");
+	writer.Key("filetype"); writer.String(fileType ? fileType : "unknown");
 
 	// Fields.
 	const RomFields *const fields = romdata->fields();
 	assert(fields != nullptr);
 	if (fields) {
-		Value fields_array(kArrayType);	// fields
-		JSONFieldsOutput<Document::AllocatorType>(*fields).writeToJSON(fields_array, allocator);
-		if (!fields_array.Empty()) {
-			document.AddMember("fields", fields_array, allocator);
-		}
+		JSONFieldsOutput<JSONWriter>(*fields).writeToJSON(writer);
 	}
 
 	// Internal images.
 	const uint32_t imgbf = romdata->supportedImageTypes();
 	if (imgbf != 0) {
-		Value imgint_array(kArrayType);	// imgint
-
+		bool started = false;	// imgint
 		for (int i = RomData::IMG_INT_MIN; i <= RomData::IMG_INT_MAX; i++) {
 			if (!(imgbf & (1U << i)))
 				continue;
@@ -380,48 +484,54 @@ std::ostream& operator<<(std::ostream& os, const JSONROMOutput& fo) {
 			if (!image || !image->isValid())
 				continue;
 
-			Value imgint_obj(kObjectType);
-			imgint_obj.AddMember("type", StringRef(RomData::getImageTypeName((RomData::ImageType)i)), allocator);
-			imgint_obj.AddMember("format", StringRef(rp_image::getFormatName(image->format())), allocator);
+			if (!started) {
+				writer.Key("imgint");
+				writer.StartArray();
+				started = true;
+			}
+
+			writer.StartObject();
+			writer.Key("type"); writer.String(RomData::getImageTypeName((RomData::ImageType)i));
+			writer.Key("format"); writer.String(rp_image::getFormatName(image->format()));
 
-			Value size_array(kArrayType);	// size
-			size_array.PushBack(image->width(), allocator);
-			size_array.PushBack(image->height(), allocator);
-			imgint_obj.AddMember("size", size_array, allocator);
+			writer.Key("size"); writer.StartArray();
+			writer.Int(image->width());
+			writer.Int(image->height());
+			writer.EndArray();
 
 			const uint32_t ppf = romdata->imgpf((RomData::ImageType)i);
 			if (ppf) {
-				imgint_obj.AddMember("postprocessing", ppf, allocator);
+				writer.Key("postprocessing"); writer.Uint(ppf);
 			}
 
 			if (ppf & RomData::IMGPF_ICON_ANIMATED) {
 				auto animdata = romdata->iconAnimData();
 				if (animdata) {
-					imgint_obj.AddMember("frames", animdata->count, allocator);
+					writer.Key("frames"); writer.Int(animdata->count);
 
-					Value animseq(kArrayType);	// sequence
+					writer.Key("sequence"); writer.StartArray();
 					for (int j = 0; j < animdata->seq_count; j++) {
-						animseq.PushBack((unsigned)animdata->seq_index[j], allocator);
+						writer.Uint((unsigned)animdata->seq_index[j]);
 					}
-					imgint_obj.AddMember("sequence", animseq, allocator);
+					writer.EndArray();
 
-					Value animdelay(kArrayType);	// delay
+					writer.Key("delay"); writer.StartArray();
 					for (int j = 0; j < animdata->seq_count; j++) {
-						animdelay.PushBack(animdata->delays[j].ms, allocator);
+						writer.Int(animdata->delays[j].ms);
 					}
-					imgint_obj.AddMember("delay", animdelay, allocator);
+					writer.EndArray();
 				}
 			}
 
-			imgint_array.PushBack(imgint_obj, allocator);
+			writer.EndObject();
 		}
-		if (!imgint_array.Empty()) {
-			document.AddMember("imgint", imgint_array, allocator);
+		if (started) {
+			writer.EndArray();
 		}
 
 		// External images.
 		// NOTE: IMGPF_ICON_ANIMATED won't ever appear in external image
-		Value imgext_array(kArrayType);	// imgext
+		started = false;	// imgext
 		vector<RomData::ExtURL> extURLs;
 		for (int i = RomData::IMG_EXT_MIN; i <= RomData::IMG_EXT_MAX; i++) {
 			if (!(imgbf & (1U << i)))
@@ -437,35 +547,63 @@ std::ostream& operator<<(std::ostream& os, const JSONROMOutput& fo) {
 			if (ret != 0 || extURLs.empty())
 				continue;
 
-			Value imgext_obj(kObjectType);
-			imgext_obj.AddMember("type", StringRef(RomData::getImageTypeName((RomData::ImageType)i)), allocator);
+			if (!started) {
+				writer.Key("imgext");
+				writer.StartArray();
+				started = true;
+			}
+
+			writer.StartObject();
+			writer.Key("type"); writer.String(RomData::getImageTypeName((RomData::ImageType)i));
 
-			Value exturls_obj(kObjectType);
+			writer.Key("exturls"); writer.StartObject();
 			const auto extURLs_cend = extURLs.cend();
 			for (auto iter = extURLs.cbegin(); iter != extURLs_cend; ++iter) {
-				Value url_val;
 				const string url_str = urlPartialUnescape(iter->url);
-				url_val.SetString(url_str, allocator);
-				exturls_obj.AddMember("url", url_val, allocator);
-
-				Value cache_key_val;
-				cache_key_val.SetString(iter->cache_key, allocator);
-				exturls_obj.AddMember("cache_key", cache_key_val, allocator);
+				writer.Key("url");
+				writer.String(url_str.data(), static_cast<SizeType>(url_str.size()));
+				writer.Key("cache_key");
+				writer.String(iter->cache_key.data(), static_cast<SizeType>(iter->cache_key.size()));
 			}
-			imgext_obj.AddMember("exturls", exturls_obj, allocator);
-			imgext_array.PushBack(imgext_obj, allocator);
+			writer.EndObject();
+			writer.EndObject();
 		}
-		if (!imgext_array.Empty()) {
-			document.AddMember("imgext", imgext_array, allocator);
+		if (started) {
+			writer.EndArray();
 		}
 	}
 
-	OStreamWrapper oswr(os);
-	PrettyWriter<OStreamWrapper> writer(oswr);
-	writer.SetNewlineMode(fo.crlf_);
-	document.Accept(writer);
+	writer.EndObject();
+}
 
-	os.flush();
+JSONROMOutput::JSONROMOutput(const RomData *romdata, uint32_t lc)
+	: romdata(romdata)
+	, lc(lc)
+	, crlf_(false)
+	, compact_(false) { }
+std::ostream& operator<<(std::ostream& os, const JSONROMOutput& fo) {
+	auto romdata = fo.romdata;
+	assert(romdata && romdata->isValid());
+
+	// The JSON is written directly to the stream as the
+	// RomData object is walked, without building a DOM.
+	BufferedOStreamWrapper oswr(os);
+	if (fo.compact_) {
+		// Compact output: one line, no whitespace.
+		Writer<BufferedOStreamWrapper> writer(oswr);
+		writeRomData(writer, romdata);
+	} else {
+		PrettyWriter<BufferedOStreamWrapper> writer(oswr);
+		writer.SetNewlineMode(fo.crlf_);
+		writeRomData(writer, romdata);
+	}
+	oswr.Flush();
+
+	if (!fo.compact_) {
+		// NOTE: Compact output is usually used for batches,
+		// so the caller decides when to flush the stream.
+		os.flush();
+	}
 	return os;
 }
 
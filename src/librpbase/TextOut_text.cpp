@@ -171,7 +171,7 @@ public:
 		auto romField = field.romField;
 		os << ColonPad(field.width, romField.name.c_str());
 		if (romField.data.str) {
-			os << SafeString(romField.data.str, true, field.width);
+			os << SafeString(romField.data.str.ptr, romField.data.str.len, true, field.width);
 		} else {
 			// Empty string.
 			os << "''";
@@ -260,8 +260,8 @@ public:
 		// NOTE: listDataDesc.names can be nullptr,
 		// which means we don't have any column headers.
 
-		// Get the ListData_t container.
-		const RomFields::ListData_t *pListData = nullptr;
+		// Get the ListDataView_t container.
+		const RomFields::ListDataView_t *pListData = nullptr;
 		if (listDataDesc.flags & RomFields::RFT_LISTDATA_MULTI) {
 			// ROM must have set a default language code.
 			assert(field.def_lc != 0);
@@ -271,7 +271,7 @@ public:
 			assert(pListData_multi != nullptr);
 			assert(!pListData_multi->empty());
 			if (pListData_multi && !pListData_multi->empty()) {
-				// Get the ListData_t.
+				// Get the ListDataView_t.
 				pListData = RomFields::getFromListDataMulti(pListData_multi, field.def_lc, field.user_lc);
 			}
 		} else {
@@ -459,7 +459,7 @@ public:
 					string str;
 					if (nl_count[row] == 0) {
 						// No newlines. Print the string directly.
-						str = SafeString(*jt, false);
+						str = SafeString(jt->c_str(), jt->size(), false);
 					} else if (linePos[col] == (unsigned int)string::npos) {
 						// End of string.
 					} else {
@@ -18,6 +18,14 @@ using std::unordered_map;
 
 #include "RomData.hpp"
 
+// librpfile
+#include "librpfile/GzReader.hpp"
+using LibRpFile::GzReader;
+
+// librpthreads
+#include "librpthreads/ThreadPool.hpp"
+using LibRpThreads::ThreadPool;
+
 namespace LibRpBase {
 
 class ConfigPrivate : public ConfReaderPrivate
@@ -81,6 +89,10 @@ class ConfigPrivate : public ConfReaderPrivate
 		bool useIntIconForSmallSizes;
 		bool downloadHighResScans;
 		bool storeFileOriginInfo;
+		uint8_t maxParallelDownloads;
+		unsigned int cacheMaxSize;		// MiB (0 == unlimited)
+		unsigned int cacheMaxEntries;		// 0 == unlimited
+		unsigned int cacheRevalidateDays;	// 0 == never
 
 		// DMG title screen mode. [index is ROM type]
 		Config::DMG_TitleScreen_Mode dmgTSMode[Config::DMG_TitleScreen_Mode::DMG_TS_MAX];
@@ -88,6 +100,9 @@ class ConfigPrivate : public ConfReaderPrivate
 		// Other options.
 		bool showDangerousPermissionsOverlayIcon;
 		bool enableThumbnailOnNetworkFS;
+		bool enableRomDataIndex;
+		bool enableGzipIndexCache;
+		unsigned int maxThreads;	// 0 == number of CPUs
 };
 
 /** ConfigPrivate **/
@@ -122,10 +137,19 @@ ConfigPrivate::ConfigPrivate()
 	, useIntIconForSmallSizes(true)
 	, downloadHighResScans(true)
 	, storeFileOriginInfo(true)
+	, maxParallelDownloads(4)
+	, cacheMaxSize(512)
+	, cacheMaxEntries(0)
+	, cacheRevalidateDays(30)
 	/* Overlay icon */
 	, showDangerousPermissionsOverlayIcon(true)
 	/* Enable thumbnailing and metadata on network FS */
 	, enableThumbnailOnNetworkFS(false)
+	/* ROM data index */
+	, enableRomDataIndex(false)
+	, enableGzipIndexCache(false)
+	/* Thread pool */
+	, maxThreads(0)
 {
 	// NOTE: Configuration is also initialized in the reset() function.
 	memset(dmgTSMode, 0, sizeof(dmgTSMode));
@@ -152,6 +176,10 @@ void ConfigPrivate::reset(void)
 	useIntIconForSmallSizes = true;
 	downloadHighResScans = true;
 	storeFileOriginInfo = true;
+	maxParallelDownloads = 4;
+	cacheMaxSize = 512;
+	cacheMaxEntries = 0;
+	cacheRevalidateDays = 30;
 
 	// DMG title screen mode.
 	dmgTSMode[Config::DMG_TitleScreen_Mode::DMG_TS_DMG] = Config::DMG_TitleScreen_Mode::DMG_TS_DMG;
@@ -162,6 +190,11 @@ void ConfigPrivate::reset(void)
 	showDangerousPermissionsOverlayIcon = true;
 	// Enable thumbnail and metadata on network FS
 	enableThumbnailOnNetworkFS = false;
+	// ROM data index
+	enableRomDataIndex = false;
+	enableGzipIndexCache = false;
+	// Thread pool
+	maxThreads = 0;
 }
 
 /**
@@ -188,7 +221,49 @@ int ConfigPrivate::processConfigLine(const char *section, const char *name, cons
 
 	// Which section are we in?
 	if (!strcasecmp(section, "Downloads")) {
-		// Downloads. Check for one of the three boolean options.
+		if (!strcasecmp(name, "MaxParallelDownloads")) {
+			// Maximum number of simultaneous downloads. (1-16)
+			char *endptr = nullptr;
+			const long val = strtol(value, &endptr, 10);
+			if (*endptr == '\0' && val >= 1 && val <= 16) {
+				maxParallelDownloads = static_cast<uint8_t>(val);
+			} else {
+				// TODO: Show a warning or something?
+			}
+			return 1;
+		}
+
+		// Check for one of the cache policy options.
+		unsigned int *uparam;
+		long maxval;
+		if (!strcasecmp(name, "CacheMaxSize")) {
+			// Maximum cache size, in MiB. (0 == unlimited)
+			uparam = &cacheMaxSize;
+			maxval = 1024L*1024L;
+		} else if (!strcasecmp(name, "CacheMaxEntries")) {
+			// Maximum number of cache files. (0 == unlimited)
+			uparam = &cacheMaxEntries;
+			maxval = 100000000L;
+		} else if (!strcasecmp(name, "CacheRevalidateDays")) {
+			// Revalidation period, in days. (0 == never)
+			uparam = &cacheRevalidateDays;
+			maxval = 36500L;
+		} else {
+			uparam = nullptr;
+			maxval = 0;
+		}
+		if (uparam) {
+			char *endptr = nullptr;
+			const long val = strtol(value, &endptr, 10);
+			if (*endptr == '\0' && val >= 0 && val <= maxval) {
+				*uparam = static_cast<unsigned int>(val);
+			} else {
+				// TODO: Show a warning or something?
+			}
+			return 1;
+		}
+
+		// Check for one of the boolean options.
 		bool *param;
 		if (!strcasecmp(name, "ExtImageDownload")) {
 			param = &extImgDownloadEnabled;
@@ -243,11 +318,27 @@ int ConfigPrivate::processConfigLine(const char *section, const char *name, cons
 		dmgTSMode[dmg_key] = dmg_value;
 	} else if (!strcasecmp(section, "Options")) {
 		// Options.
+		if (!strcasecmp(name, "MaxThreads")) {
+			// Maximum number of threads for parallel tasks. (0 == number of CPUs)
+			char *endptr = nullptr;
+			const long val = strtol(value, &endptr, 10);
+			if (*endptr == '\0' && val >= 0 && val <= 256) {
+				maxThreads = static_cast<unsigned int>(val);
+			} else {
+				// TODO: Show a warning or something?
+			}
+			return 1;
+		}
+
 		bool *param;
 		if (!strcasecmp(name, "ShowDangerousPermissionsOverlayIcon")) {
 			param = &showDangerousPermissionsOverlayIcon;
 		} else if (!strcasecmp(name, "EnableThumbnailOnNetworkFS")) {
 			param = &enableThumbnailOnNetworkFS;
+		} else if (!strcasecmp(name, "EnableRomDataIndex")) {
+			param = &enableRomDataIndex;
+		} else if (!strcasecmp(name, "EnableGzipIndexCache")) {
+			param = &enableGzipIndexCache;
 		} else {
 			// Invalid option.
 			return 1;
@@ -434,6 +525,13 @@ Config *Config::instance(void)
 	// Load the configuration if necessary.
 	q->load(false);
 
+	// Update the thread pool limit.
+	// NOTE: The RP_MAX_THREADS environment variable takes precedence.
+	ThreadPool::setMaxThreads(q->maxThreads());
+
+	// Update the gzip index cache setting.
+	GzReader::setIndexCacheEnabled(q->enableGzipIndexCache());
+
 	// Return the singleton instance.
 	return q;
 }
@@ -557,6 +655,50 @@ bool Config::storeFileOriginInfo(void) const
 	return d->storeFileOriginInfo;
 }
 
+/**
+ * Maximum number of simultaneous downloads.
+ * NOTE: Call load() before using this function.
+ * @return Maximum number of simultaneous downloads. (1-16)
+ */
+unsigned int Config::maxParallelDownloads(void) const
+{
+	RP_D(const Config);
+	return d->maxParallelDownloads;
+}
+
+/**
+ * Maximum size of the download cache, in MiB.
+ * NOTE: Call load() before using this function.
+ * @return Maximum cache size, in MiB. (0 == unlimited)
+ */
+unsigned int Config::cacheMaxSize(void) const
+{
+	RP_D(const Config);
+	return d->cacheMaxSize;
+}
+
+/**
+ * Maximum number of files in the download cache.
+ * NOTE: Call load() before using this function.
+ * @return Maximum number of cache files. (0 == unlimited)
+ */
+unsigned int Config::cacheMaxEntries(void) const
+{
+	RP_D(const Config);
+	return d->cacheMaxEntries;
+}
+
+/**
+ * Revalidate cached downloads older than this many days.
+ * NOTE: Call load() before using this function.
+ * @return Revalidation period, in days. (0 == never)
+ */
+unsigned int Config::cacheRevalidateDays(void) const
+{
+	RP_D(const Config);
+	return d->cacheRevalidateDays;
+}
+
 /** DMG title screen mode **/
 
 /**
@@ -603,4 +745,38 @@ bool Config::enableThumbnailOnNetworkFS(void) const
 	return d->enableThumbnailOnNetworkFS;
 }
 
+/**
+ * Cache detection results, fields, and metadata in the ROM data index?
+ * NOTE: Call load() before using this function.
+ * @return True if we should use the ROM data index; false if not.
+ */
+bool Config::enableRomDataIndex(void) const
+{
+	RP_D(const Config);
+	return d->enableRomDataIndex;
+}
+
+/**
+ * Cache random-access indexes for gzipped files?
+ * NOTE: Call load() before using this function.
+ * @return True if we should cache gzip indexes; false if not.
+ */
+bool Config::enableGzipIndexCache(void) const
+{
+	RP_D(const Config);
+	return d->enableGzipIndexCache;
+}
+
+/**
+ * Maximum number of threads for parallel tasks.
+ * This includes the calling thread.
+ * NOTE: Call load() before using this function.
+ * @return Maximum number of threads. (0 == number of CPUs)
+ */
+unsigned int Config::maxThreads(void) const
+{
+	RP_D(const Config);
+	return d->maxThreads;
+}
+
 }
@@ -115,6 +115,34 @@ class Config : public ConfReader
 		 */
 		bool storeFileOriginInfo(void) const;
 
+		/**
+		 * Maximum number of simultaneous downloads.
+		 * NOTE: Call load() before using this function.
+		 * @return Maximum number of simultaneous downloads. (1-16)
+		 */
+		unsigned int maxParallelDownloads(void) const;
+
+		/**
+		 * Maximum size of the download cache, in MiB.
+		 * NOTE: Call load() before using this function.
+		 * @return Maximum cache size, in MiB. (0 == unlimited)
+		 */
+		unsigned int cacheMaxSize(void) const;
+
+		/**
+		 * Maximum number of files in the download cache.
+		 * NOTE: Call load() before using this function.
+		 * @return Maximum number of cache files. (0 == unlimited)
+		 */
+		unsigned int cacheMaxEntries(void) const;
+
+		/**
+		 * Revalidate cached downloads older than this many days.
+		 * NOTE: Call load() before using this function.
+		 * @return Revalidation period, in days. (0 == never)
+		 */
+		unsigned int cacheRevalidateDays(void) const;
+
 		/** DMG title screen mode **/
 
 		enum DMG_TitleScreen_Mode : uint8_t {
@@ -147,6 +175,28 @@ class Config : public ConfReader
 		 * @return True if we should enable; false if not.
 		 */
 		bool enableThumbnailOnNetworkFS(void) const;
+
+		/**
+		 * Cache detection results, fields, and metadata in the ROM data index?
+		 * NOTE: Call load() before using this function.
+		 * @return True if we should use the ROM data index; false if not.
+		 */
+		bool enableRomDataIndex(void) const;
+
+		/**
+		 * Cache random-access indexes for gzipped files?
+		 * NOTE: Call load() before using this function.
+		 * @return True if we should cache gzip indexes; false if not.
+		 */
+		bool enableGzipIndexCache(void) const;
+
+		/**
+		 * Maximum number of threads for parallel tasks.
+		 * This includes the calling thread.
+		 * NOTE: Call load() before using this function.
+		 * @return Maximum number of threads. (0 == number of CPUs)
+		 */
+		unsigned int maxThreads(void) const;
 };
 
 }
@@ -2,7 +2,7 @@
  * ROM Properties Page shell extension. (librpbase)                        *
  * AesCipherFactory.cpp: IAesCipher factory class.                         *
  *                                                                         *
- * Copyright (c) 2016-2019 by David Korth.                                 *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
  * SPDX-License-Identifier: GPL-2.0-or-later                               *
  ***************************************************************************/
 
@@ -18,6 +18,9 @@
 #elif defined(HAVE_NETTLE)
 # include "AesNettle.hpp"
 #endif
+#ifdef HAVE_AESNI
+# include "AesNI.hpp"
+#endif
 
 namespace LibRpBase {
 
@@ -32,6 +35,15 @@ namespace LibRpBase {
  */
 IAesCipher *AesCipherFactory::create(void)
 {
+#ifdef HAVE_AESNI
+	// Use AES-NI if the CPU supports it.
+	// It's much faster than the OS-provided implementations,
+	// since it can decrypt multiple blocks in parallel.
+	if (AesNI::isUsable()) {
+		return new AesNI();
+	}
+#endif /* HAVE_AESNI */
+
 #if defined(_WIN32)
 	// Windows: Use CryptoAPI NG if available.
 	// If not, fall back to CryptoAPI.
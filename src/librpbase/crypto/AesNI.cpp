@@ -0,0 +1,472 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * AesNI.cpp: AES decryption class using AES-NI.                           *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "config.librpbase.h"
+
+#include "AesNI.hpp"
+
+// librpcpu
+#include "librpcpu/byteswap_rp.h"
+#include "librpcpu/cpuflags_x86.h"
+
+// AES-NI intrinsics.
+#include <emmintrin.h>
+#include <wmmintrin.h>
+
+// AES block size.
+#define AES_BLOCK_SIZE 16
+
+// Number of blocks to process at once.
+// AES-NI instructions have a latency of several cycles,
+// but multiple independent blocks can be processed in
+// parallel. This is only possible with ECB, CBC decryption,
+// and CTR, since CBC encryption has a serial dependency.
+#define AESNI_BLOCKS 8
+
+namespace LibRpBase {
+
+class AesNIPrivate
+{
+	public:
+		AesNIPrivate();
+		~AesNIPrivate() { }
+
+	private:
+		RP_DISABLE_COPY(AesNIPrivate)
+
+	public:
+		// Round keys.
+		// Stored as bytes because the private class
+		// may not be 16-byte aligned.
+		// - enc_keys: Encryption. (used for CTR)
+		// - dec_keys: Decryption. (used for ECB and CBC)
+		uint8_t enc_keys[15][AES_BLOCK_SIZE];
+		uint8_t dec_keys[15][AES_BLOCK_SIZE];
+
+		// Number of rounds. (10, 12, or 14; 0 if no key is set)
+		int rounds;
+
+		// CBC: Initialization vector.
+		// CTR: Counter.
+		uint8_t iv[AES_BLOCK_SIZE];
+
+		IAesCipher::ChainingMode chainingMode;
+
+		// AES S-box. (used for key expansion)
+		static const uint8_t sbox[256];
+
+		/**
+		 * Expand the encryption key into the round keys.
+		 * @param pKey	[in] Key data.
+		 * @param size	[in] Size of pKey, in bytes. (16, 24, or 32)
+		 */
+		void expandKey(const uint8_t *RESTRICT pKey, size_t size);
+
+	public:
+		/**
+		 * Decrypt data using ECB.
+		 * @param pData	[in/out] Data.
+		 * @param blocks	[in] Number of 16-byte blocks.
+		 */
+		void decrypt_ECB(uint8_t *RESTRICT pData, size_t blocks) const;
+
+		/**
+		 * Decrypt data using CBC.
+		 * The IV is updated for the next call.
+		 * @param pData	[in/out] Data.
+		 * @param blocks	[in] Number of 16-byte blocks.
+		 */
+		void decrypt_CBC(uint8_t *RESTRICT pData, size_t blocks);
+
+		/**
+		 * Decrypt data using CTR.
+		 * The counter is updated for the next call.
+		 * @param pData	[in/out] Data.
+		 * @param blocks	[in] Number of 16-byte blocks.
+		 */
+		void decrypt_CTR(uint8_t *RESTRICT pData, size_t blocks);
+};
+
+/** AesNIPrivate **/
+
+const uint8_t AesNIPrivate::sbox[256] = {
+	0x63,0x7C,0x77,0x7B,0xF2,0x6B,0x6F,0xC5,0x30,0x01,0x67,0x2B,0xFE,0xD7,0xAB,0x76,
+	0xCA,0x82,0xC9,0x7D,0xFA,0x59,0x47,0xF0,0xAD,0xD4,0xA2,0xAF,0x9C,0xA4,0x72,0xC0,
+	0xB7,0xFD,0x93,0x26,0x36,0x3F,0xF7,0xCC,0x34,0xA5,0xE5,0xF1,0x71,0xD8,0x31,0x15,
+	0x04,0xC7,0x23,0xC3,0x18,0x96,0x05,0x9A,0x07,0x12,0x80,0xE2,0xEB,0x27,0xB2,0x75,
+	0x09,0x83,0x2C,0x1A,0x1B,0x6E,0x5A,0xA0,0x52,0x3B,0xD6,0xB3,0x29,0xE3,0x2F,0x84,
+	0x53,0xD1,0x00,0xED,0x20,0xFC,0xB1,0x5B,0x6A,0xCB,0xBE,0x39,0x4A,0x4C,0x58,0xCF,
+	0xD0,0xEF,0xAA,0xFB,0x43,0x4D,0x33,0x85,0x45,0xF9,0x02,0x7F,0x50,0x3C,0x9F,0xA8,
+	0x51,0xA3,0x40,0x8F,0x92,0x9D,0x38,0xF5,0xBC,0xB6,0xDA,0x21,0x10,0xFF,0xF3,0xD2,
+	0xCD,0x0C,0x13,0xEC,0x5F,0x97,0x44,0x17,0xC4,0xA7,0x7E,0x3D,0x64,0x5D,0x19,0x73,
+	0x60,0x81,0x4F,0xDC,0x22,0x2A,0x90,0x88,0x46,0xEE,0xB8,0x14,0xDE,0x5E,0x0B,0xDB,
+	0xE0,0x32,0x3A,0x0A,0x49,0x06,0x24,0x5C,0xC2,0xD3,0xAC,0x62,0x91,0x95,0xE4,0x79,
+	0xE7,0xC8,0x37,0x6D,0x8D,0xD5,0x4E,0xA9,0x6C,0x56,0xF4,0xEA,0x65,0x7A,0xAE,0x08,
+	0xBA,0x78,0x25,0x2E,0x1C,0xA6,0xB4,0xC6,0xE8,0xDD,0x74,0x1F,0x4B,0xBD,0x8B,0x8A,
+	0x70,0x3E,0xB5,0x66,0x48,0x03,0xF6,0x0E,0x61,0x35,0x57,0xB9,0x86,0xC1,0x1D,0x9E,
+	0xE1,0xF8,0x98,0x11,0x69,0xD9,0x8E,0x94,0x9B,0x1E,0x87,0xE9,0xCE,0x55,0x28,0xDF,
+	0x8C,0xA1,0x89,0x0D,0xBF,0xE6,0x42,0x68,0x41,0x99,0x2D,0x0F,0xB0,0x54,0xBB,0x16
+};
+
+AesNIPrivate::AesNIPrivate()
+	: rounds(0)
+	, chainingMode(IAesCipher::ChainingMode::ECB)
+{
+	// Clear the keys.
+	memset(enc_keys, 0, sizeof(enc_keys));
+	memset(dec_keys, 0, sizeof(dec_keys));
+	memset(iv, 0, sizeof(iv));
+}
+
+/**
+ * Expand the encryption key into the round keys.
+ * @param pKey	[in] Key data.
+ * @param size	[in] Size of pKey, in bytes. (16, 24, or 32)
+ */
+void AesNIPrivate::expandKey(const uint8_t *RESTRICT pKey, size_t size)
+{
+	// FIPS-197 key expansion.
+	// AESKEYGENASSIST requires a separate code path for each
+	// key size, and key expansion isn't performance-critical,
+	// so the key schedule is calculated using regular C++ code.
+	const unsigned int nk = static_cast<unsigned int>(size / 4);
+	rounds = static_cast<int>(nk + 6);
+	const unsigned int total_words = 4 * (rounds + 1);
+
+	uint8_t *const w = &enc_keys[0][0];
+	memcpy(w, pKey, size);
+	uint8_t rcon = 0x01;
+	for (unsigned int i = nk; i < total_words; i++) {
+		uint8_t temp[4];
+		memcpy(temp, &w[(i-1)*4], 4);
+		if (i % nk == 0) {
+			// RotWord, SubWord, Rcon
+			const uint8_t t0 = temp[0];
+			temp[0] = sbox[temp[1]] ^ rcon;
+			temp[1] = sbox[temp[2]];
+			temp[2] = sbox[temp[3]];
+			temp[3] = sbox[t0];
+			rcon = (rcon << 1) ^ ((rcon & 0x80) ? 0x1B : 0x00);
+		} else if (nk > 6 && i % nk == 4) {
+			// SubWord (AES-256 only)
+			temp[0] = sbox[temp[0]];
+			temp[1] = sbox[temp[1]];
+			temp[2] = sbox[temp[2]];
+			temp[3] = sbox[temp[3]];
+		}
+		for (unsigned int j = 0; j < 4; j++) {
+			w[i*4 + j] = w[(i-nk)*4 + j] ^ temp[j];
+		}
+	}
+
+	// Decryption keys for the Equivalent Inverse Cipher:
+	// Reverse order, with InvMixColumns applied to the
+	// middle round keys.
+	memcpy(dec_keys[0], enc_keys[rounds], AES_BLOCK_SIZE);
+	for (int i = 1; i < rounds; i++) {
+		const __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(enc_keys[rounds - i]));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dec_keys[i]), _mm_aesimc_si128(k));
+	}
+	memcpy(dec_keys[rounds], enc_keys[0], AES_BLOCK_SIZE);
+}
+
+/**
+ * Load round keys into registers.
+ * @param rk	[out] Round keys.
+ * @param keys	[in] Round keys, as bytes.
+ * @param rounds	[in] Number of rounds.
+ */
+static FORCEINLINE void load_round_keys(__m128i rk[15], const uint8_t keys[15][AES_BLOCK_SIZE], int rounds)
+{
+	for (int i = 0; i <= rounds; i++) {
+		rk[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys[i]));
+	}
+}
+
+/**
+ * Decrypt data using ECB.
+ * @param pData	[in/out] Data.
+ * @param blocks	[in] Number of 16-byte blocks.
+ */
+void AesNIPrivate::decrypt_ECB(uint8_t *RESTRICT pData, size_t blocks) const
+{
+	__m128i rk[15];
+	load_round_keys(rk, dec_keys, rounds);
+	__m128i *p = reinterpret_cast<__m128i*>(pData);
+
+	for (; blocks >= AESNI_BLOCKS; blocks -= AESNI_BLOCKS, p += AESNI_BLOCKS) {
+		__m128i b[AESNI_BLOCKS];
+		for (int i = 0; i < AESNI_BLOCKS; i++) {
+			b[i] = _mm_xor_si128(_mm_loadu_si128(&p[i]), rk[0]);
+		}
+		for (int r = 1; r < rounds; r++) {
+			for (int i = 0; i < AESNI_BLOCKS; i++) {
+				b[i] = _mm_aesdec_si128(b[i], rk[r]);
+			}
+		}
+		for (int i = 0; i < AESNI_BLOCKS; i++) {
+			_mm_storeu_si128(&p[i], _mm_aesdeclast_si128(b[i], rk[rounds]));
+		}
+	}
+
+	// Remaining blocks.
+	for (; blocks > 0; blocks--, p++) {
+		__m128i b = _mm_xor_si128(_mm_loadu_si128(p), rk[0]);
+		for (int r = 1; r < rounds; r++) {
+			b = _mm_aesdec_si128(b, rk[r]);
+		}
+		_mm_storeu_si128(p, _mm_aesdeclast_si128(b, rk[rounds]));
+	}
+}
+
+/**
+ * Decrypt data using CBC.
+ * The IV is updated for the next call.
+ * @param pData	[in/out] Data.
+ * @param blocks	[in] Number of 16-byte blocks.
+ */
+void AesNIPrivate::decrypt_CBC(uint8_t *RESTRICT pData, size_t blocks)
+{
+	__m128i rk[15];
+	load_round_keys(rk, dec_keys, rounds);
+	__m128i *p = reinterpret_cast<__m128i*>(pData);
+	__m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv));
+
+	for (; blocks >= AESNI_BLOCKS; blocks -= AESNI_BLOCKS, p += AESNI_BLOCKS) {
+		__m128i c[AESNI_BLOCKS], b[AESNI_BLOCKS];
+		for (int i = 0; i < AESNI_BLOCKS; i++) {
+			c[i] = _mm_loadu_si128(&p[i]);
+			b[i] = _mm_xor_si128(c[i], rk[0]);
+		}
+		for (int r = 1; r < rounds; r++) {
+			for (int i = 0; i < AESNI_BLOCKS; i++) {
+				b[i] = _mm_aesdec_si128(b[i], rk[r]);
+			}
+		}
+		_mm_storeu_si128(&p[0], _mm_xor_si128(_mm_aesdeclast_si128(b[0], rk[rounds]), prev));
+		for (int i = 1; i < AESNI_BLOCKS; i++) {
+			_mm_storeu_si128(&p[i], _mm_xor_si128(_mm_aesdeclast_si128(b[i], rk[rounds]), c[i-1]));
+		}
+		prev = c[AESNI_BLOCKS-1];
+	}
+
+	// Remaining blocks.
+	for (; blocks > 0; blocks--, p++) {
+		const __m128i c = _mm_loadu_si128(p);
+		__m128i b = _mm_xor_si128(c, rk[0]);
+		for (int r = 1; r < rounds; r++) {
+			b = _mm_aesdec_si128(b, rk[r]);
+		}
+		_mm_storeu_si128(p, _mm_xor_si128(_mm_aesdeclast_si128(b, rk[rounds]), prev));
+		prev = c;
+	}
+
+	// Save the IV for the next call.
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(iv), prev);
+}
+
+/**
+ * Decrypt data using CTR.
+ * The counter is updated for the next call.
+ * @param pData	[in/out] Data.
+ * @param blocks	[in] Number of 16-byte blocks.
+ */
+void AesNIPrivate::decrypt_CTR(uint8_t *RESTRICT pData, size_t blocks)
+{
+	__m128i rk[15];
+	load_round_keys(rk, enc_keys, rounds);
+	__m128i *p = reinterpret_cast<__m128i*>(pData);
+
+	// The counter is a 128-bit big-endian value.
+	uint64_t ctr_hi, ctr_lo;
+	memcpy(&ctr_hi, &iv[0], sizeof(ctr_hi));
+	memcpy(&ctr_lo, &iv[8], sizeof(ctr_lo));
+	ctr_hi = be64_to_cpu(ctr_hi);
+	ctr_lo = be64_to_cpu(ctr_lo);
+
+	while (blocks > 0) {
+		const unsigned int n = (blocks >= AESNI_BLOCKS
+			? AESNI_BLOCKS : static_cast<unsigned int>(blocks));
+
+		// Generate the keystream.
+		__m128i b[AESNI_BLOCKS];
+		for (unsigned int i = 0; i < n; i++) {
+			b[i] = _mm_set_epi64x(
+				static_cast<int64_t>(cpu_to_be64(ctr_lo)),
+				static_cast<int64_t>(cpu_to_be64(ctr_hi)));
+			b[i] = _mm_xor_si128(b[i], rk[0]);
+			if (++ctr_lo == 0) {
+				ctr_hi++;
+			}
+		}
+		for (int r = 1; r < rounds; r++) {
+			for (unsigned int i = 0; i < n; i++) {
+				b[i] = _mm_aesenc_si128(b[i], rk[r]);
+			}
+		}
+		for (unsigned int i = 0; i < n; i++) {
+			const __m128i ks = _mm_aesenclast_si128(b[i], rk[rounds]);
+			_mm_storeu_si128(&p[i], _mm_xor_si128(_mm_loadu_si128(&p[i]), ks));
+		}
+
+		blocks -= n;
+		p += n;
+	}
+
+	// Save the counter for the next call.
+	ctr_hi = cpu_to_be64(ctr_hi);
+	ctr_lo = cpu_to_be64(ctr_lo);
+	memcpy(&iv[0], &ctr_hi, sizeof(ctr_hi));
+	memcpy(&iv[8], &ctr_lo, sizeof(ctr_lo));
+}
+
+/** AesNI **/
+
+AesNI::AesNI()
+	: d_ptr(new AesNIPrivate())
+{ }
+
+AesNI::~AesNI()
+{
+	delete d_ptr;
+}
+
+/**
+ * Is AES-NI usable on this system?
+ * @return True if the CPU supports AES-NI.
+ */
+bool AesNI::isUsable(void)
+{
+	return !!RP_CPU_HasAESNI();
+}
+
+/**
+ * Get the name of the AesCipher implementation.
+ * @return Name.
+ */
+const char *AesNI::name(void) const
+{
+	return "AES-NI";
+}
+
+/**
+ * Has the cipher been initialized properly?
+ * @return True if initialized; false if not.
+ */
+bool AesNI::isInit(void) const
+{
+	// AES-NI works if the CPU supports it.
+	return isUsable();
+}
+
+/**
+ * Set the encryption key.
+ * @param pKey	[in] Key data.
+ * @param size	[in] Size of pKey, in bytes.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AesNI::setKey(const uint8_t *RESTRICT pKey, size_t size)
+{
+	// Acceptable key lengths:
+	// - 16 (AES-128)
+	// - 24 (AES-192)
+	// - 32 (AES-256)
+	if (!pKey || !(size == 16 || size == 24 || size == 32)) {
+		return -EINVAL;
+	} else if (!isUsable()) {
+		return -ENOTSUP;
+	}
+
+	RP_D(AesNI);
+	d->expandKey(pKey, size);
+	return 0;
+}
+
+/**
+ * Set the cipher chaining mode.
+ *
+ * Note that the IV/counter must be set *after* setting
+ * the chaining mode; otherwise, setIV() will fail.
+ *
+ * @param mode Cipher chaining mode.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AesNI::setChainingMode(ChainingMode mode)
+{
+	if (mode < ChainingMode::ECB || mode >= ChainingMode::Max) {
+		return -EINVAL;
+	}
+
+	RP_D(AesNI);
+	d->chainingMode = mode;
+	return 0;
+}
+
+/**
+ * Set the IV (CBC mode) or counter (CTR mode).
+ * @param pIV	[in] IV/counter data.
+ * @param size	[in] Size of pIV, in bytes.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int AesNI::setIV(const uint8_t *RESTRICT pIV, size_t size)
+{
+	RP_D(AesNI);
+	if (!pIV || size != AES_BLOCK_SIZE ||
+	    d->chainingMode < ChainingMode::CBC || d->chainingMode >= ChainingMode::Max)
+	{
+		// Invalid parameters and/or chaining mode.
+		return -EINVAL;
+	}
+
+	// Set the IV/counter.
+	memcpy(d->iv, pIV, AES_BLOCK_SIZE);
+	return 0;
+}
+
+/**
+ * Decrypt a block of data.
+ * @param pData	[in/out] Data block.
+ * @param size	[in] Length of data block. (Must be a multiple of 16.)
+ * @return Number of bytes decrypted on success; 0 on error.
+ */
+size_t AesNI::decrypt(uint8_t *RESTRICT pData, size_t size)
+{
+	if (!pData || size == 0 || (size % AES_BLOCK_SIZE != 0)) {
+		// Invalid parameters.
+		return 0;
+	}
+
+	RP_D(AesNI);
+	if (d->rounds == 0) {
+		// No key set...
+		return 0;
+	}
+
+	const size_t blocks = size / AES_BLOCK_SIZE;
+	switch (d->chainingMode) {
+		case ChainingMode::ECB:
+			d->decrypt_ECB(pData, blocks);
+			break;
+		case ChainingMode::CBC:
+			// IV is automatically updated for the next block.
+			d->decrypt_CBC(pData, blocks);
+			break;
+		case ChainingMode::CTR:
+			// Counter is automatically updated for the next block.
+			// NOTE: CTR uses the *encrypt* function, even for decryption.
+			d->decrypt_CTR(pData, blocks);
+			break;
+		default:
+			return 0;
+	}
+
+	return size;
+}
+
+}
@@ -0,0 +1,58 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Hash.cpp: Streaming hash class. (Common functions)                      *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "Hash.hpp"
+
+namespace LibRpBase {
+
+/**
+ * Get the hash length for the specified algorithm.
+ * @param algorithm Hash algorithm.
+ * @return Hash length, in bytes. (0 if the algorithm is invalid)
+ */
+size_t Hash::hashLength(Algorithm algorithm)
+{
+	static const uint8_t hash_len_tbl[] = {
+		0,	// Unknown
+		4,	// CRC32
+		16,	// MD5
+		20,	// SHA1
+	};
+	static_assert(ARRAY_SIZE(hash_len_tbl) == (size_t)Algorithm::Max,
+		"hash_len_tbl[] is out of sync with Hash::Algorithm.");
+
+	assert(algorithm < Algorithm::Max);
+	if (algorithm >= Algorithm::Max)
+		return 0;
+	return hash_len_tbl[(size_t)algorithm];
+}
+
+/**
+ * Get the name of the specified algorithm.
+ * @param algorithm Hash algorithm.
+ * @return Algorithm name, e.g. "SHA-1", or nullptr if the algorithm is invalid.
+ */
+const char *Hash::algorithmName(Algorithm algorithm)
+{
+	static const char *const algorithm_name_tbl[] = {
+		nullptr,	// Unknown
+		"CRC32",
+		"MD5",
+		"SHA-1",
+	};
+	static_assert(ARRAY_SIZE(algorithm_name_tbl) == (size_t)Algorithm::Max,
+		"algorithm_name_tbl[] is out of sync with Hash::Algorithm.");
+
+	assert(algorithm < Algorithm::Max);
+	if (algorithm >= Algorithm::Max)
+		return nullptr;
+	return algorithm_name_tbl[(size_t)algorithm];
+}
+
+}
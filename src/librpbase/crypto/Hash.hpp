@@ -0,0 +1,113 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * Hash.hpp: Streaming hash class. (CRC32, MD5, SHA-1)                     *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPBASE_CRYPTO_HASH_HPP__
+#define __ROMPROPERTIES_LIBRPBASE_CRYPTO_HASH_HPP__
+
+#include "common.h"
+
+// C includes.
+#include <stddef.h>	/* size_t */
+#include <stdint.h>
+
+namespace LibRpBase {
+
+class HashPrivate;
+class Hash
+{
+	public:
+		/**
+		 * Hash algorithm.
+		 */
+		enum class Algorithm : uint8_t {
+			Unknown	= 0,
+
+			CRC32	= 1,	// 4 bytes (stored big-endian)
+			MD5	= 2,	// 16 bytes
+			SHA1	= 3,	// 20 bytes
+
+			Max
+		};
+
+		/**
+		 * Create a streaming hash object.
+		 * @param algorithm Hash algorithm.
+		 */
+		explicit Hash(Algorithm algorithm);
+		~Hash();
+
+	private:
+		RP_DISABLE_COPY(Hash)
+	private:
+		friend class HashPrivate;
+		HashPrivate *const d_ptr;
+
+	public:
+		/**
+		 * Is the hash object usable?
+		 * @return True if usable; false if not.
+		 */
+		bool isUsable(void) const;
+
+		/**
+		 * Get the hash algorithm.
+		 * @return Hash algorithm.
+		 */
+		Algorithm algorithm(void) const;
+
+		/**
+		 * Get the hash length for this object's algorithm.
+		 * @return Hash length, in bytes. (0 if not usable)
+		 */
+		size_t hashLength(void) const;
+
+		/**
+		 * Reset the hash state.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int reset(void);
+
+		/**
+		 * Process a block of data.
+		 * This can be called multiple times.
+		 * @param pData	[in] Input data.
+		 * @param len	[in] Data length.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		ATTR_ACCESS_SIZE(read_only, 2, 3)
+		int process(const void *pData, size_t len);
+
+		/**
+		 * Get the hash of all data processed so far.
+		 * The hash state is not modified, so more data can be processed afterwards.
+		 * @param pHash		[out] Output hash buffer. (Must be hashLength() bytes.)
+		 * @param hash_len	[in] Size of hash buffer.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 2, 3)
+		int getHash(uint8_t *pHash, size_t hash_len);
+
+	public:
+		/**
+		 * Get the hash length for the specified algorithm.
+		 * @param algorithm Hash algorithm.
+		 * @return Hash length, in bytes. (0 if the algorithm is invalid)
+		 */
+		static size_t hashLength(Algorithm algorithm);
+
+		/**
+		 * Get the name of the specified algorithm.
+		 * @param algorithm Hash algorithm.
+		 * @return Algorithm name, e.g. "SHA-1", or nullptr if the algorithm is invalid.
+		 */
+		static const char *algorithmName(Algorithm algorithm);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPBASE_CRYPTO_HASH_HPP__ */
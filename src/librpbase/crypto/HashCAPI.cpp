@@ -0,0 +1,258 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * HashCAPI.cpp: Streaming hash class. (Win32 CryptoAPI implementation.)   *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "Hash.hpp"
+
+// librpcpu
+#include "librpcpu/byteswap_rp.h"
+
+// libwin32common
+#include "libwin32common/RpWin32_sdk.h"
+#include "libwin32common/w32err.h"
+
+// zlib for crc32()
+#include <zlib.h>
+
+#include <wincrypt.h>
+
+namespace LibRpBase {
+
+class HashPrivate
+{
+	public:
+		explicit HashPrivate(Hash::Algorithm algorithm);
+		~HashPrivate();
+
+	private:
+		RP_DISABLE_COPY(HashPrivate)
+
+	public:
+		Hash::Algorithm algorithm;
+
+		// CRC32 is handled by zlib.
+		uint32_t crc32;
+
+		// CryptoAPI handles. (MD5, SHA-1)
+		HCRYPTPROV hProvider;
+		HCRYPTHASH hHash;
+
+		/**
+		 * Initialize the hash context.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int init(void);
+};
+
+/** HashPrivate **/
+
+HashPrivate::HashPrivate(Hash::Algorithm algorithm)
+	: algorithm(algorithm)
+	, crc32(0)
+	, hProvider(0)
+	, hHash(0)
+{
+	if (algorithm != Hash::Algorithm::CRC32) {
+		// Get a handle to the crypto provider.
+		if (!CryptAcquireContext(&hProvider, nullptr, nullptr,
+		    PROV_RSA_FULL, CRYPT_VERIFYCONTEXT | CRYPT_SILENT))
+		{
+			// Failed to get a handle to the crypto provider.
+			hProvider = 0;
+			this->algorithm = Hash::Algorithm::Unknown;
+			return;
+		}
+	}
+
+	if (init() != 0) {
+		// Unable to create the hash object.
+		this->algorithm = Hash::Algorithm::Unknown;
+	}
+}
+
+HashPrivate::~HashPrivate()
+{
+	if (hHash) {
+		CryptDestroyHash(hHash);
+	}
+	if (hProvider) {
+		CryptReleaseContext(hProvider, 0);
+	}
+}
+
+/**
+ * Initialize the hash context.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int HashPrivate::init(void)
+{
+	ALG_ID algid;
+	switch (algorithm) {
+		case Hash::Algorithm::CRC32:
+			crc32 = 0;
+			return 0;
+		case Hash::Algorithm::MD5:
+			algid = CALG_MD5;
+			break;
+		case Hash::Algorithm::SHA1:
+			algid = CALG_SHA1;
+			break;
+		default:
+			// Not supported.
+			return -ENOTSUP;
+	}
+
+	if (hHash) {
+		CryptDestroyHash(hHash);
+		hHash = 0;
+	}
+	if (!CryptCreateHash(hProvider, algid, 0, 0, &hHash)) {
+		// Error creating the hash object.
+		hHash = 0;
+		return -w32err_to_posix(GetLastError());
+	}
+	return 0;
+}
+
+/** Hash **/
+
+/**
+ * Create a streaming hash object.
+ * @param algorithm Hash algorithm.
+ */
+Hash::Hash(Algorithm algorithm)
+	: d_ptr(new HashPrivate(algorithm))
+{ }
+
+Hash::~Hash()
+{
+	delete d_ptr;
+}
+
+/**
+ * Is the hash object usable?
+ * @return True if usable; false if not.
+ */
+bool Hash::isUsable(void) const
+{
+	RP_D(const Hash);
+	return (d->algorithm != Algorithm::Unknown);
+}
+
+/**
+ * Get the hash algorithm.
+ * @return Hash algorithm.
+ */
+Hash::Algorithm Hash::algorithm(void) const
+{
+	RP_D(const Hash);
+	return d->algorithm;
+}
+
+/**
+ * Get the hash length for this object's algorithm.
+ * @return Hash length, in bytes. (0 if not usable)
+ */
+size_t Hash::hashLength(void) const
+{
+	RP_D(const Hash);
+	return hashLength(d->algorithm);
+}
+
+/**
+ * Reset the hash state.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Hash::reset(void)
+{
+	RP_D(Hash);
+	if (d->algorithm == Algorithm::Unknown)
+		return -EBADF;
+	return d->init();
+}
+
+/**
+ * Process a block of data.
+ * This can be called multiple times.
+ * @param pData	[in] Input data.
+ * @param len	[in] Data length.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Hash::process(const void *pData, size_t len)
+{
+	RP_D(Hash);
+	assert(pData != nullptr || len == 0);
+	if (!pData && len != 0) {
+		// Invalid parameters.
+		return -EINVAL;
+	}
+	if (d->algorithm == Algorithm::Unknown)
+		return -EBADF;
+
+	// Both zlib's crc32() and CryptHashData() take a 32-bit length.
+	static const size_t maxChunk = 1U << 30;
+	const uint8_t *const p8 = static_cast<const uint8_t*>(pData);
+	for (size_t pos = 0; pos < len; pos += maxChunk) {
+		const size_t chunk = (len - pos > maxChunk ? maxChunk : len - pos);
+		if (d->algorithm == Algorithm::CRC32) {
+			d->crc32 = ::crc32(d->crc32, &p8[pos], static_cast<uInt>(chunk));
+		} else if (!CryptHashData(d->hHash, &p8[pos], static_cast<DWORD>(chunk), 0)) {
+			// Error hashing the data.
+			return -w32err_to_posix(GetLastError());
+		}
+	}
+	return 0;
+}
+
+/**
+ * Get the hash of all data processed so far.
+ * The hash state is not modified, so more data can be processed afterwards.
+ * @param pHash		[out] Output hash buffer. (Must be hashLength() bytes.)
+ * @param hash_len	[in] Size of hash buffer.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Hash::getHash(uint8_t *pHash, size_t hash_len)
+{
+	RP_D(Hash);
+	if (d->algorithm == Algorithm::Unknown)
+		return -EBADF;
+	assert(pHash != nullptr);
+	assert(hash_len == hashLength(d->algorithm));
+	if (!pHash || hash_len != hashLength(d->algorithm)) {
+		// Invalid parameters.
+		return -EINVAL;
+	}
+
+	if (d->algorithm == Algorithm::CRC32) {
+		const uint32_t crc_be = cpu_to_be32(d->crc32);
+		memcpy(pHash, &crc_be, sizeof(crc_be));
+		return 0;
+	}
+
+	// NOTE: HP_HASHVAL finalizes the hash object,
+	// so we have to use a duplicate.
+	HCRYPTHASH hHashDup;
+	if (!CryptDuplicateHash(d->hHash, nullptr, 0, &hHashDup)) {
+		// Error duplicating the hash object.
+		return -w32err_to_posix(GetLastError());
+	}
+
+	int ret = 0;
+	DWORD cbHash = static_cast<DWORD>(hash_len);
+	if (!CryptGetHashParam(hHashDup, HP_HASHVAL, pHash, &cbHash, 0)) {
+		// Error getting the hash.
+		ret = -w32err_to_posix(GetLastError());
+	} else if (cbHash != static_cast<DWORD>(hash_len)) {
+		// Wrong hash length.
+		ret = -EINVAL;
+	}
+	CryptDestroyHash(hHashDup);
+	return ret;
+}
+
+}
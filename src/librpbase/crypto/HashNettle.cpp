@@ -0,0 +1,219 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase)                        *
+ * HashNettle.cpp: Streaming hash class. (GNU Nettle implementation.)      *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "Hash.hpp"
+
+// librpcpu
+#include "librpcpu/byteswap_rp.h"
+
+// zlib for crc32()
+#include <zlib.h>
+
+// Nettle hash functions.
+#include <nettle/md5.h>
+#include <nettle/sha1.h>
+
+namespace LibRpBase {
+
+class HashPrivate
+{
+	public:
+		explicit HashPrivate(Hash::Algorithm algorithm);
+
+	private:
+		RP_DISABLE_COPY(HashPrivate)
+
+	public:
+		Hash::Algorithm algorithm;
+
+		// Hash context.
+		union {
+			uint32_t crc32;
+			struct md5_ctx md5;
+			struct sha1_ctx sha1;
+		} ctx;
+
+		/**
+		 * Initialize the hash context.
+		 */
+		void init(void);
+};
+
+/** HashPrivate **/
+
+HashPrivate::HashPrivate(Hash::Algorithm algorithm)
+	: algorithm(algorithm)
+{
+	init();
+}
+
+/**
+ * Initialize the hash context.
+ */
+void HashPrivate::init(void)
+{
+	switch (algorithm) {
+		case Hash::Algorithm::CRC32:
+			ctx.crc32 = 0;
+			break;
+		case Hash::Algorithm::MD5:
+			md5_init(&ctx.md5);
+			break;
+		case Hash::Algorithm::SHA1:
+			sha1_init(&ctx.sha1);
+			break;
+		default:
+			// Not supported.
+			algorithm = Hash::Algorithm::Unknown;
+			break;
+	}
+}
+
+/** Hash **/
+
+/**
+ * Create a streaming hash object.
+ * @param algorithm Hash algorithm.
+ */
+Hash::Hash(Algorithm algorithm)
+	: d_ptr(new HashPrivate(algorithm))
+{ }
+
+Hash::~Hash()
+{
+	delete d_ptr;
+}
+
+/**
+ * Is the hash object usable?
+ * @return True if usable; false if not.
+ */
+bool Hash::isUsable(void) const
+{
+	RP_D(const Hash);
+	return (d->algorithm != Algorithm::Unknown);
+}
+
+/**
+ * Get the hash algorithm.
+ * @return Hash algorithm.
+ */
+Hash::Algorithm Hash::algorithm(void) const
+{
+	RP_D(const Hash);
+	return d->algorithm;
+}
+
+/**
+ * Get the hash length for this object's algorithm.
+ * @return Hash length, in bytes. (0 if not usable)
+ */
+size_t Hash::hashLength(void) const
+{
+	RP_D(const Hash);
+	return hashLength(d->algorithm);
+}
+
+/**
+ * Reset the hash state.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Hash::reset(void)
+{
+	RP_D(Hash);
+	if (d->algorithm == Algorithm::Unknown)
+		return -EBADF;
+	d->init();
+	return 0;
+}
+
+/**
+ * Process a block of data.
+ * This can be called multiple times.
+ * @param pData	[in] Input data.
+ * @param len	[in] Data length.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Hash::process(const void *pData, size_t len)
+{
+	RP_D(Hash);
+	assert(pData != nullptr || len == 0);
+	if (!pData && len != 0) {
+		// Invalid parameters.
+		return -EINVAL;
+	}
+
+	const uint8_t *const p8 = static_cast<const uint8_t*>(pData);
+	switch (d->algorithm) {
+		case Algorithm::CRC32: {
+			// zlib's crc32() takes a 32-bit length.
+			static const size_t maxChunk = 1U << 30;
+			for (size_t pos = 0; pos < len; pos += maxChunk) {
+				const size_t chunk = (len - pos > maxChunk ? maxChunk : len - pos);
+				d->ctx.crc32 = crc32(d->ctx.crc32, &p8[pos], static_cast<uInt>(chunk));
+			}
+			break;
+		}
+		case Algorithm::MD5:
+			md5_update(&d->ctx.md5, len, p8);
+			break;
+		case Algorithm::SHA1:
+			sha1_update(&d->ctx.sha1, len, p8);
+			break;
+		default:
+			return -EBADF;
+	}
+	return 0;
+}
+
+/**
+ * Get the hash of all data processed so far.
+ * The hash state is not modified, so more data can be processed afterwards.
+ * @param pHash		[out] Output hash buffer. (Must be hashLength() bytes.)
+ * @param hash_len	[in] Size of hash buffer.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Hash::getHash(uint8_t *pHash, size_t hash_len)
+{
+	RP_D(Hash);
+	if (d->algorithm == Algorithm::Unknown)
+		return -EBADF;
+	assert(pHash != nullptr);
+	assert(hash_len == hashLength(d->algorithm));
+	if (!pHash || hash_len != hashLength(d->algorithm)) {
+		// Invalid parameters.
+		return -EINVAL;
+	}
+
+	// NOTE: Nettle's digest functions reset the context,
+	// so we have to use a copy.
+	switch (d->algorithm) {
+		case Algorithm::CRC32: {
+			const uint32_t crc_be = cpu_to_be32(d->ctx.crc32);
+			memcpy(pHash, &crc_be, sizeof(crc_be));
+			break;
+		}
+		case Algorithm::MD5: {
+			struct md5_ctx md5 = d->ctx.md5;
+			md5_digest(&md5, hash_len, pHash);
+			break;
+		}
+		case Algorithm::SHA1: {
+			struct sha1_ctx sha1 = d->ctx.sha1;
+			sha1_digest(&sha1, hash_len, pHash);
+			break;
+		}
+		default:
+			assert(!"Unsupported hash algorithm.");
+			return -EBADF;
+	}
+	return 0;
+}
+
+}
@@ -14,6 +14,9 @@
 // librpfile
 using LibRpFile::IRpFile;
 
+// C++ STL classes.
+using std::unique_ptr;
+
 namespace LibRpBase {
 
 /**
@@ -124,6 +127,91 @@ size_t DiscReader::read(void *ptr, size_t size)
 	return ret;
 }
 
+/**
+ * Read data from the disc image at the specified position.
+ * The disc image position is not changed.
+ *
+ * This is thread-safe if the underlying file's
+ * readAt() is thread-safe.
+ *
+ * @param pos	[in] Disc image position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t DiscReader::readAt(off64_t pos, void *ptr, size_t size)
+{
+	assert(m_file != nullptr);
+	if (!m_file) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	// Constrain size based on offset and length.
+	if (pos < 0 || pos >= m_length) {
+		return 0;
+	}
+	if (pos + static_cast<off64_t>(size) > m_length) {
+		size = static_cast<size_t>(m_length - pos);
+	}
+
+	size_t ret = m_file->readAt(pos + m_offset, ptr, size);
+	m_lastError = m_file->lastError();
+	return ret;
+}
+
+/**
+ * Read multiple ranges of the disc image at once.
+ * The disc image position is not changed.
+ *
+ * The requests are passed to the underlying file's
+ * readBatch(), so they may be submitted all at once.
+ *
+ * NOTE: Output buffers must not overlap.
+ *
+ * @param reqs	[in/out] Read requests. (ret is set on return)
+ * @param count	[in] Number of read requests.
+ * @return Number of requests that were read completely.
+ */
+unsigned int DiscReader::readBatch(ReadRequest *reqs, unsigned int count)
+{
+	assert(m_file != nullptr);
+	if (!m_file) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	// Convert the disc image positions to file positions,
+	// constrained based on offset and length.
+	unique_ptr<ReadRequest[]> fileReqs(new ReadRequest[count]);
+	for (unsigned int i = 0; i < count; i++) {
+		off64_t pos = reqs[i].pos;
+		size_t size = reqs[i].size;
+		if (pos < 0 || pos >= m_length) {
+			pos = 0;
+			size = 0;
+		} else if (pos + static_cast<off64_t>(size) > m_length) {
+			size = static_cast<size_t>(m_length - pos);
+		}
+		fileReqs[i].pos = pos + m_offset;
+		fileReqs[i].ptr = reqs[i].ptr;
+		fileReqs[i].size = size;
+		fileReqs[i].ret = 0;
+	}
+
+	m_file->readBatch(fileReqs.get(), count);
+	m_lastError = m_file->lastError();
+
+	unsigned int ret = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		reqs[i].ret = fileReqs[i].ret;
+		if (reqs[i].ret == reqs[i].size) {
+			ret++;
+		}
+	}
+	return ret;
+}
+
 /**
  * Set the disc image position.
  * @param pos Disc image position.
@@ -71,6 +71,36 @@ class DiscReader : public IDiscReader
 		ATTR_ACCESS_SIZE(write_only, 2, 3)
 		size_t read(void *ptr, size_t size) override;
 
+		/**
+		 * Read data from the disc image at the specified position.
+		 * The disc image position is not changed.
+		 *
+		 * This is thread-safe if the underlying file's
+		 * readAt() is thread-safe.
+		 *
+		 * @param pos	[in] Disc image position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		size_t readAt(off64_t pos, void *ptr, size_t size) override;
+
+		/**
+		 * Read multiple ranges of the disc image at once.
+		 * The disc image position is not changed.
+		 *
+		 * The requests are passed to the underlying file's
+		 * readBatch(), so they may be submitted all at once.
+		 *
+		 * NOTE: Output buffers must not overlap.
+		 *
+		 * @param reqs	[in/out] Read requests. (ret is set on return)
+		 * @param count	[in] Number of read requests.
+		 * @return Number of requests that were read completely.
+		 */
+		unsigned int readBatch(ReadRequest *reqs, unsigned int count) override;
+
 		/**
 		 * Set the disc image position.
 		 * @param pos Disc image position.
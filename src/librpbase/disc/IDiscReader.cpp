@@ -59,6 +59,61 @@ bool IDiscReader::isOpen(void) const
 	}
 }
 
+/**
+ * Read data from the disc image at the specified position.
+ * The disc image position is not changed.
+ *
+ * The default implementation uses seek() and read(),
+ * then restores the previous position, so it is NOT
+ * thread-safe. Subclasses that override this may allow
+ * concurrent readAt() calls; see the subclass for details.
+ *
+ * @param pos	[in] Disc image position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t IDiscReader::readAt(off64_t pos, void *ptr, size_t size)
+{
+	const off64_t prev_pos = this->tell();
+
+	size_t ret = 0;
+	if (this->seek(pos) == 0) {
+		ret = this->read(ptr, size);
+	}
+	if (prev_pos >= 0) {
+		this->seek(prev_pos);
+	}
+	return ret;
+}
+
+/**
+ * Read multiple ranges of the disc image at once.
+ * The disc image position is not changed.
+ *
+ * The default implementation calls readAt() for each
+ * request, so it has the same thread-safety as readAt().
+ * Subclasses that map disc positions directly to file
+ * positions can pass the batch to IRpFile::readBatch().
+ *
+ * NOTE: Output buffers must not overlap.
+ *
+ * @param reqs	[in/out] Read requests. (ret is set on return)
+ * @param count	[in] Number of read requests.
+ * @return Number of requests that were read completely.
+ */
+unsigned int IDiscReader::readBatch(ReadRequest *reqs, unsigned int count)
+{
+	unsigned int ret = 0;
+	for (; count > 0; reqs++, count--) {
+		reqs->ret = this->readAt(reqs->pos, reqs->ptr, reqs->size);
+		if (reqs->ret == reqs->size) {
+			ret++;
+		}
+	}
+	return ret;
+}
+
 /**
  * Seek to the specified address, then read data.
  * @param pos	[in] Requested seek address.
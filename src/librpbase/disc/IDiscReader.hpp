@@ -19,9 +19,8 @@
 #include "common.h"
 #include "RefBase.hpp"
 
-namespace LibRpFile {
-	class IRpFile;
-}
+// librpfile
+#include "librpfile/IRpFile.hpp"
 
 namespace LibRpBase {
 
@@ -88,6 +87,45 @@ class IDiscReader : public RefBase
 		ATTR_ACCESS_SIZE(write_only, 2, 3)
 		virtual size_t read(void *ptr, size_t size) = 0;
 
+		/**
+		 * Read data from the disc image at the specified position.
+		 * The disc image position is not changed.
+		 *
+		 * The default implementation uses seek() and read(),
+		 * then restores the previous position, so it is NOT
+		 * thread-safe. Subclasses that override this may allow
+		 * concurrent readAt() calls; see the subclass for details.
+		 *
+		 * @param pos	[in] Disc image position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		virtual size_t readAt(off64_t pos, void *ptr, size_t size);
+
+		/**
+		 * Read request for readBatch().
+		 */
+		typedef LibRpFile::IRpFile::ReadRequest ReadRequest;
+
+		/**
+		 * Read multiple ranges of the disc image at once.
+		 * The disc image position is not changed.
+		 *
+		 * The default implementation calls readAt() for each
+		 * request, so it has the same thread-safety as readAt().
+		 * Subclasses that map disc positions directly to file
+		 * positions can pass the batch to IRpFile::readBatch().
+		 *
+		 * NOTE: Output buffers must not overlap.
+		 *
+		 * @param reqs	[in/out] Read requests. (ret is set on return)
+		 * @param count	[in] Number of read requests.
+		 * @return Number of requests that were read completely.
+		 */
+		virtual unsigned int readBatch(ReadRequest *reqs, unsigned int count);
+
 		/**
 		 * Set the disc image position.
 		 * @param pos disc image position.
@@ -68,6 +68,25 @@ void PartitionFile::close(void)
  * @return Number of bytes read.
  */
 size_t PartitionFile::read(void *ptr, size_t size)
+{
+	const size_t ret = readAt(m_pos, ptr, size);
+	m_pos += ret;
+	return ret;
+}
+
+/**
+ * Read data from the file at the specified position.
+ * The file position is not changed.
+ *
+ * This is thread-safe if the underlying IDiscReader's
+ * readAt() is thread-safe.
+ *
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t PartitionFile::readAt(off64_t pos, void *ptr, size_t size)
 {
 	if (!m_partition) {
 		m_lastError = EBADF;
@@ -75,29 +94,20 @@ size_t PartitionFile::read(void *ptr, size_t size)
 	}
 
 	// Check if size is in bounds.
-	if (m_pos > m_size - static_cast<off64_t>(size)) {
+	if (pos < 0 || pos >= m_size) {
+		// Nothing left.
+		// TODO: Set an error?
+		return 0;
+	} else if (pos > m_size - static_cast<off64_t>(size)) {
 		// Not enough data.
 		// Copy whatever's left in the file.
-		size = static_cast<size_t>(m_size - m_pos);
-		if (size == 0) {
-			// Nothing left.
-			// TODO: Set an error?
-			return 0;
-		}
-	}
-
-	m_partition->clearError();
-	int iRet = m_partition->seek(m_offset + m_pos);
-	if (iRet != 0) {
-		m_lastError = m_partition->lastError();
-		return 0;
+		size = static_cast<size_t>(m_size - pos);
 	}
 
 	size_t ret = 0;
 	if (size > 0) {
 		m_partition->clearError();
-		ret = m_partition->read(ptr, size);
-		m_pos += ret;
+		ret = m_partition->readAt(m_offset + pos, ptr, size);
 		m_lastError = m_partition->lastError();
 	}
 
@@ -55,6 +55,21 @@ class PartitionFile : public LibRpFile::IRpFile
 		ATTR_ACCESS_SIZE(write_only, 2, 3)
 		size_t read(void *ptr, size_t size) final;
 
+		/**
+		 * Read data from the file at the specified position.
+		 * The file position is not changed.
+		 *
+		 * This is thread-safe if the underlying IDiscReader's
+		 * readAt() is thread-safe.
+		 *
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		size_t readAt(off64_t pos, void *ptr, size_t size) final;
+
 		/**
 		 * Write data to the file.
 		 * (NOTE: Not valid for PartitionFile; this will always return 0.)
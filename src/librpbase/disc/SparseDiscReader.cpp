@@ -11,8 +11,9 @@
 #include "SparseDiscReader.hpp"
 #include "SparseDiscReader_p.hpp"
 
-// librpfile
+// librpfile, librpthreads
 using LibRpFile::IRpFile;
+using LibRpThreads::MutexLocker;
 
 namespace LibRpBase {
 
@@ -23,11 +24,271 @@ SparseDiscReaderPrivate::SparseDiscReaderPrivate(SparseDiscReader *q)
 	, disc_size(0)
 	, pos(-1)
 	, block_size(0)
+	, blockCacheMax(BLOCK_CACHE_AUTO)
+	, readahead(BLOCK_CACHE_READAHEAD)
+	, lruCounter(0)
+	, lastMissIdx(~0U)
+	, loadsInFlight(0)
+	, blockCacheInit(false)
 {
 	// NOTE: Can't check q->m_file here.
 
 	// disc_size, pos, and block_size must be
 	// set by the subclass.
+	// The block cache is initialized on first use.
+}
+
+/**
+ * Initialize the block cache.
+ * blockCacheMax must be set, and block_size must be valid.
+ * If blockCacheMax is BLOCK_CACHE_AUTO, the number of entries
+ * will be determined using the block size.
+ *
+ * blockCacheMutex must be locked, and no entries
+ * may be loading.
+ */
+void SparseDiscReaderPrivate::initBlockCache(void)
+{
+	assert(block_size != 0);
+	assert(loadsInFlight == 0);
+	if (blockCacheMax == BLOCK_CACHE_AUTO) {
+		// Determine the number of entries using the block size.
+		// Formats with very large blocks (e.g. WBFS, which usually
+		// has 2 MiB blocks) are better off reading partial blocks
+		// directly, so the cache is disabled for those.
+		unsigned int count = (block_size != 0 ? BLOCK_CACHE_MAX_BYTES / block_size : 0);
+		if (count > BLOCK_CACHE_MAX_ENTRIES) {
+			count = BLOCK_CACHE_MAX_ENTRIES;
+		} else if (count < BLOCK_CACHE_MIN_ENTRIES) {
+			count = 0;
+		}
+		blockCacheMax = count;
+	}
+
+	// Readahead must leave room for the block being read.
+	if (blockCacheMax == 0) {
+		readahead = 0;
+	} else if (readahead >= blockCacheMax) {
+		readahead = blockCacheMax - 1;
+	}
+
+	const BlockCacheEntry unusedEntry = {~0U, 0, 0, false};
+	blockCacheEntries.assign(blockCacheMax, unusedEntry);
+	blockCacheData.resize(static_cast<size_t>(blockCacheMax) * block_size);
+	lruCounter = 0;
+	lastMissIdx = ~0U;
+	blockCacheInit = true;
+}
+
+/**
+ * Find a block in the block cache.
+ * blockCacheMutex must be locked.
+ * @param blockIdx Block index.
+ * @return Block cache entry, or nullptr if not found.
+ */
+SparseDiscReaderPrivate::BlockCacheEntry *SparseDiscReaderPrivate::findCachedBlock(uint32_t blockIdx)
+{
+	// NOTE: The block cache is small, so a linear search is fine.
+	for (BlockCacheEntry &entry : blockCacheEntries) {
+		if (entry.blockIdx == blockIdx) {
+			return &entry;
+		}
+	}
+	return nullptr;
+}
+
+/**
+ * Reserve a block cache entry for loading a block.
+ * The least-recently used entry that isn't loading will be replaced.
+ * blockCacheMutex must be locked.
+ *
+ * The block data must be read into the entry's data area
+ * without holding blockCacheMutex, and then the entry must
+ * be released with finishCachedBlock().
+ *
+ * @param blockIdx Block index.
+ * @return Block cache entry, or nullptr if all entries are loading.
+ */
+SparseDiscReaderPrivate::BlockCacheEntry *SparseDiscReaderPrivate::reserveCachedBlock(uint32_t blockIdx)
+{
+	assert(!blockCacheEntries.empty());
+
+	// Find the least-recently used entry.
+	// Unused entries have lastUsed == 0, so they're used first.
+	BlockCacheEntry *entry = nullptr;
+	for (BlockCacheEntry &cur : blockCacheEntries) {
+		if (cur.loading)
+			continue;
+		if (!entry || cur.lastUsed < entry->lastUsed) {
+			entry = &cur;
+		}
+	}
+	if (!entry) {
+		// All entries are loading.
+		return nullptr;
+	}
+
+	entry->blockIdx = blockIdx;
+	entry->validSize = 0;
+	entry->lastUsed = ++lruCounter;
+	entry->loading = true;
+	loadsInFlight++;
+	return entry;
+}
+
+/**
+ * Finish loading a block cache entry.
+ * blockCacheMutex must be locked.
+ * @param entry Block cache entry from reserveCachedBlock().
+ * @param rd readBlock() return value.
+ * @return True if the block was loaded; false on error.
+ */
+bool SparseDiscReaderPrivate::finishCachedBlock(BlockCacheEntry *entry, int rd)
+{
+	assert(entry->loading);
+	assert(loadsInFlight > 0);
+	entry->loading = false;
+	loadsInFlight--;
+
+	if (rd <= 0) {
+		// Read error.
+		entry->blockIdx = ~0U;
+		entry->validSize = 0;
+		entry->lastUsed = 0;
+		return false;
+	}
+
+	entry->validSize = static_cast<uint32_t>(rd);
+	return true;
+}
+
+/**
+ * Read blocks ahead into the block cache.
+ * blockCacheMutex must *not* be locked.
+ * @param blockIdx Block index that was just read.
+ */
+void SparseDiscReaderPrivate::readAheadCachedBlocks(uint32_t blockIdx)
+{
+	// NOTE: Errors are ignored here, since the data
+	// might not even be needed.
+	RP_Q(SparseDiscReader);
+	const int lastError = q->m_lastError;
+	const uint32_t blockCount = static_cast<uint32_t>(
+		(disc_size + block_size - 1) / block_size);
+	for (unsigned int i = 1; i <= readahead; i++) {
+		const uint32_t raIdx = blockIdx + i;
+		if (raIdx >= blockCount)
+			break;
+
+		BlockCacheEntry *entry;
+		{
+			MutexLocker locker(blockCacheMutex);
+			if (!blockCacheInit)
+				break;
+			lastMissIdx = raIdx;
+			if (findCachedBlock(raIdx)) {
+				// Already cached, or another thread is loading it.
+				continue;
+			}
+			entry = reserveCachedBlock(raIdx);
+			if (!entry)
+				break;
+		}
+
+		const int rd = q->readBlock(raIdx, 0, cachedBlockData(entry), block_size);
+
+		MutexLocker locker(blockCacheMutex);
+		if (!finishCachedBlock(entry, rd))
+			break;
+	}
+	q->m_lastError = lastError;
+}
+
+/**
+ * Read the specified block, using the block cache if possible.
+ * Parameters are the same as SparseDiscReader::readBlock().
+ *
+ * blockCacheMutex is only held while accessing the block cache.
+ * Blocks are read without holding the mutex.
+ *
+ * @param blockIdx	[in] Block index.
+ * @param pos		[in] Starting position. (Must be >= 0 and <= the block size!)
+ * @param ptr		[out] Output data buffer.
+ * @param size		[in] Amount of data to read, in bytes. (Must be <= the block size!)
+ * @return Number of bytes read, or -1 if the block index is invalid.
+ */
+int SparseDiscReaderPrivate::readBlockCached(uint32_t blockIdx, int pos, void *ptr, size_t size)
+{
+	RP_Q(SparseDiscReader);
+	if (pos < 0 || static_cast<off64_t>(pos + size) > static_cast<off64_t>(block_size)) {
+		// Parameters are invalid.
+		// Let readBlock() handle it.
+		return q->readBlock(blockIdx, pos, ptr, size);
+	}
+
+	BlockCacheEntry *entry;
+	bool isSequential = false;
+	{
+		MutexLocker locker(blockCacheMutex);
+		if (unlikely(!blockCacheInit) && loadsInFlight == 0) {
+			// Block cache needs to be (re-)initialized.
+			// NOTE: If another thread is still loading a block into
+			// the old cache, it will be initialized on a later read.
+			initBlockCache();
+		}
+		if (!blockCacheInit || blockCacheMax == 0) {
+			// Block cache is disabled.
+			entry = nullptr;
+		} else {
+			entry = findCachedBlock(blockIdx);
+			if (entry) {
+				if (!entry->loading && static_cast<size_t>(pos) + size <= entry->validSize) {
+					// Block is cached.
+					entry->lastUsed = ++lruCounter;
+					memcpy(ptr, cachedBlockData(entry) + pos, size);
+					return static_cast<int>(size);
+				}
+
+				// Another thread is loading this block, or this is
+				// a short block. Read it directly.
+				entry = nullptr;
+			} else {
+				// Block is not cached.
+				// NOTE: The first block read doesn't count as sequential.
+				isSequential = (lastMissIdx != ~0U && blockIdx == lastMissIdx + 1);
+				lastMissIdx = blockIdx;
+				entry = reserveCachedBlock(blockIdx);
+			}
+		}
+	}
+
+	if (!entry) {
+		// Block cache is disabled, or no entries are available.
+		// Read the block directly.
+		return q->readBlock(blockIdx, pos, ptr, size);
+	}
+
+	// Read the full block into the block cache.
+	const int rd = q->readBlock(blockIdx, 0, cachedBlockData(entry), block_size);
+	{
+		MutexLocker locker(blockCacheMutex);
+		if (!finishCachedBlock(entry, rd) || static_cast<size_t>(pos) + size > entry->validSize) {
+			// Read error or short block. Read the block directly
+			// in order to get the correct error code.
+			entry = nullptr;
+		} else {
+			memcpy(ptr, cachedBlockData(entry) + pos, size);
+		}
+	}
+	if (!entry) {
+		return q->readBlock(blockIdx, pos, ptr, size);
+	}
+
+	if (isSequential && readahead > 0) {
+		// Sequential access. Read ahead.
+		readAheadCachedBlocks(blockIdx);
+	}
+	return static_cast<int>(size);
 }
 
 /** SparseDiscReader **/
@@ -51,36 +312,63 @@ SparseDiscReader::~SparseDiscReader()
  * @return Number of bytes read.
  */
 size_t SparseDiscReader::read(void *ptr, size_t size)
+{
+	RP_D(SparseDiscReader);
+	assert(d->pos >= 0);
+	if (d->pos < 0) {
+		// Disc image wasn't initialized properly.
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	const size_t ret = readAt(d->pos, ptr, size);
+	d->pos += ret;
+	return ret;
+}
+
+/**
+ * Read data from the disc image at the specified position.
+ * The disc image position is not changed.
+ *
+ * Only the block cache is protected by a mutex; blocks are
+ * read concurrently. This is thread-safe as long as the
+ * underlying file's readAt() is thread-safe.
+ *
+ * @param pos	[in] Disc image position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t SparseDiscReader::readAt(off64_t pos, void *ptr, size_t size)
 {
 	RP_D(SparseDiscReader);
 	assert(m_file != nullptr);
 	assert(d->disc_size > 0);
-	assert(d->pos >= 0);
 	assert(d->block_size != 0);
-	if (!m_file || d->disc_size <= 0 || d->pos < 0 || d->block_size == 0) {
+	if (!m_file || d->disc_size <= 0 || d->block_size == 0) {
 		// Disc image wasn't initialized properly.
 		m_lastError = EBADF;
-		return -1;
+		return 0;
 	}
 
 	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
 	size_t ret = 0;
 
 	// Are we already at the end of the disc?
-	if (d->pos >= d->disc_size) {
+	if (pos < 0 || pos >= d->disc_size) {
 		// End of the disc.
 		return 0;
 	}
 
-	// Make sure d->pos + size <= d->disc_size.
+	// Make sure pos + size <= d->disc_size.
 	// If it isn't, we'll do a short read.
-	if (d->pos + static_cast<off64_t>(size) >= d->disc_size) {
-		size = static_cast<size_t>(d->disc_size - d->pos);
+	if (pos + static_cast<off64_t>(size) >= d->disc_size) {
+		size = static_cast<size_t>(d->disc_size - pos);
 	}
 
 	// Check if we're not starting on a block boundary.
 	const uint32_t block_size = d->block_size;
-	const uint32_t blockStartOffset = d->pos % block_size;
+	const uint32_t blockStartOffset = pos % block_size;
 	if (blockStartOffset != 0) {
 		// Not a block boundary.
 		// Read the end of the block.
@@ -89,8 +377,8 @@ size_t SparseDiscReader::read(void *ptr, size_t size)
 			read_sz = static_cast<uint32_t>(size);
 		}
 
-		const unsigned int blockIdx = static_cast<unsigned int>(d->pos / block_size);
-		int rd = this->readBlock(blockIdx, blockStartOffset, ptr8, read_sz);
+		const unsigned int blockIdx = static_cast<unsigned int>(pos / block_size);
+		int rd = d->readBlockCached(blockIdx, blockStartOffset, ptr8, read_sz);
 		if (rd < 0 || rd != static_cast<int>(read_sz)) {
 			// Error reading the data.
 			return (rd > 0 ? rd : 0);
@@ -100,38 +388,56 @@ size_t SparseDiscReader::read(void *ptr, size_t size)
 		size -= read_sz;
 		ptr8 += read_sz;
 		ret += read_sz;
-		d->pos += read_sz;
+		pos += read_sz;
 	}
 
 	// Read entire blocks.
-	for (; size >= block_size;
-	    size -= block_size, ptr8 += block_size,
-	    ret += block_size, d->pos += block_size)
-	{
-		assert(d->pos % block_size == 0);
-		const unsigned int blockIdx = static_cast<unsigned int>(d->pos / block_size);
-		int rd = this->readBlock(blockIdx, 0, ptr8, block_size);
+	if (size >= static_cast<size_t>(block_size) * 2) {
+		// Multiple blocks. These are read directly instead of
+		// using the block cache, which allows subclasses to
+		// decompress the blocks concurrently.
+		assert(pos % block_size == 0);
+		const unsigned int blockIdx = static_cast<unsigned int>(pos / block_size);
+		const unsigned int blockCount = static_cast<unsigned int>(size / block_size);
+		const unsigned int blocksRead = this->readBlocks(blockIdx, blockCount, ptr8);
+		const size_t sz_read = static_cast<size_t>(blocksRead) * block_size;
+		size -= sz_read;
+		ptr8 += sz_read;
+		ret += sz_read;
+		pos += sz_read;
+		if (blocksRead != blockCount) {
+			// Error reading the data.
+			return ret;
+		}
+	} else if (size >= block_size) {
+		// Single block.
+		assert(pos % block_size == 0);
+		const unsigned int blockIdx = static_cast<unsigned int>(pos / block_size);
+		int rd = d->readBlockCached(blockIdx, 0, ptr8, block_size);
 		if (rd < 0 || rd != static_cast<int>(block_size)) {
 			// Error reading the data.
 			return ret + (rd > 0 ? rd : 0);
 		}
+		size -= block_size;
+		ptr8 += block_size;
+		ret += block_size;
+		pos += block_size;
 	}
 
 	// Check if we still have data left. (not a full block)
 	if (size > 0) {
 		// Not a full block.
-		assert(d->pos % block_size == 0);
+		assert(pos % block_size == 0);
 
 		// Read the start of the block.
-		const unsigned int blockIdx = static_cast<unsigned int>(d->pos / block_size);
-		int rd = this->readBlock(blockIdx, 0, ptr8, size);
+		const unsigned int blockIdx = static_cast<unsigned int>(pos / block_size);
+		int rd = d->readBlockCached(blockIdx, 0, ptr8, size);
 		if (rd < 0 || rd != static_cast<int>(size)) {
 			// Error reading the data.
 			return ret + (rd > 0 ? rd : 0);
 		}
 
 		ret += size;
-		d->pos += size;
 	}
 
 	// Finished reading the data.
@@ -211,6 +517,27 @@ off64_t SparseDiscReader::size(void)
 
 /** SparseDiscReader **/
 
+/**
+ * Set the block cache size.
+ *
+ * By default, the number of cached blocks is determined
+ * using the block size, and the block cache is disabled
+ * for formats with very large blocks, e.g. WBFS.
+ *
+ * @param count Maximum number of blocks to cache. (0 to disable)
+ * @param readahead Number of blocks to read ahead on sequential access.
+ */
+void SparseDiscReader::setBlockCacheSize(unsigned int count, unsigned int readahead)
+{
+	RP_D(SparseDiscReader);
+	MutexLocker locker(d->blockCacheMutex);
+	d->blockCacheMax = count;
+	d->readahead = readahead;
+	// NOTE: The block cache is reinitialized on the next read,
+	// since other threads might still be loading blocks.
+	d->blockCacheInit = false;
+}
+
 /**
  * Read the specified block.
  *
@@ -258,9 +585,37 @@ int SparseDiscReader::readBlock(uint32_t blockIdx, int pos, void *ptr, size_t si
 	}
 
 	// Read from the block.
-	size_t sz_read = m_file->seekAndRead(physBlockAddr + pos, ptr, size);
+	size_t sz_read = m_file->readAt(physBlockAddr + pos, ptr, size);
 	m_lastError = m_file->lastError();
 	return (sz_read > 0 ? (int)sz_read : -1);
 }
 
+/**
+ * Read multiple full blocks.
+ *
+ * This is used for reads that span more than one full block.
+ * The default implementation calls readBlock() for each block.
+ * Subclasses that need to decompress blocks can override this
+ * in order to decompress multiple blocks concurrently.
+ *
+ * @param blockIdx	[in] First block index.
+ * @param count		[in] Number of blocks.
+ * @param ptr		[out] Output data buffer. (Must be at least count * block_size bytes!)
+ * @return Number of full blocks read.
+ */
+unsigned int SparseDiscReader::readBlocks(uint32_t blockIdx, unsigned int count, void *ptr)
+{
+	RP_D(const SparseDiscReader);
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	const unsigned int block_size = d->block_size;
+	for (unsigned int i = 0; i < count; i++, ptr8 += block_size) {
+		int rd = this->readBlock(blockIdx + i, 0, ptr8, block_size);
+		if (rd != static_cast<int>(block_size)) {
+			// Error reading the data.
+			return i;
+		}
+	}
+	return count;
+}
+
 }
@@ -41,6 +41,37 @@ class SparseDiscReader : public IDiscReader
 		ATTR_ACCESS_SIZE(write_only, 2, 3)
 		size_t read(void *ptr, size_t size) final;
 
+		/**
+		 * Read data from the disc image at the specified position.
+		 * The disc image position is not changed.
+		 *
+		 * Only the block cache is protected by a mutex; blocks are
+		 * read concurrently. This is thread-safe as long as the
+		 * underlying file's readAt() is thread-safe.
+		 *
+		 * @param pos	[in] Disc image position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		size_t readAt(off64_t pos, void *ptr, size_t size) final;
+
+	public:
+		/** SparseDiscReader functions. **/
+
+		/**
+		 * Set the block cache size.
+		 *
+		 * By default, the number of cached blocks is determined
+		 * using the block size, and the block cache is disabled
+		 * for formats with very large blocks, e.g. WBFS.
+		 *
+		 * @param count Maximum number of blocks to cache. (0 to disable)
+		 * @param readahead Number of blocks to read ahead on sequential access.
+		 */
+		void setBlockCacheSize(unsigned int count, unsigned int readahead);
+
 		/**
 		 * Set the disc image position.
 		 * @param pos disc image position.
@@ -86,6 +117,9 @@ class SparseDiscReader : public IDiscReader
 		 * though usually it isn't needed. Override getPhysBlockAddr()
 		 * instead.
 		 *
+		 * NOTE: This may be called from multiple threads at once,
+		 * so it must not use shared buffers.
+		 *
 		 * @param blockIdx	[in] Block index.
 		 * @param pos		[in] Starting position. (Must be >= 0 and <= the block size!)
 		 * @param ptr		[out] Output data buffer.
@@ -94,6 +128,24 @@ class SparseDiscReader : public IDiscReader
 		 */
 		ATTR_ACCESS_SIZE(write_only, 4, 5)
 		virtual int readBlock(uint32_t blockIdx, int pos, void *ptr, size_t size);
+
+		/**
+		 * Read multiple full blocks.
+		 *
+		 * This is used for reads that span more than one full block.
+		 * The default implementation calls readBlock() for each block.
+		 * Subclasses that need to decompress blocks can override this
+		 * in order to decompress multiple blocks concurrently.
+		 *
+		 * NOTE: This may be called from multiple threads at once,
+		 * so it must not use shared buffers.
+		 *
+		 * @param blockIdx	[in] First block index.
+		 * @param count		[in] Number of blocks.
+		 * @param ptr		[out] Output data buffer. (Must be at least count * block_size bytes!)
+		 * @return Number of full blocks read.
+		 */
+		virtual unsigned int readBlocks(uint32_t blockIdx, unsigned int count, void *ptr);
 };
 
 }
@@ -14,6 +14,12 @@
 #include <stdint.h>
 #include "common.h"
 
+// librpthreads
+#include "librpthreads/Mutex.hpp"
+
+// C++ includes.
+#include <vector>
+
 namespace LibRpBase {
 
 class SparseDiscReader;
@@ -34,6 +40,114 @@ class SparseDiscReaderPrivate
 		off64_t disc_size;		// Virtual disc image size.
 		off64_t pos;			// Read position.
 		unsigned int block_size;	// Block size.
+
+	public:
+		/** Block cache **/
+
+		// Default block cache limits.
+		// The block cache is disabled if fewer than
+		// BLOCK_CACHE_MIN_ENTRIES blocks fit in the budget.
+		static const unsigned int BLOCK_CACHE_MAX_ENTRIES = 16;
+		static const unsigned int BLOCK_CACHE_MIN_ENTRIES = 4;
+		static const unsigned int BLOCK_CACHE_MAX_BYTES = 1024U*1024U;
+		static const unsigned int BLOCK_CACHE_READAHEAD = 2;
+		static const unsigned int BLOCK_CACHE_AUTO = ~0U;
+
+		struct BlockCacheEntry {
+			uint32_t blockIdx;	// Block index, or ~0U if unused.
+			uint32_t validSize;	// Amount of valid data. (May be short for the last block.)
+			uint64_t lastUsed;	// LRU counter value.
+			bool loading;		// True if the block is currently being read.
+		};
+
+		// Cached blocks. Block data is stored in blockCacheData,
+		// using the entry's index times block_size.
+		std::vector<BlockCacheEntry> blockCacheEntries;
+		ao::uvector<uint8_t> blockCacheData;
+
+		unsigned int blockCacheMax;	// Maximum number of cached blocks. (0 == disabled)
+		unsigned int readahead;		// Number of blocks to read ahead on sequential access.
+		uint64_t lruCounter;		// LRU counter.
+		uint32_t lastMissIdx;		// Last block index that wasn't cached.
+		unsigned int loadsInFlight;	// Number of entries being loaded.
+		bool blockCacheInit;		// True if the block cache is initialized.
+
+		// Block cache mutex.
+		// This only protects the block cache entries.
+		// Blocks are read without holding the mutex, so
+		// subclass readBlock() functions must be thread-safe.
+		LibRpThreads::Mutex blockCacheMutex;
+
+		/**
+		 * Initialize the block cache.
+		 * blockCacheMax must be set, and block_size must be valid.
+		 * If blockCacheMax is BLOCK_CACHE_AUTO, the number of entries
+		 * will be determined using the block size.
+		 *
+		 * blockCacheMutex must be locked, and no entries
+		 * may be loading.
+		 */
+		void initBlockCache(void);
+
+		/**
+		 * Find a block in the block cache.
+		 * blockCacheMutex must be locked.
+		 * @param blockIdx Block index.
+		 * @return Block cache entry, or nullptr if not found.
+		 */
+		BlockCacheEntry *findCachedBlock(uint32_t blockIdx);
+
+		/**
+		 * Reserve a block cache entry for loading a block.
+		 * The least-recently used entry that isn't loading will be replaced.
+		 * blockCacheMutex must be locked.
+		 *
+		 * The block data must be read into the entry's data area
+		 * without holding blockCacheMutex, and then the entry must
+		 * be released with finishCachedBlock().
+		 *
+		 * @param blockIdx Block index.
+		 * @return Block cache entry, or nullptr if all entries are loading.
+		 */
+		BlockCacheEntry *reserveCachedBlock(uint32_t blockIdx);
+
+		/**
+		 * Finish loading a block cache entry.
+		 * blockCacheMutex must be locked.
+		 * @param entry Block cache entry from reserveCachedBlock().
+		 * @param rd readBlock() return value.
+		 * @return True if the block was loaded; false on error.
+		 */
+		bool finishCachedBlock(BlockCacheEntry *entry, int rd);
+
+		/**
+		 * Get a block cache entry's data area.
+		 * @param entry Block cache entry.
+		 * @return Data area. (block_size bytes)
+		 */
+		inline uint8_t *cachedBlockData(const BlockCacheEntry *entry)
+		{
+			return &blockCacheData[static_cast<size_t>(entry - blockCacheEntries.data()) * block_size];
+		}
+
+		/**
+		 * Read blocks ahead into the block cache.
+		 * blockCacheMutex must *not* be locked.
+		 * @param blockIdx Block index that was just read.
+		 */
+		void readAheadCachedBlocks(uint32_t blockIdx);
+
+		/**
+		 * Read the specified block, using the block cache if possible.
+		 * Parameters are the same as SparseDiscReader::readBlock().
+		 *
+		 * @param blockIdx	[in] Block index.
+		 * @param pos		[in] Starting position. (Must be >= 0 and <= the block size!)
+		 * @param ptr		[out] Output data buffer.
+		 * @param size		[in] Amount of data to read, in bytes. (Must be <= the block size!)
+		 * @return Number of bytes read, or -1 if the block index is invalid.
+		 */
+		int readBlockCached(uint32_t blockIdx, int pos, void *ptr, size_t size);
 };
 
 }
@@ -62,10 +62,15 @@ const uint8_t RpImageLoaderPrivate::jpeg_magic_2[4] =
  * This image is NOT checked for issues; do not use
  * with untrusted images!
  *
- * @param file IRpFile to load from.
+ * If targetSize is specified, JPEG images may be decoded
+ * at a reduced size. (See RpJpeg::load().)
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param targetSize	[in,opt] Target size for thumbnails. (0 for full size)
+ * @param pFullSize	[out,opt] Full image size. ([0] == width, [1] == height)
  * @return rp_image*, or nullptr on error.
  */
-rp_image *RpImageLoader::loadUnchecked(IRpFile *file)
+rp_image *RpImageLoader::loadUnchecked(IRpFile *file, int targetSize, int pFullSize[2])
 {
 	file->rewind();
 
@@ -78,7 +83,13 @@ rp_image *RpImageLoader::loadUnchecked(IRpFile *file)
 		     sizeof(RpImageLoaderPrivate::png_magic)))
 		{
 			// Found a PNG image.
-			return RpPng::loadUnchecked(file);
+			// NOTE: PNG images are always loaded at full size.
+			rp_image *const img = RpPng::loadUnchecked(file);
+			if (img && pFullSize) {
+				pFullSize[0] = img->width();
+				pFullSize[1] = img->height();
+			}
+			return img;
 		}
 #ifdef HAVE_JPEG
 		else if (!memcmp(buf, RpImageLoaderPrivate::jpeg_magic_1,
@@ -87,7 +98,7 @@ rp_image *RpImageLoader::loadUnchecked(IRpFile *file)
 			  sizeof(RpImageLoaderPrivate::jpeg_magic_2)))
 		{
 			// Found a JPEG image.
-			return RpJpeg::loadUnchecked(file);
+			return RpJpeg::loadUnchecked(file, targetSize, pFullSize);
 		}
 #endif /* HAVE_JPEG */
 	}
@@ -102,10 +113,15 @@ rp_image *RpImageLoader::loadUnchecked(IRpFile *file)
  * This image is verified with various tools to ensure
  * it doesn't have any errors.
  *
- * @param file IRpFile to load from.
+ * If targetSize is specified, JPEG images may be decoded
+ * at a reduced size. (See RpJpeg::load().)
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param targetSize	[in,opt] Target size for thumbnails. (0 for full size)
+ * @param pFullSize	[out,opt] Full image size. ([0] == width, [1] == height)
  * @return rp_image*, or nullptr on error.
  */
-rp_image *RpImageLoader::load(IRpFile *file)
+rp_image *RpImageLoader::load(IRpFile *file, int targetSize, int pFullSize[2])
 {
 	file->rewind();
 
@@ -118,7 +134,13 @@ rp_image *RpImageLoader::load(IRpFile *file)
 		     sizeof(RpImageLoaderPrivate::png_magic)))
 		{
 			// Found a PNG image.
-			return RpPng::load(file);
+			// NOTE: PNG images are always loaded at full size.
+			rp_image *const img = RpPng::load(file);
+			if (img && pFullSize) {
+				pFullSize[0] = img->width();
+				pFullSize[1] = img->height();
+			}
+			return img;
 		}
 #ifdef HAVE_JPEG
 		else if (!memcmp(buf, RpImageLoaderPrivate::jpeg_magic_1,
@@ -127,7 +149,7 @@ rp_image *RpImageLoader::load(IRpFile *file)
 			  sizeof(RpImageLoaderPrivate::jpeg_magic_2)))
 		{
 			// Found a JPEG image.
-			return RpJpeg::load(file);
+			return RpJpeg::load(file, targetSize, pFullSize);
 		}
 #endif /* HAVE_JPEG */
 	}
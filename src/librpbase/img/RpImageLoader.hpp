@@ -35,10 +35,15 @@ class RpImageLoader
 		 * This image is NOT checked for issues; do not use
 		 * with untrusted images!
 		 *
-		 * @param file IRpFile to load from.
+		 * If targetSize is specified, JPEG images may be decoded
+		 * at a reduced size. (See RpJpeg::load().)
+		 *
+		 * @param file		[in] IRpFile to load from.
+		 * @param targetSize	[in,opt] Target size for thumbnails. (0 for full size)
+		 * @param pFullSize	[out,opt] Full image size. ([0] == width, [1] == height)
 		 * @return rp_image*, or nullptr on error.
 		 */
-		static LibRpTexture::rp_image *loadUnchecked(LibRpFile::IRpFile *file);
+		static LibRpTexture::rp_image *loadUnchecked(LibRpFile::IRpFile *file, int targetSize = 0, int pFullSize[2] = nullptr);
 
 		/**
 		 * Load an image from an IRpFile.
@@ -46,10 +51,15 @@ class RpImageLoader
 		 * This image is verified with various tools to ensure
 		 * it doesn't have any errors.
 		 *
-		 * @param file IRpFile to load from.
+		 * If targetSize is specified, JPEG images may be decoded
+		 * at a reduced size. (See RpJpeg::load().)
+		 *
+		 * @param file		[in] IRpFile to load from.
+		 * @param targetSize	[in,opt] Target size for thumbnails. (0 for full size)
+		 * @param pFullSize	[out,opt] Full image size. ([0] == width, [1] == height)
 		 * @return rp_image*, or nullptr on error.
 		 */
-		static LibRpTexture::rp_image *load(LibRpFile::IRpFile *file);
+		static LibRpTexture::rp_image *load(LibRpFile::IRpFile *file, int targetSize = 0, int pFullSize[2] = nullptr);
 };
 
 }
@@ -211,10 +211,16 @@ void RpJpegPrivate::jpeg_IRpFile_src(j_decompress_ptr cinfo, IRpFile *infile)
  * This image is NOT checked for issues; do not use
  * with untrusted images!
  *
- * @param file IRpFile to load from.
+ * If targetSize is specified, the image may be decoded at
+ * 1/2, 1/4, or 1/8 of its full size, as long as the larger
+ * dimension is still at least targetSize.
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param targetSize	[in,opt] Target size for thumbnails. (0 for full size)
+ * @param pFullSize	[out,opt] Full image size. ([0] == width, [1] == height)
  * @return rp_image*, or nullptr on error.
  */
-rp_image *RpJpeg::loadUnchecked(IRpFile *file)
+rp_image *RpJpeg::loadUnchecked(IRpFile *file, int targetSize, int pFullSize[2])
 {
 	if (!file)
 		return nullptr;
@@ -291,7 +297,28 @@ rp_image *RpJpeg::loadUnchecked(IRpFile *file)
 		return nullptr;
 	}
 
+	if (pFullSize) {
+		pFullSize[0] = static_cast<int>(cinfo.image_width);
+		pFullSize[1] = static_cast<int>(cinfo.image_height);
+	}
+
 	/** Step 4: Set parameters for decompression. **/
+	if (targetSize > 0) {
+		// Thumbnail: Use libjpeg's DCT scaling to decode at
+		// 1/2, 1/4, or 1/8 size if the larger dimension is
+		// still at least targetSize. This is *much* faster
+		// than decoding the full image and downscaling it.
+		const unsigned int max_dim = (cinfo.image_width > cinfo.image_height
+			? cinfo.image_width : cinfo.image_height);
+		unsigned int denom = 8;
+		for (; denom > 1; denom /= 2) {
+			if (max_dim / denom >= static_cast<unsigned int>(targetSize))
+				break;
+		}
+		cinfo.scale_num = 1;
+		cinfo.scale_denom = denom;
+	}
+
 	// Make sure we use libjpeg's built-in colorspace conversion
 	// where possible.
 	switch (cinfo.jpeg_color_space) {
@@ -391,7 +418,7 @@ rp_image *RpJpeg::loadUnchecked(IRpFile *file)
 				return nullptr;
 			}
 
-			img = new rp_image(cinfo.image_width, cinfo.image_height, rp_image::Format::ARGB32);
+			img = new rp_image(cinfo.output_width, cinfo.output_height, rp_image::Format::ARGB32);
 			if (!img->isValid()) {
 				// Could not allocate the image.
 				jpeg_destroy_decompress(&cinfo);
@@ -412,7 +439,7 @@ rp_image *RpJpeg::loadUnchecked(IRpFile *file)
 				return nullptr;
 			}
 
-			img = new rp_image(cinfo.image_width, cinfo.image_height, rp_image::Format::ARGB32);
+			img = new rp_image(cinfo.output_width, cinfo.output_height, rp_image::Format::ARGB32);
 			if (!img->isValid()) {
 				// Could not allocate the image.
 				jpeg_destroy_decompress(&cinfo);
@@ -431,7 +458,7 @@ rp_image *RpJpeg::loadUnchecked(IRpFile *file)
 				return nullptr;
 			}
 
-			img = new rp_image(cinfo.image_width, cinfo.image_height, rp_image::Format::ARGB32);
+			img = new rp_image(cinfo.output_width, cinfo.output_height, rp_image::Format::ARGB32);
 			if (!img->isValid()) {
 				// Could not allocate the image.
 				jpeg_destroy_decompress(&cinfo);
@@ -595,16 +622,22 @@ rp_image *RpJpeg::loadUnchecked(IRpFile *file)
  * This image is verified with various tools to ensure
  * it doesn't have any errors.
  *
- * @param file IRpFile to load from.
+ * If targetSize is specified, the image may be decoded at
+ * 1/2, 1/4, or 1/8 of its full size, as long as the larger
+ * dimension is still at least targetSize.
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param targetSize	[in,opt] Target size for thumbnails. (0 for full size)
+ * @param pFullSize	[out,opt] Full image size. ([0] == width, [1] == height)
  * @return rp_image*, or nullptr on error.
  */
-rp_image *RpJpeg::load(IRpFile *file)
+rp_image *RpJpeg::load(IRpFile *file, int targetSize, int pFullSize[2])
 {
 	if (!file)
 		return nullptr;
 
 	// FIXME: Add a JPEG equivalent of pngcheck().
-	return loadUnchecked(file);
+	return loadUnchecked(file, targetSize, pFullSize);
 }
 
 }
@@ -40,14 +40,24 @@ namespace LibRpBase {
  * This image is NOT checked for issues; do not use
  * with untrusted images!
  *
- * @param file IRpFile to load from.
+ * GDI+ doesn't support scaled JPEG decoding, so targetSize
+ * is ignored and the image is always decoded at full size.
+ * Only pFullSize is filled in.
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param targetSize	[in,opt] Target size for thumbnails. (ignored)
+ * @param pFullSize	[out,opt] Full image size. ([0] == width, [1] == height)
  * @return rp_image*, or nullptr on error.
  */
-rp_image *RpJpeg::loadUnchecked(IRpFile *file)
+rp_image *RpJpeg::loadUnchecked(IRpFile *file, int targetSize, int pFullSize[2])
 {
 	if (!file)
 		return nullptr;
 
+	// NOTE: GDI+ doesn't support scaled JPEG decoding,
+	// so the image is always loaded at full size.
+	RP_UNUSED(targetSize);
+
 	// Rewind the file.
 	file->rewind();
 
@@ -60,6 +70,11 @@ rp_image *RpJpeg::loadUnchecked(IRpFile *file)
 		return nullptr;
 	}
 
+	if (pFullSize) {
+		pFullSize[0] = static_cast<int>(pGdipBmp->GetWidth());
+		pFullSize[1] = static_cast<int>(pGdipBmp->GetHeight());
+	}
+
 	// Create an rp_image using the GDI+ bitmap.
 	RpGdiplusBackend *const backend = new RpGdiplusBackend(pGdipBmp);
 	return new rp_image(backend);
@@ -71,16 +86,22 @@ rp_image *RpJpeg::loadUnchecked(IRpFile *file)
  * This image is verified with various tools to ensure
  * it doesn't have any errors.
  *
- * @param file IRpFile to load from.
+ * GDI+ doesn't support scaled JPEG decoding, so targetSize
+ * is ignored and the image is always decoded at full size.
+ * Only pFullSize is filled in.
+ *
+ * @param file		[in] IRpFile to load from.
+ * @param targetSize	[in,opt] Target size for thumbnails. (ignored)
+ * @param pFullSize	[out,opt] Full image size. ([0] == width, [1] == height)
  * @return rp_image*, or nullptr on error.
  */
-rp_image *RpJpeg::load(IRpFile *file)
+rp_image *RpJpeg::load(IRpFile *file, int targetSize, int pFullSize[2])
 {
 	if (!file)
 		return nullptr;
 
 	// FIXME: Add a JPEG equivalent of pngcheck().
-	return loadUnchecked(file);
+	return loadUnchecked(file, targetSize, pFullSize);
 }
 
 }
@@ -9,6 +9,7 @@
 // Google Test
 #include "gtest/gtest.h"
 #include "tcharx.h"
+#include "config.librpbase.h"
 
 // AesCipher
 #include "../crypto/IAesCipher.hpp"
@@ -18,6 +19,9 @@
 #else /* !_WIN32 */
 # include "../crypto/AesNettle.hpp"
 #endif /* _WIN32 */
+#ifdef HAVE_AESNI
+# include "../crypto/AesNI.hpp"
+#endif /* HAVE_AESNI */
 
 // C includes. (C++ namespace)
 #include <cstdio>
@@ -703,6 +707,65 @@ AesDecryptTestSet(CAPI_NG, false)
 #else /* !_WIN32 */
 AesDecryptTestSet(Nettle, true)
 #endif /* _WIN32 */
+#ifdef HAVE_AESNI
+AesDecryptTestSet(NI, false)
+#endif /* HAVE_AESNI */
+
+#if defined(HAVE_AESNI) && !defined(_WIN32)
+/**
+ * Compare AesNI to AesNettle using a large buffer.
+ * The known-answer tests only use 4 blocks, which
+ * doesn't exercise the multi-block code paths.
+ */
+TEST(AesNITest, compareToNettle)
+{
+	if (!AesNI::isUsable()) {
+		printf("AES-NI is not supported on this CPU; skipping test.\n");
+		return;
+	}
+
+	// 67 blocks: 8 full pipelines plus 3 remaining blocks.
+	vector<uint8_t> src(67 * 16);
+	for (size_t i = 0; i < src.size(); i++) {
+		src[i] = static_cast<uint8_t>((i * 0x9D) ^ (i >> 3));
+	}
+
+	static const IAesCipher::ChainingMode modes[] = {
+		IAesCipher::ChainingMode::ECB,
+		IAesCipher::ChainingMode::CBC,
+		IAesCipher::ChainingMode::CTR,
+	};
+	// Counter with a low qword that will overflow.
+	static const uint8_t iv[16] = {
+		0x01,0x23,0x45,0x67,0x89,0xAB,0xCD,0xEF,
+		0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xF0
+	};
+
+	for (IAesCipher::ChainingMode mode : modes) {
+		for (size_t key_len = 16; key_len <= 32; key_len += 8) {
+			AesNettle nettle;
+			AesNI aesni;
+			ASSERT_EQ(0, nettle.setKey(AesCipherTest::aes_key, key_len));
+			ASSERT_EQ(0, aesni.setKey(AesCipherTest::aes_key, key_len));
+			ASSERT_EQ(0, nettle.setChainingMode(mode));
+			ASSERT_EQ(0, aesni.setChainingMode(mode));
+			if (mode != IAesCipher::ChainingMode::ECB) {
+				ASSERT_EQ(0, nettle.setIV(iv, sizeof(iv)));
+				ASSERT_EQ(0, aesni.setIV(iv, sizeof(iv)));
+			}
+
+			// Decrypt in two uneven chunks to verify IV/counter chaining.
+			vector<uint8_t> expected(src), actual(src);
+			ASSERT_EQ(expected.size(), nettle.decrypt(expected.data(), expected.size()));
+			ASSERT_EQ(13U * 16U, aesni.decrypt(actual.data(), 13U * 16U));
+			ASSERT_EQ(actual.size() - (13U * 16U),
+				aesni.decrypt(&actual[13U * 16U], actual.size() - (13U * 16U)));
+			EXPECT_TRUE(expected == actual)
+				<< "AES-" << (key_len * 8) << " mode " << static_cast<int>(mode) << " mismatch";
+		}
+	}
+}
+#endif /* HAVE_AESNI && !_WIN32 */
 
 } }
 
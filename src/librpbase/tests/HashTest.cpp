@@ -0,0 +1,163 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * HashTest.cpp: Hash class test.                                          *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// Hash
+#include "../crypto/Hash.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+struct HashTest_mode
+{
+	// Hash algorithm.
+	Hash::Algorithm algorithm;
+
+	// Expected hash of the test string, as a hex string.
+	const char *hash;
+
+	HashTest_mode(Hash::Algorithm algorithm, const char *hash)
+		: algorithm(algorithm), hash(hash)
+	{ }
+};
+
+class HashTest : public ::testing::TestWithParam<HashTest_mode>
+{
+	public:
+		/**
+		 * Convert a hash to a lowercase hex string.
+		 * @param pHash Hash.
+		 * @param hash_len Hash length.
+		 * @return Hex string.
+		 */
+		static string toHex(const uint8_t *pHash, size_t hash_len);
+
+		/**
+		 * Get the hash of all data processed so far as a hex string.
+		 * @param hash Hash object.
+		 * @return Hex string, or empty string on error.
+		 */
+		static string getHashHex(Hash &hash);
+
+	public:
+		// Test string.
+		static const char test_str[];
+};
+
+const char HashTest::test_str[] = "The quick brown fox jumps over the lazy dog";
+
+/**
+ * Convert a hash to a lowercase hex string.
+ * @param pHash Hash.
+ * @param hash_len Hash length.
+ * @return Hex string.
+ */
+string HashTest::toHex(const uint8_t *pHash, size_t hash_len)
+{
+	string s;
+	s.reserve(hash_len * 2);
+	char buf[4];
+	for (size_t i = 0; i < hash_len; i++) {
+		snprintf(buf, sizeof(buf), "%02x", pHash[i]);
+		s += buf;
+	}
+	return s;
+}
+
+/**
+ * Get the hash of all data processed so far as a hex string.
+ * @param hash Hash object.
+ * @return Hex string, or empty string on error.
+ */
+string HashTest::getHashHex(Hash &hash)
+{
+	uint8_t buf[64];
+	const size_t hash_len = hash.hashLength();
+	EXPECT_LE(hash_len, sizeof(buf));
+	if (hash_len == 0 || hash_len > sizeof(buf))
+		return string();
+
+	EXPECT_EQ(0, hash.getHash(buf, hash_len));
+	return toHex(buf, hash_len);
+}
+
+/**
+ * Hash the test string in one block.
+ */
+TEST_P(HashTest, oneBlock)
+{
+	const HashTest_mode &mode = GetParam();
+
+	Hash hash(mode.algorithm);
+	ASSERT_TRUE(hash.isUsable());
+	EXPECT_EQ(0, hash.process(test_str, strlen(test_str)));
+	EXPECT_EQ(mode.hash, getHashHex(hash));
+}
+
+/**
+ * Hash the test string in small blocks of varying sizes.
+ */
+TEST_P(HashTest, multipleBlocks)
+{
+	const HashTest_mode &mode = GetParam();
+
+	Hash hash(mode.algorithm);
+	ASSERT_TRUE(hash.isUsable());
+	const size_t len = strlen(test_str);
+	for (size_t pos = 0, chunk = 1; pos < len; pos += chunk, chunk++) {
+		if (pos + chunk > len) {
+			chunk = len - pos;
+		}
+		EXPECT_EQ(0, hash.process(&test_str[pos], chunk));
+	}
+	EXPECT_EQ(mode.hash, getHashHex(hash));
+}
+
+/**
+ * getHash() must not modify the hash state, and reset() must clear it.
+ */
+TEST_P(HashTest, getHashAndReset)
+{
+	const HashTest_mode &mode = GetParam();
+
+	Hash hash(mode.algorithm);
+	ASSERT_TRUE(hash.isUsable());
+	const size_t half = strlen(test_str) / 2;
+	EXPECT_EQ(0, hash.process(test_str, half));
+	const string s_half = getHashHex(hash);
+	EXPECT_EQ(0, hash.process(&test_str[half], strlen(test_str) - half));
+	EXPECT_EQ(mode.hash, getHashHex(hash));
+	EXPECT_NE(s_half, getHashHex(hash));
+
+	// Reset and hash the full string again.
+	EXPECT_EQ(0, hash.reset());
+	EXPECT_EQ(0, hash.process(test_str, strlen(test_str)));
+	EXPECT_EQ(mode.hash, getHashHex(hash));
+}
+
+INSTANTIATE_TEST_SUITE_P(StringHashTest, HashTest,
+	::testing::Values(
+		HashTest_mode(Hash::Algorithm::CRC32, "414fa339"),
+		HashTest_mode(Hash::Algorithm::MD5, "9e107d9d372bb6826bd81d3542a419d6"),
+		HashTest_mode(Hash::Algorithm::SHA1, "2fd4e1c67a2d28fced849ee1bb76e7391b93eb12")
+		)
+	);
+
+} }
@@ -0,0 +1,349 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * StringArenaTest.cpp: StringArena and RomFields string storage test.     *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpbase
+#include "librpbase/StringArena.hpp"
+#include "librpbase/RomFields.hpp"
+#include "librpbase/RomMetaData.hpp"
+
+// C includes. (C++ namespace)
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRpBase { namespace Tests {
+
+/**
+ * Strings copied into the arena must remain valid
+ * as more strings are added, including large strings.
+ */
+TEST(StringArenaTest, addManyStrings)
+{
+	StringArena arena;
+	vector<string> strs;
+	vector<StrView> views;
+
+	for (unsigned int i = 0; i < 4096; i++) {
+		char buf[64];
+		snprintf(buf, sizeof(buf), "Achievement %u description", i);
+		string s(buf);
+		if (i % 512 == 0) {
+			// Large string. This gets its own block.
+			s.append(32768, 'x');
+		}
+		views.emplace_back(arena.add(s));
+		strs.emplace_back(std::move(s));
+	}
+
+	for (size_t i = 0; i < strs.size(); i++) {
+		const StrView &sv = views[i];
+		ASSERT_TRUE(sv);
+		EXPECT_EQ(strs[i].size(), sv.size());
+		EXPECT_EQ(strs[i], sv.toString());
+		// NUL terminator
+		EXPECT_EQ('\0', sv.c_str()[sv.size()]);
+	}
+
+	arena.clear();
+	EXPECT_EQ(0U, arena.bytesAllocated());
+}
+
+/**
+ * nullptr and empty strings.
+ */
+TEST(StringArenaTest, nullAndEmptyStrings)
+{
+	StringArena arena;
+
+	const StrView sv_null = arena.add(nullptr);
+	EXPECT_FALSE(sv_null);
+	EXPECT_TRUE(sv_null.empty());
+	EXPECT_STREQ("", sv_null.c_str());
+
+	const StrView sv_empty = arena.add("");
+	EXPECT_TRUE(sv_empty);
+	EXPECT_TRUE(sv_empty.empty());
+	EXPECT_STREQ("", sv_empty.c_str());
+}
+
+/**
+ * RomFields string fields, including copying to another RomFields.
+ */
+TEST(StringArenaTest, romFieldsStrings)
+{
+	RomFields *const fields = new RomFields();
+	fields->addField_string("Title", "Test Title   ", RomFields::STRF_TRIM_END);
+	fields->addField_string("Empty", string());
+	const int idx = fields->addField_string("Secure Area", "Encrypted");
+	EXPECT_EQ(0, fields->changeField_string(idx, "Decrypted"));
+
+	RomFields copy;
+	copy.addFields_romFields(fields, RomFields::TabOffset_Ignore);
+	delete fields;
+
+	ASSERT_EQ(3, copy.count());
+	EXPECT_EQ("Test Title", copy.at(0)->data.str.toString());
+	EXPECT_FALSE(copy.at(1)->data.str);
+	EXPECT_STREQ("Decrypted", copy.at(2)->data.str.c_str());
+}
+
+/**
+ * Generate a test string for RFT_LISTDATA.
+ * Every 500th string is large enough to get its own arena block.
+ * @param lc Language code. (0 for none)
+ * @param row Row number.
+ * @param col Column number.
+ * @return Test string.
+ */
+static string listDataString(uint32_t lc, unsigned int row, unsigned int col)
+{
+	char buf[64];
+	snprintf(buf, sizeof(buf), "%08X-row%u-col%u", lc, row, col);
+	string str(buf);
+	if (col == 1 && (row % 500) == 250) {
+		str.append(20*1024, 'x');
+	}
+	return str;
+}
+
+/**
+ * Check RFT_LISTDATA rows against listDataString().
+ * @param list_data List data.
+ * @param lc Language code. (0 for none)
+ * @param rows Expected number of rows.
+ * @param cols Expected number of columns.
+ */
+static void checkListData(const RomFields::ListDataView_t *list_data, uint32_t lc, unsigned int rows, unsigned int cols)
+{
+	ASSERT_TRUE(list_data != nullptr);
+	ASSERT_EQ(rows, list_data->size());
+	for (unsigned int row = 0; row < rows; row++) {
+		const RomFields::ListDataRow_t &data_row = list_data->at(row);
+		ASSERT_EQ(cols, data_row.size());
+		for (unsigned int col = 0; col < cols; col++) {
+			const string expected = listDataString(lc, row, col);
+			ASSERT_EQ(expected.size(), data_row[col].size());
+			ASSERT_STREQ(expected.c_str(), data_row[col].c_str()) << "row " << row << ", col " << col;
+		}
+	}
+}
+
+/**
+ * ListDataBuilder strings must remain valid as the arena grows,
+ * including while other fields are being added.
+ */
+TEST(StringArenaTest, listDataBuilder)
+{
+	static const unsigned int rows = 2000, cols = 3;
+
+	RomFields fields;
+	RomFields::ListDataBuilder builder(&fields, rows, cols);
+	for (unsigned int row = 0; row < rows; row++) {
+		builder.addRow();
+		for (unsigned int col = 0; col < cols; col++) {
+			builder.add(listDataString(0, row, col));
+		}
+		if ((row % 100) == 0) {
+			// Add another field to grow the arena between rows.
+			fields.addField_string("Filler", listDataString(0xFFFF, row, 0));
+		}
+	}
+	EXPECT_EQ(rows, builder.rowCount());
+
+	RomFields::AFLD_PARAMS params;
+	params.view.single = new RomFields::ListDataView_t(builder.release());
+	EXPECT_EQ(0U, builder.rowCount());
+	const int idx = fields.addField_listData("List", &params);
+	ASSERT_GE(idx, 0);
+
+	// Add more strings after the list data.
+	for (unsigned int i = 0; i < 1000; i++) {
+		fields.addField_string("Filler", listDataString(0xFFFE, i, 1));
+	}
+
+	const RomFields::Field *const field = fields.at(idx);
+	ASSERT_TRUE(field != nullptr);
+	ASSERT_EQ(RomFields::RFT_LISTDATA, field->type);
+	checkListData(field->data.list_data.data.single, 0, rows, cols);
+}
+
+/**
+ * The ListData_t compatibility path copies the strings
+ * into the arena and deletes the ListData_t.
+ */
+TEST(StringArenaTest, listDataCompat)
+{
+	static const unsigned int rows = 1000, cols = 2;
+
+	RomFields fields;
+	RomFields::ListData_t *const list_data = new RomFields::ListData_t(rows);
+	for (unsigned int row = 0; row < rows; row++) {
+		vector<string> &data_row = list_data->at(row);
+		for (unsigned int col = 0; col < cols; col++) {
+			data_row.emplace_back(listDataString(0, row, col));
+		}
+	}
+
+	RomFields::AFLD_PARAMS params;
+	params.data.single = list_data;
+	const int idx = fields.addField_listData("List", &params);
+	ASSERT_GE(idx, 0);
+
+	for (unsigned int i = 0; i < 1000; i++) {
+		fields.addField_string("Filler", listDataString(0xFFFE, i, 1));
+	}
+
+	checkListData(fields.at(idx)->data.list_data.data.single, 0, rows, cols);
+}
+
+/**
+ * RFT_LISTDATA_MULTI with one ListDataBuilder per language.
+ * The rows are added interleaved, like Xbox360_XDBF does.
+ */
+TEST(StringArenaTest, listDataMulti)
+{
+	static const unsigned int rows = 1500, cols = 3;
+	static const uint32_t lcs[] = {'en', 'de', 'ja'};
+
+	RomFields fields;
+	vector<RomFields::ListDataBuilder*> builders;
+	for (size_t i = 0; i < ARRAY_SIZE(lcs); i++) {
+		builders.push_back(new RomFields::ListDataBuilder(&fields, rows, cols));
+	}
+	for (unsigned int row = 0; row < rows; row++) {
+		for (size_t i = 0; i < builders.size(); i++) {
+			builders[i]->addRow();
+			for (unsigned int col = 0; col < cols; col++) {
+				builders[i]->add(listDataString(lcs[i], row, col));
+			}
+		}
+	}
+
+	RomFields::ListDataViewMultiMap_t *const multi = new RomFields::ListDataViewMultiMap_t();
+	for (size_t i = 0; i < builders.size(); i++) {
+		multi->insert(std::make_pair(lcs[i], builders[i]->release()));
+		delete builders[i];
+	}
+
+	RomFields::AFLD_PARAMS params(RomFields::RFT_LISTDATA_MULTI, 0);
+	params.def_lc = 'en';
+	params.view.multi = multi;
+	const int idx = fields.addField_listData("List", &params);
+	ASSERT_GE(idx, 0);
+	EXPECT_EQ((uint32_t)'en', fields.defaultLanguageCode());
+
+	for (unsigned int i = 0; i < 1000; i++) {
+		fields.addField_string("Filler", listDataString(0xFFFE, i, 1));
+	}
+
+	const RomFields::ListDataViewMultiMap_t *const field_multi =
+		fields.at(idx)->data.list_data.data.multi;
+	ASSERT_TRUE(field_multi != nullptr);
+	ASSERT_EQ(ARRAY_SIZE(lcs), field_multi->size());
+	for (uint32_t lc : lcs) {
+		auto iter = field_multi->find(lc);
+		ASSERT_TRUE(iter != field_multi->end());
+		checkListData(&iter->second, lc, rows, cols);
+	}
+}
+
+/**
+ * addFields_romFields() must copy RFT_LISTDATA strings
+ * into the destination arena.
+ */
+TEST(StringArenaTest, listDataAddFields)
+{
+	static const unsigned int rows = 1000, cols = 3;
+
+	RomFields *const fields = new RomFields();
+
+	// Single
+	RomFields::ListDataBuilder builder(fields, rows, cols);
+	for (unsigned int row = 0; row < rows; row++) {
+		builder.addRow();
+		for (unsigned int col = 0; col < cols; col++) {
+			builder.add(listDataString(0, row, col));
+		}
+	}
+	RomFields::AFLD_PARAMS params;
+	params.view.single = new RomFields::ListDataView_t(builder.release());
+	fields->addField_listData("List", &params);
+
+	// Multi
+	RomFields::ListDataViewMultiMap_t *const multi = new RomFields::ListDataViewMultiMap_t();
+	for (unsigned int row = 0; row < rows; row++) {
+		builder.addRow();
+		for (unsigned int col = 0; col < cols; col++) {
+			builder.add(listDataString('fr', row, col));
+		}
+	}
+	multi->insert(std::make_pair((uint32_t)'fr', builder.release()));
+	RomFields::AFLD_PARAMS params_multi(RomFields::RFT_LISTDATA_MULTI, 0);
+	params_multi.def_lc = 'fr';
+	params_multi.view.multi = multi;
+	fields->addField_listData("Multi", &params_multi);
+
+	RomFields copy;
+	copy.addFields_romFields(fields, RomFields::TabOffset_Ignore);
+	ASSERT_EQ(2, copy.count());
+
+	// The copied strings must not point into the original arena.
+	const StrView &src_str = fields->at(0)->data.list_data.data.single->at(0)[0];
+	const StrView &dest_str = copy.at(0)->data.list_data.data.single->at(0)[0];
+	EXPECT_NE(src_str.ptr, dest_str.ptr);
+	const StrView &src_str_multi = fields->at(1)->data.list_data.data.multi->at('fr').at(0)[0];
+	const StrView &dest_str_multi = copy.at(1)->data.list_data.data.multi->at('fr').at(0)[0];
+	EXPECT_NE(src_str_multi.ptr, dest_str_multi.ptr);
+	delete fields;
+
+	checkListData(copy.at(0)->data.list_data.data.single, 0, rows, cols);
+	const RomFields::ListDataViewMultiMap_t *const copy_multi =
+		copy.at(1)->data.list_data.data.multi;
+	ASSERT_TRUE(copy_multi != nullptr);
+	ASSERT_EQ(1U, copy_multi->size());
+	checkListData(&copy_multi->at('fr'), 'fr', rows, cols);
+}
+
+/**
+ * RomMetaData string properties, including overwriting a property.
+ */
+TEST(StringArenaTest, romMetaDataStrings)
+{
+	RomMetaData metaData;
+	EXPECT_EQ(-1, metaData.addMetaData_string(Property::Title, "    ", RomMetaData::STRF_TRIM_END));
+	EXPECT_EQ(0, metaData.addMetaData_string(Property::Title, "First"));
+	EXPECT_EQ(0, metaData.addMetaData_string(Property::Title, string("Second  "), RomMetaData::STRF_TRIM_END));
+
+	ASSERT_EQ(1, metaData.count());
+	EXPECT_STREQ("Second", metaData.prop(0)->data.str.c_str());
+	EXPECT_EQ(6U, metaData.prop(0)->data.str.size());
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpBase test suite: StringArena tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
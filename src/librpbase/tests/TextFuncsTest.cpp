@@ -256,6 +256,50 @@ TEST_F(TextFuncsTest, cp1252_to_utf16)
 	EXPECT_EQ(cp1252_utf16_data, str);
 }
 
+/**
+ * Test the 7-bit ASCII fast paths with a non-ASCII character
+ * at every position of a string longer than one SIMD vector.
+ */
+TEST_F(TextFuncsTest, ascii_fast_path)
+{
+	static const char ascii_data[] = "The quick brown fox jumps over the lazy dog.";
+	static const int len = static_cast<int>(ARRAY_SIZE(ascii_data)-1);
+
+	// Pure ASCII should be returned as-is.
+	EXPECT_EQ(string(ascii_data), cp1252_to_utf8(ascii_data, len));
+	EXPECT_EQ(string(ascii_data), cp1252_sjis_to_utf8(ascii_data, len));
+	EXPECT_EQ(string(ascii_data), utf8_to_latin1(ascii_data, len));
+
+	u16string u16_ascii, u16_ascii_swap;
+	for (int i = 0; i < len; i++) {
+		u16_ascii += static_cast<char16_t>(ascii_data[i]);
+		u16_ascii_swap += static_cast<char16_t>(ascii_data[i] << 8);
+	}
+	EXPECT_EQ(u16_ascii, latin1_to_utf16(ascii_data, len));
+	EXPECT_EQ(string(ascii_data), utf16_to_latin1(u16_ascii.data(), len));
+	EXPECT_EQ(string(ascii_data), utf16_to_utf8(u16_ascii.data(), len));
+#if SYS_BYTEORDER == SYS_LIL_ENDIAN
+	EXPECT_EQ(string(ascii_data), utf16be_to_utf8(u16_ascii_swap.data(), len));
+#else /* SYS_BYTEORDER == SYS_BIG_ENDIAN */
+	EXPECT_EQ(string(ascii_data), utf16le_to_utf8(u16_ascii_swap.data(), len));
+#endif
+
+	// Replace one character with U+00E9 and make sure it's converted.
+	for (int i = 0; i < len; i++) {
+		string s_latin1(ascii_data);
+		s_latin1[i] = '\xE9';
+		string s_utf8(ascii_data, i);
+		s_utf8 += "\xC3\xA9";
+		s_utf8.append(&ascii_data[i+1]);
+		EXPECT_EQ(s_utf8, latin1_to_utf8(s_latin1.data(), len)) << "Position " << i;
+
+		u16string u16str = u16_ascii;
+		u16str[i] = 0x00E9;
+		EXPECT_EQ(s_utf8, utf16_to_utf8(u16str.data(), len)) << "Position " << i;
+		EXPECT_EQ(s_latin1, utf16_to_latin1(u16str.data(), len)) << "Position " << i;
+	}
+}
+
 /** Code Page 1252 + Shift-JIS (932) **/
 
 /**
@@ -45,6 +45,18 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		// TODO: Add more syscalls.
 		// FIXME: glibc-2.31 uses 64-bit time syscalls that may not be
 		// defined in earlier versions, including Ubuntu 14.04.
+
+		// NOTE: Special case for clone(). If it's the first syscall
+		// in the list, it has a parameter restriction added that
+		// ensures it can only be used to create threads.
+		SCMP_SYS(clone),
+		// Other multi-threading syscalls [LibRpThreads::ThreadPool]
+		SCMP_SYS(set_robust_list), SCMP_SYS(madvise),
+		SCMP_SYS(sched_getaffinity),	// sysconf(_SC_NPROCESSORS_ONLN)
+#if defined(__SNR_rseq) || defined(__NR_rseq)
+		SCMP_SYS(rseq),		// glibc-2.35
+#endif /* __SNR_rseq || __NR_rseq */
+
 		SCMP_SYS(fcntl),     SCMP_SYS(fcntl64),		// gcc profiling
 		SCMP_SYS(fstat),     SCMP_SYS(fstat64),		// __GI___fxstat() [printf()]
 		SCMP_SYS(fstatat64), SCMP_SYS(newfstatat),	// Ubuntu 19.10 (32-bit)
@@ -55,6 +67,8 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		SCMP_SYS(mprotect),	// iconv_open()
 		SCMP_SYS(munmap),	// free() [in some cases]
 		SCMP_SYS(lseek), SCMP_SYS(_llseek),
+		SCMP_SYS(pread64),	// LibRpFile::RpFile::readAt()
+		SCMP_SYS(preadv),	// LibRpFile::RpFile::readBatch()
 		SCMP_SYS(open),		// Ubuntu 16.04
 		SCMP_SYS(openat),	// glibc-2.31
 #if defined(__SNR_openat2)
@@ -72,6 +86,17 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		SCMP_SYS(close),	// mktime() [mz_zip_dosdate_to_time_t()]
 		SCMP_SYS(stat), SCMP_SYS(stat64),	// mktime() [mz_zip_dosdate_to_time_t()]
 
+		// Temporary files [RomDataIndexTest]
+		SCMP_SYS(access),	// LibUnixCommon::isWritableDirectory()
+		SCMP_SYS(getpid),	// RomDataIndexPrivate::saveEntry()
+		SCMP_SYS(mkdir),	// LibRpFile::FileSystem::rmkdir()
+		SCMP_SYS(rename), SCMP_SYS(renameat),	// LibRpFile::FileSystem::rename_file()
+#if defined(__SNR_renameat2) || defined(__NR_renameat2)
+		SCMP_SYS(renameat2),
+#endif /* __SNR_renameat2 || __NR_renameat2 */
+		SCMP_SYS(unlink), SCMP_SYS(unlinkat),	// LibRpFile::FileSystem::delete_file()
+		SCMP_SYS(utime), SCMP_SYS(utimensat),	// LibRpFile::FileSystem::set_mtime()
+
 		// glibc ncsd
 		// TODO: Restrict connect() to AF_UNIX.
 		SCMP_SYS(connect), SCMP_SYS(recvmsg), SCMP_SYS(sendto),
@@ -88,9 +113,10 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 	// Promises:
 	// - stdio: General stdio functionality.
 	// - rpath: Read test cases.
-	param.promises = "stdio rpath";
+	// - wpath, cpath, fattr: Temporary files. [RomDataIndexTest]
+	param.promises = "stdio rpath wpath cpath fattr";
 #elif defined(HAVE_TAME)
-	param.tame_flags = TAME_STDIO | TAME_RPATH;
+	param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_WPATH | TAME_CPATH;
 #else
 	param.dummy = 0;
 #endif
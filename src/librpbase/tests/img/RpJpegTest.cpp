@@ -0,0 +1,108 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpbase/tests)                  *
+ * RpJpegTest.cpp: JPEG loading test with targetSize.                      *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "librpbase/config.librpbase.h"
+
+// Google Test
+#include "gtest/gtest.h"
+
+// librpbase, librpfile, librptexture
+#include "common.h"
+#include "img/RpImageLoader.hpp"
+#include "librpfile/RpFile.hpp"
+#include "librpfile/FileSystem.hpp"
+#include "librptexture/img/rp_image.hpp"
+using LibRpFile::RpFile;
+using LibRpTexture::rp_image;
+
+// C++ includes.
+#include <ostream>
+#include <string>
+using std::string;
+
+namespace LibRpBase { namespace Tests {
+
+struct RpJpegTest_mode
+{
+	string jpeg_filename;	// JPEG image to test.
+	int width;		// Full image width.
+	int height;		// Full image height.
+	int targetSize;		// Target size for thumbnails. (0 for full size)
+	int denom;		// Expected scaling denominator.
+
+	RpJpegTest_mode(
+		const char *jpeg_filename,
+		int width, int height,
+		int targetSize, int denom)
+		: jpeg_filename(jpeg_filename)
+		, width(width), height(height)
+		, targetSize(targetSize)
+#ifdef _WIN32
+		// GDI+ doesn't support scaled JPEG decoding.
+		, denom(1)
+#else /* !_WIN32 */
+		, denom(denom)
+#endif /* _WIN32 */
+	{
+#ifdef _WIN32
+		RP_UNUSED(denom);
+#endif /* _WIN32 */
+	}
+};
+
+// Needed for gtest to print the test mode.
+inline ::std::ostream& operator<<(::std::ostream& os, const RpJpegTest_mode& mode) {
+	return os << mode.jpeg_filename << '_' << mode.targetSize;
+};
+
+class RpJpegTest : public ::testing::TestWithParam<RpJpegTest_mode>
+{ };
+
+/**
+ * Load a JPEG image with a targetSize and verify the
+ * full size and the decoded size.
+ */
+TEST_P(RpJpegTest, loadTest)
+{
+	const RpJpegTest_mode &mode = GetParam();
+
+	string path = "png_data";
+	path += DIR_SEP_CHR;
+	path += mode.jpeg_filename;
+	unique_RefBase<RpFile> file(new RpFile(path, RpFile::FM_OPEN_READ));
+	ASSERT_TRUE(file->isOpen()) << "Error loading JPEG image file: " << mode.jpeg_filename;
+
+	int fullSize[2] = {0, 0};
+	rp_image *const img = RpImageLoader::load(file.get(), mode.targetSize, fullSize);
+	ASSERT_TRUE(img != nullptr) << "RpImageLoader::load() failed to load the JPEG image.";
+
+	// pFullSize must always be the original image size.
+	EXPECT_EQ(mode.width, fullSize[0]);
+	EXPECT_EQ(mode.height, fullSize[1]);
+
+	// libjpeg's DCT scaling rounds the output size up.
+	EXPECT_EQ((mode.width + mode.denom - 1) / mode.denom, img->width());
+	EXPECT_EQ((mode.height + mode.denom - 1) / mode.denom, img->height());
+
+	img->unref();
+}
+
+// gradient.odd-size.jpg: 500x333
+// - targetSize == 0: Full size.
+// - Otherwise, the largest denominator (8, 4, 2) where
+//   500/denom >= targetSize is used.
+INSTANTIATE_TEST_SUITE_P(gradient_odd_size_jpg, RpJpegTest,
+	::testing::Values(
+		RpJpegTest_mode("gradient.odd-size.jpg", 500, 333,   0, 1),
+		RpJpegTest_mode("gradient.odd-size.jpg", 500, 333,  40, 8),
+		RpJpegTest_mode("gradient.odd-size.jpg", 500, 333,  64, 4),
+		RpJpegTest_mode("gradient.odd-size.jpg", 500, 333, 200, 2),
+		RpJpegTest_mode("gradient.odd-size.jpg", 500, 333, 400, 1))
+	);
+
+} }
@@ -108,6 +108,14 @@ int set_mtime(const std::string &filename, time_t mtime);
  */
 int get_mtime(const std::string &filename, time_t *pMtime);
 
+/**
+ * Set the access timestamp of a file to the current time.
+ * The modification timestamp is not changed.
+ * @param filename Filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int touch_atime(const std::string &filename);
+
 /**
  * Delete a file.
  * @param filename Filename.
@@ -125,6 +133,15 @@ static inline int delete_file(const std::string &filename)
 	return delete_file(filename.c_str());
 }
 
+/**
+ * Rename a file.
+ * If the destination file exists, it will be replaced.
+ * @param oldname Old filename.
+ * @param newname New filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int rename_file(const std::string &oldname, const std::string &newname);
+
 /**
  * Get the file extension from a filename or pathname.
  * @param filename Filename.
@@ -179,6 +196,25 @@ bool isOnBadFS(const char *filename, bool netFS = false);
  */
 int get_file_size_and_mtime(const std::string &filename, off64_t *pFileSize, time_t *pMtime);
 
+/**
+ * File identity.
+ * Used to determine if a file has changed since it was last seen.
+ */
+struct FileIdentity {
+	uint64_t dev;		// Device ID (Windows: volume serial number)
+	uint64_t ino;		// Inode number (Windows: file index)
+	off64_t size;		// File size
+	time_t mtime;		// Modification time
+};
+
+/**
+ * Get a file's identity.
+ * @param filename	[in] Filename.
+ * @param pFileId	[out] File identity.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int get_file_identity(const std::string &filename, FileIdentity *pFileId);
+
 } }
 
 #endif /* __ROMPROPERTIES_LIBRPFILE_FILESYSTEM_HPP__ */
@@ -197,6 +197,40 @@ int get_mtime(const string &filename, time_t *pMtime)
 	return 0;
 }
 
+/**
+ * Set the access timestamp of a file to the current time.
+ * The modification timestamp is not changed.
+ * @param filename Filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int touch_atime(const string &filename)
+{
+#ifdef UTIME_OMIT
+	struct timespec ts[2];
+	ts[0].tv_sec = 0;
+	ts[0].tv_nsec = UTIME_NOW;	// atime
+	ts[1].tv_sec = 0;
+	ts[1].tv_nsec = UTIME_OMIT;	// mtime
+	int ret = utimensat(AT_FDCWD, filename.c_str(), ts, 0);
+#else /* !UTIME_OMIT */
+	// utimensat() isn't available. Keep the existing mtime.
+	struct stat sb;
+	int ret = stat(filename.c_str(), &sb);
+	if (ret == 0) {
+		struct utimbuf utbuf;
+		utbuf.actime = time(nullptr);
+		utbuf.modtime = sb.st_mtime;
+		ret = utime(filename.c_str(), &utbuf);
+	}
+#endif /* UTIME_OMIT */
+
+	if (ret != 0) {
+		ret = -errno;
+		return (ret != 0 ? ret : -EIO);
+	}
+	return 0;
+}
+
 /**
  * Delete a file.
  * @param filename Filename.
@@ -216,6 +250,27 @@ int delete_file(const char *filename)
 	return ret;
 }
 
+/**
+ * Rename a file.
+ * If the destination file exists, it will be replaced.
+ * @param oldname Old filename.
+ * @param newname New filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int rename_file(const string &oldname, const string &newname)
+{
+	if (unlikely(oldname.empty() || newname.empty()))
+		return -EINVAL;
+
+	int ret = rename(oldname.c_str(), newname.c_str());
+	if (ret != 0) {
+		// Error renaming the file.
+		ret = -errno;
+	}
+
+	return ret;
+}
+
 /**
  * Check if the specified file is a symbolic link.
  * @return True if the file is a symbolic link; false if not.
@@ -404,4 +459,60 @@ int get_file_size_and_mtime(const string &filename, off64_t *pFileSize, time_t *
 	return 0;
 }
 
+/**
+ * Get a file's identity.
+ * @param filename	[in] Filename.
+ * @param pFileId	[out] File identity.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int get_file_identity(const string &filename, FileIdentity *pFileId)
+{
+	assert(pFileId != nullptr);
+
+#ifdef HAVE_STATX
+	static const unsigned int mask = STATX_TYPE | STATX_INO | STATX_MTIME | STATX_SIZE;
+	struct statx sbx;
+	int ret = statx(AT_FDCWD, filename.c_str(), 0, mask, &sbx);
+	if (ret != 0 || (sbx.stx_mask & (mask & ~STATX_TYPE)) != (mask & ~STATX_TYPE)) {
+		// statx() failed and/or did not return the required fields.
+		int ret = -errno;
+		return (ret != 0 ? ret : -EIO);
+	}
+
+	// Make sure this is not a directory.
+	if ((sbx.stx_mask & STATX_TYPE) && S_ISDIR(sbx.stx_mode)) {
+		// It's a directory.
+		return -EISDIR;
+	}
+
+	// Return the file identity.
+	pFileId->dev = (static_cast<uint64_t>(sbx.stx_dev_major) << 32) | sbx.stx_dev_minor;
+	pFileId->ino = sbx.stx_ino;
+	pFileId->size = sbx.stx_size;
+	pFileId->mtime = sbx.stx_mtime.tv_sec;
+#else /* !HAVE_STATX */
+	struct stat sb;
+	int ret = stat(filename.c_str(), &sb);
+	if (ret != 0) {
+		// stat() failed.
+		int ret = -errno;
+		return (ret != 0 ? ret : -EIO);
+	}
+
+	// Make sure this is not a directory.
+	if (S_ISDIR(sb.st_mode)) {
+		// It's a directory.
+		return -EISDIR;
+	}
+
+	// Return the file identity.
+	pFileId->dev = sb.st_dev;
+	pFileId->ino = sb.st_ino;
+	pFileId->size = sb.st_size;
+	pFileId->mtime = sb.st_mtime;
+#endif /* HAVE_STATX */
+
+	return 0;
+}
+
 } }
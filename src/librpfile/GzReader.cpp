@@ -0,0 +1,857 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile)                        *
+ * GzReader.cpp: gzip decompression with random access.                    *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "config.librpfile.h"
+#include "GzReader.hpp"
+#include "RpFile.hpp"
+
+// librpthreads
+#include "librpthreads/Atomics.h"
+
+// zlib
+#include <zlib.h>
+
+#ifndef _WIN32
+// C includes.
+#  include <unistd.h>	// getpid()
+#endif /* !_WIN32 */
+
+// C++ STL classes.
+using std::string;
+using std::vector;
+
+namespace LibRpFile {
+
+// Size of the inflate window.
+#define GZ_WINSIZE 32768U
+// Size of the compressed data buffer.
+#define GZ_CHUNK 65536U
+// Minimum distance between access points, in uncompressed bytes.
+#define GZ_SPAN_MIN (1024U*1024U)
+// Maximum number of access points.
+// If the file is larger than GZ_SPAN_MIN * GZ_POINTS_MAX,
+// the span is increased to keep the index size bounded.
+#define GZ_POINTS_MAX 1024U
+
+// Minimum compressed size for the index cache.
+// Smaller files are fast enough to decompress from the start.
+#define GZ_INDEX_CACHE_MIN_SIZE (16*1024*1024)
+// Maximum index cache file size.
+#define GZ_INDEX_CACHE_MAX_SIZE (64U*1024U*1024U)
+
+// Index cache is enabled.
+static volatile int gz_index_cache_enabled = 0;
+
+class GzReaderPrivate
+{
+	public:
+		GzReaderPrivate(GzReader::ReadAtFn readAt, void *param,
+			off64_t compressedSize, off64_t uncompressedSize);
+		~GzReaderPrivate();
+
+	private:
+		RP_DISABLE_COPY(GzReaderPrivate)
+
+	public:
+		// Compressed data.
+		GzReader::ReadAtFn readAt;
+		void *param;
+		off64_t compressedSize;
+		off64_t uncompressedSize;	// -1 if not known yet
+
+		// Decompressor state.
+		z_stream strm;
+		bool strm_init;
+		bool raw;		// True if in raw deflate mode. (restored from an access point)
+		bool eof;		// True if the end of the data has been reached.
+		int lastError;
+
+		uint8_t *in_buf;	// Compressed data buffer. [GZ_CHUNK]
+		off64_t in_next;	// Compressed position of the next in_buf refill.
+
+		// Sliding window. The last GZ_WINSIZE bytes of uncompressed
+		// data, in order, are window[win_pos..] + window[..win_pos].
+		uint8_t *window;	// [GZ_WINSIZE]
+		unsigned int win_pos;
+
+		off64_t out_pos;	// Uncompressed position of the decompressor.
+		off64_t pos;		// Uncompressed position requested by seek().
+
+		// Access point.
+		struct AccessPoint {
+			off64_t out;		// Uncompressed position.
+			off64_t in;		// Compressed position of the first full byte.
+			uint8_t bits;		// Number of bits used from the byte before in. (0-7)
+			vector<uint8_t> window;	// Window, compressed using zlib.
+		};
+		vector<AccessPoint> points;
+		off64_t span;		// Minimum distance between access points.
+		bool indexComplete;	// True if the entire file has been indexed.
+
+		// Index cache.
+		string cacheFilename;	// Empty if the index shouldn't be saved.
+		FileSystem::FileIdentity fileId;
+		size_t savedPoints;	// Number of access points in the cached index.
+		bool savedComplete;	// True if the cached index is complete.
+
+		static const char index_magic[8];
+
+	public:
+		/**
+		 * Make sure at least `need` bytes of compressed data are available.
+		 * @param need Number of bytes. (must be <= GZ_CHUNK)
+		 * @return True if available; false on end of file.
+		 */
+		bool fillInput(unsigned int need);
+
+		/**
+		 * Restart decompression from the beginning of the file.
+		 */
+		void reset(void);
+
+		/**
+		 * Restart decompression from an access point.
+		 * @param point Access point.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int restore(const AccessPoint &point);
+
+		/**
+		 * Save an access point at the current position.
+		 */
+		void addPoint(void);
+
+		/**
+		 * Handle the end of a gzip member.
+		 * If another member follows, decompression continues with it.
+		 */
+		void endOfMember(void);
+
+		/**
+		 * Decompress data.
+		 * @param ptr	[out,opt] Output data buffer. (If nullptr, data is discarded.)
+		 * @param size	[in] Amount of data to decompress, in bytes.
+		 * @return Number of bytes decompressed.
+		 */
+		size_t inflateData(uint8_t *ptr, size_t size);
+
+		/**
+		 * Move the decompressor to the requested position.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int sync(void);
+
+	public:
+		/** Index cache **/
+
+		/**
+		 * Get the index cache filename for a file.
+		 * @param fileId File identity.
+		 * @return Index cache filename, or empty string on error.
+		 */
+		static string getCacheFilename(const FileSystem::FileIdentity &fileId);
+
+		/**
+		 * Save the access point index to the cache.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int saveIndexCache(void);
+};
+
+/** GzReaderPrivate **/
+
+// Index cache magic number.
+const char GzReaderPrivate::index_magic[8] = {'R','P','G','Z','I','X','0','2'};
+
+GzReaderPrivate::GzReaderPrivate(GzReader::ReadAtFn readAt, void *param,
+	off64_t compressedSize, off64_t uncompressedSize)
+	: readAt(readAt)
+	, param(param)
+	, compressedSize(compressedSize)
+	, uncompressedSize(-1)
+	, strm_init(false)
+	, raw(false)
+	, eof(false)
+	, lastError(0)
+	, in_buf(new uint8_t[GZ_CHUNK])
+	, in_next(0)
+	, window(new uint8_t[GZ_WINSIZE])
+	, win_pos(0)
+	, out_pos(0)
+	, pos(0)
+	, indexComplete(false)
+	, savedPoints(0)
+	, savedComplete(false)
+{
+	memset(&fileId, 0, sizeof(fileId));
+
+	// NOTE: The uncompressed size in the gzip trailer is
+	// modulo 2^32, so it's only used to choose the span.
+	const off64_t sizeEstimate = std::max(compressedSize, uncompressedSize);
+	span = std::max(static_cast<off64_t>(GZ_SPAN_MIN),
+		sizeEstimate / static_cast<off64_t>(GZ_POINTS_MAX));
+
+	memset(&strm, 0, sizeof(strm));
+	// 15+16: gzip format with a 32 KB window.
+	if (inflateInit2(&strm, 15+16) == Z_OK) {
+		strm_init = true;
+	} else {
+		lastError = ENOMEM;
+	}
+}
+
+GzReaderPrivate::~GzReaderPrivate()
+{
+	if (!cacheFilename.empty() && !points.empty() &&
+	    (points.size() > savedPoints || indexComplete != savedComplete))
+	{
+		// The index has grown since it was loaded.
+		saveIndexCache();
+	}
+
+	if (strm_init) {
+		inflateEnd(&strm);
+	}
+	delete[] in_buf;
+	delete[] window;
+}
+
+/**
+ * Make sure at least `need` bytes of compressed data are available.
+ * @param need Number of bytes. (must be <= GZ_CHUNK)
+ * @return True if available; false on end of file.
+ */
+bool GzReaderPrivate::fillInput(unsigned int need)
+{
+	assert(need <= GZ_CHUNK);
+	if (strm.avail_in >= need)
+		return true;
+
+	// Move the remaining data to the start of the buffer.
+	if (strm.avail_in > 0 && strm.next_in != in_buf) {
+		memmove(in_buf, strm.next_in, strm.avail_in);
+	}
+	strm.next_in = in_buf;
+
+	const size_t size = readAt(param, in_next, &in_buf[strm.avail_in], GZ_CHUNK - strm.avail_in);
+	in_next += size;
+	strm.avail_in += static_cast<uInt>(size);
+	return (strm.avail_in >= need);
+}
+
+/**
+ * Restart decompression from the beginning of the file.
+ */
+void GzReaderPrivate::reset(void)
+{
+	inflateReset2(&strm, 15+16);
+	raw = false;
+	eof = false;
+	strm.next_in = in_buf;
+	strm.avail_in = 0;
+	in_next = 0;
+	win_pos = 0;
+	out_pos = 0;
+}
+
+/**
+ * Restart decompression from an access point.
+ * @param point Access point.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GzReaderPrivate::restore(const AccessPoint &point)
+{
+	// Decompress the window.
+	uLongf winSize = GZ_WINSIZE;
+	if (uncompress(window, &winSize, point.window.data(), point.window.size()) != Z_OK ||
+	    winSize != GZ_WINSIZE)
+	{
+		// Corrupted window.
+		return -EIO;
+	}
+
+	// Access points are always within a deflate stream.
+	inflateReset2(&strm, -15);
+	raw = true;
+	eof = false;
+	strm.next_in = in_buf;
+	strm.avail_in = 0;
+	in_next = point.in - (point.bits ? 1 : 0);
+	if (point.bits) {
+		// Feed the remaining bits of the previous byte.
+		if (!fillInput(1)) {
+			return -EIO;
+		}
+		const int byte = *strm.next_in;
+		strm.next_in++;
+		strm.avail_in--;
+		inflatePrime(&strm, point.bits, byte >> (8 - point.bits));
+	}
+	inflateSetDictionary(&strm, window, GZ_WINSIZE);
+
+	// The window is now in order.
+	win_pos = 0;
+	out_pos = point.out;
+	return 0;
+}
+
+/**
+ * Save an access point at the current position.
+ */
+void GzReaderPrivate::addPoint(void)
+{
+	points.resize(points.size() + 1);
+	AccessPoint &point = points.back();
+	point.out = out_pos;
+	point.in = in_next - strm.avail_in;
+	point.bits = static_cast<uint8_t>(strm.data_type & 7);
+
+	// Get the window in order, then compress it.
+	// Disc images usually have a lot of padding,
+	// so this significantly reduces the index size.
+	uint8_t *const tmp = new uint8_t[GZ_WINSIZE];
+	memcpy(tmp, &window[win_pos], GZ_WINSIZE - win_pos);
+	memcpy(&tmp[GZ_WINSIZE - win_pos], window, win_pos);
+	uLongf cSize = compressBound(GZ_WINSIZE);
+	point.window.resize(cSize);
+	if (compress2(point.window.data(), &cSize, tmp, GZ_WINSIZE, Z_BEST_SPEED) == Z_OK) {
+		point.window.resize(cSize);
+		point.window.shrink_to_fit();
+	} else {
+		// Unable to compress the window.
+		points.pop_back();
+	}
+	delete[] tmp;
+}
+
+/**
+ * Handle the end of a gzip member.
+ * If another member follows, decompression continues with it.
+ */
+void GzReaderPrivate::endOfMember(void)
+{
+	if (raw) {
+		// Raw deflate mode doesn't process the gzip trailer.
+		// Skip the CRC32 and ISIZE fields.
+		if (!fillInput(8)) {
+			eof = true;
+			return;
+		}
+		strm.next_in += 8;
+		strm.avail_in -= 8;
+	}
+
+	// Check for another gzip member.
+	// Anything else after the first member is ignored, like gzread().
+	if (!fillInput(2) || strm.next_in[0] != 0x1F || strm.next_in[1] != 0x8B) {
+		eof = true;
+		return;
+	}
+	inflateReset2(&strm, 15+16);
+	raw = false;
+}
+
+/**
+ * Decompress data.
+ * @param ptr	[out,opt] Output data buffer. (If nullptr, data is discarded.)
+ * @param size	[in] Amount of data to decompress, in bytes.
+ * @return Number of bytes decompressed.
+ */
+size_t GzReaderPrivate::inflateData(uint8_t *ptr, size_t size)
+{
+	size_t ret = 0;
+	while (size > 0 && !eof) {
+		if (strm.avail_in == 0 && !fillInput(1)) {
+			// Unexpected end of file.
+			eof = true;
+			lastError = EIO;
+			break;
+		}
+
+		// Decompress into the window, then copy the data.
+		if (win_pos == GZ_WINSIZE) {
+			win_pos = 0;
+		}
+		uint8_t *const out = &window[win_pos];
+		const unsigned int avail = static_cast<unsigned int>(
+			std::min(static_cast<size_t>(GZ_WINSIZE - win_pos), size));
+		strm.next_out = out;
+		strm.avail_out = avail;
+
+		// Z_BLOCK: Stop at deflate block boundaries so
+		// access points can be saved.
+		const int zret = inflate(&strm, Z_BLOCK);
+		const unsigned int have = avail - strm.avail_out;
+		if (ptr) {
+			memcpy(ptr, out, have);
+			ptr += have;
+		}
+		win_pos += have;
+		out_pos += have;
+		size -= have;
+		ret += have;
+
+		if (zret == Z_STREAM_END) {
+			endOfMember();
+		} else if (zret != Z_OK && zret != Z_BUF_ERROR) {
+			// Decompression error.
+			eof = true;
+			lastError = (zret == Z_MEM_ERROR ? ENOMEM : EIO);
+			break;
+		} else if (!indexComplete && (strm.data_type & 128) && !(strm.data_type & 64) &&
+			   out_pos >= (points.empty() ? 0 : points.back().out) + span)
+		{
+			// End of a deflate block that isn't the last block,
+			// and we've decompressed at least one span since the
+			// last access point.
+			addPoint();
+		}
+	}
+
+	if (eof && lastError == 0 && !indexComplete) {
+		// The entire file has been indexed.
+		indexComplete = true;
+		uncompressedSize = out_pos;
+	}
+	return ret;
+}
+
+/**
+ * Move the decompressor to the requested position.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GzReaderPrivate::sync(void)
+{
+	if (pos == out_pos)
+		return 0;
+
+	if (pos < out_pos || pos - out_pos > span) {
+		// Find the last access point at or before pos.
+		auto iter = std::upper_bound(points.cbegin(), points.cend(), pos,
+			[](off64_t pos, const AccessPoint &point) {
+				return pos < point.out;
+			});
+		const AccessPoint *const point = (iter != points.cbegin() ? &(*(iter - 1)) : nullptr);
+
+		if (point && (pos < out_pos || point->out > out_pos)) {
+			int ret = restore(*point);
+			if (ret != 0) {
+				// Unable to restore the access point.
+				// Start from the beginning instead.
+				reset();
+			}
+		} else if (pos < out_pos) {
+			reset();
+		}
+	}
+
+	// Decompress and discard data up to pos.
+	if (pos > out_pos) {
+		inflateData(nullptr, static_cast<size_t>(pos - out_pos));
+	}
+	return (pos == out_pos ? 0 : -EIO);
+}
+
+/** Index cache **/
+
+/**
+ * Get the index cache filename for a file.
+ * @param fileId File identity.
+ * @return Index cache filename, or empty string on error.
+ */
+string GzReaderPrivate::getCacheFilename(const FileSystem::FileIdentity &fileId)
+{
+	const string &cache_dir = FileSystem::getCacheDirectory();
+	if (cache_dir.empty())
+		return string();
+
+	// Same layout as the ROM data index.
+	// Format: gzindex/[dev]/[ino & 0xFF]/[ino].gzidx
+	char buf[80];
+	snprintf(buf, sizeof(buf), "gzindex%c%08X%08X%c%02X%c%08X%08X.gzidx",
+		static_cast<char>(DIR_SEP_CHR),
+		static_cast<uint32_t>(fileId.dev >> 32), static_cast<uint32_t>(fileId.dev),
+		static_cast<char>(DIR_SEP_CHR),
+		static_cast<unsigned int>(fileId.ino & 0xFF),
+		static_cast<char>(DIR_SEP_CHR),
+		static_cast<uint32_t>(fileId.ino >> 32), static_cast<uint32_t>(fileId.ino));
+
+	string filename = cache_dir;
+	if (filename.at(filename.size()-1) != DIR_SEP_CHR) {
+		filename += DIR_SEP_CHR;
+	}
+	filename += buf;
+	return filename;
+}
+
+/**
+ * Append a 64-bit little-endian value to a buffer.
+ * @param buf Buffer.
+ * @param val Value.
+ */
+static inline void append_u64(vector<uint8_t> &buf, uint64_t val)
+{
+	val = cpu_to_le64(val);
+	const uint8_t *const p = reinterpret_cast<const uint8_t*>(&val);
+	buf.insert(buf.end(), p, p + sizeof(val));
+}
+
+/**
+ * Read a 64-bit little-endian value from a buffer.
+ * @param p	[in/out] Buffer pointer. (Incremented by 8.)
+ * @return Value.
+ */
+static inline uint64_t read_u64(const uint8_t *&p)
+{
+	uint64_t val;
+	memcpy(&val, p, sizeof(val));
+	p += sizeof(val);
+	return le64_to_cpu(val);
+}
+
+/**
+ * Save the access point index to the cache.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GzReaderPrivate::saveIndexCache(void)
+{
+	assert(!cacheFilename.empty());
+
+	// Format: (all values are little-endian)
+	// - Magic: "RPGZIX02"
+	// - File identity: dev, ino, size, mtime [u64 each]
+	// - Uncompressed size (-1 if the index is incomplete),
+	//   span, number of access points [u64 each]
+	// - Access points: out, in, bits, window size [u64 each], then the window
+	// - CRC32 of everything above [u32]
+	vector<uint8_t> buf;
+	buf.reserve(8 + (7*8) + (points.size() * (4*8 + 8192)) + 4);
+	buf.insert(buf.end(), index_magic, index_magic + sizeof(index_magic));
+	append_u64(buf, fileId.dev);
+	append_u64(buf, fileId.ino);
+	append_u64(buf, static_cast<uint64_t>(fileId.size));
+	append_u64(buf, static_cast<uint64_t>(fileId.mtime));
+	append_u64(buf, static_cast<uint64_t>(uncompressedSize));
+	append_u64(buf, static_cast<uint64_t>(span));
+	append_u64(buf, points.size());
+	for (const AccessPoint &point : points) {
+		append_u64(buf, static_cast<uint64_t>(point.out));
+		append_u64(buf, static_cast<uint64_t>(point.in));
+		append_u64(buf, point.bits);
+		append_u64(buf, point.window.size());
+		buf.insert(buf.end(), point.window.cbegin(), point.window.cend());
+	}
+
+	// NOTE: The access point fields can't be fully validated
+	// when loading the index, so a CRC32 is used to detect
+	// corrupted index files.
+	const uint32_t crc = cpu_to_le32(static_cast<uint32_t>(crc32(0, buf.data(), static_cast<uInt>(buf.size()))));
+	const uint8_t *const p_crc = reinterpret_cast<const uint8_t*>(&crc);
+	buf.insert(buf.end(), p_crc, p_crc + sizeof(crc));
+	if (buf.size() > GZ_INDEX_CACHE_MAX_SIZE) {
+		// Index is too big.
+		return -ENOSPC;
+	}
+
+	const string &filename = cacheFilename;
+
+	// Make sure the index subdirectory exists.
+	// NOTE: rmkdir() ignores the last component.
+	int ret = FileSystem::rmkdir(filename);
+	if (ret != 0)
+		return ret;
+
+	// Write to a temporary file, then rename it, so other
+	// processes will never see a partial index.
+	static volatile int tmpCounter = 0;
+	char tmpSuffix[48];
+	snprintf(tmpSuffix, sizeof(tmpSuffix), ".%u-%d.tmp",
+#ifdef _WIN32
+		static_cast<unsigned int>(GetCurrentProcessId()),
+#else /* !_WIN32 */
+		static_cast<unsigned int>(getpid()),
+#endif /* _WIN32 */
+		ATOMIC_INC_FETCH(&tmpCounter));
+	const string tmpFilename = filename + tmpSuffix;
+
+	RpFile *const file = new RpFile(tmpFilename, RpFile::FM_CREATE_WRITE);
+	if (!file->isOpen()) {
+		ret = -file->lastError();
+		file->unref();
+		return (ret != 0 ? ret : -EIO);
+	}
+	const size_t size = file->write(buf.data(), buf.size());
+	file->unref();
+	if (size != buf.size()) {
+		// Short write.
+		FileSystem::delete_file(tmpFilename);
+		return -EIO;
+	}
+
+	ret = FileSystem::rename_file(tmpFilename, filename);
+	if (ret != 0) {
+		FileSystem::delete_file(tmpFilename);
+	}
+	return ret;
+}
+
+/** GzReader **/
+
+/**
+ * Create a GzReader.
+ * The gzip header is not checked here.
+ * @param readAt		[in] Read function for the compressed data.
+ * @param param			[in] User parameter for readAt.
+ * @param compressedSize	[in] Compressed file size.
+ * @param uncompressedSize	[in] Uncompressed size from the gzip trailer. (Only used as a hint.)
+ */
+GzReader::GzReader(ReadAtFn readAt, void *param, off64_t compressedSize, off64_t uncompressedSize)
+	: d_ptr(new GzReaderPrivate(readAt, param, compressedSize, uncompressedSize))
+{ }
+
+GzReader::~GzReader()
+{
+	delete d_ptr;
+}
+
+/**
+ * Is the decompressor initialized?
+ * @return True if it is; false if not.
+ */
+bool GzReader::isOpen(void) const
+{
+	RP_D(const GzReader);
+	return d->strm_init;
+}
+
+/**
+ * Get the last error.
+ * @return Last POSIX error, or 0 if no error.
+ */
+int GzReader::lastError(void) const
+{
+	RP_D(const GzReader);
+	return d->lastError;
+}
+
+/**
+ * Read uncompressed data.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t GzReader::read(void *ptr, size_t size)
+{
+	RP_D(GzReader);
+	if (!d->strm_init) {
+		d->lastError = EBADF;
+		return 0;
+	}
+
+	if (d->sync() != 0) {
+		// Seek position is past the end of the data.
+		return 0;
+	}
+
+	const size_t ret = d->inflateData(static_cast<uint8_t*>(ptr), size);
+	d->pos += ret;
+	return ret;
+}
+
+/**
+ * Set the uncompressed position.
+ * The data is decompressed on the next read().
+ * Like gzseek(), seeking past the end of the data is allowed.
+ * @param pos Uncompressed position.
+ * @return 0 on success; -1 on error.
+ */
+int GzReader::seek(off64_t pos)
+{
+	RP_D(GzReader);
+	if (pos < 0) {
+		d->lastError = EINVAL;
+		return -1;
+	}
+	d->pos = pos;
+	return 0;
+}
+
+/**
+ * Get the uncompressed position.
+ * @return Uncompressed position.
+ */
+off64_t GzReader::tell(void) const
+{
+	RP_D(const GzReader);
+	return d->pos;
+}
+
+/**
+ * Get the uncompressed size.
+ * This is only known if the entire file has been
+ * decompressed, or if the index was loaded from the cache.
+ * @return Uncompressed size, or -1 if not known yet.
+ */
+off64_t GzReader::uncompressedSize(void) const
+{
+	RP_D(const GzReader);
+	return d->uncompressedSize;
+}
+
+/** Index cache **/
+
+/**
+ * Enable or disable the index cache.
+ * @param enable True to enable; false to disable.
+ */
+void GzReader::setIndexCacheEnabled(bool enable)
+{
+	ATOMIC_EXCHANGE(&gz_index_cache_enabled, enable ? 1 : 0);
+}
+
+/**
+ * Is the index cache enabled?
+ * @return True if enabled; false if not.
+ */
+bool GzReader::isIndexCacheEnabled(void)
+{
+	return (ATOMIC_LOAD(&gz_index_cache_enabled) != 0);
+}
+
+/**
+ * Load the access point index from the cache.
+ *
+ * If the index isn't cached, if the file has changed, or if
+ * more access points are added, the index will be saved to
+ * the cache when the GzReader is deleted.
+ *
+ * @param fileId File identity of the compressed file.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int GzReader::loadIndexCache(const FileSystem::FileIdentity &fileId)
+{
+	RP_D(GzReader);
+	if (!d->strm_init) {
+		return -EBADF;
+	} else if (!isIndexCacheEnabled() || fileId.size < GZ_INDEX_CACHE_MIN_SIZE) {
+		// Index cache is disabled, or the file is too small.
+		return -ENOTSUP;
+	}
+
+	string filename = GzReaderPrivate::getCacheFilename(fileId);
+	if (filename.empty()) {
+		return -ENOENT;
+	}
+
+	// If the index can't be loaded, save it when the GzReader is deleted.
+	d->fileId = fileId;
+	d->cacheFilename = filename;
+
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ);
+	if (!file->isOpen()) {
+		// Index isn't cached.
+		int ret = -file->lastError();
+		file->unref();
+		return (ret != 0 ? ret : -ENOENT);
+	}
+
+	const off64_t fileSize = file->size();
+	if (fileSize < static_cast<off64_t>(sizeof(GzReaderPrivate::index_magic) + (7*8) + 4) ||
+	    fileSize > static_cast<off64_t>(GZ_INDEX_CACHE_MAX_SIZE))
+	{
+		// Invalid index size.
+		file->unref();
+		return -EIO;
+	}
+	vector<uint8_t> buf(static_cast<size_t>(fileSize));
+	const size_t size = file->read(buf.data(), buf.size());
+	file->unref();
+	if (size != buf.size()) {
+		// Short read.
+		return -EIO;
+	}
+
+	// Check the CRC32.
+	const uint8_t *p = buf.data();
+	const uint8_t *const p_end = p + buf.size() - 4;
+	uint32_t crc;
+	memcpy(&crc, p_end, sizeof(crc));
+	if (le32_to_cpu(crc) != static_cast<uint32_t>(crc32(0, p, static_cast<uInt>(p_end - p)))) {
+		// Index is corrupted.
+		return -EIO;
+	}
+
+	// Check the header.
+	if (memcmp(p, GzReaderPrivate::index_magic, sizeof(GzReaderPrivate::index_magic)) != 0) {
+		// Incorrect magic number.
+		return -EIO;
+	}
+	p += sizeof(GzReaderPrivate::index_magic);
+	const uint64_t dev = read_u64(p);
+	const uint64_t ino = read_u64(p);
+	const off64_t fsize = static_cast<off64_t>(read_u64(p));
+	const time_t mtime = static_cast<time_t>(read_u64(p));
+	if (dev != fileId.dev || ino != fileId.ino ||
+	    fsize != fileId.size || mtime != fileId.mtime)
+	{
+		// File has changed.
+		return -ESTALE;
+	}
+
+	const off64_t uncompressedSize = static_cast<off64_t>(read_u64(p));
+	const off64_t span = static_cast<off64_t>(read_u64(p));
+	const uint64_t count = read_u64(p);
+	if (uncompressedSize < -1 || span < static_cast<off64_t>(GZ_SPAN_MIN) ||
+	    count > GZ_INDEX_CACHE_MAX_SIZE / (4*8))
+	{
+		// Invalid header.
+		return -EIO;
+	}
+
+	// Load the access points.
+	vector<GzReaderPrivate::AccessPoint> points(static_cast<size_t>(count));
+	off64_t prev_out = 0;
+	for (GzReaderPrivate::AccessPoint &point : points) {
+		if (p_end - p < (4*8)) {
+			return -EIO;
+		}
+		point.out = static_cast<off64_t>(read_u64(p));
+		point.in = static_cast<off64_t>(read_u64(p));
+		const uint64_t bits = read_u64(p);
+		const uint64_t winSize = read_u64(p);
+		if (point.out <= prev_out || (uncompressedSize >= 0 && point.out > uncompressedSize) ||
+		    point.in <= 0 || point.in > fileId.size || bits > 7 ||
+		    winSize == 0 || winSize > static_cast<uint64_t>(p_end - p))
+		{
+			// Invalid access point.
+			return -EIO;
+		}
+		point.bits = static_cast<uint8_t>(bits);
+		point.window.assign(p, p + winSize);
+		p += winSize;
+		prev_out = point.out;
+	}
+	if (p != p_end) {
+		// Extra data after the access points.
+		return -EIO;
+	}
+
+	// Index loaded.
+	// NOTE: An incomplete index is extended as more of the
+	// file is decompressed.
+	d->points = std::move(points);
+	d->span = span;
+	d->uncompressedSize = uncompressedSize;
+	d->indexComplete = (uncompressedSize >= 0);
+	d->savedPoints = d->points.size();
+	d->savedComplete = d->indexComplete;
+	return 0;
+}
+
+}
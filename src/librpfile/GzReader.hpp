@@ -0,0 +1,147 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile)                        *
+ * GzReader.hpp: gzip decompression with random access.                    *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPFILE_GZREADER_HPP__
+#define __ROMPROPERTIES_LIBRPFILE_GZREADER_HPP__
+
+#include "FileSystem.hpp"
+
+// C includes.
+#include <stdint.h>
+
+// C++ includes.
+#include <string>
+
+// common macros
+#include "common.h"
+
+namespace LibRpFile {
+
+/**
+ * gzip decompression with random access.
+ *
+ * While data is decompressed, an access point is saved
+ * every "span" bytes of uncompressed data. Each access point
+ * has the decompressor's bit position and the last 32 KB of
+ * uncompressed data, so decompression can be restarted from
+ * that point. Seeking then only needs to decompress at most
+ * one span instead of restarting from the beginning of the file.
+ *
+ * Based on zran.c from the zlib distribution.
+ *
+ * The access point index can be saved in the cache directory
+ * so it doesn't need to be rebuilt the next time the file is
+ * opened. This is disabled by default; see setIndexCacheEnabled().
+ */
+class GzReaderPrivate;
+class GzReader
+{
+	public:
+		/**
+		 * Read function for the compressed data.
+		 * @param param	[in] User parameter.
+		 * @param pos	[in] Position in the compressed file.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read. (Less than size on end of file or error.)
+		 */
+		typedef size_t (*ReadAtFn)(void *param, off64_t pos, void *ptr, size_t size);
+
+		/**
+		 * Create a GzReader.
+		 * The gzip header is not checked here.
+		 * @param readAt		[in] Read function for the compressed data.
+		 * @param param			[in] User parameter for readAt.
+		 * @param compressedSize	[in] Compressed file size.
+		 * @param uncompressedSize	[in] Uncompressed size from the gzip trailer. (Only used as a hint.)
+		 */
+		GzReader(ReadAtFn readAt, void *param, off64_t compressedSize, off64_t uncompressedSize);
+		~GzReader();
+
+	private:
+		RP_DISABLE_COPY(GzReader)
+	private:
+		friend class GzReaderPrivate;
+		GzReaderPrivate *const d_ptr;
+
+	public:
+		/**
+		 * Is the decompressor initialized?
+		 * @return True if it is; false if not.
+		 */
+		bool isOpen(void) const;
+
+		/**
+		 * Get the last error.
+		 * @return Last POSIX error, or 0 if no error.
+		 */
+		int lastError(void) const;
+
+		/**
+		 * Read uncompressed data.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 2, 3)
+		size_t read(void *ptr, size_t size);
+
+		/**
+		 * Set the uncompressed position.
+		 * The data is decompressed on the next read().
+		 * Like gzseek(), seeking past the end of the data is allowed.
+		 * @param pos Uncompressed position.
+		 * @return 0 on success; -1 on error.
+		 */
+		int seek(off64_t pos);
+
+		/**
+		 * Get the uncompressed position.
+		 * @return Uncompressed position.
+		 */
+		off64_t tell(void) const;
+
+		/**
+		 * Get the uncompressed size.
+		 * This is only known if the entire file has been
+		 * decompressed, or if the index was loaded from the cache.
+		 * @return Uncompressed size, or -1 if not known yet.
+		 */
+		off64_t uncompressedSize(void) const;
+
+	public:
+		/** Index cache **/
+
+		/**
+		 * Enable or disable the index cache.
+		 * @param enable True to enable; false to disable.
+		 */
+		static void setIndexCacheEnabled(bool enable);
+
+		/**
+		 * Is the index cache enabled?
+		 * @return True if enabled; false if not.
+		 */
+		static bool isIndexCacheEnabled(void);
+
+		/**
+		 * Load the access point index from the cache.
+		 *
+		 * If the index isn't cached, if the file has changed, or if
+		 * more access points are added, the index will be saved to
+		 * the cache when the GzReader is deleted.
+		 *
+		 * @param fileId File identity of the compressed file.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int loadIndexCache(const FileSystem::FileIdentity &fileId);
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPFILE_GZREADER_HPP__ */
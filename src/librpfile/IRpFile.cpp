@@ -22,6 +22,68 @@ IRpFile::IRpFile()
 	static_assert(sizeof(off64_t) == 8, "off64_t is not 64-bit!");
 }
 
+/**
+ * Read data from the file at the specified position.
+ * The file position is not changed.
+ *
+ * The default implementation uses seek() and read(),
+ * then restores the previous file position, so it is
+ * NOT thread-safe. Subclasses that can read without
+ * using the file position (e.g. RpFile with pread())
+ * override this, in which case it's safe to call
+ * readAt() from multiple threads at once as long as
+ * no other functions are called at the same time.
+ *
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t IRpFile::readAt(off64_t pos, void *ptr, size_t size)
+{
+	const off64_t prev_pos = this->tell();
+
+	size_t ret = 0;
+	if (this->seek(pos) == 0) {
+		ret = this->read(ptr, size);
+	}
+	if (prev_pos >= 0) {
+		this->seek(prev_pos);
+	}
+	return ret;
+}
+
+/**
+ * Read multiple ranges of the file at once.
+ * The file position is not changed.
+ *
+ * This is intended for reading several headers whose
+ * locations are already known. Subclasses may submit
+ * all of the requests to the OS at once, which is much
+ * faster than separate reads on high-latency storage,
+ * e.g. network filesystems or optical discs.
+ *
+ * The default implementation calls readAt() for each
+ * request, so it has the same thread-safety as readAt().
+ *
+ * NOTE: Output buffers must not overlap.
+ *
+ * @param reqs	[in/out] Read requests. (ret is set on return)
+ * @param count	[in] Number of read requests.
+ * @return Number of requests that were read completely.
+ */
+unsigned int IRpFile::readBatch(ReadRequest *reqs, unsigned int count)
+{
+	unsigned int ret = 0;
+	for (; count > 0; reqs++, count--) {
+		reqs->ret = this->readAt(reqs->pos, reqs->ptr, reqs->size);
+		if (reqs->ret == reqs->size) {
+			ret++;
+		}
+	}
+	return ret;
+}
+
 /**
  * Get a single character (byte) from the file
  * @return Character from file, or EOF on end of file or error.
@@ -101,6 +101,79 @@ class IRpFile : public RefBase
 		ATTR_ACCESS_SIZE(write_only, 2, 3)
 		virtual size_t read(void *ptr, size_t size) = 0;
 
+		/**
+		 * Read data from the file at the specified position.
+		 * The file position is not changed.
+		 *
+		 * The default implementation uses seek() and read(),
+		 * then restores the previous file position, so it is
+		 * NOT thread-safe. Subclasses that can read without
+		 * using the file position (e.g. RpFile with pread())
+		 * override this, in which case it's safe to call
+		 * readAt() from multiple threads at once as long as
+		 * no other functions are called at the same time.
+		 *
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		virtual size_t readAt(off64_t pos, void *ptr, size_t size);
+
+		/**
+		 * Read request for readBatch().
+		 */
+		struct ReadRequest {
+			off64_t pos;	// [in] File position.
+			void *ptr;	// [out] Output data buffer.
+			size_t size;	// [in] Amount of data to read, in bytes.
+			size_t ret;	// [out] Number of bytes read.
+		};
+
+		/**
+		 * Read multiple ranges of the file at once.
+		 * The file position is not changed.
+		 *
+		 * This is intended for reading several headers whose
+		 * locations are already known. Subclasses may submit
+		 * all of the requests to the OS at once, which is much
+		 * faster than separate reads on high-latency storage,
+		 * e.g. network filesystems or optical discs.
+		 *
+		 * The default implementation calls readAt() for each
+		 * request, so it has the same thread-safety as readAt().
+		 *
+		 * NOTE: Output buffers must not overlap.
+		 *
+		 * @param reqs	[in/out] Read requests. (ret is set on return)
+		 * @param count	[in] Number of read requests.
+		 * @return Number of requests that were read completely.
+		 */
+		virtual unsigned int readBatch(ReadRequest *reqs, unsigned int count);
+
+		/**
+		 * Get a direct pointer to a range of the file's data.
+		 *
+		 * This is only available if the file's contents are
+		 * already in memory, e.g. RpFile with FM_MMAP, RpMemFile,
+		 * or RpVectorFile. This allows headers to be parsed
+		 * in place instead of being copied into a buffer.
+		 *
+		 * The pointer is valid until the file is closed or
+		 * written to. The data might not be aligned.
+		 *
+		 * @param pos	[in] File position.
+		 * @param size	[in] Size of the range, in bytes.
+		 * @return Pointer to the data, or nullptr if not available or out of range.
+		 */
+		virtual const uint8_t *dataPtr(off64_t pos, size_t size)
+		{
+			RP_UNUSED(pos);
+			RP_UNUSED(size);
+			return nullptr;
+		}
+
 		/**
 		 * Write data to the file.
 		 * @param ptr	[in] Input data buffer.
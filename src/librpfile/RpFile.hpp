@@ -43,7 +43,15 @@ class RpFile : public IRpFile
 
 			// Extras.
 			FM_GZIP_DECOMPRESS = 4,	// Transparent gzip decompression. (read-only!)
+			// FM_MMAP: Memory-map local regular files if possible. (read-only!)
+			// NOTE: If a mapped file is truncated while it's open, reading
+			// past the new end of file raises SIGBUS, which kills the process.
+			// Only use this in short-lived programs, e.g. rpcli; never in
+			// thumbnailers or plugins that run in long-lived processes.
+			FM_MMAP = 8,
 			FM_OPEN_READ_GZ = FM_READ | FM_GZIP_DECOMPRESS,
+			FM_OPEN_READ_MMAP = FM_READ | FM_MMAP,
+			FM_OPEN_READ_GZ_MMAP = FM_READ | FM_GZIP_DECOMPRESS | FM_MMAP,
 		};
 
 		/**
@@ -88,6 +96,41 @@ class RpFile : public IRpFile
 		ATTR_ACCESS_SIZE(write_only, 2, 3)
 		size_t read(void *ptr, size_t size) final;
 
+		/**
+		 * Read data from the file at the specified position.
+		 * The file position is not changed.
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		size_t readAt(off64_t pos, void *ptr, size_t size) final;
+
+		/**
+		 * Read multiple ranges of the file at once.
+		 * The file position is not changed.
+		 *
+		 * On Linux, the requests are submitted using io_uring
+		 * if it's available. Otherwise, requests for adjacent
+		 * ranges are combined and read using preadv().
+		 *
+		 * @param reqs	[in/out] Read requests. (ret is set on return)
+		 * @param count	[in] Number of read requests.
+		 * @return Number of requests that were read completely.
+		 */
+		unsigned int readBatch(ReadRequest *reqs, unsigned int count) final;
+
+		/**
+		 * Get a direct pointer to a range of the file's data.
+		 * This is only available if the file was opened with
+		 * FM_MMAP and it could be memory-mapped.
+		 * @param pos	[in] File position.
+		 * @param size	[in] Size of the range, in bytes.
+		 * @return Pointer to the data, or nullptr if not available.
+		 */
+		const uint8_t *dataPtr(off64_t pos, size_t size) final;
+
 		/**
 		 * Write data to the file.
 		 * @param ptr Input data buffer.
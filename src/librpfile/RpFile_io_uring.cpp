@@ -0,0 +1,419 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile)                        *
+ * RpFile_io_uring.cpp: Standard file object. (io_uring batch reads)       *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "config.librpfile.h"
+
+#ifndef HAVE_IO_URING
+# error RpFile_io_uring requires io_uring.
+#endif /* HAVE_IO_URING */
+
+#include "RpFile.hpp"
+#include "RpFile_p.hpp"
+
+// librpthreads
+#include "librpthreads/Atomics.h"
+#include "librpthreads/pthread_once.h"
+
+// C includes.
+#include <fcntl.h>		// open()
+#include <linux/io_uring.h>
+#include <sys/mman.h>		// mmap(), munmap()
+#include <sys/syscall.h>	// __NR_io_uring_setup, __NR_io_uring_enter
+#include <sched.h>		// sched_yield()
+#include <sys/uio.h>		// struct iovec
+#include <unistd.h>		// syscall()
+
+// C++ STL classes.
+using std::unique_ptr;
+
+namespace LibRpFile {
+
+// NOTE: liburing isn't used, since it's not available on
+// all systems and we only need a small subset of it.
+
+// Maximum number of requests in flight at once.
+#define IO_URING_MAX_ENTRIES 64
+
+// Set if io_uring can't be used in this process.
+static volatile int io_uring_disabled = 0;
+static pthread_once_t io_uring_once_control = PTHREAD_ONCE_INIT;
+
+/**
+ * Check if io_uring can be used in this process.
+ * Called by pthread_once().
+ *
+ * io_uring can't be used if a seccomp filter is active,
+ * since the filter would most likely kill the process.
+ * (The sandboxed programs enable seccomp at startup,
+ * before any files are read.)
+ */
+static void io_uring_check(void)
+{
+	// Check the "Seccomp:" line in /proc/self/status.
+	// If it can't be read, assume io_uring isn't usable.
+	int disabled = 1;
+	int fd = open("/proc/self/status", O_RDONLY | O_CLOEXEC);
+	if (fd >= 0) {
+		char buf[4096];
+		ssize_t sz = read(fd, buf, sizeof(buf)-1);
+		if (sz > 0) {
+			buf[sz] = '\0';
+			const char *p = strstr(buf, "\nSeccomp:");
+			if (p) {
+				p += 9;
+				while (*p == ' ' || *p == '\t') {
+					p++;
+				}
+				// 0 == seccomp is disabled.
+				disabled = (*p != '0');
+			}
+		}
+		::close(fd);
+	}
+
+	if (disabled) {
+		ATOMIC_EXCHANGE(&io_uring_disabled, 1);
+	}
+}
+
+/**
+ * Minimal io_uring wrapper.
+ */
+class IoUring
+{
+	public:
+		IoUring()
+			: sq_entries(0)
+			, ring_fd(-1)
+			, sq_ptr(MAP_FAILED), sq_ptr_sz(0)
+			, cq_ptr(MAP_FAILED), cq_ptr_sz(0)
+			, sqes(static_cast<struct io_uring_sqe*>(MAP_FAILED)), sqes_sz(0)
+		{ }
+
+		~IoUring()
+		{
+			reset();
+		}
+
+	private:
+		RP_DISABLE_COPY(IoUring)
+
+	public:
+		/**
+		 * Is the ring initialized?
+		 * @return True if initialized; false if not.
+		 */
+		inline bool isInit(void) const
+		{
+			return (ring_fd >= 0);
+		}
+
+		/**
+		 * Close the ring and unmap its memory.
+		 * NOTE: No requests may be in flight.
+		 */
+		void reset(void)
+		{
+			if (sqes != MAP_FAILED) {
+				munmap(sqes, sqes_sz);
+				sqes = static_cast<struct io_uring_sqe*>(MAP_FAILED);
+			}
+			if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) {
+				munmap(cq_ptr, cq_ptr_sz);
+			}
+			cq_ptr = MAP_FAILED;
+			if (sq_ptr != MAP_FAILED) {
+				munmap(sq_ptr, sq_ptr_sz);
+				sq_ptr = MAP_FAILED;
+			}
+			if (ring_fd >= 0) {
+				::close(ring_fd);
+				ring_fd = -1;
+			}
+			sq_entries = 0;
+		}
+
+		/**
+		 * Initialize the ring.
+		 * @param entries Number of submission queue entries.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int init(unsigned int entries)
+		{
+			struct io_uring_params p;
+			memset(&p, 0, sizeof(p));
+			ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &p));
+			if (ring_fd < 0) {
+				return -errno;
+			}
+
+			sq_entries = p.sq_entries;
+			sq_ptr_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+			cq_ptr_sz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+			const bool single_mmap = !!(p.features & IORING_FEAT_SINGLE_MMAP);
+			if (single_mmap) {
+				sq_ptr_sz = std::max(sq_ptr_sz, cq_ptr_sz);
+			}
+
+			sq_ptr = mmap(nullptr, sq_ptr_sz, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+			if (sq_ptr == MAP_FAILED) {
+				return -errno;
+			}
+			if (single_mmap) {
+				cq_ptr = sq_ptr;
+			} else {
+				cq_ptr = mmap(nullptr, cq_ptr_sz, PROT_READ | PROT_WRITE,
+					MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+				if (cq_ptr == MAP_FAILED) {
+					return -errno;
+				}
+			}
+
+			sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+			sqes = static_cast<struct io_uring_sqe*>(mmap(nullptr, sqes_sz,
+				PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+				ring_fd, IORING_OFF_SQES));
+			if (sqes == MAP_FAILED) {
+				return -errno;
+			}
+
+			uint8_t *const sq8 = static_cast<uint8_t*>(sq_ptr);
+			sq_head  = reinterpret_cast<unsigned int*>(sq8 + p.sq_off.head);
+			sq_tail  = reinterpret_cast<unsigned int*>(sq8 + p.sq_off.tail);
+			sq_mask  = *reinterpret_cast<unsigned int*>(sq8 + p.sq_off.ring_mask);
+			sq_array = reinterpret_cast<unsigned int*>(sq8 + p.sq_off.array);
+
+			uint8_t *const cq8 = static_cast<uint8_t*>(cq_ptr);
+			cq_head = reinterpret_cast<unsigned int*>(cq8 + p.cq_off.head);
+			cq_tail = reinterpret_cast<unsigned int*>(cq8 + p.cq_off.tail);
+			cq_mask = *reinterpret_cast<unsigned int*>(cq8 + p.cq_off.ring_mask);
+			cqes = reinterpret_cast<struct io_uring_cqe*>(cq8 + p.cq_off.cqes);
+			return 0;
+		}
+
+		/**
+		 * Queue a readv request.
+		 * The caller must ensure the submission queue isn't full.
+		 * @param fd File descriptor.
+		 * @param iov iovec. (must be valid until the request completes)
+		 * @param pos File position.
+		 * @param user_data User data.
+		 */
+		void queueReadv(int fd, const struct iovec *iov, off64_t pos, uint64_t user_data)
+		{
+			// NOTE: Only this thread writes to the SQ tail.
+			const unsigned int tail = *sq_tail;
+			const unsigned int idx = tail & sq_mask;
+			struct io_uring_sqe *const sqe = &sqes[idx];
+			memset(sqe, 0, sizeof(*sqe));
+			sqe->opcode = IORING_OP_READV;
+			sqe->fd = fd;
+			sqe->addr = reinterpret_cast<uint64_t>(iov);
+			sqe->len = 1;
+			sqe->off = static_cast<uint64_t>(pos);
+			sqe->user_data = user_data;
+			sq_array[idx] = idx;
+
+			// Make the SQE visible to the kernel before the tail update.
+			__atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+		}
+
+		/**
+		 * Discard requests that were queued but not submitted.
+		 * This must be done if submission fails; otherwise, the
+		 * stale SQEs would be submitted by the next batch.
+		 */
+		void discardQueued(void)
+		{
+			// The kernel advances the SQ head when it consumes SQEs.
+			__atomic_store_n(sq_tail, __atomic_load_n(sq_head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+		}
+
+		/**
+		 * Submit queued requests and wait for completions.
+		 * @param to_submit Number of queued requests.
+		 * @param min_complete Minimum number of completions to wait for.
+		 * @return Number of requests submitted, or negative POSIX error code on error.
+		 */
+		int enter(unsigned int to_submit, unsigned int min_complete)
+		{
+			long ret = syscall(__NR_io_uring_enter, ring_fd, to_submit,
+				min_complete, IORING_ENTER_GETEVENTS, nullptr, 0);
+			return (ret >= 0 ? static_cast<int>(ret) : -errno);
+		}
+
+		/**
+		 * Get the next completion, if one is available.
+		 * @param pUserData	[out] User data.
+		 * @param pRes		[out] Result.
+		 * @return True if a completion was returned; false if none are available.
+		 */
+		bool popCompletion(uint64_t *pUserData, int32_t *pRes)
+		{
+			const unsigned int head = *cq_head;
+			if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+				// No completions.
+				return false;
+			}
+
+			const struct io_uring_cqe *const cqe = &cqes[head & cq_mask];
+			*pUserData = cqe->user_data;
+			*pRes = cqe->res;
+			__atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+			return true;
+		}
+
+	public:
+		unsigned int sq_entries;
+
+	private:
+		int ring_fd;
+
+		void *sq_ptr;
+		size_t sq_ptr_sz;
+		void *cq_ptr;
+		size_t cq_ptr_sz;
+		struct io_uring_sqe *sqes;
+		size_t sqes_sz;
+
+		// Submission queue.
+		unsigned int *sq_head;
+		unsigned int *sq_tail;
+		unsigned int sq_mask;
+		unsigned int *sq_array;
+
+		// Completion queue.
+		unsigned int *cq_head;
+		unsigned int *cq_tail;
+		unsigned int cq_mask;
+		struct io_uring_cqe *cqes;
+};
+
+/**
+ * Read multiple ranges of the file at once using io_uring.
+ * @param fd	[in] File descriptor.
+ * @param reqs	[in/out] Read requests.
+ * @param count	[in] Number of read requests.
+ * @return Number of requests that were read completely, or negative POSIX error code if io_uring isn't available.
+ */
+int RpFilePrivate::readBatch_io_uring(int fd, IRpFile::ReadRequest *reqs, unsigned int count)
+{
+	pthread_once(&io_uring_once_control, io_uring_check);
+	if (ATOMIC_LOAD(&io_uring_disabled)) {
+		return -ENOSYS;
+	}
+
+	// NOTE: Each thread has its own ring so this function
+	// is thread-safe, like readAt(). The ring is set up on
+	// first use and reused for subsequent batches.
+	static thread_local IoUring ring;
+	if (!ring.isInit()) {
+		int ret = ring.init(IO_URING_MAX_ENTRIES);
+		if (ret != 0) {
+			ring.reset();
+			if (ret == -ENOSYS || ret == -EPERM) {
+				// io_uring is not supported by the kernel,
+				// or it has been disabled by the administrator.
+				ATOMIC_EXCHANGE(&io_uring_disabled, 1);
+			}
+			return ret;
+		}
+	}
+
+	unique_ptr<struct iovec[]> iov(new struct iovec[count]);
+	for (unsigned int i = 0; i < count; i++) {
+		reqs[i].ret = 0;
+		iov[i].iov_base = reqs[i].ptr;
+		iov[i].iov_len = reqs[i].size;
+	}
+
+	unsigned int inflight = 0;	// Submitted but not completed.
+	auto reapCompletions = [reqs, count, &inflight]() {
+		uint64_t user_data;
+		int32_t res;
+		while (ring.popCompletion(&user_data, &res)) {
+			assert(user_data < count);
+			assert(inflight > 0);
+			inflight--;
+			if (res > 0) {
+				reqs[user_data].ret = static_cast<size_t>(res);
+			}
+			// NOTE: Errors and short reads are handled below.
+		}
+	};
+
+	// Submit the requests, keeping up to sq_entries in flight.
+	unsigned int next = 0;		// Next request to queue.
+	unsigned int queued = 0;	// Queued but not submitted.
+	while (next < count || queued > 0 || inflight > 0) {
+		while (next < count && queued + inflight < ring.sq_entries) {
+			if (reqs[next].size != 0) {
+				ring.queueReadv(fd, &iov[next], reqs[next].pos, next);
+				queued++;
+			}
+			next++;
+		}
+		if (queued == 0 && inflight == 0)
+			break;
+
+		const int ret = ring.enter(queued, 1);
+		if (ret < 0) {
+			if (ret == -EINTR || ret == -EAGAIN || ret == -EBUSY) {
+				// Try again.
+				continue;
+			}
+			// Submission failed. Discard the unsubmitted SQEs and
+			// stop queueing requests; the remaining ones will be
+			// read with pread() below.
+			ring.discardQueued();
+			queued = 0;
+			break;
+		}
+		queued -= ret;
+		inflight += ret;
+		reapCompletions();
+	}
+
+	// If submission failed, some requests may still be in flight.
+	// The kernel writes to the output buffers until they complete,
+	// so wait for all of them before using pread() or returning.
+	bool broken = false;
+	while (inflight > 0) {
+		const int ret = ring.enter(0, inflight);
+		if (ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY) {
+			// Can't wait in the kernel. Poll for completions instead,
+			// and don't reuse the ring afterwards.
+			broken = true;
+			sched_yield();
+		}
+		reapCompletions();
+	}
+	if (broken) {
+		ring.reset();
+	}
+
+	// Finish any requests that weren't read completely.
+	// This also handles errors and end of file.
+	unsigned int done = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		IRpFile::ReadRequest *const req = &reqs[i];
+		if (req->ret < req->size) {
+			req->ret += preadFully(fd, req->pos + req->ret,
+				static_cast<uint8_t*>(req->ptr) + req->ret,
+				req->size - req->ret);
+		}
+		if (req->ret == req->size) {
+			done++;
+		}
+	}
+	return static_cast<int>(done);
+}
+
+}
@@ -21,17 +21,8 @@
 using std::string;
 using std::vector;
 
-// zlib for transparent gzip decompression.
-#include <zlib.h>
-// gzclose_r() and gzclose_w() were introduced in zlib-1.2.4.
-#if (ZLIB_VER_MAJOR > 1) || \
-    (ZLIB_VER_MAJOR == 1 && ZLIB_VER_MINOR > 2) || \
-    (ZLIB_VER_MAJOR == 1 && ZLIB_VER_MINOR == 2 && ZLIB_VER_REVISION >= 4)
-// zlib-1.2.4 or later
-#else
-#  define gzclose_r(file) gzclose(file)
-#  define gzclose_w(file) gzclose(file)
-#endif
+// Transparent gzip decompression.
+#include "GzReader.hpp"
 
 #ifdef _WIN32
 // Windows SDK
@@ -74,10 +65,14 @@ class RpFilePrivate
 
 		RpFilePrivate(RpFile *q, const char *filename, RpFile::FileMode mode)
 			: q_ptr(q), file(INVALID_HANDLE_VALUE), filename(filename)
-			, mode(mode), gzfd(nullptr), gzsz(-1), devInfo(nullptr) { }
+			, mode(mode), gzReader(nullptr), gzsz(-1)
+			, mmap_ptr(nullptr), mmap_size(0), mmap_pos(0)
+			, devInfo(nullptr) { }
 		RpFilePrivate(RpFile *q, const string &filename, RpFile::FileMode mode)
 			: q_ptr(q), file(INVALID_HANDLE_VALUE), filename(filename)
-			, mode(mode), gzfd(nullptr), gzsz(-1), devInfo(nullptr) { }
+			, mode(mode), gzReader(nullptr), gzsz(-1)
+			, mmap_ptr(nullptr), mmap_size(0), mmap_pos(0)
+			, devInfo(nullptr) { }
 		~RpFilePrivate();
 
 	private:
@@ -89,8 +84,14 @@ class RpFilePrivate
 		string filename;	// Filename.
 		RpFile::FileMode mode;	// File mode.
 
-		gzFile gzfd;		// Used for transparent gzip decompression.
-		off64_t gzsz;		// Uncompressed file size.
+		GzReader *gzReader;	// Used for transparent gzip decompression.
+		off64_t gzsz;		// Uncompressed file size. (from the gzip trailer)
+
+		// Memory mapping. (FM_MMAP)
+		// NOTE: Not currently implemented on Windows.
+		uint8_t *mmap_ptr;	// Mapped file data.
+		size_t mmap_size;	// Size of the mapping.
+		off64_t mmap_pos;	// Read position within the mapping.
 
 		// Device information struct.
 		// Only used if the underlying file
@@ -188,7 +189,7 @@ class RpFilePrivate
 		/**
 		 * (Re-)Open the main file.
 		 *
-		 * INTERNAL FUNCTION. This does NOT affect gzfd.
+		 * INTERNAL FUNCTION. This does NOT affect gzReader.
 		 * NOTE: This function sets q->m_lastError.
 		 *
 		 * Uses parameters stored in this->filename and this->mode.
@@ -196,6 +197,70 @@ class RpFilePrivate
 		 */
 		int reOpenFile(void);
 
+#ifndef _WIN32
+		/**
+		 * Memory-map the main file.
+		 *
+		 * INTERNAL FUNCTION. This only works for read-only,
+		 * uncompressed, regular files. If the file can't be
+		 * mapped, stdio will be used instead.
+		 *
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int mmapFile(void);
+
+		/**
+		 * Unmap the main file, if it's mapped.
+		 * The stdio file position will be set to the
+		 * mapped read position.
+		 */
+		void munmapFile(void);
+
+		/**
+		 * Read data using pread() until the requested amount
+		 * has been read, end of file is reached, or an error occurs.
+		 * NOTE: This function sets q->m_lastError on error.
+		 * @param fd	[in] File descriptor.
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 4, 5)
+		size_t preadFully(int fd, off64_t pos, void *ptr, size_t size);
+
+		/**
+		 * Read multiple ranges of the file at once using preadv().
+		 * Requests for adjacent ranges are combined.
+		 * @param fd	[in] File descriptor.
+		 * @param reqs	[in/out] Read requests.
+		 * @param count	[in] Number of read requests.
+		 * @return Number of requests that were read completely.
+		 */
+		unsigned int readBatch_preadv(int fd, IRpFile::ReadRequest *reqs, unsigned int count);
+
+#ifdef HAVE_IO_URING
+		/**
+		 * Read multiple ranges of the file at once using io_uring.
+		 * @param fd	[in] File descriptor.
+		 * @param reqs	[in/out] Read requests.
+		 * @param count	[in] Number of read requests.
+		 * @return Number of requests that were read completely, or negative POSIX error code if io_uring isn't available.
+		 */
+		int readBatch_io_uring(int fd, IRpFile::ReadRequest *reqs, unsigned int count);
+#endif /* HAVE_IO_URING */
+#endif /* !_WIN32 */
+
+		/**
+		 * Read compressed data for GzReader.
+		 * @param param	[in] RpFilePrivate
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		static size_t gzReadAt(void *param, off64_t pos, void *ptr, size_t size);
+
 	public:
 		/**
 		 * Read one sector into the sector cache.
@@ -15,11 +15,17 @@
 
 #include "RpFile.hpp"
 #include "RpFile_p.hpp"
+#include "FileSystem.hpp"
 
 // C includes.
 #include <fcntl.h>	// AT_EMPTY_PATH
+#include <sys/mman.h>	// mmap(), munmap()
 #include <sys/stat.h>	// stat(), statx()
-#include <unistd.h>	// ftruncate()
+#include <sys/uio.h>	// preadv()
+#include <unistd.h>	// ftruncate(), pread()
+
+// C++ STL classes.
+#include <algorithm>
 
 namespace LibRpFile {
 
@@ -27,9 +33,10 @@ namespace LibRpFile {
 
 RpFilePrivate::~RpFilePrivate()
 {
-	if (gzfd != 0) {
-		gzclose_r(gzfd);
+	if (mmap_ptr) {
+		munmap(mmap_ptr, mmap_size);
 	}
+	delete gzReader;
 	if (file) {
 		fclose(file);
 	}
@@ -60,7 +67,7 @@ inline const char *RpFilePrivate::mode_to_str(RpFile::FileMode mode)
 /**
  * (Re-)Open the main file.
  *
- * INTERNAL FUNCTION. This does NOT affect gzfd.
+ * INTERNAL FUNCTION. This does NOT affect gzReader.
  * NOTE: This function sets q->m_lastError.
  *
  * Uses parameters stored in this->filename and this->mode.
@@ -196,6 +203,219 @@ int RpFilePrivate::reOpenFile(void)
 	return 0;
 }
 
+/**
+ * Memory-map the main file.
+ *
+ * INTERNAL FUNCTION. This only works for read-only,
+ * uncompressed, regular files on local file systems.
+ * If the file can't be mapped, stdio will be used instead.
+ *
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int RpFilePrivate::mmapFile(void)
+{
+	assert(file != nullptr);
+	assert(mmap_ptr == nullptr);
+	assert(gzReader == nullptr);
+	if (!file || mmap_ptr || gzReader || devInfo || (mode & RpFile::FM_WRITE)) {
+		// Cannot map this file.
+		return -EBADF;
+	}
+
+	// Only regular files can be mapped.
+	const int fd = fileno(file);
+	struct stat sb;
+	if (fstat(fd, &sb) != 0) {
+		int err = -errno;
+		if (err == 0) {
+			err = -EIO;
+		}
+		return err;
+	}
+	if (!S_ISREG(sb.st_mode)) {
+		return -ENOTSUP;
+	}
+
+	// Don't map files on network file systems. Their contents can
+	// change or become unavailable at any time, and accessing a
+	// mapping that's no longer backed by the file raises SIGBUS.
+	if (FileSystem::isOnBadFS(filename.c_str(), false)) {
+		return -ENOTSUP;
+	}
+
+	// Empty files can't be mapped, and files larger than
+	// the address space (32-bit) shouldn't be mapped.
+	if (sb.st_size <= 0 || static_cast<uint64_t>(sb.st_size) > static_cast<uint64_t>(SIZE_MAX)) {
+		return -ENOTSUP;
+	}
+
+	const size_t size = static_cast<size_t>(sb.st_size);
+	void *const ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (ptr == MAP_FAILED) {
+		int err = -errno;
+		if (err == 0) {
+			err = -EIO;
+		}
+		return err;
+	}
+
+	// Continue reading from the current stdio position.
+	off64_t pos = ftello(file);
+	mmap_pos = (pos >= 0 ? pos : 0);
+	mmap_ptr = static_cast<uint8_t*>(ptr);
+	mmap_size = size;
+	return 0;
+}
+
+/**
+ * Unmap the main file, if it's mapped.
+ * The stdio file position will be set to the
+ * mapped read position.
+ */
+void RpFilePrivate::munmapFile(void)
+{
+	if (!mmap_ptr)
+		return;
+
+	munmap(mmap_ptr, mmap_size);
+	mmap_ptr = nullptr;
+	mmap_size = 0;
+	if (file) {
+		fseeko(file, mmap_pos, SEEK_SET);
+	}
+	mmap_pos = 0;
+}
+
+/**
+ * Read data using pread() until the requested amount
+ * has been read, end of file is reached, or an error occurs.
+ * NOTE: This function sets q->m_lastError on error.
+ * @param fd	[in] File descriptor.
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpFilePrivate::preadFully(int fd, off64_t pos, void *ptr, size_t size)
+{
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+	while (size > 0) {
+		ssize_t sz_read = pread(fd, ptr8, size, pos);
+		if (sz_read < 0) {
+			if (errno == EINTR)
+				continue;
+			// An error occurred.
+			RP_Q(RpFile);
+			q->m_lastError = errno;
+			break;
+		} else if (sz_read == 0) {
+			// End of file.
+			break;
+		}
+
+		ptr8 += sz_read;
+		pos += sz_read;
+		size -= static_cast<size_t>(sz_read);
+		ret += static_cast<size_t>(sz_read);
+	}
+	return ret;
+}
+
+/**
+ * Read compressed data for GzReader.
+ * @param param	[in] RpFilePrivate
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpFilePrivate::gzReadAt(void *param, off64_t pos, void *ptr, size_t size)
+{
+	RpFilePrivate *const d = static_cast<RpFilePrivate*>(param);
+	return d->preadFully(fileno(d->file), pos, ptr, size);
+}
+
+/**
+ * Read multiple ranges of the file at once using preadv().
+ * Requests for adjacent ranges are combined.
+ * @param fd	[in] File descriptor.
+ * @param reqs	[in/out] Read requests.
+ * @param count	[in] Number of read requests.
+ * @return Number of requests that were read completely.
+ */
+unsigned int RpFilePrivate::readBatch_preadv(int fd, IRpFile::ReadRequest *reqs, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i++) {
+		reqs[i].ret = 0;
+	}
+
+#ifdef HAVE_PREADV
+	// Sort the requests by file position so adjacent
+	// ranges can be read with a single preadv() call.
+	vector<unsigned int> order(count);
+	for (unsigned int i = 0; i < count; i++) {
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [reqs](unsigned int a, unsigned int b) {
+		return reqs[a].pos < reqs[b].pos;
+	});
+
+	// NOTE: IOV_MAX is at least 16 per POSIX.
+	static const unsigned int MAX_IOV = 16;
+	struct iovec iov[MAX_IOV];
+	for (unsigned int i = 0; i < count; ) {
+		// Find a run of adjacent requests.
+		const IRpFile::ReadRequest *const first = &reqs[order[i]];
+		off64_t next_pos = first->pos;
+		unsigned int n = 0;
+		for (; n < MAX_IOV && i + n < count; n++) {
+			const IRpFile::ReadRequest *const req = &reqs[order[i + n]];
+			if (req->pos != next_pos)
+				break;
+			iov[n].iov_base = req->ptr;
+			iov[n].iov_len = req->size;
+			next_pos += req->size;
+		}
+
+		if (n > 1) {
+			ssize_t sz_read;
+			do {
+				sz_read = preadv(fd, iov, n, first->pos);
+			} while (sz_read < 0 && errno == EINTR);
+
+			// Distribute the data. Short reads are
+			// completed by preadFully() below.
+			size_t remain = (sz_read > 0 ? static_cast<size_t>(sz_read) : 0);
+			for (unsigned int j = 0; j < n && remain > 0; j++) {
+				IRpFile::ReadRequest *const req = &reqs[order[i + j]];
+				req->ret = std::min(req->size, remain);
+				remain -= req->ret;
+			}
+		} else {
+			// Single request.
+			n = 1;
+		}
+		i += n;
+	}
+#endif /* HAVE_PREADV */
+
+	// Finish any requests that weren't read completely.
+	unsigned int ret = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		IRpFile::ReadRequest *const req = &reqs[i];
+		if (req->ret < req->size) {
+			req->ret += preadFully(fd, req->pos + req->ret,
+				static_cast<uint8_t*>(req->ptr) + req->ret,
+				req->size - req->ret);
+		}
+		if (req->ret == req->size) {
+			ret++;
+		}
+	}
+	return ret;
+}
+
 /** RpFile **/
 
 /**
@@ -237,6 +457,10 @@ void RpFile::init(void)
 	if (d->mode & RpFile::FM_GZIP_DECOMPRESS) {
 		assert((d->mode & FM_MODE_MASK) != RpFile::FM_WRITE);
 	}
+	// Cannot use memory mapping with writing.
+	if (d->mode & RpFile::FM_MMAP) {
+		assert((d->mode & FM_MODE_MASK) != RpFile::FM_WRITE);
+	}
 #endif /* NDEBUG */
 
 	// Open the file.
@@ -250,7 +474,7 @@ void RpFile::init(void)
 	// Check if this is a gzipped file.
 	// If it is, use transparent decompression.
 	// Reference: https://www.forensicswiki.org/wiki/Gzip
-	if (d->mode == FM_OPEN_READ_GZ) {
+	if ((d->mode & ~FM_MMAP) == FM_OPEN_READ_GZ) {
 		uint16_t gzmagic;
 		size_t size = fread(&gzmagic, 1, sizeof(gzmagic), d->file);
 		if (size == sizeof(gzmagic) && gzmagic == be16_to_cpu(0x1F8B)) {
@@ -270,35 +494,45 @@ void RpFile::init(void)
 						// TODO: Add better verification heuristics?
 						d->gzsz = (off64_t)uncomp_sz;
 
-						// Make sure the CRC32 table is initialized.
-						get_crc_table();
-
-						// Open the file with gzdopen().
-						::rewind(d->file);
-						::fflush(d->file);
-						int gzfd_dup = ::dup(fileno(d->file));
-						if (gzfd_dup >= 0) {
-							d->gzfd = gzdopen(gzfd_dup, "r");
-							if (d->gzfd) {
-								m_isCompressed = true;
-							} else {
-								// gzdopen() failed.
-								// Close the dup()'d handle to prevent a leak.
-								::close(gzfd_dup);
+						// Decompress the file using GzReader.
+						// NOTE: GzReader uses pread(), so the stdio
+						// file position doesn't matter.
+						d->gzReader = new GzReader(RpFilePrivate::gzReadAt, d, real_sz, d->gzsz);
+						if (d->gzReader->isOpen()) {
+							m_isCompressed = true;
+
+							// Load the access point index from the cache.
+							if (GzReader::isIndexCacheEnabled()) {
+								FileSystem::FileIdentity fileId;
+								if (FileSystem::get_file_identity(d->filename, &fileId) == 0) {
+									d->gzReader->loadIndexCache(fileId);
+								}
 							}
+						} else {
+							// Unable to initialize the decompressor.
+							delete d->gzReader;
+							d->gzReader = nullptr;
 						}
 					}
 				}
 			}
 		}
 
-		if (!d->gzfd) {
+		if (!d->gzReader) {
 			// Not a gzipped file.
 			// Rewind and flush the file.
 			::rewind(d->file);
 			::fflush(d->file);
 		}
 	}
+
+	// Memory-map the file if requested.
+	// If the file can't be mapped, stdio will be used.
+	if ((d->mode & FM_MMAP) && !(d->mode & FM_WRITE) &&
+	    !d->gzReader && !d->devInfo)
+	{
+		d->mmapFile();
+	}
 }
 
 RpFile::~RpFile()
@@ -332,10 +566,14 @@ void RpFile::close(void)
 		d->devInfo->close();
 	}
 
-	if (d->gzfd != 0) {
-		gzclose_r(d->gzfd);
-		d->gzfd = nullptr;
+	if (d->mmap_ptr) {
+		munmap(d->mmap_ptr, d->mmap_size);
+		d->mmap_ptr = nullptr;
+		d->mmap_size = 0;
+		d->mmap_pos = 0;
 	}
+	delete d->gzReader;
+	d->gzReader = nullptr;
 	if (d->file) {
 		fclose(d->file);
 		d->file = nullptr;
@@ -359,17 +597,19 @@ size_t RpFile::read(void *ptr, size_t size)
 	if (d->devInfo) {
 		// Block device. Need to read in multiples of the block size.
 		return d->readUsingBlocks(ptr, size);
+	} else if (d->mmap_ptr) {
+		// Memory-mapped file.
+		const size_t ret = readAt(d->mmap_pos, ptr, size);
+		d->mmap_pos += ret;
+		return ret;
 	}
 
 	size_t ret;
-	if (d->gzfd != 0) {
-		int iret = gzread(d->gzfd, ptr, size);
-		if (iret >= 0) {
-			ret = (size_t)iret;
-		} else {
+	if (d->gzReader) {
+		ret = d->gzReader->read(ptr, size);
+		if (ret != size && d->gzReader->lastError() != 0) {
 			// An error occurred.
-			ret = 0;
-			m_lastError = errno;
+			m_lastError = d->gzReader->lastError();
 		}
 	} else {
 		ret = fread(ptr, 1, size, d->file);
@@ -381,6 +621,132 @@ size_t RpFile::read(void *ptr, size_t size)
 	return ret;
 }
 
+/**
+ * Read data from the file at the specified position.
+ * The file position is not changed.
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpFile::readAt(off64_t pos, void *ptr, size_t size)
+{
+	RP_D(RpFile);
+	if (!d->file) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	if (d->devInfo || d->gzReader) {
+		// Block devices and gzipped files depend on the
+		// file position, so use seek() and read().
+		return super::readAt(pos, ptr, size);
+	}
+
+	if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
+	}
+
+	if (d->mmap_ptr) {
+		// Memory-mapped file.
+		if (pos >= static_cast<off64_t>(d->mmap_size)) {
+			// End of file.
+			return 0;
+		}
+		if (size > d->mmap_size - static_cast<size_t>(pos)) {
+			size = d->mmap_size - static_cast<size_t>(pos);
+		}
+		memcpy(ptr, &d->mmap_ptr[pos], size);
+		return size;
+	}
+
+	if (m_isWritable) {
+		// Make sure buffered writes are visible to pread().
+		::fflush(d->file);
+	}
+
+	// NOTE: pread() doesn't use the stdio buffer or the
+	// file position, so it's safe to call from multiple
+	// threads at once.
+	return d->preadFully(fileno(d->file), pos, ptr, size);
+}
+
+/**
+ * Read multiple ranges of the file at once.
+ * The file position is not changed.
+ *
+ * On Linux, the requests are submitted using io_uring
+ * if it's available. Otherwise, requests for adjacent
+ * ranges are combined and read using preadv().
+ *
+ * @param reqs	[in/out] Read requests. (ret is set on return)
+ * @param count	[in] Number of read requests.
+ * @return Number of requests that were read completely.
+ */
+unsigned int RpFile::readBatch(ReadRequest *reqs, unsigned int count)
+{
+	RP_D(RpFile);
+	if (!d->file) {
+		m_lastError = EBADF;
+		for (unsigned int i = 0; i < count; i++) {
+			reqs[i].ret = 0;
+		}
+		return 0;
+	}
+
+	if (count < 2 || d->devInfo || d->gzReader || d->mmap_ptr) {
+		// Nothing to combine, or the file doesn't support
+		// positional reads. (Memory-mapped files are
+		// already handled efficiently by readAt().)
+		return super::readBatch(reqs, count);
+	}
+
+	for (unsigned int i = 0; i < count; i++) {
+		if (reqs[i].pos < 0) {
+			// Invalid position.
+			// Let readAt() handle the errors.
+			return super::readBatch(reqs, count);
+		}
+	}
+
+	if (m_isWritable) {
+		// Make sure buffered writes are visible to pread().
+		::fflush(d->file);
+	}
+
+	const int fd = fileno(d->file);
+#ifdef HAVE_IO_URING
+	const int ret = d->readBatch_io_uring(fd, reqs, count);
+	if (ret >= 0) {
+		return static_cast<unsigned int>(ret);
+	}
+	// io_uring isn't available. Use preadv() instead.
+#endif /* HAVE_IO_URING */
+	return d->readBatch_preadv(fd, reqs, count);
+}
+
+/**
+ * Get a direct pointer to a range of the file's data.
+ * This is only available if the file was opened with
+ * FM_MMAP and it could be memory-mapped.
+ * @param pos	[in] File position.
+ * @param size	[in] Size of the range, in bytes.
+ * @return Pointer to the data, or nullptr if not available.
+ */
+const uint8_t *RpFile::dataPtr(off64_t pos, size_t size)
+{
+	RP_D(const RpFile);
+	if (!d->mmap_ptr || pos < 0 || pos > static_cast<off64_t>(d->mmap_size) ||
+	    size > d->mmap_size - static_cast<size_t>(pos))
+	{
+		// Not mapped, or out of range.
+		return nullptr;
+	}
+
+	return &d->mmap_ptr[pos];
+}
+
 /**
  * Write data to the file.
  * @param ptr Input data buffer.
@@ -430,20 +796,22 @@ int RpFile::seek(off64_t pos)
 			d->devInfo->device_pos = d->devInfo->device_size;
 		}
 		return 0;
+	} else if (d->mmap_ptr) {
+		// Memory-mapped file.
+		// NOTE: Like fseeko(), seeking past EOF is allowed.
+		if (pos < 0) {
+			m_lastError = EINVAL;
+			return -1;
+		}
+		d->mmap_pos = pos;
+		return 0;
 	}
 
 	int ret;
-	if (d->gzfd != 0) {
-		errno = 0;
-		z_off_t zret = gzseek(d->gzfd, pos, SEEK_SET);
-		if (zret >= 0) {
-			ret = 0;
-		} else {
-			ret = -1;
-			m_lastError = -errno;
-			if (m_lastError == 0) {
-				m_lastError = -EIO;
-			}
+	if (d->gzReader) {
+		ret = d->gzReader->seek(pos);
+		if (ret != 0) {
+			m_lastError = d->gzReader->lastError();
 		}
 	} else {
 		ret = fseeko(d->file, pos, SEEK_SET);
@@ -467,8 +835,10 @@ off64_t RpFile::tell(void)
 		return -1;
 	}
 
-	if (d->gzfd != 0) {
-		return (off64_t)gztell(d->gzfd);
+	if (d->mmap_ptr) {
+		return d->mmap_pos;
+	} else if (d->gzReader) {
+		return d->gzReader->tell();
 	}
 	return ftello(d->file);
 }
@@ -560,10 +930,15 @@ off64_t RpFile::size(void)
 	if (d->devInfo) {
 		// Block device. Use the cached device size.
 		return d->devInfo->device_size;
-	} else if (d->gzfd != 0) {
+	} else if (d->mmap_ptr) {
+		// Memory-mapped file. Use the mapping size.
+		return static_cast<off64_t>(d->mmap_size);
+	} else if (d->gzReader) {
 		// gzipped files have the uncompressed size stored
-		// at the end of the stream.
-		return d->gzsz;
+		// at the end of the stream, modulo 2^32. If the entire
+		// file has been decompressed, the actual size is known.
+		const off64_t gzReaderSize = d->gzReader->uncompressedSize();
+		return (gzReaderSize >= 0 ? gzReaderSize : d->gzsz);
 	}
 
 	// Save the current position.
@@ -607,6 +982,10 @@ int RpFile::makeWritable(void)
 	}
 
 	RP_D(RpFile);
+	// Writable files can't be memory-mapped.
+	d->munmapFile();
+	d->mode = (RpFile::FileMode)(d->mode & ~FM_MMAP);
+
 	off64_t prev_pos = ftello(d->file);
 	fclose(d->file);
 	d->file = fopen(d->filename.c_str(), "rb+");
@@ -92,6 +92,60 @@ size_t RpMemFile::read(void *ptr, size_t size)
 	return size;
 }
 
+/**
+ * Read data from the file at the specified position.
+ * The file position is not changed.
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpMemFile::readAt(off64_t pos, void *ptr, size_t size)
+{
+	if (!m_buf) {
+		m_lastError = EBADF;
+		return 0;
+	}
+
+	if (unlikely(size == 0) || pos < 0 ||
+	    pos >= static_cast<off64_t>(m_size))
+	{
+		// Not reading anything, or out of range.
+		return 0;
+	}
+
+	// Check if size is in bounds.
+	// NOTE: Need to use a signed comparison here.
+	if (pos > (static_cast<off64_t>(m_size) - static_cast<off64_t>(size))) {
+		// Not enough data.
+		// Copy whatever's left in the buffer.
+		size = static_cast<size_t>(m_size - pos);
+	}
+
+	// Copy the data.
+	const uint8_t *const buf = static_cast<const uint8_t*>(m_buf);
+	memcpy(ptr, &buf[pos], size);
+	return size;
+}
+
+/**
+ * Get a direct pointer to a range of the file's data.
+ * @param pos	[in] File position.
+ * @param size	[in] Size of the range, in bytes.
+ * @return Pointer to the data, or nullptr if out of range.
+ */
+const uint8_t *RpMemFile::dataPtr(off64_t pos, size_t size)
+{
+	if (!m_buf || pos < 0 || pos > static_cast<off64_t>(m_size) ||
+	    size > m_size - static_cast<size_t>(pos))
+	{
+		// Out of range.
+		return nullptr;
+	}
+
+	return static_cast<const uint8_t*>(m_buf) + pos;
+}
+
 /**
  * Write data to the file.
  * (NOTE: Not valid for RpMemFile; this will always return 0.)
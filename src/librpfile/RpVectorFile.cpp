@@ -57,6 +57,55 @@ size_t RpVectorFile::read(void *ptr, size_t size)
 	return size;
 }
 
+/**
+ * Read data from the file at the specified position.
+ * The file position is not changed.
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpVectorFile::readAt(off64_t pos, void *ptr, size_t size)
+{
+	if (unlikely(size == 0) || pos < 0 ||
+	    pos >= static_cast<off64_t>(m_vector.size()))
+	{
+		// Not reading anything, or out of range.
+		return 0;
+	}
+
+	// Check if size is in bounds.
+	// NOTE: Need to use a signed comparison here.
+	if (pos > (static_cast<off64_t>(m_vector.size()) - static_cast<off64_t>(size))) {
+		// Not enough data.
+		// Copy whatever's left in the buffer.
+		size = static_cast<size_t>(m_vector.size() - pos);
+	}
+
+	// Copy the data.
+	const uint8_t *const buf = m_vector.data();
+	memcpy(ptr, &buf[pos], size);
+	return size;
+}
+
+/**
+ * Get a direct pointer to a range of the file's data.
+ * @param pos	[in] File position.
+ * @param size	[in] Size of the range, in bytes.
+ * @return Pointer to the data, or nullptr if out of range.
+ */
+const uint8_t *RpVectorFile::dataPtr(off64_t pos, size_t size)
+{
+	if (pos < 0 || pos > static_cast<off64_t>(m_vector.size()) ||
+	    size > m_vector.size() - static_cast<size_t>(pos))
+	{
+		// Out of range.
+		return nullptr;
+	}
+
+	return m_vector.data() + pos;
+}
+
 /**
  * Write data to the file.
  * @param ptr Input data buffer.
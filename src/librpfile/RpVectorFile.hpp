@@ -60,6 +60,25 @@ class RpVectorFile final : public IRpFile
 		ATTR_ACCESS_SIZE(write_only, 2, 3)
 		size_t read(void *ptr, size_t size) final;
 
+		/**
+		 * Read data from the file at the specified position.
+		 * The file position is not changed.
+		 * @param pos	[in] File position.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		ATTR_ACCESS_SIZE(write_only, 3, 4)
+		size_t readAt(off64_t pos, void *ptr, size_t size) final;
+
+		/**
+		 * Get a direct pointer to a range of the file's data.
+		 * @param pos	[in] File position.
+		 * @param size	[in] Size of the range, in bytes.
+		 * @return Pointer to the data, or nullptr if out of range.
+		 */
+		const uint8_t *dataPtr(off64_t pos, size_t size) final;
+
 		/**
 		 * Write data to the file.
 		 * @param ptr Input data buffer.
@@ -0,0 +1,639 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpfile/tests)                  *
+ * GzReaderTest.cpp: GzReader class test.                                  *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+
+// librpfile
+#include "../GzReader.hpp"
+#include "../RpFile.hpp"
+#include "../FileSystem.hpp"
+
+// zlib
+#include <zlib.h>
+
+// C includes.
+#include <stdlib.h>
+#ifndef _WIN32
+#  include <unistd.h>	// getcwd()
+#endif /* !_WIN32 */
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// C++ includes.
+#include <algorithm>
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+namespace LibRpFile { namespace Tests {
+
+// Size of each gzip member, in uncompressed bytes.
+// The compressed file must be at least 16 MB for the index cache,
+// and each member must have multiple access points. (1 MB span)
+#define MEMBER_SIZE (8U*1024U*1024U)
+// Number of gzip members.
+#define MEMBER_COUNT 3U
+
+class GzReaderTest : public ::testing::Test
+{
+	protected:
+		GzReaderTest()
+			: gzReader(nullptr)
+		{ }
+
+		void SetUp(void) final
+		{
+			ASSERT_FALSE(gz_data.empty());
+			gzReader = newGzReader();
+			ASSERT_TRUE(gzReader->isOpen());
+		}
+
+		void TearDown(void) final
+		{
+			delete gzReader;
+			GzReader::setIndexCacheEnabled(false);
+		}
+
+		static void SetUpTestCase(void);
+		static void TearDownTestCase(void);
+
+	public:
+		/**
+		 * Read compressed data from gz_data.
+		 * @param param	[in] Unused.
+		 * @param pos	[in] Position in the compressed file.
+		 * @param ptr	[out] Output data buffer.
+		 * @param size	[in] Amount of data to read, in bytes.
+		 * @return Number of bytes read.
+		 */
+		static size_t readAt(void *param, off64_t pos, void *ptr, size_t size);
+
+		/**
+		 * Create a GzReader for gz_data.
+		 * @return GzReader.
+		 */
+		static GzReader *newGzReader(void)
+		{
+			return new GzReader(readAt, nullptr,
+				static_cast<off64_t>(gz_data.size()), MEMBER_SIZE);
+		}
+
+		/**
+		 * Read data with a GzReader and compare it to the uncompressed data.
+		 * @param reader GzReader.
+		 * @param pos Uncompressed position.
+		 * @param size Amount of data to read, in bytes.
+		 */
+		static void checkRead(GzReader *reader, off64_t pos, size_t size);
+
+		/**
+		 * Get the index cache filename for fileId.
+		 * Same layout as GzReaderPrivate::getCacheFilename().
+		 * @return Index cache filename.
+		 */
+		static string cacheFilename(void);
+
+		/**
+		 * Write data to a file.
+		 * @param filename Filename.
+		 * @param data Data.
+		 * @param size Size of data.
+		 * @return True on success; false on error.
+		 */
+		static bool writeFile(const string &filename, const uint8_t *data, size_t size);
+
+		/**
+		 * Read an entire file.
+		 * @param filename Filename.
+		 * @return File data, or empty vector on error.
+		 */
+		static vector<uint8_t> readFile(const string &filename);
+
+		/**
+		 * Decompress the entire file to build the index cache.
+		 */
+		static void buildIndexCache(void);
+
+	public:
+		GzReader *gzReader;
+
+		// Fake file identity for the index cache.
+		static FileSystem::FileIdentity fileId;
+
+		// Uncompressed and compressed data.
+		static vector<uint8_t> raw_data;
+		static vector<uint8_t> gz_data;
+
+		// Temporary directory.
+		static string tmp_dir;
+};
+
+vector<uint8_t> GzReaderTest::raw_data;
+vector<uint8_t> GzReaderTest::gz_data;
+string GzReaderTest::tmp_dir;
+FileSystem::FileIdentity GzReaderTest::fileId;
+
+/**
+ * Generate the test data.
+ *
+ * The uncompressed data is pseudo-random 7-bit data, which
+ * compresses to about 7/8 of its original size. It's stored
+ * as MEMBER_COUNT gzip members, like the output of `cat a.gz b.gz`,
+ * so the ISIZE field in the trailer is only the size of the last
+ * member and doesn't match the actual uncompressed size.
+ */
+void GzReaderTest::SetUpTestCase(void)
+{
+	// xorshift32
+	raw_data.resize(MEMBER_SIZE * MEMBER_COUNT);
+	uint32_t x = 0x2545F491;
+	for (uint8_t &b : raw_data) {
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		b = static_cast<uint8_t>(x & 0x7F);
+	}
+
+	for (unsigned int i = 0; i < MEMBER_COUNT; i++) {
+		z_stream strm;
+		memset(&strm, 0, sizeof(strm));
+		// 15+16: gzip format with a 32 KB window.
+		ASSERT_EQ(Z_OK, deflateInit2(&strm, Z_BEST_SPEED, Z_DEFLATED, 15+16, 8, Z_DEFAULT_STRATEGY));
+
+		const size_t start = gz_data.size();
+		const uLong bound = deflateBound(&strm, MEMBER_SIZE);
+		gz_data.resize(start + bound);
+		strm.next_in = &raw_data[i * MEMBER_SIZE];
+		strm.avail_in = MEMBER_SIZE;
+		strm.next_out = &gz_data[start];
+		strm.avail_out = static_cast<uInt>(bound);
+		const int zret = deflate(&strm, Z_FINISH);
+		gz_data.resize(start + strm.total_out);
+		deflateEnd(&strm);
+		ASSERT_EQ(Z_STREAM_END, zret);
+	}
+	ASSERT_GE(gz_data.size(), 16U*1024U*1024U) << "Compressed data is too small for the index cache.";
+
+	memset(&fileId, 0, sizeof(fileId));
+	fileId.dev = 0x47A5BEEFULL;
+	fileId.ino = 0x12345678ABCDULL;
+	fileId.size = static_cast<off64_t>(gz_data.size());
+	fileId.mtime = 1000000000;
+
+#ifndef _WIN32
+	char cwd[4096];
+	ASSERT_TRUE(getcwd(cwd, sizeof(cwd)) != nullptr);
+	tmp_dir = cwd;
+	tmp_dir += "/GzReaderTest.tmp/";
+
+	// Redirect the cache directory so the index cache
+	// doesn't affect the user's cache.
+	// NOTE: The environment variable buffer becomes
+	// part of the environment, so it must be static.
+	static string xdg_cache_home_env;
+	xdg_cache_home_env = "XDG_CACHE_HOME=" + tmp_dir + "cache";
+	putenv(const_cast<char*>(xdg_cache_home_env.c_str()));
+#else /* _WIN32 */
+	tmp_dir = "GzReaderTest.tmp\\";
+#endif /* _WIN32 */
+	ASSERT_EQ(0, FileSystem::rmkdir(tmp_dir));
+}
+
+/**
+ * Free the test data and remove the index cache file.
+ */
+void GzReaderTest::TearDownTestCase(void)
+{
+	FileSystem::delete_file(cacheFilename());
+
+	raw_data.clear();
+	raw_data.shrink_to_fit();
+	gz_data.clear();
+	gz_data.shrink_to_fit();
+}
+
+/**
+ * Read compressed data from gz_data.
+ * @param param	[in] Unused.
+ * @param pos	[in] Position in the compressed file.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t GzReaderTest::readAt(void *param, off64_t pos, void *ptr, size_t size)
+{
+	RP_UNUSED(param);
+	if (pos < 0 || pos >= static_cast<off64_t>(gz_data.size()))
+		return 0;
+	size = std::min(size, gz_data.size() - static_cast<size_t>(pos));
+	memcpy(ptr, &gz_data[static_cast<size_t>(pos)], size);
+	return size;
+}
+
+/**
+ * Read data with a GzReader and compare it to the uncompressed data.
+ * @param reader GzReader.
+ * @param pos Uncompressed position.
+ * @param size Amount of data to read, in bytes.
+ */
+void GzReaderTest::checkRead(GzReader *reader, off64_t pos, size_t size)
+{
+	ASSERT_LE(pos + static_cast<off64_t>(size), static_cast<off64_t>(raw_data.size()));
+
+	vector<uint8_t> buf(size);
+	ASSERT_EQ(0, reader->seek(pos));
+	ASSERT_EQ(size, reader->read(buf.data(), size)) << "pos == " << pos;
+	EXPECT_EQ(pos + static_cast<off64_t>(size), reader->tell());
+	EXPECT_EQ(0, memcmp(&raw_data[static_cast<size_t>(pos)], buf.data(), size)) << "pos == " << pos;
+}
+
+/**
+ * Get the index cache filename for fileId.
+ * Same layout as GzReaderPrivate::getCacheFilename().
+ * @return Index cache filename.
+ */
+string GzReaderTest::cacheFilename(void)
+{
+	char buf[80];
+	snprintf(buf, sizeof(buf), "gzindex%c%08X%08X%c%02X%c%08X%08X.gzidx",
+		static_cast<char>(DIR_SEP_CHR),
+		static_cast<uint32_t>(fileId.dev >> 32), static_cast<uint32_t>(fileId.dev),
+		static_cast<char>(DIR_SEP_CHR),
+		static_cast<unsigned int>(fileId.ino & 0xFF),
+		static_cast<char>(DIR_SEP_CHR),
+		static_cast<uint32_t>(fileId.ino >> 32), static_cast<uint32_t>(fileId.ino));
+
+	string filename = FileSystem::getCacheDirectory();
+	if (filename.empty())
+		return filename;
+	if (filename.at(filename.size()-1) != DIR_SEP_CHR) {
+		filename += DIR_SEP_CHR;
+	}
+	filename += buf;
+	return filename;
+}
+
+/**
+ * Write data to a file.
+ * @param filename Filename.
+ * @param data Data.
+ * @param size Size of data.
+ * @return True on success; false on error.
+ */
+bool GzReaderTest::writeFile(const string &filename, const uint8_t *data, size_t size)
+{
+	RpFile *const file = new RpFile(filename, RpFile::FM_CREATE_WRITE);
+	if (!file->isOpen()) {
+		file->unref();
+		return false;
+	}
+	const size_t written = (size > 0 ? file->write(data, size) : 0);
+	file->unref();
+	return (written == size);
+}
+
+/**
+ * Read an entire file.
+ * @param filename Filename.
+ * @return File data, or empty vector on error.
+ */
+vector<uint8_t> GzReaderTest::readFile(const string &filename)
+{
+	vector<uint8_t> buf;
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ);
+	if (file->isOpen()) {
+		buf.resize(static_cast<size_t>(file->size()));
+		if (file->read(buf.data(), buf.size()) != buf.size()) {
+			buf.clear();
+		}
+	}
+	file->unref();
+	return buf;
+}
+
+/**
+ * Decompress the entire file to build the index cache.
+ */
+void GzReaderTest::buildIndexCache(void)
+{
+	const string filename = cacheFilename();
+	ASSERT_FALSE(filename.empty());
+	FileSystem::delete_file(filename);
+
+	GzReader::setIndexCacheEnabled(true);
+	GzReader *const reader = newGzReader();
+	ASSERT_EQ(-ENOENT, reader->loadIndexCache(fileId));
+
+	// Decompress the entire file.
+	vector<uint8_t> buf(1024*1024);
+	size_t total = 0, size;
+	do {
+		size = reader->read(buf.data(), buf.size());
+		total += size;
+	} while (size != 0);
+	EXPECT_EQ(raw_data.size(), total);
+	EXPECT_EQ(0, reader->lastError());
+
+	// The index is saved when the GzReader is deleted.
+	delete reader;
+	ASSERT_EQ(0, FileSystem::access(filename, R_OK));
+}
+
+/**
+ * Sequential read of the entire file.
+ */
+TEST_F(GzReaderTest, sequentialRead)
+{
+	EXPECT_EQ(-1, gzReader->uncompressedSize());
+
+	// Use an odd buffer size so reads don't line up with
+	// the member boundaries or the inflate window.
+	vector<uint8_t> buf(100003);
+	size_t pos = 0;
+	while (pos < raw_data.size()) {
+		const size_t size = gzReader->read(buf.data(), buf.size());
+		const size_t expected = std::min(buf.size(), raw_data.size() - pos);
+		ASSERT_EQ(expected, size) << "pos == " << pos;
+		ASSERT_EQ(0, memcmp(&raw_data[pos], buf.data(), size)) << "pos == " << pos;
+		pos += size;
+	}
+	EXPECT_EQ(0U, gzReader->read(buf.data(), buf.size()));
+	EXPECT_EQ(0, gzReader->lastError());
+	EXPECT_EQ(static_cast<off64_t>(raw_data.size()), gzReader->uncompressedSize());
+}
+
+/**
+ * Random reads, including backward seeks.
+ */
+TEST_F(GzReaderTest, randomRead)
+{
+	// Linear congruential generator for reproducible positions.
+	uint32_t lcg = 12345;
+	for (unsigned int i = 0; i < 64; i++) {
+		lcg = lcg * 1103515245U + 12345U;
+		const size_t size = (lcg >> 8) % (256*1024) + 1;
+		lcg = lcg * 1103515245U + 12345U;
+		const off64_t pos = static_cast<off64_t>(
+			((static_cast<uint64_t>(lcg) << 8) | (lcg >> 24)) % (raw_data.size() - size));
+		ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, pos, size));
+	}
+
+	// Backward seeks after the entire file has been indexed.
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, raw_data.size() - 4096, 4096));
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, MEMBER_SIZE * 2 + 12345, 65536));
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, MEMBER_SIZE + 54321, 65536));
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, 0, 65536));
+	EXPECT_EQ(0, gzReader->lastError());
+}
+
+/**
+ * Reads that cross gzip member boundaries.
+ */
+TEST_F(GzReaderTest, memberBoundary)
+{
+	for (unsigned int i = 1; i < MEMBER_COUNT; i++) {
+		const off64_t boundary = static_cast<off64_t>(MEMBER_SIZE) * i;
+		ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, boundary - 1, 2));
+		ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, boundary - 100000, 200000));
+	}
+
+	// Backward seek across a boundary.
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, MEMBER_SIZE - 32768, 65536));
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, MEMBER_SIZE * 2 - 1, 1));
+	EXPECT_EQ(0, gzReader->lastError());
+}
+
+/**
+ * Reads past the end of the data.
+ */
+TEST_F(GzReaderTest, readPastEOF)
+{
+	const off64_t total = static_cast<off64_t>(raw_data.size());
+	uint8_t buf[256];
+
+	// Seeking past the end is allowed, but reading returns nothing.
+	EXPECT_EQ(0, gzReader->seek(total + 1000));
+	EXPECT_EQ(total + 1000, gzReader->tell());
+	EXPECT_EQ(0U, gzReader->read(buf, sizeof(buf)));
+	EXPECT_EQ(total, gzReader->uncompressedSize());
+
+	// Short read at the end of the data.
+	EXPECT_EQ(0, gzReader->seek(total - 100));
+	EXPECT_EQ(100U, gzReader->read(buf, sizeof(buf)));
+	EXPECT_EQ(0, memcmp(&raw_data[raw_data.size() - 100], buf, 100));
+	EXPECT_EQ(total, gzReader->tell());
+	EXPECT_EQ(0U, gzReader->read(buf, sizeof(buf)));
+
+	// Reading still works after hitting the end.
+	EXPECT_EQ(0, gzReader->lastError());
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, 1000, sizeof(buf)));
+
+	// Negative positions are rejected.
+	EXPECT_EQ(-1, gzReader->seek(-1));
+	EXPECT_EQ(EINVAL, gzReader->lastError());
+}
+
+/**
+ * RpFile::size() for a multi-member file.
+ * Before the file is fully decompressed, the size is the
+ * ISIZE field from the last member's trailer, which is wrong.
+ * Afterwards, it's the actual uncompressed size.
+ */
+TEST_F(GzReaderTest, multiMemberSize)
+{
+	const string filename = tmp_dir + "multi.gz";
+	ASSERT_TRUE(writeFile(filename, gz_data.data(), gz_data.size()));
+
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ);
+	ASSERT_TRUE(file->isOpen());
+	EXPECT_TRUE(file->isCompressed());
+	EXPECT_EQ(static_cast<off64_t>(MEMBER_SIZE), file->size());
+
+	// Decompress the entire file.
+	vector<uint8_t> buf(1024*1024);
+	size_t total = 0, size;
+	do {
+		size = file->read(buf.data(), buf.size());
+		ASSERT_LE(total + size, raw_data.size());
+		EXPECT_EQ(0, memcmp(&raw_data[total], buf.data(), size)) << "pos == " << total;
+		total += size;
+	} while (size != 0);
+	EXPECT_EQ(raw_data.size(), total);
+	EXPECT_EQ(static_cast<off64_t>(raw_data.size()), file->size());
+
+	// Random access through RpFile.
+	EXPECT_EQ(4096U, file->seekAndRead(MEMBER_SIZE - 2048, buf.data(), 4096));
+	EXPECT_EQ(0, memcmp(&raw_data[MEMBER_SIZE - 2048], buf.data(), 4096));
+
+	file->unref();
+	FileSystem::delete_file(filename);
+}
+
+/**
+ * Load a valid index from the cache.
+ */
+TEST_F(GzReaderTest, indexCacheValid)
+{
+	ASSERT_NO_FATAL_FAILURE(buildIndexCache());
+
+	// Load the index. The uncompressed size should be
+	// known without decompressing anything.
+	GzReader::setIndexCacheEnabled(true);
+	EXPECT_EQ(0, gzReader->loadIndexCache(fileId));
+	EXPECT_EQ(static_cast<off64_t>(raw_data.size()), gzReader->uncompressedSize());
+
+	// Random reads use the loaded access points, including
+	// access points in the later gzip members.
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, raw_data.size() - 65536, 65536));
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, MEMBER_SIZE * 2 - 100000, 200000));
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, MEMBER_SIZE + 3*1024*1024 + 777, 65536));
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, 5*1024*1024 + 1, 65536));
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, 0, 65536));
+	EXPECT_EQ(0, gzReader->lastError());
+
+	// The index cache is ignored if it's disabled.
+	GzReader::setIndexCacheEnabled(false);
+	GzReader *const reader = newGzReader();
+	EXPECT_EQ(-ENOTSUP, reader->loadIndexCache(fileId));
+	EXPECT_EQ(-1, reader->uncompressedSize());
+	delete reader;
+}
+
+/**
+ * Stale index: The file's mtime has changed.
+ */
+TEST_F(GzReaderTest, indexCacheStale)
+{
+	ASSERT_NO_FATAL_FAILURE(buildIndexCache());
+	const vector<uint8_t> index = readFile(cacheFilename());
+	ASSERT_FALSE(index.empty());
+
+	GzReader::setIndexCacheEnabled(true);
+	FileSystem::FileIdentity newFileId = fileId;
+	newFileId.mtime++;
+	EXPECT_EQ(-ESTALE, gzReader->loadIndexCache(newFileId));
+	EXPECT_EQ(-1, gzReader->uncompressedSize());
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, MEMBER_SIZE + 1000, 65536));
+	delete gzReader;
+	gzReader = nullptr;
+
+	// The index is rebuilt for the new mtime when the GzReader is deleted,
+	// since decompressing to MEMBER_SIZE added new access points.
+	const vector<uint8_t> newIndex = readFile(cacheFilename());
+	ASSERT_FALSE(newIndex.empty());
+	EXPECT_NE(index, newIndex);
+	GzReader *const reader = newGzReader();
+	EXPECT_EQ(-ESTALE, reader->loadIndexCache(fileId));
+	delete reader;
+}
+
+/**
+ * Truncated index.
+ */
+TEST_F(GzReaderTest, indexCacheTruncated)
+{
+	ASSERT_NO_FATAL_FAILURE(buildIndexCache());
+	const string filename = cacheFilename();
+	const vector<uint8_t> index = readFile(filename);
+	ASSERT_GT(index.size(), 8U + (7*8) + (4*8) + 4);
+
+	GzReader::setIndexCacheEnabled(true);
+
+	// Truncate the index at every position in the header
+	// and the first access point, then at regular intervals.
+	vector<size_t> lengths;
+	for (size_t len = 0; len < 8 + (7*8) + (4*8) + 8; len++) {
+		lengths.push_back(len);
+	}
+	for (size_t len = 8 + (7*8) + (4*8) + 8; len < index.size(); len += 4093) {
+		lengths.push_back(len);
+	}
+	lengths.push_back(index.size() - 1);
+
+	for (size_t len : lengths) {
+		ASSERT_TRUE(writeFile(filename, index.data(), len));
+		GzReader *const reader = newGzReader();
+		EXPECT_NE(0, reader->loadIndexCache(fileId)) << "len == " << len;
+		EXPECT_EQ(-1, reader->uncompressedSize()) << "len == " << len;
+		delete reader;
+	}
+
+	// Reading works with a truncated index.
+	ASSERT_TRUE(writeFile(filename, index.data(), index.size() / 2));
+	EXPECT_NE(0, gzReader->loadIndexCache(fileId));
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, MEMBER_SIZE * 2 + 1000, 65536));
+	EXPECT_EQ(0, gzReader->lastError());
+}
+
+/**
+ * Index with flipped bits.
+ */
+TEST_F(GzReaderTest, indexCacheBitFlip)
+{
+	ASSERT_NO_FATAL_FAILURE(buildIndexCache());
+	const string filename = cacheFilename();
+	const vector<uint8_t> index = readFile(filename);
+	ASSERT_GT(index.size(), 8U + (7*8) + (4*8) + 4);
+
+	GzReader::setIndexCacheEnabled(true);
+
+	// Flip every bit in the header and the first access point,
+	// then bits at regular intervals, including the CRC32.
+	vector<size_t> bits;
+	for (size_t bit = 0; bit < (8 + (7*8) + (4*8)) * 8; bit++) {
+		bits.push_back(bit);
+	}
+	for (size_t bit = (8 + (7*8) + (4*8)) * 8; bit < index.size() * 8; bit += 40009) {
+		bits.push_back(bit);
+	}
+	for (size_t bit = (index.size() - 4) * 8; bit < index.size() * 8; bit++) {
+		bits.push_back(bit);
+	}
+
+	vector<uint8_t> corrupted = index;
+	for (size_t bit : bits) {
+		corrupted[bit / 8] ^= (1U << (bit & 7));
+		ASSERT_TRUE(writeFile(filename, corrupted.data(), corrupted.size()));
+		corrupted[bit / 8] ^= (1U << (bit & 7));
+
+		GzReader *const reader = newGzReader();
+		EXPECT_NE(0, reader->loadIndexCache(fileId)) << "bit == " << bit;
+		EXPECT_EQ(-1, reader->uncompressedSize()) << "bit == " << bit;
+		delete reader;
+	}
+
+	// Reading works with a corrupted index.
+	// Flip a bit in the first access point's position.
+	corrupted[8 + (7*8) + 3] ^= 0x10;
+	ASSERT_TRUE(writeFile(filename, corrupted.data(), corrupted.size()));
+	EXPECT_NE(0, gzReader->loadIndexCache(fileId));
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, MEMBER_SIZE * 2 + 1000, 65536));
+	ASSERT_NO_FATAL_FAILURE(checkRead(gzReader, MEMBER_SIZE + 1000, 65536));
+	EXPECT_EQ(0, gzReader->lastError());
+}
+
+} }
+
+/**
+ * Test suite main function.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpFile test suite: GzReader tests.\n\n");
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
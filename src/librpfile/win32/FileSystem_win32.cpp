@@ -290,6 +290,37 @@ int get_mtime(const string &filename, time_t *pMtime)
 	return 0;
 }
 
+/**
+ * Set the access timestamp of a file to the current time.
+ * The modification timestamp is not changed.
+ * @param filename Filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int touch_atime(const string &filename)
+{
+	const tstring tfilename = makeWinPath(filename);
+
+	HANDLE hFile = CreateFile(tfilename.c_str(),
+		FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (!hFile || hFile == INVALID_HANDLE_VALUE) {
+		// Error opening the file.
+		return -w32err_to_posix(GetLastError());
+	}
+
+	SYSTEMTIME st;
+	FILETIME atime;
+	GetSystemTime(&st);
+	SystemTimeToFileTime(&st, &atime);
+	BOOL bRet = SetFileTime(hFile, nullptr, &atime, nullptr);
+	CloseHandle(hFile);
+	if (!bRet) {
+		// Error setting the file time.
+		return -w32err_to_posix(GetLastError());
+	}
+	return 0;
+}
+
 /**
  * Delete a file.
  * @param filename Filename.
@@ -312,6 +343,30 @@ int delete_file(const char *filename)
 	return ret;
 }
 
+/**
+ * Rename a file.
+ * If the destination file exists, it will be replaced.
+ * @param oldname Old filename.
+ * @param newname New filename.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int rename_file(const string &oldname, const string &newname)
+{
+	if (unlikely(oldname.empty() || newname.empty())) {
+		return -EINVAL;
+	}
+
+	int ret = 0;
+	const tstring toldname = makeWinPath(oldname);
+	const tstring tnewname = makeWinPath(newname);
+	if (!MoveFileEx(toldname.c_str(), tnewname.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+		// Error renaming file.
+		ret = -w32err_to_posix(GetLastError());
+	}
+
+	return ret;
+}
+
 /**
  * Check if the specified file is a symbolic link.
  * @return True if the file is a symbolic link; false if not.
@@ -510,4 +565,50 @@ int get_file_size_and_mtime(const string &filename, off64_t *pFileSize, time_t *
 	return 0;
 }
 
+/**
+ * Get a file's identity.
+ * @param filename	[in] Filename.
+ * @param pFileId	[out] File identity.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int get_file_identity(const string &filename, FileIdentity *pFileId)
+{
+	assert(pFileId != nullptr);
+	const tstring tfilename = makeWinPath(filename);
+
+	// Open the file to get the volume serial number and file index.
+	// FILE_FLAG_BACKUP_SEMANTICS is needed to open directories,
+	// which are rejected below.
+	HANDLE hFile = CreateFile(tfilename.c_str(),
+		FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+	if (!hFile || hFile == INVALID_HANDLE_VALUE) {
+		// An error occurred.
+		const int err = w32err_to_posix(GetLastError());
+		return (err != 0 ? -err : -EIO);
+	}
+
+	BY_HANDLE_FILE_INFORMATION bhfi;
+	BOOL bRet = GetFileInformationByHandle(hFile, &bhfi);
+	CloseHandle(hFile);
+	if (!bRet) {
+		// An error occurred.
+		const int err = w32err_to_posix(GetLastError());
+		return (err != 0 ? -err : -EIO);
+	}
+
+	// Make sure this is not a directory.
+	if (bhfi.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+		// It's a directory.
+		return -EISDIR;
+	}
+
+	// Return the file identity.
+	pFileId->dev = bhfi.dwVolumeSerialNumber;
+	pFileId->ino = (static_cast<uint64_t>(bhfi.nFileIndexHigh) << 32) | bhfi.nFileIndexLow;
+	pFileId->size = (static_cast<off64_t>(bhfi.nFileSizeHigh) << 32) | bhfi.nFileSizeLow;
+	pFileId->mtime = FileTimeToUnixTime(&bhfi.ftLastWriteTime);
+	return 0;
+}
+
 } }
@@ -16,9 +16,6 @@
 #include "libwin32common/w32err.h"
 using LibWin32Common::U82T_s;
 
-// C includes.
-#include <fcntl.h>
-
 // C++ STL classes.
 using std::string;
 using std::wstring;
@@ -39,9 +36,7 @@ DELAYLOAD_TEST_FUNCTION_IMPL0(zlibVersion);
 
 RpFilePrivate::~RpFilePrivate()
 {
-	if (gzfd) {
-		gzclose_r(gzfd);
-	}
+	delete gzReader;
 	if (file && file != INVALID_HANDLE_VALUE) {
 		CloseHandle(file);
 	}
@@ -90,7 +85,7 @@ inline int RpFilePrivate::mode_to_win32(RpFile::FileMode mode,
 /**
  * (Re-)Open the main file.
  *
- * INTERNAL FUNCTION. This does NOT affect gzfd.
+ * INTERNAL FUNCTION. This does NOT affect gzReader.
  * NOTE: This function sets q->m_lastError.
  *
  * Uses parameters stored in this->filename and this->mode.
@@ -262,6 +257,43 @@ int RpFilePrivate::reOpenFile(void)
 	return (!file || file == INVALID_HANDLE_VALUE);
 }
 
+/**
+ * Read compressed data for GzReader.
+ * @param param	[in] RpFilePrivate
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpFilePrivate::gzReadAt(void *param, off64_t pos, void *ptr, size_t size)
+{
+	RpFilePrivate *const d = static_cast<RpFilePrivate*>(param);
+
+	// NOTE: ReadFile() with an OVERLAPPED offset also updates
+	// the file pointer, but it isn't used for gzipped files.
+	uint8_t *ptr8 = static_cast<uint8_t*>(ptr);
+	size_t ret = 0;
+	while (size > 0) {
+		OVERLAPPED ov;
+		memset(&ov, 0, sizeof(ov));
+		ov.Offset = static_cast<DWORD>(pos & 0xFFFFFFFFU);
+		ov.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(pos) >> 32);
+
+		const DWORD toRead = static_cast<DWORD>(std::min(size, static_cast<size_t>(0x40000000U)));
+		DWORD bytesRead;
+		if (!ReadFile(d->file, ptr8, toRead, &bytesRead, &ov) || bytesRead == 0) {
+			// End of file or error.
+			break;
+		}
+
+		ptr8 += bytesRead;
+		pos += bytesRead;
+		size -= bytesRead;
+		ret += bytesRead;
+	}
+	return ret;
+}
+
 /** RpFile **/
 
 /**
@@ -316,7 +348,7 @@ void RpFile::init(void)
 	// Check if this is a gzipped file.
 	// If it is, use transparent decompression.
 	// Reference: https://www.forensicswiki.org/wiki/Gzip
-	if (!d->devInfo && d->mode == FM_OPEN_READ_GZ) {
+	if (!d->devInfo && (d->mode & ~FM_MMAP) == FM_OPEN_READ_GZ) {
 #if defined(_MSC_VER) && defined(ZLIB_IS_DLL)
 		// Delay load verification.
 		// TODO: Only if linked with /DELAYLOAD?
@@ -351,48 +383,31 @@ void RpFile::init(void)
 						// TODO: Add better verification heuristics?
 						d->gzsz = (off64_t)uncomp_sz;
 
-						liSeekPos.QuadPart = 0;
-						SetFilePointerEx(d->file, liSeekPos, nullptr, FILE_BEGIN);
-						// NOTE: Not sure if this is needed on Windows.
-						FlushFileBuffers(d->file);
-
-						// Open the file with gzdopen().
-						HANDLE hGzDup;
-						BOOL bRet = DuplicateHandle(
-							GetCurrentProcess(),	// hSourceProcessHandle
-							d->file,		// hSourceHandle
-							GetCurrentProcess(),	// hTargetProcessHandle
-							&hGzDup,		// lpTargetHandle
-							0,			// dwDesiredAccess
-							FALSE,			// bInheritHandle
-							DUPLICATE_SAME_ACCESS);	// dwOptions
-						if (bRet) {
-							// NOTE: close() on gzfd_dup() will close the
-							// underlying Windows handle.
-							int gzfd_dup = _open_osfhandle((intptr_t)hGzDup, _O_RDONLY);
-							if (gzfd_dup >= 0) {
-								// Make sure the CRC32 table is initialized.
-								get_crc_table();
-
-								d->gzfd = gzdopen(gzfd_dup, "r");
-								if (d->gzfd) {
-									m_isCompressed = true;
-								} else {
-									// gzdopen() failed.
-									// Close the dup()'d handle to prevent a leak.
-									_close(gzfd_dup);
+						// Decompress the file using GzReader.
+						// NOTE: GzReader uses overlapped reads, so the
+						// file pointer doesn't matter.
+						d->gzReader = new GzReader(RpFilePrivate::gzReadAt, d, liFileSize.QuadPart, d->gzsz);
+						if (d->gzReader->isOpen()) {
+							m_isCompressed = true;
+
+							// Load the access point index from the cache.
+							if (GzReader::isIndexCacheEnabled()) {
+								FileSystem::FileIdentity fileId;
+								if (FileSystem::get_file_identity(d->filename, &fileId) == 0) {
+									d->gzReader->loadIndexCache(fileId);
 								}
-							} else {
-								// Unable to open an fd.
-								CloseHandle(hGzDup);
 							}
+						} else {
+							// Unable to initialize the decompressor.
+							delete d->gzReader;
+							d->gzReader = nullptr;
 						}
 					}
 				}
 			}
 		}
 
-		if (!d->gzfd) {
+		if (!d->gzReader) {
 			// Not a gzipped file.
 			// Rewind and flush the file.
 			LARGE_INTEGER liSeekPos;
@@ -435,10 +450,8 @@ void RpFile::close(void)
 		d->devInfo->close();
 	}
 
-	if (d->gzfd) {
-		gzclose_r(d->gzfd);
-		d->gzfd = nullptr;
-	}
+	delete d->gzReader;
+	d->gzReader = nullptr;
 	if (d->file && d->file != INVALID_HANDLE_VALUE) {
 		CloseHandle(d->file);
 		d->file = INVALID_HANDLE_VALUE;
@@ -468,15 +481,13 @@ size_t RpFile::read(void *ptr, size_t size)
 	}
 
 	DWORD bytesRead;
-	if (d->gzfd) {
-		int iret = gzread(d->gzfd, ptr, (unsigned int)size);
-		if (iret >= 0) {
-			bytesRead = (DWORD)iret;
-		} else {
+	if (d->gzReader) {
+		const size_t ret = d->gzReader->read(ptr, size);
+		if (ret != size && d->gzReader->lastError() != 0) {
 			// An error occurred.
-			bytesRead = 0;
-			m_lastError = errno;
+			m_lastError = d->gzReader->lastError();
 		}
+		return ret;
 	} else {
 		BOOL bRet = ReadFile(d->file, ptr, static_cast<DWORD>(size), &bytesRead, nullptr);
 		if (!bRet) {
@@ -489,6 +500,99 @@ size_t RpFile::read(void *ptr, size_t size)
 	return bytesRead;
 }
 
+/**
+ * Read data from the file at the specified position.
+ * The file position is not changed.
+ * @param pos	[in] File position.
+ * @param ptr	[out] Output data buffer.
+ * @param size	[in] Amount of data to read, in bytes.
+ * @return Number of bytes read.
+ */
+size_t RpFile::readAt(off64_t pos, void *ptr, size_t size)
+{
+	RP_D(RpFile);
+	if (!d->file || d->file == INVALID_HANDLE_VALUE) {
+		m_lastError = EBADF;
+		return 0;
+	} else if (size == 0) {
+		// Nothing to read.
+		return 0;
+	}
+
+	if (d->devInfo || d->gzReader) {
+		// Block devices and gzipped files depend on the
+		// file position, so use seek() and read().
+		return super::readAt(pos, ptr, size);
+	}
+
+	if (pos < 0) {
+		m_lastError = EINVAL;
+		return 0;
+	}
+
+	// NOTE: ReadFile() with an OVERLAPPED offset updates the
+	// file pointer for synchronous handles, so the previous
+	// file pointer has to be restored afterwards.
+	// If multiple threads call readAt() at the same time, the
+	// data is still read correctly, but the file pointer is
+	// unspecified until the next seek().
+	LARGE_INTEGER liZero, liPrevPos;
+	liZero.QuadPart = 0;
+	if (!SetFilePointerEx(d->file, liZero, &liPrevPos, FILE_CURRENT)) {
+		m_lastError = w32err_to_posix(GetLastError());
+		return 0;
+	}
+
+	OVERLAPPED ov;
+	memset(&ov, 0, sizeof(ov));
+	ov.Offset = static_cast<DWORD>(pos & 0xFFFFFFFFU);
+	ov.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(pos) >> 32);
+
+	DWORD bytesRead;
+	BOOL bRet = ReadFile(d->file, ptr, static_cast<DWORD>(size), &bytesRead, &ov);
+	if (!bRet) {
+		const DWORD dwError = GetLastError();
+		if (dwError != ERROR_HANDLE_EOF) {
+			// An error occurred.
+			m_lastError = w32err_to_posix(dwError);
+		}
+		bytesRead = 0;
+	}
+
+	SetFilePointerEx(d->file, liPrevPos, nullptr, FILE_BEGIN);
+	return bytesRead;
+}
+
+/**
+ * Read multiple ranges of the file at once.
+ * The file position is not changed.
+ * @param reqs	[in/out] Read requests. (ret is set on return)
+ * @param count	[in] Number of read requests.
+ * @return Number of requests that were read completely.
+ */
+unsigned int RpFile::readBatch(ReadRequest *reqs, unsigned int count)
+{
+	// TODO: Submit the requests at once using overlapped I/O.
+	// This requires opening the file with FILE_FLAG_OVERLAPPED.
+	return super::readBatch(reqs, count);
+}
+
+/**
+ * Get a direct pointer to a range of the file's data.
+ * This is only available if the file was opened with
+ * FM_MMAP and it could be memory-mapped.
+ * @param pos	[in] File position.
+ * @param size	[in] Size of the range, in bytes.
+ * @return Pointer to the data, or nullptr if not available.
+ */
+const uint8_t *RpFile::dataPtr(off64_t pos, size_t size)
+{
+	// TODO: Memory mapping on Windows. (FM_MMAP is ignored for now.)
+	RP_UNUSED(pos);
+	RP_UNUSED(size);
+	return nullptr;
+}
+
 /**
  * Write data to the file.
  * @param ptr Input data buffer.
@@ -550,17 +654,10 @@ int RpFile::seek(off64_t pos)
 	}
 
 	int ret;
-	if (d->gzfd) {
-		// FIXME: Might not work with >2GB files...
-		z_off_t zret = gzseek(d->gzfd, (long)pos, SEEK_SET);
-		if (zret >= 0) {
-			ret = 0;
-		} else {
-			ret = -1;
-			m_lastError = -errno;
-			if (m_lastError == 0) {
-				m_lastError = -EIO;
-			}
+	if (d->gzReader) {
+		ret = d->gzReader->seek(pos);
+		if (ret != 0) {
+			m_lastError = d->gzReader->lastError();
 		}
 	} else {
 		LARGE_INTEGER liSeekPos;
@@ -596,8 +693,8 @@ off64_t RpFile::tell(void)
 		return d->devInfo->device_pos;
 	}
 
-	if (d->gzfd) {
-		return (off64_t)gztell(d->gzfd);
+	if (d->gzReader) {
+		return d->gzReader->tell();
 	}
 
 	LARGE_INTEGER liSeekPos, liSeekRet;
@@ -706,10 +803,12 @@ off64_t RpFile::size(void)
 	if (d->devInfo) {
 		// Block device. Use the cached device size.
 		return d->devInfo->device_size;
-	} else if (d->gzfd) {
+	} else if (d->gzReader) {
 		// gzipped files have the uncompressed size stored
-		// at the end of the stream.
-		return d->gzsz;
+		// at the end of the stream, modulo 2^32. If the entire
+		// file has been decompressed, the actual size is known.
+		const off64_t gzReaderSize = d->gzReader->uncompressedSize();
+		return (gzReaderSize >= 0 ? gzReaderSize : d->gzsz);
 	}
 
 	// Regular file.
@@ -100,6 +100,13 @@ int rp_secure_enable(rp_secure_param_t param)
 		seccomp_rule_add_array(ctx, SCMP_ACT_ALLOW, SCMP_SYS(clone),
 			(unsigned int)(sizeof(clone_params)/sizeof(clone_params[0])), clone_params);
 
+#if defined(__SNR_clone3) || defined(__NR_clone3)
+		// clone3() passes its flags in a struct, so it can't be
+		// filtered like clone(). Return ENOSYS so glibc-2.34+
+		// falls back to clone() when creating threads.
+		seccomp_rule_add_array(ctx, SCMP_ACT_ERRNO(ENOSYS), SCMP_SYS(clone3), 0, NULL);
+#endif /* __SNR_clone3 || __NR_clone3 */
+
 		// Skip clone() in the loop.
 		p++;
 	}
@@ -197,6 +197,52 @@ FileFormat *FileFormatFactory::create(IRpFile *file)
 	return nullptr;
 }
 
+/**
+ * Check if a file header has a magic number that is
+ * recognized by any FileFormat subclass.
+ *
+ * This doesn't construct any FileFormat objects, so it's
+ * much cheaper than create() for files that definitely
+ * aren't textures. A return value of true doesn't mean
+ * that create() will succeed.
+ *
+ * @param pHeader File header, starting at address 0.
+ * @param size Size of pHeader. (Must be at least 8 bytes.)
+ * @return True if the magic number is recognized; false if not.
+ */
+bool FileFormatFactory::isTextureSupported(const uint8_t *pHeader, size_t size)
+{
+	assert(pHeader != nullptr);
+	if (!pHeader || size < sizeof(uint32_t)*2) {
+		// Not enough data to check.
+		return false;
+	}
+
+	uint32_t magic[2];
+	memcpy(magic, pHeader, sizeof(magic));
+
+	// Khronos KTX: Two completely different versions.
+	if (magic[0] == cpu_to_be32('\xABKTX')) {
+		return (magic[1] == cpu_to_be32(' 11\xBB') ||
+		        magic[1] == cpu_to_be32(' 20\xBB'));
+	}
+
+	// Check FileFormat subclasses that take a header at 0
+	// and definitely have a 32-bit magic number at address 0.
+	magic[0] = be32_to_cpu(magic[0]);
+	const FileFormatFactoryPrivate::FileFormatFns *fns =
+		&FileFormatFactoryPrivate::FileFormatFns_magic[0];
+	for (; fns->supportedFileExtensions != nullptr; fns++) {
+		if (magic[0] == fns->magic) {
+			// Found a matching magic number.
+			return true;
+		}
+	}
+
+	// Not supported.
+	return false;
+}
+
 /**
  * Get all supported file extensions.
  * Used for Win32 COM registration.
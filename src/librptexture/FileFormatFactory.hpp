@@ -47,6 +47,21 @@ class FileFormatFactory
 		 */
 		static LibRpTexture::FileFormat *create(LibRpFile::IRpFile *file);
 
+		/**
+		 * Check if a file header has a magic number that is
+		 * recognized by any FileFormat subclass.
+		 *
+		 * This doesn't construct any FileFormat objects, so it's
+		 * much cheaper than create() for files that definitely
+		 * aren't textures. A return value of true doesn't mean
+		 * that create() will succeed.
+		 *
+		 * @param pHeader File header, starting at address 0.
+		 * @param size Size of pHeader. (Must be at least 8 bytes.)
+		 * @return True if the magic number is recognized; false if not.
+		 */
+		static bool isTextureSupported(const uint8_t *pHeader, size_t size);
+
 		/**
 		 * Get all supported file extensions.
 		 * Used for Win32 COM registration.
@@ -137,6 +137,22 @@ enum class PixelFormat : uint8_t {
 #endif
 };
 
+/** Parallel decoding **/
+
+/**
+ * Set the maximum number of threads used to decode
+ * large block-compressed images.
+ * @param maxThreads Maximum number of threads. (0 for no limit; 1 to disable parallel decoding)
+ */
+void setMaxThreads(unsigned int maxThreads);
+
+/**
+ * Get the maximum number of threads used to decode
+ * large block-compressed images.
+ * @return Maximum number of threads. (0 for no limit)
+ */
+unsigned int maxThreads(void);
+
 /**
  * Convert a linear CI4 image to rp_image with a little-endian 16-bit palette.
  * @param px_format Palette pixel format.
@@ -238,50 +238,18 @@ static FORCEINLINE void rshift128(uint64_t &msb, uint64_t &lsb, unsigned int sha
 }
 
 /**
- * Convert a BC7 image to rp_image.
- * @param width Image width.
- * @param height Image height.
- * @param img_buf BC7 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)]
- * @return rp_image, or nullptr on error.
+ * Decode BC7 tile rows.
+ * @param param ImageDecoderPrivate::TileRowsParams*
+ * @param tileY_start First tile row.
+ * @param tileY_end Last tile row, plus one.
+ * @return 0 on success; negative POSIX error code on error.
  */
-rp_image *fromBC7(int width, int height,
-	const uint8_t *img_buf, int img_siz)
+static int decodeRows_BC7(void *param, unsigned int tileY_start, unsigned int tileY_end)
 {
-	// Verify parameters.
-	assert(img_buf != nullptr);
-	assert(width > 0);
-	assert(height > 0);
-
-	// BC7 uses 4x4 tiles, but some container formats allow
-	// the last tile to be cut off, so round up for the
-	// physical tile size.
-	const int physWidth = ALIGN_BYTES(4, width);
-	const int physHeight = ALIGN_BYTES(4, height);
-
-	assert(img_siz >= (width * height));
-	if (!img_buf || width <= 0 || height <= 0 ||
-	    img_siz < (physWidth * physHeight))
-	{
-		return nullptr;
-	}
-
-	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
-	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
-
-	// Create an rp_image.
-	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
-	if (!img->isValid()) {
-		// Could not allocate the image.
-		img->unref();
-		return nullptr;
-	}
-
-	// sBIT metadata.
-	// TODO: Dynamically determine if we have alpha?
-	// Rotation bits makes this difficult...
-	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
+	const ImageDecoderPrivate::TileRowsParams *const p =
+		static_cast<const ImageDecoderPrivate::TileRowsParams*>(param);
+	rp_image *const img = p->img;
+	const unsigned int tilesX = p->tilesX;
 
 	// BC7 has eight block modes with varying properties, including
 	// bitfields of different lengths. As such, the only guaranteed
@@ -289,7 +257,7 @@ rp_image *fromBC7(int width, int height,
 	// represented as two uint64_t values, which will be shifted
 	// as each component is processed.
 	// TODO: Optimize by using fewer shifts?
-	const uint64_t *bc7_src = reinterpret_cast<const uint64_t*>(img_buf);
+	const uint64_t *bc7_src = reinterpret_cast<const uint64_t*>(p->img_buf) + (tileY_start * tilesX * 2);
 
 	// Temporary tile buffer.
 	ALIGNED_VAR(16, argb32_t tileBuf[4*4]);
@@ -302,7 +270,7 @@ rp_image *fromBC7(int width, int height,
 	uint8_t anchor_index[4];
 	anchor_index[0] = 0;
 
-	for (unsigned int y = 0; y < tilesY; y++) {
+	for (unsigned int y = tileY_start; y < tileY_end; y++) {
 	for (unsigned int x = 0; x < tilesX; x++, bc7_src += 2) {
 		/** BEGIN: Temporary values. **/
 
@@ -332,8 +300,7 @@ rp_image *fromBC7(int width, int height,
 		const int mode = get_mode(static_cast<uint32_t>(lsb));
 		if (mode < 0) {
 			// Invalid mode.
-			img->unref();
-			return nullptr;
+			return -EIO;
 		}
 		rshift128(msb, lsb, mode+1);
 
@@ -680,6 +647,68 @@ rp_image *fromBC7(int width, int height,
 			reinterpret_cast<const uint32_t*>(&tileBuf[0]), x, y);
 	} }
 
+	return 0;
+}
+
+/**
+ * Convert a BC7 image to rp_image.
+ * @param width Image width.
+ * @param height Image height.
+ * @param img_buf BC7 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @return rp_image, or nullptr on error.
+ */
+rp_image *fromBC7(int width, int height,
+	const uint8_t *img_buf, int img_siz)
+{
+	// Verify parameters.
+	assert(img_buf != nullptr);
+	assert(width > 0);
+	assert(height > 0);
+
+	// BC7 uses 4x4 tiles, but some container formats allow
+	// the last tile to be cut off, so round up for the
+	// physical tile size.
+	const int physWidth = ALIGN_BYTES(4, width);
+	const int physHeight = ALIGN_BYTES(4, height);
+
+	assert(img_siz >= (width * height));
+	if (!img_buf || width <= 0 || height <= 0 ||
+	    img_siz < (physWidth * physHeight))
+	{
+		return nullptr;
+	}
+
+	// Calculate the total number of tiles.
+	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+
+	// Create an rp_image.
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
+	if (!img->isValid()) {
+		// Could not allocate the image.
+		img->unref();
+		return nullptr;
+	}
+
+	// sBIT metadata.
+	// TODO: Dynamically determine if we have alpha?
+	// Rotation bits makes this difficult...
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
+
+	// Decode the tiles.
+	ImageDecoderPrivate::TileRowsParams params;
+	params.img = img;
+	params.img_buf = img_buf;
+	params.tilesX = tilesX;
+	int ret = ImageDecoderPrivate::decodeTileRows(tilesY, static_cast<unsigned int>(physWidth * physHeight),
+		decodeRows_BC7, &params);
+	if (ret != 0) {
+		// Invalid block mode.
+		img->unref();
+		return nullptr;
+	}
+
 	if (width < physWidth || height < physHeight) {
 		// Shrink the image.
 		img->shrink(width, height);
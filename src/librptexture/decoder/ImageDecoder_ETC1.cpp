@@ -598,6 +598,38 @@ static void decodeBlock_ETC_RGB(uint32_t tileBuf[4*4], const etc1_block *etc1_sr
 	}
 }
 
+/**
+ * Decode ETC1/ETC2 RGB tile rows.
+ * @tparam mode ETC_Decoding_Mode
+ * @param param ImageDecoderPrivate::TileRowsParams*
+ * @param tileY_start First tile row.
+ * @param tileY_end Last tile row, plus one.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+template</* ETC_Decoding_Mode */ unsigned int mode>
+static int decodeRows_ETC_RGB(void *param, unsigned int tileY_start, unsigned int tileY_end)
+{
+	const ImageDecoderPrivate::TileRowsParams *const p =
+		static_cast<const ImageDecoderPrivate::TileRowsParams*>(param);
+	rp_image *const img = p->img;
+	const unsigned int tilesX = p->tilesX;
+	const etc1_block *etc1_src = reinterpret_cast<const etc1_block*>(p->img_buf) + (tileY_start * tilesX);
+
+	// Temporary tile buffer.
+	uint32_t tileBuf[4*4];
+
+	for (unsigned int y = tileY_start; y < tileY_end; y++) {
+	for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
+		// Decode the ETC RGB block.
+		decodeBlock_ETC_RGB<mode>(tileBuf, etc1_src);
+
+		// Blit the tile to the main image buffer.
+		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
+	} }
+
+	return 0;
+}
+
 /**
  * Convert an ETC1 image to rp_image.
  * @param width Image width.
@@ -634,23 +666,14 @@ rp_image *fromETC1(int width, int height,
 		return nullptr;
 	}
 
-	const etc1_block *etc1_src = reinterpret_cast<const etc1_block*>(img_buf);
-
-	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
+	// Decode the tiles.
+	ImageDecoderPrivate::TileRowsParams params;
+	params.img = img;
+	params.img_buf = img_buf;
+	params.tilesX = static_cast<unsigned int>(width / 4);
 	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
-
-	// Temporary tile buffer.
-	uint32_t tileBuf[4*4];
-
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
-		// Decode the ETC1 RGB block.
-		decodeBlock_ETC_RGB<ETC_DM_ETC1>(tileBuf, etc1_src);
-
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
-	} }
+	ImageDecoderPrivate::decodeTileRows(tilesY, static_cast<unsigned int>(width * height),
+		decodeRows_ETC_RGB<ETC_DM_ETC1>, &params);
 
 	// Set the sBIT metadata.
 	static const rp_image::sBIT_t sBIT = {8,8,8,0,0};
@@ -696,23 +719,14 @@ rp_image *fromETC2_RGB(int width, int height,
 		return nullptr;
 	}
 
-	const etc1_block *etc1_src = reinterpret_cast<const etc1_block*>(img_buf);
-
-	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
+	// Decode the tiles.
+	ImageDecoderPrivate::TileRowsParams params;
+	params.img = img;
+	params.img_buf = img_buf;
+	params.tilesX = static_cast<unsigned int>(width / 4);
 	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
-
-	// Temporary tile buffer.
-	uint32_t tileBuf[4*4];
-
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
-		// Decode the ETC2 RGB block.
-		decodeBlock_ETC_RGB<ETC_DM_ETC2>(tileBuf, etc1_src);
-
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
-	} }
+	ImageDecoderPrivate::decodeTileRows(tilesY, static_cast<unsigned int>(width * height),
+		decodeRows_ETC_RGB<ETC_DM_ETC2>, &params);
 
 	// Set the sBIT metadata.
 	static const rp_image::sBIT_t sBIT = {8,8,8,0,0};
@@ -762,6 +776,40 @@ static void decodeBlock_ETC2_alpha(uint32_t tileBuf[4*4], const etc2_alpha *alph
 	}
 }
 
+/**
+ * Decode ETC2 RGBA tile rows.
+ * @param param ImageDecoderPrivate::TileRowsParams*
+ * @param tileY_start First tile row.
+ * @param tileY_end Last tile row, plus one.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int decodeRows_ETC2_RGBA(void *param, unsigned int tileY_start, unsigned int tileY_end)
+{
+	const ImageDecoderPrivate::TileRowsParams *const p =
+		static_cast<const ImageDecoderPrivate::TileRowsParams*>(param);
+	rp_image *const img = p->img;
+	const unsigned int tilesX = p->tilesX;
+	const etc2_rgba_block *etc2_src = reinterpret_cast<const etc2_rgba_block*>(p->img_buf) + (tileY_start * tilesX);
+
+	// Temporary tile buffer.
+	uint32_t tileBuf[4*4];
+
+	for (unsigned int y = tileY_start; y < tileY_end; y++) {
+	for (unsigned int x = 0; x < tilesX; x++, etc2_src++) {
+		// Decode the ETC2 RGB block.
+		decodeBlock_ETC_RGB<ETC_DM_ETC2>(tileBuf, &etc2_src->etc1);
+
+		// Decode the ETC2 alpha block.
+		// TODO: Don't fill in the alpha channel in decodeBlock_ETC2_RGB()?
+		decodeBlock_ETC2_alpha(tileBuf, &etc2_src->alpha);
+
+		// Blit the tile to the main image buffer.
+		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
+	} }
+
+	return 0;
+}
+
 /**
  * Convert an ETC2 RGBA image to rp_image.
  * @param width Image width.
@@ -798,27 +846,14 @@ rp_image *fromETC2_RGBA(int width, int height,
 		return nullptr;
 	}
 
-	const etc2_rgba_block *etc2_src = reinterpret_cast<const etc2_rgba_block*>(img_buf);
-
-	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
+	// Decode the tiles.
+	ImageDecoderPrivate::TileRowsParams params;
+	params.img = img;
+	params.img_buf = img_buf;
+	params.tilesX = static_cast<unsigned int>(width / 4);
 	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
-
-	// Temporary tile buffer.
-	uint32_t tileBuf[4*4];
-
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, etc2_src++) {
-		// Decode the ETC2 RGB block.
-		decodeBlock_ETC_RGB<ETC_DM_ETC2>(tileBuf, &etc2_src->etc1);
-
-		// Decode the ETC2 alpha block.
-		// TODO: Don't fill in the alpha channel in decodeBlock_ETC2_RGB()?
-		decodeBlock_ETC2_alpha(tileBuf, &etc2_src->alpha);
-
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
-	} }
+	ImageDecoderPrivate::decodeTileRows(tilesY, static_cast<unsigned int>(width * height),
+		decodeRows_ETC2_RGBA, &params);
 
 	// Set the sBIT metadata.
 	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
@@ -864,23 +899,14 @@ rp_image *fromETC2_RGB_A1(int width, int height,
 		return nullptr;
 	}
 
-	const etc1_block *etc1_src = reinterpret_cast<const etc1_block*>(img_buf);
-
-	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
+	// Decode the tiles.
+	ImageDecoderPrivate::TileRowsParams params;
+	params.img = img;
+	params.img_buf = img_buf;
+	params.tilesX = static_cast<unsigned int>(width / 4);
 	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
-
-	// Temporary tile buffer.
-	uint32_t tileBuf[4*4];
-
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, etc1_src++) {
-		// Decode the ETC2 RGB block.
-		decodeBlock_ETC_RGB<ETC_DM_ETC2 | ETC2_DM_A1>(tileBuf, etc1_src);
-
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
-	} }
+	ImageDecoderPrivate::decodeTileRows(tilesY, static_cast<unsigned int>(width * height),
+		decodeRows_ETC_RGB<ETC_DM_ETC2 | ETC2_DM_A1>, &params);
 
 	// Set the sBIT metadata.
 	static const rp_image::sBIT_t sBIT = {8,8,8,0,1};
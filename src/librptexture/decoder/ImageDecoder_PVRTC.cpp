@@ -22,6 +22,54 @@
 
 namespace LibRpTexture { namespace ImageDecoder {
 
+/**
+ * Parameters for decodeRows_PVRTC().
+ */
+struct PVRTC_DecodeParams {
+	uint8_t *bits;			// Output image buffer.
+	const uint8_t *img_buf;		// PVRTC image buffer.
+	uint32_t width;			// Physical width.
+	uint32_t height;		// Physical height.
+	uint32_t do2bitMode;		// 1 for 2bpp; 0 for 4bpp.
+	uint32_t expected_size_in;	// Expected size to be read by the PowerVR Native SDK.
+	unsigned int tilesY;		// Number of word rows to decode.
+	bool pvrtcII;			// True for PVRTC-II.
+};
+
+/**
+ * Decode PVRTC word rows.
+ *
+ * Each word row is 4 pixels high, so this is equivalent
+ * to decoding 4x4 or 8x4 tile rows.
+ *
+ * @param param PVRTC_DecodeParams*
+ * @param tileY_start First word row.
+ * @param tileY_end Last word row, plus one.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int decodeRows_PVRTC(void *param, unsigned int tileY_start, unsigned int tileY_end)
+{
+	const PVRTC_DecodeParams *const p = static_cast<const PVRTC_DecodeParams*>(param);
+
+	// Use the PowerVR Native SDK to decompress the texture.
+	// Return value is the size of the *input* data that was decompressed.
+	// NOTE: The row functions don't handle textures that are smaller
+	// than the minimum PVRTC size, so use the regular functions if
+	// the entire texture is being decoded.
+	uint32_t size;
+	if (tileY_start == 0 && tileY_end == p->tilesY) {
+		size = (p->pvrtcII
+			? pvr::PVRTDecompressPVRTCII(p->img_buf, p->do2bitMode, p->width, p->height, p->bits)
+			: pvr::PVRTDecompressPVRTC(p->img_buf, p->do2bitMode, p->width, p->height, p->bits));
+	} else {
+		size = (p->pvrtcII
+			? pvr::PVRTDecompressPVRTCII_Rows(p->img_buf, p->do2bitMode, p->width, p->height, p->bits, tileY_start, tileY_end)
+			: pvr::PVRTDecompressPVRTC_Rows(p->img_buf, p->do2bitMode, p->width, p->height, p->bits, tileY_start, tileY_end));
+	}
+	assert(size == p->expected_size_in);
+	return (size == p->expected_size_in ? 0 : -EIO);
+}
+
 /**
  * Convert a PVRTC 2bpp or 4bpp image to rp_image.
  * @param width Image width.
@@ -75,13 +123,22 @@ rp_image *fromPVRTC(int width, int height,
 		return nullptr;
 	}
 
-	// Use the PowerVR Native SDK to decompress the texture.
-	// Return value is the size of the *input* data that was decompressed.
+	// Decompress the texture.
 	// TODO: Row padding?
-	uint32_t size = pvr::PVRTDecompressPVRTC(img_buf, ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP), width, height,
-		static_cast<uint8_t*>(img->bits()));
-	assert(size == expected_size_in);
-	if (size != expected_size_in) {
+	PVRTC_DecodeParams params;
+	params.bits = static_cast<uint8_t*>(img->bits());
+	params.img_buf = img_buf;
+	params.width = static_cast<uint32_t>(width);
+	params.height = static_cast<uint32_t>(height);
+	params.do2bitMode = ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP);
+	params.expected_size_in = expected_size_in;
+	params.pvrtcII = false;
+	// Textures smaller than the minimum PVRTC size have to be decoded all at once.
+	params.tilesY = (params.width >= (params.do2bitMode ? 16U : 8U) && params.height >= 8U)
+		? (params.height / 4) : 1;
+	int ret = ImageDecoderPrivate::decodeTileRows(params.tilesY, params.width * params.height,
+		decodeRows_PVRTC, &params);
+	if (ret != 0) {
 		// Read error...
 		img->unref();
 		return nullptr;
@@ -139,20 +196,29 @@ rp_image *fromPVRTCII(int width, int height,
 	}
 
 	// Create an rp_image.
-	rp_image *const img = new rp_image(width, height, rp_image::Format::ARGB32);
+	rp_image *const img = new rp_image(physWidth, physHeight, rp_image::Format::ARGB32);
 	if (!img->isValid()) {
 		// Could not allocate the image.
 		img->unref();
 		return nullptr;
 	}
 
-	// Use the PowerVR Native SDK to decompress the texture.
-	// Return value is the size of the *input* data that was decompressed.
+	// Decompress the texture.
 	// TODO: Row padding?
-	uint32_t size = pvr::PVRTDecompressPVRTCII(img_buf, ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP),
-		physWidth, physHeight, static_cast<uint8_t*>(img->bits()));
-	assert(size == expected_size_in);
-	if (size != expected_size_in) {
+	PVRTC_DecodeParams params;
+	params.bits = static_cast<uint8_t*>(img->bits());
+	params.img_buf = img_buf;
+	params.width = static_cast<uint32_t>(physWidth);
+	params.height = static_cast<uint32_t>(physHeight);
+	params.do2bitMode = ((mode & PVRTC_BPP_MASK) == PVRTC_2BPP);
+	params.expected_size_in = expected_size_in;
+	params.pvrtcII = true;
+	// Textures smaller than the minimum PVRTC size have to be decoded all at once.
+	params.tilesY = (params.width >= (params.do2bitMode ? 16U : 8U) && params.height >= 8U)
+		? (params.height / 4) : 1;
+	int ret = ImageDecoderPrivate::decodeTileRows(params.tilesY, params.width * params.height,
+		decodeRows_PVRTC, &params);
+	if (ret != 0) {
 		// Read error...
 		img->unref();
 		return nullptr;
@@ -0,0 +1,134 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * ImageDecoder_Parallel.cpp: Image decoding functions. (parallel)         *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+
+#include "ImageDecoder.hpp"
+#include "ImageDecoder_p.hpp"
+
+// librpthreads
+#include "librpthreads/Atomics.h"
+#include "librpthreads/ThreadPool.hpp"
+using LibRpThreads::ThreadPool;
+
+namespace LibRpTexture {
+
+namespace ImageDecoder {
+
+// Maximum number of threads for parallel decoding. (0 for no limit)
+static volatile unsigned int max_threads = 0;
+
+/**
+ * Set the maximum number of threads used to decode
+ * large block-compressed images.
+ * @param maxThreads Maximum number of threads. (0 for no limit; 1 to disable parallel decoding)
+ */
+void setMaxThreads(unsigned int maxThreads)
+{
+	ATOMIC_EXCHANGE(&max_threads, maxThreads);
+}
+
+/**
+ * Get the maximum number of threads used to decode
+ * large block-compressed images.
+ * @return Maximum number of threads. (0 for no limit)
+ */
+unsigned int maxThreads(void)
+{
+	return max_threads;
+}
+
+}
+
+// Number of bands per thread.
+// Using more than one band per thread balances the load
+// if some parts of the image take longer to decode.
+#define DECODE_BANDS_PER_THREAD 4U
+
+/**
+ * Parallel decoding job.
+ */
+struct DecodeTileRowsJob {
+	ImageDecoderPrivate::DecodeTileRowsFn fn;
+	void *param;
+	unsigned int tilesY;	// Total number of tile rows.
+	unsigned int bands;	// Number of bands.
+	volatile int ret;	// First error code.
+};
+
+/**
+ * ThreadPool task function for parallel decoding.
+ * @param param DecodeTileRowsJob*
+ * @param index Band index.
+ */
+static void decodeTileRowsTask(void *param, unsigned int index)
+{
+	DecodeTileRowsJob *const job = static_cast<DecodeTileRowsJob*>(param);
+	if (job->ret != 0) {
+		// Another band failed. No point in decoding this one.
+		return;
+	}
+
+	const unsigned int y_start = static_cast<unsigned int>(
+		(static_cast<uint64_t>(job->tilesY) * index) / job->bands);
+	const unsigned int y_end = static_cast<unsigned int>(
+		(static_cast<uint64_t>(job->tilesY) * (index + 1)) / job->bands);
+	const int ret = job->fn(job->param, y_start, y_end);
+	if (ret != 0) {
+		ATOMIC_CMPXCHG(&job->ret, 0, ret);
+	}
+}
+
+/**
+ * Decode tile rows, using the shared thread pool for large images.
+ *
+ * Each tile row must be independent of all other tile rows.
+ * Images with fewer than DECODE_PARALLEL_MIN_PIXELS pixels
+ * are decoded on the calling thread.
+ *
+ * @param tilesY Number of tile rows.
+ * @param pixels Number of pixels in the image.
+ * @param fn Decode function.
+ * @param param User parameter.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int ImageDecoderPrivate::decodeTileRows(unsigned int tilesY, unsigned int pixels,
+	DecodeTileRowsFn fn, void *param)
+{
+	assert(fn != nullptr);
+	if (tilesY == 0) {
+		return 0;
+	}
+
+	const unsigned int maxThreads = ImageDecoder::maxThreads();
+	if (pixels < DECODE_PARALLEL_MIN_PIXELS || tilesY < 2 || maxThreads == 1) {
+		// Decode the entire image on the calling thread.
+		return fn(param, 0, tilesY);
+	}
+
+	ThreadPool *const pool = ThreadPool::instance();
+	unsigned int threads = pool->threadCount();
+	if (maxThreads != 0 && threads > maxThreads) {
+		threads = maxThreads;
+	}
+	if (threads < 2) {
+		// Not worth decoding concurrently.
+		return fn(param, 0, tilesY);
+	}
+
+	DecodeTileRowsJob job;
+	job.fn = fn;
+	job.param = param;
+	job.tilesY = tilesY;
+	job.bands = std::min(threads * DECODE_BANDS_PER_THREAD, tilesY);
+	job.ret = 0;
+	pool->parallelFor(job.bands, decodeTileRowsTask, &job, threads);
+	return job.ret;
+}
+
+}
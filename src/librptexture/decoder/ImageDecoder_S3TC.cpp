@@ -45,6 +45,33 @@ union dxt5_alpha {
 	uint64_t u64;	// Access the 48-bit code value directly. (Requires shifting.)
 };
 
+// DXT3 block format.
+struct dxt3_block {
+	uint64_t alpha;		// Alpha values. (4-bit per pixel)
+	dxt1_block colors;	// DXT1-style color block.
+};
+ASSERT_STRUCT(dxt3_block, 16);
+
+// DXT5 block format.
+struct dxt5_block {
+	dxt5_alpha alpha;
+	dxt1_block colors;	// DXT1-style color block.
+};
+ASSERT_STRUCT(dxt5_block, 16);
+
+// BC4 block format.
+struct bc4_block {
+	dxt5_alpha red;
+};
+ASSERT_STRUCT(bc4_block, 8);
+
+// BC5 block format.
+struct bc5_block {
+	dxt5_alpha red;
+	dxt5_alpha green;
+};
+ASSERT_STRUCT(bc5_block, 16);
+
 /**
  * Extract the 48-bit code value from dxt5_alpha.
  * @param data dxt5_alpha.
@@ -266,6 +293,45 @@ rp_image *fromDXT1_GCN(int width, int height,
 	return img;
 }
 
+/**
+ * Decode DXT1 tile rows.
+ * @tparam palflags decode_DXTn_tile_color_palette_S3TC<>() flags.
+ * @param param ImageDecoderPrivate::TileRowsParams*
+ * @param tileY_start First tile row.
+ * @param tileY_end Last tile row, plus one.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+template<unsigned int palflags>
+static int decodeRows_DXT1(void *param, unsigned int tileY_start, unsigned int tileY_end)
+{
+	const ImageDecoderPrivate::TileRowsParams *const p =
+		static_cast<const ImageDecoderPrivate::TileRowsParams*>(param);
+	rp_image *const img = p->img;
+	const unsigned int tilesX = p->tilesX;
+	const dxt1_block *dxt1_src = reinterpret_cast<const dxt1_block*>(p->img_buf) + (tileY_start * tilesX);
+
+	// Temporary tile buffer.
+	uint32_t tileBuf[4*4];
+
+	for (unsigned int y = tileY_start; y < tileY_end; y++) {
+	for (unsigned int x = 0; x < tilesX; x++, dxt1_src++) {
+		// Decode the DXT1 tile palette.
+		argb32_t pal[4];
+		decode_DXTn_tile_color_palette_S3TC<palflags>(pal, dxt1_src);
+
+		// Process the 16 color indexes.
+		uint32_t indexes = le32_to_cpu(dxt1_src->indexes);
+		for (unsigned int i = 0; i < 16; i++, indexes >>= 2) {
+			tileBuf[i] = pal[indexes & 3].u32;
+		}
+
+		// Blit the tile to the main image buffer.
+		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
+	} }
+
+	return 0;
+}
+
 /**
  * Convert a DXT1 image to rp_image.
  * @param palflags decode_DXTn_tile_color_palette_S3TC<>() flags.
@@ -305,30 +371,14 @@ static rp_image *T_fromDXT1(int width, int height,
 		return nullptr;
 	}
 
-	const dxt1_block *dxt1_src = reinterpret_cast<const dxt1_block*>(img_buf);
-
-	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	// Decode the tiles.
+	ImageDecoderPrivate::TileRowsParams params;
+	params.img = img;
+	params.img_buf = img_buf;
+	params.tilesX = static_cast<unsigned int>(physWidth / 4);
 	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
-
-	// Temporary tile buffer.
-	uint32_t tileBuf[4*4];
-
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, dxt1_src++) {
-		// Decode the DXT1 tile palette.
-		argb32_t pal[4];
-		decode_DXTn_tile_color_palette_S3TC<palflags>(pal, dxt1_src);
-
-		// Process the 16 color indexes.
-		uint32_t indexes = le32_to_cpu(dxt1_src->indexes);
-		for (unsigned int i = 0; i < 16; i++, indexes >>= 2) {
-			tileBuf[i] = pal[indexes & 3].u32;
-		}
-
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
-	} }
+	ImageDecoderPrivate::decodeTileRows(tilesY, static_cast<unsigned int>(physWidth * physHeight),
+		decodeRows_DXT1<palflags>, &params);
 
 	if (width < physWidth || height < physHeight) {
 		// Shrink the image.
@@ -404,6 +454,50 @@ rp_image *fromDXT2(int width, int height,
 	return img;
 }
 
+/**
+ * Decode DXT3 tile rows.
+ * @param param ImageDecoderPrivate::TileRowsParams*
+ * @param tileY_start First tile row.
+ * @param tileY_end Last tile row, plus one.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int decodeRows_DXT3(void *param, unsigned int tileY_start, unsigned int tileY_end)
+{
+	const ImageDecoderPrivate::TileRowsParams *const p =
+		static_cast<const ImageDecoderPrivate::TileRowsParams*>(param);
+	rp_image *const img = p->img;
+	const unsigned int tilesX = p->tilesX;
+	const dxt3_block *dxt3_src = reinterpret_cast<const dxt3_block*>(p->img_buf) + (tileY_start * tilesX);
+
+	// Temporary tile buffer.
+	uint32_t tileBuf[4*4];
+
+	for (unsigned int y = tileY_start; y < tileY_end; y++) {
+	for (unsigned int x = 0; x < tilesX; x++, dxt3_src++) {
+		// Decode the DXT3 tile palette.
+		argb32_t pal[4];
+		// FIXME: DXTn_PALETTE_COLOR0_LE_COLOR1 seems to result in garbage pixels.
+		// https://github.com/kchapelier/decode-dxt/tree/master/lib has similar code
+		// but handles DXT3 like both DXT1 and DXT5, so disable this for now.
+		decode_DXTn_tile_color_palette_S3TC<0/*DXTn_PALETTE_COLOR0_LE_COLOR1*/>(pal, &dxt3_src->colors);
+
+		// Process the 16 color indexes and apply alpha.
+		uint32_t indexes = le32_to_cpu(dxt3_src->colors.indexes);
+		uint64_t alpha = le64_to_cpu(dxt3_src->alpha);
+		for (unsigned int i = 0; i < 16; i++, indexes >>= 2, alpha >>= 4) {
+			argb32_t color = pal[indexes & 3];
+			// TODO: Verify alpha value handling for DXT3.
+			color.a = (alpha & 0xF) | ((alpha & 0xF) << 4);
+			tileBuf[i] = color.u32;
+		}
+
+		// Blit the tile to the main image buffer.
+		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
+	} }
+
+	return 0;
+}
+
 /**
  * Convert a DXT3 image to rp_image.
  * @param width Image width.
@@ -441,43 +535,14 @@ rp_image *fromDXT3(int width, int height,
 		return nullptr;
 	}
 
-	// DXT3 block format.
-	struct dxt3_block {
-		uint64_t alpha;		// Alpha values. (4-bit per pixel)
-		dxt1_block colors;	// DXT1-style color block.
-	};
-	ASSERT_STRUCT(dxt3_block, 16);
-	const dxt3_block *dxt3_src = reinterpret_cast<const dxt3_block*>(img_buf);
-
-	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	// Decode the tiles.
+	ImageDecoderPrivate::TileRowsParams params;
+	params.img = img;
+	params.img_buf = img_buf;
+	params.tilesX = static_cast<unsigned int>(physWidth / 4);
 	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
-
-	// Temporary tile buffer.
-	uint32_t tileBuf[4*4];
-
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, dxt3_src++) {
-		// Decode the DXT3 tile palette.
-		argb32_t pal[4];
-		// FIXME: DXTn_PALETTE_COLOR0_LE_COLOR1 seems to result in garbage pixels.
-		// https://github.com/kchapelier/decode-dxt/tree/master/lib has similar code
-		// but handles DXT3 like both DXT1 and DXT5, so disable this for now.
-		decode_DXTn_tile_color_palette_S3TC<0/*DXTn_PALETTE_COLOR0_LE_COLOR1*/>(pal, &dxt3_src->colors);
-
-		// Process the 16 color indexes and apply alpha.
-		uint32_t indexes = le32_to_cpu(dxt3_src->colors.indexes);
-		uint64_t alpha = le64_to_cpu(dxt3_src->alpha);
-		for (unsigned int i = 0; i < 16; i++, indexes >>= 2, alpha >>= 4) {
-			argb32_t color = pal[indexes & 3];
-			// TODO: Verify alpha value handling for DXT3.
-			color.a = (alpha & 0xF) | ((alpha & 0xF) << 4);
-			tileBuf[i] = color.u32;
-		}
-
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
-	} }
+	ImageDecoderPrivate::decodeTileRows(tilesY, static_cast<unsigned int>(physWidth * physHeight),
+		decodeRows_DXT3, &params);
 
 	if (width < physWidth || height < physHeight) {
 		// Shrink the image.
@@ -521,6 +586,49 @@ rp_image *fromDXT4(int width, int height,
 	return img;
 }
 
+/**
+ * Decode DXT5 tile rows.
+ * @param param ImageDecoderPrivate::TileRowsParams*
+ * @param tileY_start First tile row.
+ * @param tileY_end Last tile row, plus one.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int decodeRows_DXT5(void *param, unsigned int tileY_start, unsigned int tileY_end)
+{
+	const ImageDecoderPrivate::TileRowsParams *const p =
+		static_cast<const ImageDecoderPrivate::TileRowsParams*>(param);
+	rp_image *const img = p->img;
+	const unsigned int tilesX = p->tilesX;
+	const dxt5_block *dxt5_src = reinterpret_cast<const dxt5_block*>(p->img_buf) + (tileY_start * tilesX);
+
+	// Temporary tile buffer.
+	uint32_t tileBuf[4*4];
+
+	for (unsigned int y = tileY_start; y < tileY_end; y++) {
+	for (unsigned int x = 0; x < tilesX; x++, dxt5_src++) {
+		// Decode the DXT5 tile palette.
+		argb32_t pal[4];
+		decode_DXTn_tile_color_palette_S3TC<0>(pal, &dxt5_src->colors);
+
+		// Get the DXT5 alpha codes.
+		uint64_t alpha48 = extract48(&dxt5_src->alpha);
+
+		// Process the 16 color and alpha indexes.
+		uint32_t indexes = le32_to_cpu(dxt5_src->colors.indexes);
+		for (unsigned int i = 0; i < 16; i++, indexes >>= 2, alpha48 >>= 3) {
+			argb32_t color = pal[indexes & 3];
+			// Decode the alpha channel value.
+			color.a = decode_DXT5_alpha_S3TC(alpha48 & 7, dxt5_src->alpha.values);
+			tileBuf[i] = color.u32;
+		}
+
+		// Blit the tile to the main image buffer.
+		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
+	} }
+
+	return 0;
+}
+
 /**
  * Convert a DXT5 image to rp_image.
  * @param width Image width.
@@ -558,36 +666,61 @@ rp_image *fromDXT5(int width, int height,
 		return nullptr;
 	}
 
-	// DXT5 block format.
-	struct dxt5_block {
-		dxt5_alpha alpha;
-		dxt1_block colors;	// DXT1-style color block.
-	};
-	ASSERT_STRUCT(dxt5_block, 16);
-	const dxt5_block *dxt5_src = reinterpret_cast<const dxt5_block*>(img_buf);
-
-	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	// Decode the tiles.
+	ImageDecoderPrivate::TileRowsParams params;
+	params.img = img;
+	params.img_buf = img_buf;
+	params.tilesX = static_cast<unsigned int>(physWidth / 4);
 	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+	ImageDecoderPrivate::decodeTileRows(tilesY, static_cast<unsigned int>(physWidth * physHeight),
+		decodeRows_DXT5, &params);
+
+	if (width < physWidth || height < physHeight) {
+		// Shrink the image.
+		img->shrink(width, height);
+	}
+
+	// Set the sBIT metadata.
+	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Decode BC4 tile rows.
+ * @param param ImageDecoderPrivate::TileRowsParams*
+ * @param tileY_start First tile row.
+ * @param tileY_end Last tile row, plus one.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int decodeRows_BC4(void *param, unsigned int tileY_start, unsigned int tileY_end)
+{
+	const ImageDecoderPrivate::TileRowsParams *const p =
+		static_cast<const ImageDecoderPrivate::TileRowsParams*>(param);
+	rp_image *const img = p->img;
+	const unsigned int tilesX = p->tilesX;
+	const bc4_block *bc4_src = reinterpret_cast<const bc4_block*>(p->img_buf) + (tileY_start * tilesX);
 
 	// Temporary tile buffer.
 	uint32_t tileBuf[4*4];
 
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, dxt5_src++) {
-		// Decode the DXT5 tile palette.
-		argb32_t pal[4];
-		decode_DXTn_tile_color_palette_S3TC<0>(pal, &dxt5_src->colors);
+	// S3TC version.
+	for (unsigned int y = tileY_start; y < tileY_end; y++) {
+	for (unsigned int x = 0; x < tilesX; x++, bc4_src++) {
+		// BC4 colors are determined using DXT5-style alpha interpolation.
 
-		// Get the DXT5 alpha codes.
-		uint64_t alpha48 = extract48(&dxt5_src->alpha);
+		// Get the BC4 color codes.
+		uint64_t red48 = extract48(&bc4_src->red);
 
-		// Process the 16 color and alpha indexes.
-		uint32_t indexes = le32_to_cpu(dxt5_src->colors.indexes);
-		for (unsigned int i = 0; i < 16; i++, indexes >>= 2, alpha48 >>= 3) {
-			argb32_t color = pal[indexes & 3];
-			// Decode the alpha channel value.
-			color.a = decode_DXT5_alpha_S3TC(alpha48 & 7, dxt5_src->alpha.values);
+		// Process the 16 color indexes.
+		// NOTE: Using red instead of grayscale here.
+		argb32_t color;
+		color.u32 = 0xFF000000;	// opaque black
+		for (unsigned int i = 0; i < 16; i++, red48 >>= 3) {
+			// Decode the red channel value.
+			color.r = decode_DXT5_alpha_S3TC(red48 & 7, bc4_src->red.values);
 			tileBuf[i] = color.u32;
 		}
 
@@ -595,17 +728,7 @@ rp_image *fromDXT5(int width, int height,
 		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
 	} }
 
-	if (width < physWidth || height < physHeight) {
-		// Shrink the image.
-		img->shrink(width, height);
-	}
-
-	// Set the sBIT metadata.
-	static const rp_image::sBIT_t sBIT = {8,8,8,0,8};
-	img->set_sBIT(&sBIT);
-
-	// Image has been converted.
-	return img;
+	return 0;
 }
 
 /**
@@ -645,35 +768,64 @@ rp_image *fromBC4(int width, int height,
 		return nullptr;
 	}
 
-	// BC4 block format.
-	struct bc4_block {
-		dxt5_alpha red;
-	};
-	ASSERT_STRUCT(bc4_block, 8);
-	const bc4_block *bc4_src = reinterpret_cast<const bc4_block*>(img_buf);
-
-	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(physWidth / 4);
+	// Decode the tiles.
+	ImageDecoderPrivate::TileRowsParams params;
+	params.img = img;
+	params.img_buf = img_buf;
+	params.tilesX = static_cast<unsigned int>(physWidth / 4);
 	const unsigned int tilesY = static_cast<unsigned int>(physHeight / 4);
+	ImageDecoderPrivate::decodeTileRows(tilesY, static_cast<unsigned int>(physWidth * physHeight),
+		decodeRows_BC4, &params);
+
+	if (width < physWidth || height < physHeight) {
+		// Shrink the image.
+		img->shrink(width, height);
+	}
+
+	// Set the sBIT metadata.
+	// NOTE: We have to set '1' for the empty Green and Blue channels,
+	// since libpng complains if it's set to '0'.
+	static const rp_image::sBIT_t sBIT = {8,1,1,0,0};
+	img->set_sBIT(&sBIT);
+
+	// Image has been converted.
+	return img;
+}
+
+/**
+ * Decode BC5 tile rows.
+ * @param param ImageDecoderPrivate::TileRowsParams*
+ * @param tileY_start First tile row.
+ * @param tileY_end Last tile row, plus one.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int decodeRows_BC5(void *param, unsigned int tileY_start, unsigned int tileY_end)
+{
+	const ImageDecoderPrivate::TileRowsParams *const p =
+		static_cast<const ImageDecoderPrivate::TileRowsParams*>(param);
+	rp_image *const img = p->img;
+	const unsigned int tilesX = p->tilesX;
+	const bc5_block *bc5_src = reinterpret_cast<const bc5_block*>(p->img_buf) + (tileY_start * tilesX);
 
 	// Temporary tile buffer.
 	uint32_t tileBuf[4*4];
 
 	// S3TC version.
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, bc4_src++) {
-		// BC4 colors are determined using DXT5-style alpha interpolation.
+	for (unsigned int y = tileY_start; y < tileY_end; y++) {
+	for (unsigned int x = 0; x < tilesX; x++, bc5_src++) {
+		// BC5 colors are determined using DXT5-style alpha interpolation.
 
-		// Get the BC4 color codes.
-		uint64_t red48 = extract48(&bc4_src->red);
+		// Get the BC5 color codes.
+		uint64_t red48   = extract48(&bc5_src->red);
+		uint64_t green48 = extract48(&bc5_src->green);
 
 		// Process the 16 color indexes.
-		// NOTE: Using red instead of grayscale here.
 		argb32_t color;
 		color.u32 = 0xFF000000;	// opaque black
-		for (unsigned int i = 0; i < 16; i++, red48 >>= 3) {
-			// Decode the red channel value.
-			color.r = decode_DXT5_alpha_S3TC(red48 & 7, bc4_src->red.values);
+		for (unsigned int i = 0; i < 16; i++, red48 >>= 3, green48 >>= 3) {
+			// Decode the red and green channel values.
+			color.r = decode_DXT5_alpha_S3TC(red48   & 7, bc5_src->red.values);
+			color.g = decode_DXT5_alpha_S3TC(green48 & 7, bc5_src->green.values);
 			tileBuf[i] = color.u32;
 		}
 
@@ -681,19 +833,7 @@ rp_image *fromBC4(int width, int height,
 		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
 	} }
 
-	if (width < physWidth || height < physHeight) {
-		// Shrink the image.
-		img->shrink(width, height);
-	}
-
-	// Set the sBIT metadata.
-	// NOTE: We have to set '1' for the empty Green and Blue channels,
-	// since libpng complains if it's set to '0'.
-	static const rp_image::sBIT_t sBIT = {8,1,1,0,0};
-	img->set_sBIT(&sBIT);
-
-	// Image has been converted.
-	return img;
+	return 0;
 }
 
 /**
@@ -733,43 +873,14 @@ rp_image *fromBC5(int width, int height,
 		return nullptr;
 	}
 
-	// BC5 block format.
-	struct bc5_block {
-		dxt5_alpha red;
-		dxt5_alpha green;
-	};
-	ASSERT_STRUCT(bc5_block, 16);
-	const bc5_block *bc5_src = reinterpret_cast<const bc5_block*>(img_buf);
-
-	// Calculate the total number of tiles.
-	const unsigned int tilesX = static_cast<unsigned int>(width / 4);
+	// Decode the tiles.
+	ImageDecoderPrivate::TileRowsParams params;
+	params.img = img;
+	params.img_buf = img_buf;
+	params.tilesX = static_cast<unsigned int>(width / 4);
 	const unsigned int tilesY = static_cast<unsigned int>(height / 4);
-
-	// Temporary tile buffer.
-	uint32_t tileBuf[4*4];
-
-	// S3TC version.
-	for (unsigned int y = 0; y < tilesY; y++) {
-	for (unsigned int x = 0; x < tilesX; x++, bc5_src++) {
-		// BC5 colors are determined using DXT5-style alpha interpolation.
-
-		// Get the BC5 color codes.
-		uint64_t red48   = extract48(&bc5_src->red);
-		uint64_t green48 = extract48(&bc5_src->green);
-
-		// Process the 16 color indexes.
-		argb32_t color;
-		color.u32 = 0xFF000000;	// opaque black
-		for (unsigned int i = 0; i < 16; i++, red48 >>= 3, green48 >>= 3) {
-			// Decode the red and green channel values.
-			color.r = decode_DXT5_alpha_S3TC(red48   & 7, bc5_src->red.values);
-			color.g = decode_DXT5_alpha_S3TC(green48 & 7, bc5_src->green.values);
-			tileBuf[i] = color.u32;
-		}
-
-		// Blit the tile to the main image buffer.
-		ImageDecoderPrivate::BlitTile<uint32_t, 4, 4>(img, tileBuf, x, y);
-	} }
+	ImageDecoderPrivate::decodeTileRows(tilesY, static_cast<unsigned int>(width * height),
+		decodeRows_BC5, &params);
 
 	if (width < physWidth || height < physHeight) {
 		// Shrink the image.
@@ -58,8 +58,47 @@ class ImageDecoderPrivate
 		static inline void BlitTile_CI4_LeftLSN(
 			rp_image *RESTRICT img, const uint8_t *RESTRICT tileBuf,
 			unsigned int tileX, unsigned int tileY);
+
+	public:
+		/**
+		 * Common parameters for DecodeTileRowsFn.
+		 */
+		struct TileRowsParams {
+			rp_image *img;			// Output image.
+			const uint8_t *img_buf;		// Image buffer.
+			unsigned int tilesX;		// Number of tiles per row.
+		};
+
+		/**
+		 * Decode function for a range of tile rows.
+		 * @param param User parameter.
+		 * @param tileY_start First tile row.
+		 * @param tileY_end Last tile row, plus one.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		typedef int (*DecodeTileRowsFn)(void *param, unsigned int tileY_start, unsigned int tileY_end);
+
+		/**
+		 * Decode tile rows, using the shared thread pool for large images.
+		 *
+		 * Each tile row must be independent of all other tile rows.
+		 * Images with fewer than DECODE_PARALLEL_MIN_PIXELS pixels
+		 * are decoded on the calling thread.
+		 *
+		 * @param tilesY Number of tile rows.
+		 * @param pixels Number of pixels in the image.
+		 * @param fn Decode function.
+		 * @param param User parameter.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int decodeTileRows(unsigned int tilesY, unsigned int pixels,
+			DecodeTileRowsFn fn, void *param);
 };
 
+// Minimum number of pixels for parallel decoding.
+// Smaller images aren't worth the thread synchronization overhead.
+#define DECODE_PARALLEL_MIN_PIXELS (256U*256U)
+
 /**
  * Blit a tile to an rp_image.
  * NOTE: No bounds checking is done.
@@ -51,19 +51,30 @@ class DirectDrawSurfacePrivate final : public FileFormatPrivate
 		// Texture data start address.
 		unsigned int texDataStartAddr;
 
-		// Decoded image.
-		rp_image *img;
+		// Decoded mipmaps.
+		// Mipmap 0 is the full image.
+		vector<rp_image*> mipmaps;
 
 		// Pixel format message.
 		// NOTE: Used for both valid and invalid pixel formats
 		// due to various bit specifications.
 		char pixel_format[32];
 
+		/**
+		 * Calculate the size of a mipmap.
+		 * Uncompressed mipmaps are assumed to not have any row padding.
+		 * @param width Mipmap width.
+		 * @param height Mipmap height.
+		 * @return Mipmap size, in bytes, or 0 if the pixel format isn't supported.
+		 */
+		unsigned int calcMipmapSize(unsigned int width, unsigned int height) const;
+
 		/**
 		 * Load the image.
+		 * @param mip Mipmap number. (0 == full image)
 		 * @return Image, or nullptr on error.
 		 */
-		const rp_image *loadImage(void);
+		const rp_image *loadImage(int mip);
 
 	public:
 		// Supported uncompressed RGB formats.
@@ -474,7 +485,6 @@ int DirectDrawSurfacePrivate::updatePixelFormat(void)
 DirectDrawSurfacePrivate::DirectDrawSurfacePrivate(DirectDrawSurface *q, IRpFile *file)
 	: super(q, file)
 	, texDataStartAddr(0)
-	, img(nullptr)
 	, pxf_uncomp(ImageDecoder::PixelFormat::Unknown)
 	, bytespp(0)
 	, dxgi_format(0)
@@ -489,18 +499,96 @@ DirectDrawSurfacePrivate::DirectDrawSurfacePrivate(DirectDrawSurface *q, IRpFile
 
 DirectDrawSurfacePrivate::~DirectDrawSurfacePrivate()
 {
-	UNREF(img);
+	std::for_each(mipmaps.begin(), mipmaps.end(), [](rp_image *img) { UNREF(img); });
+}
+
+/**
+ * Calculate the size of a mipmap.
+ * Uncompressed mipmaps are assumed to not have any row padding.
+ * @param width Mipmap width.
+ * @param height Mipmap height.
+ * @return Mipmap size, in bytes, or 0 if the pixel format isn't supported.
+ */
+unsigned int DirectDrawSurfacePrivate::calcMipmapSize(unsigned int width, unsigned int height) const
+{
+	if (dxgi_format == 0) {
+		// Uncompressed linear image data.
+		return width * height * bytespp;
+	}
+
+	// Compressed RGB data.
+	switch (dxgi_format) {
+#ifdef ENABLE_PVRTC
+		case DXGI_FORMAT_FAKE_PVRTC_2bpp:
+			// 32 pixels compressed into 64 bits. (2bpp)
+			return (width * height) / 4;
+
+		case DXGI_FORMAT_FAKE_PVRTC_4bpp:
+			// 16 pixels compressed into 64 bits. (4bpp)
+			return (width * height) / 2;
+#endif /* ENABLE_PVRTC */
+
+		case DXGI_FORMAT_BC1_TYPELESS:
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+		case DXGI_FORMAT_BC4_TYPELESS:
+		case DXGI_FORMAT_BC4_UNORM:
+		case DXGI_FORMAT_BC4_SNORM:
+			// 16 pixels compressed into 64 bits. (4bpp)
+			// NOTE: Width and height must be rounded to the nearest tile. (4x4)
+			return ALIGN_BYTES(4, width) * ALIGN_BYTES(4, height) / 2;
+
+		case DXGI_FORMAT_BC2_TYPELESS:
+		case DXGI_FORMAT_BC2_UNORM:
+		case DXGI_FORMAT_BC2_UNORM_SRGB:
+		case DXGI_FORMAT_BC3_TYPELESS:
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+		case DXGI_FORMAT_BC5_TYPELESS:
+		case DXGI_FORMAT_BC5_UNORM:
+		case DXGI_FORMAT_BC5_SNORM:
+		case DXGI_FORMAT_BC7_TYPELESS:
+		case DXGI_FORMAT_BC7_UNORM:
+		case DXGI_FORMAT_BC7_UNORM_SRGB:
+			// 16 pixels compressed into 128 bits. (8bpp)
+			// NOTE: Width and height must be rounded to the nearest tile. (4x4)
+			return ALIGN_BYTES(4, width) * ALIGN_BYTES(4, height);
+
+		case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+			// Uncompressed "special" 32bpp formats.
+			return width * height * 4;
+
+		default:
+			// Not supported.
+			return 0;
+	}
 }
 
 /**
  * Load the image.
+ * @param mip Mipmap number. (0 == full image)
  * @return Image, or nullptr on error.
  */
-const rp_image *DirectDrawSurfacePrivate::loadImage(void)
+const rp_image *DirectDrawSurfacePrivate::loadImage(int mip)
 {
-	if (img) {
+	// NOTE: DDSD_MIPMAPCOUNT might not be accurate, so ignore it.
+	// NOTE: A 32768x32768 texture has 16 mipmaps.
+	int mipmapCount = static_cast<int>(std::min(ddsHeader.dwMipMapCount, 16U));
+	if (mipmapCount <= 0) {
+		// No mipmaps == one image.
+		mipmapCount = 1;
+	}
+
+	assert(mip >= 0);
+	assert(mip < mipmapCount);
+	if (mip < 0 || mip >= mipmapCount) {
+		// Invalid mipmap number.
+		return nullptr;
+	}
+
+	if (!mipmaps.empty() && mipmaps[mip] != nullptr) {
 		// Image has already been loaded.
-		return img;
+		return mipmaps[mip];
 	} else if (!this->file || !this->isValid) {
 		// Can't load the image.
 		return nullptr;
@@ -533,93 +621,104 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 	}
 	const uint32_t file_sz = static_cast<uint32_t>(file->size());
 
-	// Seek to the start of the texture data.
-	int ret = file->seek(texDataStartAddr);
-	if (ret != 0) {
-		// Seek error.
-		return nullptr;
-	}
+	// Mipmap dimensions.
+	const unsigned int mip_w = std::max(ddsHeader.dwWidth >> mip, 1U);
+	const unsigned int mip_h = std::max(ddsHeader.dwHeight >> mip, 1U);
 
-	// TODO: Handle DX10 alpha processing.
-	// Currently, we're assuming straight alpha for formats
-	// that have an alpha channel, except for DXT2 and DXT4,
-	// which use premultiplied alpha.
+	// Row stride for uncompressed images.
+	unsigned int stride = 0;
+	if (dxgi_format == 0) {
+		assert(pxf_uncomp != ImageDecoder::PixelFormat::Unknown);
+		assert(bytespp != 0);
+		if (pxf_uncomp == ImageDecoder::PixelFormat::Unknown || bytespp == 0) {
+			// Pixel format wasn't updated...
+			return nullptr;
+		}
 
-	// NOTE: Mipmaps are stored *after* the main image.
-	// Hence, no mipmap processing is necessary.
-	if (dxgi_format != 0) {
-		// Compressed RGB data.
+		// If DDSD_LINEARSIZE is set, the field is linear size,
+		// so it needs to be divided by the image height.
+		if (ddsHeader.dwFlags & DDSD_LINEARSIZE) {
+			if (ddsHeader.dwHeight != 0) {
+				stride = ddsHeader.dwPitchOrLinearSize / ddsHeader.dwHeight;
+			}
+		} else {
+			stride = ddsHeader.dwPitchOrLinearSize;
+		}
+		if (stride == 0) {
+			// Invalid stride. Assume stride == width * bytespp.
+			// TODO: Check for stride is too small but non-zero?
+			stride = ddsHeader.dwWidth * bytespp;
+		} else if (stride > (ddsHeader.dwWidth * 16)) {
+			// Stride is too large.
+			return nullptr;
+		}
+	}
 
-		// NOTE: dwPitchOrLinearSize is not necessarily correct.
-		// Calculate the expected size.
-		uint32_t expected_size;
-		switch (dxgi_format) {
+	// Calculate the mipmap's address.
+	// NOTE: Mipmaps are stored *after* the main image,
+	// from largest to smallest.
+	uint32_t addr = texDataStartAddr;
+	if (mip > 0) {
+		// Mipmaps of volume textures are stored after all of the
+		// depth slices, and PVRTC mipmaps have a minimum size.
+		// The pitch of uncompressed mipmaps isn't stored, so the
+		// full image must not have any row padding.
+		if ((ddsHeader.dwCaps2 & DDSCAPS2_VOLUME) ||
+		    (dxgi_format == 0 && stride != ddsHeader.dwWidth * bytespp))
+		{
+			return nullptr;
+		}
 #ifdef ENABLE_PVRTC
-			case DXGI_FORMAT_FAKE_PVRTC_2bpp:
-				// 32 pixels compressed into 64 bits. (2bpp)
-				expected_size = (ddsHeader.dwWidth * ddsHeader.dwHeight) / 4;
-				break;
-
-			case DXGI_FORMAT_FAKE_PVRTC_4bpp:
-				// 16 pixels compressed into 64 bits. (4bpp)
-				expected_size = (ddsHeader.dwWidth * ddsHeader.dwHeight) / 2;
-				break;
+		if (dxgi_format == DXGI_FORMAT_FAKE_PVRTC_2bpp ||
+		    dxgi_format == DXGI_FORMAT_FAKE_PVRTC_4bpp)
+		{
+			return nullptr;
+		}
 #endif /* ENABLE_PVRTC */
 
-			case DXGI_FORMAT_BC1_TYPELESS:
-			case DXGI_FORMAT_BC1_UNORM:
-			case DXGI_FORMAT_BC1_UNORM_SRGB:
-			case DXGI_FORMAT_BC4_TYPELESS:
-			case DXGI_FORMAT_BC4_UNORM:
-			case DXGI_FORMAT_BC4_SNORM:
-				// 16 pixels compressed into 64 bits. (4bpp)
-				// NOTE: Width and height must be rounded to the nearest tile. (4x4)
-				expected_size = ALIGN_BYTES(4, ddsHeader.dwWidth) *
-				                ALIGN_BYTES(4, ddsHeader.dwHeight) / 2;
-				break;
-
-			case DXGI_FORMAT_BC2_TYPELESS:
-			case DXGI_FORMAT_BC2_UNORM:
-			case DXGI_FORMAT_BC2_UNORM_SRGB:
-			case DXGI_FORMAT_BC3_TYPELESS:
-			case DXGI_FORMAT_BC3_UNORM:
-			case DXGI_FORMAT_BC3_UNORM_SRGB:
-			case DXGI_FORMAT_BC5_TYPELESS:
-			case DXGI_FORMAT_BC5_UNORM:
-			case DXGI_FORMAT_BC5_SNORM:
-			case DXGI_FORMAT_BC7_TYPELESS:
-			case DXGI_FORMAT_BC7_UNORM:
-			case DXGI_FORMAT_BC7_UNORM_SRGB:
-				// 16 pixels compressed into 128 bits. (8bpp)
-				// NOTE: Width and height must be rounded to the nearest tile. (4x4)
-				expected_size = ALIGN_BYTES(4, ddsHeader.dwWidth) *
-				                ALIGN_BYTES(4, ddsHeader.dwHeight);
-				break;
-
-			case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
-				// Uncompressed "special" 32bpp formats.
-				expected_size = ddsHeader.dwWidth * ddsHeader.dwHeight * 4;
-				break;
-
-			default:
+		for (int i = 0; i < mip; i++) {
+			const unsigned int mip_size = calcMipmapSize(
+				std::max(ddsHeader.dwWidth >> i, 1U),
+				std::max(ddsHeader.dwHeight >> i, 1U));
+			if (mip_size == 0) {
 				// Not supported.
 				return nullptr;
+			}
+			addr += mip_size;
 		}
+	}
 
-		// Verify file size.
-		if (expected_size >= file_sz + texDataStartAddr) {
-			// File is too small.
-			return nullptr;
-		}
+	// NOTE: dwPitchOrLinearSize is not necessarily correct
+	// for compressed images. Calculate the expected size.
+	const unsigned int expected_size = (dxgi_format != 0)
+		? calcMipmapSize(mip_w, mip_h)
+		: mip_h * (mip > 0 ? mip_w * bytespp : stride);
+	if (expected_size == 0) {
+		// Not supported.
+		return nullptr;
+	}
 
-		// Read the texture data.
-		auto buf = aligned_uptr<uint8_t>(16, expected_size);
-		size_t size = file->read(buf.get(), expected_size);
-		if (size != expected_size) {
-			// Read error.
-			return nullptr;
-		}
+	// Verify file size.
+	if (static_cast<uint64_t>(addr) + expected_size > file_sz) {
+		// File is too small.
+		return nullptr;
+	}
 
+	// Read the texture data.
+	auto buf = aligned_uptr<uint8_t>(16, expected_size);
+	size_t size = file->seekAndRead(addr, buf.get(), expected_size);
+	if (size != expected_size) {
+		// Read error.
+		return nullptr;
+	}
+
+	// TODO: Handle DX10 alpha processing.
+	// Currently, we're assuming straight alpha for formats
+	// that have an alpha channel, except for DXT2 and DXT4,
+	// which use premultiplied alpha.
+	rp_image *img = nullptr;
+	if (dxgi_format != 0) {
+		// Compressed RGB data.
 		// TODO: Handle typeless, signed, sRGB, float.
 		switch (dxgi_format) {
 			case DXGI_FORMAT_BC1_TYPELESS:
@@ -628,12 +727,12 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 				if (likely(dxgi_alpha != DDS_ALPHA_MODE_OPAQUE)) {
 					// 1-bit alpha.
 					img = ImageDecoder::fromDXT1_A1(
-						ddsHeader.dwWidth, ddsHeader.dwHeight,
+						mip_w, mip_h,
 						buf.get(), expected_size);
 				} else {
 					// No alpha channel.
 					img = ImageDecoder::fromDXT1(
-						ddsHeader.dwWidth, ddsHeader.dwHeight,
+						mip_w, mip_h,
 						buf.get(), expected_size);
 				}
 				break;
@@ -644,12 +743,12 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 				if (likely(dxgi_alpha != DDS_ALPHA_MODE_PREMULTIPLIED)) {
 					// Standard alpha: DXT3
 					img = ImageDecoder::fromDXT3(
-						ddsHeader.dwWidth, ddsHeader.dwHeight,
+						mip_w, mip_h,
 						buf.get(), expected_size);
 				} else {
 					// Premultiplied alpha: DXT2
 					img = ImageDecoder::fromDXT2(
-						ddsHeader.dwWidth, ddsHeader.dwHeight,
+						mip_w, mip_h,
 						buf.get(), expected_size);
 				}
 				break;
@@ -660,12 +759,12 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 				if (likely(dxgi_alpha != DDS_ALPHA_MODE_PREMULTIPLIED)) {
 					// Standard alpha: DXT5
 					img = ImageDecoder::fromDXT5(
-						ddsHeader.dwWidth, ddsHeader.dwHeight,
+						mip_w, mip_h,
 						buf.get(), expected_size);
 				} else {
 					// Premultiplied alpha: DXT4
 					img = ImageDecoder::fromDXT4(
-						ddsHeader.dwWidth, ddsHeader.dwHeight,
+						mip_w, mip_h,
 						buf.get(), expected_size);
 				}
 				break;
@@ -674,7 +773,7 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 			case DXGI_FORMAT_BC4_UNORM:
 			case DXGI_FORMAT_BC4_SNORM:
 				img = ImageDecoder::fromBC4(
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
+					mip_w, mip_h,
 					buf.get(), expected_size);
 				break;
 
@@ -682,7 +781,7 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 			case DXGI_FORMAT_BC5_UNORM:
 			case DXGI_FORMAT_BC5_SNORM:
 				img = ImageDecoder::fromBC5(
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
+					mip_w, mip_h,
 					buf.get(), expected_size);
 				break;
 
@@ -690,7 +789,7 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 			case DXGI_FORMAT_BC7_UNORM:
 			case DXGI_FORMAT_BC7_UNORM_SRGB:
 				img = ImageDecoder::fromBC7(
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
+					mip_w, mip_h,
 					buf.get(), expected_size);
 				break;
 
@@ -698,7 +797,7 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 			case DXGI_FORMAT_FAKE_PVRTC_2bpp:
 				// PVRTC, 2bpp, has alpha.
 				img = ImageDecoder::fromPVRTC(
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
+					mip_w, mip_h,
 					buf.get(), expected_size,
 					ImageDecoder::PVRTC_2BPP | ImageDecoder::PVRTC_ALPHA_YES);
 				break;
@@ -706,7 +805,7 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 			case DXGI_FORMAT_FAKE_PVRTC_4bpp:
 				// PVRTC, 4bpp, has alpha.
 				img = ImageDecoder::fromPVRTC(
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
+					mip_w, mip_h,
 					buf.get(), expected_size,
 					ImageDecoder::PVRTC_4BPP | ImageDecoder::PVRTC_ALPHA_YES);
 				break;
@@ -716,7 +815,7 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 				// RGB9_E5 (technically uncompressed...)
 				img = ImageDecoder::fromLinear32(
 					ImageDecoder::PixelFormat::RGB9_E5,
-					ddsHeader.dwWidth, ddsHeader.dwHeight,
+					mip_w, mip_h,
 					reinterpret_cast<const uint32_t*>(buf.get()),
 					expected_size);
 				break;
@@ -727,59 +826,22 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 		}
 	} else {
 		// Uncompressed linear image data.
-		assert(pxf_uncomp != ImageDecoder::PixelFormat::Unknown);
-		assert(bytespp != 0);
-		if (pxf_uncomp == ImageDecoder::PixelFormat::Unknown || bytespp == 0) {
-			// Pixel format wasn't updated...
-			return nullptr;
-		}
-
-		// If DDSD_LINEARSIZE is set, the field is linear size,
-		// so it needs to be divided by the image height.
-		unsigned int stride = 0;
-		if (ddsHeader.dwFlags & DDSD_LINEARSIZE) {
-			if (ddsHeader.dwHeight != 0) {
-				stride = ddsHeader.dwPitchOrLinearSize / ddsHeader.dwHeight;
-			}
-		} else {
-			stride = ddsHeader.dwPitchOrLinearSize;
-		}
-		if (stride == 0) {
-			// Invalid stride. Assume stride == width * bytespp.
-			// TODO: Check for stride is too small but non-zero?
-			stride = ddsHeader.dwWidth * bytespp;
-		} else if (stride > (ddsHeader.dwWidth * 16)) {
-			// Stride is too large.
-			return nullptr;
-		}
-		const unsigned int expected_size = ddsHeader.dwHeight * stride;
-
-		// Verify file size.
-		if (expected_size >= file_sz + texDataStartAddr) {
-			// File is too small.
-			return nullptr;
-		}
-
-		// Read the texture data.
-		auto buf = aligned_uptr<uint8_t>(16, expected_size);
-		size_t size = file->read(buf.get(), expected_size);
-		if (size != expected_size) {
-			// Read error.
-			return nullptr;
+		if (mip > 0) {
+			stride = mip_w * bytespp;
 		}
 
 		switch (bytespp) {
 			case sizeof(uint8_t):
 				// 8-bit image. (Usually luminance or alpha.)
 				img = ImageDecoder::fromLinear8(
-					pxf_uncomp, ddsHeader.dwWidth, ddsHeader.dwHeight,
+					pxf_uncomp, mip_w, mip_h,
 					buf.get(), expected_size, stride);
 				break;
 
 			case sizeof(uint16_t):
 				// 16-bit RGB image.
 				img = ImageDecoder::fromLinear16(
-					pxf_uncomp, ddsHeader.dwWidth, ddsHeader.dwHeight,
+					pxf_uncomp, mip_w, mip_h,
 					reinterpret_cast<const uint16_t*>(buf.get()),
 					expected_size, stride);
 				break;
@@ -787,14 +849,14 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 			case 24/8:
 				// 24-bit RGB image.
 				img = ImageDecoder::fromLinear24(
-					pxf_uncomp, ddsHeader.dwWidth, ddsHeader.dwHeight,
+					pxf_uncomp, mip_w, mip_h,
 					buf.get(), expected_size, stride);
 				break;
 
 			case sizeof(uint32_t):
 				// 32-bit RGB image.
 				img = ImageDecoder::fromLinear32(
-					pxf_uncomp, ddsHeader.dwWidth, ddsHeader.dwHeight,
+					pxf_uncomp, mip_w, mip_h,
 					reinterpret_cast<const uint32_t*>(buf.get()),
 					expected_size, stride);
 				break;
@@ -807,6 +869,10 @@ const rp_image *DirectDrawSurfacePrivate::loadImage(void)
 	}
 
 	// TODO: Untile textures for XBOX format.
+	if (mipmaps.empty()) {
+		mipmaps.resize(mipmapCount);
+	}
+	mipmaps[mip] = img;
 	return img;
 }
 
@@ -1338,11 +1404,8 @@ const rp_image *DirectDrawSurface::mipmap(int mip) const
 		return nullptr;
 	}
 
-	// FIXME: Support decoding mipmaps.
-	if (mip == 0) {
-		return const_cast<DirectDrawSurfacePrivate*>(d)->loadImage();
-	}
-	return nullptr;
+	// Load the image.
+	return const_cast<DirectDrawSurfacePrivate*>(d)->loadImage(mip);
 }
 
 }
@@ -139,4 +139,51 @@ int FileFormat::getDimensions(int pBuf[3]) const
 	return 0;
 }
 
+/** Image accessors **/
+
+/**
+ * Get the image for the specified thumbnail size.
+ *
+ * This is the smallest mipmap whose largest dimension is
+ * at least reqSize, so only that mipmap is decoded.
+ * If no mipmap is suitable, the full image is returned.
+ *
+ * @param reqSize Requested size. (0 for the full image)
+ * @return Image, or nullptr on error.
+ */
+const rp_image *FileFormat::imageForSize(int reqSize) const
+{
+	RP_D(const FileFormat);
+	const int width = d->dimensions[0];
+	const int height = d->dimensions[1];
+	const int mipmapCount = this->mipmapCount();
+	if (reqSize <= 0 || mipmapCount <= 1 || width <= 0 || height <= 0) {
+		// No mipmaps.
+		return image();
+	}
+
+	// Find the smallest mipmap that's large enough.
+	// NOTE: Mipmaps smaller than 4x4 are skipped, since
+	// block-compressed formats use 4x4 tiles.
+	for (int mip = mipmapCount - 1; mip > 0; mip--) {
+		const int mip_w = width >> mip;
+		const int mip_h = height >> mip;
+		if (mip_w < 4 || mip_h < 4)
+			continue;
+		if (mip_w < reqSize && mip_h < reqSize)
+			continue;
+
+		// This mipmap is large enough.
+		// If it can't be decoded, use the full image.
+		const rp_image *const img = mipmap(mip);
+		if (img) {
+			return img;
+		}
+		break;
+	}
+
+	// Use the full image.
+	return image();
+}
+
 }
@@ -194,6 +194,18 @@ class FileFormat : public RefBase
 		 * @return Image, or nullptr on error.
 		 */
 		virtual const rp_image *mipmap(int mip) const = 0;
+
+		/**
+		 * Get the image for the specified thumbnail size.
+		 *
+		 * This is the smallest mipmap whose largest dimension is
+		 * at least reqSize, so only that mipmap is decoded.
+		 * If no mipmap is suitable, the full image is returned.
+		 *
+		 * @param reqSize Requested size. (0 for the full image)
+		 * @return Image, or nullptr on error.
+		 */
+		virtual const rp_image *imageForSize(int reqSize) const;
 };
 
 }
@@ -55,6 +55,9 @@ class ValveVTFPrivate final : public FileFormatPrivate
 		// Mipmap 0 is the full image.
 		vector<rp_image*> mipmaps;
 
+		// Decoded low-resolution image.
+		rp_image *lowResImg;
+
 		// Mipmap sizes and start addresses.
 		struct mipmap_data_t {
 			uint32_t addr;		// start address
@@ -98,7 +101,7 @@ class ValveVTFPrivate final : public FileFormatPrivate
 
 		/**
 		 * Load the image.
-		 * @param mip Mipmap number. (0 == full image)
+		 * @param mip Mipmap number. (0 == full image; -1 == low-resolution image)
 		 * @return Image, or nullptr on error.
 		 */
 		const rp_image *loadImage(int mip);
@@ -162,6 +165,7 @@ static_assert(ARRAY_SIZE(ValveVTFPrivate::img_format_tbl)-1 == VTF_IMAGE_FORMAT_
 ValveVTFPrivate::ValveVTFPrivate(ValveVTF *q, IRpFile *file)
 	: super(q, file)
 	, texDataStartAddr(0)
+	, lowResImg(nullptr)
 {
 	// Clear the structs and arrays.
 	memset(&vtfHeader, 0, sizeof(vtfHeader));
@@ -171,6 +175,7 @@ ValveVTFPrivate::ValveVTFPrivate(ValveVTF *q, IRpFile *file)
 ValveVTFPrivate::~ValveVTFPrivate()
 {
 	std::for_each(mipmaps.begin(), mipmaps.end(), [](rp_image *img) { UNREF(img); });
+	UNREF(lowResImg);
 }
 
 /**
@@ -418,29 +423,34 @@ int ValveVTFPrivate::getMipmapInfo(void)
 
 /**
  * Load the image.
- * @param mip Mipmap number. (0 == full image)
+ * @param mip Mipmap number. (0 == full image; -1 == low-resolution image)
  * @return Image, or nullptr on error.
  */
 const rp_image *ValveVTFPrivate::loadImage(int mip)
 {
-	// TODO: Option to load the low-res image instead?
 	int mipmapCount = vtfHeader.mipmapCount;
 	if (mipmapCount <= 0) {
 		// No mipmaps == one image.
 		mipmapCount = 1;
 	}
 
-	assert(mip >= 0);
+	assert(mip >= -1);
 	assert(mip < mipmapCount);
-	if (mip < 0 || mip >= mipmapCount) {
+	if (mip < -1 || mip >= mipmapCount) {
 		// Invalid mipmap number.
 		return nullptr;
 	}
 
-	if (!mipmaps.empty() && mipmaps[mip] != nullptr) {
+	if (mip < 0) {
+		if (lowResImg) {
+			// Image has already been loaded.
+			return lowResImg;
+		}
+	} else if (!mipmaps.empty() && mipmaps[mip] != nullptr) {
 		// Image has already been loaded.
 		return mipmaps[mip];
-	} else if (!this->file || !this->isValid) {
+	}
+	if (!this->file || !this->isValid) {
 		// Can't load the image.
 		return nullptr;
 	}
@@ -471,7 +481,30 @@ const rp_image *ValveVTFPrivate::loadImage(int mip)
 		// Error getting the mipmap info.
 		return nullptr;
 	}
-	const auto &mdata = mipmap_data[mip];
+
+	mipmap_data_t mdata;
+	VTF_IMAGE_FORMAT format;
+	if (mip < 0) {
+		// Low-resolution image.
+		// This is stored before the mipmaps.
+		if (vtfHeader.lowResImageFormat < 0 || vtfHeader.lowResImageWidth == 0) {
+			// No low-resolution image.
+			return nullptr;
+		}
+		format = static_cast<VTF_IMAGE_FORMAT>(vtfHeader.lowResImageFormat);
+		mdata.addr = texDataStartAddr;
+		mdata.width = vtfHeader.lowResImageWidth;
+		mdata.height = (vtfHeader.lowResImageHeight > 0 ? vtfHeader.lowResImageHeight : 1);
+		mdata.row_width = mdata.width;
+		mdata.size = calcImageSize(format, mdata.width, mdata.height);
+		if (mdata.size == 0) {
+			// Invalid image size.
+			return nullptr;
+		}
+	} else {
+		mdata = mipmap_data[mip];
+		format = static_cast<VTF_IMAGE_FORMAT>(vtfHeader.highResImageFormat);
+	}
 
 	// TODO: Handle environment maps (6-faced cube map) and volumetric textures.
 
@@ -505,7 +538,7 @@ const rp_image *ValveVTFPrivate::loadImage(int mip)
 	// TODO: Lookup table to convert to PXF constants?
 	// TODO: Verify on big-endian?
 	rp_image *img = nullptr;
-	switch (vtfHeader.highResImageFormat) {
+	switch (format) {
 		/* 32-bit */
 		case VTF_IMAGE_FORMAT_RGBA8888:
 		case VTF_IMAGE_FORMAT_UVWQ8888:	// handling as RGBA8888
@@ -686,7 +719,11 @@ const rp_image *ValveVTFPrivate::loadImage(int mip)
 			break;
 	}
 
-	mipmaps[mip] = img;
+	if (mip < 0) {
+		lowResImg = img;
+	} else {
+		mipmaps[mip] = img;
+	}
 	return img;
 }
 
@@ -1084,4 +1121,41 @@ const rp_image *ValveVTF::mipmap(int mip) const
 	return const_cast<ValveVTFPrivate*>(d)->loadImage(mip);
 }
 
+/**
+ * Get the image for the specified thumbnail size.
+ *
+ * This is the smallest mipmap whose largest dimension is
+ * at least reqSize, so only that mipmap is decoded.
+ * If the low-resolution image is large enough, it's used instead.
+ * If no mipmap is suitable, the full image is returned.
+ *
+ * @param reqSize Requested size. (0 for the full image)
+ * @return Image, or nullptr on error.
+ */
+const rp_image *ValveVTF::imageForSize(int reqSize) const
+{
+	RP_D(const ValveVTF);
+	if (!d->isValid) {
+		// Unknown file type.
+		return nullptr;
+	}
+
+	// The low-resolution image must have the same
+	// aspect ratio as the full image.
+	const int lr_w = d->vtfHeader.lowResImageWidth;
+	const int lr_h = d->vtfHeader.lowResImageHeight;
+	if (reqSize > 0 && d->vtfHeader.lowResImageFormat >= 0 &&
+	    lr_w > 0 && lr_h > 0 && (lr_w >= reqSize || lr_h >= reqSize) &&
+	    lr_w * d->dimensions[1] == lr_h * d->dimensions[0])
+	{
+		const rp_image *const img = const_cast<ValveVTFPrivate*>(d)->loadImage(-1);
+		if (img) {
+			return img;
+		}
+	}
+
+	// Use the smallest suitable mipmap.
+	return super::imageForSize(reqSize);
+}
+
 }
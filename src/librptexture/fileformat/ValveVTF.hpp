@@ -14,6 +14,21 @@
 namespace LibRpTexture {
 
 FILEFORMAT_DECL_BEGIN(ValveVTF)
+
+	public:
+		/**
+		 * Get the image for the specified thumbnail size.
+		 *
+		 * This is the smallest mipmap whose largest dimension is
+		 * at least reqSize, so only that mipmap is decoded.
+		 * If the low-resolution image is large enough, it's used instead.
+		 * If no mipmap is suitable, the full image is returned.
+		 *
+		 * @param reqSize Requested size. (0 for the full image)
+		 * @return Image, or nullptr on error.
+		 */
+		const rp_image *imageForSize(int reqSize) const final;
+
 FILEFORMAT_DECL_END()
 
 }
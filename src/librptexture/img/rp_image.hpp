@@ -22,6 +22,7 @@
 #if defined(RP_CPU_I386) || defined(RP_CPU_AMD64)
 # include "librpcpu/cpuflags_x86.h"
 # define RP_IMAGE_HAS_SSE2 1
+# define RP_IMAGE_HAS_SSSE3 1
 # define RP_IMAGE_HAS_SSE41 1
 #endif
 #ifdef RP_CPU_AMD64
@@ -501,6 +502,71 @@ class rp_image : public RefBase
 		 * @return 0 on success; negative POSIX error code on error.
 		 */
 		int shrink(int width, int height);
+
+		enum ScaleFilter : uint8_t {
+			SCALE_BOX	= 0,	// Box filter (area average when downscaling)
+			SCALE_BILINEAR	= 1,	// Bilinear (triangle) filter
+			SCALE_LANCZOS	= 2,	// Lanczos-3 filter
+		};
+
+		/**
+		 * Scale the image.
+		 * Standard version using regular C++ code.
+		 *
+		 * This function returns a *new* ARGB32 image and leaves
+		 * the original image unmodified.
+		 *
+		 * @param width New width.
+		 * @param height New height.
+		 * @param filter Scaling filter.
+		 * @return Scaled image, or nullptr on error.
+		 */
+		rp_image *scaled_cpp(int width, int height, ScaleFilter filter = SCALE_LANCZOS) const;
+
+#ifdef RP_IMAGE_HAS_SSE2
+		/**
+		 * Scale the image.
+		 * SSE2-optimized version.
+		 *
+		 * This function returns a *new* ARGB32 image and leaves
+		 * the original image unmodified.
+		 *
+		 * @param width New width.
+		 * @param height New height.
+		 * @param filter Scaling filter.
+		 * @return Scaled image, or nullptr on error.
+		 */
+		rp_image *scaled_sse2(int width, int height, ScaleFilter filter = SCALE_LANCZOS) const;
+#endif /* RP_IMAGE_HAS_SSE2 */
+
+#ifdef RP_IMAGE_HAS_SSSE3
+		/**
+		 * Scale the image.
+		 * SSSE3-optimized version.
+		 *
+		 * This function returns a *new* ARGB32 image and leaves
+		 * the original image unmodified.
+		 *
+		 * @param width New width.
+		 * @param height New height.
+		 * @param filter Scaling filter.
+		 * @return Scaled image, or nullptr on error.
+		 */
+		rp_image *scaled_ssse3(int width, int height, ScaleFilter filter = SCALE_LANCZOS) const;
+#endif /* RP_IMAGE_HAS_SSSE3 */
+
+		/**
+		 * Scale the image.
+		 *
+		 * This function returns a *new* ARGB32 image and leaves
+		 * the original image unmodified.
+		 *
+		 * @param width New width.
+		 * @param height New height.
+		 * @param filter Scaling filter.
+		 * @return Scaled image, or nullptr on error.
+		 */
+		inline rp_image *scaled(int width, int height, ScaleFilter filter = SCALE_LANCZOS) const;
 };
 
 /**
@@ -552,6 +618,42 @@ inline int rp_image::apply_chroma_key(uint32_t key)
 #endif /* RP_IMAGE_ALWAYS_HAS_SSE2 */
 }
 
+/**
+ * Scale the image.
+ *
+ * This function returns a *new* ARGB32 image and leaves
+ * the original image unmodified.
+ *
+ * @param width New width.
+ * @param height New height.
+ * @param filter Scaling filter.
+ * @return Scaled image, or nullptr on error.
+ */
+inline rp_image *rp_image::scaled(int width, int height, ScaleFilter filter) const
+{
+	// FIXME: Figure out how to get IFUNC working with  C++ member functions.
+#ifdef RP_IMAGE_HAS_SSSE3
+	if (RP_CPU_HasSSSE3()) {
+		return scaled_ssse3(width, height, filter);
+	} else
+#endif /* RP_IMAGE_HAS_SSSE3 */
+#if defined(RP_IMAGE_ALWAYS_HAS_SSE2)
+	{
+		// amd64 always has SSE2.
+		return scaled_sse2(width, height, filter);
+	}
+#else /* !RP_IMAGE_ALWAYS_HAS_SSE2 */
+# ifdef RP_IMAGE_HAS_SSE2
+	if (RP_CPU_HasSSE2()) {
+		return scaled_sse2(width, height, filter);
+	} else
+# endif /* RP_IMAGE_HAS_SSE2 */
+	{
+		return scaled_cpp(width, height, filter);
+	}
+#endif /* RP_IMAGE_ALWAYS_HAS_SSE2 */
+}
+
 }
 
 #endif /* __ROMPROPERTIES_LIBRPTEXTURE_RP_IMAGE_HPP__ */
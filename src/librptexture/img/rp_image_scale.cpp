@@ -0,0 +1,361 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_scale.cpp: Image class. (scaling functions)                    *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_p.hpp"
+#include "rp_image_backend.hpp"
+#include "rp_image_scale_p.hpp"
+
+// C includes. (C++ namespace)
+#include <cmath>
+
+namespace LibRpTexture { namespace RpImageScale {
+
+#ifndef M_PI
+# define M_PI 3.14159265358979323846
+#endif
+
+/**
+ * Box filter.
+ * @param x Distance from the center, in source pixels.
+ * @return Weight.
+ */
+static inline double filter_box(double x)
+{
+	return (x > -0.5 && x <= 0.5) ? 1.0 : 0.0;
+}
+
+/**
+ * Triangle filter. (bilinear)
+ * @param x Distance from the center, in source pixels.
+ * @return Weight.
+ */
+static inline double filter_triangle(double x)
+{
+	x = fabs(x);
+	return (x < 1.0) ? (1.0 - x) : 0.0;
+}
+
+/**
+ * Lanczos-3 filter.
+ * @param x Distance from the center, in source pixels.
+ * @return Weight.
+ */
+static inline double filter_lanczos3(double x)
+{
+	if (x == 0.0)
+		return 1.0;
+	if (x <= -3.0 || x >= 3.0)
+		return 0.0;
+	const double pix = M_PI * x;
+	return (3.0 * sin(pix) * sin(pix / 3.0)) / (pix * pix);
+}
+
+/**
+ * Initialize the resampling table.
+ * @param src_len Source length, in pixels.
+ * @param dst_len Destination length, in pixels.
+ * @param filter Scaling filter.
+ */
+void ResampleTable::init(int src_len, int dst_len, rp_image::ScaleFilter filter)
+{
+	assert(src_len > 0);
+	assert(dst_len > 0);
+	this->src_len = src_len;
+	this->dst_len = dst_len;
+
+	double (*pfnFilter)(double);
+	double support;
+	switch (filter) {
+		case rp_image::SCALE_BOX:
+			pfnFilter = filter_box;
+			support = 0.5;
+			break;
+		case rp_image::SCALE_BILINEAR:
+			pfnFilter = filter_triangle;
+			support = 1.0;
+			break;
+		case rp_image::SCALE_LANCZOS:
+		default:
+			pfnFilter = filter_lanczos3;
+			support = 3.0;
+			break;
+	}
+
+	// When downscaling, the filter is stretched to cover
+	// all source pixels that map to a destination pixel.
+	const double scale = static_cast<double>(src_len) / static_cast<double>(dst_len);
+	const double filter_scale = std::max(scale, 1.0);
+	support *= filter_scale;
+
+	// Calculate the floating-point weights.
+	// Source pixels outside of the image are clamped to the edges.
+	const int max_window = static_cast<int>(ceil(support * 2.0)) + 1;
+	ao::uvector<int> lo_tbl(dst_len);
+	ao::uvector<int> count_tbl(dst_len);
+	ao::uvector<double> fweights(static_cast<size_t>(dst_len) * max_window);
+	int max_count = 1;
+	for (int i = 0; i < dst_len; i++) {
+		const double center = (i + 0.5) * scale - 0.5;
+		const int left = static_cast<int>(ceil(center - support));
+		const int right = static_cast<int>(floor(center + support));
+		const int lo = std::max(left, 0);
+		const int hi = std::min(right, src_len - 1);
+		const int count = (hi >= lo ? hi - lo + 1 : 1);
+		assert(count <= max_window);
+
+		double *const fw = &fweights[static_cast<size_t>(i) * max_window];
+		memset(fw, 0, max_window * sizeof(double));
+		double sum = 0.0;
+		for (int k = left; k <= right; k++) {
+			const double w = pfnFilter((k - center) / filter_scale);
+			const int idx = std::max(lo, std::min(k, hi));
+			fw[idx - lo] += w;
+			sum += w;
+		}
+		if (sum == 0.0) {
+			// Shouldn't happen, but use the nearest pixel if it does.
+			fw[0] = 1.0;
+			sum = 1.0;
+		}
+		for (int k = 0; k < count; k++) {
+			fw[k] /= sum;
+		}
+
+		lo_tbl[i] = std::min(lo, src_len - 1);
+		count_tbl[i] = count;
+		if (count > max_count) {
+			max_count = count;
+		}
+	}
+
+	// Use a multiple of 4 taps if possible so the SIMD versions
+	// don't have to handle leftover taps. The window is moved
+	// left at the right edge so it doesn't go past the source.
+	taps = (max_count + 3) & ~3;
+	simd_ok = (taps <= src_len);
+	if (!simd_ok) {
+		taps = max_count;
+	}
+
+	// Convert the weights to fixed-point.
+	static const int one = (1 << RP_IMAGE_SCALE_WEIGHT_BITS);
+	start.resize(dst_len);
+	weights.resize(static_cast<size_t>(dst_len) * taps);
+	memset(weights.data(), 0, weights.size() * sizeof(int16_t));
+	for (int i = 0; i < dst_len; i++) {
+		const int lo = lo_tbl[i];
+		const int first = std::min(lo, src_len - taps);
+		start[i] = first;
+
+		const double *const fw = &fweights[static_cast<size_t>(i) * max_window];
+		int16_t *const iw = &weights[static_cast<size_t>(i) * taps + (lo - first)];
+		int isum = 0, max_k = 0;
+		for (int k = 0; k < count_tbl[i]; k++) {
+			const int w = static_cast<int>(lround(fw[k] * one));
+			iw[k] = static_cast<int16_t>(w);
+			isum += w;
+			if (w > iw[max_k]) {
+				max_k = k;
+			}
+		}
+
+		// Make sure the weights add up to exactly 1.0.
+		iw[max_k] += static_cast<int16_t>(one - isum);
+	}
+}
+
+/**
+ * Clamp a fixed-point channel sum to [0, 255].
+ * @param sum Channel sum.
+ * @return Clamped value.
+ */
+static FORCEINLINE uint32_t clamp_channel(int sum)
+{
+	sum = (sum + (1 << (RP_IMAGE_SCALE_WEIGHT_BITS - 1))) >> RP_IMAGE_SCALE_WEIGHT_BITS;
+	if (sum < 0)
+		return 0;
+	else if (sum > 255)
+		return 255;
+	return static_cast<uint32_t>(sum);
+}
+
+/**
+ * Resample rows of ARGB32 pixels.
+ * Standard version using regular C++ code.
+ * (See ResampleRowsFn for parameters.)
+ */
+void resampleRows_cpp(const ResampleTable &tbl,
+	const uint32_t *RESTRICT src, int src_stride, int rows,
+	uint32_t *RESTRICT dst, int dst_stride)
+{
+	const int taps = tbl.taps;
+	for (int y = 0; y < rows; y++, src += src_stride) {
+		const int16_t *w = tbl.weights.data();
+		uint32_t *d = dst + y;
+		for (int x = 0; x < tbl.dst_len; x++, w += taps, d += dst_stride) {
+			const uint32_t *const s = &src[tbl.start[x]];
+			int b = 0, g = 0, r = 0, a = 0;
+			for (int k = 0; k < taps; k++) {
+				const uint32_t px = s[k];
+				const int wk = w[k];
+				b += static_cast<int>( px        & 0xFF) * wk;
+				g += static_cast<int>((px >>  8) & 0xFF) * wk;
+				r += static_cast<int>((px >> 16) & 0xFF) * wk;
+				a += static_cast<int>( px >> 24        ) * wk;
+			}
+			*d =  clamp_channel(b) |
+			     (clamp_channel(g) <<  8) |
+			     (clamp_channel(r) << 16) |
+			     (clamp_channel(a) << 24);
+		}
+	}
+}
+
+/**
+ * Scale an image using the specified resampling function.
+ * @param img Source image.
+ * @param width New width.
+ * @param height New height.
+ * @param filter Scaling filter.
+ * @param pfnResampleRows Resampling function.
+ * @return Scaled ARGB32 image, or nullptr on error.
+ */
+rp_image *scaled(const rp_image *img, int width, int height,
+	rp_image::ScaleFilter filter, ResampleRowsFn pfnResampleRows)
+{
+	assert(width > 0);
+	assert(height > 0);
+	if (!img->isValid() || width <= 0 || height <= 0) {
+		return nullptr;
+	}
+
+	const int src_width = img->width();
+	const int src_height = img->height();
+	if (width == src_width && height == src_height) {
+		// No scaling is necessary.
+		return img->dup_ARGB32();
+	}
+
+	// Source image must be ARGB32.
+	rp_image *tmp_img = nullptr;
+	const rp_image *src_img = img;
+	if (img->format() != rp_image::Format::ARGB32) {
+		tmp_img = img->dup_ARGB32();
+		if (!tmp_img || !tmp_img->isValid()) {
+			UNREF(tmp_img);
+			return nullptr;
+		}
+		src_img = tmp_img;
+	}
+
+	// Resampling has to be done with premultiplied alpha.
+	// Otherwise, the colors of transparent pixels will bleed
+	// into the visible pixels. Opaque images can be used as-is.
+	bool has_alpha = false;
+	for (int y = 0; y < src_height && !has_alpha; y++) {
+		const uint32_t *px = static_cast<const uint32_t*>(src_img->scanLine(y));
+		for (int x = src_width; x > 0; x--, px++) {
+			if ((*px & 0xFF000000) != 0xFF000000) {
+				has_alpha = true;
+				break;
+			}
+		}
+	}
+	if (has_alpha) {
+		if (!tmp_img) {
+			tmp_img = img->dup();
+			if (!tmp_img || !tmp_img->isValid()) {
+				UNREF(tmp_img);
+				return nullptr;
+			}
+			src_img = tmp_img;
+		}
+		tmp_img->premultiply();
+
+		// premultiply() leaves fully-transparent pixels as-is,
+		// so their colors have to be cleared here.
+		for (int y = 0; y < src_height; y++) {
+			uint32_t *px = static_cast<uint32_t*>(tmp_img->scanLine(y));
+			for (int x = src_width; x > 0; x--, px++) {
+				if ((*px & 0xFF000000) == 0) {
+					*px = 0;
+				}
+			}
+		}
+	}
+
+	rp_image *const out_img = new rp_image(width, height, rp_image::Format::ARGB32);
+	if (!out_img->isValid()) {
+		UNREF(tmp_img);
+		out_img->unref();
+		return nullptr;
+	}
+
+	// Resample the rows, then the columns.
+	// The first pass transposes the image, and the second
+	// pass transposes it back to the original orientation.
+	ResampleTable tbl;
+	ao::uvector<uint32_t> tmp_buf(static_cast<size_t>(width) * src_height);
+	tbl.init(src_width, width, filter);
+	pfnResampleRows(tbl,
+		static_cast<const uint32_t*>(src_img->bits()), src_img->stride() / sizeof(uint32_t), src_height,
+		tmp_buf.data(), src_height);
+	UNREF(tmp_img);
+
+	tbl.init(src_height, height, filter);
+	pfnResampleRows(tbl,
+		tmp_buf.data(), src_height, width,
+		static_cast<uint32_t*>(out_img->bits()), out_img->stride() / sizeof(uint32_t));
+
+	if (has_alpha) {
+		// Filters with negative lobes may result in color
+		// values that are larger than the alpha value.
+		for (int y = 0; y < height; y++) {
+			argb32_t *px = static_cast<argb32_t*>(out_img->scanLine(y));
+			for (int x = width; x > 0; x--, px++) {
+				if (px->r > px->a) px->r = px->a;
+				if (px->g > px->a) px->g = px->a;
+				if (px->b > px->a) px->b = px->a;
+			}
+		}
+		out_img->un_premultiply();
+	}
+
+	// Copy sBIT if it's set.
+	rp_image::sBIT_t sBIT;
+	if (img->get_sBIT(&sBIT) == 0) {
+		out_img->set_sBIT(&sBIT);
+	}
+
+	return out_img;
+}
+
+} }
+
+namespace LibRpTexture {
+
+/**
+ * Scale the image.
+ * Standard version using regular C++ code.
+ *
+ * This function returns a *new* ARGB32 image and leaves
+ * the original image unmodified.
+ *
+ * @param width New width.
+ * @param height New height.
+ * @param filter Scaling filter.
+ * @return Scaled image, or nullptr on error.
+ */
+rp_image *rp_image::scaled_cpp(int width, int height, ScaleFilter filter) const
+{
+	return RpImageScale::scaled(this, width, height, filter, RpImageScale::resampleRows_cpp);
+}
+
+}
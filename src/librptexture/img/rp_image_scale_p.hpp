@@ -0,0 +1,110 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_scale_p.hpp: Image class. (scaling functions) (Private)        *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_SCALE_P_HPP__
+#define __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_SCALE_P_HPP__
+
+#include "rp_image.hpp"
+#include "librpbase/uvector.h"
+
+namespace LibRpTexture { namespace RpImageScale {
+
+// Fixed-point precision of the filter weights.
+#define RP_IMAGE_SCALE_WEIGHT_BITS 14
+
+/**
+ * Resampling table for one dimension.
+ *
+ * Each destination pixel uses 'taps' consecutive source pixels,
+ * starting at start[i]. Unused taps have a weight of 0.
+ */
+struct ResampleTable {
+	int src_len;		// Source length, in pixels.
+	int dst_len;		// Destination length, in pixels.
+	int taps;		// Number of taps per destination pixel.
+
+	// If true, taps is a multiple of 4, so SIMD versions
+	// can process 2 or 4 taps at a time.
+	bool simd_ok;
+
+	ao::uvector<int> start;		// [dst_len] First source pixel.
+	ao::uvector<int16_t> weights;	// [dst_len * taps] Fixed-point weights.
+
+	/**
+	 * Initialize the resampling table.
+	 * @param src_len Source length, in pixels.
+	 * @param dst_len Destination length, in pixels.
+	 * @param filter Scaling filter.
+	 */
+	void init(int src_len, int dst_len, rp_image::ScaleFilter filter);
+};
+
+/**
+ * Resample rows of ARGB32 pixels.
+ *
+ * Each source row is resampled using tbl, and the result
+ * is written to a *column* of the destination buffer.
+ * Calling this twice scales an image in both dimensions.
+ *
+ * @param tbl		[in] Resampling table.
+ * @param src		[in] Source pixels.
+ * @param src_stride	[in] Source stride, in pixels.
+ * @param rows		[in] Number of source rows.
+ * @param dst		[out] Destination pixels.
+ * @param dst_stride	[in] Destination stride, in pixels.
+ */
+typedef void (*ResampleRowsFn)(const ResampleTable &tbl,
+	const uint32_t *RESTRICT src, int src_stride, int rows,
+	uint32_t *RESTRICT dst, int dst_stride);
+
+/**
+ * Resample rows of ARGB32 pixels.
+ * Standard version using regular C++ code.
+ * (See ResampleRowsFn for parameters.)
+ */
+void resampleRows_cpp(const ResampleTable &tbl,
+	const uint32_t *RESTRICT src, int src_stride, int rows,
+	uint32_t *RESTRICT dst, int dst_stride);
+
+#ifdef RP_IMAGE_HAS_SSE2
+/**
+ * Resample rows of ARGB32 pixels.
+ * SSE2-optimized version.
+ * (See ResampleRowsFn for parameters.)
+ */
+void resampleRows_sse2(const ResampleTable &tbl,
+	const uint32_t *RESTRICT src, int src_stride, int rows,
+	uint32_t *RESTRICT dst, int dst_stride);
+#endif /* RP_IMAGE_HAS_SSE2 */
+
+#ifdef RP_IMAGE_HAS_SSSE3
+/**
+ * Resample rows of ARGB32 pixels.
+ * SSSE3-optimized version.
+ * (See ResampleRowsFn for parameters.)
+ */
+void resampleRows_ssse3(const ResampleTable &tbl,
+	const uint32_t *RESTRICT src, int src_stride, int rows,
+	uint32_t *RESTRICT dst, int dst_stride);
+#endif /* RP_IMAGE_HAS_SSSE3 */
+
+/**
+ * Scale an image using the specified resampling function.
+ * @param img Source image.
+ * @param width New width.
+ * @param height New height.
+ * @param filter Scaling filter.
+ * @param pfnResampleRows Resampling function.
+ * @return Scaled ARGB32 image, or nullptr on error.
+ */
+rp_image *scaled(const rp_image *img, int width, int height,
+	rp_image::ScaleFilter filter, ResampleRowsFn pfnResampleRows);
+
+} }
+
+#endif /* __ROMPROPERTIES_LIBRPTEXTURE_IMG_RP_IMAGE_SCALE_P_HPP__ */
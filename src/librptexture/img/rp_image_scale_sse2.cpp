@@ -0,0 +1,89 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_scale.cpp: Image class. (scaling functions)                    *
+ * SSE2-optimized version.                                                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_scale_p.hpp"
+
+// SSE2 intrinsics.
+#include <emmintrin.h>
+
+namespace LibRpTexture { namespace RpImageScale {
+
+/**
+ * Resample rows of ARGB32 pixels.
+ * SSE2-optimized version.
+ * (See ResampleRowsFn for parameters.)
+ */
+void resampleRows_sse2(const ResampleTable &tbl,
+	const uint32_t *RESTRICT src, int src_stride, int rows,
+	uint32_t *RESTRICT dst, int dst_stride)
+{
+	if (!tbl.simd_ok) {
+		// Tap count isn't a multiple of 4.
+		// This only happens with very small source images.
+		resampleRows_cpp(tbl, src, src_stride, rows, dst, dst_stride);
+		return;
+	}
+
+	const int taps = tbl.taps;
+	const __m128i xmm_zero = _mm_setzero_si128();
+	const __m128i xmm_round = _mm_set1_epi32(1 << (RP_IMAGE_SCALE_WEIGHT_BITS - 1));
+	for (int y = 0; y < rows; y++, src += src_stride) {
+		const int16_t *w = tbl.weights.data();
+		uint32_t *d = dst + y;
+		for (int x = 0; x < tbl.dst_len; x++, w += taps, d += dst_stride) {
+			const uint32_t *const s = &src[tbl.start[x]];
+			__m128i xmm_acc = xmm_round;
+
+			// Process two taps at a time.
+			for (int k = 0; k < taps; k += 2) {
+				// Expand to 16-bit: [b0 g0 r0 a0 b1 g1 r1 a1]
+				__m128i px = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&s[k]));
+				px = _mm_unpacklo_epi8(px, xmm_zero);
+				// Interleave the two pixels: [b0 b1 g0 g1 r0 r1 a0 a1]
+				px = _mm_unpacklo_epi16(px, _mm_srli_si128(px, 8));
+
+				// Multiply by [w0 w1] and add the pairs.
+				int32_t w01;
+				memcpy(&w01, &w[k], sizeof(w01));
+				xmm_acc = _mm_add_epi32(xmm_acc, _mm_madd_epi16(px, _mm_set1_epi32(w01)));
+			}
+
+			// Convert back to 8-bit with saturation.
+			xmm_acc = _mm_srai_epi32(xmm_acc, RP_IMAGE_SCALE_WEIGHT_BITS);
+			xmm_acc = _mm_packs_epi32(xmm_acc, xmm_acc);
+			xmm_acc = _mm_packus_epi16(xmm_acc, xmm_acc);
+			*d = static_cast<uint32_t>(_mm_cvtsi128_si32(xmm_acc));
+		}
+	}
+}
+
+} }
+
+namespace LibRpTexture {
+
+/**
+ * Scale the image.
+ * SSE2-optimized version.
+ *
+ * This function returns a *new* ARGB32 image and leaves
+ * the original image unmodified.
+ *
+ * @param width New width.
+ * @param height New height.
+ * @param filter Scaling filter.
+ * @return Scaled image, or nullptr on error.
+ */
+rp_image *rp_image::scaled_sse2(int width, int height, ScaleFilter filter) const
+{
+	return RpImageScale::scaled(this, width, height, filter, RpImageScale::resampleRows_sse2);
+}
+
+}
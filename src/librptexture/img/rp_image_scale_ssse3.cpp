@@ -0,0 +1,97 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture)                     *
+ * rp_image_scale.cpp: Image class. (scaling functions)                    *
+ * SSSE3-optimized version.                                                *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "rp_image.hpp"
+#include "rp_image_scale_p.hpp"
+
+// SSSE3 intrinsics.
+#include <tmmintrin.h>
+
+namespace LibRpTexture { namespace RpImageScale {
+
+/**
+ * Resample rows of ARGB32 pixels.
+ * SSSE3-optimized version.
+ * (See ResampleRowsFn for parameters.)
+ */
+void resampleRows_ssse3(const ResampleTable &tbl,
+	const uint32_t *RESTRICT src, int src_stride, int rows,
+	uint32_t *RESTRICT dst, int dst_stride)
+{
+	if (!tbl.simd_ok) {
+		// Tap count isn't a multiple of 4.
+		// This only happens with very small source images.
+		resampleRows_cpp(tbl, src, src_stride, rows, dst, dst_stride);
+		return;
+	}
+
+	// Shuffle masks to expand four pixels to 16-bit, with
+	// each channel's pixels interleaved for pmaddwd:
+	// - lo: [b0 b1 g0 g1 r0 r1 a0 a1]
+	// - hi: [b2 b3 g2 g3 r2 r3 a2 a3]
+	const __m128i shuf_lo = _mm_setr_epi8(
+		0, -128, 4, -128, 1, -128, 5, -128,
+		2, -128, 6, -128, 3, -128, 7, -128);
+	const __m128i shuf_hi = _mm_setr_epi8(
+		 8, -128, 12, -128,  9, -128, 13, -128,
+		10, -128, 14, -128, 11, -128, 15, -128);
+	const __m128i xmm_round = _mm_set1_epi32(1 << (RP_IMAGE_SCALE_WEIGHT_BITS - 1));
+
+	const int taps = tbl.taps;
+	for (int y = 0; y < rows; y++, src += src_stride) {
+		const int16_t *w = tbl.weights.data();
+		uint32_t *d = dst + y;
+		for (int x = 0; x < tbl.dst_len; x++, w += taps, d += dst_stride) {
+			const uint32_t *const s = &src[tbl.start[x]];
+			__m128i xmm_acc = xmm_round;
+
+			// Process four taps at a time.
+			for (int k = 0; k < taps; k += 4) {
+				const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&s[k]));
+				int32_t w01, w23;
+				memcpy(&w01, &w[k], sizeof(w01));
+				memcpy(&w23, &w[k+2], sizeof(w23));
+				xmm_acc = _mm_add_epi32(xmm_acc,
+					_mm_madd_epi16(_mm_shuffle_epi8(px, shuf_lo), _mm_set1_epi32(w01)));
+				xmm_acc = _mm_add_epi32(xmm_acc,
+					_mm_madd_epi16(_mm_shuffle_epi8(px, shuf_hi), _mm_set1_epi32(w23)));
+			}
+
+			// Convert back to 8-bit with saturation.
+			xmm_acc = _mm_srai_epi32(xmm_acc, RP_IMAGE_SCALE_WEIGHT_BITS);
+			xmm_acc = _mm_packs_epi32(xmm_acc, xmm_acc);
+			xmm_acc = _mm_packus_epi16(xmm_acc, xmm_acc);
+			*d = static_cast<uint32_t>(_mm_cvtsi128_si32(xmm_acc));
+		}
+	}
+}
+
+} }
+
+namespace LibRpTexture {
+
+/**
+ * Scale the image.
+ * SSSE3-optimized version.
+ *
+ * This function returns a *new* ARGB32 image and leaves
+ * the original image unmodified.
+ *
+ * @param width New width.
+ * @param height New height.
+ * @param filter Scaling filter.
+ * @return Scaled image, or nullptr on error.
+ */
+rp_image *rp_image::scaled_ssse3(int width, int height, ScaleFilter filter) const
+{
+	return RpImageScale::scaled(this, width, height, filter, RpImageScale::resampleRows_ssse3);
+}
+
+}
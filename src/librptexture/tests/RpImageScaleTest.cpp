@@ -0,0 +1,257 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librptexture/tests)               *
+ * RpImageScaleTest.cpp: Test rp_image::scaled().                          *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+// Google Test
+#include "gtest/gtest.h"
+#include "tcharx.h"
+#include "common.h"
+
+// librptexture
+#include "librptexture/img/rp_image.hpp"
+
+// C includes.
+#include <stdint.h>
+#include <stdlib.h>
+
+// C includes. (C++ namespace)
+#include <cstring>
+
+namespace LibRpTexture { namespace Tests {
+
+class RpImageScaleTest : public ::testing::TestWithParam<rp_image::ScaleFilter>
+{
+	protected:
+		RpImageScaleTest()
+			: m_img(new rp_image(512, 384, rp_image::Format::ARGB32))
+		{
+			// Initialize the image with a pattern that has
+			// both sharp edges and partial transparency.
+			for (int y = 0; y < m_img->height(); y++) {
+				uint32_t *px = static_cast<uint32_t*>(m_img->scanLine(y));
+				for (int x = 0; x < m_img->width(); x++) {
+					const uint32_t alpha = ((x / 32) & 1) ? 0xFF : static_cast<uint32_t>(y & 0xFF);
+					px[x] = (alpha << 24) |
+						(static_cast<uint32_t>(x * 7) & 0xFF) << 16 |
+						(static_cast<uint32_t>(y * 3) & 0xFF) << 8 |
+						(((x ^ y) & 8) ? 0xFF : 0x00);
+				}
+			}
+		}
+
+		~RpImageScaleTest()
+		{
+			m_img->unref();
+		}
+
+	public:
+		// Number of iterations for benchmarks.
+		static const unsigned int BENCHMARK_ITERATIONS = 100;
+
+		// Image.
+		rp_image *m_img;
+
+		/**
+		 * Compare two ARGB32 images.
+		 * @param expected Expected image.
+		 * @param actual Actual image.
+		 */
+		static void compareImages(const rp_image *expected, const rp_image *actual)
+		{
+			ASSERT_TRUE(expected != nullptr);
+			ASSERT_TRUE(actual != nullptr);
+			ASSERT_EQ(expected->width(), actual->width());
+			ASSERT_EQ(expected->height(), actual->height());
+			ASSERT_EQ(rp_image::Format::ARGB32, actual->format());
+			const size_t row_bytes = expected->width() * sizeof(uint32_t);
+			for (int y = 0; y < expected->height(); y++) {
+				ASSERT_EQ(0, memcmp(expected->scanLine(y), actual->scanLine(y), row_bytes))
+					<< "Row " << y << " does not match.";
+			}
+		}
+};
+
+/**
+ * A solid-color image should remain solid after scaling.
+ */
+TEST_P(RpImageScaleTest, solidColor)
+{
+	const rp_image::ScaleFilter filter = GetParam();
+	rp_image *const img = new rp_image(100, 60, rp_image::Format::ARGB32);
+	for (int y = 0; y < img->height(); y++) {
+		uint32_t *px = static_cast<uint32_t*>(img->scanLine(y));
+		for (int x = 0; x < img->width(); x++) {
+			px[x] = 0xFF204080;
+		}
+	}
+
+	static const int sizes[][2] = {{37, 23}, {100, 60}, {160, 90}, {1, 1}, {3, 200}};
+	for (const auto &sz : sizes) {
+		rp_image *const scaled = img->scaled(sz[0], sz[1], filter);
+		ASSERT_TRUE(scaled != nullptr);
+		ASSERT_EQ(sz[0], scaled->width());
+		ASSERT_EQ(sz[1], scaled->height());
+		for (int y = 0; y < scaled->height(); y++) {
+			const uint32_t *px = static_cast<const uint32_t*>(scaled->scanLine(y));
+			for (int x = 0; x < scaled->width(); x++) {
+				ASSERT_EQ(0xFF204080U, px[x]) << "(" << x << "," << y << ")";
+			}
+		}
+		scaled->unref();
+	}
+
+	img->unref();
+}
+
+/**
+ * Fully-transparent pixels should not affect the color of opaque pixels.
+ */
+TEST_P(RpImageScaleTest, transparentBorder)
+{
+	const rp_image::ScaleFilter filter = GetParam();
+	rp_image *const img = new rp_image(64, 64, rp_image::Format::ARGB32);
+	for (int y = 0; y < img->height(); y++) {
+		uint32_t *px = static_cast<uint32_t*>(img->scanLine(y));
+		for (int x = 0; x < img->width(); x++) {
+			// Left half is transparent white; right half is opaque red.
+			px[x] = (x < 32) ? 0x00FFFFFF : 0xFFFF0000;
+		}
+	}
+
+	rp_image *const scaled = img->scaled(16, 16, filter);
+	ASSERT_TRUE(scaled != nullptr);
+	for (int y = 0; y < scaled->height(); y++) {
+		const argb32_t *px = static_cast<const argb32_t*>(scaled->scanLine(y));
+		for (int x = 0; x < scaled->width(); x++) {
+			if (px[x].a == 0)
+				continue;
+			EXPECT_EQ(0xFF, px[x].r) << "(" << x << "," << y << ")";
+			EXPECT_EQ(0x00, px[x].g) << "(" << x << "," << y << ")";
+			EXPECT_EQ(0x00, px[x].b) << "(" << x << "," << y << ")";
+		}
+	}
+
+	scaled->unref();
+	img->unref();
+}
+
+#ifdef RP_IMAGE_HAS_SSE2
+/**
+ * The SSE2-optimized version must match the standard version.
+ */
+TEST_P(RpImageScaleTest, scaled_sse2_matches_cpp)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	const rp_image::ScaleFilter filter = GetParam();
+	static const int sizes[][2] = {{256, 192}, {97, 13}, {3, 2}, {600, 400}};
+	for (const auto &sz : sizes) {
+		rp_image *const expected = m_img->scaled_cpp(sz[0], sz[1], filter);
+		rp_image *const actual = m_img->scaled_sse2(sz[0], sz[1], filter);
+		compareImages(expected, actual);
+		UNREF(expected);
+		UNREF(actual);
+	}
+}
+#endif /* RP_IMAGE_HAS_SSE2 */
+
+#ifdef RP_IMAGE_HAS_SSSE3
+/**
+ * The SSSE3-optimized version must match the standard version.
+ */
+TEST_P(RpImageScaleTest, scaled_ssse3_matches_cpp)
+{
+	if (!RP_CPU_HasSSSE3()) {
+		fprintf(stderr, "*** SSSE3 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	const rp_image::ScaleFilter filter = GetParam();
+	static const int sizes[][2] = {{256, 192}, {97, 13}, {3, 2}, {600, 400}};
+	for (const auto &sz : sizes) {
+		rp_image *const expected = m_img->scaled_cpp(sz[0], sz[1], filter);
+		rp_image *const actual = m_img->scaled_ssse3(sz[0], sz[1], filter);
+		compareImages(expected, actual);
+		UNREF(expected);
+		UNREF(actual);
+	}
+}
+#endif /* RP_IMAGE_HAS_SSSE3 */
+
+/**
+ * Benchmark the rp_image::scaled() function. (Standard version)
+ */
+TEST_P(RpImageScaleTest, scaled_cpp_benchmark)
+{
+	const rp_image::ScaleFilter filter = GetParam();
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->scaled_cpp(128, 96, filter)->unref();
+	}
+}
+
+#ifdef RP_IMAGE_HAS_SSE2
+/**
+ * Benchmark the rp_image::scaled() function. (SSE2-optimized version)
+ */
+TEST_P(RpImageScaleTest, scaled_sse2_benchmark)
+{
+	if (!RP_CPU_HasSSE2()) {
+		fprintf(stderr, "*** SSE2 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	const rp_image::ScaleFilter filter = GetParam();
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->scaled_sse2(128, 96, filter)->unref();
+	}
+}
+#endif /* RP_IMAGE_HAS_SSE2 */
+
+#ifdef RP_IMAGE_HAS_SSSE3
+/**
+ * Benchmark the rp_image::scaled() function. (SSSE3-optimized version)
+ */
+TEST_P(RpImageScaleTest, scaled_ssse3_benchmark)
+{
+	if (!RP_CPU_HasSSSE3()) {
+		fprintf(stderr, "*** SSSE3 is not supported on this CPU. Skipping test.\n");
+		return;
+	}
+
+	const rp_image::ScaleFilter filter = GetParam();
+	for (unsigned int i = BENCHMARK_ITERATIONS; i > 0; i--) {
+		m_img->scaled_ssse3(128, 96, filter)->unref();
+	}
+}
+#endif /* RP_IMAGE_HAS_SSSE3 */
+
+INSTANTIATE_TEST_SUITE_P(RpImageScaleTest, RpImageScaleTest,
+	::testing::Values(
+		rp_image::SCALE_BOX,
+		rp_image::SCALE_BILINEAR,
+		rp_image::SCALE_LANCZOS));
+
+} }
+
+/**
+ * Test suite main function.
+ * Called by gtest_init.cpp.
+ */
+extern "C" int gtest_main(int argc, TCHAR *argv[])
+{
+	fprintf(stderr, "LibRpTexture test suite: rp_image::scaled() tests.\n\n");
+	fprintf(stderr, "Benchmark iterations: %u\n",
+		LibRpTexture::Tests::RpImageScaleTest::BENCHMARK_ITERATIONS);
+	fflush(nullptr);
+
+	// coverity[fun_call_w_exception]: uncaught exceptions cause nonzero exit anyway, so don't warn.
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -34,6 +34,7 @@
    /* NOTE: C11 version of cmpxchg requires pointers, so we'll use the Itanium-style version. */
 #  define ATOMIC_CMPXCHG(ptr, cmp, xchg)	__sync_val_compare_and_swap(ptr, cmp, xchg);
 #  define ATOMIC_EXCHANGE(ptr, val)		__c11_atomic_exchange(ptr, val);
+#  define ATOMIC_LOAD(ptr)			__c11_atomic_load(ptr, __ATOMIC_SEQ_CST)
 # else
    /* Use Itanium-style atomics. */
 #  define ATOMIC_INC_FETCH(ptr)			__sync_add_and_fetch(ptr, 1)
@@ -41,6 +42,7 @@
 #  define ATOMIC_OR_FETCH(ptr, val)		__sync_or_and_fetch(ptr, val)
 #  define ATOMIC_CMPXCHG(ptr, cmp, xchg)	__sync_val_compare_and_swap(ptr, cmp, xchg);
 #  define ATOMIC_EXCHANGE(ptr, val)		__sync_lock_test_and_set(ptr, val);
+#  define ATOMIC_LOAD(ptr)			__sync_add_and_fetch(ptr, 0)
 # endif
 #elif defined(__GNUC__)
 # if (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
@@ -51,6 +53,7 @@
    /* NOTE: C11 version of cmpxchg requires pointers, so we'll use the Itanium-style version. */
 #  define ATOMIC_CMPXCHG(ptr, cmp, xchg)	__sync_val_compare_and_swap(ptr, cmp, xchg)
 #  define ATOMIC_EXCHANGE(ptr, val)		__sync_lock_test_and_set(ptr, val)
+#  define ATOMIC_LOAD(ptr)			__atomic_load_n(ptr, __ATOMIC_SEQ_CST)
 # else
    /* gcc-4.6 and earlier: Use Itanium-style atomics. */
 #  define ATOMIC_INC_FETCH(ptr)			__sync_add_and_fetch(ptr, 1)
@@ -58,6 +61,7 @@
 #  define ATOMIC_OR_FETCH(ptr, val)		__sync_or_and_fetch(ptr, val)
 #  define ATOMIC_CMPXCHG(ptr, cmp, xchg)	__sync_val_compare_and_swap(ptr, cmp, xchg)
 #  define ATOMIC_EXCHANGE(ptr, val)		__sync_lock_test_and_set(ptr, val)
+#  define ATOMIC_LOAD(ptr)			__sync_add_and_fetch(ptr, 0)
 # endif
 #elif defined(_MSC_VER)
 # include <intrin.h>
@@ -81,6 +85,10 @@ static __inline int ATOMIC_EXCHANGE(volatile int *ptr, int val)
 {
 	return _InterlockedExchange(REINTERPRET_CAST(volatile long*)(ptr), val);
 }
+static __inline int ATOMIC_LOAD(volatile int *ptr)
+{
+	return _InterlockedOr(REINTERPRET_CAST(volatile long*)(ptr), 0);
+}
 #else
 # error Atomic functions not defined for this compiler.
 #endif
@@ -0,0 +1,766 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * ThreadPool.cpp: Work-stealing thread pool.                              *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "config.librpthreads.h"
+#include "ThreadPool.hpp"
+
+#include "Atomics.h"
+#include "Mutex.hpp"
+#include "pthread_once.h"
+
+#ifdef HAVE_PTHREADS
+#  include <signal.h>	// pthread_sigmask()
+#  include <unistd.h>	// sysconf()
+#endif /* HAVE_PTHREADS */
+
+// C includes.
+#include <stdint.h>
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cstdlib>
+
+// C++ includes.
+#include <deque>
+
+namespace LibRpThreads {
+
+// Maximum number of worker threads.
+static const unsigned int THREADPOOL_MAX_THREADS = 15;
+
+// Worker thread stack size.
+// Some C libraries, e.g. musl, have a very small default stack size.
+static const size_t THREADPOOL_STACK_SIZE = 2U * 1024U * 1024U;
+
+/**
+ * Queued task.
+ */
+struct Task {
+	TaskGroup *group;
+	TaskGroup::TaskFn fn;
+	void *param;
+};
+
+/**
+ * Task queue.
+ * Each worker thread has its own queue. The owner pushes and pops
+ * at the back; other threads steal from the front.
+ */
+struct TaskQueue {
+	Mutex mutex;
+	std::deque<Task> tasks;
+};
+
+class ThreadPoolPrivate
+{
+	public:
+		explicit ThreadPoolPrivate(unsigned int threadCount);
+		~ThreadPoolPrivate();
+
+	private:
+#if __cplusplus >= 201103L
+		ThreadPoolPrivate(const ThreadPoolPrivate &) = delete; \
+		ThreadPoolPrivate &operator=(const ThreadPoolPrivate &) = delete;
+#else /* __cplusplus < 201103L */
+		ThreadPoolPrivate(const ThreadPoolPrivate &); \
+		ThreadPoolPrivate &operator=(const ThreadPoolPrivate &);
+#endif /* __cplusplus */
+
+	public:
+		// Task queues.
+		// - [0, THREADPOOL_MAX_THREADS): Worker threads
+		// - THREADPOOL_MAX_THREADS: Tasks submitted by other threads
+		TaskQueue queues[THREADPOOL_MAX_THREADS + 1];
+
+#ifdef HAVE_PTHREADS
+		// Worker threads.
+		struct Worker {
+			ThreadPoolPrivate *d;
+			unsigned int index;
+			pthread_t thread;
+			bool started;		// pthread_create() succeeded; must be joined.
+			volatile int running;	// Non-zero if the thread is running.
+		};
+		Worker workers[THREADPOOL_MAX_THREADS];
+		Mutex mtxWorkers;	// Locked while starting worker threads.
+#endif /* HAVE_PTHREADS */
+
+		// Maximum number of worker threads for this pool.
+		const unsigned int maxWorkers;
+
+		// Idle worker threads wait on this semaphore.
+		Semaphore semWake;
+		volatile int sleepers;	// Number of threads waiting on semWake.
+		volatile int quit;	// Non-zero if the worker threads should exit.
+
+		/**
+		 * Get the number of worker threads that should be running.
+		 * @return Number of worker threads.
+		 */
+		unsigned int wantedWorkers(void) const;
+
+		/**
+		 * Start worker threads if necessary.
+		 * @return Number of worker threads available.
+		 */
+		unsigned int startWorkers(void);
+
+		/**
+		 * Submit a task.
+		 * @param task Task
+		 */
+		void push(const Task &task);
+
+		/**
+		 * Get a task to run.
+		 * Checks the current thread's queue first, then the
+		 * shared queue, then steals from the other workers.
+		 * @param task	[out] Task
+		 * @return True if a task was found; false if not.
+		 */
+		bool pop(Task &task);
+
+		/**
+		 * Wake up one idle worker thread, if any are waiting.
+		 */
+		void wakeOne(void);
+
+		/**
+		 * Run a task and mark it as completed.
+		 * @param task Task
+		 */
+		static void runTask(const Task &task);
+
+#ifdef HAVE_PTHREADS
+		/**
+		 * Worker thread function.
+		 * @param arg Worker*
+		 * @return nullptr
+		 */
+		static void *workerThread(void *arg);
+
+		// Worker index of the current thread, plus one. (0 if not a worker)
+		static pthread_key_t key_workerIdx;
+#endif /* HAVE_PTHREADS */
+
+		/**
+		 * Get the worker index of the current thread.
+		 * @return Worker index, or -1 if not a worker thread.
+		 */
+		static int currentWorker(void);
+
+	public:
+		// Shared thread pool.
+		static ThreadPool *instance;
+		static pthread_once_t once_instance;
+
+		// Maximum number of threads, including the calling thread. (0 == default)
+		// - envMaxThreads: RP_MAX_THREADS environment variable
+		// - cfgMaxThreads: setMaxThreads()
+		static unsigned int envMaxThreads;
+		static volatile int cfgMaxThreads;
+
+		// Non-zero if this is a child process created by fork().
+		// The worker threads don't exist in the child process,
+		// so all tasks are run on the calling thread.
+		static volatile int forked;
+
+		/**
+		 * Create the shared thread pool.
+		 * Called by pthread_once().
+		 */
+		static void initInstance(void);
+
+#ifdef HAVE_PTHREADS
+		/**
+		 * fork() handler for the child process.
+		 */
+		static void atforkChild(void);
+#endif /* HAVE_PTHREADS */
+
+		/**
+		 * Shared thread pool deleter.
+		 * Stops the worker threads on exit.
+		 */
+		struct InstanceDeleter {
+			~InstanceDeleter()
+			{
+				delete ThreadPoolPrivate::instance;
+				ThreadPoolPrivate::instance = nullptr;
+			}
+		};
+		static InstanceDeleter instanceDeleter;
+};
+
+ThreadPool *ThreadPoolPrivate::instance = nullptr;
+pthread_once_t ThreadPoolPrivate::once_instance = PTHREAD_ONCE_INIT;
+unsigned int ThreadPoolPrivate::envMaxThreads = 0;
+volatile int ThreadPoolPrivate::cfgMaxThreads = 0;
+volatile int ThreadPoolPrivate::forked = 0;
+#ifdef HAVE_PTHREADS
+pthread_key_t ThreadPoolPrivate::key_workerIdx;
+#endif /* HAVE_PTHREADS */
+ThreadPoolPrivate::InstanceDeleter ThreadPoolPrivate::instanceDeleter;
+
+ThreadPoolPrivate::ThreadPoolPrivate(unsigned int threadCount)
+	: maxWorkers(threadCount <= THREADPOOL_MAX_THREADS ? threadCount : THREADPOOL_MAX_THREADS)
+	, semWake(0)
+	, sleepers(0)
+	, quit(0)
+{
+#ifdef HAVE_PTHREADS
+	for (unsigned int i = 0; i < THREADPOOL_MAX_THREADS; i++) {
+		workers[i].d = this;
+		workers[i].index = i;
+		workers[i].started = false;
+		workers[i].running = 0;
+	}
+#else /* !HAVE_PTHREADS */
+	// TODO: Win32 worker threads. The shell extension DLL can be
+	// unloaded at any time, and worker threads can't be joined
+	// while the loader lock is held, so tasks are run on the
+	// calling thread for now.
+#endif /* HAVE_PTHREADS */
+}
+
+ThreadPoolPrivate::~ThreadPoolPrivate()
+{
+#ifdef HAVE_PTHREADS
+	if (forked) {
+		// The worker threads don't exist in this process.
+		return;
+	}
+
+	// Stop the worker threads.
+	ATOMIC_EXCHANGE(&quit, 1);
+	for (unsigned int i = 0; i < THREADPOOL_MAX_THREADS; i++) {
+		semWake.release();
+	}
+	for (unsigned int i = 0; i < THREADPOOL_MAX_THREADS; i++) {
+		if (workers[i].started) {
+			pthread_join(workers[i].thread, nullptr);
+		}
+	}
+#endif /* HAVE_PTHREADS */
+}
+
+/**
+ * Get the number of worker threads that should be running.
+ * @return Number of worker threads.
+ */
+unsigned int ThreadPoolPrivate::wantedWorkers(void) const
+{
+	if (ATOMIC_LOAD(&forked))
+		return 0;
+
+	// The calling thread also runs tasks, so use
+	// one less worker thread than the thread limit.
+	unsigned int maxThreads = envMaxThreads;
+	if (maxThreads == 0) {
+		maxThreads = static_cast<unsigned int>(ATOMIC_LOAD(&cfgMaxThreads));
+	}
+	if (maxThreads == 0 || maxThreads - 1 > maxWorkers) {
+		return maxWorkers;
+	}
+	return maxThreads - 1;
+}
+
+/**
+ * Start worker threads if necessary.
+ * @return Number of worker threads available.
+ */
+unsigned int ThreadPoolPrivate::startWorkers(void)
+{
+	const unsigned int wanted = wantedWorkers();
+#ifdef HAVE_PTHREADS
+	if (wanted == 0 || ATOMIC_LOAD(&workers[wanted - 1].running)) {
+		// Worker threads are already running.
+		return wanted;
+	}
+
+	MutexLocker locker(mtxWorkers);
+
+	// Block all signals in the worker threads.
+	// Signals should be handled by the host process's own threads.
+	sigset_t newmask, oldmask;
+	sigfillset(&newmask);
+	pthread_sigmask(SIG_SETMASK, &newmask, &oldmask);
+
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	pthread_attr_setstacksize(&attr, THREADPOOL_STACK_SIZE);
+
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < wanted; i++) {
+		Worker &worker = workers[i];
+		if (ATOMIC_LOAD(&worker.running)) {
+			count++;
+			continue;
+		}
+
+		if (worker.started) {
+			// Thread exited due to a lower thread limit.
+			pthread_join(worker.thread, nullptr);
+			worker.started = false;
+		}
+
+		ATOMIC_EXCHANGE(&worker.running, 1);
+		if (pthread_create(&worker.thread, &attr, workerThread, &worker) != 0) {
+			// Unable to create the thread.
+			// Use the threads that were created.
+			ATOMIC_EXCHANGE(&worker.running, 0);
+			break;
+		}
+		worker.started = true;
+		count++;
+	}
+
+	pthread_attr_destroy(&attr);
+	pthread_sigmask(SIG_SETMASK, &oldmask, nullptr);
+	return count;
+#else /* !HAVE_PTHREADS */
+	return wanted;
+#endif /* HAVE_PTHREADS */
+}
+
+/**
+ * Get the worker index of the current thread.
+ * @return Worker index, or -1 if not a worker thread.
+ */
+int ThreadPoolPrivate::currentWorker(void)
+{
+#ifdef HAVE_PTHREADS
+	// NOTE: The key is created in initInstance().
+	return static_cast<int>(reinterpret_cast<intptr_t>(pthread_getspecific(key_workerIdx))) - 1;
+#else /* !HAVE_PTHREADS */
+	return -1;
+#endif /* HAVE_PTHREADS */
+}
+
+/**
+ * Wake up one idle worker thread, if any are waiting.
+ */
+void ThreadPoolPrivate::wakeOne(void)
+{
+	int cur = ATOMIC_LOAD(&sleepers);
+	while (cur > 0) {
+		const int prev = ATOMIC_CMPXCHG(&sleepers, cur, cur - 1);
+		if (prev == cur) {
+			semWake.release();
+			break;
+		}
+		cur = prev;
+	}
+}
+
+/**
+ * Submit a task.
+ * @param task Task
+ */
+void ThreadPoolPrivate::push(const Task &task)
+{
+	const int idx = currentWorker();
+	TaskQueue &queue = queues[idx >= 0 ? idx : THREADPOOL_MAX_THREADS];
+	{
+		MutexLocker locker(queue.mutex);
+		queue.tasks.push_back(task);
+	}
+	wakeOne();
+}
+
+/**
+ * Get a task to run.
+ * Checks the current thread's queue first, then the
+ * shared queue, then steals from the other workers.
+ * @param task	[out] Task
+ * @return True if a task was found; false if not.
+ */
+bool ThreadPoolPrivate::pop(Task &task)
+{
+	const int idx = currentWorker();
+	if (idx >= 0) {
+		// Own queue: Newest task first.
+		TaskQueue &queue = queues[idx];
+		MutexLocker locker(queue.mutex);
+		if (!queue.tasks.empty()) {
+			task = queue.tasks.back();
+			queue.tasks.pop_back();
+			return true;
+		}
+	}
+
+	// Shared queue, then other workers' queues: Oldest task first.
+	// Start with the shared queue, then the worker after this one.
+	const unsigned int start = (idx >= 0 ? static_cast<unsigned int>(idx) + 1 : 0);
+	for (unsigned int i = 0; i <= THREADPOOL_MAX_THREADS; i++) {
+		const unsigned int q = (i == 0 ? THREADPOOL_MAX_THREADS
+			: (start + i - 1) % THREADPOOL_MAX_THREADS);
+		if (static_cast<int>(q) == idx)
+			continue;
+
+		TaskQueue &queue = queues[q];
+		MutexLocker locker(queue.mutex);
+		if (!queue.tasks.empty()) {
+			task = queue.tasks.front();
+			queue.tasks.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Run a task and mark it as completed.
+ * @param task Task
+ */
+void ThreadPoolPrivate::runTask(const Task &task)
+{
+	if (!task.group->isCancelled()) {
+		task.fn(task.param);
+	}
+	task.group->taskDone();
+}
+
+#ifdef HAVE_PTHREADS
+/**
+ * Worker thread function.
+ * @param arg Worker*
+ * @return nullptr
+ */
+void *ThreadPoolPrivate::workerThread(void *arg)
+{
+	Worker *const worker = static_cast<Worker*>(arg);
+	ThreadPoolPrivate *const d = worker->d;
+	pthread_setspecific(key_workerIdx, reinterpret_cast<void*>(static_cast<intptr_t>(worker->index + 1)));
+
+	Task task;
+	for (;;) {
+		if (ATOMIC_LOAD(&d->quit))
+			break;
+		if (worker->index >= d->wantedWorkers()) {
+			// Thread limit was lowered.
+			// Pass the wakeup on to another thread.
+			d->wakeOne();
+			break;
+		}
+
+		if (d->pop(task)) {
+			runTask(task);
+			continue;
+		}
+
+		// No tasks. Go to sleep.
+		// NOTE: Check the queues again after incrementing sleepers.
+		// If a task was pushed in between, either we'll see it here,
+		// or the pushing thread will see sleepers > 0 and wake us up.
+		ATOMIC_INC_FETCH(&d->sleepers);
+		if (d->pop(task)) {
+			// NOTE: If another thread already decremented sleepers,
+			// the extra wakeup is harmless.
+			int cur = ATOMIC_LOAD(&d->sleepers);
+			while (cur > 0) {
+				const int prev = ATOMIC_CMPXCHG(&d->sleepers, cur, cur - 1);
+				if (prev == cur)
+					break;
+				cur = prev;
+			}
+			runTask(task);
+			continue;
+		}
+		d->semWake.obtain();
+	}
+
+	ATOMIC_EXCHANGE(&worker->running, 0);
+	return nullptr;
+}
+
+/**
+ * fork() handler for the child process.
+ */
+void ThreadPoolPrivate::atforkChild(void)
+{
+	// Only the thread that called fork() exists in the child.
+	ATOMIC_EXCHANGE(&forked, 1);
+}
+#endif /* HAVE_PTHREADS */
+
+/**
+ * Create the shared thread pool.
+ * Called by pthread_once().
+ */
+void ThreadPoolPrivate::initInstance(void)
+{
+	unsigned int threadCount = 0;
+#ifdef HAVE_PTHREADS
+	pthread_key_create(&key_workerIdx, nullptr);
+	pthread_atfork(nullptr, nullptr, atforkChild);
+
+	const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if (cpus > 1) {
+		threadCount = static_cast<unsigned int>(cpus - 1);
+	}
+#endif /* HAVE_PTHREADS */
+	if (threadCount > THREADPOOL_MAX_THREADS) {
+		threadCount = THREADPOOL_MAX_THREADS;
+	}
+
+	// Check for a thread limit override.
+	const char *const s_maxThreads = getenv("RP_MAX_THREADS");
+	if (s_maxThreads && s_maxThreads[0] != '\0') {
+		char *endptr = nullptr;
+		const long val = strtol(s_maxThreads, &endptr, 10);
+		if (*endptr == '\0' && val > 0) {
+			envMaxThreads = (val <= static_cast<long>(THREADPOOL_MAX_THREADS + 1)
+				? static_cast<unsigned int>(val)
+				: THREADPOOL_MAX_THREADS + 1);
+		}
+	}
+
+	instance = new ThreadPool(threadCount);
+}
+
+/** ThreadPool **/
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+	: d_ptr(new ThreadPoolPrivate(threadCount))
+{ }
+
+ThreadPool::~ThreadPool()
+{
+	delete d_ptr;
+}
+
+/**
+ * Get the shared thread pool.
+ * The thread pool is created on first use.
+ * @return Shared thread pool.
+ */
+ThreadPool *ThreadPool::instance(void)
+{
+	pthread_once(&ThreadPoolPrivate::once_instance, ThreadPoolPrivate::initInstance);
+	return ThreadPoolPrivate::instance;
+}
+
+/**
+ * Set the maximum number of threads that can run tasks,
+ * including the calling thread.
+ *
+ * This can be called at any time. Worker threads above
+ * the new limit exit once they're idle.
+ *
+ * NOTE: The RP_MAX_THREADS environment variable
+ * takes precedence over this value.
+ *
+ * @param maxThreads Maximum number of threads. (0 for the number of CPUs)
+ */
+void ThreadPool::setMaxThreads(unsigned int maxThreads)
+{
+	if (maxThreads > THREADPOOL_MAX_THREADS + 1) {
+		maxThreads = THREADPOOL_MAX_THREADS + 1;
+	}
+	ATOMIC_EXCHANGE(&ThreadPoolPrivate::cfgMaxThreads, static_cast<int>(maxThreads));
+}
+
+/**
+ * Get the number of threads that can run tasks,
+ * including the calling thread.
+ * @return Number of threads.
+ */
+unsigned int ThreadPool::threadCount(void) const
+{
+	return d_ptr->wantedWorkers() + 1;
+}
+
+/**
+ * parallelFor() job.
+ */
+struct ParallelForJob {
+	ThreadPool::ParallelForFn fn;
+	void *param;
+	int count;
+	volatile int nextIdx;
+
+	/**
+	 * Run tasks until there are none left.
+	 */
+	void runTasks(void)
+	{
+		for (;;) {
+			const int idx = ATOMIC_INC_FETCH(&nextIdx) - 1;
+			if (idx >= count)
+				break;
+			fn(param, static_cast<unsigned int>(idx));
+		}
+	}
+
+	/**
+	 * TaskGroup task function.
+	 * @param param ParallelForJob
+	 */
+	static void task(void *param)
+	{
+		static_cast<ParallelForJob*>(param)->runTasks();
+	}
+};
+
+/**
+ * Run fn(param, index) for index = [0, count).
+ *
+ * Tasks are distributed between the worker threads
+ * and the calling thread. This function does not
+ * return until all tasks have completed.
+ *
+ * This may be called from a task; the calling thread
+ * runs other queued tasks while it waits.
+ *
+ * @param count Number of tasks.
+ * @param fn Task function.
+ * @param param User parameter.
+ * @param maxThreads Maximum number of threads to use, including the calling thread. (0 for no limit)
+ */
+void ThreadPool::parallelFor(unsigned int count, ParallelForFn fn, void *param, unsigned int maxThreads)
+{
+	assert(fn != nullptr);
+	assert(count <= 0x7FFFFFFFU);
+	if (!fn || count == 0)
+		return;
+
+	// Number of additional threads to use.
+	unsigned int helpers = d_ptr->startWorkers();
+	if (helpers > count - 1) {
+		helpers = count - 1;
+	}
+	if (maxThreads != 0 && helpers > maxThreads - 1) {
+		helpers = maxThreads - 1;
+	}
+
+	if (helpers == 0 || count > 0x7FFFFFFFU) {
+		// Single task or no worker threads.
+		// Run the tasks on the calling thread.
+		for (unsigned int i = 0; i < count; i++) {
+			fn(param, i);
+		}
+		return;
+	}
+
+	// Each helper task takes indexes until there are none left.
+	// If a helper task doesn't start until all indexes are taken,
+	// it returns immediately.
+	ParallelForJob job;
+	job.fn = fn;
+	job.param = param;
+	job.count = static_cast<int>(count);
+	job.nextIdx = 0;
+
+	TaskGroup group(this);
+	for (unsigned int i = 0; i < helpers; i++) {
+		group.run(ParallelForJob::task, &job);
+	}
+	job.runTasks();
+	group.wait();
+}
+
+/** TaskGroup **/
+
+/**
+ * Create a task group.
+ * @param pool Thread pool. (If nullptr, use the shared thread pool.)
+ */
+TaskGroup::TaskGroup(ThreadPool *pool)
+	: m_pool(pool ? pool : ThreadPool::instance())
+	, m_state(0)
+	, m_cancelled(0)
+	, m_semDone(0)
+{ }
+
+TaskGroup::~TaskGroup()
+{
+	wait();
+}
+
+/**
+ * Submit a task.
+ * If the group has been cancelled, the task is not run.
+ * @param fn Task function.
+ * @param param User parameter.
+ */
+void TaskGroup::run(TaskFn fn, void *param)
+{
+	assert(fn != nullptr);
+	if (!fn || isCancelled())
+		return;
+
+	ThreadPoolPrivate *const d = m_pool->d_ptr;
+	if (d->startWorkers() == 0) {
+		// No worker threads. Run the task now.
+		fn(param);
+		return;
+	}
+
+	Task task;
+	task.group = this;
+	task.fn = fn;
+	task.param = param;
+	ATOMIC_INC_FETCH(&m_state);
+	d->push(task);
+}
+
+/**
+ * Mark a task as completed.
+ * Called by the thread that ran (or skipped) the task.
+ */
+void TaskGroup::taskDone(void)
+{
+	// NOTE: Once the count reaches 0, wait() may return and
+	// the group may be destroyed, unless wait() is blocked.
+	if (ATOMIC_DEC_FETCH(&m_state) == STATE_WAITING) {
+		// Last task, and wait() is blocked.
+		m_semDone.release();
+	}
+}
+
+/**
+ * Wait for all tasks in this group to complete.
+ */
+void TaskGroup::wait(void)
+{
+	ThreadPoolPrivate *const d = m_pool->d_ptr;
+	Task task;
+	while (ATOMIC_LOAD(&m_state) != 0) {
+		// Help out by running queued tasks.
+		// These may belong to other groups.
+		if (d->pop(task)) {
+			ThreadPoolPrivate::runTask(task);
+			continue;
+		}
+
+		// No queued tasks, so the remaining tasks in this
+		// group are running on other threads. Wait for them.
+		if (ATOMIC_OR_FETCH(&m_state, STATE_WAITING) != STATE_WAITING) {
+			// taskDone() will release the semaphore
+			// when the last task is done.
+			m_semDone.obtain();
+		}
+		ATOMIC_EXCHANGE(&m_state, 0);
+		break;
+	}
+}
+
+/**
+ * Cancel the group.
+ * Tasks that haven't started yet won't be run.
+ * Running tasks can check isCancelled() to stop early.
+ * The group must still be waited on. (The destructor does this.)
+ */
+void TaskGroup::cancel(void)
+{
+	ATOMIC_EXCHANGE(&m_cancelled, 1);
+}
+
+}
@@ -0,0 +1,193 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (librpthreads)                     *
+ * ThreadPool.hpp: Work-stealing thread pool.                              *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_LIBRPTHREADS_THREADPOOL_HPP__
+#define __ROMPROPERTIES_LIBRPTHREADS_THREADPOOL_HPP__
+
+#include "Atomics.h"
+#include "Semaphore.hpp"
+
+namespace LibRpThreads {
+
+class TaskGroup;
+
+class ThreadPoolPrivate;
+class ThreadPool
+{
+	protected:
+		/**
+		 * Create a thread pool.
+		 * Worker threads are started when the first task is submitted.
+		 * @param threadCount Maximum number of worker threads.
+		 */
+		explicit ThreadPool(unsigned int threadCount);
+	public:
+		~ThreadPool();
+
+	private:
+#if __cplusplus >= 201103L
+		ThreadPool(const ThreadPool &) = delete; \
+		ThreadPool &operator=(const ThreadPool &) = delete;
+#else /* __cplusplus < 201103L */
+		ThreadPool(const ThreadPool &); \
+		ThreadPool &operator=(const ThreadPool &);
+#endif /* __cplusplus */
+
+	private:
+		friend class ThreadPoolPrivate;
+		friend class TaskGroup;
+		ThreadPoolPrivate *const d_ptr;
+
+	public:
+		/**
+		 * Get the shared thread pool.
+		 * The thread pool is created on first use.
+		 * @return Shared thread pool.
+		 */
+		static ThreadPool *instance(void);
+
+		/**
+		 * Set the maximum number of threads that can run tasks,
+		 * including the calling thread.
+		 *
+		 * This can be called at any time. Worker threads above
+		 * the new limit exit once they're idle.
+		 *
+		 * NOTE: The RP_MAX_THREADS environment variable
+		 * takes precedence over this value.
+		 *
+		 * @param maxThreads Maximum number of threads. (0 for the number of CPUs)
+		 */
+		static void setMaxThreads(unsigned int maxThreads);
+
+		/**
+		 * Get the number of threads that can run tasks,
+		 * including the calling thread.
+		 * @return Number of threads.
+		 */
+		unsigned int threadCount(void) const;
+
+		/**
+		 * Task function for parallelFor().
+		 * @param param User parameter.
+		 * @param index Task index.
+		 */
+		typedef void (*ParallelForFn)(void *param, unsigned int index);
+
+		/**
+		 * Run fn(param, index) for index = [0, count).
+		 *
+		 * Tasks are distributed between the worker threads
+		 * and the calling thread. This function does not
+		 * return until all tasks have completed.
+		 *
+		 * This may be called from a task; the calling thread
+		 * runs other queued tasks while it waits.
+		 *
+		 * @param count Number of tasks.
+		 * @param fn Task function.
+		 * @param param User parameter.
+		 * @param maxThreads Maximum number of threads to use, including the calling thread. (0 for no limit)
+		 */
+		void parallelFor(unsigned int count, ParallelForFn fn, void *param, unsigned int maxThreads = 0);
+};
+
+/**
+ * Group of tasks that run on a ThreadPool.
+ *
+ * Tasks are submitted with run() and may run on any worker thread.
+ * Tasks submitted from a worker thread go to that thread's own
+ * queue; idle threads steal tasks from other threads' queues.
+ *
+ * wait() blocks until all tasks in the group have completed.
+ * While waiting, the calling thread runs queued tasks itself,
+ * so groups can be nested and waited on from within a task.
+ *
+ * The destructor waits for any remaining tasks.
+ */
+class TaskGroup
+{
+	public:
+		/**
+		 * Create a task group.
+		 * @param pool Thread pool. (If nullptr, use the shared thread pool.)
+		 */
+		explicit TaskGroup(ThreadPool *pool = nullptr);
+		~TaskGroup();
+
+	private:
+#if __cplusplus >= 201103L
+		TaskGroup(const TaskGroup &) = delete; \
+		TaskGroup &operator=(const TaskGroup &) = delete;
+#else /* __cplusplus < 201103L */
+		TaskGroup(const TaskGroup &); \
+		TaskGroup &operator=(const TaskGroup &);
+#endif /* __cplusplus */
+
+	public:
+		/**
+		 * Task function.
+		 * @param param User parameter.
+		 */
+		typedef void (*TaskFn)(void *param);
+
+		/**
+		 * Submit a task.
+		 * If the group has been cancelled, the task is not run.
+		 * @param fn Task function.
+		 * @param param User parameter.
+		 */
+		void run(TaskFn fn, void *param);
+
+		/**
+		 * Wait for all tasks in this group to complete.
+		 */
+		void wait(void);
+
+		/**
+		 * Cancel the group.
+		 * Tasks that haven't started yet won't be run.
+		 * Running tasks can check isCancelled() to stop early.
+		 * The group must still be waited on. (The destructor does this.)
+		 */
+		void cancel(void);
+
+		/**
+		 * Has the group been cancelled?
+		 * @return True if cancelled; false if not.
+		 */
+		inline bool isCancelled(void) const
+		{
+			return (ATOMIC_LOAD(const_cast<volatile int*>(&m_cancelled)) != 0);
+		}
+
+	private:
+		friend class ThreadPoolPrivate;
+
+		/**
+		 * Mark a task as completed.
+		 * Called by the thread that ran (or skipped) the task.
+		 */
+		void taskDone(void);
+
+		ThreadPool *const m_pool;
+
+		// Low bits: Number of tasks that haven't completed.
+		// STATE_WAITING: Set if wait() is blocked on m_semDone.
+		// NOTE: These are combined so taskDone() doesn't touch
+		// the object after the last task has been marked as done,
+		// unless wait() is blocked.
+		static const int STATE_WAITING = 0x40000000;
+		volatile int m_state;
+		volatile int m_cancelled;	// Non-zero if cancelled.
+		Semaphore m_semDone;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_LIBRPTHREADS_THREADPOOL_HPP__ */
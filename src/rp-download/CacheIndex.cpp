@@ -0,0 +1,222 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rp-download)                      *
+ * CacheIndex.cpp: Cache directory index for LRU eviction.                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "CacheIndex.hpp"
+
+// C includes.
+#ifdef _WIN32
+# include "libwin32common/w32time.h"
+#else /* !_WIN32 */
+# include <dirent.h>
+# include <fcntl.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif /* _WIN32 */
+
+// C includes. (C++ namespace)
+#include <cstdio>
+
+// C++ includes.
+#include <algorithm>
+using std::tstring;
+using std::vector;
+
+namespace RpDownload {
+
+// Maximum directory depth to scan.
+// Cache keys are usually "system/type/region/id.png".
+static const int MAX_DEPTH = 8;
+
+CacheIndex::CacheIndex()
+	: m_totalSize(0)
+{ }
+
+/**
+ * Scan a cache directory.
+ * Any previously-indexed files are discarded.
+ * @param cache_dir Cache directory.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CacheIndex::scan(const tstring &cache_dir)
+{
+	m_entries.clear();
+	m_totalSize = 0;
+
+	if (cache_dir.empty()) {
+		return -EINVAL;
+	}
+
+	tstring path = cache_dir;
+	if (path[path.size()-1] != DIR_SEP_CHR) {
+		path += DIR_SEP_CHR;
+	}
+	scanDir(path, 0);
+	return 0;
+}
+
+/**
+ * Add a file to the index if it's a downloaded image.
+ * @param path Directory path, with a trailing separator.
+ * @param name Filename.
+ * @param size File size.
+ * @param atime Last access time.
+ */
+void CacheIndex::addFile(const tstring &path, const TCHAR *name, off64_t size, time_t atime)
+{
+	// Cache keys must have a lowercase ".png" or ".jpg" extension,
+	// so this skips temporary files, the eviction timestamp,
+	// and anything else that isn't a downloaded image.
+	const TCHAR *const lastdot = _tcsrchr(name, _T('.'));
+	if (!lastdot || (_tcscmp(lastdot, _T(".png")) != 0 &&
+	                 _tcscmp(lastdot, _T(".jpg")) != 0))
+	{
+		return;
+	}
+
+	Entry entry;
+	entry.filename = path;
+	entry.filename += name;
+	entry.size = size;
+	entry.atime = atime;
+	m_entries.emplace_back(std::move(entry));
+	m_totalSize += size;
+}
+
+/**
+ * Recursively scan a directory.
+ * @param path Directory path, with a trailing separator.
+ * @param depth Directory depth. (0 == cache directory)
+ */
+void CacheIndex::scanDir(const tstring &path, int depth)
+{
+	if (depth > MAX_DEPTH) {
+		// Too deep. The cache shouldn't have this many levels.
+		return;
+	}
+
+#ifdef _WIN32
+	WIN32_FIND_DATA ffd;
+	HANDLE hFind = FindFirstFile((path + _T('*')).c_str(), &ffd);
+	if (!hFind || hFind == INVALID_HANDLE_VALUE) {
+		// Unable to open the directory.
+		return;
+	}
+
+	do {
+		const TCHAR *const name = ffd.cFileName;
+		if (name[0] == _T('.') && (name[1] == _T('\0') ||
+		    (name[1] == _T('.') && name[2] == _T('\0'))))
+		{
+			// "." or ".."
+			continue;
+		}
+
+		if (ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+			// Skip RomDataIndex's directory.
+			if (depth == 0 && !_tcscmp(name, _T("index")))
+				continue;
+			scanDir(path + name + DIR_SEP_CHR, depth + 1);
+			continue;
+		}
+
+		LARGE_INTEGER fileSize;
+		fileSize.LowPart = ffd.nFileSizeLow;
+		fileSize.HighPart = ffd.nFileSizeHigh;
+		addFile(path, name, fileSize.QuadPart,
+			static_cast<time_t>(FileTimeToUnixTime(&ffd.ftLastAccessTime)));
+	} while (FindNextFile(hFind, &ffd));
+	FindClose(hFind);
+#else /* !_WIN32 */
+	DIR *const dir = opendir(path.c_str());
+	if (!dir) {
+		// Unable to open the directory.
+		return;
+	}
+
+	const int dfd = dirfd(dir);
+	struct dirent *dirent;
+	while ((dirent = readdir(dir)) != nullptr) {
+		const char *const name = dirent->d_name;
+		if (name[0] == '.' && (name[1] == '\0' ||
+		    (name[1] == '.' && name[2] == '\0')))
+		{
+			// "." or ".."
+			continue;
+		}
+
+		struct stat sb;
+		if (fstatat(dfd, name, &sb, AT_SYMLINK_NOFOLLOW) != 0)
+			continue;
+
+		if (S_ISDIR(sb.st_mode)) {
+			// Skip RomDataIndex's directory.
+			if (depth == 0 && !strcmp(name, "index"))
+				continue;
+			scanDir(path + name + DIR_SEP_CHR, depth + 1);
+		} else if (S_ISREG(sb.st_mode)) {
+			addFile(path, name, sb.st_size, sb.st_atime);
+		}
+	}
+	closedir(dir);
+#endif /* _WIN32 */
+}
+
+/**
+ * Delete the least-recently-used files until the
+ * cache is within the specified limits.
+ * @param maxSize	[in] Maximum total size, in bytes. (0 == unlimited)
+ * @param maxEntries	[in] Maximum number of files. (0 == unlimited)
+ * @return Number of files deleted.
+ */
+unsigned int CacheIndex::evict(off64_t maxSize, unsigned int maxEntries)
+{
+	size_t count = m_entries.size();
+	if ((maxSize <= 0 || m_totalSize <= maxSize) &&
+	    (maxEntries == 0 || count <= maxEntries))
+	{
+		// Cache is within the limits.
+		return 0;
+	}
+
+	// Sort by last access time, oldest first.
+	std::sort(m_entries.begin(), m_entries.end(),
+		[](const Entry &a, const Entry &b) {
+			return (a.atime < b.atime);
+		});
+
+	unsigned int deleted = 0;
+	auto iter = m_entries.begin();
+	for (; iter != m_entries.end(); ++iter) {
+		if ((maxSize <= 0 || m_totalSize <= maxSize) &&
+		    (maxEntries == 0 || count <= maxEntries))
+		{
+			// Cache is within the limits now.
+			break;
+		}
+
+		if (_tremove(iter->filename.c_str()) != 0 && errno != ENOENT) {
+			// Unable to delete the file. Skip it.
+			continue;
+		}
+		m_totalSize -= iter->size;
+		count--;
+		deleted++;
+	}
+
+	// Remove the deleted files from the index.
+	// NOTE: Files that couldn't be deleted are removed, too.
+	m_entries.erase(m_entries.begin(), iter);
+	m_totalSize = 0;
+	for (auto cur = m_entries.cbegin(); cur != m_entries.cend(); ++cur) {
+		m_totalSize += cur->size;
+	}
+	return deleted;
+}
+
+}
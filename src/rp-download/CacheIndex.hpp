@@ -0,0 +1,111 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rp-download)                      *
+ * CacheIndex.hpp: Cache directory index for LRU eviction.                 *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_RP_DOWNLOAD_CACHEINDEX_HPP__
+#define __ROMPROPERTIES_RP_DOWNLOAD_CACHEINDEX_HPP__
+
+// Common definitions, including function attributes.
+#include "common.h"
+
+// C includes. (C++ namespace)
+#include <cstddef>
+#include <ctime>
+
+// C++ includes.
+#include <string>
+#include <vector>
+
+// tcharx
+#include "tcharx.h"
+
+namespace RpDownload {
+
+/**
+ * In-memory index of the downloaded files in the cache directory.
+ *
+ * The index is built by scanning the cache directory. The last
+ * access time of each file is used for LRU ordering; CacheManager
+ * updates it explicitly on every cache hit, so this works even
+ * if the file system is mounted with noatime.
+ *
+ * Only downloaded images (*.png, *.jpg) are indexed. Negative
+ * cache entries (0-byte files) count towards the entry limit.
+ */
+class CacheIndex
+{
+	public:
+		CacheIndex();
+
+	private:
+		RP_DISABLE_COPY(CacheIndex)
+
+	public:
+		/**
+		 * Scan a cache directory.
+		 * Any previously-indexed files are discarded.
+		 * @param cache_dir Cache directory.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int scan(const std::tstring &cache_dir);
+
+		/**
+		 * Get the number of indexed files.
+		 * @return Number of indexed files.
+		 */
+		size_t count(void) const
+		{
+			return m_entries.size();
+		}
+
+		/**
+		 * Get the total size of all indexed files.
+		 * @return Total size, in bytes.
+		 */
+		off64_t totalSize(void) const
+		{
+			return m_totalSize;
+		}
+
+		/**
+		 * Delete the least-recently-used files until the
+		 * cache is within the specified limits.
+		 * @param maxSize	[in] Maximum total size, in bytes. (0 == unlimited)
+		 * @param maxEntries	[in] Maximum number of files. (0 == unlimited)
+		 * @return Number of files deleted.
+		 */
+		unsigned int evict(off64_t maxSize, unsigned int maxEntries);
+
+	private:
+		/**
+		 * Recursively scan a directory.
+		 * @param path Directory path, with a trailing separator.
+		 * @param depth Directory depth. (0 == cache directory)
+		 */
+		void scanDir(const std::tstring &path, int depth);
+
+		/**
+		 * Add a file to the index if it's a downloaded image.
+		 * @param path Directory path, with a trailing separator.
+		 * @param name Filename.
+		 * @param size File size.
+		 * @param atime Last access time.
+		 */
+		void addFile(const std::tstring &path, const TCHAR *name, off64_t size, time_t atime);
+
+		struct Entry {
+			std::tstring filename;
+			off64_t size;
+			time_t atime;
+		};
+		std::vector<Entry> m_entries;
+		off64_t m_totalSize;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_RP_DOWNLOAD_CACHEINDEX_HPP__ */
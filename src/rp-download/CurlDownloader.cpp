@@ -12,23 +12,30 @@
 // C++ STL classes.
 using std::string;
 
-// cURL for network access.
-#include <curl/curl.h>
-
 namespace RpDownload {
 
 CurlDownloader::CurlDownloader()
 	: super()
+	, m_curl(nullptr)
 { }
 
 CurlDownloader::CurlDownloader(const TCHAR *url)
 	: super(url)
+	, m_curl(nullptr)
 { }
 
 CurlDownloader::CurlDownloader(const tstring &url)
 	: super(url)
+	, m_curl(nullptr)
 { }
 
+CurlDownloader::~CurlDownloader()
+{
+	if (m_curl) {
+		curl_easy_cleanup(m_curl);
+	}
+}
+
 /**
  * Internal cURL data write function.
  * @param ptr Data to write.
@@ -151,10 +158,30 @@ size_t CurlDownloader::parse_header(char *ptr, size_t size, size_t nitems, void
 }
 
 /**
- * Download the file.
- * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
+ * Set the cURL time condition based on the If-Modified-Since time.
+ * @param curl cURL easy handle.
  */
-int CurlDownloader::download(void)
+void CurlDownloader::setTimeCondition(CURL *curl)
+{
+	if (m_ifModifiedSince >= 0) {
+		curl_easy_setopt(curl, CURLOPT_TIMECONDITION, static_cast<long>(CURL_TIMECOND_IFMODSINCE));
+#if LIBCURL_VERSION_NUM >= 0x073B00 /* 7.59.0 */
+		curl_easy_setopt(curl, CURLOPT_TIMEVALUE_LARGE, static_cast<curl_off_t>(m_ifModifiedSince));
+#else /* LIBCURL_VERSION_NUM < 0x073B00 */
+		curl_easy_setopt(curl, CURLOPT_TIMEVALUE, static_cast<long>(m_ifModifiedSince));
+#endif /* LIBCURL_VERSION_NUM >= 0x073B00 */
+	} else {
+		curl_easy_setopt(curl, CURLOPT_TIMECONDITION, static_cast<long>(CURL_TIMECOND_NONE));
+	}
+}
+
+/**
+ * Prepare the cURL easy handle for a new download.
+ * The handle is created on first use and reused afterwards,
+ * so it can be added to a CURLM handle multiple times.
+ * @return cURL easy handle, or nullptr on error.
+ */
+CURL *CurlDownloader::prepareHandle(void)
 {
 	// References:
 	// - http://stackoverflow.com/questions/1636333/download-file-using-libcurl-in-c-c
@@ -165,11 +192,19 @@ int CurlDownloader::download(void)
 	m_data.clear();
 	m_mtime = -1;
 
+	if (m_curl) {
+		// Handle was already initialized.
+		// Only the URL and If-Modified-Since time need to be updated.
+		curl_easy_setopt(m_curl, CURLOPT_URL, m_url.c_str());
+		setTimeCondition(m_curl);
+		return m_curl;
+	}
+
 	// Initialize cURL.
-	CURL *curl = curl_easy_init();
+	CURL *const curl = curl_easy_init();
 	if (!curl) {
 		// Could not initialize cURL.
-		return -ENOMEM;	// TODO: Better error?
+		return nullptr;
 	}
 
 	// Proxy settings should be set by the calling application
@@ -191,6 +226,7 @@ int CurlDownloader::download(void)
 	curl_easy_setopt(curl, CURLOPT_HEADERDATA, this);
 	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_data);
 	curl_easy_setopt(curl, CURLOPT_WRITEDATA, this);
+	curl_easy_setopt(curl, CURLOPT_PRIVATE, this);
 
 	// Don't use signals. We're running as a plugin, so using
 	// signals might interfere.
@@ -206,15 +242,26 @@ int CurlDownloader::download(void)
 	// Set the User-Agent.
 	curl_easy_setopt(curl, CURLOPT_USERAGENT, m_userAgent.c_str());
 
-	// TODO: Set the User-Agent?
-	CURLcode res = curl_easy_perform(curl);
-	curl_easy_cleanup(curl);
+	// Set the If-Modified-Since time.
+	setTimeCondition(curl);
+
+	m_curl = curl;
+	return curl;
+}
+
+/**
+ * Get the download result after the transfer has completed.
+ * @param res cURL result code.
+ * @return 0 on success; 304 if not modified; negative POSIX error code, positive HTTP status code on error.
+ */
+int CurlDownloader::transferResult(CURLcode res)
+{
 	if (res != CURLE_OK) {
 		// Error downloading the file.
 		// Check if we have an HTTP response code.
 		// NOTE: GameTDB sometimes returns nothing instead of 404...
 		long response_code = 0;
-		curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+		curl_easy_getinfo(m_curl, CURLINFO_RESPONSE_CODE, &response_code);
 		if (response_code <= 0) {
 			// No HTTP response code.
 			// TODO: Return a cURL error code and/or message...
@@ -223,6 +270,17 @@ int CurlDownloader::download(void)
 		return (int)response_code;
 	}
 
+	// Check if the file wasn't modified.
+	// NOTE: cURL returns CURLE_OK with no data in this case.
+	if (m_ifModifiedSince >= 0) {
+		long unmet = 0;
+		curl_easy_getinfo(m_curl, CURLINFO_CONDITION_UNMET, &unmet);
+		if (unmet) {
+			// HTTP 304 Not Modified
+			return 304;
+		}
+	}
+
 	// Check if we have data.
 	if (m_data.empty()) {
 		// No data.
@@ -233,4 +291,20 @@ int CurlDownloader::download(void)
 	return 0;
 }
 
+/**
+ * Download the file.
+ * @return 0 on success; 304 if not modified (see setIfModifiedSince()); negative POSIX error code, positive HTTP status code on error.
+ */
+int CurlDownloader::download(void)
+{
+	CURL *const curl = prepareHandle();
+	if (!curl) {
+		// Could not initialize cURL.
+		return -ENOMEM;	// TODO: Better error?
+	}
+
+	const CURLcode res = curl_easy_perform(curl);
+	return transferResult(res);
+}
+
 }
@@ -11,19 +11,49 @@
 
 #include "IDownloader.hpp"
 
+// cURL for network access.
+#include <curl/curl.h>
+
 namespace RpDownload {
 
+class CurlMultiDownloader;
+
 class CurlDownloader final : public IDownloader
 {
 	public:
 		CurlDownloader();
 		explicit CurlDownloader(const TCHAR *url);
 		explicit CurlDownloader(const std::tstring &url);
+		~CurlDownloader() final;
 
 	private:
 		typedef IDownloader super;
 		RP_DISABLE_COPY(CurlDownloader)
 
+	private:
+		friend class CurlMultiDownloader;
+
+		/**
+		 * Set the cURL time condition based on the If-Modified-Since time.
+		 * @param curl cURL easy handle.
+		 */
+		void setTimeCondition(CURL *curl);
+
+		/**
+		 * Prepare the cURL easy handle for a new download.
+		 * The handle is created on first use and reused afterwards,
+		 * so it can be added to a CURLM handle multiple times.
+		 * @return cURL easy handle, or nullptr on error.
+		 */
+		CURL *prepareHandle(void);
+
+		/**
+		 * Get the download result after the transfer has completed.
+		 * @param res cURL result code.
+		 * @return 0 on success; 304 if not modified; negative POSIX error code, positive HTTP status code on error.
+		 */
+		int transferResult(CURLcode res);
+
 	protected:
 		/**
 		 * Internal cURL data write function.
@@ -48,9 +78,12 @@ class CurlDownloader final : public IDownloader
 	public:
 		/**
 		 * Download the file.
-		 * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
+		 * @return 0 on success; 304 if not modified (see setIfModifiedSince()); negative POSIX error code, positive HTTP status code on error.
 		 */
 		int download(void) final;
+
+	private:
+		CURL *m_curl;
 };
 
 }
@@ -0,0 +1,168 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rp-download)                      *
+ * CurlMultiDownloader.cpp: libcurl-based parallel file downloader.        *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "CurlMultiDownloader.hpp"
+
+// C includes.
+#include <poll.h>
+
+// C++ STL classes.
+using std::vector;
+
+namespace RpDownload {
+
+/**
+ * Create a parallel downloader.
+ *
+ * All transfers share a single cURL multi handle, so connections,
+ * DNS lookups, and TLS sessions are reused across downloads.
+ *
+ * @param maxTransfers Maximum number of simultaneous transfers.
+ */
+CurlMultiDownloader::CurlMultiDownloader(unsigned int maxTransfers)
+	: m_multi(curl_multi_init())
+	, m_maxTransfers(maxTransfers > 0 ? maxTransfers : 1)
+	, m_activeTransfers(0)
+{
+	if (!m_multi) {
+		// Could not initialize cURL.
+		return;
+	}
+
+	// Limit the number of connections to the number of transfers.
+	// Each database is hosted on a single server, so the per-host
+	// limit is the same as the total limit.
+	curl_multi_setopt(m_multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(m_maxTransfers));
+	curl_multi_setopt(m_multi, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(m_maxTransfers));
+	// Keep idle connections around for reuse.
+	curl_multi_setopt(m_multi, CURLMOPT_MAXCONNECTS, static_cast<long>(m_maxTransfers));
+#if LIBCURL_VERSION_NUM >= 0x072B00 /* 7.43.0 */
+	// Use HTTP/2 multiplexing if the server supports it.
+	curl_multi_setopt(m_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif /* LIBCURL_VERSION_NUM >= 0x072B00 */
+}
+
+CurlMultiDownloader::~CurlMultiDownloader()
+{
+	// NOTE: The easy handles are owned by the CurlDownloader objects.
+	// Any transfers that are still active will be aborted.
+	if (m_multi) {
+		curl_multi_cleanup(m_multi);
+	}
+}
+
+/**
+ * Start downloading a file.
+ * The downloader's URL must be set beforehand, and the downloader
+ * must remain valid until it's returned by perform().
+ * @param downloader CurlDownloader.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CurlMultiDownloader::add(CurlDownloader *downloader)
+{
+	assert(downloader != nullptr);
+	if (!m_multi) {
+		return -EBADF;
+	} else if (!downloader) {
+		return -EINVAL;
+	}
+
+	CURL *const curl = downloader->prepareHandle();
+	if (!curl) {
+		// Could not initialize cURL.
+		return -ENOMEM;	// TODO: Better error?
+	}
+
+	if (curl_multi_add_handle(m_multi, curl) != CURLM_OK) {
+		// Could not add the handle.
+		return -EIO;
+	}
+
+	m_activeTransfers++;
+	return 0;
+}
+
+/**
+ * Run the active transfers, waiting up to timeout_ms for activity.
+ * @param extra_fd	[in] Additional file descriptor to wait for input on, or -1 for none.
+ * @param timeout_ms	[in] Maximum time to wait, in milliseconds.
+ * @param results	[out] Completed transfers are appended here.
+ * @return 1 if extra_fd has input (or EOF); 0 if not; negative POSIX error code on error.
+ */
+int CurlMultiDownloader::perform(int extra_fd, int timeout_ms, vector<Result> &results)
+{
+	if (!m_multi) {
+		return -EBADF;
+	}
+
+	int running = 0;
+	CURLMcode mres = curl_multi_perform(m_multi, &running);
+	if (mres != CURLM_OK) {
+		return -EIO;
+	}
+
+	// Wait for activity on the transfers and/or the extra file descriptor.
+	struct curl_waitfd wfd;
+	wfd.fd = extra_fd;
+	wfd.events = CURL_WAIT_POLLIN;
+	wfd.revents = 0;
+	mres = curl_multi_wait(m_multi, (extra_fd >= 0 ? &wfd : nullptr),
+		(extra_fd >= 0 ? 1 : 0), timeout_ms, nullptr);
+	if (mres != CURLM_OK) {
+		return -EIO;
+	}
+	mres = curl_multi_perform(m_multi, &running);
+	if (mres != CURLM_OK) {
+		return -EIO;
+	}
+
+	// Check if the extra file descriptor has input.
+	// NOTE: curl_multi_wait() doesn't report POLLHUP in revents,
+	// so EOF on a pipe wouldn't be detected. Check it directly.
+	int fd_ready = 0;
+	if (extra_fd >= 0) {
+		struct pollfd pfd;
+		pfd.fd = extra_fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		if (poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLIN | POLLHUP | POLLERR))) {
+			fd_ready = 1;
+		}
+	}
+
+	// Check for completed transfers.
+	CURLMsg *msg;
+	int msgs_left = 0;
+	while ((msg = curl_multi_info_read(m_multi, &msgs_left)) != nullptr) {
+		if (msg->msg != CURLMSG_DONE)
+			continue;
+
+		CURL *const curl = msg->easy_handle;
+		const CURLcode res = msg->data.result;
+		curl_multi_remove_handle(m_multi, curl);
+		assert(m_activeTransfers > 0);
+		m_activeTransfers--;
+
+		char *priv = nullptr;
+		curl_easy_getinfo(curl, CURLINFO_PRIVATE, &priv);
+		CurlDownloader *const downloader = reinterpret_cast<CurlDownloader*>(priv);
+		assert(downloader != nullptr);
+		if (!downloader)
+			continue;
+
+		Result result;
+		result.downloader = downloader;
+		result.ret = downloader->transferResult(res);
+		results.emplace_back(result);
+	}
+
+	return fd_ready;
+}
+
+}
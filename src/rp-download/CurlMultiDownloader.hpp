@@ -0,0 +1,98 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rp-download)                      *
+ * CurlMultiDownloader.hpp: libcurl-based parallel file downloader.        *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_RP_DOWNLOAD_CURLMULTIDOWNLOADER_HPP__
+#define __ROMPROPERTIES_RP_DOWNLOAD_CURLMULTIDOWNLOADER_HPP__
+
+#include "CurlDownloader.hpp"
+
+// C++ includes.
+#include <vector>
+
+namespace RpDownload {
+
+class CurlMultiDownloader
+{
+	public:
+		/**
+		 * Create a parallel downloader.
+		 *
+		 * All transfers share a single cURL multi handle, so connections,
+		 * DNS lookups, and TLS sessions are reused across downloads.
+		 *
+		 * @param maxTransfers Maximum number of simultaneous transfers.
+		 */
+		explicit CurlMultiDownloader(unsigned int maxTransfers);
+		~CurlMultiDownloader();
+
+	private:
+		RP_DISABLE_COPY(CurlMultiDownloader)
+
+	public:
+		/**
+		 * Is the multi handle valid?
+		 * @return True if valid; false if not.
+		 */
+		bool isValid(void) const
+		{
+			return (m_multi != nullptr);
+		}
+
+		/**
+		 * Get the maximum number of simultaneous transfers.
+		 * @return Maximum number of simultaneous transfers.
+		 */
+		unsigned int maxTransfers(void) const
+		{
+			return m_maxTransfers;
+		}
+
+		/**
+		 * Get the number of active transfers.
+		 * @return Number of active transfers.
+		 */
+		unsigned int activeTransfers(void) const
+		{
+			return m_activeTransfers;
+		}
+
+		/**
+		 * Start downloading a file.
+		 * The downloader's URL must be set beforehand, and the downloader
+		 * must remain valid until it's returned by perform().
+		 * @param downloader CurlDownloader.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int add(CurlDownloader *downloader);
+
+		/**
+		 * Result of a completed transfer.
+		 */
+		struct Result {
+			CurlDownloader *downloader;
+			int ret;	// 0 on success; 304 if not modified; negative POSIX error code, positive HTTP status code on error.
+		};
+
+		/**
+		 * Run the active transfers, waiting up to timeout_ms for activity.
+		 * @param extra_fd	[in] Additional file descriptor to wait for input on, or -1 for none.
+		 * @param timeout_ms	[in] Maximum time to wait, in milliseconds.
+		 * @param results	[out] Completed transfers are appended here.
+		 * @return 1 if extra_fd has input (or EOF); 0 if not; negative POSIX error code on error.
+		 */
+		int perform(int extra_fd, int timeout_ms, std::vector<Result> &results);
+
+	private:
+		CURLM *m_multi;
+		unsigned int m_maxTransfers;
+		unsigned int m_activeTransfers;
+};
+
+}
+
+#endif /* __ROMPROPERTIES_RP_DOWNLOAD_CURLMULTIDOWNLOADER_HPP__ */
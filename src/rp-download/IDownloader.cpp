@@ -25,6 +25,7 @@ namespace RpDownload {
 
 IDownloader::IDownloader()
 	: m_mtime(-1)
+	, m_ifModifiedSince(-1)
 	, m_inProgress(false)
 	, m_maxSize(0)
 #ifdef _WIN32
@@ -37,6 +38,7 @@ IDownloader::IDownloader()
 IDownloader::IDownloader(const TCHAR *url)
 	: m_url(url)
 	, m_mtime(-1)
+	, m_ifModifiedSince(-1)
 	, m_inProgress(false)
 	, m_maxSize(0)
 #ifdef _WIN32
@@ -49,6 +51,7 @@ IDownloader::IDownloader(const TCHAR *url)
 IDownloader::IDownloader(const tstring &url)
 	: m_url(url)
 	, m_mtime(-1)
+	, m_ifModifiedSince(-1)
 	, m_inProgress(false)
 	, m_maxSize(0)
 {
@@ -120,6 +123,29 @@ void IDownloader::setMaxSize(size_t maxSize)
 	m_maxSize = maxSize;
 }
 
+/**
+ * Get the If-Modified-Since time. (-1 == unconditional)
+ * @return If-Modified-Since time.
+ */
+time_t IDownloader::ifModifiedSince(void) const
+{
+	return m_ifModifiedSince;
+}
+
+/**
+ * Set the If-Modified-Since time. (-1 == unconditional)
+ *
+ * If set, download() returns 304 (Not Modified) without
+ * any data if the file hasn't changed since this time.
+ *
+ * @param ifModifiedSince If-Modified-Since time.
+ */
+void IDownloader::setIfModifiedSince(time_t ifModifiedSince)
+{
+	assert(!m_inProgress);
+	m_ifModifiedSince = ifModifiedSince;
+}
+
 /** Data accessors. **/
 
 /**
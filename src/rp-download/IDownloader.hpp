@@ -81,6 +81,22 @@ class IDownloader
 		 */
 		void setMaxSize(size_t maxSize);
 
+		/**
+		 * Get the If-Modified-Since time. (-1 == unconditional)
+		 * @return If-Modified-Since time.
+		 */
+		time_t ifModifiedSince(void) const;
+
+		/**
+		 * Set the If-Modified-Since time. (-1 == unconditional)
+		 *
+		 * If set, download() returns 304 (Not Modified) without
+		 * any data if the file hasn't changed since this time.
+		 *
+		 * @param ifModifiedSince If-Modified-Since time.
+		 */
+		void setIfModifiedSince(time_t ifModifiedSince);
+
 	public:
 		/** Data accessors. **/
 
@@ -110,7 +126,7 @@ class IDownloader
 	public:
 		/**
 		 * Download the file.
-		 * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
+		 * @return 0 on success; 304 if not modified (see setIfModifiedSince()); negative POSIX error code, positive HTTP status code on error.
 		 */
 		virtual int download(void) = 0;
 
@@ -135,6 +151,8 @@ class IDownloader
 
 		// Last-Modified time.
 		time_t m_mtime;
+		// If-Modified-Since time. (-1 == unconditional)
+		time_t m_ifModifiedSince;
 
 		bool m_inProgress;	// Set when downloading.
 		size_t m_maxSize;	// Maximum buffer size. (0 == unlimited)
@@ -37,7 +37,7 @@ WinInetDownloader::WinInetDownloader(const tstring &url)
 
 /**
  * Download the file.
- * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
+ * @return 0 on success; 304 if not modified (see setIfModifiedSince()); negative POSIX error code, positive HTTP status code on error.
  */
 int WinInetDownloader::download(void)
 {
@@ -80,12 +80,28 @@ int WinInetDownloader::download(void)
 		}
 	}
 
+	// If-Modified-Since header.
+	TCHAR szHeaders[64];
+	szHeaders[0] = _T('\0');
+	if (m_ifModifiedSince >= 0) {
+		SYSTEMTIME st_ims;
+		TCHAR szTime[INTERNET_RFC1123_BUFSIZE+1];
+		UnixTimeToSystemTime(m_ifModifiedSince, &st_ims);
+		if (InternetTimeFromSystemTime(&st_ims, INTERNET_RFC1123_FORMAT, szTime, sizeof(szTime))) {
+			_sntprintf(szHeaders, _countof(szHeaders), _T("If-Modified-Since: %s\r\n"), szTime);
+			szHeaders[_countof(szHeaders)-1] = _T('\0');
+			// Make sure the request goes to the server instead of
+			// being answered from WinInet's own cache.
+			dwFlags |= INTERNET_FLAG_RELOAD;
+		}
+	}
+
 	// Request the URL.
 	HINTERNET hURL = InternetOpenUrl(
 		hConnection,	// hInternet
 		m_url.c_str(),	// lpszUrl (Latin-1 characters only!)
-		nullptr,	// lpszHeaders
-		0,		// dwHeaderLength
+		(szHeaders[0] != _T('\0') ? szHeaders : nullptr),	// lpszHeaders
+		(szHeaders[0] != _T('\0') ? static_cast<DWORD>(-1L) : 0),	// dwHeaderLength
 		dwFlags,	// dwFlags
 		reinterpret_cast<DWORD_PTR>(this));	// dwContext
 	if (!hURL) {
@@ -112,8 +128,14 @@ int WinInetDownloader::download(void)
 		// Received DWORD.
 		if (dwBufferLength == static_cast<DWORD>(sizeof(dwHttpStatusCode))) {
 			// Length is valid.
-			// We're only accepting HTTP 200.
-			if (dwHttpStatusCode != 200) {
+			// We're only accepting HTTP 200, plus HTTP 304
+			// if If-Modified-Since was set.
+			if (dwHttpStatusCode == 304 && m_ifModifiedSince >= 0) {
+				// Not modified.
+				InternetCloseHandle(hURL);
+				InternetCloseHandle(hConnection);
+				return 304;
+			} else if (dwHttpStatusCode != 200) {
 				// Unexpected status code.
 				InternetCloseHandle(hURL);
 				InternetCloseHandle(hConnection);
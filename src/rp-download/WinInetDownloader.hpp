@@ -27,7 +27,7 @@ class WinInetDownloader final : public IDownloader
 	public:
 		/**
 		 * Download the file.
-		 * @return 0 on success; negative POSIX error code, positive HTTP status code on error.
+		 * @return 0 on success; 304 if not modified (see setIfModifiedSince()); negative POSIX error code, positive HTTP status code on error.
 		 */
 		int download(void) final;
 };
@@ -13,10 +13,13 @@
 #include "librpsecure/os-secure.h"
 
 // C includes.
-#ifndef _WIN32
+#ifdef _WIN32
+# include <sys/utime.h>
+#else /* !_WIN32 */
 # include <fcntl.h>
 # include <sys/stat.h>
 # include <unistd.h>
+# include <utime.h>
 #endif /* _WIN32 */
 
 #ifndef __S_ISTYPE
@@ -35,10 +38,14 @@
 #include <cstdio>
 
 // C++ includes.
+#include <deque>
 #include <memory>
+#include <vector>
+using std::deque;
 using std::string;
 using std::tstring;
 using std::unique_ptr;
+using std::vector;
 
 #ifdef _WIN32
 // libwin32common
@@ -67,7 +74,9 @@ using std::unique_ptr;
 # include "WinInetDownloader.hpp"
 #else
 # include "CurlDownloader.hpp"
+# include "CurlMultiDownloader.hpp"
 #endif
+#include "CacheIndex.hpp"
 #include "SetFileOriginInfo.hpp"
 using namespace RpDownload;
 
@@ -77,12 +86,34 @@ using namespace RpDownload;
 static const TCHAR *argv0 = nullptr;
 static bool verbose = false;
 
+// Maximum number of simultaneous transfers in batch mode.
+#define MAX_TRANSFERS 16
+
+// Cache policy. (0 == unlimited / disabled)
+static unsigned int revalidateDays = 0;	// Revalidate files older than this many days.
+static off64_t cacheMaxSize = 0;	// Maximum cache size, in bytes.
+static unsigned int cacheMaxEntries = 0;	// Maximum number of cache files.
+
+// Minimum interval between cache eviction scans, in seconds.
+#define EVICT_INTERVAL 3600
+// In batch mode, also scan after this many requests have been handled.
+#define EVICT_FILE_COUNT 1024
+// Eviction timestamp filename, relative to the cache directory.
+static const TCHAR evict_stamp_filename[] = _T("rp-download.evict");
+
 /**
  * Show command usage.
  */
 static void show_usage(void)
 {
-	_ftprintf(stderr, _T("Syntax: %s [-v] [-f] cache_key\n"), argv0);
+	_ftprintf(stderr, _T("Syntax: %s [-v] [-f] [-r days] [-s size] [-n entries] cache_key\n"), argv0);
+	_ftprintf(stderr, _T("        %s [-v] [-f] [-r days] [-s size] [-n entries] [-j transfers] -b\n"), argv0);
+	_ftprintf(stderr, _T("\n"));
+	_ftprintf(stderr, _T("-b: Batch mode. Cache keys are read from stdin, one per line.\n"));
+	_ftprintf(stderr, _T("-j: Maximum number of simultaneous transfers in batch mode. (1-%d, default is 4)\n"), MAX_TRANSFERS);
+	_ftprintf(stderr, _T("-r: Revalidate cached files older than this many days. (0 == never, default)\n"));
+	_ftprintf(stderr, _T("-s: Maximum cache size, in MiB. (0 == unlimited, default)\n"));
+	_ftprintf(stderr, _T("-n: Maximum number of cached files. (0 == unlimited, default)\n"));
 }
 
 /**
@@ -288,178 +319,47 @@ int rmkdir(const tstring &path)
 }
 
 /**
- * rp-download: Download an image from a supported online database.
- * @param cache_key Cache key, e.g. "ds/cover/US/ADAE.png"
- * @return 0 on success; non-zero on error.
- *
- * TODO:
- * - More error codes based on the error.
+ * Cache file information for a single download.
  */
-int RP_C_API _tmain(int argc, TCHAR *argv[])
-{
-	// Create a downloader based on OS:
-	// - Linux: CurlDownloader
-	// - Windows: WinInetDownloader
-
-	// Syntax: rp-download cache_key
-	// Example: rp-download ds/coverM/US/ADAE.png
-
-	// If http_proxy or https_proxy are set, they will be used
-	// by the downloader code if supported.
-
-	// Reduce process integrity, if available.
-	rp_secure_reduce_integrity();
-
-	// Set OS-specific security options.
-	rp_secure_param_t param;
-#if defined(_WIN32)
-	param.bHighSec = FALSE;
-#elif defined(HAVE_SECCOMP)
-	static const int syscall_wl[] = {
-		// Syscalls used by rp-download.
-		// TODO: Add more syscalls.
-		// FIXME: glibc-2.31 uses 64-bit time syscalls that may not be
-		// defined in earlier versions, including Ubuntu 14.04.
-
-		// NOTE: Special case for clone(). If it's the first syscall
-		// in the list, it has a parameter restriction added that
-		// ensures it can only be used to create threads.
-		SCMP_SYS(clone),
-		// Other multi-threading syscalls
-		SCMP_SYS(set_robust_list),
-
-		SCMP_SYS(access), SCMP_SYS(clock_gettime),
-#if defined(__SNR_clock_gettime64) || defined(__NR_clock_gettime64)
-		SCMP_SYS(clock_gettime64),
-#endif /* __SNR_clock_gettime64 || __NR_clock_gettime64 */
-		SCMP_SYS(close),
-		SCMP_SYS(fcntl),     SCMP_SYS(fcntl64),		// gcc profiling
-		SCMP_SYS(fsetxattr),
-		SCMP_SYS(fstat),     SCMP_SYS(fstat64),		// __GI___fxstat() [printf()]
-		SCMP_SYS(fstatat64), SCMP_SYS(newfstatat),	// Ubuntu 19.10 (32-bit)
-		SCMP_SYS(futex),
-		SCMP_SYS(getdents), SCMP_SYS(getdents64),
-		SCMP_SYS(getppid),	// for bubblewrap verification
-		SCMP_SYS(getrusage),
-		SCMP_SYS(gettimeofday),	// 32-bit only?
-		SCMP_SYS(getuid),	// TODO: Only use geteuid()?
-		SCMP_SYS(lseek), SCMP_SYS(_llseek),
-		//SCMP_SYS(lstat), SCMP_SYS(lstat64),	// Not sure if used?
-		SCMP_SYS(mkdir), SCMP_SYS(mmap), SCMP_SYS(mmap2),
-		SCMP_SYS(munmap),
-		SCMP_SYS(open),		// Ubuntu 16.04
-		SCMP_SYS(openat),	// glibc-2.31
-#if defined(__SNR_openat2)
-		SCMP_SYS(openat2),	// Linux 5.6
-#elif defined(__NR_openat2)
-		__NR_openat2,		// Linux 5.6
-#endif /* __SNR_openat2 || __NR_openat2 */
-		SCMP_SYS(poll), SCMP_SYS(select),
-		SCMP_SYS(stat), SCMP_SYS(stat64),
-		SCMP_SYS(unlink),	// to delete expired cache files
-		SCMP_SYS(utimensat),
-
-#if defined(__SNR_statx) || defined(__NR_statx)
-		SCMP_SYS(getcwd),	// called by glibc's statx()
-		SCMP_SYS(statx),
-#endif /* __SNR_statx || __NR_statx */
-
-#ifndef NDEBUG
-		// Needed for assert() on some systems.
-		SCMP_SYS(uname),
-#endif /* NDEBUG */
-
-		// glibc ncsd
-		// TODO: Restrict connect() to AF_UNIX.
-		SCMP_SYS(connect), SCMP_SYS(recvmsg), SCMP_SYS(sendto),
-		SCMP_SYS(sendmmsg),	// getaddrinfo() (32-bit only?)
-		SCMP_SYS(ioctl),	// getaddrinfo() (32-bit only?) [FIXME: Filter for FIONREAD]
-		SCMP_SYS(recvfrom),	// getaddrinfo() (32-bit only?)
-
-		// Needed for network access on Kubuntu 20.04 for some reason.
-		SCMP_SYS(getpid), SCMP_SYS(uname),
-
-		// cURL and OpenSSL
-		SCMP_SYS(bind),		// getaddrinfo() [curl_thread_create_thunk(), curl-7.68.0]
-#ifdef __SNR_getrandom
-		SCMP_SYS(getrandom),
-#endif /* __SNR_getrandom */
-		SCMP_SYS(getpeername), SCMP_SYS(getsockname),
-		SCMP_SYS(getsockopt), SCMP_SYS(madvise), SCMP_SYS(mprotect),
-		SCMP_SYS(setsockopt), SCMP_SYS(socket),
-		SCMP_SYS(socketcall),	// FIXME: Enhanced filtering? [cURL+GnuTLS only?]
-		SCMP_SYS(socketpair), SCMP_SYS(sysinfo),
-
-		// libnss_resolve.so (systemd-resolved)
-		SCMP_SYS(geteuid),
-		SCMP_SYS(sendmsg),	// libpthread.so [_nss_resolve_gethostbyname4_r() from libnss_resolve.so]
-
-		-1	// End of whitelist
-	};
-	param.syscall_wl = syscall_wl;
-#elif defined(HAVE_PLEDGE)
-	// Promises:
-	// - stdio: General stdio functionality.
-	// - rpath: Read from ~/.config/rom-properties/ and ~/.cache/rom-properties/
-	// - wpath: Write to ~/.cache/rom-properties/
-	// - cpath: Create ~/.cache/rom-properties/ if it doesn't exist.
-	// - inet: Internet access.
-	// - fattr: Modify file attributes, e.g. mtime.
-	// - dns: Resolve hostnames.
-	// - getpw: Get user's home directory if HOME is empty.
-	param.promises = "stdio rpath wpath cpath inet fattr dns getpw";
-#elif defined(HAVE_TAME)
-	// NOTE: stdio includes fattr, e.g. utimes().
-	param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_WPATH | TAME_CPATH |
-	                   TAME_INET | TAME_DNS | TAME_GETPW;
-#else
-	param.dummy = 0;
-#endif
-	rp_secure_enable(param);
-
-	// Store argv[0] globally.
-	argv0 = argv[0];
-
-	if (argc < 2) {
-		show_usage();
-		return EXIT_FAILURE;
-	}
-
-	// Check for arguments. (simple non-getopt version)
-	bool force = false;
-	int optind = 1;
-	for (; optind < argc; optind++) {
-		if (!argv[optind] || argv[optind][0] != '-') {
-			// End of options.
-			break;
-		}
+struct CacheJob {
+	const TCHAR *cache_key;		// Cache key (not owned by this struct)
+	tstring cache_filename;		// Cache filename
+	TCHAR full_url[256];		// Full URL
+	FILE *f_out;			// Cache file (negative hit if the download fails)
+	time_t ifModifiedSince;		// If >= 0, the existing cache file is being revalidated.
+};
 
-		// Allow multiple options in one argument, e.g. '-vf'.
-		for (int i = 1; argv[optind][i] != '\0'; i++) {
-			switch (argv[optind][i]) {
-				case 'v':
-					// Verbose mode is enabled.
-					verbose = true;
-					break;
-				case 'f':
-					// Force download is enabled.
-					force = true;
-					break;
-				default:
-					// Invalid parameter.
-					show_error(_T("Unrecognized option: %c"), argv[optind][i]);
-					show_usage();
-					return EXIT_FAILURE;
-			}
-		}
-	}
+/**
+ * Result of prepareCacheJob().
+ */
+enum PrepareResult {
+	PREPARE_DOWNLOAD,	// File needs to be downloaded.
+	PREPARE_CACHED,		// File is already cached.
+	PREPARE_FAILED,		// Error, or negative cache hit.
+};
 
-	if (optind >= argc) {
-		show_error(_T("No cache key specified."));
-		show_usage();
-		return EXIT_FAILURE;
-	}
-	const TCHAR *const cache_key = argv[optind];
+/**
+ * Prepare a cache key for downloading.
+ *
+ * This validates the cache key, determines the full URL,
+ * and checks the cache file. If the file needs to be downloaded,
+ * the cache file is opened so it can be used as a negative hit
+ * if the download fails.
+ *
+ * If the file is cached but older than the revalidation period,
+ * job.ifModifiedSince is set to its mtime and the cache file is
+ * not opened; finishCacheJob() will replace it if it was modified.
+ *
+ * @param cache_key	[in] Cache key, e.g. "ds/cover/US/ADAE.png"
+ * @param force		[in] If true, redownload the file even if it's cached.
+ * @param job		[out] Cache job.
+ * @return PrepareResult
+ */
+static PrepareResult prepareCacheJob(const TCHAR *cache_key, bool force, CacheJob &job)
+{
+	job.cache_key = cache_key;
+	job.f_out = nullptr;
+	job.ifModifiedSince = -1;
 
 	// Check the cache key prefix. The prefix indicates the system
 	// and identifies the online database used.
@@ -482,14 +382,14 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		// - Does not contain any slashes.
 		// - First slash is either the first or the last character.
 		SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
-		return EXIT_FAILURE;
+		return PREPARE_FAILED;
 	}
 
 	const ptrdiff_t prefix_len = (slash_pos - cache_key);
 	if (prefix_len <= 0) {
 		// Empty prefix.
 		SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
-		return EXIT_FAILURE;
+		return PREPARE_FAILED;
 	}
 
 	// Cache key must include a lowercase file extension.
@@ -497,14 +397,14 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 	if (!lastdot) {
 		// No dot...
 		SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
-		return EXIT_FAILURE;
+		return PREPARE_FAILED;
 	}
 	if (_tcscmp(lastdot, _T(".png")) != 0 &&
 	    _tcscmp(lastdot, _T(".jpg")) != 0)
 	{
 		// Not a supported file extension.
 		SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
-		return EXIT_FAILURE;
+		return PREPARE_FAILED;
 	}
 
 	// urlencode the cache key.
@@ -513,14 +413,14 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 	slash_pos = _tcschr(cache_key_urlencode.data(), _T('/'));
 
 	// Determine the full URL based on the cache key.
-	TCHAR full_url[256];
+	TCHAR *const full_url = job.full_url;
 	if ((prefix_len == 3 && !_tcsncmp(cache_key, _T("wii"), 3)) ||
 	    (prefix_len == 4 && !_tcsncmp(cache_key, _T("wiiu"), 4)) ||
 	    (prefix_len == 3 && !_tcsncmp(cache_key, _T("3ds"), 3)) ||
 	    (prefix_len == 2 && !_tcsncmp(cache_key, _T("ds"), 2)))
 	{
 		// Wii, Wii U, Nintendo 3DS, Nintendo DS
-		_sntprintf(full_url, _countof(full_url),
+		_sntprintf(full_url, _countof(job.full_url),
 			_T("https://art.gametdb.com/%s"), cache_key_urlencode.c_str());
 	} else if (prefix_len == 6 && !_tcsncmp(cache_key, _T("amiibo"), 6)) {
 		// amiibo.
@@ -529,11 +429,11 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		if (filename_len <= 4) {
 			// Can't remove the extension...
 			SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
-			return EXIT_FAILURE;
+			return PREPARE_FAILED;
 		}
 		filename_len -= 4;
 
-		_sntprintf(full_url, _countof(full_url),
+		_sntprintf(full_url, _countof(job.full_url),
 			_T("https://amiibo.life/nfc/%.*s/image"),
 			static_cast<int>(filename_len), slash_pos+1);
 	} else if ((prefix_len == 3 && !_tcsncmp(cache_key, _T("gba"), 3)) ||
@@ -541,12 +441,12 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		   (prefix_len == 4 && (!_tcsncmp(cache_key, _T("snes"), 4) || !_tcsncmp(cache_key, _T("ngpc"), 4)))) {
 		// Game Boy, Game Boy Color, Game Boy Advance, Super NES,
 		// Neo Geo Pocket, Neo Geo Pocket Color
-		_sntprintf(full_url, _countof(full_url),
+		_sntprintf(full_url, _countof(job.full_url),
 			_T("https://rpdb.gerbilsoft.com/%s"), cache_key_urlencode.c_str());
 	} else {
 		// Prefix is not supported.
 		SHOW_ERROR(_T("Cache key '%s' has an unsupported prefix."), cache_key);
-		return EXIT_FAILURE;
+		return PREPARE_FAILED;
 	}
 
 	if (verbose) {
@@ -559,15 +459,16 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		// Cache directory is invalid...
 		// This may happen if bubblewrap is in use.
 		SHOW_ERROR(_T("Unable to access cache directory. Check the sandbox environment!"));
-		return EXIT_FAILURE;
+		return PREPARE_FAILED;
 	}
 
 	// Get the cache filename.
-	tstring cache_filename = LibCacheCommon::getCacheFilename(cache_key);
+	tstring &cache_filename = job.cache_filename;
+	cache_filename = LibCacheCommon::getCacheFilename(cache_key);
 	if (cache_filename.empty()) {
 		// Invalid cache filename.
 		SHOW_ERROR(_T("Cache key '%s' is invalid."), cache_key);
-		return EXIT_FAILURE;
+		return PREPARE_FAILED;
 	}
 	if (verbose) {
 		_ftprintf(stderr, _T("Cache Filename: %s\n"), cache_filename.c_str());
@@ -598,7 +499,7 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 				// Less than a week old.
 				if (likely(!force)) {
 					SHOW_INFO(_T("Negative cache file for '%s' has not expired; not redownloading."), cache_key);
-					return EXIT_FAILURE;
+					return PREPARE_FAILED;
 				} else {
 					SHOW_INFO(_T("Negative cache file for '%s' has not expired, but -f was specified. Redownloading anyway."), cache_key);
 				}
@@ -608,19 +509,30 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 			// Delete the cache file and try to download it again.
 			if (_tremove(cache_filename.c_str()) != 0) {
 				SHOW_ERROR(_T("Error deleting negative cache file for '%s': %s"), cache_key, _tcserror(errno));
-				return EXIT_FAILURE;
+				return PREPARE_FAILED;
 			}
 		} else if (filesize > 0) {
 			// File is larger than 0 bytes, which indicates
 			// it was previously cached successfully
 			if (likely(!force)) {
+				// The mtime is the server's Last-Modified time,
+				// or the last time the file was revalidated.
+				const time_t systime = time(nullptr);
+				if (revalidateDays > 0 &&
+				    (systime - filemtime) >= (static_cast<time_t>(revalidateDays) * 86400))
+				{
+					SHOW_INFO(_T("Cache file for '%s' is older than %u day%s; revalidating."),
+						cache_key, revalidateDays, (revalidateDays == 1 ? _T("") : _T("s")));
+					job.ifModifiedSince = filemtime;
+					return PREPARE_DOWNLOAD;
+				}
 				SHOW_INFO(_T("Cache file for '%s' is already downloaded."), cache_key);
-				return EXIT_SUCCESS;
+				return PREPARE_CACHED;
 			} else {
 				SHOW_INFO(_T("Cache file for '%s' is already downloaded, but -f was specified. Redownloading anyway."), cache_key);
 				if (_tremove(cache_filename.c_str()) != 0) {
 					SHOW_ERROR(_T("Error deleting cache file for '%s': %s"), cache_key, _tcserror(errno));
-					return EXIT_FAILURE;
+					return PREPARE_FAILED;
 				}
 			}
 		}
@@ -630,57 +542,159 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 		int ret = rmkdir(cache_filename.c_str());
 		if (ret != 0) {
 			SHOW_ERROR(_T("Error creating directory structure: %s"), _tcserror(-ret));
-			return EXIT_FAILURE;
+			return PREPARE_FAILED;
 		}
 	} else {
 		// Other error.
 		SHOW_ERROR(_T("Error checking cache file for '%s': %s"), cache_key, _tcserror(-ret));
-		return EXIT_FAILURE;
+		return PREPARE_FAILED;
 	}
 
-	// Attempt to download the file.
-	// TODO: IDownloaderFactory?
+	// Open the cache file now so we can use it as a negative hit
+	// if the download fails.
+	job.f_out = _tfopen(cache_filename.c_str(), _T("wb"));
+	if (!job.f_out) {
+		// Error opening the cache file.
+		SHOW_ERROR(_T("Error writing to cache file: %s"), _tcserror(errno));
+		return PREPARE_FAILED;
+	}
+
+	return PREPARE_DOWNLOAD;
+}
+
+/**
+ * Show a download error message. (verbose mode only)
+ * @param ret Return value from the downloader.
+ */
+static void show_download_error(int ret)
+{
+	if (!verbose)
+		return;
+
+	if (ret < 0) {
+		// POSIX error code
+		show_error(_T("Error downloading file: %s"), _tcserror(-ret));
+	} else /*if (ret > 0)*/ {
+		// HTTP status code
+		const TCHAR *msg = http_status_string(ret);
+		if (msg) {
+			show_error(_T("Error downloading file: HTTP %d %s"), ret, msg);
+		} else {
+			show_error(_T("Error downloading file: HTTP %d"), ret);
+		}
+	}
+}
+
+/**
+ * Finish revalidating a cache file after the download has completed.
+ *
+ * If the file was modified, it's replaced atomically, so other
+ * processes never see a partially-written file. Otherwise, or if
+ * the request failed, the existing file is kept and its mtime is
+ * updated, so it won't be revalidated again until the next period.
+ *
+ * @param job		[in] Cache job.
+ * @param downloader	[in] Downloader used for this cache job.
+ * @param ret		[in] Return value from the downloader.
+ * @return EXIT_SUCCESS on success; EXIT_FAILURE on error.
+ */
+static int finishRevalidation(CacheJob &job, const IDownloader *downloader, int ret)
+{
+	const TCHAR *const cache_filename = job.cache_filename.c_str();
+	if (ret == 304) {
+		// Not modified. Only update the timestamps.
+		SHOW_INFO(_T("Cache file for '%s' has not been modified."), job.cache_key);
+		_tutime(cache_filename, nullptr);
+		return EXIT_SUCCESS;
+	} else if (ret != 0 || downloader->dataSize() <= 0) {
+		// Error downloading the file.
+		// The cached file is still usable, so keep it.
+		if (ret != 0) {
+			show_download_error(ret);
+		} else {
+			SHOW_ERROR(_T("Error downloading file: 0 bytes received"));
+		}
+		_tutime(cache_filename, nullptr);
+		return EXIT_SUCCESS;
+	}
+
+	// Write the new file to a temporary file, then replace the cache file.
+	TCHAR tmp_suffix[32];
+	_sntprintf(tmp_suffix, _countof(tmp_suffix), _T(".%u.tmp"),
 #ifdef _WIN32
-	unique_ptr<IDownloader> m_downloader(new WinInetDownloader());
+		static_cast<unsigned int>(GetCurrentProcessId())
 #else /* !_WIN32 */
-	unique_ptr<IDownloader> m_downloader(new CurlDownloader());
+		static_cast<unsigned int>(getpid())
+#endif /* _WIN32 */
+		);
+	const tstring tmp_filename = job.cache_filename + tmp_suffix;
+	FILE *const f_tmp = _tfopen(tmp_filename.c_str(), _T("wb"));
+	if (!f_tmp) {
+		// Error opening the temporary file. Keep the old file.
+		SHOW_ERROR(_T("Error writing to cache file: %s"), _tcserror(errno));
+		_tutime(cache_filename, nullptr);
+		return EXIT_SUCCESS;
+	}
+
+	const size_t dataSize = downloader->dataSize();
+	const size_t size = fwrite(downloader->data(), 1, dataSize, f_tmp);
+	fflush(f_tmp);
+	if (size == dataSize) {
+		// Save the file origin information.
+#ifdef _WIN32
+		setFileOriginInfo(f_tmp, tmp_filename.c_str(), job.full_url, downloader->mtime());
+#else /* !_WIN32 */
+		setFileOriginInfo(f_tmp, job.full_url, downloader->mtime());
 #endif /* _WIN32 */
+	}
+	const bool ok = (fclose(f_tmp) == 0 && size == dataSize);
 
-	// Open the cache file now so we can use it as a negative hit
-	// if the download fails.
-	FILE *f_out = _tfopen(cache_filename.c_str(), _T("wb"));
-	if (!f_out) {
-		// Error opening the cache file.
+#ifdef _WIN32
+	const bool replaced = ok && MoveFileEx(tmp_filename.c_str(), cache_filename, MOVEFILE_REPLACE_EXISTING);
+#else /* !_WIN32 */
+	const bool replaced = ok && (_trename(tmp_filename.c_str(), cache_filename) == 0);
+#endif /* _WIN32 */
+	if (!replaced) {
+		// Error replacing the cache file. Keep the old file.
 		SHOW_ERROR(_T("Error writing to cache file: %s"), _tcserror(errno));
-		return EXIT_FAILURE;
+		_tremove(tmp_filename.c_str());
+		_tutime(cache_filename, nullptr);
+		return EXIT_SUCCESS;
 	}
 
-	// TODO: Configure this somewhere?
-	m_downloader->setMaxSize(4*1024*1024);
+	SHOW_INFO(_T("Updated cache file for '%s': %u byte%s."),
+		job.cache_key, static_cast<unsigned int>(dataSize),
+		(unlikely(dataSize == 1) ? _T("") : _T("s")));
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Finish a cache job after the download has completed.
+ * The downloaded data is written to the cache file,
+ * and the cache file is closed.
+ * @param job		[in] Cache job.
+ * @param downloader	[in] Downloader used for this cache job.
+ * @param ret		[in] Return value from the downloader.
+ * @return EXIT_SUCCESS on success; EXIT_FAILURE on error.
+ */
+static int finishCacheJob(CacheJob &job, const IDownloader *downloader, int ret)
+{
+	if (job.ifModifiedSince >= 0) {
+		// Revalidating an existing cache file.
+		return finishRevalidation(job, downloader, ret);
+	}
+
+	FILE *const f_out = job.f_out;
+	job.f_out = nullptr;
 
-	m_downloader->setUrl(full_url);
-	ret = m_downloader->download();
 	if (ret != 0) {
 		// Error downloading the file.
-		if (verbose) {
-			if (ret < 0) {
-				// POSIX error code
-				show_error(_T("Error downloading file: %s"), _tcserror(-ret));
-			} else /*if (ret > 0)*/ {
-				// HTTP status code
-				const TCHAR *msg = http_status_string(ret);
-				if (msg) {
-					show_error(_T("Error downloading file: HTTP %d %s"), ret, msg);
-				} else {
-					show_error(_T("Error downloading file: HTTP %d"), ret);
-				}
-			}
-		}
+		show_download_error(ret);
 		fclose(f_out);
 		return EXIT_FAILURE;
 	}
 
-	if (m_downloader->dataSize() <= 0) {
+	if (downloader->dataSize() <= 0) {
 		// No data downloaded...
 		SHOW_ERROR(_T("Error downloading file: 0 bytes received"));
 		fclose(f_out);
@@ -689,22 +703,651 @@ int RP_C_API _tmain(int argc, TCHAR *argv[])
 
 	// Write the file to the cache.
 	// TODO: Verify the size.
-	const size_t dataSize = m_downloader->dataSize();
-	size_t size = fwrite(m_downloader->data(), 1, dataSize, f_out);
+	const size_t dataSize = downloader->dataSize();
+	size_t size = fwrite(downloader->data(), 1, dataSize, f_out);
+	RP_UNUSED(size);
 	fflush(f_out);
 
 	// Save the file origin information.
 #ifdef _WIN32
 	// TODO: Figure out how to setFileOriginInfo() on Windows using an open file handle.
-	setFileOriginInfo(f_out, cache_filename.c_str(), full_url, m_downloader->mtime());
+	setFileOriginInfo(f_out, job.cache_filename.c_str(), job.full_url, downloader->mtime());
 #else /* !_WIN32 */
-	setFileOriginInfo(f_out, full_url, m_downloader->mtime());
+	setFileOriginInfo(f_out, job.full_url, downloader->mtime());
 #endif /* _WIN32 */
 	fclose(f_out);
 
 	// Success.
 	SHOW_INFO(_T("Downloaded cache file for '%s': %u byte%s."),
-		cache_key, static_cast<unsigned int>(dataSize),
+		job.cache_key, static_cast<unsigned int>(dataSize),
 		unlikely(dataSize == 1) ? "" : "s");
 	return EXIT_SUCCESS;
 }
+
+/**
+ * Evict the least-recently-used cache files if the cache
+ * is over its size or entry limits.
+ *
+ * Scanning the cache directory is relatively expensive, so this
+ * is only done once per EVICT_INTERVAL, based on the mtime of a
+ * timestamp file in the cache directory, unless force is set.
+ *
+ * @param force If true, scan the cache even if the interval hasn't elapsed.
+ * @return True if the cache was scanned; false if not.
+ */
+static bool evictCache(bool force)
+{
+	if (cacheMaxSize <= 0 && cacheMaxEntries == 0) {
+		// No limits.
+		return false;
+	}
+
+	const string &cache_dir_u8 = LibCacheCommon::getCacheDirectory();
+	if (cache_dir_u8.empty()) {
+		// Cache directory is invalid.
+		return false;
+	}
+#if defined(_WIN32) && defined(_UNICODE)
+	// Convert the cache directory from UTF-8.
+	tstring cache_dir;
+	const int cchWide = MultiByteToWideChar(CP_UTF8, 0,
+		cache_dir_u8.data(), static_cast<int>(cache_dir_u8.size()), nullptr, 0);
+	if (cchWide <= 0) {
+		return false;
+	}
+	cache_dir.resize(cchWide);
+	MultiByteToWideChar(CP_UTF8, 0,
+		cache_dir_u8.data(), static_cast<int>(cache_dir_u8.size()), &cache_dir[0], cchWide);
+#else /* !_WIN32 || !_UNICODE */
+	const tstring &cache_dir = cache_dir_u8;
+#endif /* _WIN32 && _UNICODE */
+
+	tstring stamp_filename = cache_dir;
+	if (stamp_filename[stamp_filename.size()-1] != DIR_SEP_CHR) {
+		stamp_filename += DIR_SEP_CHR;
+	}
+	stamp_filename += evict_stamp_filename;
+
+	if (!force) {
+		off64_t filesize = 0;
+		time_t filemtime = 0;
+		if (get_file_size_and_mtime(stamp_filename.c_str(), &filesize, &filemtime) == 0 &&
+		    (time(nullptr) - filemtime) < EVICT_INTERVAL)
+		{
+			// The cache was scanned recently.
+			return false;
+		}
+	}
+
+	// Update the timestamp before scanning so other
+	// rp-download processes don't scan at the same time.
+	FILE *const f_stamp = _tfopen(stamp_filename.c_str(), _T("ab"));
+	if (!f_stamp) {
+		// Cache directory probably doesn't exist yet.
+		return false;
+	}
+	fclose(f_stamp);
+	_tutime(stamp_filename.c_str(), nullptr);
+
+	CacheIndex index;
+	index.scan(cache_dir);
+	const unsigned int deleted = index.evict(cacheMaxSize, cacheMaxEntries);
+	if (deleted > 0) {
+		SHOW_INFO(_T("Evicted %u cache file%s."), deleted,
+			(unlikely(deleted == 1) ? _T("") : _T("s")));
+	}
+	return true;
+}
+
+/**
+ * Download a single cache key.
+ * @param downloader	[in] Downloader.
+ * @param cache_key	[in] Cache key, e.g. "ds/cover/US/ADAE.png"
+ * @param force		[in] If true, redownload the file even if it's cached.
+ * @return EXIT_SUCCESS on success; EXIT_FAILURE on error.
+ */
+static int downloadCacheKey(IDownloader *downloader, const TCHAR *cache_key, bool force)
+{
+	CacheJob job;
+	switch (prepareCacheJob(cache_key, force, job)) {
+		case PREPARE_DOWNLOAD:
+			break;
+		case PREPARE_CACHED:
+			return EXIT_SUCCESS;
+		case PREPARE_FAILED:
+		default:
+			return EXIT_FAILURE;
+	}
+
+	downloader->setUrl(job.full_url);
+	downloader->setIfModifiedSince(job.ifModifiedSince);
+	const int ret = downloader->download();
+	return finishCacheJob(job, downloader, ret);
+}
+
+/**
+ * Print the result of a batch mode request.
+ *
+ * Batch mode protocol:
+ * - Input: One cache key per line on stdin.
+ * - Output: One line per cache key on stdout: "%d %s\n",
+ *   where %d is 0 on success or 1 on error, and %s is the
+ *   cache key as received.
+ *
+ * Results are not necessarily in the same order as requests.
+ *
+ * @param ret EXIT_SUCCESS or EXIT_FAILURE
+ * @param cache_key Cache key
+ */
+static void print_batch_result(int ret, const TCHAR *cache_key)
+{
+	_tprintf(_T("%d %s\n"), (ret == EXIT_SUCCESS ? 0 : 1), cache_key);
+	fflush(stdout);
+}
+
+#ifdef _WIN32
+/**
+ * Batch mode: Download cache keys read from stdin. (sequential)
+ *
+ * WinInet doesn't have an equivalent to the cURL multi interface,
+ * so cache keys are downloaded one at a time. WinInet maintains
+ * its own per-process connection cache, so connections are still
+ * reused between downloads.
+ *
+ * @param downloader	[in] Downloader.
+ * @param force		[in] If true, redownload files even if they're cached.
+ * @param maxTransfers	[in] Maximum number of simultaneous transfers. (ignored)
+ * @return EXIT_SUCCESS on success; EXIT_FAILURE on error.
+ */
+static int batch_download(IDownloader *downloader, bool force, unsigned int maxTransfers)
+{
+	RP_UNUSED(maxTransfers);
+
+	TCHAR line[1024];
+	unsigned int doneSinceEvict = 0;
+	while (_fgetts(line, _countof(line), stdin) != nullptr) {
+		// Remove the trailing newline.
+		size_t len = _tcslen(line);
+		while (len > 0 && (line[len-1] == _T('\n') || line[len-1] == _T('\r'))) {
+			line[--len] = _T('\0');
+		}
+		if (len == 0)
+			continue;
+
+		print_batch_result(downloadCacheKey(downloader, line, force), line);
+
+		// Check if the cache needs to be trimmed.
+		doneSinceEvict++;
+		if (evictCache(doneSinceEvict >= EVICT_FILE_COUNT)) {
+			doneSinceEvict = 0;
+		}
+	}
+	return EXIT_SUCCESS;
+}
+#else /* !_WIN32 */
+/**
+ * Batch mode transfer slot.
+ */
+struct BatchSlot {
+	CurlDownloader downloader;
+	CacheJob job;
+	tstring cache_key;
+	unsigned int duplicates;	// Number of duplicate requests for this cache key.
+	bool busy;
+};
+
+/**
+ * Batch mode: Download cache keys read from stdin. (parallel)
+ *
+ * Up to maxTransfers cache keys are downloaded simultaneously
+ * using a single cURL multi handle, so connections are reused
+ * between downloads. New cache keys are accepted while other
+ * transfers are in progress. Batch mode ends when stdin is closed
+ * and all transfers have completed.
+ *
+ * @param force		[in] If true, redownload files even if they're cached.
+ * @param maxTransfers	[in] Maximum number of simultaneous transfers.
+ * @return EXIT_SUCCESS on success; EXIT_FAILURE on error.
+ */
+static int batch_download(bool force, unsigned int maxTransfers)
+{
+	CurlMultiDownloader multi(maxTransfers);
+	if (!multi.isValid()) {
+		SHOW_ERROR(_T("Unable to initialize the cURL multi handle."));
+		return EXIT_FAILURE;
+	}
+
+	// Transfer slots. Each slot's downloader keeps its cURL easy handle
+	// between downloads; connections are owned by the multi handle.
+	vector<BatchSlot> slots(maxTransfers);
+	for (auto iter = slots.begin(); iter != slots.end(); ++iter) {
+		// TODO: Configure this somewhere?
+		iter->downloader.setMaxSize(4*1024*1024);
+		iter->duplicates = 0;
+		iter->busy = false;
+	}
+
+	deque<tstring> pending;
+	string linebuf;
+	bool eof = false;
+	vector<CurlMultiDownloader::Result> results;
+	results.reserve(maxTransfers);
+	unsigned int doneSinceEvict = 0;
+
+	while (!eof || !pending.empty() || multi.activeTransfers() > 0) {
+		// Start pending downloads.
+		while (!pending.empty() && multi.activeTransfers() < maxTransfers) {
+			const tstring cache_key = std::move(pending.front());
+			pending.pop_front();
+
+			// If this cache key is already being downloaded,
+			// report the result when that transfer finishes.
+			BatchSlot *slot = nullptr;
+			for (auto iter = slots.begin(); iter != slots.end(); ++iter) {
+				if (iter->busy && iter->cache_key == cache_key) {
+					slot = &(*iter);
+					break;
+				}
+			}
+			if (slot) {
+				slot->duplicates++;
+				continue;
+			}
+
+			// Find an available slot.
+			// NOTE: There's always at least one available slot here.
+			for (auto iter = slots.begin(); iter != slots.end(); ++iter) {
+				if (!iter->busy) {
+					slot = &(*iter);
+					break;
+				}
+			}
+			assert(slot != nullptr);
+			slot->cache_key = cache_key;
+
+			const PrepareResult prep = prepareCacheJob(slot->cache_key.c_str(), force, slot->job);
+			if (prep != PREPARE_DOWNLOAD) {
+				print_batch_result((prep == PREPARE_CACHED ? EXIT_SUCCESS : EXIT_FAILURE), cache_key.c_str());
+				continue;
+			}
+
+			slot->downloader.setUrl(slot->job.full_url);
+			slot->downloader.setIfModifiedSince(slot->job.ifModifiedSince);
+			int ret = multi.add(&slot->downloader);
+			if (ret != 0) {
+				print_batch_result(finishCacheJob(slot->job, &slot->downloader, ret), cache_key.c_str());
+				continue;
+			}
+			slot->duplicates = 0;
+			slot->busy = true;
+		}
+
+		// Run the transfers and check for new cache keys.
+		results.clear();
+		int ret = multi.perform((eof ? -1 : STDIN_FILENO), 1000, results);
+		if (ret < 0) {
+			SHOW_ERROR(_T("Error running cURL transfers: %s"), _tcserror(-ret));
+			return EXIT_FAILURE;
+		}
+
+		for (auto iter = results.cbegin(); iter != results.cend(); ++iter) {
+			BatchSlot *slot = nullptr;
+			for (auto slot_iter = slots.begin(); slot_iter != slots.end(); ++slot_iter) {
+				if (&slot_iter->downloader == iter->downloader) {
+					slot = &(*slot_iter);
+					break;
+				}
+			}
+			assert(slot != nullptr);
+			if (!slot)
+				continue;
+
+			const int exit_code = finishCacheJob(slot->job, &slot->downloader, iter->ret);
+			for (unsigned int i = 0; i <= slot->duplicates; i++) {
+				print_batch_result(exit_code, slot->cache_key.c_str());
+			}
+			slot->busy = false;
+		}
+
+		if (!results.empty()) {
+			// Check if the cache needs to be trimmed.
+			doneSinceEvict += static_cast<unsigned int>(results.size());
+			if (evictCache(doneSinceEvict >= EVICT_FILE_COUNT)) {
+				doneSinceEvict = 0;
+			}
+		}
+
+		if (ret > 0) {
+			// New input is available.
+			char buf[4096];
+			const ssize_t sz = read(STDIN_FILENO, buf, sizeof(buf));
+			if (sz < 0 && (errno == EINTR || errno == EAGAIN)) {
+				// Try again later.
+				continue;
+			} else if (sz <= 0) {
+				// End of input, or an error occurred.
+				eof = true;
+			} else {
+				linebuf.append(buf, sz);
+			}
+
+			// Split the input into lines.
+			size_t start = 0;
+			size_t nl;
+			while ((nl = linebuf.find('\n', start)) != string::npos) {
+				size_t len = nl - start;
+				if (len > 0 && linebuf[nl-1] == '\r') {
+					len--;
+				}
+				if (len > 0) {
+					pending.emplace_back(linebuf, start, len);
+				}
+				start = nl + 1;
+			}
+			linebuf.erase(0, start);
+
+			if (linebuf.size() > 1024) {
+				// Line is too long. Discard it.
+				SHOW_ERROR(_T("Cache key is too long."));
+				linebuf.clear();
+			}
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
+#endif /* _WIN32 */
+
+/**
+ * Get the numeric value for a command line option.
+ * The value may be attached, e.g. '-j4', or separate, e.g. '-j 4'.
+ * On success, optind and i are updated to skip the value.
+ * @param argc		[in] Number of arguments.
+ * @param argv		[in] Arguments.
+ * @param optind	[in/out] Index of the current argument.
+ * @param i		[in/out] Index of the option character within the current argument.
+ * @param minValue	[in] Minimum value.
+ * @param maxValue	[in] Maximum value.
+ * @param pValue	[out] Value.
+ * @return True on success; false on error. (An error message will be shown.)
+ */
+static bool get_option_value(int argc, TCHAR *argv[], int &optind, int &i,
+	unsigned int minValue, unsigned int maxValue, unsigned int *pValue)
+{
+	const TCHAR opt = argv[optind][i];
+	const TCHAR *s_value = &argv[optind][i+1];
+	if (*s_value == _T('\0')) {
+		if (optind + 1 >= argc) {
+			show_error(_T("Option -%c requires a value."), opt);
+			show_usage();
+			return false;
+		}
+		s_value = argv[++optind];
+	}
+
+	TCHAR *endptr = nullptr;
+	const unsigned long value = _tcstoul(s_value, &endptr, 10);
+	if (*s_value == _T('\0') || *endptr != _T('\0') || value < minValue || value > maxValue) {
+		show_error(_T("Invalid value for option -%c: %s"), opt, s_value);
+		show_usage();
+		return false;
+	}
+	*pValue = static_cast<unsigned int>(value);
+
+	// Skip the rest of this argument.
+	i = static_cast<int>(_tcslen(argv[optind])) - 1;
+	return true;
+}
+
+/**
+ * rp-download: Download an image from a supported online database.
+ * @param cache_key Cache key, e.g. "ds/cover/US/ADAE.png"
+ * @return 0 on success; non-zero on error.
+ *
+ * In batch mode (-b), cache keys are read from stdin instead.
+ * See print_batch_result() for the protocol.
+ *
+ * TODO:
+ * - More error codes based on the error.
+ */
+int RP_C_API _tmain(int argc, TCHAR *argv[])
+{
+	// Create a downloader based on OS:
+	// - Linux: CurlDownloader
+	// - Windows: WinInetDownloader
+
+	// Syntax: rp-download cache_key
+	// Example: rp-download ds/coverM/US/ADAE.png
+	// Batch mode: rp-download -b [-j 4] < cache_keys.txt
+	// Cache policy: -r 30 -s 512 -n 0
+
+	// If http_proxy or https_proxy are set, they will be used
+	// by the downloader code if supported.
+
+	// Reduce process integrity, if available.
+	rp_secure_reduce_integrity();
+
+	// Set OS-specific security options.
+	rp_secure_param_t param;
+#if defined(_WIN32)
+	param.bHighSec = FALSE;
+#elif defined(HAVE_SECCOMP)
+	static const int syscall_wl[] = {
+		// Syscalls used by rp-download.
+		// TODO: Add more syscalls.
+		// FIXME: glibc-2.31 uses 64-bit time syscalls that may not be
+		// defined in earlier versions, including Ubuntu 14.04.
+
+		// NOTE: Special case for clone(). If it's the first syscall
+		// in the list, it has a parameter restriction added that
+		// ensures it can only be used to create threads.
+		SCMP_SYS(clone),
+		// Other multi-threading syscalls
+		SCMP_SYS(set_robust_list),
+
+		SCMP_SYS(access), SCMP_SYS(clock_gettime),
+#if defined(__SNR_clock_gettime64) || defined(__NR_clock_gettime64)
+		SCMP_SYS(clock_gettime64),
+#endif /* __SNR_clock_gettime64 || __NR_clock_gettime64 */
+		SCMP_SYS(close),
+		SCMP_SYS(fcntl),     SCMP_SYS(fcntl64),		// gcc profiling
+		SCMP_SYS(fsetxattr),
+		SCMP_SYS(fstat),     SCMP_SYS(fstat64),		// __GI___fxstat() [printf()]
+		SCMP_SYS(fstatat64), SCMP_SYS(newfstatat),	// Ubuntu 19.10 (32-bit)
+		SCMP_SYS(futex),
+		SCMP_SYS(getdents), SCMP_SYS(getdents64),
+		SCMP_SYS(getppid),	// for bubblewrap verification
+		SCMP_SYS(getrusage),
+		SCMP_SYS(gettimeofday),	// 32-bit only?
+		SCMP_SYS(getuid),	// TODO: Only use geteuid()?
+		SCMP_SYS(lseek), SCMP_SYS(_llseek),
+		//SCMP_SYS(lstat), SCMP_SYS(lstat64),	// Not sure if used?
+		SCMP_SYS(mkdir), SCMP_SYS(mmap), SCMP_SYS(mmap2),
+		SCMP_SYS(munmap),
+		SCMP_SYS(open),		// Ubuntu 16.04
+		SCMP_SYS(openat),	// glibc-2.31
+#if defined(__SNR_openat2)
+		SCMP_SYS(openat2),	// Linux 5.6
+#elif defined(__NR_openat2)
+		__NR_openat2,		// Linux 5.6
+#endif /* __SNR_openat2 || __NR_openat2 */
+		SCMP_SYS(poll), SCMP_SYS(ppoll), SCMP_SYS(select),
+		SCMP_SYS(stat), SCMP_SYS(stat64),
+		SCMP_SYS(rename), SCMP_SYS(renameat),	// to replace revalidated cache files
+#if defined(__SNR_renameat2) || defined(__NR_renameat2)
+		SCMP_SYS(renameat2),
+#endif /* __SNR_renameat2 || __NR_renameat2 */
+		SCMP_SYS(unlink),	// to delete expired and evicted cache files
+		SCMP_SYS(utimensat),
+
+#if defined(__SNR_statx) || defined(__NR_statx)
+		SCMP_SYS(getcwd),	// called by glibc's statx()
+		SCMP_SYS(statx),
+#endif /* __SNR_statx || __NR_statx */
+
+#ifndef NDEBUG
+		// Needed for assert() on some systems.
+		SCMP_SYS(uname),
+#endif /* NDEBUG */
+
+		// glibc ncsd
+		// TODO: Restrict connect() to AF_UNIX.
+		SCMP_SYS(connect), SCMP_SYS(recvmsg), SCMP_SYS(sendto),
+		SCMP_SYS(sendmmsg),	// getaddrinfo() (32-bit only?)
+		SCMP_SYS(ioctl),	// getaddrinfo() (32-bit only?) [FIXME: Filter for FIONREAD]
+		SCMP_SYS(recvfrom),	// getaddrinfo() (32-bit only?)
+
+		// Needed for network access on Kubuntu 20.04 for some reason.
+		SCMP_SYS(getpid), SCMP_SYS(uname),
+
+		// cURL and OpenSSL
+		SCMP_SYS(bind),		// getaddrinfo() [curl_thread_create_thunk(), curl-7.68.0]
+#ifdef __SNR_getrandom
+		SCMP_SYS(getrandom),
+#endif /* __SNR_getrandom */
+		SCMP_SYS(getpeername), SCMP_SYS(getsockname),
+		SCMP_SYS(getsockopt), SCMP_SYS(madvise), SCMP_SYS(mprotect),
+		SCMP_SYS(setsockopt), SCMP_SYS(socket),
+		SCMP_SYS(socketcall),	// FIXME: Enhanced filtering? [cURL+GnuTLS only?]
+		SCMP_SYS(socketpair), SCMP_SYS(sysinfo),
+		SCMP_SYS(eventfd2), SCMP_SYS(pipe), SCMP_SYS(pipe2),	// cURL multi handle wakeup [batch mode]
+
+		// libnss_resolve.so (systemd-resolved)
+		SCMP_SYS(geteuid),
+		SCMP_SYS(sendmsg),	// libpthread.so [_nss_resolve_gethostbyname4_r() from libnss_resolve.so]
+
+		-1	// End of whitelist
+	};
+	param.syscall_wl = syscall_wl;
+#elif defined(HAVE_PLEDGE)
+	// Promises:
+	// - stdio: General stdio functionality.
+	// - rpath: Read from ~/.config/rom-properties/ and ~/.cache/rom-properties/
+	// - wpath: Write to ~/.cache/rom-properties/
+	// - cpath: Create ~/.cache/rom-properties/ if it doesn't exist.
+	// - inet: Internet access.
+	// - fattr: Modify file attributes, e.g. mtime.
+	// - dns: Resolve hostnames.
+	// - getpw: Get user's home directory if HOME is empty.
+	param.promises = "stdio rpath wpath cpath inet fattr dns getpw";
+#elif defined(HAVE_TAME)
+	// NOTE: stdio includes fattr, e.g. utimes().
+	param.tame_flags = TAME_STDIO | TAME_RPATH | TAME_WPATH | TAME_CPATH |
+	                   TAME_INET | TAME_DNS | TAME_GETPW;
+#else
+	param.dummy = 0;
+#endif
+	rp_secure_enable(param);
+
+	// Store argv[0] globally.
+	argv0 = argv[0];
+
+	if (argc < 2) {
+		show_usage();
+		return EXIT_FAILURE;
+	}
+
+	// Check for arguments. (simple non-getopt version)
+	bool force = false;
+	bool batch = false;
+	unsigned int maxTransfers = 4;
+	unsigned int value;
+	int optind = 1;
+	for (; optind < argc; optind++) {
+		if (!argv[optind] || argv[optind][0] != '-') {
+			// End of options.
+			break;
+		}
+
+		// Allow multiple options in one argument, e.g. '-vf'.
+		for (int i = 1; argv[optind][i] != '\0'; i++) {
+			switch (argv[optind][i]) {
+				case 'b':
+					// Batch mode is enabled.
+					batch = true;
+					break;
+				case 'j':
+					// Maximum number of simultaneous transfers.
+					if (!get_option_value(argc, argv, optind, i, 1, MAX_TRANSFERS, &value)) {
+						return EXIT_FAILURE;
+					}
+					maxTransfers = value;
+					break;
+				case 'r':
+					// Revalidation period, in days.
+					if (!get_option_value(argc, argv, optind, i, 0, 36500, &value)) {
+						return EXIT_FAILURE;
+					}
+					revalidateDays = value;
+					break;
+				case 's':
+					// Maximum cache size, in MiB.
+					if (!get_option_value(argc, argv, optind, i, 0, 1024U*1024U, &value)) {
+						return EXIT_FAILURE;
+					}
+					cacheMaxSize = static_cast<off64_t>(value) * 1024 * 1024;
+					break;
+				case 'n':
+					// Maximum number of cache files.
+					if (!get_option_value(argc, argv, optind, i, 0, 100000000U, &value)) {
+						return EXIT_FAILURE;
+					}
+					cacheMaxEntries = value;
+					break;
+				case 'v':
+					// Verbose mode is enabled.
+					verbose = true;
+					break;
+				case 'f':
+					// Force download is enabled.
+					force = true;
+					break;
+				default:
+					// Invalid parameter.
+					show_error(_T("Unrecognized option: %c"), argv[optind][i]);
+					show_usage();
+					return EXIT_FAILURE;
+			}
+		}
+	}
+
+	if (batch) {
+		if (optind < argc) {
+			show_error(_T("Cache keys cannot be specified on the command line in batch mode."));
+			show_usage();
+			return EXIT_FAILURE;
+		}
+#ifdef _WIN32
+		unique_ptr<IDownloader> m_downloader(new WinInetDownloader());
+		// TODO: Configure this somewhere?
+		m_downloader->setMaxSize(4*1024*1024);
+		return batch_download(m_downloader.get(), force, maxTransfers);
+#else /* !_WIN32 */
+		return batch_download(force, maxTransfers);
+#endif /* _WIN32 */
+	}
+
+	if (optind >= argc) {
+		show_error(_T("No cache key specified."));
+		show_usage();
+		return EXIT_FAILURE;
+	}
+	const TCHAR *const cache_key = argv[optind];
+
+	// Attempt to download the file.
+	// TODO: IDownloaderFactory?
+#ifdef _WIN32
+	unique_ptr<IDownloader> m_downloader(new WinInetDownloader());
+#else /* !_WIN32 */
+	unique_ptr<IDownloader> m_downloader(new CurlDownloader());
+#endif /* _WIN32 */
+
+	// TODO: Configure this somewhere?
+	m_downloader->setMaxSize(4*1024*1024);
+
+	const int ret = downloadCacheKey(m_downloader.get(), cache_key, force);
+
+	// Check if the cache needs to be trimmed.
+	evictCache(false);
+	return ret;
+}
@@ -43,6 +43,19 @@
  */
 typedef int (RP_C_API *PFN_RP_CREATE_THUMBNAIL)(const char *source_file, const char *output_file, int maximum_size);
 
+/**
+ * rp_create_thumbnails_batch() function pointer.
+ * @param count		[in] Number of files.
+ * @param source_files	[in] Source files. (UTF-8)
+ * @param output_files	[in] Output files. (UTF-8)
+ * @param maximum_size	[in] Maximum size.
+ * @param results	[out] Array of count RPCT error codes. (0 on success)
+ * @return Number of files that failed. (0 if all thumbnails were created)
+ */
+typedef int (RP_C_API *PFN_RP_CREATE_THUMBNAILS_BATCH)(unsigned int count,
+	const char *const *source_files, const char *const *output_files,
+	int maximum_size, int *results);
+
 /**
  * rp_show_config_dialog() function pointer. (Unix/Linux version)
  * @param argc
@@ -84,13 +97,19 @@ static void show_help(const char *argv0)
 	if (!is_rp_config) {
 		printf(C_("rp-stub", "Usage: %s [-s size] source_file output_file"), argv0);
 		putchar('\n');
+		printf(C_("rp-stub", "Usage: %s [-s size] -b batch_file"), argv0);
+		putchar('\n');
 		putchar('\n');
 		puts(C_("rp-stub",
 			"If source_file is a supported ROM image, a thumbnail is\n"
 			"extracted and saved as output_file.\n"
 			"\n"
+			"In batch mode, each line of batch_file contains a source file\n"
+			"and an output file, separated by a tab. Use '-' for stdin.\n"
+			"\n"
 			"Options:\n"
 			"  -s, --size\t\tMaximum thumbnail size. (default is 256px)\n"
+			"  -b, --batch\t\tCreate thumbnails for all files listed in batch_file.\n"
 			"  -c, --config\t\tShow the configuration dialog instead of thumbnailing.\n"
 			"  -d, --debug\t\tShow debug output when searching for rom-properties.\n"
 			"  -h, --help\t\tDisplay this help and exit.\n"
@@ -127,11 +146,157 @@ static int ATTR_PRINTF(2, 3) fnDebug(int level, const char *format, ...)
 	return ret;
 }
 
+/**
+ * Batch thumbnailing mode.
+ * @param batch_file Batch file, or "-" for stdin.
+ * @param maximum_size Maximum size.
+ * @return 0 on success; non-zero on error.
+ */
+static int do_batch(const char *batch_file, int maximum_size)
+{
+	FILE *f;
+	if (!strcmp(batch_file, "-")) {
+		f = stdin;
+	} else {
+		f = fopen(batch_file, "r");
+		if (!f) {
+			// tr: %1$s == batch filename, %2$s == error message
+			fprintf_p(stderr, C_("rp-stub", "Couldn't open batch file '%1$s': %2$s"),
+				batch_file, strerror(errno));
+			putc('\n', stderr);
+			return EXIT_FAILURE;
+		}
+	}
+
+	// Read the source and output filenames.
+	// NOTE: Each line is allocated by getline(). The output filename
+	// is part of the same allocation, so only the source filename
+	// needs to be freed.
+	char **source_files = NULL;
+	char **output_files = NULL;
+	unsigned int count = 0, capacity = 0;
+	unsigned int line_num = 0;
+	char *line = NULL;
+	size_t line_sz = 0;
+	ssize_t len;
+	while ((len = getline(&line, &line_sz, f)) >= 0) {
+		line_num++;
+
+		// Remove the trailing newline.
+		while (len > 0 && (line[len-1] == '\n' || line[len-1] == '\r')) {
+			line[--len] = '\0';
+		}
+		if (len == 0 || line[0] == '#') {
+			// Empty line or comment.
+			continue;
+		}
+
+		char *const tab = strchr(line, '\t');
+		if (!tab || tab == line || tab[1] == '\0') {
+			// tr: %1$s == batch filename, %2$u == line number
+			fprintf_p(stderr, C_("rp-stub", "%1$s:%2$u: expected 'source_file<TAB>output_file'"),
+				batch_file, line_num);
+			putc('\n', stderr);
+			continue;
+		}
+		*tab = '\0';
+
+		if (count == capacity) {
+			capacity = (capacity == 0 ? 64 : capacity * 2);
+			source_files = realloc(source_files, capacity * sizeof(*source_files));
+			output_files = realloc(output_files, capacity * sizeof(*output_files));
+			if (!source_files || !output_files) {
+				fputs("*** ERROR: realloc() failed.\n", stderr);
+				abort();
+			}
+		}
+		source_files[count] = line;
+		output_files[count] = tab + 1;
+		count++;
+
+		// Let getline() allocate a new buffer for the next line.
+		line = NULL;
+		line_sz = 0;
+	}
+	free(line);
+	if (f != stdin) {
+		fclose(f);
+	}
+
+	int ret = 0;
+	if (count == 0) {
+		goto out;
+	}
+
+	// Search for a usable rom-properties library.
+	// If rp_create_thumbnails_batch() isn't available,
+	// fall back to rp_create_thumbnail().
+	void *pDll = NULL, *pfn = NULL;
+	const char *symname = "rp_create_thumbnails_batch";
+	int *const results = calloc(count, sizeof(int));
+	if (!results) {
+		fputs("*** ERROR: calloc() failed.\n", stderr);
+		abort();
+	}
+	ret = rp_dll_search(symname, &pDll, &pfn, (is_debug ? fnDebug : NULL));
+	if (ret == 0) {
+		if (is_debug) {
+			// tr: NOTE: Not positional. Don't change argument positions!
+			// tr: Only localize "Calling function:".
+			fprintf(stderr, C_("rp-stub", "Calling function: %s(%u, ..., %d);"),
+				symname, count, maximum_size);
+			putc('\n', stderr);
+		}
+		((PFN_RP_CREATE_THUMBNAILS_BATCH)pfn)(count,
+			(const char *const *)source_files, (const char *const *)output_files,
+			maximum_size, results);
+	} else {
+		symname = "rp_create_thumbnail";
+		ret = rp_dll_search(symname, &pDll, &pfn, fnDebug);
+		if (ret != 0) {
+			free(results);
+			goto out;
+		}
+		for (unsigned int i = 0; i < count; i++) {
+			results[i] = ((PFN_RP_CREATE_THUMBNAIL)pfn)(source_files[i], output_files[i], maximum_size);
+		}
+	}
+	dlclose(pDll);
+
+	// Report errors.
+	unsigned int failed = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		if (results[i] == 0)
+			continue;
+		failed++;
+		// tr: %1$s == source filename, %2$d == return value
+		fprintf_p(stderr, C_("rp-stub", "*** ERROR: %1$s: thumbnailing failed with error %2$d."),
+			source_files[i], results[i]);
+		putc('\n', stderr);
+	}
+	if (is_debug) {
+		// tr: %1$u == number of successful files, %2$u == total number of files
+		fprintf_p(stderr, C_("rp-stub", "%1$u of %2$u thumbnails created."), count - failed, count);
+		putc('\n', stderr);
+	}
+	free(results);
+	ret = (failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+
+out:
+	for (unsigned int i = 0; i < count; i++) {
+		free(source_files[i]);
+	}
+	free(source_files);
+	free(output_files);
+	return ret;
+}
+
 int main(int argc, char *argv[])
 {
 	/**
 	 * Command line syntax:
 	 * - Thumbnail: rp-stub [-s size] path output
+	 * - Batch:     rp-stub [-s size] -b batch_file
 	 * - Config:    rp-stub -c
 	 *
 	 * If invoked as 'rp-config', the configuration dialog
@@ -166,6 +331,7 @@ int main(int argc, char *argv[])
 
 	static const struct option long_options[] = {
 		{"size",	required_argument,	NULL, 's'},
+		{"batch",	required_argument,	NULL, 'b'},
 		{"config",	no_argument,		NULL, 'c'},
 		{"debug",	no_argument,		NULL, 'd'},
 		{"help",	no_argument,		NULL, 'h'},
@@ -181,8 +347,9 @@ int main(int argc, char *argv[])
 	// Default to 256x256.
 	uint8_t config = is_rp_config;
 	int maximum_size = 256;
+	const char *batch_file = NULL;
 	int c, option_index;
-	while ((c = getopt_long(argc, argv, "s:cdhV", long_options, &option_index)) != -1) {
+	while ((c = getopt_long(argc, argv, "s:b:cdhV", long_options, &option_index)) != -1) {
 		switch (c) {
 			case 's': {
 				char *endptr = NULL;
@@ -209,6 +376,11 @@ int main(int argc, char *argv[])
 				break;
 			}
 
+			case 'b':
+				// Batch mode.
+				batch_file = optarg;
+				break;
+
 			case 'c':
 				// Show the configuration dialog.
 				config = true;
@@ -241,7 +413,19 @@ int main(int argc, char *argv[])
 	// and reparse?
 	rp_stub_do_security_options(config);
 
-	if (!config) {
+	if (!config && batch_file) {
+		// Batch thumbnailing mode.
+		// Filenames are read from the batch file.
+		if (optind < argc) {
+			// tr: %s == program name
+			fprintf(stderr, C_("rp-stub", "%s: too many parameters specified"), argv[0]);
+			putc('\n', stderr);
+			// tr: %s == program name
+			fprintf(stderr, str_help_more_info, argv[0]);
+			putc('\n', stderr);
+			return EXIT_FAILURE;
+		}
+	} else if (!config) {
 		// Thumbnailing mode.
 		// We must have 2 filenames specified.
 		if (optind == argc) {
@@ -271,6 +455,11 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	if (!config && batch_file) {
+		// Batch thumbnailing mode.
+		return do_batch(batch_file, maximum_size);
+	}
+
 	// Search for a usable rom-properties library.
 	// TODO: Desktop override option?
 	const char *const symname = (config ? "rp_show_config_dialog" : "rp_create_thumbnail");
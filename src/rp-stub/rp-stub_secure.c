@@ -106,10 +106,24 @@ int rp_stub_do_security_options(bool config)
 		SCMP_SYS(clock_nanosleep), SCMP_SYS(clone), SCMP_SYS(fork),
 		SCMP_SYS(execve), SCMP_SYS(wait4),
 
+		// LibRpThreads::ThreadPool
+		SCMP_SYS(madvise),
+		SCMP_SYS(sched_getaffinity),	// sysconf(_SC_NPROCESSORS_ONLN)
+#if defined(__SNR_rseq) || defined(__NR_rseq)
+		SCMP_SYS(rseq),		// glibc-2.35
+#endif /* __SNR_rseq || __NR_rseq */
+
+		// gzip index cache [LibRpFile::GzReader]
+		SCMP_SYS(rename), SCMP_SYS(renameat),	// LibRpFile::FileSystem::rename_file()
+#if defined(__SNR_renameat2) || defined(__NR_renameat2)
+		SCMP_SYS(renameat2),
+#endif /* __SNR_renameat2 || __NR_renameat2 */
+		SCMP_SYS(unlink), SCMP_SYS(unlinkat),	// LibRpFile::FileSystem::delete_file()
+
 		// FIXME: Child process inherits the seccomp filter...
 		// rp-download child process
 		SCMP_SYS(arch_prctl), SCMP_SYS(mkdir), SCMP_SYS(prctl),
-		SCMP_SYS(pread64), SCMP_SYS(seccomp),
+		SCMP_SYS(pread64), SCMP_SYS(preadv), SCMP_SYS(seccomp),
 
 		-1	// End of whitelist
 	};
@@ -0,0 +1,374 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * hashfile.cpp: Streaming multi-hash of files and their contents.         *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "config.rpcli.h"
+
+#ifndef ENABLE_DECRYPTION
+#error This file should only be compiled if decryption is enabled.
+#endif
+
+#include "hashfile.hpp"
+#include "scandir.hpp"
+
+// librpbase
+#include "librpbase/RomData.hpp"
+#include "librpbase/TextFuncs.hpp"
+#include "librpbase/crypto/Hash.hpp"
+#include "librpbase/disc/DiscReader.hpp"
+#include "librpbase/uvector.h"
+#include "libi18n/i18n.h"
+using namespace LibRpBase;
+
+// librpfile
+#include "librpfile/RpFile.hpp"
+using LibRpFile::RpFile;
+
+// libromdata
+#include "libromdata/RomDataFactory.hpp"
+using LibRomData::RomDataFactory;
+
+// librpthreads
+#include "librpthreads/ThreadPool.hpp"
+using LibRpThreads::ThreadPool;
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+// C++ includes.
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::ostream;
+using std::ostringstream;
+using std::string;
+using std::vector;
+
+// Size of each half of the read buffer.
+// The reader fills one half while the hashing
+// threads process the other half.
+static const size_t HASH_BUFFER_SIZE = 4U * 1024U * 1024U;
+
+/**
+ * Hash job for a single view.
+ */
+struct HashJob {
+	IDiscReader *reader;		// [in] View being hashed
+
+	// Block that will be read by task 0.
+	uint8_t *readBuf;		// [in] Read buffer
+	size_t readLen;			// [out] Number of bytes read
+	bool doRead;			// [in] If false, don't read anything.
+
+	// Block that will be hashed by tasks 1 and up.
+	const uint8_t *hashBuf;		// [in] Hash buffer
+	size_t hashLen;			// [in] Number of bytes to hash
+
+	vector<Hash*> hashes;		// [in] Hash objects
+};
+
+/**
+ * Hash pipeline task function.
+ * Task 0 reads the next block; tasks 1 and up hash the current block.
+ * @param param HashJob
+ * @param index Task index
+ */
+static void hashTask(void *param, unsigned int index)
+{
+	HashJob *const job = static_cast<HashJob*>(param);
+	if (index == 0) {
+		// Read the next block.
+		job->readLen = (job->doRead
+			? job->reader->read(job->readBuf, HASH_BUFFER_SIZE)
+			: 0);
+	} else {
+		// Hash the current block.
+		job->hashes[index - 1]->process(job->hashBuf, job->hashLen);
+	}
+}
+
+/**
+ * Hash a single view.
+ *
+ * Reading and hashing are pipelined using a double buffer:
+ * while block N is being hashed by one thread per algorithm,
+ * block N+1 is being read into the other half of the buffer.
+ *
+ * @param reader	[in] View to hash
+ * @param hashes	[in] Hash objects (will be reset)
+ * @param buf		[in] Read buffer (2 * HASH_BUFFER_SIZE)
+ * @param pTotal	[out] Number of bytes hashed
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int hashView(IDiscReader *reader, const vector<Hash*> &hashes, uint8_t *buf, off64_t *pTotal)
+{
+	for (auto iter = hashes.cbegin(); iter != hashes.cend(); ++iter) {
+		(*iter)->reset();
+	}
+
+	const off64_t size = reader->size();
+	reader->clearError();
+	reader->rewind();
+
+	HashJob job;
+	job.reader = reader;
+	job.hashes = hashes;
+	const unsigned int taskCount = static_cast<unsigned int>(hashes.size() + 1);
+
+	// Read the first block.
+	uint8_t *bufs[2] = {buf, buf + HASH_BUFFER_SIZE};
+	unsigned int cur = 0;
+	size_t len = reader->read(bufs[cur], HASH_BUFFER_SIZE);
+	off64_t total = 0;
+	ThreadPool *const pool = ThreadPool::instance();
+
+	while (len > 0) {
+		total += len;
+
+		// Hash the current block and read the next block concurrently.
+		// NOTE: A short read indicates EOF, so don't read past it.
+		job.hashBuf = bufs[cur];
+		job.hashLen = len;
+		job.readBuf = bufs[cur ^ 1];
+		job.readLen = 0;
+		job.doRead = (len == HASH_BUFFER_SIZE && (size < 0 || total < size));
+		pool->parallelFor(taskCount, hashTask, &job, taskCount);
+
+		len = job.readLen;
+		cur ^= 1;
+	}
+
+	*pTotal = total;
+	if (size >= 0 && total != size) {
+		// Short read.
+		const int err = reader->lastError();
+		return (err != 0 ? -err : -EIO);
+	}
+	return 0;
+}
+
+/**
+ * Convert a hash to a lowercase hex string.
+ * @param pHash Hash
+ * @param hash_len Hash length
+ * @return Hex string
+ */
+static string hashToHex(const uint8_t *pHash, size_t hash_len)
+{
+	static const char hex_chr[] = "0123456789abcdef";
+	string s;
+	s.resize(hash_len * 2);
+	for (size_t i = 0; i < hash_len; i++) {
+		s[(i * 2) + 0] = hex_chr[pHash[i] >> 4];
+		s[(i * 2) + 1] = hex_chr[pHash[i] & 0x0F];
+	}
+	return s;
+}
+
+/**
+ * Get the JSON key for a hash algorithm.
+ * @param algorithm Hash algorithm
+ * @return JSON key
+ */
+static const char *jsonKey(Hash::Algorithm algorithm)
+{
+	switch (algorithm) {
+		case Hash::Algorithm::CRC32:	return "crc32";
+		case Hash::Algorithm::MD5:	return "md5";
+		case Hash::Algorithm::SHA1:	return "sha1";
+		default:			return "unknown";
+	}
+}
+
+/**
+ * Hash a view and print the results.
+ * @param name		[in] View name
+ * @param reader	[in] View to hash
+ * @param hashes	[in] Hash objects
+ * @param buf		[in] Read buffer (2 * HASH_BUFFER_SIZE)
+ * @param json		[in,opt] JSON output stream (If nullptr, print text to cout.)
+ * @param first		[in/out] True if this is the first view (JSON only)
+ * @return 0 on success; negative POSIX error code on error.
+ */
+static int hashAndPrintView(const char *name, IDiscReader *reader,
+	const vector<Hash*> &hashes, uint8_t *buf, ostream *json, bool &first)
+{
+	cerr << "-- " << rp_sprintf(C_("rpcli", "Hashing %s..."), name) << endl;
+
+	off64_t total = 0;
+	const int ret = hashView(reader, hashes, buf, &total);
+	if (ret != 0) {
+		cerr << "   " << rp_sprintf(C_("rpcli", "Read error: %s"), strerror(-ret)) << endl;
+	}
+
+	if (json) {
+		if (!first) *json << ',';
+		*json << "{\"view\":";
+		WriteJSONString(*json, name);
+		*json << ",\"size\":" << total;
+		if (ret != 0) {
+			*json << ",\"error\":\"read error\",\"code\":" << -ret << '}';
+			first = false;
+			return ret;
+		}
+	} else {
+		cout << rp_sprintf(C_("rpcli", "%s: %lld bytes"), name, static_cast<long long>(total)) << endl;
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	uint8_t hash[20];
+	for (auto iter = hashes.cbegin(); iter != hashes.cend(); ++iter) {
+		Hash *const h = *iter;
+		const size_t hash_len = h->hashLength();
+		assert(hash_len <= sizeof(hash));
+		if (hash_len > sizeof(hash) || h->getHash(hash, hash_len) != 0)
+			continue;
+
+		if (json) {
+			*json << ",\"" << jsonKey(h->algorithm()) << "\":\"" << hashToHex(hash, hash_len) << '"';
+		} else {
+			cout << "  " << Hash::algorithmName(h->algorithm()) << ": " << hashToHex(hash, hash_len) << endl;
+		}
+	}
+
+	if (json) *json << '}';
+	first = false;
+	return 0;
+}
+
+/**
+ * Get the time elapsed since a starting point.
+ * @param start Starting point
+ * @return Elapsed time, in microseconds
+ */
+static inline uint64_t elapsed_us(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Hash a file in a single streaming pass per view.
+ *
+ * The raw file is always hashed. If the file is gzip-compressed,
+ * the decompressed data is hashed, too. Decrypted and/or decompressed
+ * views provided by the RomData subclass, e.g. Wii partitions or
+ * 3DS NCCH contents, are hashed afterwards.
+ *
+ * @param filename Filename
+ * @param json Is program running in json mode?
+ * @param algorithms HashAlgorithmFlags bitfield
+ * @return 0 on success; non-zero on error.
+ */
+int DoHashFile(const char *filename, bool json, unsigned int algorithms)
+{
+	cerr << "== " << rp_sprintf(C_("rpcli", "Hashing file '%s'..."), filename) << endl;
+	const auto start = std::chrono::steady_clock::now();
+
+	// Raw file.
+	RpFile *const rawFile = new RpFile(filename, RpFile::FM_OPEN_READ);
+	if (!rawFile->isOpen()) {
+		cerr << "-- " << rp_sprintf(C_("rpcli", "Couldn't open file: %s"), strerror(rawFile->lastError())) << endl;
+		if (json) {
+			WriteJSONRecord(cout, filename, elapsed_us(start), SCAN_OPEN_ERROR, string(), rawFile->lastError());
+		}
+		const int err = rawFile->lastError();
+		rawFile->unref();
+		return (err != 0 ? err : EIO);
+	}
+
+	// Create the hash objects.
+	static const Hash::Algorithm alg_tbl[] = {
+		Hash::Algorithm::CRC32,
+		Hash::Algorithm::MD5,
+		Hash::Algorithm::SHA1,
+	};
+	vector<Hash*> hashes;
+	for (unsigned int i = 0; i < ARRAY_SIZE(alg_tbl); i++) {
+		if (!(algorithms & (1U << i)))
+			continue;
+		Hash *const h = new Hash(alg_tbl[i]);
+		if (!h->isUsable()) {
+			cerr << "-- " << rp_sprintf(C_("rpcli", "Warning: %s is not available"),
+				Hash::algorithmName(alg_tbl[i])) << endl;
+			delete h;
+			continue;
+		}
+		hashes.emplace_back(h);
+	}
+
+	ao::uvector<uint8_t> buf;
+	buf.resize(HASH_BUFFER_SIZE * 2);
+
+	// JSON: The hashes are written to a buffer, since the
+	// record's time_us field has to be written first.
+	ostringstream oss;
+	ostream *const pJson = (json ? &oss : nullptr);
+
+	int ret = 0;
+	bool first = true;
+	if (pJson) *pJson << '[';
+
+	// Raw file.
+	IDiscReader *reader = new DiscReader(rawFile);
+	if (hashAndPrintView(C_("rpcli", "Raw file"), reader, hashes, buf.data(), pJson, first) != 0) {
+		ret = EIO;
+	}
+	reader->unref();
+	rawFile->unref();
+
+	// Transparent decompression, plus the RomData subclass.
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ);
+	if (file->isOpen()) {
+		if (file->isCompressed()) {
+			reader = new DiscReader(file);
+			if (hashAndPrintView(C_("rpcli", "Decompressed file"), reader, hashes, buf.data(), pJson, first) != 0) {
+				ret = EIO;
+			}
+			reader->unref();
+		}
+
+		RomData *const romData = RomDataFactory::create(file);
+		if (romData) {
+			vector<RomData::ContentView> views = romData->contentViews();
+			for (auto iter = views.begin(); iter != views.end(); ++iter) {
+				if (hashAndPrintView(iter->name.c_str(), iter->discReader, hashes, buf.data(), pJson, first) != 0) {
+					ret = EIO;
+				}
+				iter->discReader->unref();
+			}
+			romData->unref();
+		}
+	}
+	file->unref();
+
+	if (json) {
+		// Use the same record format as DoScanDir() so the
+		// hashes can be matched to their input file.
+		oss << ']';
+		WriteJSONRecordStart(cout, filename, elapsed_us(start));
+		cout << ",\"hashes\":" << oss.str();
+		WriteJSONRecordEnd(cout);
+	} else {
+		cout << endl;
+	}
+
+	for (auto iter = hashes.begin(); iter != hashes.end(); ++iter) {
+		delete *iter;
+	}
+	return ret;
+}
@@ -0,0 +1,41 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * hashfile.hpp: Streaming multi-hash of files and their contents.         *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_RPCLI_HASHFILE_HPP__
+#define __ROMPROPERTIES_RPCLI_HASHFILE_HPP__
+
+/**
+ * Hash algorithm bitfield for DoHashFile().
+ */
+enum HashAlgorithmFlags {
+	HASH_CRC32	= (1U << 0),
+	HASH_MD5	= (1U << 1),
+	HASH_SHA1	= (1U << 2),
+
+	HASH_ALL	= HASH_CRC32 | HASH_MD5 | HASH_SHA1,
+};
+
+/**
+ * Hash a file in a single streaming pass per view.
+ *
+ * The raw file is always hashed. If the file is gzip-compressed,
+ * the decompressed data is hashed, too. Decrypted and/or decompressed
+ * views provided by the RomData subclass, e.g. Wii partitions or
+ * 3DS NCCH contents, are hashed afterwards.
+ *
+ * In JSON mode, the hashes are written as a WriteJSONRecord()-style
+ * record: {"filename":"...","time_us":123,"hashes":[...]}
+ *
+ * @param filename Filename
+ * @param json Is program running in json mode?
+ * @param algorithms HashAlgorithmFlags bitfield
+ * @return 0 on success; non-zero on error.
+ */
+int DoHashFile(const char *filename, bool json, unsigned int algorithms);
+
+#endif /* __ROMPROPERTIES_RPCLI_HASHFILE_HPP__ */
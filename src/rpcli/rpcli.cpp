@@ -32,8 +32,8 @@ using namespace LibRpBase;
 using namespace LibRpFile;
 
 // libromdata
-#include "libromdata/RomDataFactory.hpp"
-using LibRomData::RomDataFactory;
+#include "libromdata/RomDataIndex.hpp"
+using LibRomData::RomDataIndex;
 
 // librptexture
 #include "librptexture/img/rp_image.hpp"
@@ -46,8 +46,10 @@ using LibRpTexture::rp_image;
 
 #ifdef ENABLE_DECRYPTION
 # include "verifykeys.hpp"
+# include "hashfile.hpp"
 #endif /* ENABLE_DECRYPTION */
 #include "device.hpp"
+#include "scandir.hpp"
 
 // OS-specific userdirs
 #ifdef _WIN32
@@ -67,6 +69,7 @@ using LibRpTexture::rp_image;
 #include <cerrno>
 
 // C++ includes.
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <locale>
@@ -164,6 +167,21 @@ static void ExtractImages(const RomData *romData, vector<ExtractParam>& extract)
 	}
 }
 
+// NDJSON mode: One compact JSON object per line,
+// with no enclosing array.
+static bool ndjson = false;
+
+/**
+ * Get the time elapsed since a starting point.
+ * @param start Starting point
+ * @return Elapsed time, in microseconds
+ */
+static inline uint64_t elapsed_us(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
 /**
  * Shows info about file
  * @param filename ROM filename
@@ -174,13 +192,26 @@ static void ExtractImages(const RomData *romData, vector<ExtractParam>& extract)
 static void DoFile(const char *filename, bool json, vector<ExtractParam>& extract, uint32_t languageCode = 0)
 {
 	cerr << "== " << rp_sprintf(C_("rpcli", "Reading file '%s'..."), filename) << endl;
-	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ);
+	const auto start = std::chrono::steady_clock::now();
+	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ_MMAP);
 	if (file->isOpen()) {
-		RomData *romData = RomDataFactory::create(file);
+		RomData *romData = RomDataIndex::create(file);
 		if (romData && romData->isValid()) {
 			if (json) {
 				cerr << "-- " << C_("rpcli", "Outputting JSON data") << endl;
-				cout << JSONROMOutput(romData, languageCode) << endl;
+				JSONROMOutput jsro(romData, languageCode);
+				if (ndjson) {
+					// NDJSON: Use the same record format as DoScanDir()
+					// so each line can be matched to its input file.
+					// The RomData object is written directly to cout
+					// by the JSON SAX writer.
+					jsro.setCompact(true);
+					WriteJSONRecordStart(cout, filename, elapsed_us(start));
+					cout << ",\"romdata\":" << jsro;
+					WriteJSONRecordEnd(cout);
+				} else {
+					cout << jsro << endl;
+				}
 			} else {
 				cout << ROMOutput(romData, languageCode) << endl;
 			}
@@ -188,13 +219,21 @@ static void DoFile(const char *filename, bool json, vector<ExtractParam>& extrac
 			ExtractImages(romData, extract);
 		} else {
 			cerr << "-- " << C_("rpcli", "ROM is not supported") << endl;
-			if (json) cout << "{\"error\":\"rom is not supported\"}" << endl;
+			if (ndjson) {
+				WriteJSONRecord(cout, filename, elapsed_us(start), SCAN_NOT_SUPPORTED, string(), 0);
+			} else if (json) {
+				cout << "{\"error\":\"rom is not supported\"}" << endl;
+			}
 		}
 
 		UNREF(romData);
 	} else {
 		cerr << "-- " << rp_sprintf(C_("rpcli", "Couldn't open file: %s"), strerror(file->lastError())) << endl;
-		if (json) cout << "{\"error\":\"couldn't open file\",\"code\":" << file->lastError() << "}" << endl;
+		if (ndjson) {
+			WriteJSONRecord(cout, filename, elapsed_us(start), SCAN_OPEN_ERROR, string(), file->lastError());
+		} else if (json) {
+			cout << "{\"error\":\"couldn't open file\",\"code\":" << file->lastError() << "}" << endl;
+		}
 	}
 	file->unref();
 }
@@ -261,6 +300,7 @@ static void PrintPathnames(void)
 static void DoScsiInquiry(const char *filename, bool json)
 {
 	cerr << "== " << rp_sprintf(C_("rpcli", "Opening device file '%s'..."), filename) << endl;
+	const auto start = std::chrono::steady_clock::now();
 	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ);
 	if (file->isOpen()) {
 		// TODO: Check for unsupported devices? (Only CD-ROM is supported.)
@@ -274,11 +314,19 @@ static void DoScsiInquiry(const char *filename, bool json)
 			}
 		} else {
 			cerr << "-- " << C_("rpcli", "Not a device file") << endl;
-			if (json) cout << "{\"error\":\"Not a device file\"}" << endl;
+			if (ndjson) {
+				WriteJSONRecord(cout, filename, elapsed_us(start), SCAN_NOT_A_DEVICE, string(), 0);
+			} else if (json) {
+				cout << "{\"error\":\"Not a device file\"}" << endl;
+			}
 		}
 	} else {
 		cerr << "-- " << rp_sprintf(C_("rpcli", "Couldn't open file: %s"), strerror(file->lastError())) << endl;
-		if (json) cout << "{\"error\":\"couldn't open file\",\"code\":" << file->lastError() << "}" << endl;
+		if (ndjson) {
+			WriteJSONRecord(cout, filename, elapsed_us(start), SCAN_OPEN_ERROR, string(), file->lastError());
+		} else if (json) {
+			cout << "{\"error\":\"couldn't open file\",\"code\":" << file->lastError() << "}" << endl;
+		}
 	}
 	file->unref();
 }
@@ -292,6 +340,7 @@ static void DoScsiInquiry(const char *filename, bool json)
 static void DoAtaIdentifyDevice(const char *filename, bool json, bool packet)
 {
 	cerr << "== " << rp_sprintf(C_("rpcli", "Opening device file '%s'..."), filename) << endl;
+	const auto start = std::chrono::steady_clock::now();
 	RpFile *const file = new RpFile(filename, RpFile::FM_OPEN_READ_GZ);
 	if (file->isOpen()) {
 		// TODO: Check for unsupported devices? (Only CD-ROM is supported.)
@@ -305,11 +354,19 @@ static void DoAtaIdentifyDevice(const char *filename, bool json, bool packet)
 			}
 		} else {
 			cerr << "-- " << C_("rpcli", "Not a device file") << endl;
-			if (json) cout << "{\"error\":\"Not a device file\"}" << endl;
+			if (ndjson) {
+				WriteJSONRecord(cout, filename, elapsed_us(start), SCAN_NOT_A_DEVICE, string(), 0);
+			} else if (json) {
+				cout << "{\"error\":\"Not a device file\"}" << endl;
+			}
 		}
 	} else {
 		cerr << "-- " << rp_sprintf(C_("rpcli", "Couldn't open file: %s"), strerror(file->lastError())) << endl;
-		if (json) cout << "{\"error\":\"couldn't open file\",\"code\":" << file->lastError() << "}" << endl;
+		if (ndjson) {
+			WriteJSONRecord(cout, filename, elapsed_us(start), SCAN_OPEN_ERROR, string(), file->lastError());
+		} else if (json) {
+			cout << "{\"error\":\"couldn't open file\",\"code\":" << file->lastError() << "}" << endl;
+		}
 	}
 	file->unref();
 }
@@ -344,18 +401,30 @@ int RP_C_API main(int argc, char *argv[])
 
 	if(argc < 2){
 #ifdef ENABLE_DECRYPTION
-		cerr << C_("rpcli", "Usage: rpcli [-k] [-c] [-p] [-j] [-l lang] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
+		cerr << C_("rpcli", "Usage: rpcli [-k] [-c] [-p] [-j] [-J] [-h[cms]] [-r[N]] [-l lang] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
 		cerr << "  -k:   " << C_("rpcli", "Verify encryption keys in keys.conf.") << endl;
 #else /* !ENABLE_DECRYPTION */
-		cerr << C_("rpcli", "Usage: rpcli [-c] [-p] [-j] [-l lang] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
+		cerr << C_("rpcli", "Usage: rpcli [-c] [-p] [-j] [-J] [-r[N]] [-l lang] [[-x[b]N outfile]... [-a apngoutfile] filename]...") << endl;
 #endif /* ENABLE_DECRYPTION */
 		cerr << "  -c:   " << C_("rpcli", "Print system region information.") << endl;
 		cerr << "  -p:   " << C_("rpcli", "Print system path information.") << endl;
 		cerr << "  -j:   " << C_("rpcli", "Use JSON output format.") << endl;
+		cerr << "  -J:   " << C_("rpcli", "Use NDJSON output format. (one compact JSON object per line)") << endl;
 		cerr << "  -l:   " << C_("rpcli", "Retrieve the specified language from the ROM image.") << endl;
 		cerr << "  -xN:  " << C_("rpcli", "Extract image N to outfile in PNG format.") << endl;
 		cerr << "  -a:   " << C_("rpcli", "Extract the animated icon to outfile in APNG format.") << endl;
+		cerr << "  -rN:  " << C_("rpcli", "Recursively scan directories using up to N threads. (N is optional)") << endl;
 		cerr << endl;
+#ifdef ENABLE_DECRYPTION
+		cerr << C_("rpcli", "Hashing options:") << endl;
+		cerr << "  -h:    " << C_("rpcli", "Hash files instead of showing their properties.") << endl;
+		cerr << "  -hc:   " << C_("rpcli", "Only calculate CRC32.") << endl;
+		cerr << "  -hm:   " << C_("rpcli", "Only calculate MD5.") << endl;
+		cerr << "  -hs:   " << C_("rpcli", "Only calculate SHA-1.") << endl;
+		cerr << "         " << C_("rpcli", "Algorithms can be combined, e.g. -hcs.") << endl;
+		cerr << "         " << C_("rpcli", "Decrypted and decompressed contents are hashed, too.") << endl;
+		cerr << endl;
+#endif /* ENABLE_DECRYPTION */
 #ifdef RP_OS_SCSI_SUPPORTED
 		cerr << C_("rpcli", "Special options for devices:") << endl;
 		cerr << "  -is:   " << C_("rpcli", "Run a SCSI INQUIRY command.") << endl;
@@ -368,6 +437,8 @@ int RP_C_API main(int argc, char *argv[])
 		cerr << "\t " << C_("rpcli", "displays info about s3.gen") << endl;
 		cerr << "* rpcli -x0 icon.png pokeb2.nds" << endl;
 		cerr << "\t " << C_("rpcli", "extracts icon from pokeb2.nds") << endl;
+		cerr << "* rpcli -J -r roms/" << endl;
+		cerr << "\t " << C_("rpcli", "prints NDJSON for every supported file in roms/") << endl;
 	}
 	
 	assert(RomData::IMG_INT_MIN == 0);
@@ -378,9 +449,12 @@ int RP_C_API main(int argc, char *argv[])
 	for (int i = 1; i < argc; i++) { // figure out the json mode in advance
 		if (argv[i][0] == '-' && argv[i][1] == 'j') {
 			json = true;
+		} else if (argv[i][0] == '-' && argv[i][1] == 'J') {
+			json = true;
+			ndjson = true;
 		}
 	}
-	if (json) cout << "[\n";
+	if (json && !ndjson) cout << "[\n";
 
 #ifdef _WIN32
 	// Initialize GDI+.
@@ -397,7 +471,12 @@ int RP_C_API main(int argc, char *argv[])
 	bool inq_ata = false;
 	bool inq_ata_packet = false;
 #endif /* RP_OS_SCSI_SUPPORTED */
+#ifdef ENABLE_DECRYPTION
+	unsigned int hashAlgorithms = 0;
+#endif /* ENABLE_DECRYPTION */
 	uint32_t languageCode = 0;
+	bool scanDirs = false;
+	unsigned int scanThreads = 0;
 	bool first = true;
 	int ret = 0;
 	for (int i = 1; i < argc; i++){
@@ -413,6 +492,29 @@ int RP_C_API main(int argc, char *argv[])
 				}
 				break;
 			}
+			case 'h': {
+				// Hash files.
+				// NOTE: Algorithms may be specified immediately after 'h'.
+				unsigned int algorithms = 0;
+				for (const char *p = &argv[i][2]; *p != '\0'; p++) {
+					switch (*p) {
+						case 'c':
+							algorithms |= HASH_CRC32;
+							break;
+						case 'm':
+							algorithms |= HASH_MD5;
+							break;
+						case 's':
+							algorithms |= HASH_SHA1;
+							break;
+						default:
+							cerr << rp_sprintf(C_("rpcli", "Warning: skipping unknown hash algorithm '%c'"), *p) << endl;
+							break;
+					}
+				}
+				hashAlgorithms = (algorithms != 0 ? algorithms : static_cast<unsigned int>(HASH_ALL));
+				break;
+			}
 #endif /* ENABLE_DECRYPTION */
 			case 'c':
 				// Print the system region information.
@@ -468,7 +570,16 @@ int RP_C_API main(int argc, char *argv[])
 				extract.emplace_back(ExtractParam(argv[++i], -1));
 				break;
 			case 'j': // do nothing
+			case 'J':
 				break;
+			case 'r': {
+				// Recursively scan directories.
+				// NOTE: The maximum number of threads may be specified immediately after 'r'.
+				const long num = atol(argv[i] + 2);
+				scanDirs = true;
+				scanThreads = (num > 0 ? static_cast<unsigned int>(num) : 0);
+				break;
+			}
 #ifdef RP_OS_SCSI_SUPPORTED
 			case 'i':
 				// These commands take precedence over the usual rpcli functionality.
@@ -499,11 +610,25 @@ int RP_C_API main(int argc, char *argv[])
 				cerr << rp_sprintf(C_("rpcli", "Warning: skipping unknown switch '%c'"), argv[i][1]) << endl;
 				break;
 			}
+		} else if (scanDirs) {
+			// Recursive directory scan.
+			// NOTE: DoScanDir() handles JSON array separators.
+			if (DoScanDir(argv[i], json, ndjson, first, scanThreads, languageCode) != 0) {
+				ret = EXIT_FAILURE;
+			}
 		} else {
 			if (first) first = false;
-			else if (json) cout << "," << endl;
+			else if (json && !ndjson) cout << "," << endl;
 
 			// TODO: Return codes?
+#ifdef ENABLE_DECRYPTION
+			if (hashAlgorithms != 0) {
+				// Hash the file.
+				if (DoHashFile(argv[i], json, hashAlgorithms) != 0) {
+					ret = EXIT_FAILURE;
+				}
+			} else
+#endif /* ENABLE_DECRYPTION */
 #ifdef RP_OS_SCSI_SUPPORTED
 			if (inq_scsi) {
 				// SCSI INQUIRY command.
@@ -529,7 +654,8 @@ int RP_C_API main(int argc, char *argv[])
 			extract.clear();
 		}
 	}
-	if (json) cout << "]\n";
+	if (json && !ndjson) cout << "]\n";
+	cout.flush();
 
 #ifdef _WIN32
 	// Shut down GDI+.
@@ -26,6 +26,18 @@ int rpcli_do_security_options(void)
 		// TODO: Add more syscalls.
 		// FIXME: glibc-2.31 uses 64-bit time syscalls that may not be
 		// defined in earlier versions, including Ubuntu 14.04.
+
+		// NOTE: Special case for clone(). If it's the first syscall
+		// in the list, it has a parameter restriction added that
+		// ensures it can only be used to create threads.
+		SCMP_SYS(clone),
+		// Other multi-threading syscalls [LibRpThreads::ThreadPool]
+		SCMP_SYS(set_robust_list), SCMP_SYS(madvise),
+		SCMP_SYS(sched_getaffinity),	// sysconf(_SC_NPROCESSORS_ONLN)
+#if defined(__SNR_rseq) || defined(__NR_rseq)
+		SCMP_SYS(rseq),		// glibc-2.35
+#endif /* __SNR_rseq || __NR_rseq */
+
 		SCMP_SYS(close),
 		SCMP_SYS(dup),		// gzdopen()
 		SCMP_SYS(fcntl),     SCMP_SYS(fcntl64),		// gcc profiling
@@ -34,9 +46,16 @@ int rpcli_do_security_options(void)
 		SCMP_SYS(ftruncate),	// LibRpBase::RpFile::truncate() [from LibRpBase::RpPngWriterPrivate::init()]
 		SCMP_SYS(ftruncate64),
 		SCMP_SYS(futex),
+		SCMP_SYS(getdents), SCMP_SYS(getdents64),	// readdir() [DoScanDir()]
+		SCMP_SYS(clock_gettime),	// std::chrono::steady_clock [DoScanDir()]
+#if defined(__SNR_clock_gettime64) || defined(__NR_clock_gettime64)
+		SCMP_SYS(clock_gettime64),
+#endif /* __SNR_clock_gettime64 || __NR_clock_gettime64 */
 		SCMP_SYS(gettimeofday),	// 32-bit only?
 		SCMP_SYS(ioctl),	// for devices; also afl-fuzz
 		SCMP_SYS(lseek), SCMP_SYS(_llseek),
+		SCMP_SYS(pread64),	// LibRpFile::RpFile::readAt()
+		SCMP_SYS(preadv),	// LibRpFile::RpFile::readBatch()
 		SCMP_SYS(lstat), SCMP_SYS(lstat64),	// LibRpBase::FileSystem::is_symlink(), resolve_symlink()
 		SCMP_SYS(mmap), SCMP_SYS(mmap2),
 		SCMP_SYS(mprotect),	// dlopen()
@@ -49,11 +68,22 @@ int rpcli_do_security_options(void)
 		__NR_openat2,		// Linux 5.6
 #endif /* __SNR_openat2 || __NR_openat2 */
 		SCMP_SYS(readlink),	// realpath() [LibRpBase::FileSystem::resolve_symlink()]
+		SCMP_SYS(statfs), SCMP_SYS(statfs64),	// FileSystem::isOnBadFS() [RpFile FM_MMAP]
 
 		// KeyManager (keys.conf)
 		SCMP_SYS(access),	// LibUnixCommon::isWritableDirectory()
 		SCMP_SYS(stat), SCMP_SYS(stat64),	// LibUnixCommon::isWritableDirectory()
 
+		// RomDataIndex (~/.cache/rom-properties/index/)
+		// gzip index cache [LibRpFile::GzReader] (~/.cache/rom-properties/gzindex/)
+		SCMP_SYS(getpid),	// temporary filenames
+		SCMP_SYS(mkdir),	// LibRpFile::FileSystem::rmkdir()
+		SCMP_SYS(rename), SCMP_SYS(renameat),	// LibRpFile::FileSystem::rename_file()
+#if defined(__SNR_renameat2) || defined(__NR_renameat2)
+		SCMP_SYS(renameat2),
+#endif /* __SNR_renameat2 || __NR_renameat2 */
+		SCMP_SYS(unlink), SCMP_SYS(unlinkat),	// LibRpFile::FileSystem::delete_file()
+
 #if defined(__SNR_statx) || defined(__NR_statx)
 		SCMP_SYS(getcwd),	// called by glibc's statx()
 		SCMP_SYS(statx),
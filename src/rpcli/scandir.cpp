@@ -0,0 +1,652 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * scandir.cpp: Parallel recursive directory scan.                         *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "stdafx.h"
+#include "scandir.hpp"
+
+// librpbase
+#include "librpbase/RomData.hpp"
+#include "librpbase/TextFuncs.hpp"
+#include "librpbase/TextOut.hpp"
+#include "libi18n/i18n.h"
+using namespace LibRpBase;
+
+// librpfile
+#include "librpfile/RpFile.hpp"
+using LibRpFile::RpFile;
+
+// libromdata
+#include "libromdata/RomDataFactory.hpp"
+#include "libromdata/RomDataIndex.hpp"
+using LibRomData::RomDataFactory;
+using LibRomData::RomDataIndex;
+
+// librpthreads
+#include "librpthreads/ThreadPool.hpp"
+using LibRpThreads::ThreadPool;
+
+// C includes.
+#ifdef _WIN32
+# include "libwin32common/RpWin32_sdk.h"
+# include "libwin32common/w32err.h"
+# include "librpbase/TextFuncs_wchar.hpp"
+#else /* !_WIN32 */
+# include <dirent.h>
+# include <fcntl.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif /* _WIN32 */
+
+// C includes. (C++ namespace)
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+// C++ includes.
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::ostringstream;
+using std::string;
+using std::vector;
+
+#ifdef _WIN32
+# define DIR_SEP_CHR '\\'
+#else /* !_WIN32 */
+# define DIR_SEP_CHR '/'
+#endif /* _WIN32 */
+
+// Number of files to process per batch.
+// Results are buffered until the whole batch is done,
+// so this bounds the amount of memory used for output.
+static const size_t SCAN_BATCH_SIZE = 256;
+
+// Maximum directory depth.
+static const unsigned int SCAN_MAX_DEPTH = 64;
+
+/**
+ * A single file in a scan batch.
+ */
+struct ScanEntry {
+	string filename;	// [in] Filename
+	string output;		// [out] ROMOutput or JSONROMOutput
+	ScanStatus status;	// [out] Status
+	int err;		// [out] POSIX error code (SCAN_OPEN_ERROR only)
+	uint64_t time_us;	// [out] Time taken, in microseconds
+
+	explicit ScanEntry(const string &filename)
+		: filename(filename)
+		, status(SCAN_NOT_SUPPORTED)
+		, err(0)
+		, time_us(0)
+	{ }
+};
+
+/**
+ * Directory scanner.
+ */
+class DirScanner
+{
+	public:
+		DirScanner(bool json, bool ndjson, bool &first, unsigned int maxThreads, uint32_t languageCode);
+
+	private:
+		RP_DISABLE_COPY(DirScanner)
+
+	public:
+		/**
+		 * Recursively scan a directory.
+		 * @param path Directory path, including the trailing separator.
+		 * @param depth Current depth.
+		 */
+		void scanDir(const string &path, unsigned int depth);
+
+		/**
+		 * Add a file to the current batch.
+		 * The batch is processed if it's full.
+		 * @param filename Filename
+		 */
+		void addFile(const string &filename);
+
+		/**
+		 * Process the current batch and print the results.
+		 */
+		void flush(void);
+
+		/**
+		 * Print a summary of the scan to stderr.
+		 */
+		void printSummary(void) const;
+
+		/**
+		 * Does a filename have a supported file extension?
+		 * @param name Filename (without the directory)
+		 * @return True if supported; false if not.
+		 */
+		static bool isSupportedExt(const char *name);
+
+	private:
+		/**
+		 * Process a single file in a batch.
+		 * @param param DirScanner
+		 * @param index Batch index
+		 */
+		static void scanTask(void *param, unsigned int index);
+
+		/**
+		 * Print a single result.
+		 * @param entry Scan entry
+		 */
+		void printEntry(const ScanEntry &entry);
+
+	private:
+		const bool json;
+		const bool ndjson;
+		bool &first;
+		const unsigned int maxThreads;
+		const uint32_t languageCode;
+
+		vector<ScanEntry> batch;
+
+		// Statistics.
+		unsigned int count_ok;
+		unsigned int count_notSupported;
+		unsigned int count_error;
+		uint64_t total_us;
+
+		// Supported file extensions, lowercase and sorted.
+		static vector<string> exts;
+};
+
+vector<string> DirScanner::exts;
+
+/**
+ * Convert a string to lowercase.
+ * Only ASCII characters are converted; UTF-8 sequences are left as-is.
+ * @param str String
+ */
+static void toLowerASCII(string &str)
+{
+	for (auto iter = str.begin(); iter != str.end(); ++iter) {
+		if (*iter >= 'A' && *iter <= 'Z') {
+			*iter |= 0x20;
+		}
+	}
+}
+
+DirScanner::DirScanner(bool json, bool ndjson, bool &first, unsigned int maxThreads, uint32_t languageCode)
+	: json(json)
+	, ndjson(ndjson)
+	, first(first)
+	, maxThreads(maxThreads)
+	, languageCode(languageCode)
+	, count_ok(0)
+	, count_notSupported(0)
+	, count_error(0)
+	, total_us(0)
+{
+	batch.reserve(SCAN_BATCH_SIZE);
+
+	if (exts.empty()) {
+		// Get the supported file extensions.
+		const vector<RomDataFactory::ExtInfo> &vec_exts = RomDataFactory::supportedFileExtensions();
+		exts.reserve(vec_exts.size());
+		for (auto iter = vec_exts.cbegin(); iter != vec_exts.cend(); ++iter) {
+			exts.emplace_back(iter->ext);
+			toLowerASCII(exts.back());
+		}
+		std::sort(exts.begin(), exts.end());
+		exts.erase(std::unique(exts.begin(), exts.end()), exts.end());
+	}
+}
+
+/**
+ * Does a filename have a supported file extension?
+ * @param name Filename (without the directory)
+ * @return True if supported; false if not.
+ */
+bool DirScanner::isSupportedExt(const char *name)
+{
+	// Some extensions have more than one dot, e.g. ".xex.bin",
+	// so check the suffix starting at every dot.
+	// NOTE: A leading dot indicates a hidden file, not an extension.
+	string lname(name);
+	toLowerASCII(lname);
+
+	// Check the extension without ".gz", since RpFile
+	// handles gzipped files transparently.
+	size_t len = lname.size();
+	if (len > 3 && !lname.compare(len - 3, 3, ".gz")) {
+		len -= 3;
+		lname.resize(len);
+	}
+
+	for (size_t pos = lname.find('.', 1); pos != string::npos; pos = lname.find('.', pos + 1)) {
+		if (std::binary_search(exts.cbegin(), exts.cend(), lname.substr(pos))) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Recursively scan a directory.
+ * @param path Directory path, including the trailing separator.
+ * @param depth Current depth.
+ */
+void DirScanner::scanDir(const string &path, unsigned int depth)
+{
+	if (depth > SCAN_MAX_DEPTH) {
+		cerr << "-- " << rp_sprintf(C_("rpcli", "Directory is nested too deeply: %s"), path.c_str()) << endl;
+		return;
+	}
+
+	// Directory entries are sorted by name before processing
+	// so the output doesn't depend on the filesystem's order.
+	// Subdirectories are marked with a trailing separator.
+	vector<string> names;
+
+#ifdef _WIN32
+	WIN32_FIND_DATA ffd;
+	HANDLE hFind = FindFirstFile(U82T_s(path + '*'), &ffd);
+	if (!hFind || hFind == INVALID_HANDLE_VALUE) {
+		// Unable to open the directory.
+		cerr << "-- " << rp_sprintf_p(C_("rpcli", "Couldn't open directory '%1$s': %2$s"),
+			path.c_str(), strerror(w32err_to_posix(GetLastError()))) << endl;
+		count_error++;
+		return;
+	}
+
+	do {
+		const TCHAR *const name = ffd.cFileName;
+		if (name[0] == _T('.') && (name[1] == _T('\0') ||
+		    (name[1] == _T('.') && name[2] == _T('\0'))))
+		{
+			// "." or ".."
+			continue;
+		}
+
+		if (ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+			// Don't follow junctions or directory symlinks.
+			if (ffd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)
+				continue;
+			names.emplace_back(T2U8(name) + DIR_SEP_CHR);
+		} else {
+			string u8name = T2U8(name);
+			if (isSupportedExt(u8name.c_str())) {
+				names.emplace_back(std::move(u8name));
+			}
+		}
+	} while (FindNextFile(hFind, &ffd));
+	FindClose(hFind);
+#else /* !_WIN32 */
+	DIR *const dir = opendir(path.c_str());
+	if (!dir) {
+		// Unable to open the directory.
+		cerr << "-- " << rp_sprintf_p(C_("rpcli", "Couldn't open directory '%1$s': %2$s"),
+			path.c_str(), strerror(errno)) << endl;
+		count_error++;
+		return;
+	}
+
+	const int dfd = dirfd(dir);
+	struct dirent *dirent;
+	while ((dirent = readdir(dir)) != nullptr) {
+		const char *const name = dirent->d_name;
+		if (name[0] == '.' && (name[1] == '\0' ||
+		    (name[1] == '.' && name[2] == '\0')))
+		{
+			// "." or ".."
+			continue;
+		}
+
+		// Use d_type if available to skip stat() for most entries.
+		bool isDir = false;
+#ifdef _DIRENT_HAVE_D_TYPE
+		switch (dirent->d_type) {
+			case DT_DIR:
+				isDir = true;
+				break;
+			case DT_REG:
+				break;
+			case DT_LNK:
+			case DT_UNKNOWN: {
+				// Need to check the file type.
+#endif /* _DIRENT_HAVE_D_TYPE */
+				struct stat sb;
+				if (fstatat(dfd, name, &sb, AT_SYMLINK_NOFOLLOW) != 0)
+					continue;
+				if (S_ISLNK(sb.st_mode)) {
+					// Follow symlinks to regular files only.
+					// Directory symlinks may create loops.
+					if (fstatat(dfd, name, &sb, 0) != 0 || !S_ISREG(sb.st_mode))
+						continue;
+				} else if (S_ISDIR(sb.st_mode)) {
+					isDir = true;
+				} else if (!S_ISREG(sb.st_mode)) {
+					// Not a regular file.
+					continue;
+				}
+#ifdef _DIRENT_HAVE_D_TYPE
+				break;
+			}
+			default:
+				// Not a regular file or directory.
+				continue;
+		}
+#endif /* _DIRENT_HAVE_D_TYPE */
+
+		if (isDir) {
+			names.emplace_back(string(name) + DIR_SEP_CHR);
+		} else if (isSupportedExt(name)) {
+			names.emplace_back(name);
+		}
+	}
+	closedir(dir);
+#endif /* _WIN32 */
+
+	std::sort(names.begin(), names.end());
+	for (auto iter = names.cbegin(); iter != names.cend(); ++iter) {
+		if (iter->back() == DIR_SEP_CHR) {
+			scanDir(path + *iter, depth + 1);
+		} else {
+			addFile(path + *iter);
+		}
+	}
+}
+
+/**
+ * Add a file to the current batch.
+ * The batch is processed if it's full.
+ * @param filename Filename
+ */
+void DirScanner::addFile(const string &filename)
+{
+	batch.emplace_back(ScanEntry(filename));
+	if (batch.size() >= SCAN_BATCH_SIZE) {
+		flush();
+	}
+}
+
+/**
+ * Process a single file in a batch.
+ * @param param DirScanner
+ * @param index Batch index
+ */
+void DirScanner::scanTask(void *param, unsigned int index)
+{
+	DirScanner *const scanner = static_cast<DirScanner*>(param);
+	ScanEntry &entry = scanner->batch[index];
+
+	const auto start = std::chrono::steady_clock::now();
+	RpFile *const file = new RpFile(entry.filename, RpFile::FM_OPEN_READ_GZ_MMAP);
+	if (file->isOpen()) {
+		RomData *romData = RomDataIndex::create(file);
+		if (romData && romData->isValid()) {
+			ostringstream oss;
+			if (scanner->json) {
+				JSONROMOutput jsro(romData, scanner->languageCode);
+				jsro.setCompact(scanner->ndjson);
+				oss << jsro;
+			} else {
+				oss << ROMOutput(romData, scanner->languageCode);
+			}
+			entry.output = oss.str();
+			entry.status = SCAN_OK;
+		} else {
+			entry.status = SCAN_NOT_SUPPORTED;
+		}
+		UNREF(romData);
+	} else {
+		entry.status = SCAN_OPEN_ERROR;
+		entry.err = file->lastError();
+	}
+	file->unref();
+
+	entry.time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Write a string as a JSON string literal.
+ * @param os	[in] Output stream
+ * @param str	[in] String
+ */
+void WriteJSONString(std::ostream &os, const string &str)
+{
+	static const char hex_chr[] = "0123456789abcdef";
+	os << '"';
+	for (auto iter = str.cbegin(); iter != str.cend(); ++iter) {
+		const uint8_t chr = static_cast<uint8_t>(*iter);
+		switch (chr) {
+			case '"':	os << "\\\""; break;
+			case '\\':	os << "\\\\"; break;
+			case '\n':	os << "\\n"; break;
+			case '\r':	os << "\\r"; break;
+			case '\t':	os << "\\t"; break;
+			default:
+				if (chr < 0x20) {
+					os << "\\u00" << hex_chr[chr >> 4] << hex_chr[chr & 0x0F];
+				} else {
+					os << *iter;
+				}
+				break;
+		}
+	}
+	os << '"';
+}
+
+/**
+ * Write the start of a JSON record for a single file.
+ * The caller then writes the record's data as `,"key":value`
+ * and ends the record with WriteJSONRecordEnd().
+ *
+ * Format: {"filename":"...","time_us":123
+ *
+ * @param os		[in] Output stream
+ * @param filename	[in] Filename
+ * @param time_us	[in] Time taken, in microseconds
+ */
+void WriteJSONRecordStart(std::ostream &os, const string &filename, uint64_t time_us)
+{
+	os << "{\"filename\":";
+	WriteJSONString(os, filename);
+	os << ",\"time_us\":" << time_us;
+}
+
+/**
+ * Write a JSON record for a single file.
+ * This is used for every record in NDJSON mode, so
+ * each line can be matched to its input file.
+ *
+ * Format: {"filename":"...","time_us":123,"romdata":{...}}
+ * On error, "romdata" is replaced with "error" (and "code").
+ *
+ * @param os		[in] Output stream
+ * @param filename	[in] Filename
+ * @param time_us	[in] Time taken, in microseconds
+ * @param status	[in] Scan status
+ * @param romdata	[in] JSONROMOutput (SCAN_OK only)
+ * @param err		[in] POSIX error code (SCAN_OPEN_ERROR only)
+ */
+void WriteJSONRecord(std::ostream &os, const string &filename, uint64_t time_us,
+	ScanStatus status, const string &romdata, int err)
+{
+	WriteJSONRecordStart(os, filename, time_us);
+	switch (status) {
+		case SCAN_OK:
+			os << ",\"romdata\":" << romdata;
+			break;
+		case SCAN_NOT_SUPPORTED:
+			os << ",\"error\":\"rom is not supported\"";
+			break;
+		case SCAN_NOT_A_DEVICE:
+			os << ",\"error\":\"Not a device file\"";
+			break;
+		case SCAN_OPEN_ERROR:
+		default:
+			os << ",\"error\":\"couldn't open file\",\"code\":" << err;
+			break;
+	}
+	WriteJSONRecordEnd(os);
+}
+
+/**
+ * Print a single result.
+ * @param entry Scan entry
+ */
+void DirScanner::printEntry(const ScanEntry &entry)
+{
+	switch (entry.status) {
+		case SCAN_OK:
+			count_ok++;
+			break;
+		case SCAN_NOT_SUPPORTED:
+			count_notSupported++;
+			break;
+		case SCAN_OPEN_ERROR:
+		default:
+			count_error++;
+			break;
+	}
+	total_us += entry.time_us;
+
+	if (json) {
+		if (!ndjson) {
+			if (first) first = false;
+			else cout << ",\n";
+		}
+
+		WriteJSONRecord(cout, entry.filename, entry.time_us, entry.status, entry.output, entry.err);
+		return;
+	}
+
+	// tr: %1$s == filename, %2$u == milliseconds, %3$03u == fractional milliseconds
+	cout << "== " << rp_sprintf_p(C_("rpcli", "%1$s [%2$u.%3$03u ms]"), entry.filename.c_str(),
+		static_cast<unsigned int>(entry.time_us / 1000),
+		static_cast<unsigned int>(entry.time_us % 1000)) << '\n';
+	switch (entry.status) {
+		case SCAN_OK:
+			cout << entry.output << '\n';
+			break;
+		case SCAN_NOT_SUPPORTED:
+			cout << "-- " << C_("rpcli", "ROM is not supported") << "\n\n";
+			break;
+		case SCAN_OPEN_ERROR:
+		default:
+			cout << "-- " << rp_sprintf(C_("rpcli", "Couldn't open file: %s"), strerror(entry.err)) << "\n\n";
+			break;
+	}
+}
+
+/**
+ * Process the current batch and print the results.
+ */
+void DirScanner::flush(void)
+{
+	if (batch.empty())
+		return;
+
+	ThreadPool::instance()->parallelFor(static_cast<unsigned int>(batch.size()),
+		scanTask, this, maxThreads);
+
+	// Print the results in walk order.
+	for (auto iter = batch.cbegin(); iter != batch.cend(); ++iter) {
+		printEntry(*iter);
+	}
+	batch.clear();
+}
+
+/**
+ * Print a summary of the scan to stderr.
+ */
+void DirScanner::printSummary(void) const
+{
+	const unsigned int count = count_ok + count_notSupported + count_error;
+	// tr: %1$u == number of files, %2$u == supported, %3$u == not supported, %4$u == errors
+	cerr << "-- " << rp_sprintf_p(C_("rpcli", "Scanned %1$u file(s): %2$u supported, %3$u not supported, %4$u error(s)"),
+		count, count_ok, count_notSupported, count_error) << endl;
+	if (count > 0) {
+		// tr: %1$u == total milliseconds, %2$u == average microseconds per file
+		cerr << "-- " << rp_sprintf_p(C_("rpcli", "Total processing time: %1$u ms (%2$u us per file)"),
+			static_cast<unsigned int>(total_us / 1000),
+			static_cast<unsigned int>(total_us / count)) << endl;
+	}
+}
+
+/**
+ * Recursively scan a directory and show info about every
+ * file that has a supported file extension.
+ *
+ * Files are opened and parsed on the shared thread pool in batches.
+ * Directory entries are sorted by name, and results are printed
+ * in walk order, so the output does not depend on the number of
+ * threads or on the order in which the OS returns directory entries.
+ *
+ * If path is a regular file, only that file is processed.
+ *
+ * @param path		[in] Directory or file path
+ * @param json		[in] Is program running in json mode?
+ * @param ndjson	[in] Is program running in NDJSON mode?
+ * @param first		[in/out] True if nothing has been printed to the JSON array yet
+ * @param maxThreads	[in] Maximum number of threads to use (0 for no limit)
+ * @param languageCode	[in] Language code (0 for default)
+ * @return 0 on success; non-zero if the path couldn't be opened.
+ */
+int DoScanDir(const char *path, bool json, bool ndjson, bool &first,
+	unsigned int maxThreads, uint32_t languageCode)
+{
+	cerr << "== " << rp_sprintf(C_("rpcli", "Scanning '%s'..."), path) << endl;
+
+	// Check if this is a directory.
+	bool isDir;
+#ifdef _WIN32
+	const DWORD dwAttrs = GetFileAttributes(U82T_c(path));
+	if (dwAttrs == INVALID_FILE_ATTRIBUTES) {
+		const int err = w32err_to_posix(GetLastError());
+		cerr << "-- " << rp_sprintf(C_("rpcli", "Couldn't open file: %s"), strerror(err)) << endl;
+		return err;
+	}
+	isDir = !!(dwAttrs & FILE_ATTRIBUTE_DIRECTORY);
+#else /* !_WIN32 */
+	struct stat sb;
+	if (stat(path, &sb) != 0) {
+		const int err = errno;
+		cerr << "-- " << rp_sprintf(C_("rpcli", "Couldn't open file: %s"), strerror(err)) << endl;
+		return err;
+	}
+	isDir = S_ISDIR(sb.st_mode);
+#endif /* _WIN32 */
+
+	DirScanner scanner(json, ndjson, first, maxThreads, languageCode);
+	if (isDir) {
+		string s_path(path);
+#ifdef _WIN32
+		if (s_path.back() != '\\' && s_path.back() != '/')
+#else /* !_WIN32 */
+		if (s_path.back() != '/')
+#endif /* _WIN32 */
+		{
+			s_path += DIR_SEP_CHR;
+		}
+		scanner.scanDir(s_path, 0);
+	} else {
+		// Single file. Process it even if the
+		// file extension isn't supported.
+		scanner.addFile(path);
+	}
+	scanner.flush();
+	scanner.printSummary();
+	return 0;
+}
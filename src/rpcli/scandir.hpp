@@ -0,0 +1,98 @@
+/***************************************************************************
+ * ROM Properties Page shell extension. (rpcli)                            *
+ * scandir.hpp: Parallel recursive directory scan.                         *
+ *                                                                         *
+ * Copyright (c) 2016-2020 by David Korth.                                 *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __ROMPROPERTIES_RPCLI_SCANDIR_HPP__
+#define __ROMPROPERTIES_RPCLI_SCANDIR_HPP__
+
+// C includes.
+#include <stdint.h>
+
+// C++ includes.
+#include <ostream>
+#include <string>
+
+/**
+ * Scan result status.
+ */
+enum ScanStatus {
+	SCAN_OK,		// RomData was loaded.
+	SCAN_NOT_SUPPORTED,	// File isn't supported.
+	SCAN_OPEN_ERROR,	// Couldn't open the file.
+	SCAN_NOT_A_DEVICE,	// File isn't a device. (SCSI and ATA commands)
+};
+
+/**
+ * Write a string as a JSON string literal.
+ * @param os	[in] Output stream
+ * @param str	[in] String
+ */
+void WriteJSONString(std::ostream &os, const std::string &str);
+
+/**
+ * Write the start of a JSON record for a single file.
+ * The caller then writes the record's data as `,"key":value`
+ * and ends the record with WriteJSONRecordEnd().
+ *
+ * Format: {"filename":"...","time_us":123
+ *
+ * @param os		[in] Output stream
+ * @param filename	[in] Filename
+ * @param time_us	[in] Time taken, in microseconds
+ */
+void WriteJSONRecordStart(std::ostream &os, const std::string &filename, uint64_t time_us);
+
+/**
+ * Write the end of a JSON record.
+ * @param os		[in] Output stream
+ */
+static inline void WriteJSONRecordEnd(std::ostream &os)
+{
+	os << "}\n";
+}
+
+/**
+ * Write a JSON record for a single file.
+ * This is used for every record in NDJSON mode, so
+ * each line can be matched to its input file.
+ *
+ * Format: {"filename":"...","time_us":123,"romdata":{...}}
+ * On error, "romdata" is replaced with "error" (and "code").
+ *
+ * @param os		[in] Output stream
+ * @param filename	[in] Filename
+ * @param time_us	[in] Time taken, in microseconds
+ * @param status	[in] Scan status
+ * @param romdata	[in] JSONROMOutput (SCAN_OK only)
+ * @param err		[in] POSIX error code (SCAN_OPEN_ERROR only)
+ */
+void WriteJSONRecord(std::ostream &os, const std::string &filename, uint64_t time_us,
+	ScanStatus status, const std::string &romdata, int err);
+
+/**
+ * Recursively scan a directory and show info about every
+ * file that has a supported file extension.
+ *
+ * Files are opened and parsed on the shared thread pool in batches.
+ * Directory entries are sorted by name, and results are printed
+ * in walk order, so the output does not depend on the number of
+ * threads or on the order in which the OS returns directory entries.
+ *
+ * If path is a regular file, only that file is processed.
+ *
+ * @param path		[in] Directory or file path
+ * @param json		[in] Is program running in json mode?
+ * @param ndjson	[in] Is program running in NDJSON mode?
+ * @param first		[in/out] True if nothing has been printed to the JSON array yet
+ * @param maxThreads	[in] Maximum number of threads to use (0 for no limit)
+ * @param languageCode	[in] Language code (0 for default)
+ * @return 0 on success; non-zero if the path couldn't be opened.
+ */
+int DoScanDir(const char *path, bool json, bool ndjson, bool &first,
+	unsigned int maxThreads, uint32_t languageCode = 0);
+
+#endif /* __ROMPROPERTIES_RPCLI_SCANDIR_HPP__ */
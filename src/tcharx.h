@@ -39,6 +39,8 @@ typedef char TCHAR;
 #define _tfopen(filename, mode)		fopen((filename), (mode))
 #define _tmkdir(path, mode)		mkdir((path), (mode))
 #define _tremove(pathname)		remove(pathname)
+#define _trename(oldname, newname)	rename((oldname), (newname))
+#define _tutime(filename, times)	utime((filename), (times))
 
 #define _tprintf printf
 #define _ftprintf fprintf
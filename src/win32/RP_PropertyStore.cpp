@@ -236,7 +236,7 @@ IFACEMETHODIMP RP_PropertyStore::Initialize(IStream *pstream, DWORD grfMode)
 	d->grfMode = grfMode;
 
 	// Attempt to create a RomData object.
-	d->romData = RomDataFactory::create(file, RomDataFactory::RDA_HAS_METADATA);
+	d->romData = RomDataFactory::create(file, RomDataFactory::RDA_METADATA_ONLY);
 	if (!d->romData) {
 		// No RomData.
 		return E_FAIL;
@@ -378,7 +378,7 @@ IFACEMETHODIMP RP_PropertyStore::Initialize(IStream *pstream, DWORD grfMode)
 				if (prop->type != PropertyType::String)
 					continue;
 				if (prop->data.str) {
-					InitPropVariantFromString(U82W_s(*prop->data.str), &prop_var);
+					InitPropVariantFromString(U82W_c(prop->data.str.c_str()), &prop_var);
 					d->prop_key.emplace_back(conv.pkey);
 					d->prop_val.emplace_back(prop_var);
 				}
@@ -389,7 +389,7 @@ IFACEMETHODIMP RP_PropertyStore::Initialize(IStream *pstream, DWORD grfMode)
 				assert(prop->type == PropertyType::String);
 				if (prop->type != PropertyType::String)
 					continue;
-				const wstring wstr = (prop->data.str ? U82W_s(*prop->data.str) : L"");
+				const wstring wstr = (prop->data.str ? U82W_c(prop->data.str.c_str()) : L"");
 				const wchar_t *vstr[] = {wstr.c_str()};
 				InitPropVariantFromStringVector(vstr, 1, &prop_var);
 				d->prop_key.emplace_back(conv.pkey);
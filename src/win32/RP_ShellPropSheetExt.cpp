@@ -749,7 +749,7 @@ int RP_ShellPropSheetExt_Private::initString(_In_ HWND hDlg, _In_ HWND hWndTab,
 
 		// NULL string == empty string
 		if (field.data.str) {
-			str_nl = LibWin32Common::unix2dos(U82T_s(*(field.data.str)), &lf_count);
+			str_nl = LibWin32Common::unix2dos(U82T_c(field.data.str.c_str()), &lf_count);
 		}
 	} else {
 		// Use the specified string.
@@ -1152,9 +1152,9 @@ int RP_ShellPropSheetExt_Private::initListData(HWND hDlg, HWND hWndTab,
 	// NOTE: listDataDesc.names can be nullptr,
 	// which means we don't have any column headers.
 
-	// Single language ListData_t.
+	// Single language ListDataView_t.
 	// For RFT_LISTDATA_MULTI, this is only used for row and column count.
-	const RomFields::ListData_t *list_data;
+	const RomFields::ListDataView_t *list_data;
 	const bool isMulti = !!(listDataDesc.flags & RomFields::RFT_LISTDATA_MULTI);
 	if (isMulti) {
 		// Multiple languages.
@@ -1310,7 +1310,7 @@ int RP_ShellPropSheetExt_Private::initListData(HWND hDlg, HWND hWndTab,
 	int nl_max = 0;	// Highest number of newlines in any string.
 	const auto list_data_cend = list_data->cend();
 	for (auto iter = list_data->cbegin(); iter != list_data_cend; ++iter) {
-		const vector<string> &data_row = *iter;
+		const RomFields::ListDataRow_t &data_row = *iter;
 		// FIXME: Skip even if we don't have checkboxes?
 		// (also check other UI frontends)
 		if (hasCheckboxes) {
@@ -1342,7 +1342,7 @@ int RP_ShellPropSheetExt_Private::initListData(HWND hDlg, HWND hWndTab,
 			const auto *const multi = field.data.list_data.data.multi;
 			const auto multi_cend = multi->cend();
 			for (auto iter_m = multi->cbegin(); iter_m != multi_cend; ++iter_m) {
-				const RomFields::ListData_t &ld = iter_m->second;
+				const RomFields::ListDataView_t &ld = iter_m->second;
 				const auto ld_cend = ld.cend();
 				for (auto iter_row = ld.cbegin(); iter_row != ld_cend; ++iter_row) {
 					const auto &data_row = *iter_row;
@@ -1351,7 +1351,7 @@ int RP_ShellPropSheetExt_Private::initListData(HWND hDlg, HWND hWndTab,
 						size_t prev_nl_pos = 0;
 						size_t cur_nl_pos;
 						int nl = 0;
-						while ((cur_nl_pos = iter_col->find('\n', prev_nl_pos)) != tstring::npos) {
+						while ((cur_nl_pos = iter_col->find('\n', prev_nl_pos)) != string::npos) {
 							nl++;
 							prev_nl_pos = cur_nl_pos + 1;
 						}
@@ -1364,7 +1364,7 @@ int RP_ShellPropSheetExt_Private::initListData(HWND hDlg, HWND hWndTab,
 			int col = 0;
 			const auto data_row_cend = data_row.cend();
 			for (auto iter = data_row.cbegin(); iter != data_row_cend; ++iter, col++) {
-				tstring tstr = U82T_s(*iter);
+				tstring tstr = U82T_c(iter->c_str());
 
 				int nl_count;
 				int width = LibWin32Common::measureStringForListView(hDC, tstr, &nl_count);
@@ -1882,7 +1882,7 @@ void RP_ShellPropSheetExt_Private::updateMulti(uint32_t user_lc)
 			}
 		}
 
-		// Get the ListData_t.
+		// Get the ListDataView_t.
 		const auto *const pListData = RomFields::getFromListDataMulti(pListData_multi, def_lc, user_lc);
 		assert(pListData != nullptr);
 		if (pListData != nullptr) {
@@ -1931,7 +1931,7 @@ void RP_ShellPropSheetExt_Private::updateMulti(uint32_t user_lc)
 			for (; iter_ld_row != pListData_cend && iter_vvStr_row != vvStr_end;
 			     ++iter_ld_row, ++iter_vvStr_row)
 			{
-				const vector<string> &src_data_row = *iter_ld_row;
+				const RomFields::ListDataRow_t &src_data_row = *iter_ld_row;
 				vector<tstring> &dest_data_row = *iter_vvStr_row;
 
 				int col = 0;
@@ -1942,7 +1942,7 @@ void RP_ShellPropSheetExt_Private::updateMulti(uint32_t user_lc)
 				for (; iter_sdr != src_data_row_cend && iter_ddr != dest_data_row_end;
 				     ++iter_sdr, ++iter_ddr, col++)
 				{
-					tstring tstr = U82T_s(*iter_sdr);
+					tstring tstr = U82T_c(iter_sdr->c_str());
 					int width = LibWin32Common::measureStringForListView(hDC, tstr);
 					if (col < colCount) {
 						lvData.col_widths[col] = std::max(lvData.col_widths[col], width);
@@ -2131,8 +2131,8 @@ int RP_ShellPropSheetExt_Private::updateField(int fieldIdx)
 				break;
 			}
 
-			if (field->data.str && !field->data.str->empty()) {
-				const tstring ts_text = LibWin32Common::unix2dos(U82T_s(*field->data.str));
+			if (!field->data.str.empty()) {
+				const tstring ts_text = LibWin32Common::unix2dos(U82T_c(field->data.str.c_str()));
 				SetWindowText(hLabel, ts_text.c_str());
 			} else {
 				SetWindowText(hLabel, _T(""));